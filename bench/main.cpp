@@ -0,0 +1,1824 @@
+// AudioSwitcherBench: microbenchmarks of the device API.
+//
+// Runs against an in-process SimulatedBackend by default, so results are
+// repeatable and the benchmark runs where Core Audio does not exist:
+//
+//   AudioSwitcherBench --devices 8 --latency-us 50 --iterations 2000 --out results.json
+//
+// Output is JSON (one object per benchmark with mean/median/p99/min in
+// nanoseconds) meant to be diffed against a stored baseline. The "traced:"
+// benchmarks repeat some calls through a TracingBackend (recording overhead);
+// the "trace" object gives the size of what they recorded.
+//
+// The "c:" benchmarks make the same calls through the flat C API
+// (AudioSwitcherC.h). Every result also reports heap allocations per call.
+//
+// The "service:" benchmarks time round trips to an in-process AudioService
+// through Service::AudioClient; the "service" object reports requests per
+// second with --clients concurrent clients, each keeping --pipeline requests
+// in flight.
+//
+// The "snapshot:" benchmarks time reads of the shared-memory device snapshot
+// (Service::SnapshotReader); the "snapshot" object reports a stress run of
+// --clients reader threads against a publisher republishing as fast as it can.
+//
+// The "sessions:" benchmarks compare finding and muting one process's audio
+// sessions through Devices::SessionTable (PID index, cached volume controls)
+// with enumerating every endpoint's sessions each time.
+//
+// The "rules:" benchmark times Devices::RuleEngine from a simulated headset
+// being plugged in or out to its rule's last action.
+//
+// The "profiles:" benchmarks switch between two scenes with
+// Devices::ProfileManager and with the hand-coded sequence it replaces
+// (look devices up by name, switch, mute, set volume); the "profiles" object
+// gives the backend calls each makes per switch.
+//
+// The "names:" benchmarks search a few thousand synthetic device names
+// (accented, numbered, vendor and model words) with Devices::DeviceNameIndex
+// and with a lower-case substring scan of every name; the index also finds
+// accent-folded and misspelt queries, which the scan cannot.
+//
+// The "diff:" benchmarks compare two device snapshots that differ by a few
+// added, removed, unplugged, renamed and reformatted endpoints, with
+// Devices::DiffSnapshots (hashed, linear) and with the ID-by-ID search it
+// replaces; a stderr line gives the differ's throughput on a large snapshot.
+//
+// The "states:" benchmarks list endpoints in every state and time
+// Devices::DeviceStateTracker::waitForDevice() from a simulated jack being
+// plugged in or out to the waiting thread seeing it.
+//
+// The "mixer:", "matrix:", "meter:", "spectrum:" and "vad:" benchmarks time
+// one 10 ms period as the number of mixer inputs (2 to 64), matrix source
+// channels and meter / spectrum streams (1 to 32) grows, and one VAD frame;
+// stderr lines give frames per second.
+//
+// The "recorder:" benchmark times Streaming::WavRecorder::write() on the
+// capture thread (a stderr line gives its disk throughput); the "player:"
+// benchmarks time Streaming::WavPlayer from enqueue() to the first period.
+//
+// The "directory:" benchmarks time the first Devices::DeviceDirectory lookup
+// without a cache file (live enumeration) and with one. The "instrumentation:"
+// benchmarks time a call bare and timed; build with and without
+// AUDIO_SWITCHER_INSTRUMENTATION to compare.
+//
+// The "probe:" benchmarks time Devices::FormatProber over eight
+// Devices::FakeFormatQuery endpoints whose queries sleep like a driver call
+// (--latency-us, at least 20): cold one device at a time, cold in parallel,
+// and answered from a Devices::FormatCache. The "negotiate:" benchmarks time
+// Devices::FormatNegotiator::negotiate() over 12, 24 and 48 synthetic endpoints
+// in shared and in exclusive mode; stderr lines give the chosen format.
+//
+// The "cli" object compares N commands run by one AudioSwitcherCli invocation
+// with N launches of it (one command each); --cli PATH points at the binary,
+// which is otherwise looked up next to this one.
+//
+// A trace (from --trace-out, or recorded in the field) can be replayed through
+// the simulation with its original timing:
+//
+//   AudioSwitcherBench --replay session.awtr --speed 1
+
+#include "AudioSwitcher/AudioSwitcher.h"
+#include "AudioSwitcher/AudioInputSwitcher.h"
+#include "AudioSwitcher/AudioSwitcherC.h"
+#include "Backend/AudioBackend.h"
+#include "Backend/SimulatedBackend.h"
+#include "Backend/SimulatedSessionBackend.h"
+#include "Backend/TraceReplayer.h"
+#include "Backend/TracingBackend.h"
+#include "Devices/DeviceDirectory.h"
+#include "Devices/DeviceNameIndex.h"
+#include "Devices/DeviceStateTracker.h"
+#include "Devices/FakeFormatQuery.h"
+#include "Devices/FormatCache.h"
+#include "Devices/FormatNegotiator.h"
+#include "Devices/FormatProber.h"
+#include "Devices/ProfileManager.h"
+#include "Devices/SnapshotDiff.h"
+#include "Devices/RuleEngine.h"
+#include "Devices/SessionTable.h"
+#include "Dsp/ChannelLayout.h"
+#include "Dsp/ChannelMatrix.h"
+#include "Dsp/LevelMeter.h"
+#include "Dsp/MultiSourceMixer.h"
+#include "Dsp/SpectrumAnalyzer.h"
+#include "Dsp/VoiceActivityDetector.h"
+#include "Service/AudioClient.h"
+#include "Service/AudioService.h"
+#include "Service/DeviceSnapshot.h"
+#include "Streaming/AudioStream.h"
+#include "Streaming/WavPlayer.h"
+#include "Streaming/WavRecorder.h"
+#include "Utility/COMInitializer.h"
+#include "Utility/DeviceUtils.h"
+#include "Utility/Instrumentation.h"
+#include "Utility/SafeRelease.h"
+#include "Utility/StringConvert.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <malloc.h> // _aligned_malloc / _aligned_free
+#endif
+
+using namespace AudioSwitcher;
+using namespace Utility;
+
+namespace
+{
+    std::atomic<uint64_t> g_allocations{0};
+
+    /**
+     * @brief Counts and performs one allocation; `aligned` for the over-aligned operator forms.
+     */
+    void *CountedAllocate(std::size_t size, std::size_t alignment, bool aligned) noexcept
+    {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        size = size ? size : 1;
+        if (!aligned)
+            return std::malloc(size);
+#if defined(_WIN32)
+        return _aligned_malloc(size, alignment);
+#else
+        void *p = nullptr;
+        return posix_memalign(&p, alignment, size) == 0 ? p : nullptr;
+#endif
+    }
+
+    void *CountedAllocateOrThrow(std::size_t size, std::size_t alignment, bool aligned)
+    {
+        if (void *p = CountedAllocate(size, alignment, aligned))
+            return p;
+        throw std::bad_alloc();
+    }
+
+    void CountedFree(void *p, bool aligned) noexcept
+    {
+#if defined(_WIN32)
+        if (aligned)
+        {
+            _aligned_free(p);
+            return;
+        }
+#else
+        (void)aligned;
+#endif
+        std::free(p);
+    }
+}
+
+// Count every heap allocation made by the process (reported per benchmarked call). Every form is
+// replaced, so each pointer is released by the allocator that returned it
+void *operator new(std::size_t size) { return CountedAllocateOrThrow(size, 0, false); }
+void *operator new[](std::size_t size) { return CountedAllocateOrThrow(size, 0, false); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return CountedAllocate(size, 0, false); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return CountedAllocate(size, 0, false); }
+void *operator new(std::size_t size, std::align_val_t align) { return CountedAllocateOrThrow(size, static_cast<std::size_t>(align), true); }
+void *operator new[](std::size_t size, std::align_val_t align) { return CountedAllocateOrThrow(size, static_cast<std::size_t>(align), true); }
+void *operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept { return CountedAllocate(size, static_cast<std::size_t>(align), true); }
+void *operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept { return CountedAllocate(size, static_cast<std::size_t>(align), true); }
+
+void operator delete(void *p) noexcept { CountedFree(p, false); }
+void operator delete[](void *p) noexcept { CountedFree(p, false); }
+void operator delete(void *p, std::size_t) noexcept { CountedFree(p, false); }
+void operator delete[](void *p, std::size_t) noexcept { CountedFree(p, false); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { CountedFree(p, false); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { CountedFree(p, false); }
+void operator delete(void *p, std::align_val_t) noexcept { CountedFree(p, true); }
+void operator delete[](void *p, std::align_val_t) noexcept { CountedFree(p, true); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { CountedFree(p, true); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { CountedFree(p, true); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { CountedFree(p, true); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { CountedFree(p, true); }
+
+namespace
+{
+    struct Options
+    {
+        uint32_t renderDevices = 4;
+        uint32_t captureDevices = 2;
+        uint32_t latencyUs = 0;
+        uint32_t iterations = 1000;
+        uint32_t warmup = 10;
+        uint64_t seed = 1;
+        bool platform = false; ///< Use the platform backend instead of the simulation
+        bool mutate = false;   ///< Allow default-switching / mute benchmarks on the platform backend
+        std::string out;       ///< Output file (stdout when empty)
+        std::string traceOut;  ///< Where to save the trace of the traced benchmarks
+        std::string replay;    ///< Trace to replay instead of benchmarking
+        double speed = 1.0;    ///< Replay speed (0 = no gaps)
+        uint32_t clients = 4;   ///< Concurrent service clients in the throughput run
+        uint32_t pipeline = 16; ///< Requests each client keeps in flight
+        std::string cli;        ///< AudioSwitcherCli binary (default: next to this executable)
+    };
+
+    struct ServiceSummary
+    {
+        uint32_t clients = 0;
+        uint32_t pipeline = 0;
+        uint64_t requests = 0;
+        double requestsPerSecond = 0.0;
+        double unpipelinedRequestsPerSecond = 0.0;
+    };
+
+    struct SnapshotSummary
+    {
+        uint32_t readers = 0;
+        uint64_t publishes = 0;
+        uint64_t reads = 0;
+        uint64_t tornReads = 0;   ///< Reads that returned a mix of two generations (must be 0)
+        uint64_t failedReads = 0; ///< read() gave up
+        double seconds = 0.0;
+    };
+
+    struct CliSummary
+    {
+        uint32_t commands = 0;
+        double singleProcessMs = 0.0; ///< All commands in one invocation
+        double perProcessMs = 0.0;    ///< One invocation per command
+    };
+
+    struct ProfileSummary
+    {
+        double naiveCalls = 0.0; ///< Backend calls per hand-coded switch
+        double applyCalls = 0.0; ///< Per ProfileManager::apply() switch
+        double noopCalls = 0.0;  ///< Per apply() of the scene already in place
+    };
+
+    struct TraceSummary
+    {
+        size_t records = 0;
+        size_t bytes = 0;
+    };
+
+    struct Result
+    {
+        std::string name;
+        uint32_t iterations = 0;
+        double meanNs = 0.0;
+        double medianNs = 0.0;
+        double p99Ns = 0.0;
+        double minNs = 0.0;
+        double allocations = 0.0; ///< Heap allocations per call
+    };
+
+    void PrintUsage()
+    {
+        std::fprintf(stderr,
+                     "Usage: AudioSwitcherBench [--devices N] [--inputs N] [--latency-us US]\n"
+                     "                          [--iterations N] [--warmup N] [--seed N]\n"
+                     "                          [--backend simulated|platform] [--mutate] [--out FILE]\n"
+                     "                          [--trace-out FILE] [--clients N] [--pipeline D] [--cli PATH]\n"
+                     "       AudioSwitcherBench --replay TRACE [--speed X] [--out FILE]\n");
+    }
+
+    bool ParseOptions(int argc, char **argv, Options &options)
+    {
+        bool inputsGiven = false;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--devices" && hasValue)
+                options.renderDevices = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--inputs" && hasValue)
+            {
+                options.captureDevices = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+                inputsGiven = true;
+            }
+            else if (arg == "--latency-us" && hasValue)
+                options.latencyUs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--iterations" && hasValue)
+                options.iterations = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--warmup" && hasValue)
+                options.warmup = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--seed" && hasValue)
+                options.seed = std::strtoull(argv[++i], nullptr, 10);
+            else if (arg == "--backend" && hasValue)
+            {
+                const std::string backend = argv[++i];
+                if (backend != "simulated" && backend != "platform")
+                    return false;
+                options.platform = backend == "platform";
+            }
+            else if (arg == "--mutate")
+                options.mutate = true;
+            else if (arg == "--out" && hasValue)
+                options.out = argv[++i];
+            else if (arg == "--trace-out" && hasValue)
+                options.traceOut = argv[++i];
+            else if (arg == "--replay" && hasValue)
+                options.replay = argv[++i];
+            else if (arg == "--speed" && hasValue)
+                options.speed = std::strtod(argv[++i], nullptr);
+            else if (arg == "--clients" && hasValue)
+                options.clients = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--pipeline" && hasValue)
+                options.pipeline = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--cli" && hasValue)
+                options.cli = argv[++i];
+            else
+                return false;
+        }
+
+        if (!inputsGiven)
+            options.captureDevices = std::max<uint32_t>(1, options.renderDevices / 2);
+        return options.iterations > 0 && options.renderDevices > 0 && options.speed >= 0.0 && options.clients > 0 &&
+               options.pipeline > 0;
+    }
+
+    /**
+     * @brief Times `iterations` calls of `body` individually after `warmup` untimed calls.
+     *
+     * @param reset Optional, run untimed after every call (e.g. to stop what `body` started).
+     */
+    Result Measure(const char *name, const Options &options, const std::function<void()> &body,
+                   const std::function<void()> &reset = nullptr)
+    {
+        for (uint32_t i = 0; i < options.warmup; ++i)
+        {
+            body();
+            if (reset)
+                reset();
+        }
+
+        std::vector<double> samples(options.iterations);
+        uint64_t allocations = 0;
+        for (uint32_t i = 0; i < options.iterations; ++i)
+        {
+            const uint64_t allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+            const auto start = std::chrono::steady_clock::now();
+            body();
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            allocations += g_allocations.load(std::memory_order_relaxed) - allocationsBefore;
+            samples[i] = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            if (reset)
+                reset();
+        }
+
+        std::sort(samples.begin(), samples.end());
+        Result result;
+        result.name = name;
+        result.iterations = options.iterations;
+        double sum = 0.0;
+        for (double s : samples)
+            sum += s;
+        result.meanNs = sum / static_cast<double>(samples.size());
+        result.medianNs = samples[samples.size() / 2];
+        result.p99Ns = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+        result.minNs = samples.front();
+        result.allocations = static_cast<double>(allocations) / static_cast<double>(options.iterations);
+
+        std::fprintf(stderr, "%-44s mean %12.0f ns  p99 %12.0f ns  %6.1f allocs\n", name, result.meanNs, result.p99Ns,
+                     result.allocations);
+        return result;
+    }
+
+    std::string JsonEscape(const std::string &text)
+    {
+        std::string out;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out.push_back('\\');
+                out.push_back(c);
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+                out += buffer;
+            }
+            else
+            {
+                out.push_back(c);
+            }
+        }
+        return out;
+    }
+
+    void WriteJson(std::FILE *file, const char *backend, const Options &options, const std::vector<Result> &results,
+                   const TraceSummary &trace, const ServiceSummary &service, const SnapshotSummary &snapshot,
+                   const CliSummary &cli, const ProfileSummary &profiles)
+    {
+        std::fprintf(file, "{\n  \"suite\": \"AudioSwitcherBench\",\n  \"backend\": \"%s\",\n", JsonEscape(backend).c_str());
+        std::fprintf(file,
+                     "  \"config\": {\"render_devices\": %u, \"capture_devices\": %u, \"latency_us\": %u, "
+                     "\"iterations\": %u, \"warmup\": %u, \"seed\": %llu},\n",
+                     options.renderDevices, options.captureDevices, options.latencyUs, options.iterations,
+                     options.warmup, static_cast<unsigned long long>(options.seed));
+        std::fprintf(file, "  \"results\": [\n");
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const Result &r = results[i];
+            std::fprintf(file,
+                         "    {\"name\": \"%s\", \"iterations\": %u, \"mean_ns\": %.1f, \"median_ns\": %.1f, "
+                         "\"p99_ns\": %.1f, \"min_ns\": %.1f, \"allocs_per_call\": %.2f}%s\n",
+                         JsonEscape(r.name).c_str(), r.iterations, r.meanNs, r.medianNs, r.p99Ns, r.minNs,
+                         r.allocations, i + 1 < results.size() ? "," : "");
+        }
+        std::fprintf(file, "  ],\n");
+        std::fprintf(file, "  \"trace\": {\"records\": %zu, \"bytes\": %zu, \"bytes_per_record\": %.2f},\n",
+                     trace.records, trace.bytes,
+                     trace.records ? static_cast<double>(trace.bytes) / static_cast<double>(trace.records) : 0.0);
+        std::fprintf(file,
+                     "  \"service\": {\"clients\": %u, \"pipeline\": %u, \"requests\": %llu, "
+                     "\"requests_per_second\": %.0f, \"unpipelined_requests_per_second\": %.0f},\n",
+                     service.clients, service.pipeline, static_cast<unsigned long long>(service.requests),
+                     service.requestsPerSecond, service.unpipelinedRequestsPerSecond);
+        const double seconds = snapshot.seconds > 0.0 ? snapshot.seconds : 1.0;
+        std::fprintf(file,
+                     "  \"snapshot\": {\"readers\": %u, \"publishes\": %llu, \"reads\": %llu, \"torn_reads\": %llu, "
+                     "\"failed_reads\": %llu, \"publishes_per_second\": %.0f, \"reads_per_second\": %.0f},\n",
+                     snapshot.readers, static_cast<unsigned long long>(snapshot.publishes),
+                     static_cast<unsigned long long>(snapshot.reads), static_cast<unsigned long long>(snapshot.tornReads),
+                     static_cast<unsigned long long>(snapshot.failedReads), snapshot.publishes / seconds,
+                     snapshot.reads / seconds);
+        const double commands = cli.commands ? static_cast<double>(cli.commands) : 1.0;
+        std::fprintf(file,
+                     "  \"cli\": {\"commands\": %u, \"single_process_ms\": %.1f, \"per_process_ms\": %.1f, "
+                     "\"single_process_us_per_command\": %.1f, \"per_process_us_per_command\": %.1f},\n",
+                     cli.commands, cli.singleProcessMs, cli.perProcessMs, cli.singleProcessMs * 1000.0 / commands,
+                     cli.perProcessMs * 1000.0 / commands);
+        std::fprintf(file,
+                     "  \"profiles\": {\"naive_calls_per_switch\": %.1f, \"apply_calls_per_switch\": %.1f, "
+                     "\"noop_apply_calls\": %.1f}\n}\n",
+                     profiles.naiveCalls, profiles.applyCalls, profiles.noopCalls);
+    }
+
+    void WriteReplayJson(std::FILE *file, const Options &options, const Backend::ReplayResult &result)
+    {
+        std::fprintf(file, "{\n  \"suite\": \"AudioSwitcherBench\",\n  \"replay\": \"%s\",\n  \"speed\": %.3f,\n",
+                     JsonEscape(options.replay).c_str(), options.speed);
+        std::fprintf(file,
+                     "  \"calls\": %zu, \"events\": %zu, \"mismatches\": %zu, "
+                     "\"recorded_span_ns\": %lld, \"replayed_span_ns\": %lld,\n",
+                     result.calls, result.events, result.mismatches,
+                     static_cast<long long>(result.recordedSpanNs), static_cast<long long>(result.replayedSpanNs));
+        std::fprintf(file, "  \"operations\": [\n");
+        bool first = true;
+        for (size_t i = 0; i < static_cast<size_t>(Backend::BackendOperation::Count); ++i)
+        {
+            const Backend::ReplayOperationStats &op = result.operations[i];
+            if (op.calls == 0)
+                continue;
+            const double calls = static_cast<double>(op.calls);
+            std::fprintf(file,
+                         "%s    {\"name\": \"%s\", \"calls\": %llu, \"recorded_mean_ns\": %.1f, \"replayed_mean_ns\": %.1f, "
+                         "\"recorded_max_ns\": %llu, \"replayed_max_ns\": %llu}",
+                         first ? "" : ",\n", Backend::OperationName(static_cast<Backend::BackendOperation>(i)),
+                         static_cast<unsigned long long>(op.calls), op.recordedNs / calls, op.replayedNs / calls,
+                         static_cast<unsigned long long>(op.maxRecordedNs), static_cast<unsigned long long>(op.maxReplayedNs));
+            first = false;
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+    }
+
+    /**
+     * @brief Runs `clients` concurrent clients, each sending `perClient` GetDefault requests
+     *        with up to `pipeline` of them in flight; returns requests per second.
+     */
+    double ServiceThroughput(const std::string &endpoint, uint32_t clients, uint32_t pipeline, uint32_t perClient)
+    {
+        std::vector<std::unique_ptr<Service::AudioClient>> connections;
+        for (uint32_t i = 0; i < clients; ++i)
+        {
+            connections.emplace_back(new Service::AudioClient());
+            if (!connections.back()->connect(endpoint))
+                return 0.0;
+        }
+
+        std::vector<uint8_t> payload;
+        Service::FrameWriter(payload).u8(ASW_FLOW_RENDER).u8(ASW_ROLE_CONSOLE);
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < clients; ++i)
+        {
+            threads.emplace_back([&, i]
+                                 {
+                                     Service::AudioClient &client = *connections[i];
+                                     std::deque<std::future<Service::ServiceResponse>> inFlight;
+                                     for (uint32_t sent = 0; sent < perClient; ++sent)
+                                     {
+                                         if (inFlight.size() >= pipeline)
+                                         {
+                                             inFlight.front().get();
+                                             inFlight.pop_front();
+                                         }
+                                         inFlight.push_back(client.request(Service::MessageType::GetDefault, payload));
+                                     }
+                                     for (auto &response : inFlight)
+                                         response.get(); });
+        }
+        for (std::thread &thread : threads)
+            thread.join();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return seconds > 0.0 ? static_cast<double>(clients) * perClient / seconds : 0.0;
+    }
+
+    /**
+     * @brief Fills a synthetic snapshot in which every field derives from `stamp`,
+     *        so a reader can tell a copy that mixes two publishes.
+     */
+    void StampSnapshot(Service::DeviceSnapshot &snapshot, uint32_t stamp)
+    {
+        snapshot.deviceCount = 1 + stamp % Service::kSnapshotMaxDevices;
+        for (uint32_t i = 0; i < snapshot.deviceCount; ++i)
+        {
+            Service::SnapshotDevice &device = snapshot.devices[i];
+            device.handle = i + 1;
+            device.state = stamp;
+            device.volume = static_cast<float>(stamp & 0xffff);
+            std::snprintf(device.name, sizeof(device.name), "device %u stamp %u", i, stamp);
+            std::snprintf(device.id, sizeof(device.id), "%u", stamp);
+        }
+        for (auto &flow : snapshot.defaults)
+            for (AswDevice &device : flow)
+                device = 1;
+    }
+
+    bool SnapshotConsistent(const Service::DeviceSnapshot &snapshot)
+    {
+        if (snapshot.deviceCount == 0)
+            return false;
+        const uint32_t stamp = snapshot.devices[0].state;
+        if (snapshot.deviceCount != 1 + stamp % Service::kSnapshotMaxDevices)
+            return false;
+        char id[16];
+        std::snprintf(id, sizeof(id), "%u", stamp);
+        for (uint32_t i = 0; i < snapshot.deviceCount; ++i)
+        {
+            const Service::SnapshotDevice &device = snapshot.devices[i];
+            if (device.state != stamp || device.volume != static_cast<float>(stamp & 0xffff) || std::strcmp(device.id, id) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Republishes synthetic snapshots back to back while `readers` threads
+     *        read and verify them, each through its own mapping of the segment.
+     */
+    SnapshotSummary SnapshotStress(Service::SnapshotPublisher &publisher, const std::string &name, uint32_t readers,
+                                   uint64_t publishes)
+    {
+        SnapshotSummary summary;
+        summary.readers = readers;
+
+        std::unique_ptr<Service::DeviceSnapshot> source(new Service::DeviceSnapshot());
+        StampSnapshot(*source, 0);
+        publisher.publish(*source);
+
+        std::atomic<bool> done{false};
+        std::atomic<uint64_t> reads{0}, torn{0}, failed{0};
+        std::vector<std::thread> threads;
+        for (uint32_t r = 0; r < readers; ++r)
+        {
+            threads.emplace_back([&]
+                                 {
+                                     Service::SnapshotReader reader;
+                                     if (!reader.open(name))
+                                     {
+                                         failed.fetch_add(1);
+                                         return;
+                                     }
+                                     std::unique_ptr<Service::DeviceSnapshot> copy(new Service::DeviceSnapshot());
+                                     uint64_t localReads = 0, localTorn = 0, localFailed = 0, lastGeneration = 0;
+                                     while (!done.load(std::memory_order_relaxed))
+                                     {
+                                         if (!reader.read(*copy))
+                                         {
+                                             ++localFailed;
+                                             continue;
+                                         }
+                                         ++localReads;
+                                         if (!SnapshotConsistent(*copy) || copy->generation < lastGeneration)
+                                             ++localTorn;
+                                         lastGeneration = copy->generation;
+                                     }
+                                     reads.fetch_add(localReads);
+                                     torn.fetch_add(localTorn);
+                                     failed.fetch_add(localFailed); });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 1; i <= publishes; ++i)
+        {
+            StampSnapshot(*source, static_cast<uint32_t>(i));
+            publisher.publish(*source);
+        }
+        summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        done.store(true);
+        for (std::thread &thread : threads)
+            thread.join();
+
+        summary.publishes = publishes;
+        summary.reads = reads.load();
+        summary.tornReads = torn.load();
+        summary.failedReads = failed.load();
+        return summary;
+    }
+
+    /**
+     * @brief Times `commands` CLI commands run by one invocation (from a script) and by one invocation each.
+     */
+    CliSummary CliComparison(const Options &options, const std::string &cli, uint32_t commands)
+    {
+#if defined(_WIN32)
+        const std::string discard = " > NUL";
+#else
+        const std::string discard = " > /dev/null";
+#endif
+        const std::string base = "\"" + cli + "\" --backend " + (options.platform ? "platform" : "simulated") +
+                                 " --devices " + std::to_string(options.renderDevices) + " --inputs " +
+                                 std::to_string(options.captureDevices);
+        const std::filesystem::path script = std::filesystem::temp_directory_path() / "audioswitcher-cli-bench.txt";
+        {
+            std::ofstream file(script);
+            for (uint32_t i = 0; i < commands; ++i)
+                file << "list render\n";
+        }
+
+        CliSummary summary;
+        summary.commands = commands;
+
+        auto start = std::chrono::steady_clock::now();
+        std::system((base + " -f \"" + script.string() + "\"" + discard).c_str());
+        summary.singleProcessMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        const std::string single = base + " list render" + discard;
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < commands; ++i)
+            std::system(single.c_str());
+        summary.perProcessMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::error_code ignored;
+        std::filesystem::remove(script, ignored);
+        return summary;
+    }
+
+    /**
+     * @brief Render sink that accepts one period per write and discards it (player startup benchmarks).
+     */
+    class DiscardSink : public Streaming::IAudioSink
+    {
+    public:
+        DiscardSink(const Utility::DeviceFormatInfo &format, size_t periodFrames)
+            : m_format(format), m_periodFrames(periodFrames) {}
+
+        const Utility::DeviceFormatInfo &format() const override { return m_format; }
+        size_t writableFrames() override { return m_periodFrames; }
+        size_t write(const void *, size_t frames) override { return std::min(frames, m_periodFrames); }
+
+    private:
+        Utility::DeviceFormatInfo m_format;
+        size_t m_periodFrames;
+    };
+
+    /**
+     * @brief DeviceDirectory enumerator over the current backend: render endpoints, then capture endpoints.
+     */
+    bool EnumerateBackendDevices(std::vector<Devices::DeviceRecord> &out)
+    {
+        COMInitializer com; // Runs on the directory's thread
+        out.clear();
+        try
+        {
+            for (const AudioDevice &device : AudioManager::listOutputDevices())
+            {
+                Devices::DeviceRecord record;
+                record.id = device.id;
+                record.name = device.name;
+                record.flow = Devices::DeviceFlow::Render;
+                record.state = device.state;
+                record.format = GetDeviceFormatInfo(device.device);
+                out.push_back(std::move(record));
+            }
+            for (const AudioInputDevice &device : AudioInputManager::listInputDevices())
+            {
+                Devices::DeviceRecord record;
+                record.id = device.id;
+                record.name = device.name;
+                record.flow = Devices::DeviceFlow::Capture;
+                record.state = device.state;
+                record.format = GetDeviceFormatInfo(device.device);
+                out.push_back(std::move(record));
+            }
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    std::FILE *OpenOutput(const Options &options)
+    {
+        if (options.out.empty())
+            return stdout;
+        std::FILE *file = std::fopen(options.out.c_str(), "w");
+        if (!file)
+            std::fprintf(stderr, "Cannot write %s\n", options.out.c_str());
+        return file;
+    }
+
+    /**
+     * @brief --replay: plays a trace back through the simulation and reports its timing.
+     */
+    int Replay(const Options &options)
+    {
+        std::vector<Backend::TraceRecord> records;
+        if (!Backend::ReadTrace(options.replay, records))
+        {
+            std::fprintf(stderr, "Cannot read trace %s\n", options.replay.c_str());
+            return 1;
+        }
+
+        Backend::TraceReplayer replayer(std::move(records));
+        Backend::ReplayOptions replayOptions;
+        replayOptions.speed = options.speed;
+        const Backend::ReplayResult result = replayer.replay(replayOptions);
+        std::fprintf(stderr, "Replayed %zu calls and %zu events in %.3f ms (recorded %.3f ms), %zu mismatches\n",
+                     result.calls, result.events, result.replayedSpanNs / 1e6, result.recordedSpanNs / 1e6, result.mismatches);
+
+        std::FILE *file = OpenOutput(options);
+        if (!file)
+            return 1;
+        WriteReplayJson(file, options, result);
+        if (file != stdout)
+            std::fclose(file);
+        return 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    if (!options.replay.empty())
+        return Replay(options);
+
+    COMInitializer com;
+
+    if (!options.platform)
+    {
+        Backend::SimulatedBackendConfig config;
+        config.renderDevices = options.renderDevices;
+        config.captureDevices = options.captureDevices;
+        config.seed = options.seed;
+        config.latency.enumerateUs = options.latencyUs;
+        config.latency.propertyUs = options.latencyUs;
+        config.latency.defaultUs = options.latencyUs;
+        config.latency.setDefaultUs = options.latencyUs;
+        config.latency.formatUs = options.latencyUs;
+        config.latency.volumeUs = options.latencyUs;
+        Backend::SetAudioBackend(std::make_shared<Backend::SimulatedBackend>(config));
+    }
+    const std::shared_ptr<Backend::IAudioBackend> backend = Backend::GetAudioBackend();
+    const bool mutate = !options.platform || options.mutate;
+
+    std::vector<AudioDevice> outputs;
+    std::vector<AudioInputDevice> inputs;
+    try
+    {
+        outputs = AudioManager::listOutputDevices();
+        inputs = AudioInputManager::listInputDevices();
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    std::vector<Result> results;
+    results.push_back(Measure("AudioManager::listOutputDevices", options, []
+                              { AudioManager::listOutputDevices(); }));
+    results.push_back(Measure("AudioInputManager::listInputDevices", options, []
+                              { AudioInputManager::listInputDevices(); }));
+    results.push_back(Measure("GetDefaultAudioPlaybackDevice", options, []
+                              {
+                                  IMMDevice *device = GetDefaultAudioPlaybackDevice();
+                                  SafeRelease(device); }));
+    results.push_back(Measure("GetDefaultAudioInputDevice", options, []
+                              {
+                                  IMMDevice *device = GetDefaultAudioInputDevice();
+                                  SafeRelease(device); }));
+    results.push_back(Measure("GetDeviceFriendlyName", options, [&outputs]
+                              { GetDeviceFriendlyName(outputs[0].device); }));
+    results.push_back(Measure("GetDeviceFormatInfo", options, [&outputs]
+                              { GetDeviceFormatInfo(outputs[0].device); }));
+
+    if (mutate)
+    {
+        // Alternate between the first two endpoints so every call is a real switch
+        size_t next = 0;
+        results.push_back(Measure("AudioManager::setDefaultOutputDevice", options, [&]
+                                  { AudioManager::setDefaultOutputDevice(outputs[next++ % outputs.size()].id); }));
+        results.push_back(Measure("AudioInputManager::setDefaultInputDevice", options, [&]
+                                  { AudioInputManager::setDefaultInputDevice(inputs[next++ % inputs.size()].id); }));
+
+        bool mute = false;
+        results.push_back(Measure("MuteDevice", options, [&]
+                                  { MuteDevice(outputs[0].device, mute = !mute); }));
+        results.push_back(Measure("SetDefaultPlaybackDeviceMute", options, [&]
+                                  { SetDefaultPlaybackDeviceMute(mute = !mute); }));
+        MuteDevice(outputs[0].device, false);
+        SetDefaultPlaybackDeviceMute(false);
+    }
+
+    // String conversion over every endpoint name and ID
+    std::vector<std::wstring> wide;
+    for (const AudioDevice &device : outputs)
+    {
+        wide.push_back(device.name);
+        wide.push_back(device.id);
+    }
+    std::vector<std::string> narrow;
+    for (const std::wstring &text : wide)
+        narrow.push_back(ToUtf8(text));
+
+    results.push_back(Measure("ToUtf8(names+ids)", options, [&wide]
+                              {
+                                  for (const std::wstring &text : wide)
+                                      ToUtf8(text); }));
+    results.push_back(Measure("FromUtf8(names+ids)", options, [&narrow]
+                              {
+                                  for (const std::string &text : narrow)
+                                      FromUtf8(text); }));
+
+    // Call overhead of the flat C API against the C++ calls above
+    AswContext *context = nullptr;
+    if (AswCreateContext(&context) == ASW_OK)
+    {
+        std::vector<AswDeviceInfo> infos(outputs.size() + 8);
+        std::vector<char> text(1024);
+        uint32_t count = 0;
+        AswEnumerateDevices(context, ASW_FLOW_RENDER, infos.data(), static_cast<uint32_t>(infos.size()), &count);
+
+        results.push_back(Measure("c:AswEnumerateDevices", options, [&]
+                                  { AswEnumerateDevices(context, ASW_FLOW_RENDER, infos.data(), static_cast<uint32_t>(infos.size()), &count); }));
+        results.push_back(Measure("c:AswGetDefaultDevice", options, [&]
+                                  {
+                                      AswDevice device = 0;
+                                      AswGetDefaultDevice(context, ASW_FLOW_RENDER, ASW_ROLE_CONSOLE, &device); }));
+        results.push_back(Measure("c:AswGetDeviceName", options, [&]
+                                  {
+                                      uint32_t size = 0;
+                                      AswGetDeviceName(context, infos[0].device, text.data(), static_cast<uint32_t>(text.size()), &size); }));
+        if (mutate && count > 1)
+        {
+            uint32_t next = 0;
+            results.push_back(Measure("c:AswSetDefaultDevice", options, [&]
+                                      { AswSetDefaultDevice(context, infos[next++ % count].device, ASW_ROLE_MASK_ALL); }));
+            int32_t mute = 0;
+            results.push_back(Measure("c:AswSetMute", options, [&]
+                                      { AswSetMute(context, infos[0].device, mute = !mute); }));
+            AswSetMute(context, infos[0].device, 0);
+        }
+        AswDestroyContext(context);
+    }
+
+    // Round trips and throughput through the resident service on a private endpoint
+    ServiceSummary serviceSummary;
+    {
+        Service::ServiceConfig config;
+#if defined(_WIN32)
+        config.endpoint = "\\\\.\\pipe\\AudioSwitcherBench";
+#else
+        config.endpoint = "/tmp/audioswitcher-bench.sock";
+#endif
+        Service::AudioService service(config);
+        Service::AudioClient client;
+        if (service.start() && client.connect(config.endpoint))
+        {
+            std::vector<Service::ServiceDevice> devices;
+            client.listDevices(ASW_FLOW_RENDER, devices);
+
+            results.push_back(Measure("service:Ping", options, [&]
+                                      { client.ping(); }));
+            results.push_back(Measure("service:ListDevices", options, [&]
+                                      { client.listDevices(ASW_FLOW_RENDER, devices); }));
+            results.push_back(Measure("service:GetDefault", options, [&]
+                                      {
+                                          AswDevice device = 0;
+                                          client.getDefault(ASW_FLOW_RENDER, ASW_ROLE_CONSOLE, device); }));
+            if (mutate && devices.size() > 1)
+            {
+                size_t next = 0;
+                results.push_back(Measure("service:SetDefault", options, [&]
+                                          { client.setDefault(devices[next++ % devices.size()].handle); }));
+            }
+            client.disconnect();
+
+            const uint32_t perClient = options.iterations * 10;
+            serviceSummary.clients = options.clients;
+            serviceSummary.pipeline = options.pipeline;
+            serviceSummary.requests = static_cast<uint64_t>(options.clients) * perClient;
+            serviceSummary.requestsPerSecond = ServiceThroughput(config.endpoint, options.clients, options.pipeline, perClient);
+            serviceSummary.unpipelinedRequestsPerSecond = ServiceThroughput(config.endpoint, options.clients, 1, perClient);
+            std::fprintf(stderr, "service: %u clients x %u in flight: %.0f req/s (unpipelined %.0f req/s)\n",
+                         options.clients, options.pipeline, serviceSummary.requestsPerSecond,
+                         serviceSummary.unpipelinedRequestsPerSecond);
+        }
+        else
+        {
+            std::fprintf(stderr, "Cannot start the service on %s\n", config.endpoint.c_str());
+        }
+    }
+
+    // Shared-memory snapshot: read latency, then consistency under rapid republishing
+    SnapshotSummary snapshotSummary;
+    {
+        const std::string name = "AudioSwitcherBenchSnapshot";
+        Service::SnapshotPublisher publisher;
+        Service::SnapshotReader reader;
+        if (publisher.open(name) && publisher.start() && reader.open(name))
+        {
+            std::unique_ptr<Service::DeviceSnapshot> snapshot(new Service::DeviceSnapshot());
+            Service::SnapshotDevice device = {};
+            results.push_back(Measure("snapshot:generation", options, [&]
+                                      { reader.generation(); }));
+            results.push_back(Measure("snapshot:read", options, [&]
+                                      { reader.read(*snapshot); }));
+            results.push_back(Measure("snapshot:readDefault", options, [&]
+                                      { reader.readDefault(ASW_FLOW_RENDER, ASW_ROLE_CONSOLE, device); }));
+            if (mutate && outputs.size() > 1)
+            {
+                // Publisher latency: from a switch to the generation a reader sees. Start after the
+                // current default: switching to it changes nothing, so no generation would follow
+                IMMDevice *current = GetDefaultAudioPlaybackDevice();
+                const std::wstring currentId = GetDeviceId(current);
+                SafeRelease(current);
+                size_t next = 1;
+                for (size_t i = 0; i < outputs.size(); ++i)
+                    if (outputs[i].id == currentId)
+                        next = i + 1;
+                results.push_back(Measure("snapshot:setDefault->visible", options, [&]
+                                          {
+                                              const uint64_t generation = reader.generation();
+                                              AudioManager::setDefaultOutputDevice(outputs[next++ % outputs.size()].id);
+                                              while (reader.generation() == generation)
+                                                  std::this_thread::yield(); }));
+            }
+            publisher.stop();
+
+            snapshotSummary = SnapshotStress(publisher, name, options.clients, static_cast<uint64_t>(options.iterations) * 100);
+            std::fprintf(stderr, "snapshot: %u readers, %llu publishes, %llu reads, %llu torn, %llu failed\n",
+                         snapshotSummary.readers, static_cast<unsigned long long>(snapshotSummary.publishes),
+                         static_cast<unsigned long long>(snapshotSummary.reads),
+                         static_cast<unsigned long long>(snapshotSummary.tornReads),
+                         static_cast<unsigned long long>(snapshotSummary.failedReads));
+        }
+        else
+        {
+            std::fprintf(stderr, "Cannot publish snapshot %s\n", name.c_str());
+        }
+    }
+
+    // Audio sessions: PID-indexed table versus enumerating every endpoint per lookup
+    if (!outputs.empty())
+    {
+        constexpr DWORD kSessionProcesses = 32;
+        Backend::SimulatedSessionLatency latency;
+        latency.enumerateUs = options.latencyUs;
+        latency.sessionUs = options.latencyUs / 10;
+        latency.volumeUs = options.latencyUs / 10;
+        const auto sessions = std::make_shared<Backend::SimulatedSessionBackend>(latency);
+        for (DWORD pid = 1; pid <= kSessionProcesses; ++pid)
+            for (const AudioDevice &device : outputs)
+                sessions->addSession(device.id, 1000 + pid, L"app" + std::to_wstring(pid) + L".exe");
+
+        Devices::SessionTable table(sessions);
+        for (const AudioDevice &device : outputs)
+            table.attach(device.id);
+
+        DWORD next = 0;
+        results.push_back(Measure("sessions:enumerate+filter(pid)", options, [&]
+                                  {
+                                      const DWORD pid = 1001 + next++ % kSessionProcesses;
+                                      std::vector<Backend::SessionInfo> found;
+                                      for (const AudioDevice &device : outputs)
+                                          sessions->enumerateSessions(device.id, [&](const Backend::SessionInfo &session, const std::shared_ptr<Backend::ISessionVolume> &)
+                                                                      {
+                                                                          if (session.processId == pid)
+                                                                              found.push_back(session); });
+                                  }));
+        results.push_back(Measure("sessions:SessionTable::sessionsForProcess", options, [&]
+                                  { table.sessionsForProcess(1001 + next++ % kSessionProcesses); }));
+
+        bool mute = false;
+        results.push_back(Measure("sessions:enumerate+setMute(pid)", options, [&]
+                                  {
+                                      const DWORD pid = 1001 + next++ % kSessionProcesses;
+                                      mute = !mute;
+                                      for (const AudioDevice &device : outputs)
+                                          sessions->enumerateSessions(device.id, [&](const Backend::SessionInfo &session, const std::shared_ptr<Backend::ISessionVolume> &volume)
+                                                                      {
+                                                                          if (session.processId == pid)
+                                                                              volume->setMute(mute); });
+                                  }));
+        results.push_back(Measure("sessions:SessionTable::setProcessMute", options, [&]
+                                  {
+                                      mute = !mute;
+                                      table.setProcessMute(1001 + next++ % kSessionProcesses, mute); }));
+
+        const Devices::SessionTableStats stats = table.stats();
+        std::fprintf(stderr, "sessions: %zu sessions of %zu processes on %zu endpoints, %llu enumerations, %llu events\n",
+                     stats.sessions, stats.processes, stats.devices,
+                     static_cast<unsigned long long>(stats.enumerations), static_cast<unsigned long long>(stats.events));
+    }
+
+    // Scenes: ProfileManager::apply() versus the hand-coded switch sequence
+    ProfileSummary profileSummary;
+    const auto simulatedBackend = std::dynamic_pointer_cast<Backend::SimulatedBackend>(backend);
+    if (mutate && outputs.size() > 1 && inputs.size() > 1)
+    {
+        struct Scene
+        {
+            std::wstring output;
+            std::wstring input;
+            bool muted;
+            float volume;
+        };
+        const Scene scenes[2] = {{outputs[0].name, inputs[0].name, false, 0.8f},
+                                 {outputs[1].name, inputs[1].name, true, 0.5f}};
+
+        Devices::ProfileManager manager;
+        std::vector<Devices::AudioProfile> profiles(2);
+        for (size_t i = 0; i < 2; ++i)
+        {
+            profiles[i].name = i == 0 ? "desk" : "meeting";
+            for (ERole role : {eConsole, eMultimedia, eCommunications})
+            {
+                profiles[i].defaults[eRender][role].name = scenes[i].output;
+                profiles[i].defaults[eCapture][role].name = scenes[i].input;
+            }
+            Devices::ProfileEndpoint speakers;
+            speakers.device.name = outputs[0].name;
+            speakers.hasMute = true;
+            speakers.muted = scenes[i].muted;
+            speakers.hasVolume = true;
+            speakers.volume = scenes[i].volume;
+            profiles[i].endpoints.push_back(speakers);
+        }
+        manager.setProfiles(profiles);
+
+        // Backend calls per switch, when the backend can count them
+        auto countCalls = [&](const std::function<void()> &run)
+        {
+            const uint64_t before = simulatedBackend ? simulatedBackend->callCount() : 0;
+            run();
+            return simulatedBackend ? static_cast<double>(simulatedBackend->callCount() - before) : 0.0;
+        };
+
+        size_t scene = 0;
+        auto naiveSwitch = [&]
+        {
+            const Scene &target = scenes[scene++ % 2];
+            std::vector<AudioDevice> renders = AudioManager::listOutputDevices();
+            std::vector<AudioInputDevice> captures = AudioInputManager::listInputDevices();
+            for (const AudioDevice &device : renders)
+                if (device.name == target.output)
+                    AudioManager::setDefaultOutputDevice(device.id);
+            for (const AudioInputDevice &device : captures)
+                if (device.name == target.input)
+                    AudioInputManager::setDefaultInputDevice(device.id);
+            for (const AudioDevice &device : renders)
+            {
+                if (device.name == outputs[0].name)
+                {
+                    MuteDevice(device.device, target.muted);
+                    backend->setVolume(device.device, target.volume);
+                }
+            }
+        };
+        results.push_back(Measure("profiles:naive switch", options, naiveSwitch));
+        profileSummary.naiveCalls = countCalls(naiveSwitch);
+
+        if (SUCCEEDED(manager.start()))
+        {
+            auto applySwitch = [&]
+            { manager.apply(profiles[scene++ % 2].name); };
+            results.push_back(Measure("profiles:ProfileManager::apply switch", options, applySwitch));
+            profileSummary.applyCalls = countCalls(applySwitch);
+            results.push_back(Measure("profiles:ProfileManager::apply no-op", options, [&]
+                                      { manager.apply("desk"); }));
+            profileSummary.noopCalls = countCalls([&]
+                                                  { manager.apply("desk"); });
+            manager.apply("desk");
+            manager.stop();
+        }
+        std::fprintf(stderr, "profiles: backend calls per switch: naive %.0f, apply %.0f, no-op apply %.0f\n",
+                     profileSummary.naiveCalls, profileSummary.applyCalls, profileSummary.noopCalls);
+        MuteDevice(outputs[0].device, false);
+    }
+
+    // Switching rules: simulated headset arrival / removal to the rule's last action
+    if (const auto simulated = simulatedBackend)
+    {
+        Devices::DeviceRule arrival;
+        arrival.name = "headset arrives";
+        arrival.match.formFactor = Headset;
+        Devices::RuleAction communications;
+        communications.roles = Backend::RoleCommunications;
+        Devices::RuleAction muteSpeakers;
+        muteSpeakers.type = Devices::RuleActionType::Mute;
+        muteSpeakers.target.formFactor = Speakers;
+        arrival.actions = {communications, muteSpeakers};
+
+        Devices::DeviceRule removal;
+        removal.name = "headset leaves";
+        removal.trigger = Devices::RuleTrigger::Removal;
+        removal.match.formFactor = Headset;
+        Devices::RuleAction unmuteSpeakers = muteSpeakers;
+        unmuteSpeakers.type = Devices::RuleActionType::Unmute;
+        removal.actions = {unmuteSpeakers};
+
+        for (const std::wstring &id : simulated->deviceIds(eRender))
+            simulated->setFormFactor(id, Speakers);
+        const std::wstring headset = simulated->addDevice(eRender, L"USB Headset", Utility::DeviceFormatInfo(), std::wstring(), Headset);
+        Devices::RuleEngine engine;
+        if (!headset.empty() && SUCCEEDED(engine.start({arrival, removal})))
+        {
+            bool plugged = true;
+            results.push_back(Measure("rules:event->action", options, [&]
+                                      {
+                                          const uint64_t firings = engine.stats().firings;
+                                          plugged = !plugged;
+                                          simulated->setDeviceState(headset, plugged ? DEVICE_STATE_ACTIVE : DEVICE_STATE_UNPLUGGED);
+                                          while (engine.stats().firings == firings)
+                                              std::this_thread::yield(); }));
+
+            const Devices::RuleEngineStats stats = engine.stats();
+            std::fprintf(stderr, "rules: %llu firings, %llu actions (%llu failed), notification to last action mean %.1f us, max %.1f us\n",
+                         static_cast<unsigned long long>(stats.firings), static_cast<unsigned long long>(stats.actions),
+                         static_cast<unsigned long long>(stats.failures),
+                         stats.firings ? stats.totalLatencyNs / 1000.0 / static_cast<double>(stats.firings) : 0.0,
+                         stats.maxLatencyNs / 1000.0);
+            engine.stop();
+        }
+        simulated->removeDevice(headset);
+    }
+
+    // Device-name search: trigram index versus a substring scan of every name
+    {
+        static const wchar_t *const vendors[] = {L"Jabra", L"Sennheiser", L"Logitech", L"Focusrite", L"Realtek", L"NVIDIA",
+                                                 L"Bose", L"Sony", L"Razer", L"Shure", L"Elgato", L"Behringer"};
+        static const wchar_t *const models[] = {L"Evolve2 65", L"GSP 670", L"G Pro X", L"Scarlett 2i2", L"High Definition Audio",
+                                                L"QC45", L"WH-1000XM5", L"Kraken V3", L"MV7", L"Wave:3", L"UMC204HD"};
+        static const wchar_t *const kinds[] = {L"Speakers", L"Headphones", L"Microphone", L"Line In", L"HDMI Output",
+                                               L"\u00c9couteurs", L"Haut-parleurs", L"Casque d\u2019\u00e9coute", L"Lautsprecher"};
+        constexpr size_t nameCount = 5000;
+
+        std::vector<std::wstring> names;
+        names.reserve(nameCount);
+        for (size_t i = 0; i < nameCount; ++i)
+        {
+            names.push_back(std::wstring(kinds[i % 9]) + L" (" + vendors[(i / 9) % 12] + L" " + models[(i / 108) % 11] +
+                            L") #" + std::to_wstring(i));
+        }
+
+        Devices::DeviceNameIndex index;
+        for (size_t i = 0; i < names.size(); ++i)
+            index.add(L"{name." + std::to_wstring(i) + L"}", names[i]);
+
+        std::vector<std::string> lowered;
+        lowered.reserve(names.size());
+        for (const std::wstring &name : names)
+        {
+            std::string narrow = Utility::ToUtf8(name);
+            std::transform(narrow.begin(), narrow.end(), narrow.begin(), [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+            lowered.push_back(std::move(narrow));
+        }
+        auto scan = [&](const std::string &query)
+        {
+            size_t hits = 0;
+            for (const std::string &name : lowered)
+                hits += name.find(query) != std::string::npos;
+            return hits;
+        };
+
+        size_t sink = 0;
+        results.push_back(Measure("names:scan(\"evolve2\")", options, [&]
+                                  { sink += scan("evolve2"); }));
+        results.push_back(Measure("names:DeviceNameIndex::search(\"evolve2\")", options, [&]
+                                  { sink += index.search(L"evolve2").size(); }));
+        results.push_back(Measure("names:scan(\"scarlett 2i2 mic\")", options, [&]
+                                  { sink += scan("scarlett 2i2 mic"); }));
+        results.push_back(Measure("names:DeviceNameIndex::search(\"scarlett 2i2 mic\")", options, [&]
+                                  { sink += index.search(L"scarlett 2i2 mic").size(); }));
+        results.push_back(Measure("names:DeviceNameIndex::search(\"ecouteurs\")", options, [&]
+                                  { sink += index.search(L"ecouteurs").size(); }));
+        results.push_back(Measure("names:DeviceNameIndex::search(\"sennhiser\")", options, [&]
+                                  { sink += index.search(L"sennhiser").size(); }));
+        size_t next = 0;
+        results.push_back(Measure("names:DeviceNameIndex::add+remove", options, [&]
+                                  {
+                                      const std::wstring id = L"{extra." + std::to_wstring(next++) + L"}";
+                                      index.add(id, names[next % names.size()]);
+                                      index.remove(id); }));
+
+        const std::vector<Devices::NameMatch> accented = index.search(L"ecouteurs sony", 1);
+        const std::vector<Devices::NameMatch> typo = index.search(L"sennhiser gsp", 1);
+        std::fprintf(stderr, "names: %zu names; \"ecouteurs sony\" -> %s; \"sennhiser gsp\" -> %s (%zu)\n", index.size(),
+                     accented.empty() ? "(none)" : Utility::ToUtf8(accented[0].name).c_str(),
+                     typo.empty() ? "(none)" : Utility::ToUtf8(typo[0].name).c_str(), sink);
+    }
+
+    // Snapshot diffs: hashed linear diff versus comparing IDs pairwise
+    {
+        auto makeSnapshot = [](size_t count)
+        {
+            std::vector<Devices::DeviceRecord> records(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                Devices::DeviceRecord &record = records[i];
+                record.flow = i % 3 == 2 ? Devices::DeviceFlow::Capture : Devices::DeviceFlow::Render;
+                record.id = std::wstring(record.flow == Devices::DeviceFlow::Render ? L"{0.0.0.00000000}.{" : L"{0.0.1.00000000}.{") +
+                            std::to_wstring(0x5a3c0000u + i * 7919u) + L"-bb68-6f68-22eb-92502318fa4e}";
+                record.name = L"Speakers (Simulated Audio " + std::to_wstring(i + 1) + L")";
+                record.format.valid = true;
+                record.format.sampleRate = 48000;
+                record.format.channels = 2;
+                record.format.bitDepth = 32;
+                record.format.blockAlign = 8;
+                record.format.isFloat = true;
+            }
+            return records;
+        };
+        // 1% of the endpoints each: removed, added, unplugged, renamed, reformatted
+        auto churn = [](std::vector<Devices::DeviceRecord> records)
+        {
+            const size_t step = 100;
+            for (size_t i = 0; i < records.size(); i += step)
+            {
+                records[i].state = DEVICE_STATE_UNPLUGGED;
+                if (i + 1 < records.size())
+                    records[i + 1].name += L" (renamed)";
+                if (i + 2 < records.size())
+                    records[i + 2].format.sampleRate = 44100;
+                if (i + 3 < records.size())
+                    records[i + 3].id += L"-new";
+            }
+            return records;
+        };
+
+        const size_t count = 1000;
+        const std::vector<Devices::DeviceRecord> before = makeSnapshot(count);
+        const std::vector<Devices::DeviceRecord> after = churn(before);
+
+        size_t sink = 0;
+        results.push_back(Measure("diff:pairwise(1000)", options, [&]
+                                  {
+                                      for (const Devices::DeviceRecord &record : after)
+                                      {
+                                          auto it = std::find_if(before.begin(), before.end(), [&](const Devices::DeviceRecord &old)
+                                                                 { return old.id == record.id; });
+                                          sink += it == before.end() || *it != record;
+                                      }
+                                      for (const Devices::DeviceRecord &old : before)
+                                          sink += std::none_of(after.begin(), after.end(), [&](const Devices::DeviceRecord &record)
+                                                               { return record.id == old.id; }); }));
+        results.push_back(Measure("diff:DiffSnapshots(1000)", options, [&]
+                                  { sink += Devices::DiffSnapshots(before, after).changes.size(); }));
+        Devices::SnapshotDiffer differ;
+        bool flip = false;
+        results.push_back(Measure("diff:SnapshotDiffer::update(1000)", options, [&]
+                                  { sink += differ.update((flip = !flip) ? after : before).changes.size(); }));
+
+        const size_t largeCount = 200000;
+        const std::vector<Devices::DeviceRecord> largeBefore = makeSnapshot(largeCount);
+        std::vector<Devices::DeviceRecord> largeAfter = churn(largeBefore);
+        Devices::SnapshotDiffer large;
+        large.update(largeBefore);
+        const auto start = std::chrono::steady_clock::now();
+        const Devices::SnapshotDiff &diff = large.update(std::move(largeAfter));
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::fprintf(stderr, "diff: %zu records in %.1f ms (%.1f M records/s): %zu added, %zu removed, %zu state, %zu renamed, %zu format, %zu unchanged (%zu)\n",
+                     largeCount, seconds * 1000.0, static_cast<double>(largeCount) / seconds / 1e6,
+                     diff.count(Devices::DeviceAdded), diff.count(Devices::DeviceRemoved),
+                     diff.count(Devices::DeviceStateChanged), diff.count(Devices::DeviceRenamed),
+                     diff.count(Devices::DeviceFormatChanged), diff.unchanged, sink);
+    }
+
+    // Device states: full-state listing and notification-driven waits for a scripted jack
+    if (const auto simulated = simulatedBackend)
+    {
+        results.push_back(Measure("states:AudioManager::listOutputDevices(all)", options, []
+                                  { AudioManager::listOutputDevices(DEVICE_STATEMASK_ALL); }));
+
+        const std::wstring jack = simulated->addDevice(eRender, L"Line Out (Rear Jack)");
+        simulated->setDeviceState(jack, DEVICE_STATE_UNPLUGGED);
+        Devices::DeviceStateTracker tracker;
+        if (!jack.empty() && SUCCEEDED(tracker.start()))
+        {
+            results.push_back(Measure("states:DeviceStateTracker::devices", options, [&]
+                                      { tracker.devices(); }));
+
+            // Round r waits for the state the r-th toggle produces: odd rounds plug in, even rounds unplug
+            std::atomic<uint64_t> round{0};
+            std::atomic<uint64_t> seen{0};
+            std::atomic<bool> done{false};
+            std::thread waiter([&]
+                               {
+                                   for (uint64_t r = 1; !done.load(); ++r)
+                                   {
+                                       const DWORD wanted = r % 2 ? DEVICE_STATE_ACTIVE : DEVICE_STATE_UNPLUGGED;
+                                       while (!done.load() && !tracker.waitForDevice([&](const Devices::DeviceRecord &device)
+                                                                                     { return device.id == jack && device.state == wanted; },
+                                                                                     std::chrono::milliseconds(100)))
+                                       {
+                                       }
+                                       seen.store(r);
+                                   } });
+
+            const Devices::DeviceTrackerStats before = tracker.stats();
+            results.push_back(Measure("states:plug/unplug->waitForDevice", options, [&]
+                                      {
+                                          const uint64_t r = ++round;
+                                          simulated->setDeviceState(jack, r % 2 ? DEVICE_STATE_ACTIVE : DEVICE_STATE_UNPLUGGED);
+                                          while (seen.load() != r)
+                                              std::this_thread::yield(); }));
+            const Devices::DeviceTrackerStats after = tracker.stats();
+            done.store(true);
+            waiter.join();
+
+            std::fprintf(stderr, "states: %llu toggles detected from %llu notifications with %llu enumerations; plug to wake mean %.1f us, p99 %.1f us\n",
+                         static_cast<unsigned long long>(round.load()),
+                         static_cast<unsigned long long>(after.notifications - before.notifications),
+                         static_cast<unsigned long long>(after.enumerations - before.enumerations),
+                         results.back().meanNs / 1000.0, results.back().p99Ns / 1000.0);
+            tracker.stop();
+        }
+        simulated->removeDevice(jack);
+    }
+
+    // Signal processing: throughput as inputs and streams grow, and the VAD's cost per analysis frame
+    constexpr uint32_t dspRate = 48000;
+    constexpr size_t dspPeriod = 480; // 10 ms
+    std::vector<float> signal(dspPeriod * 18); // Enough for every speaker position
+    {
+        uint32_t noise = static_cast<uint32_t>(options.seed) | 1;
+        for (size_t i = 0; i < signal.size(); ++i)
+        {
+            noise ^= noise << 13;
+            noise ^= noise >> 17;
+            noise ^= noise << 5;
+            signal[i] = 0.25f * std::sin(0.0576f * static_cast<float>(i)) + 0.1f * (static_cast<float>(noise) / 4294967296.0f - 0.5f);
+        }
+    }
+    Utility::DeviceFormatInfo stereoFloat;
+    stereoFloat.bitDepth = 32;
+    stereoFloat.channels = 2;
+    stereoFloat.blockAlign = 8;
+    stereoFloat.sampleRate = dspRate;
+    stereoFloat.channelMask = Dsp::Layout::Stereo;
+    stereoFloat.isFloat = true;
+    stereoFloat.valid = true;
+
+    // Input frames mixed (or analysed) per second, in millions, for one entry of each size
+    auto throughput = [&](const char *label, const std::vector<uint32_t> &sizes)
+    {
+        std::string line;
+        for (size_t i = 0; i < sizes.size(); ++i)
+        {
+            const Result &result = results[results.size() - sizes.size() + i];
+            char entry[32];
+            std::snprintf(entry, sizeof(entry), " %u:%.1f", sizes[i], sizes[i] * dspPeriod / result.meanNs * 1e3);
+            line += entry;
+        }
+        std::fprintf(stderr, "%s (M frames/s):%s\n", label, line.c_str());
+    };
+
+    {
+        const std::vector<uint32_t> inputCounts = {2, 4, 8, 16, 32, 64};
+        Dsp::MultiSourceMixer mixer;
+        if (mixer.configure(inputCounts.back(), 2, dspPeriod, dspRate))
+        {
+            for (uint32_t i = 0; i < inputCounts.back(); ++i)
+            {
+                std::copy(signal.begin(), signal.begin() + dspPeriod * 2, mixer.input(i));
+                mixer.setGain(i, 0.5f, true);
+            }
+            mixer.setSoftClip(true);
+            std::vector<float> mixed(dspPeriod * 2);
+            for (uint32_t inputs : inputCounts)
+            {
+                const std::string name = "mixer:mix(" + std::to_string(inputs) + " inputs)";
+                results.push_back(Measure(name.c_str(), options, [&]
+                                          { mixer.mix(mixed.data(), dspPeriod, inputs); }));
+            }
+            throughput("mixer: inputs", inputCounts);
+        }
+
+        // A layout has at most 18 speaker positions, so the matrix grows by source channels
+        const uint32_t allSpeakers = 0x3ffff;
+        const uint32_t layouts[][2] = {{Dsp::Layout::Mono, Dsp::Layout::Stereo},
+                                       {Dsp::Layout::Stereo, Dsp::Layout::FivePointOne},
+                                       {Dsp::Layout::FivePointOne, Dsp::Layout::Stereo},
+                                       {Dsp::Layout::SevenPointOneSurround, Dsp::Layout::Stereo},
+                                       {allSpeakers, Dsp::Layout::Stereo}};
+        std::vector<uint32_t> sourceChannels;
+        std::vector<float> converted(dspPeriod * 18);
+        for (const auto &layout : layouts)
+        {
+            Dsp::ChannelMatrix matrix;
+            if (!matrix.build(layout[0], layout[1]))
+                continue;
+            const std::string name = "matrix:process(" + std::to_string(matrix.srcChannels()) + "->" +
+                                     std::to_string(matrix.dstChannels()) + " ch)";
+            results.push_back(Measure(name.c_str(), options, [&]
+                                      { matrix.process(signal.data(), converted.data(), dspPeriod); }));
+            sourceChannels.push_back(matrix.srcChannels());
+        }
+        std::fprintf(stderr, "matrix: up to %u source channels (every speaker position)\n",
+                     sourceChannels.empty() ? 0u : sourceChannels.back());
+    }
+
+    {
+        const std::vector<uint32_t> streamCounts = {1, 2, 4, 8, 16, 32};
+        std::vector<Dsp::LevelMeter> meters(streamCounts.back());
+        for (Dsp::LevelMeter &meter : meters)
+            meter.configure(stereoFloat);
+        for (uint32_t streams : streamCounts)
+        {
+            const std::string name = "meter:process(" + std::to_string(streams) + " streams)";
+            results.push_back(Measure(name.c_str(), options, [&]
+                                      {
+                                          for (uint32_t s = 0; s < streams; ++s)
+                                              meters[s].process(signal.data(), dspPeriod); }));
+        }
+        throughput("meter: streams", streamCounts);
+
+        std::vector<Dsp::SpectrumAnalyzer> analyzers(streamCounts.back());
+        for (Dsp::SpectrumAnalyzer &analyzer : analyzers)
+            analyzer.configure(Dsp::SpectrumConfig(), dspRate, dspPeriod);
+        for (uint32_t streams : streamCounts)
+        {
+            const std::string name = "spectrum:push(" + std::to_string(streams) + " streams)";
+            results.push_back(Measure(name.c_str(), options, [&]
+                                      {
+                                          for (uint32_t s = 0; s < streams; ++s)
+                                              analyzers[s].push(signal.data(), dspPeriod, 2); }));
+        }
+        throughput("spectrum: streams", streamCounts);
+    }
+
+    {
+        Dsp::VoiceActivityDetector vad;
+        if (vad.configure(dspRate))
+        {
+            const size_t frame = vad.frameSamples();
+            size_t position = 0;
+            results.push_back(Measure("vad:push(one frame)", options, [&]
+                                      {
+                                          vad.push(signal.data() + position, frame);
+                                          position = (position + frame) % (signal.size() - frame); }));
+            const double frameNs = frame * 1e9 / dspRate;
+            std::fprintf(stderr, "vad: %zu-sample frames (%.1f ms), %.2f us each, %.3f%% of real time\n", frame,
+                         frameNs / 1e6, results.back().meanNs / 1000.0, 100.0 * results.back().meanNs / frameNs);
+        }
+    }
+
+    // Streaming: recorder write cost and disk throughput, player latency from enqueue() to the first period
+    {
+        std::error_code ignored;
+        const std::filesystem::path wav = std::filesystem::temp_directory_path() / "audioswitcher-bench-recording.wav";
+        const std::filesystem::path bulk = std::filesystem::temp_directory_path() / "audioswitcher-bench-bulk.wav";
+
+        Streaming::WavRecorder recorder;
+        if (recorder.open(wav, stereoFloat))
+        {
+            results.push_back(Measure("recorder:write(10 ms)", options, [&]
+                                      { recorder.write(signal.data(), dspPeriod); }));
+            recorder.close();
+        }
+
+        // Keep the pool fed for 64 MiB; close() returns once everything is on disk
+        constexpr uint64_t bulkBytes = 64ull << 20;
+        Streaming::WavRecorder bulkRecorder;
+        if (bulkRecorder.open(bulk, stereoFloat))
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (uint64_t queued = 0; queued < bulkBytes;)
+            {
+                if (bulkRecorder.writableFrames() < dspPeriod)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                queued += bulkRecorder.write(signal.data(), dspPeriod) * stereoFloat.blockAlign;
+            }
+            bulkRecorder.close();
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::fprintf(stderr, "recorder: %.0f MB/s to %s (%llu frames dropped, %llu write errors)\n",
+                         bulkRecorder.bytesWritten() / seconds / 1e6, bulk.string().c_str(),
+                         static_cast<unsigned long long>(bulkRecorder.droppedFrames()),
+                         static_cast<unsigned long long>(bulkRecorder.writeErrors()));
+            std::filesystem::remove(bulk, ignored);
+        }
+
+        // The same file into a sink of its own format (zero-copy) and into 5.1 at 44.1 kHz (converted)
+        Utility::DeviceFormatInfo surround = stereoFloat;
+        surround.channels = 6;
+        surround.blockAlign = 24;
+        surround.sampleRate = 44100;
+        surround.channelMask = Dsp::Layout::FivePointOne;
+        DiscardSink directSink(stereoFloat, dspPeriod);
+        DiscardSink convertingSink(surround, dspPeriod);
+        const std::pair<const char *, DiscardSink *> sinks[] = {{"player:enqueue->first period (direct)", &directSink},
+                                                                {"player:enqueue->first period (converted)", &convertingSink}};
+        for (const auto &entry : sinks)
+        {
+            Streaming::WavPlayer player;
+            if (!player.open(entry.second, dspPeriod) || !player.enqueue(wav))
+            {
+                std::fprintf(stderr, "player: cannot play %s, skipped\n", wav.string().c_str());
+                break;
+            }
+            player.stop();
+            player.pump();
+            results.push_back(Measure(entry.first, options, [&]
+                                      {
+                                          if (player.enqueue(wav))
+                                              while (player.pump() == 0)
+                                              {
+                                              } },
+                                      [&]
+                                      {
+                                          player.stop();
+                                          player.pump(); }));
+        }
+        std::filesystem::remove(wav, ignored);
+    }
+
+    // Device directory: first lookup after start() without a cache file (live enumeration) and with one
+    {
+        std::error_code ignored;
+        const std::filesystem::path cache = std::filesystem::temp_directory_path() / "audioswitcher-bench-devices.cache";
+        std::filesystem::remove(cache, ignored);
+
+        const std::wstring id = outputs[0].id;
+        Devices::DeviceDirectory directory;
+        Devices::DeviceRecord record;
+        results.push_back(Measure("directory:cold start->find", options, [&]
+                                  {
+                                      directory.start(cache, EnumerateBackendDevices);
+                                      directory.waitReconciled(std::chrono::seconds(5));
+                                      directory.find(id, record); },
+                                  [&]
+                                  {
+                                      directory.stop();
+                                      std::filesystem::remove(cache, ignored); }));
+        const double coldNs = results.back().meanNs;
+
+        directory.start(cache, EnumerateBackendDevices);
+        directory.waitReconciled(std::chrono::seconds(5));
+        directory.stop();
+        results.push_back(Measure("directory:cached start->find", options, [&]
+                                  {
+                                      directory.start(cache, EnumerateBackendDevices);
+                                      directory.find(id, record); },
+                                  [&]
+                                  { directory.stop(); }));
+        const Devices::DeviceDirectoryStats stats = directory.stats();
+        results.push_back(Measure("directory:find", options, [&]
+                                  { directory.find(id, record); }));
+
+        std::fprintf(stderr, "directory: %zu devices; first lookup cold %.1f us, cached %.1f us (cache %s, live enumeration %.3f ms)\n",
+                     directory.devices().size(), coldNs / 1000.0, results[results.size() - 2].meanNs / 1000.0,
+                     stats.cacheStatus == Devices::CacheStatus::Loaded ? "loaded" : "not loaded", stats.enumerateMs);
+        std::filesystem::remove(cache, ignored);
+    }
+
+    // Instrumentation: one backend call bare, through AUDIO_SWITCHER_TIME_CALL and under an explicit ScopedTimer.
+    // The macro compiles to the bare call without AUDIO_SWITCHER_INSTRUMENTATION; compare two builds for on/off.
+    {
+        const uint32_t operation = RegisterTimedOperation("bench:GetDeviceFriendlyName(scoped)");
+        results.push_back(Measure("instrumentation:bare call", options, [&outputs]
+                                  { GetDeviceFriendlyName(outputs[0].device); }));
+        const double bareNs = results.back().meanNs;
+        results.push_back(Measure("instrumentation:AUDIO_SWITCHER_TIME_CALL", options, [&outputs]
+                                  { AUDIO_SWITCHER_TIME_CALL("bench:GetDeviceFriendlyName", GetDeviceFriendlyName(outputs[0].device)); }));
+        const double macroNs = results.back().meanNs;
+        results.push_back(Measure("instrumentation:ScopedTimer", options, [&]
+                                  {
+                                      const ScopedTimer timer(operation);
+                                      GetDeviceFriendlyName(outputs[0].device); }));
+        std::fprintf(stderr, "instrumentation: %s; TIME_CALL %+.0f ns, ScopedTimer %+.0f ns per call over the bare call\n",
+                     InstrumentationEnabled() ? "compiled in" : "compiled out", macroNs - bareNs,
+                     results.back().meanNs - bareNs);
+        ResetInstrumentation();
+    }
+
+    // Format probing: cold matrix probes of simulated endpoints one at a time and in parallel, then from the cache
+    {
+        // IsFormatSupported is slow on real drivers; each fake query sleeps like one
+        const size_t count = 8;
+        const std::chrono::microseconds callLatency(std::max<uint32_t>(options.latencyUs, 20));
+        std::vector<std::unique_ptr<Devices::FakeFormatQuery>> owned;
+        std::vector<Devices::IFormatQuery *> devices;
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto device = std::make_unique<Devices::FakeFormatQuery>(L"{0.0.0.00000000}.{probe-" + std::to_wstring(i) + L"}");
+            device->exclusive.sampleRates = {44100, 48000, 96000};
+            device->exclusive.channelCounts = {2};
+            device->exclusive.sampleTypes = {Devices::SampleType{16, 16, false}, Devices::SampleType{32, 24, false}};
+            device->callLatency = callLatency;
+            devices.push_back(device.get());
+            owned.push_back(std::move(device));
+        }
+
+        // A cold probe of the full default grid runs hundreds of queries per device
+        Options coldOptions = options;
+        coldOptions.iterations = std::min<uint32_t>(options.iterations, 10);
+        coldOptions.warmup = std::min<uint32_t>(options.warmup, 1);
+
+        const Devices::FormatProbeSpec spec;
+        size_t sink = 0;
+        results.push_back(Measure("probe:cold serial(8)", coldOptions, [&]
+                                  { sink += Devices::FormatProber(1).probe(devices, spec).size(); }));
+        const double serialNs = results.back().meanNs;
+        results.push_back(Measure("probe:cold parallel(8)", coldOptions, [&]
+                                  { sink += Devices::FormatProber().probe(devices, spec).size(); }));
+        const double parallelNs = results.back().meanNs;
+
+        Devices::FormatCache cache;
+        const Devices::FormatProber prober;
+        prober.probe(devices, spec, &cache);
+        const uint64_t callsBefore = owned[0]->calls();
+        size_t fromCache = 0;
+        results.push_back(Measure("probe:cached(8)", options, [&]
+                                  {
+                                      for (const Devices::FormatCapabilities &caps : prober.probe(devices, spec, &cache))
+                                          fromCache += caps.fromCache; }));
+
+        std::fprintf(stderr, "probe: %zu devices x %zu queries at %lld us each; cold serial %.1f ms, parallel %.1f ms (%.1fx); cached %.1f us, %s (%zu)\n",
+                     count, 2 * spec.cellCount(), static_cast<long long>(callLatency.count()), serialNs / 1e6,
+                     parallelNs / 1e6, serialNs / parallelNs, results.back().meanNs / 1000.0,
+                     owned[0]->calls() == callsBefore ? "no queries" : "QUERIED", sink + fromCache);
+    }
+
+    // Format negotiation: the common format of 12, 24 and 48 synthetic endpoints, shared and exclusive
+    {
+        // Default grid; exclusive sets drawn from what USB, HDMI and onboard endpoints typically accept
+        const Devices::FormatProbeSpec spec;
+        static const uint32_t rates[] = {44100, 48000, 88200, 96000, 176400, 192000};
+        static const uint16_t channelCounts[] = {2, 6, 8};
+        static const Devices::SampleType types[] = {Devices::SampleType{16, 16, false}, Devices::SampleType{24, 24, false},
+                                                    Devices::SampleType{32, 24, false}, Devices::SampleType{32, 32, true}};
+        uint32_t noise = static_cast<uint32_t>(options.seed) | 1;
+        auto random = [&noise](uint32_t range)
+        {
+            noise ^= noise << 13;
+            noise ^= noise >> 17;
+            noise ^= noise << 5;
+            return noise % range;
+        };
+        auto accept = [&spec](std::vector<uint8_t> &flags, uint32_t rate, uint16_t channels, const Devices::SampleType &type)
+        {
+            const std::ptrdiff_t index = spec.indexOf(rate, channels, type);
+            if (index >= 0)
+                flags[static_cast<size_t>(index)] = 1;
+        };
+        auto makeDevices = [&](size_t count)
+        {
+            std::vector<Devices::FormatCapabilities> devices(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                Devices::FormatCapabilities &caps = devices[i];
+                caps.deviceId = L"{0.0.0.00000000}.{negotiate-" + std::to_wstring(i) + L"}";
+                caps.spec = spec;
+                caps.valid = true;
+                caps.shared.assign(spec.cellCount(), 0);
+                caps.exclusive.assign(spec.cellCount(), 0);
+
+                // Shared mode: the mix format only, at 44.1 or 48 kHz (stereo or the speaker layout)
+                const uint16_t mixChannels = channelCounts[random(2) ? 0 : 1 + random(2)];
+                caps.mixFormat = Devices::MakeFormat(random(4) ? 48000 : 44100, mixChannels, types[3]);
+                accept(caps.shared, caps.mixFormat.sampleRate, mixChannels, types[3]);
+
+                // Exclusive mode: a contiguous run of rates, the mix channel count, one to three integer types
+                const uint32_t firstRate = random(3);
+                const uint32_t lastRate = firstRate + 1 + random(static_cast<uint32_t>(std::size(rates)) - firstRate - 1);
+                const uint32_t firstType = random(3);
+                for (uint32_t r = firstRate; r <= lastRate; ++r)
+                    for (uint32_t t = firstType; t < 3; ++t)
+                        accept(caps.exclusive, rates[r], mixChannels, types[t]);
+            }
+            return devices;
+        };
+
+        const Devices::FormatNegotiator negotiator;
+        for (size_t count : {12, 24, 48})
+        {
+            const std::vector<Devices::FormatCapabilities> devices = makeDevices(count);
+            for (Devices::ShareMode mode : {Devices::ShareMode::Shared, Devices::ShareMode::Exclusive})
+            {
+                const std::string name = std::string("negotiate:") + (mode == Devices::ShareMode::Shared ? "shared(" : "exclusive(") +
+                                         std::to_string(count) + ")";
+                Devices::NegotiationResult result;
+                results.push_back(Measure(name.c_str(), options, [&]
+                                          { result = negotiator.negotiate(devices, mode); }));
+                size_t passthrough = 0;
+                for (const Devices::ConversionPlan &plan : result.plans)
+                    passthrough += plan.passthrough();
+                std::fprintf(stderr, "%s: %s %u Hz, %u ch, %u bit%s; %zu of %zu passthrough, cost %.1f, %zu candidates\n",
+                             name.c_str(), result.valid ? "common" : "no common format", result.format.sampleRate,
+                             result.format.channels, result.sampleType.validBits, result.sampleType.isFloat ? " float" : "",
+                             passthrough, count, result.totalCost, result.candidatesEvaluated);
+            }
+        }
+    }
+
+    // Batch CLI: N commands in one process versus N process launches
+    CliSummary cliSummary;
+    {
+        std::filesystem::path cli = options.cli;
+        if (cli.empty())
+        {
+            std::error_code ignored;
+            cli = std::filesystem::absolute(argv[0], ignored).parent_path() / "AudioSwitcherCli";
+#if defined(_WIN32)
+            cli += ".exe";
+#endif
+        }
+        if (std::filesystem::exists(cli))
+        {
+            cliSummary = CliComparison(options, cli.string(), std::min<uint32_t>(options.iterations, 200));
+            std::fprintf(stderr, "cli: %u commands in one process %.1f ms, one process each %.1f ms\n",
+                         cliSummary.commands, cliSummary.singleProcessMs, cliSummary.perProcessMs);
+        }
+        else
+        {
+            std::fprintf(stderr, "cli: %s not found, skipped\n", cli.string().c_str());
+        }
+    }
+
+    // Recording overhead: the same calls through a TracingBackend
+    const auto writer = std::make_shared<Backend::TraceWriter>();
+    Backend::SetAudioBackend(std::make_shared<Backend::TracingBackend>(backend, writer));
+    results.push_back(Measure("traced:AudioManager::listOutputDevices", options, []
+                              { AudioManager::listOutputDevices(); }));
+    results.push_back(Measure("traced:GetDefaultAudioPlaybackDevice", options, []
+                              {
+                                  IMMDevice *device = GetDefaultAudioPlaybackDevice();
+                                  SafeRelease(device); }));
+    results.push_back(Measure("traced:GetDeviceFriendlyName", options, [&outputs]
+                              { GetDeviceFriendlyName(outputs[0].device); }));
+    results.push_back(Measure("traced:GetDeviceFormatInfo", options, [&outputs]
+                              { GetDeviceFormatInfo(outputs[0].device); }));
+    if (mutate)
+    {
+        size_t next = 0;
+        results.push_back(Measure("traced:AudioManager::setDefaultOutputDevice", options, [&]
+                                  { AudioManager::setDefaultOutputDevice(outputs[next++ % outputs.size()].id); }));
+        bool mute = false;
+        results.push_back(Measure("traced:MuteDevice", options, [&]
+                                  { MuteDevice(outputs[0].device, mute = !mute); }));
+        MuteDevice(outputs[0].device, false);
+    }
+    Backend::SetAudioBackend(backend);
+
+    TraceSummary trace;
+    trace.records = writer->recordCount();
+    trace.bytes = writer->byteSize();
+    if (!options.traceOut.empty() && !writer->save(options.traceOut))
+        std::fprintf(stderr, "Cannot write %s\n", options.traceOut.c_str());
+
+    std::FILE *file = OpenOutput(options);
+    if (!file)
+        return 1;
+    WriteJson(file, backend->name(), options, results, trace, serviceSummary, snapshotSummary, cliSummary, profileSummary);
+    if (file != stdout)
+        std::fclose(file);
+
+    return 0;
+}
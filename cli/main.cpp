@@ -0,0 +1,904 @@
+// AudioSwitcherCli: non-interactive device control for scripts and automation.
+//
+// Runs a sequence of commands in one process on one warm AswContext and writes
+// one JSON object per line (JSON Lines) for every command result and event:
+//
+//   AudioSwitcherCli list render
+//   AudioSwitcherCli -c "switch Headphones; mute Speakers on; volume Speakers 0.4"
+//   AudioSwitcherCli -f script.txt
+//   producer | AudioSwitcherCli            (commands read from stdin as they arrive)
+//
+// Commands (a device is a handle, an endpoint ID, or a unique part of its name):
+//
+//   list [render|capture|all]
+//   default [render|capture] [console|multimedia|communications]
+//   status DEVICE
+//   switch DEVICE [console|multimedia|communications|all]
+//   mute DEVICE [on|off|toggle]
+//   unmute DEVICE
+//   volume DEVICE [LEVEL]                   (0..1; prints the level when omitted)
+//   wait-for-device DEVICE [TIMEOUT_MS]     (until it is present and active)
+//   watch [SECONDS]                         (stream events; until Ctrl+C without SECONDS)
+//   sleep MS
+//
+// Exit code: 0 if every command succeeded, 1 if one failed (execution stops at
+// the first failure unless --keep-going), 2 for bad usage.
+
+#include "AudioSwitcher/AudioSwitcherC.h"
+#include "Backend/AudioBackend.h"
+#include "Backend/SimulatedBackend.h"
+#include "Devices/DeviceNameIndex.h"
+#include "Utility/COMInitializer.h"
+#include "Utility/StringConvert.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    std::atomic<bool> g_interrupted{false};
+
+    void OnSignal(int)
+    {
+        g_interrupted.store(true);
+    }
+
+    /**
+     * @brief Lets Ctrl+C end a watch or a wait instead of the process, while in scope.
+     */
+    class InterruptScope
+    {
+    public:
+        InterruptScope()
+        {
+            g_interrupted.store(false);
+            std::signal(SIGINT, OnSignal);
+            std::signal(SIGTERM, OnSignal);
+        }
+
+        ~InterruptScope()
+        {
+            std::signal(SIGINT, SIG_DFL);
+            std::signal(SIGTERM, SIG_DFL);
+        }
+
+        InterruptScope(const InterruptScope &) = delete;
+        InterruptScope &operator=(const InterruptScope &) = delete;
+    };
+
+    /**
+     * @brief Quotes a command-line word so Tokenize() gives it back unchanged.
+     */
+    std::string Quote(const std::string &word)
+    {
+        std::string quoted = "\"";
+        for (char c : word)
+        {
+            if (c == '"' || c == '\\')
+                quoted.push_back('\\');
+            quoted.push_back(c);
+        }
+        return quoted + "\"";
+    }
+
+    constexpr const char *kFlowNames[] = {"render", "capture"};
+    constexpr const char *kRoleNames[] = {"console", "multimedia", "communications"};
+    constexpr const char *kEventNames[] = {"device_added", "device_removed", "state_changed", "default_changed",
+                                           "volume_changed"};
+    constexpr int64_t kWaitForDeviceDefaultMs = 30000;
+    constexpr int32_t kErrorTimeout = static_cast<int32_t>(0x800705B4);   // HRESULT_FROM_WIN32(ERROR_TIMEOUT)
+    constexpr int32_t kErrorCancelled = static_cast<int32_t>(0x800704C7); // HRESULT_FROM_WIN32(ERROR_CANCELLED)
+
+    /**
+     * @brief Parses a whole argument as a non-negative count of milliseconds.
+     */
+    bool ParseMilliseconds(const std::string &text, int64_t &ms)
+    {
+        char *end = nullptr;
+        errno = 0;
+        const long long value = std::strtoll(text.c_str(), &end, 10);
+        if (end == text.c_str() || *end || errno == ERANGE || value < 0)
+            return false;
+        ms = static_cast<int64_t>(value);
+        return true;
+    }
+
+    /**
+     * @brief now + `ms`, saturating at the latest representable time instead of overflowing.
+     */
+    std::chrono::steady_clock::time_point DeadlineAfter(int64_t ms)
+    {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point now = Clock::now();
+        const int64_t remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::time_point::max() - now).count();
+        if (ms >= remainingMs)
+            return Clock::time_point::max();
+        return now + std::chrono::milliseconds(ms);
+    }
+
+    struct Options
+    {
+#if defined(_WIN32)
+        bool platform = true;
+#else
+        bool platform = false;
+#endif
+        uint32_t renderDevices = 4;
+        uint32_t captureDevices = 2;
+        bool keepGoing = false;
+        std::vector<std::string> commands; ///< From -c and positional words
+        std::string script;                ///< -f FILE ("-" = stdin)
+    };
+
+    void PrintUsage()
+    {
+        std::fprintf(stderr,
+                     "Usage: AudioSwitcherCli [options] [COMMAND ARGS...]\n"
+                     "  -c \"CMD; CMD...\"        Run commands (repeatable)\n"
+                     "  -f FILE                 Run commands from a file, one per line (- = stdin)\n"
+                     "  --keep-going            Continue after a failed command\n"
+                     "  --backend simulated|platform, --devices N, --inputs N\n"
+                     "Without commands, reads them from stdin.\n"
+                     "Commands: list, default, status, switch, mute, unmute, volume,\n"
+                     "          wait-for-device, watch, sleep\n");
+    }
+
+    std::string JsonEscape(const std::string &text)
+    {
+        std::string out;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out.push_back('\\');
+                out.push_back(c);
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+                out += buffer;
+            }
+            else
+            {
+                out.push_back(c);
+            }
+        }
+        return out;
+    }
+
+    std::string Lower(std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+        return text;
+    }
+
+    /**
+     * @brief Splits a command line into words; double quotes group, backslash escapes inside quotes.
+     */
+    std::vector<std::string> Tokenize(const std::string &line)
+    {
+        std::vector<std::string> words;
+        std::string word;
+        bool inWord = false;
+        bool quoted = false;
+        for (size_t i = 0; i < line.size(); ++i)
+        {
+            const char c = line[i];
+            if (quoted)
+            {
+                if (c == '\\' && i + 1 < line.size())
+                    word.push_back(line[++i]);
+                else if (c == '"')
+                    quoted = false;
+                else
+                    word.push_back(c);
+            }
+            else if (c == '"')
+            {
+                quoted = inWord = true;
+            }
+            else if (std::isspace(static_cast<unsigned char>(c)))
+            {
+                if (inWord)
+                    words.push_back(word);
+                word.clear();
+                inWord = false;
+            }
+            else
+            {
+                word.push_back(c);
+                inWord = true;
+            }
+        }
+        if (inWord)
+            words.push_back(word);
+        return words;
+    }
+
+    /**
+     * @brief Splits a -c argument at semicolons outside quotes.
+     */
+    std::vector<std::string> SplitCommands(const std::string &text)
+    {
+        std::vector<std::string> commands;
+        std::string current;
+        bool quoted = false;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            const char c = text[i];
+            if (c == '"' && (i == 0 || text[i - 1] != '\\'))
+                quoted = !quoted;
+            if (c == ';' && !quoted)
+            {
+                commands.push_back(current);
+                current.clear();
+            }
+            else
+            {
+                current.push_back(c);
+            }
+        }
+        commands.push_back(current);
+        return commands;
+    }
+
+    bool ParseOptions(int argc, char **argv, Options &options)
+    {
+        std::string positional;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (!positional.empty())
+            {
+                positional += " " + Quote(arg);
+            }
+            else if (arg == "-c" && hasValue)
+            {
+                for (const std::string &command : SplitCommands(argv[++i]))
+                    options.commands.push_back(command);
+            }
+            else if (arg == "-f" && hasValue)
+                options.script = argv[++i];
+            else if (arg == "--keep-going")
+                options.keepGoing = true;
+            else if (arg == "--backend" && hasValue)
+            {
+                const std::string backend = argv[++i];
+                if (backend != "simulated" && backend != "platform")
+                    return false;
+                options.platform = backend == "platform";
+            }
+            else if (arg == "--devices" && hasValue)
+                options.renderDevices = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--inputs" && hasValue)
+                options.captureDevices = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg.size() > 1 && arg[0] == '-')
+                return false;
+            else
+                positional = arg; // The command word; the rest are its arguments
+        }
+        if (!positional.empty())
+            options.commands.push_back(positional);
+        return true;
+    }
+
+    /**
+     * @brief One warm context plus the JSON Lines writer and the event queue.
+     */
+    class Cli
+    {
+    public:
+        explicit Cli(AswContext *context) : m_context(context)
+        {
+            AswSetEventCallback(m_context, &Cli::onEvent, this);
+        }
+
+        ~Cli()
+        {
+            AswSetEventCallback(m_context, nullptr, nullptr);
+        }
+
+        // Registered as the context's callback target: not copyable
+        Cli(const Cli &) = delete;
+        Cli &operator=(const Cli &) = delete;
+
+        /**
+         * @brief Runs one command line; false if it failed.
+         */
+        bool run(const std::string &line)
+        {
+            const std::vector<std::string> words = Tokenize(line);
+            if (words.empty() || words[0][0] == '#')
+                return true;
+
+            const std::string command = Lower(words[0]);
+            const std::vector<std::string> args(words.begin() + 1, words.end());
+            if (command == "list")
+                return list(command, args);
+            if (command == "default")
+                return getDefault(command, args);
+            if (command == "status")
+                return status(command, args);
+            if (command == "switch")
+                return switchDefault(command, args);
+            if (command == "mute" || command == "unmute")
+                return mute(command, args);
+            if (command == "volume")
+                return volume(command, args);
+            if (command == "wait-for-device")
+                return waitForDevice(command, args);
+            if (command == "watch")
+                return watch(command, args);
+            if (command == "sleep")
+                return sleep(command, args);
+            return fail(command, ASW_E_INVALIDARG, "unknown command");
+        }
+
+    private:
+        // --------------------------------------------------------------------
+        // Output
+        // --------------------------------------------------------------------
+
+        void emit(const std::string &json)
+        {
+            std::fputs(json.c_str(), stdout);
+            std::fputc('\n', stdout);
+            std::fflush(stdout); // Consumers read line by line
+        }
+
+        bool ok(const std::string &command, const std::string &fields = std::string())
+        {
+            emit("{\"command\":\"" + JsonEscape(command) + "\",\"status\":\"ok\"" + fields + "}");
+            return true;
+        }
+
+        bool fail(const std::string &command, int32_t hr, const std::string &message)
+        {
+            char code[16];
+            std::snprintf(code, sizeof(code), "0x%08X", static_cast<unsigned>(hr));
+            emit("{\"command\":\"" + JsonEscape(command) + "\",\"status\":\"error\",\"hresult\":\"" + code +
+                 "\",\"message\":\"" + JsonEscape(message) + "\"}");
+            return false;
+        }
+
+        std::string text(AswDevice device, bool name)
+        {
+            uint32_t size = 0;
+            auto get = name ? AswGetDeviceName : AswGetDeviceId;
+            if (get(m_context, device, m_text.data(), static_cast<uint32_t>(m_text.size()), &size) == ASW_E_INSUFFICIENT_BUFFER)
+            {
+                m_text.resize(size);
+                get(m_context, device, m_text.data(), size, &size);
+            }
+            return size ? std::string(m_text.data(), size - 1) : std::string();
+        }
+
+        std::string deviceJson(const AswDeviceInfo &info)
+        {
+            std::string json = "{\"device\":" + std::to_string(info.device) + ",\"flow\":\"" + kFlowNames[info.flow & 1] +
+                               "\",\"state\":" + std::to_string(info.state) + ",\"default\":[";
+            bool first = true;
+            for (int role = 0; role < 3; ++role)
+            {
+                if (info.defaultRoles & (1u << role))
+                {
+                    json += std::string(first ? "" : ",") + "\"" + kRoleNames[role] + "\"";
+                    first = false;
+                }
+            }
+            json += "],\"id\":\"" + JsonEscape(text(info.device, false)) + "\",\"name\":\"" +
+                    JsonEscape(text(info.device, true)) + "\"}";
+            return json;
+        }
+
+        // --------------------------------------------------------------------
+        // Arguments
+        // --------------------------------------------------------------------
+
+        bool enumerate(int32_t flow)
+        {
+            uint32_t count = 0;
+            int32_t hr = AswEnumerateDevices(m_context, flow, m_devices.data(), static_cast<uint32_t>(m_devices.size()), &count);
+            if (hr == ASW_E_INSUFFICIENT_BUFFER)
+            {
+                m_devices.resize(count + 8);
+                hr = AswEnumerateDevices(m_context, flow, m_devices.data(), static_cast<uint32_t>(m_devices.size()), &count);
+            }
+            m_count = hr == ASW_OK ? count : 0;
+            return hr == ASW_OK;
+        }
+
+        static bool ParseFlow(const std::string &word, int32_t &flow)
+        {
+            const std::string w = Lower(word);
+            if (w == "render" || w == "output" || w == "playback")
+                flow = ASW_FLOW_RENDER;
+            else if (w == "capture" || w == "input" || w == "recording")
+                flow = ASW_FLOW_CAPTURE;
+            else if (w == "all")
+                flow = ASW_FLOW_ALL;
+            else
+                return false;
+            return true;
+        }
+
+        static bool ParseRole(const std::string &word, int32_t &role)
+        {
+            for (int32_t r = 0; r < 3; ++r)
+            {
+                if (Lower(word) == kRoleNames[r])
+                {
+                    role = r;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Resolves a handle, an endpoint ID, or a case-insensitive name (exact, else unique substring,
+         *        else the clear best fuzzy match, so "ecouteurs" or "sennhiser" still find their device).
+         */
+        int32_t resolve(const std::string &word, AswDevice &device)
+        {
+            device = 0;
+            if (!word.empty() && std::all_of(word.begin(), word.end(), [](unsigned char c)
+                                             { return std::isdigit(c) != 0; }))
+            {
+                device = static_cast<AswDevice>(std::strtoul(word.c_str(), nullptr, 10));
+                uint32_t size = 0;
+                return AswGetDeviceId(m_context, device, nullptr, 0, &size) == ASW_E_NOTFOUND ? ASW_E_NOTFOUND : ASW_OK;
+            }
+            if (AswFindDevice(m_context, word.c_str(), &device) == ASW_OK)
+                return ASW_OK;
+
+            if (!enumerate(ASW_FLOW_ALL))
+                return ASW_E_FAIL;
+            const std::string wanted = Lower(word);
+            AswDevice partial = 0;
+            uint32_t partialMatches = 0;
+            for (uint32_t i = 0; i < m_count; ++i)
+            {
+                const std::string name = Lower(text(m_devices[i].device, true));
+                if (name == wanted)
+                {
+                    device = m_devices[i].device;
+                    return ASW_OK;
+                }
+                if (name.find(wanted) != std::string::npos)
+                {
+                    partial = m_devices[i].device;
+                    ++partialMatches;
+                }
+            }
+            if (partialMatches == 1)
+            {
+                device = partial;
+                return ASW_OK;
+            }
+            if (partialMatches > 1)
+                return ASW_E_INVALIDARG;
+
+            Devices::DeviceNameIndex index;
+            for (uint32_t i = 0; i < m_count; ++i)
+                index.add(Utility::FromUtf8(text(m_devices[i].device, false)), Utility::FromUtf8(text(m_devices[i].device, true)),
+                          std::wstring(), i);
+            const std::vector<Devices::NameMatch> matches = index.search(Utility::FromUtf8(word), 2);
+            if (matches.empty())
+                return ASW_E_NOTFOUND;
+            if (matches.size() > 1 && matches[1].score >= matches[0].score)
+                return ASW_E_INVALIDARG;
+            device = m_devices[matches[0].tag].device;
+            return ASW_OK;
+        }
+
+        bool resolveOrFail(const std::string &command, const std::vector<std::string> &args, AswDevice &device)
+        {
+            if (args.empty())
+                return fail(command, ASW_E_INVALIDARG, "missing device");
+            const int32_t hr = resolve(args[0], device);
+            if (hr == ASW_E_INVALIDARG)
+                return fail(command, hr, "ambiguous device: " + args[0]);
+            if (hr != ASW_OK)
+                return fail(command, hr, "device not found: " + args[0]);
+            return true;
+        }
+
+        // --------------------------------------------------------------------
+        // Commands
+        // --------------------------------------------------------------------
+
+        bool list(const std::string &command, const std::vector<std::string> &args)
+        {
+            int32_t flow = ASW_FLOW_ALL;
+            if (!args.empty() && !ParseFlow(args[0], flow))
+                return fail(command, ASW_E_INVALIDARG, "bad flow: " + args[0]);
+            if (!enumerate(flow))
+                return fail(command, ASW_E_FAIL, "enumeration failed");
+
+            std::string devices = ",\"devices\":[";
+            for (uint32_t i = 0; i < m_count; ++i)
+                devices += (i ? "," : "") + deviceJson(m_devices[i]);
+            return ok(command, devices + "]");
+        }
+
+        bool getDefault(const std::string &command, const std::vector<std::string> &args)
+        {
+            int32_t flow = ASW_FLOW_RENDER;
+            int32_t role = ASW_ROLE_CONSOLE;
+            if (args.size() > 0 && (!ParseFlow(args[0], flow) || flow == ASW_FLOW_ALL))
+                return fail(command, ASW_E_INVALIDARG, "bad flow: " + args[0]);
+            if (args.size() > 1 && !ParseRole(args[1], role))
+                return fail(command, ASW_E_INVALIDARG, "bad role: " + args[1]);
+
+            AswDevice device = 0;
+            const int32_t hr = AswGetDefaultDevice(m_context, flow, role, &device);
+            if (hr < 0)
+                return fail(command, hr, "default lookup failed");
+            if (device == 0)
+                return ok(command, ",\"device\":null");
+            return ok(command, ",\"device\":" + std::to_string(device) + ",\"id\":\"" + JsonEscape(text(device, false)) +
+                                   "\",\"name\":\"" + JsonEscape(text(device, true)) + "\"");
+        }
+
+        bool status(const std::string &command, const std::vector<std::string> &args)
+        {
+            AswDevice device = 0;
+            if (!resolveOrFail(command, args, device))
+                return false;
+
+            int32_t muted = 0;
+            float level = 0.0f;
+            int32_t hr = AswGetMute(m_context, device, &muted);
+            if (hr >= 0)
+                hr = AswGetVolume(m_context, device, &level);
+            if (hr < 0)
+                return fail(command, hr, "device not available");
+
+            char fields[96];
+            std::snprintf(fields, sizeof(fields), ",\"device\":%u,\"muted\":%s,\"volume\":%.3f", device,
+                          muted ? "true" : "false", level);
+            return ok(command, std::string(fields) + ",\"name\":\"" + JsonEscape(text(device, true)) + "\"");
+        }
+
+        bool switchDefault(const std::string &command, const std::vector<std::string> &args)
+        {
+            AswDevice device = 0;
+            if (!resolveOrFail(command, args, device))
+                return false;
+
+            uint32_t roles = ASW_ROLE_MASK_ALL;
+            if (args.size() > 1 && Lower(args[1]) != "all")
+            {
+                int32_t role = 0;
+                if (!ParseRole(args[1], role))
+                    return fail(command, ASW_E_INVALIDARG, "bad role: " + args[1]);
+                roles = 1u << role;
+            }
+
+            const int32_t hr = AswSetDefaultDevice(m_context, device, roles);
+            if (hr < 0)
+                return fail(command, hr, "switch failed");
+            return ok(command, ",\"device\":" + std::to_string(device) + ",\"name\":\"" + JsonEscape(text(device, true)) + "\"");
+        }
+
+        bool mute(const std::string &command, const std::vector<std::string> &args)
+        {
+            AswDevice device = 0;
+            if (!resolveOrFail(command, args, device))
+                return false;
+
+            int32_t muted = command == "unmute" ? 0 : 1;
+            if (command == "mute" && args.size() > 1)
+            {
+                const std::string mode = Lower(args[1]);
+                if (mode == "off")
+                    muted = 0;
+                else if (mode == "toggle")
+                {
+                    const int32_t hr = AswGetMute(m_context, device, &muted);
+                    if (hr < 0)
+                        return fail(command, hr, "device not available");
+                    muted = !muted;
+                }
+                else if (mode != "on")
+                    return fail(command, ASW_E_INVALIDARG, "expected on, off or toggle");
+            }
+
+            const int32_t hr = AswSetMute(m_context, device, muted);
+            if (hr < 0)
+                return fail(command, hr, "mute failed");
+            return ok(command, ",\"device\":" + std::to_string(device) + ",\"muted\":" + (muted ? "true" : "false"));
+        }
+
+        bool volume(const std::string &command, const std::vector<std::string> &args)
+        {
+            AswDevice device = 0;
+            if (!resolveOrFail(command, args, device))
+                return false;
+
+            float level = 0.0f;
+            int32_t hr = ASW_OK;
+            if (args.size() > 1)
+            {
+                char *end = nullptr;
+                level = std::strtof(args[1].c_str(), &end);
+                if (end == args[1].c_str() || *end || !std::isfinite(level) || level < 0.0f || level > 1.0f)
+                    return fail(command, ASW_E_INVALIDARG, "level must be between 0 and 1");
+                hr = AswSetVolume(m_context, device, level);
+            }
+            else
+            {
+                hr = AswGetVolume(m_context, device, &level);
+            }
+            if (hr < 0)
+                return fail(command, hr, "volume failed");
+
+            char fields[64];
+            std::snprintf(fields, sizeof(fields), ",\"device\":%u,\"volume\":%.3f", device, level);
+            return ok(command, fields);
+        }
+
+        /**
+         * @brief Waits until a device resolves and is active, re-checking after every notification.
+         */
+        bool waitForDevice(const std::string &command, const std::vector<std::string> &args)
+        {
+            if (args.empty())
+                return fail(command, ASW_E_INVALIDARG, "missing device");
+            int64_t timeoutMs = kWaitForDeviceDefaultMs;
+            if (args.size() > 1 && !ParseMilliseconds(args[1], timeoutMs))
+                return fail(command, ASW_E_INVALIDARG, "timeout must be a non-negative integer (milliseconds)");
+
+            const auto start = std::chrono::steady_clock::now();
+            const auto deadline = DeadlineAfter(timeoutMs);
+            InterruptScope interruptible;
+            for (;;)
+            {
+                const uint64_t changes = m_changes.load(std::memory_order_acquire);
+
+                AswDevice device = 0;
+                const int32_t hr = resolve(args[0], device);
+                if (hr == ASW_E_INVALIDARG)
+                    return fail(command, hr, "ambiguous device: " + args[0]);
+                if (hr == ASW_OK && isActive(device))
+                {
+                    const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+                    return ok(command, ",\"device\":" + std::to_string(device) + ",\"name\":\"" +
+                                           JsonEscape(text(device, true)) + "\",\"waited_ms\":" + std::to_string(waited.count()));
+                }
+
+                // The signal handler cannot notify m_changed, so Ctrl+C is polled every 100 ms, as in watch()
+                std::unique_lock<std::mutex> lock(m_eventMutex);
+                bool changed = false;
+                while (!changed && !g_interrupted.load() && std::chrono::steady_clock::now() < deadline)
+                {
+                    const auto slice = std::min(deadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(100));
+                    changed = m_changed.wait_until(lock, slice, [&]
+                                                   { return m_changes.load(std::memory_order_acquire) != changes; });
+                }
+                if (g_interrupted.load())
+                    return fail(command, kErrorCancelled, "interrupted waiting for " + args[0]);
+                if (!changed)
+                    return fail(command, kErrorTimeout, "timed out waiting for " + args[0]);
+            }
+        }
+
+        bool isActive(AswDevice device)
+        {
+            if (!enumerate(ASW_FLOW_ALL))
+                return false;
+            for (uint32_t i = 0; i < m_count; ++i)
+                if (m_devices[i].device == device)
+                    return true;
+            return false;
+        }
+
+        /**
+         * @brief Prints events as they arrive, for SECONDS or until interrupted.
+         */
+        bool watch(const std::string &command, const std::vector<std::string> &args)
+        {
+            double seconds = -1.0; // Until Ctrl+C
+            if (!args.empty())
+            {
+                char *end = nullptr;
+                seconds = std::strtod(args[0].c_str(), &end);
+                if (end == args[0].c_str() || *end || !std::isfinite(seconds) || seconds < 0.0)
+                    return fail(command, ASW_E_INVALIDARG, "seconds must be a non-negative number");
+            }
+            const auto deadline = DeadlineAfter(seconds * 1000.0 < 9.0e18 ? static_cast<int64_t>(std::max(seconds, 0.0) * 1000.0)
+                                                                         : std::numeric_limits<int64_t>::max());
+            {
+                std::lock_guard<std::mutex> lock(m_eventMutex);
+                m_events.clear();
+                m_watching = true;
+            }
+            ok(command, ",\"watching\":true");
+            InterruptScope interruptible;
+
+            uint64_t count = 0;
+            std::deque<AswEvent> pending;
+            while (!g_interrupted.load() && (seconds < 0.0 || std::chrono::steady_clock::now() < deadline))
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_eventMutex);
+                    m_changed.wait_for(lock, std::chrono::milliseconds(100), [this]
+                                       { return !m_events.empty(); });
+                    pending.swap(m_events);
+                }
+                for (const AswEvent &event : pending)
+                {
+                    emitEvent(event);
+                    ++count;
+                }
+                pending.clear();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_eventMutex);
+                m_watching = false;
+            }
+            return ok(command, ",\"events\":" + std::to_string(count));
+        }
+
+        void emitEvent(const AswEvent &event)
+        {
+            std::string json = "{\"event\":\"" + std::string(kEventNames[std::min(event.type, 4)]) + "\"";
+            if (event.device)
+                json += ",\"device\":" + std::to_string(event.device) + ",\"name\":\"" + JsonEscape(text(event.device, true)) + "\"";
+            else
+                json += ",\"device\":null";
+            if (event.type == ASW_EVENT_DEFAULT_CHANGED)
+                json += std::string(",\"flow\":\"") + kFlowNames[event.flow & 1] + "\",\"role\":\"" + kRoleNames[std::min(event.role, 2)] + "\"";
+            else if (event.type == ASW_EVENT_STATE_CHANGED)
+                json += ",\"state\":" + std::to_string(event.state);
+            else if (event.type == ASW_EVENT_VOLUME_CHANGED)
+            {
+                char fields[64];
+                std::snprintf(fields, sizeof(fields), ",\"volume\":%.3f,\"muted\":%s", event.volume, event.muted ? "true" : "false");
+                json += fields;
+            }
+            emit(json + "}");
+        }
+
+        bool sleep(const std::string &command, const std::vector<std::string> &args)
+        {
+            int64_t ms = 0;
+            if (!args.empty() && !ParseMilliseconds(args[0], ms))
+                return fail(command, ASW_E_INVALIDARG, "milliseconds must be a non-negative integer");
+            std::this_thread::sleep_until(DeadlineAfter(ms));
+            return ok(command);
+        }
+
+        /**
+         * @brief Context callback: wakes wait-for-device and queues events while watching.
+         */
+        static void onEvent(const AswEvent *event, void *user)
+        {
+            Cli *cli = static_cast<Cli *>(user);
+            {
+                std::lock_guard<std::mutex> lock(cli->m_eventMutex);
+                cli->m_changes.fetch_add(1, std::memory_order_release);
+                if (cli->m_watching)
+                    cli->m_events.push_back(*event);
+            }
+            cli->m_changed.notify_all();
+        }
+
+        AswContext *m_context;
+        std::vector<AswDeviceInfo> m_devices = std::vector<AswDeviceInfo>(16);
+        uint32_t m_count = 0;
+        std::vector<char> m_text = std::vector<char>(256);
+
+        std::mutex m_eventMutex;
+        std::condition_variable m_changed;
+        std::atomic<uint64_t> m_changes{0};
+        std::deque<AswEvent> m_events;
+        bool m_watching = false;
+    };
+
+    /**
+     * @brief Runs every line of a stream as it is read (so a pipe can feed a long-lived process).
+     */
+    bool RunStream(Cli &cli, std::istream &in, bool keepGoing)
+    {
+        bool success = true;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (!cli.run(line))
+            {
+                success = false;
+                if (!keepGoing)
+                    break;
+            }
+        }
+        return success;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    Utility::COMInitializer com;
+
+    if (!options.platform)
+    {
+        Backend::SimulatedBackendConfig config;
+        config.renderDevices = options.renderDevices;
+        config.captureDevices = options.captureDevices;
+        Backend::SetAudioBackend(std::make_shared<Backend::SimulatedBackend>(config));
+    }
+
+    AswContext *context = nullptr;
+    const int32_t hr = AswCreateContext(&context);
+    if (hr != ASW_OK)
+    {
+        std::fprintf(stdout, "{\"command\":\"init\",\"status\":\"error\",\"hresult\":\"0x%08X\",\"message\":\"no audio backend\"}\n",
+                     static_cast<unsigned>(hr));
+        return 1;
+    }
+
+    bool success = true;
+    {
+        Cli cli(context);
+        for (const std::string &command : options.commands)
+        {
+            if (!cli.run(command))
+            {
+                success = false;
+                if (!options.keepGoing)
+                    break;
+            }
+        }
+
+        if ((success || options.keepGoing) && !options.script.empty() && options.script != "-")
+        {
+            std::ifstream file(options.script);
+            if (!file)
+            {
+                std::fprintf(stderr, "Cannot read %s\n", options.script.c_str());
+                success = false;
+            }
+            else if (!RunStream(cli, file, options.keepGoing))
+                success = false;
+        }
+        else if ((success || options.keepGoing) && (options.script == "-" || (options.commands.empty() && options.script.empty())))
+        {
+            if (!RunStream(cli, std::cin, options.keepGoing))
+                success = false;
+        }
+    }
+
+    AswDestroyContext(context);
+    return success ? 0 : 1;
+}
@@ -15,7 +15,7 @@
 
 #include <string>
 #include <vector>
-#include <mmdeviceapi.h> // IMMDevice*
+#include "Backend/Platform.h" // IMMDevice*
 
 namespace AudioSwitcher
 {
@@ -27,6 +27,7 @@ namespace AudioSwitcher
         std::wstring id;             ///< The unique ID of the input device.
         std::wstring name;           ///< Friendly name (e.g., "Microphone", "Line In").
         IMMDevice *device = nullptr; ///< Raw pointer to the device.
+        DWORD state = DEVICE_STATE_ACTIVE; ///< DEVICE_STATE_* value when listed.
 
         AudioInputDevice() = default;
 
@@ -45,6 +46,7 @@ namespace AudioSwitcher
         {
             id = std::move(other.id);
             name = std::move(other.name);
+            state = other.state;
             device = other.device;
             other.device = nullptr;
         }
@@ -57,6 +59,7 @@ namespace AudioSwitcher
                     device->Release();
                 id = std::move(other.id);
                 name = std::move(other.name);
+                state = other.state;
                 device = other.device;
                 other.device = nullptr;
             }
@@ -77,6 +80,14 @@ namespace AudioSwitcher
          */
         static std::vector<AudioInputDevice> listInputDevices();
 
+        /**
+         * @brief Lists the audio input devices in any of the given states.
+         *
+         * @param stateMask DEVICE_STATE_* bits (DEVICE_STATEMASK_ALL for disabled, unplugged and not-present too).
+         * @return std::vector<AudioInputDevice> Matching devices with their `state`; may be empty.
+         */
+        static std::vector<AudioInputDevice> listInputDevices(DWORD stateMask);
+
         /**
          * @brief Sets the given device as the system's default input device.
          *
@@ -17,7 +17,7 @@
 
 #include <string>
 #include <vector>
-#include <mmdeviceapi.h> // Required for IMMDevice*
+#include "Backend/Platform.h" // Required for IMMDevice*
 
 namespace AudioSwitcher
 {
@@ -29,6 +29,7 @@ namespace AudioSwitcher
         std::wstring id;             ///< The unique ID of the audio device (used by the system).
         std::wstring name;           ///< Friendly name shown to the user (e.g., "Speakers", "Headset").
         IMMDevice *device = nullptr; ///< Pointer to the actual device object (optional for advanced use).
+        DWORD state = DEVICE_STATE_ACTIVE; ///< DEVICE_STATE_* value when listed.
         // Explicit default constructor to fix the issue
         AudioDevice() = default;
         // Optional: Destructor to safely release if ever needed
@@ -47,6 +48,7 @@ namespace AudioSwitcher
         {
             id = std::move(other.id);
             name = std::move(other.name);
+            state = other.state;
             device = other.device;
             other.device = nullptr;
         }
@@ -59,6 +61,7 @@ namespace AudioSwitcher
                     device->Release();
                 id = std::move(other.id);
                 name = std::move(other.name);
+                state = other.state;
                 device = other.device;
                 other.device = nullptr;
             }
@@ -79,6 +82,14 @@ namespace AudioSwitcher
          */
         static std::vector<AudioDevice> listOutputDevices();
 
+        /**
+         * @brief Lists the audio output devices in any of the given states.
+         *
+         * @param stateMask DEVICE_STATE_* bits (DEVICE_STATEMASK_ALL for disabled, unplugged and not-present too).
+         * @return std::vector<AudioDevice> Matching devices with their `state`; may be empty.
+         */
+        static std::vector<AudioDevice> listOutputDevices(DWORD stateMask);
+
         /**
          * @brief Sets the given device as the default playback device.
          *
@@ -0,0 +1,183 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+/*
+ * Flat C API of the library, for front ends that cannot consume the C++ classes
+ * (C#, Rust, Python ctypes...). Only fixed-size types cross the boundary; strings
+ * are UTF-8 and copied into caller-provided buffers.
+ *
+ * A context caches the device table and the current defaults and keeps them up to
+ * date from backend notifications, so enumeration, name/ID queries and default
+ * lookups never call the backend and never allocate. Switching, mute and volume
+ * go to the backend directly, without allocating in this layer.
+ *
+ * Every function returns an HRESULT (negative on failure). Buffer functions
+ * follow the size-query pattern: call with a null buffer / zero capacity to get
+ * the required size, then call again. A context may be used from several threads.
+ *
+ *     AswContext *context = NULL;
+ *     AswCreateContext(&context);
+ *     uint32_t count = 0;
+ *     AswEnumerateDevices(context, ASW_FLOW_RENDER, NULL, 0, &count);   // ASW_E_INSUFFICIENT_BUFFER
+ *     AswDeviceInfo devices[16];
+ *     AswEnumerateDevices(context, ASW_FLOW_RENDER, devices, 16, &count);
+ *     AswSetDefaultDevice(context, devices[1].device, ASW_ROLE_MASK_ALL);
+ *     AswDestroyContext(context);
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct AswContext AswContext;
+
+    /** Device handle, stable for the lifetime of the context (0 = none). */
+    typedef uint32_t AswDevice;
+
+#define ASW_OK ((int32_t)0)
+#define ASW_S_FALSE ((int32_t)1)
+#define ASW_E_FAIL ((int32_t)0x80004005)
+#define ASW_E_POINTER ((int32_t)0x80004003)
+#define ASW_E_INVALIDARG ((int32_t)0x80070057)
+#define ASW_E_OUTOFMEMORY ((int32_t)0x8007000E)
+#define ASW_E_NOTFOUND ((int32_t)0x80070490)
+#define ASW_E_INSUFFICIENT_BUFFER ((int32_t)0x8007007A)
+
+#define ASW_FLOW_RENDER 0
+#define ASW_FLOW_CAPTURE 1
+#define ASW_FLOW_ALL 2
+
+#define ASW_ROLE_CONSOLE 0
+#define ASW_ROLE_MULTIMEDIA 1
+#define ASW_ROLE_COMMUNICATIONS 2
+#define ASW_ROLE_MASK_ALL 7u
+
+#define ASW_EVENT_DEVICE_ADDED 0
+#define ASW_EVENT_DEVICE_REMOVED 1
+#define ASW_EVENT_STATE_CHANGED 2
+#define ASW_EVENT_DEFAULT_CHANGED 3
+#define ASW_EVENT_VOLUME_CHANGED 4
+
+    /** One endpoint of AswEnumerateDevices(). */
+    typedef struct AswDeviceInfo
+    {
+        AswDevice device;
+        int32_t flow;          /**< ASW_FLOW_RENDER or ASW_FLOW_CAPTURE */
+        uint32_t state;        /**< DEVICE_STATE_* (1 = active) */
+        uint32_t defaultRoles; /**< Bit (1 << ASW_ROLE_*) for every role the device is default for */
+        uint32_t idSize;       /**< UTF-8 bytes of the ID, terminator included */
+        uint32_t nameSize;     /**< UTF-8 bytes of the friendly name, terminator included */
+    } AswDeviceInfo;
+
+    /** Notification passed to the event callback (fields beyond `device` depend on `type`). */
+    typedef struct AswEvent
+    {
+        int32_t type;     /**< ASW_EVENT_* */
+        AswDevice device; /**< 0 for "no default" */
+        int32_t flow;     /**< ASW_EVENT_DEFAULT_CHANGED */
+        int32_t role;     /**< ASW_EVENT_DEFAULT_CHANGED */
+        uint32_t state;   /**< ASW_EVENT_STATE_CHANGED */
+        float volume;     /**< ASW_EVENT_VOLUME_CHANGED */
+        int32_t muted;    /**< ASW_EVENT_VOLUME_CHANGED */
+    } AswEvent;
+
+    /**
+     * Called on a backend thread (Core Audio) or on the thread that caused the
+     * change. May call the query functions; must not destroy the context or change
+     * the callback.
+     */
+    typedef void (*AswEventCallback)(const AswEvent *event, void *user);
+
+    /**
+     * @brief Creates a context on the library's current backend and reads the device table.
+     */
+    AUDIO_SWITCHER_API int32_t AswCreateContext(AswContext **context);
+
+    /**
+     * @brief Stops notifications and frees the context (null is ignored).
+     */
+    AUDIO_SWITCHER_API void AswDestroyContext(AswContext *context);
+
+    /**
+     * @brief Re-reads the device table and defaults from the backend.
+     *
+     * Not needed in normal use: the table refreshes itself after device changes.
+     */
+    AUDIO_SWITCHER_API int32_t AswRefresh(AswContext *context);
+
+    /**
+     * @brief Lists the active endpoints of a flow.
+     *
+     * @param flow ASW_FLOW_RENDER, ASW_FLOW_CAPTURE or ASW_FLOW_ALL.
+     * @param devices Receives up to `capacity` entries (may be null when capacity is 0).
+     * @param count Receives the number of active endpoints.
+     * @return ASW_OK, or ASW_E_INSUFFICIENT_BUFFER if `count` > `capacity` (the first `capacity` are filled).
+     */
+    AUDIO_SWITCHER_API int32_t AswEnumerateDevices(AswContext *context, int32_t flow, AswDeviceInfo *devices,
+                                                   uint32_t capacity, uint32_t *count);
+
+    /**
+     * @brief Copies the endpoint ID (UTF-8, NUL-terminated).
+     *
+     * @param size Receives the required size in bytes, terminator included.
+     * @return ASW_OK, ASW_E_INSUFFICIENT_BUFFER (nothing copied), or ASW_E_NOTFOUND for a bad handle.
+     */
+    AUDIO_SWITCHER_API int32_t AswGetDeviceId(AswContext *context, AswDevice device, char *buffer,
+                                              uint32_t capacity, uint32_t *size);
+
+    /**
+     * @brief Copies the friendly name (UTF-8, NUL-terminated); same contract as AswGetDeviceId().
+     */
+    AUDIO_SWITCHER_API int32_t AswGetDeviceName(AswContext *context, AswDevice device, char *buffer,
+                                                uint32_t capacity, uint32_t *size);
+
+    /**
+     * @brief Finds the handle of an endpoint ID (UTF-8), whatever its state.
+     */
+    AUDIO_SWITCHER_API int32_t AswFindDevice(AswContext *context, const char *id, AswDevice *device);
+
+    /**
+     * @brief Current default endpoint of a flow and role (0 and ASW_S_FALSE if there is none).
+     */
+    AUDIO_SWITCHER_API int32_t AswGetDefaultDevice(AswContext *context, int32_t flow, int32_t role, AswDevice *device);
+
+    /**
+     * @brief Makes an endpoint the default for the roles in `roles` (ASW_ROLE_MASK_ALL for all).
+     */
+    AUDIO_SWITCHER_API int32_t AswSetDefaultDevice(AswContext *context, AswDevice device, uint32_t roles);
+
+    AUDIO_SWITCHER_API int32_t AswGetMute(AswContext *context, AswDevice device, int32_t *muted);
+    AUDIO_SWITCHER_API int32_t AswSetMute(AswContext *context, AswDevice device, int32_t muted);
+
+    /** Master volume scalar, 0..1. */
+    AUDIO_SWITCHER_API int32_t AswGetVolume(AswContext *context, AswDevice device, float *volume);
+    AUDIO_SWITCHER_API int32_t AswSetVolume(AswContext *context, AswDevice device, float volume);
+
+    /**
+     * @brief Installs (or with null, removes) the notification callback.
+     */
+    AUDIO_SWITCHER_API int32_t AswSetEventCallback(AswContext *context, AswEventCallback callback, void *user);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,235 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include "Backend/Platform.h"
+#include "Utility/DeviceFormatInfo.h"
+
+namespace Backend
+{
+    /**
+     * @brief Bit set of ERole values for setDefaultDevice().
+     */
+    enum RoleMask : uint32_t
+    {
+        RoleConsole = 1u << eConsole,
+        RoleMultimedia = 1u << eMultimedia,
+        RoleCommunications = 1u << eCommunications,
+        AllRoles = RoleConsole | RoleMultimedia | RoleCommunications
+    };
+
+    /**
+     * @brief Called once per endpoint during enumeration.
+     *
+     * `device` is only borrowed for the duration of the call; AddRef() it to keep it.
+     */
+    using DeviceVisitor = std::function<void(const std::wstring &id, const std::wstring &name, IMMDevice *device)>;
+
+    /**
+     * @brief DeviceVisitor that also receives the endpoint's DEVICE_STATE_* value.
+     */
+    using DeviceStateVisitor =
+        std::function<void(const std::wstring &id, const std::wstring &name, DWORD state, IMMDevice *device)>;
+
+    /**
+     * @brief Backend entry points, for failure injection and tracing.
+     */
+    enum class BackendOperation : uint8_t
+    {
+        EnumerateDevices,
+        GetDevice,
+        GetDefaultDevice,
+        SetDefaultDevice,
+        GetFriendlyName,
+        GetDeviceState,
+        GetMixFormat,
+        GetMute,
+        SetMute,
+        GetVolume,
+        SetVolume,
+        GetFormFactor,
+        EnumerateDevicesByState,
+        GetDeviceDescription,
+        Count
+    };
+
+    /**
+     * @brief Method name of an operation ("enumerateDevices", ...).
+     */
+    AUDIO_SWITCHER_API const char *OperationName(BackendOperation operation);
+
+    /**
+     * @brief Receives endpoint and volume changes (IMMNotificationClient + IAudioEndpointVolumeCallback).
+     *
+     * Callbacks may run on a backend-owned thread (Core Audio) or synchronously on
+     * the thread that caused the change (SimulatedBackend). They must not block and
+     * must not register or unregister listeners.
+     */
+    class AUDIO_SWITCHER_API IDeviceListener
+    {
+    public:
+        virtual ~IDeviceListener() = default;
+
+        virtual void onDeviceAdded(const std::wstring &deviceId) { (void)deviceId; }
+        virtual void onDeviceRemoved(const std::wstring &deviceId) { (void)deviceId; }
+
+        /// `state` is a DEVICE_STATE_* value.
+        virtual void onDeviceStateChanged(const std::wstring &deviceId, DWORD state)
+        {
+            (void)deviceId;
+            (void)state;
+        }
+
+        /// `deviceId` is empty when the flow no longer has a default for the role.
+        virtual void onDefaultDeviceChanged(EDataFlow flow, ERole role, const std::wstring &deviceId)
+        {
+            (void)flow;
+            (void)role;
+            (void)deviceId;
+        }
+
+        /// Master volume scalar (0..1) and mute state after the change.
+        virtual void onVolumeChanged(const std::wstring &deviceId, float volume, bool muted)
+        {
+            (void)deviceId;
+            (void)volume;
+            (void)muted;
+        }
+    };
+
+    /**
+     * @brief System audio services used by AudioManager, AudioInputManager and Utility.
+     *
+     * Implementations: the Windows Core Audio backend (default on Windows) and
+     * SimulatedBackend (default elsewhere, and for benchmarks). Methods return COM
+     * HRESULTs; the public API turns them into its usual bool / nullptr / exception
+     * results. Implementations must be callable from several threads.
+     */
+    class AUDIO_SWITCHER_API IAudioBackend
+    {
+    public:
+        virtual ~IAudioBackend() = default;
+
+        /// Short backend name ("wasapi", "simulated").
+        virtual const char *name() const = 0;
+
+        /**
+         * @brief Visits every active endpoint of a flow that has a readable name.
+         */
+        virtual HRESULT enumerateDevices(EDataFlow flow, const DeviceVisitor &visit) = 0;
+
+        /**
+         * @brief Visits every endpoint of a flow whose state is in `stateMask` (DEVICE_STATE_* bits).
+         *
+         * The default serves masks of DEVICE_STATE_ACTIVE through enumerateDevices()
+         * and returns E_NOTIMPL for anything wider, for backends that only know
+         * active endpoints.
+         */
+        virtual HRESULT enumerateDevicesByState(EDataFlow flow, DWORD stateMask, const DeviceStateVisitor &visit);
+
+        /**
+         * @brief Looks up an endpoint by ID, whatever its state (AddRef'd into `device`).
+         */
+        virtual HRESULT getDevice(const std::wstring &deviceId, IMMDevice **device) = 0;
+
+        /**
+         * @brief Default endpoint of a flow and role (AddRef'd into `device`).
+         */
+        virtual HRESULT getDefaultDevice(EDataFlow flow, ERole role, IMMDevice **device) = 0;
+
+        /**
+         * @brief Makes an endpoint the default for every role in `roles` (RoleMask bits).
+         *
+         * @return S_OK only if every role was set.
+         */
+        virtual HRESULT setDefaultDevice(const std::wstring &deviceId, uint32_t roles) = 0;
+
+        // Properties
+        virtual HRESULT getFriendlyName(IMMDevice *device, std::wstring &name) = 0;
+        virtual HRESULT getDeviceState(IMMDevice *device, DWORD &state) = 0;
+        virtual HRESULT getMixFormat(IMMDevice *device, Utility::DeviceFormatInfo &format) = 0;
+
+        /**
+         * @brief Reads PKEY_AudioEndpoint_FormFactor (speakers, headset, HDMI...).
+         *
+         * Backends without the property return E_NOTIMPL.
+         */
+        virtual HRESULT getFormFactor(IMMDevice *device, EndpointFormFactor &formFactor)
+        {
+            (void)device;
+            formFactor = UnknownFormFactor;
+            return E_NOTIMPL;
+        }
+
+        /**
+         * @brief Reads PKEY_Device_DeviceDesc ("Speakers" for "Speakers (Realtek Audio)").
+         *
+         * Backends without the property return E_NOTIMPL.
+         */
+        virtual HRESULT getDeviceDescription(IMMDevice *device, std::wstring &description)
+        {
+            (void)device;
+            description.clear();
+            return E_NOTIMPL;
+        }
+
+        // Endpoint volume (master scalar 0..1)
+        virtual HRESULT getMute(IMMDevice *device, bool &mute) = 0;
+        virtual HRESULT setMute(IMMDevice *device, bool mute) = 0;
+        virtual HRESULT getVolume(IMMDevice *device, float &volume) = 0;
+        virtual HRESULT setVolume(IMMDevice *device, float volume) = 0;
+
+        /**
+         * @brief Starts delivering notifications to a listener (not owned).
+         *
+         * @return S_OK, S_FALSE if already registered, E_POINTER for null.
+         */
+        virtual HRESULT registerListener(IDeviceListener *listener) = 0;
+
+        /**
+         * @brief Stops notifications; returns after any callback running on another thread.
+         *
+         * @return S_OK, or E_NOTFOUND if the listener was not registered.
+         */
+        virtual HRESULT unregisterListener(IDeviceListener *listener) = 0;
+    };
+
+    /**
+     * @brief Backend used by the library (created on first use if none was set).
+     */
+    AUDIO_SWITCHER_API std::shared_ptr<IAudioBackend> GetAudioBackend();
+
+    /**
+     * @brief Replaces the backend for subsequent calls.
+     *
+     * Calls already running keep the previous backend alive until they return.
+     *
+     * @param backend New backend, or nullptr to return to the platform default.
+     * @return The previous backend.
+     */
+    AUDIO_SWITCHER_API std::shared_ptr<IAudioBackend> SetAudioBackend(std::shared_ptr<IAudioBackend> backend);
+
+    /**
+     * @brief Creates the platform default: Core Audio on Windows, a SimulatedBackend elsewhere.
+     */
+    AUDIO_SWITCHER_API std::shared_ptr<IAudioBackend> CreatePlatformBackend();
+}
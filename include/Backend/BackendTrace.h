@@ -0,0 +1,179 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Backend/AudioBackend.h"
+
+namespace Backend
+{
+    /**
+     * @brief Notifications recorded in a trace (one per IDeviceListener callback).
+     */
+    enum class TraceEventType : uint8_t
+    {
+        DeviceAdded,
+        DeviceRemoved,
+        DeviceStateChanged,
+        DefaultDeviceChanged,
+        VolumeChanged,
+        Count
+    };
+
+    /**
+     * @brief Endpoint reported by a traced enumerateDevices() or enumerateDevicesByState() call.
+     */
+    struct TraceDevice
+    {
+        std::wstring id;
+        std::wstring name;
+        DWORD state = DEVICE_STATE_ACTIVE; ///< Recorded by enumerateDevicesByState() only
+    };
+
+    /**
+     * @brief One backend call or notification.
+     *
+     * Only the fields that belong to the operation or event are meaningful:
+     *
+     * | Record                | Fields                                   |
+     * |-----------------------|------------------------------------------|
+     * | enumerateDevices      | flow, devices                            |
+     * | enumerateDevicesByState | flow, state (mask), devices with state |
+     * | getDevice             | deviceId                                 |
+     * | getDefaultDevice      | flow, role, deviceId (result)            |
+     * | setDefaultDevice      | deviceId, roles                          |
+     * | getFriendlyName       | deviceId, name (result)                  |
+     * | getDeviceDescription  | deviceId, name (the description)         |
+     * | getDeviceState        | deviceId, state (result)                 |
+     * | getMixFormat          | deviceId, format (result)                |
+     * | getMute / setMute     | deviceId, muted                          |
+     * | getVolume / setVolume | deviceId, volume                         |
+     * | getFormFactor         | deviceId, formFactor (result)            |
+     * | DeviceAdded / Removed | deviceId                                 |
+     * | DeviceStateChanged    | deviceId, state                          |
+     * | DefaultDeviceChanged  | flow, role, deviceId (empty for none)    |
+     * | VolumeChanged         | deviceId, volume, muted                  |
+     */
+    struct TraceRecord
+    {
+        bool isEvent = false;
+        BackendOperation operation = BackendOperation::Count; ///< Calls only
+        TraceEventType event = TraceEventType::Count;         ///< Events only
+        int64_t timestampNs = 0;  ///< Call start / notification time since the trace started
+        uint64_t durationNs = 0;  ///< Calls only
+        HRESULT result = S_OK;    ///< Calls only
+
+        std::wstring deviceId;
+        EDataFlow flow = eRender;
+        ERole role = eConsole;
+        uint32_t roles = 0;
+        DWORD state = 0;
+        bool muted = false;
+        float volume = 0.0f;
+        std::wstring name;
+        Utility::DeviceFormatInfo format;
+        EndpointFormFactor formFactor = UnknownFormFactor;
+        std::vector<TraceDevice> devices;
+    };
+
+    /**
+     * @brief Encodes records into the compact binary trace format.
+     *
+     * Layout: a 16-byte header ("AWTR", version, start time in Unix nanoseconds)
+     * followed by tagged records. Timestamps are varint deltas, HRESULTs are varints
+     * (S_OK is one byte), and device IDs and names are interned: each string is
+     * written once as UTF-8 and referenced by index afterwards. A typical record
+     * takes about 10 bytes.
+     *
+     * append() is thread-safe; records are stored in append order.
+     */
+    class AUDIO_SWITCHER_API TraceWriter
+    {
+    public:
+        TraceWriter();
+
+        // Owns the string table: not copyable
+        TraceWriter(const TraceWriter &) = delete;
+        TraceWriter &operator=(const TraceWriter &) = delete;
+
+        /// Nanoseconds since the trace started (steady clock).
+        int64_t now() const;
+
+        void append(const TraceRecord &record);
+
+        size_t recordCount() const;
+        size_t byteSize() const;
+
+        /// Copy of the encoded trace, header included.
+        std::vector<uint8_t> bytes() const;
+
+        /**
+         * @brief Writes the trace to a file (via a temporary file, replaced atomically).
+         *
+         * @return true on success.
+         */
+        bool save(const std::filesystem::path &path) const;
+
+        /**
+         * @brief Drops every record and restarts the clock.
+         */
+        void clear();
+
+    private:
+        void writeString(const std::wstring &text);
+        void writeHeaderLocked();
+
+        mutable std::mutex m_mutex;
+        std::atomic<int64_t> m_startNs{0}; ///< Steady clock at start
+        int64_t m_lastNs = 0;              ///< Timestamp of the previous record (delta base)
+        size_t m_records = 0;
+        std::vector<uint8_t> m_data;
+        std::vector<uint8_t> m_scratch; ///< Record being encoded (string definitions go straight to m_data)
+        std::unordered_map<std::wstring, uint32_t> m_strings;
+    };
+
+    /**
+     * @brief Decodes an encoded trace.
+     *
+     * @param data Trace bytes (as produced by TraceWriter).
+     * @param size Byte count.
+     * @param records Receives the records in order.
+     * @param startUnixNs Receives the wall-clock start time (optional).
+     * @return false if the data is not a trace or is truncated (records holds what was decoded).
+     */
+    AUDIO_SWITCHER_API bool ParseTrace(const uint8_t *data, size_t size, std::vector<TraceRecord> &records,
+                                       int64_t *startUnixNs = nullptr);
+
+    /**
+     * @brief Maps and decodes a trace file.
+     */
+    AUDIO_SWITCHER_API bool ReadTrace(const std::filesystem::path &path, std::vector<TraceRecord> &records,
+                                      int64_t *startUnixNs = nullptr);
+
+    /**
+     * @brief Event name ("deviceAdded", ...).
+     */
+    AUDIO_SWITCHER_API const char *EventName(TraceEventType event);
+}
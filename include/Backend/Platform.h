@@ -0,0 +1,120 @@
+#pragma once
+
+// Core Audio types used by the public API.
+//
+// On Windows this is just the SDK headers. Elsewhere it declares the small subset
+// the library relies on (HRESULT codes, EDataFlow/ERole, a reference-counted
+// IMMDevice with GetId/GetState, CoTaskMem*), so the device API and its simulated
+// backend build unchanged on other platforms.
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <mmdeviceapi.h>
+#else
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+using HRESULT = int32_t;
+using DWORD = uint32_t;
+using UINT = unsigned int;
+using ULONG = unsigned long;
+using BOOL = int;
+using WCHAR = wchar_t;
+using LPWSTR = wchar_t *;
+using LPCWSTR = const wchar_t *;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#define S_OK ((HRESULT)0)
+#define S_FALSE ((HRESULT)1)
+#define E_NOTIMPL ((HRESULT)0x80004001u)
+#define E_POINTER ((HRESULT)0x80004003u)
+#define E_FAIL ((HRESULT)0x80004005u)
+#define E_OUTOFMEMORY ((HRESULT)0x8007000Eu)
+#define E_INVALIDARG ((HRESULT)0x80070057u)
+#define E_NOTFOUND ((HRESULT)0x80070490u)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+
+#define STDMETHODCALLTYPE
+
+#define COINIT_MULTITHREADED 0x0
+#define COINIT_APARTMENTTHREADED 0x2
+
+#define DEVICE_STATE_ACTIVE 0x00000001
+#define DEVICE_STATE_DISABLED 0x00000002
+#define DEVICE_STATE_NOTPRESENT 0x00000004
+#define DEVICE_STATE_UNPLUGGED 0x00000008
+#define DEVICE_STATEMASK_ALL 0x0000000f
+
+enum EDataFlow
+{
+    eRender,
+    eCapture,
+    eAll,
+    EDataFlow_enum_count
+};
+
+enum ERole
+{
+    eConsole,
+    eMultimedia,
+    eCommunications,
+    ERole_enum_count
+};
+
+/// PKEY_AudioEndpoint_FormFactor values.
+enum EndpointFormFactor
+{
+    RemoteNetworkDevice,
+    Speakers,
+    LineLevel,
+    Headphones,
+    Microphone,
+    Headset,
+    Handset,
+    UnknownDigitalPassthrough,
+    SPDIF,
+    DigitalAudioDisplayDevice,
+    UnknownFormFactor,
+    EndpointFormFactor_enum_count
+};
+
+/**
+ * @brief Reference counting part of IUnknown.
+ */
+struct IUnknown
+{
+    virtual ULONG STDMETHODCALLTYPE AddRef() = 0;
+    virtual ULONG STDMETHODCALLTYPE Release() = 0;
+
+protected:
+    virtual ~IUnknown() = default;
+};
+
+/**
+ * @brief Endpoint handle: the IMMDevice methods backends can provide everywhere.
+ */
+struct IMMDevice : public IUnknown
+{
+    /// Allocates the ID with CoTaskMemAlloc; the caller frees it with CoTaskMemFree.
+    virtual HRESULT STDMETHODCALLTYPE GetId(LPWSTR *id) = 0;
+    virtual HRESULT STDMETHODCALLTYPE GetState(DWORD *state) = 0;
+};
+
+inline void *CoTaskMemAlloc(size_t bytes)
+{
+    return std::malloc(bytes);
+}
+
+inline void CoTaskMemFree(void *memory)
+{
+    std::free(memory);
+}
+#endif
@@ -0,0 +1,151 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include "Backend/Platform.h"
+
+namespace Backend
+{
+    /**
+     * @brief AudioSessionState values.
+     */
+    enum class SessionState : uint8_t
+    {
+        Inactive, ///< Exists but not streaming (muting it still sticks)
+        Active,
+        Expired   ///< Gone; the table drops it
+    };
+
+    /**
+     * @brief One audio session (IAudioSessionControl2) of an endpoint.
+     */
+    struct SessionInfo
+    {
+        std::wstring deviceId;
+        std::wstring instanceId;  ///< GetSessionInstanceIdentifier(): unique per session
+        DWORD processId = 0;      ///< 0 for the system sounds session
+        std::wstring executable;  ///< File name of the process image ("Teams.exe"), empty if unknown
+        std::wstring displayName; ///< As set by the application (often empty)
+        SessionState state = SessionState::Inactive;
+        float volume = 1.0f;      ///< Session volume scalar 0..1 (relative to the endpoint)
+        bool muted = false;
+    };
+
+    /**
+     * @brief Volume control of one session (an ISimpleAudioVolume on Core Audio).
+     *
+     * Obtained once per session and kept, so changing a session's volume costs
+     * one call instead of an enumeration.
+     */
+    class AUDIO_SWITCHER_API ISessionVolume
+    {
+    public:
+        virtual ~ISessionVolume() = default;
+
+        virtual HRESULT getVolume(float &volume) = 0;
+        virtual HRESULT setVolume(float volume) = 0;
+        virtual HRESULT getMute(bool &mute) = 0;
+        virtual HRESULT setMute(bool mute) = 0;
+    };
+
+    /**
+     * @brief Called once per session during enumeration, with its volume control.
+     */
+    using SessionVisitor = std::function<void(const SessionInfo &session, const std::shared_ptr<ISessionVolume> &volume)>;
+
+    /**
+     * @brief Receives session changes of the endpoints it was registered for
+     *        (IAudioSessionNotification + IAudioSessionEvents).
+     *
+     * Same rules as IDeviceListener: callbacks may run on a backend thread or on
+     * the thread that caused the change, must not block and must not register or
+     * unregister listeners.
+     */
+    class AUDIO_SWITCHER_API ISessionListener
+    {
+    public:
+        virtual ~ISessionListener() = default;
+
+        virtual void onSessionCreated(const SessionInfo &session, const std::shared_ptr<ISessionVolume> &volume)
+        {
+            (void)session;
+            (void)volume;
+        }
+
+        virtual void onSessionStateChanged(const std::wstring &instanceId, SessionState state)
+        {
+            (void)instanceId;
+            (void)state;
+        }
+
+        /// Volume scalar and mute state after the change.
+        virtual void onSessionVolumeChanged(const std::wstring &instanceId, float volume, bool muted)
+        {
+            (void)instanceId;
+            (void)volume;
+            (void)muted;
+        }
+
+        /// The session is gone (endpoint removed, server shutdown, exclusive-mode override...).
+        virtual void onSessionDisconnected(const std::wstring &instanceId) { (void)instanceId; }
+    };
+
+    /**
+     * @brief Per-application audio sessions of an endpoint (IAudioSessionManager2).
+     *
+     * Implementations: the Core Audio session backend (Windows) and
+     * SimulatedSessionBackend. Methods return HRESULTs and must be callable from
+     * several threads.
+     */
+    class AUDIO_SWITCHER_API ISessionBackend
+    {
+    public:
+        virtual ~ISessionBackend() = default;
+
+        /// Short backend name ("wasapi", "simulated").
+        virtual const char *name() const = 0;
+
+        /**
+         * @brief Visits every session of an endpoint, expired ones excluded.
+         */
+        virtual HRESULT enumerateSessions(const std::wstring &deviceId, const SessionVisitor &visit) = 0;
+
+        /**
+         * @brief Starts delivering the session events of one endpoint to a listener (not owned).
+         *
+         * @return S_OK, S_FALSE if already registered for that endpoint, E_POINTER for null.
+         */
+        virtual HRESULT registerListener(const std::wstring &deviceId, ISessionListener *listener) = 0;
+
+        /**
+         * @brief Stops those events; returns after any callback running on another thread.
+         *
+         * @return S_OK, or E_NOTFOUND if the listener was not registered for that endpoint.
+         */
+        virtual HRESULT unregisterListener(const std::wstring &deviceId, ISessionListener *listener) = 0;
+    };
+
+    /**
+     * @brief Creates the platform default: Core Audio sessions on Windows, an empty SimulatedSessionBackend elsewhere.
+     */
+    AUDIO_SWITCHER_API std::shared_ptr<ISessionBackend> CreatePlatformSessionBackend();
+}
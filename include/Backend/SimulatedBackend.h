@@ -0,0 +1,260 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "Backend/AudioBackend.h"
+
+namespace Backend
+{
+    class ListenerSet;
+
+    /**
+     * @brief Simulated cost of each backend operation, in microseconds.
+     *
+     * Latencies are busy-waited so sub-millisecond values are honoured.
+     */
+    struct SimulatedLatency
+    {
+        uint32_t enumerateUs = 0;  ///< Per enumerateDevices() call (enumerator + collection)
+        uint32_t propertyUs = 0;   ///< Per property read (name, state; also per enumerated device)
+        uint32_t defaultUs = 0;    ///< Per getDefaultDevice() / getDevice()
+        uint32_t setDefaultUs = 0; ///< Per role in setDefaultDevice()
+        uint32_t formatUs = 0;     ///< Per getMixFormat()
+        uint32_t volumeUs = 0;     ///< Per endpoint-volume call (mute or volume, get or set)
+    };
+
+    /**
+     * @brief Failure injected into one backend operation.
+     *
+     * The next `failNext` calls fail; after that each call fails with `probability`
+     * (drawn from the backend's seeded generator, so runs are reproducible).
+     */
+    struct SimulatedFailure
+    {
+        uint32_t failNext = 0;
+        double probability = 0.0;
+        HRESULT result = E_FAIL;
+    };
+
+    /**
+     * @brief Shape of the simulated system.
+     */
+    struct SimulatedBackendConfig
+    {
+        uint32_t renderDevices = 4;
+        uint32_t captureDevices = 2;
+        SimulatedLatency latency;
+        uint64_t seed = 1; ///< Drives device IDs, mix formats and failure draws
+    };
+
+    /**
+     * @brief Deterministic in-process audio system.
+     *
+     * Models endpoints with Windows-style IDs, friendly names and descriptions (the
+     * friendly name up to " (", as Core Audio builds one from the other), a float mix format,
+     * a form factor (UnknownFormFactor unless given to addDevice() or setFormFactor()), device state,
+     * master volume and mute, and per-role defaults (device 0 of each
+     * flow to start with). State can be changed from the outside (addDevice,
+     * removeDevice, setDeviceState) and behaves like Core Audio: enumerateDevices()
+     * lists active devices, enumerateDevicesByState() any states (removed devices
+     * are DEVICE_STATE_NOTPRESENT), and when a default endpoint goes away the first remaining
+     * active endpoint of its flow takes over.
+     *
+     * Every change notifies the registered listeners synchronously on the calling
+     * thread, after the backend's lock is released. Per-operation latency and
+     * failures can be injected; for a given config and call sequence everything,
+     * including injected failures, is reproducible.
+     */
+    class AUDIO_SWITCHER_API SimulatedBackend : public IAudioBackend
+    {
+    public:
+        explicit SimulatedBackend(const SimulatedBackendConfig &config = SimulatedBackendConfig());
+        ~SimulatedBackend() override;
+
+        // Non-copyable: handed-out devices refer to this instance
+        SimulatedBackend(const SimulatedBackend &) = delete;
+        SimulatedBackend &operator=(const SimulatedBackend &) = delete;
+
+        const char *name() const override { return "simulated"; }
+
+        HRESULT enumerateDevices(EDataFlow flow, const DeviceVisitor &visit) override;
+        HRESULT enumerateDevicesByState(EDataFlow flow, DWORD stateMask, const DeviceStateVisitor &visit) override;
+        HRESULT getDevice(const std::wstring &deviceId, IMMDevice **device) override;
+        HRESULT getDefaultDevice(EDataFlow flow, ERole role, IMMDevice **device) override;
+        HRESULT setDefaultDevice(const std::wstring &deviceId, uint32_t roles) override;
+        HRESULT getFriendlyName(IMMDevice *device, std::wstring &name) override;
+        HRESULT getDeviceState(IMMDevice *device, DWORD &state) override;
+        HRESULT getMixFormat(IMMDevice *device, Utility::DeviceFormatInfo &format) override;
+        HRESULT getFormFactor(IMMDevice *device, EndpointFormFactor &formFactor) override;
+        HRESULT getDeviceDescription(IMMDevice *device, std::wstring &description) override;
+        HRESULT getMute(IMMDevice *device, bool &mute) override;
+        HRESULT setMute(IMMDevice *device, bool mute) override;
+        HRESULT getVolume(IMMDevice *device, float &volume) override;
+        HRESULT setVolume(IMMDevice *device, float volume) override;
+        HRESULT registerListener(IDeviceListener *listener) override;
+        HRESULT unregisterListener(IDeviceListener *listener) override;
+
+        // --- Simulation control ---
+
+        /**
+         * @brief Replaces the simulated latencies (takes effect on the next call).
+         */
+        void setLatency(const SimulatedLatency &latency);
+
+        /**
+         * @brief Injects failures into one operation (replaces any previous plan for it).
+         */
+        void setFailure(BackendOperation operation, const SimulatedFailure &failure);
+
+        /**
+         * @brief Removes every injected failure.
+         */
+        void clearFailures();
+
+        /**
+         * @brief Fixes the cost of one operation, overriding SimulatedLatency.
+         *
+         * The delay is per call (not per enumerated device or per role). Used by
+         * TraceReplayer to reproduce recorded call durations.
+         *
+         * @param operation Operation to override.
+         * @param ns Delay in nanoseconds; negative removes the override.
+         */
+        void setOperationLatency(BackendOperation operation, int64_t ns);
+
+        /**
+         * @brief Removes every per-operation latency override.
+         */
+        void clearOperationLatencies();
+
+        /**
+         * @brief Plugs in a new active endpoint.
+         *
+         * It becomes the default for every role if its flow had none.
+         *
+         * @param flow eRender or eCapture.
+         * @param name Friendly name.
+         * @param format Mix format; an invalid format gets a generated one.
+         * @param deviceId Endpoint ID to use; empty generates one.
+         * @param formFactor Reported by getFormFactor().
+         * @return The new endpoint ID (empty for an invalid flow or an ID already in use).
+         */
+        std::wstring addDevice(EDataFlow flow, const std::wstring &name,
+                               const Utility::DeviceFormatInfo &format = Utility::DeviceFormatInfo(),
+                               const std::wstring &deviceId = std::wstring(),
+                               EndpointFormFactor formFactor = UnknownFormFactor);
+
+        /**
+         * @brief Removes an endpoint (state becomes DEVICE_STATE_NOTPRESENT).
+         *
+         * @return false for an unknown or already removed ID.
+         */
+        bool removeDevice(const std::wstring &deviceId);
+
+        /**
+         * @brief Changes an endpoint's DEVICE_STATE_* (unplug, disable, re-enable...).
+         *
+         * @return false for an unknown ID or an invalid state.
+         */
+        bool setDeviceState(const std::wstring &deviceId, DWORD state);
+
+        /**
+         * @brief Changes the form factor reported by getFormFactor() (no notification, as in Core Audio).
+         *
+         * @return false for an unknown ID or an invalid form factor.
+         */
+        bool setFormFactor(const std::wstring &deviceId, EndpointFormFactor formFactor);
+
+        /**
+         * @brief Changes the description reported by getDeviceDescription() (no notification).
+         *
+         * @return false for an unknown ID.
+         */
+        bool setDescription(const std::wstring &deviceId, const std::wstring &description);
+
+        // --- Inspection ---
+
+        SimulatedBackendConfig config() const;
+
+        /// IDs of the endpoints of a flow that are not removed, in enumeration order.
+        std::vector<std::wstring> deviceIds(EDataFlow flow) const;
+
+        /// Current default of a flow and role (empty if none).
+        std::wstring defaultDeviceId(EDataFlow flow, ERole role) const;
+
+        /// Mute state / volume / DEVICE_STATE_* of an endpoint (false / 0 / 0 for unknown IDs).
+        bool isMuted(const std::wstring &deviceId) const;
+        float volume(const std::wstring &deviceId) const;
+        DWORD deviceState(const std::wstring &deviceId) const;
+
+        /// Operations served so far (including failed ones), in total or for one operation.
+        uint64_t callCount() const;
+        uint64_t callCount(BackendOperation operation) const;
+
+        /// Calls failed by injection so far.
+        uint64_t injectedFailures() const { return m_injected.load(std::memory_order_relaxed); }
+
+    private:
+        class Device;
+        struct Event;
+
+        struct Endpoint
+        {
+            std::wstring id;
+            std::wstring name;
+            std::wstring description;
+            EDataFlow flow = eRender;
+            Utility::DeviceFormatInfo format;
+            EndpointFormFactor formFactor = UnknownFormFactor;
+            bool muted = false;
+            float volume = 1.0f;
+            std::shared_ptr<std::atomic<DWORD>> state; ///< Shared with the handle for GetState()
+            Device *handle = nullptr;                  ///< Reference held by the backend
+        };
+
+        HRESULT begin(BackendOperation operation, uint32_t repeats = 1);
+        HRESULT enumerate(BackendOperation operation, EDataFlow flow, DWORD stateMask, const DeviceStateVisitor &visit);
+        int64_t latencyLocked(BackendOperation operation, uint32_t repeats) const;
+        int findLocked(IMMDevice *device) const;
+        int findLocked(const std::wstring &deviceId) const;
+        int addLocked(EDataFlow flow, const std::wstring &name, const Utility::DeviceFormatInfo &format,
+                      const std::wstring &deviceId = std::wstring());
+        void reassignDefaultsLocked(int index, std::vector<Event> &events);
+        void dispatch(const std::vector<Event> &events);
+
+        SimulatedBackendConfig m_config;
+        uint64_t m_instance = 0; ///< Distinguishes devices of different backends
+        mutable std::mutex m_mutex;
+        std::mt19937_64 m_random;                    ///< IDs, formats and failure draws
+        std::vector<Endpoint> m_endpoints;
+        uint32_t m_added[2] = {0, 0};                ///< Endpoints created per flow (for names)
+        int m_defaults[2][3] = {{-1, -1, -1}, {-1, -1, -1}}; ///< [flow][role] → endpoint index
+        SimulatedFailure m_failures[static_cast<size_t>(BackendOperation::Count)];
+        int64_t m_latencyOverrides[static_cast<size_t>(BackendOperation::Count)]; ///< ns, negative = none
+        std::atomic<uint64_t> m_calls[static_cast<size_t>(BackendOperation::Count)] = {};
+        std::atomic<uint64_t> m_injected{0};
+        std::unique_ptr<ListenerSet> m_listeners;
+    };
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Backend/SessionBackend.h"
+
+namespace Backend
+{
+    /**
+     * @brief Simulated cost of session calls (busy-waited).
+     */
+    struct SimulatedSessionLatency
+    {
+        uint32_t enumerateUs = 0; ///< Per enumerateSessions() call (manager + enumerator)
+        uint32_t sessionUs = 0;   ///< Per enumerated session (control, QueryInterface, process lookup)
+        uint32_t volumeUs = 0;    ///< Per session volume / mute call
+    };
+
+    /**
+     * @brief In-process session manager for tests, benchmarks and non-Windows builds.
+     *
+     * Sessions are created and changed from the outside (addSession, setSessionState,
+     * setSessionVolume, disconnectSession) and the registered listeners are notified
+     * synchronously on the calling thread, after the backend's lock is released.
+     * Volume controls handed out refer to this instance, which must outlive them.
+     */
+    class AUDIO_SWITCHER_API SimulatedSessionBackend : public ISessionBackend
+    {
+    public:
+        explicit SimulatedSessionBackend(const SimulatedSessionLatency &latency = SimulatedSessionLatency());
+        ~SimulatedSessionBackend() override;
+
+        // Non-copyable: handed-out volume controls refer to this instance
+        SimulatedSessionBackend(const SimulatedSessionBackend &) = delete;
+        SimulatedSessionBackend &operator=(const SimulatedSessionBackend &) = delete;
+
+        const char *name() const override { return "simulated"; }
+
+        HRESULT enumerateSessions(const std::wstring &deviceId, const SessionVisitor &visit) override;
+        HRESULT registerListener(const std::wstring &deviceId, ISessionListener *listener) override;
+        HRESULT unregisterListener(const std::wstring &deviceId, ISessionListener *listener) override;
+
+        // --- Simulation control ---
+
+        void setLatency(const SimulatedSessionLatency &latency);
+
+        /**
+         * @brief Starts a session for a process on an endpoint (listeners get onSessionCreated).
+         *
+         * @return The session instance ID.
+         */
+        std::wstring addSession(const std::wstring &deviceId, DWORD processId, const std::wstring &executable,
+                                const std::wstring &displayName = std::wstring(),
+                                SessionState state = SessionState::Active);
+
+        /**
+         * @brief Changes a session's state; Expired ends it.
+         *
+         * @return false for an unknown or expired session.
+         */
+        bool setSessionState(const std::wstring &instanceId, SessionState state);
+
+        /**
+         * @brief Changes volume and mute as the application or the volume mixer would.
+         */
+        bool setSessionVolume(const std::wstring &instanceId, float volume, bool muted);
+
+        /**
+         * @brief Ends a session with onSessionDisconnected.
+         */
+        bool disconnectSession(const std::wstring &instanceId);
+
+        // --- Inspection ---
+
+        /// Sessions that have not expired, on every endpoint.
+        size_t sessionCount() const;
+        bool isMuted(const std::wstring &instanceId) const;
+        float volume(const std::wstring &instanceId) const;
+
+        /// enumerateSessions() calls / session volume calls served so far.
+        uint64_t enumerations() const { return m_enumerations.load(std::memory_order_relaxed); }
+        uint64_t volumeCalls() const { return m_volumeCalls.load(std::memory_order_relaxed); }
+
+    private:
+        class Volume;
+
+        struct Session
+        {
+            SessionInfo info;
+            std::shared_ptr<Volume> volume;
+        };
+
+        enum class Change
+        {
+            Created,
+            State,
+            Volume,
+            Disconnected
+        };
+
+        int findLocked(const std::wstring &instanceId) const;
+        HRESULT getVolume(size_t index, float &volume, bool &muted);
+        HRESULT setVolume(size_t index, const float *volume, const bool *muted);
+        void dispatch(Change change, const SessionInfo &session, const std::shared_ptr<ISessionVolume> &volume);
+
+        SimulatedSessionLatency m_latency;
+        mutable std::mutex m_mutex;
+        std::vector<Session> m_sessions;                      ///< Never shrinks: volume controls keep an index
+        std::unordered_map<std::wstring, size_t> m_byInstance;
+        uint64_t m_created = 0;
+
+        std::recursive_mutex m_listenerMutex;                 ///< Held while dispatching
+        std::map<std::wstring, std::vector<ISessionListener *>> m_listeners;
+
+        std::atomic<uint64_t> m_enumerations{0};
+        std::atomic<uint64_t> m_volumeCalls{0};
+    };
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Backend/BackendTrace.h"
+#include "Backend/SimulatedBackend.h"
+
+namespace Backend
+{
+    /**
+     * @brief How a trace is played back.
+     */
+    struct ReplayOptions
+    {
+        double speed = 1.0;           ///< Time scale of the gaps between records (2 = twice as fast); 0 = no gaps
+        bool reproduceLatency = true; ///< Make every call take as long as it did when recorded
+        bool reproduceFailures = true;///< Fail the calls that failed, with the recorded HRESULT
+        bool replayEvents = true;     ///< Apply recorded notifications (plug/unplug, external default changes...)
+    };
+
+    /**
+     * @brief Recorded vs replayed cost of one operation.
+     */
+    struct ReplayOperationStats
+    {
+        uint64_t calls = 0;
+        uint64_t recordedNs = 0; ///< Sum of recorded durations
+        uint64_t replayedNs = 0; ///< Sum of replayed durations
+        uint64_t maxRecordedNs = 0;
+        uint64_t maxReplayedNs = 0;
+    };
+
+    /**
+     * @brief Outcome of a replay.
+     */
+    struct ReplayResult
+    {
+        size_t calls = 0;
+        size_t events = 0;
+        size_t mismatches = 0;     ///< Calls whose HRESULT differed from the recording
+        int64_t recordedSpanNs = 0; ///< First to last record, as recorded
+        int64_t replayedSpanNs = 0; ///< Wall time of the replay
+        ReplayOperationStats operations[static_cast<size_t>(BackendOperation::Count)];
+    };
+
+    /**
+     * @brief Plays a recorded trace back through a SimulatedBackend.
+     *
+     * The simulation is seeded with the endpoints found in the trace (same IDs,
+     * names, flows and mix formats) and the first observed defaults. replay() then
+     * issues every recorded call against it in timestamp order, waiting out the
+     * recorded gaps (scaled by `speed`), reproducing each call's recorded duration
+     * and failure, and applying recorded notifications that the calls themselves do
+     * not cause. Listeners registered on backend() see the notifications as they
+     * happen, so code under test can be run against the replayed session — e.g.
+     * install backend() with SetAudioBackend() to time the library on a customer's
+     * latency profile.
+     *
+     * Calls from several threads are replayed on one thread, in start order.
+     * Notifications are applied through the simulation's control methods and, for
+     * default and volume changes, ordinary calls (these show up in callCount()).
+     */
+    class AUDIO_SWITCHER_API TraceReplayer
+    {
+    public:
+        explicit TraceReplayer(std::vector<TraceRecord> records);
+
+        /**
+         * @brief Simulated system reconstructed from the trace.
+         */
+        const std::shared_ptr<SimulatedBackend> &backend() const { return m_backend; }
+
+        const std::vector<TraceRecord> &records() const { return m_records; }
+
+        /**
+         * @brief Replays the whole trace on the calling thread.
+         *
+         * The backend keeps the state reached at the end; construct a new replayer
+         * to replay from the start again.
+         */
+        ReplayResult replay(const ReplayOptions &options = ReplayOptions());
+
+    private:
+        /// What the trace tells about an endpoint.
+        struct DeviceInfo
+        {
+            EDataFlow flow = eRender;
+            std::wstring name;
+            Utility::DeviceFormatInfo format;
+            EndpointFormFactor formFactor = UnknownFormFactor;
+            std::wstring description;
+            bool hasDescription = false; ///< Read in the trace (an empty description is kept)
+        };
+
+        void collectDevices();
+        HRESULT replayCall(const TraceRecord &record, const ReplayOptions &options, uint64_t &elapsedNs);
+        void replayEvent(const TraceRecord &record);
+        void ensureDevice(const std::wstring &deviceId);
+
+        std::vector<TraceRecord> m_records;
+        std::shared_ptr<SimulatedBackend> m_backend;
+        std::unordered_map<std::wstring, DeviceInfo> m_devices;
+    };
+}
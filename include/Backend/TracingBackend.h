@@ -0,0 +1,98 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <memory>
+#include <mutex>
+#include "Backend/AudioBackend.h"
+#include "Backend/BackendTrace.h"
+
+namespace Backend
+{
+    class ListenerSet;
+
+    /**
+     * @brief Backend decorator that records every call and notification into a trace.
+     *
+     * Forwards each call to the wrapped backend and appends a TraceRecord with its
+     * start time, duration, HRESULT, arguments and results. Notifications of the
+     * wrapped backend are recorded and passed on to the listeners registered here.
+     * Install it in front of the real backend to capture a field session:
+     *
+     *     auto writer = std::make_shared<Backend::TraceWriter>();
+     *     Backend::SetAudioBackend(std::make_shared<Backend::TracingBackend>(Backend::CreatePlatformBackend(), writer));
+     *     ...
+     *     writer->save("session.awtr");
+     *
+     * Replay a trace with TraceReplayer.
+     */
+    class AUDIO_SWITCHER_API TracingBackend : public IAudioBackend
+    {
+    public:
+        /**
+         * @param inner Backend that serves the calls.
+         * @param writer Receives the records (may be shared by several backends).
+         * @param recordEvents Also subscribe to the inner backend's notifications from the start
+         *        (otherwise only while a listener is registered here).
+         */
+        TracingBackend(std::shared_ptr<IAudioBackend> inner, std::shared_ptr<TraceWriter> writer,
+                       bool recordEvents = true);
+        ~TracingBackend() override;
+
+        // Non-copyable: registered with the inner backend as a listener
+        TracingBackend(const TracingBackend &) = delete;
+        TracingBackend &operator=(const TracingBackend &) = delete;
+
+        const char *name() const override { return m_inner->name(); }
+
+        HRESULT enumerateDevices(EDataFlow flow, const DeviceVisitor &visit) override;
+        HRESULT enumerateDevicesByState(EDataFlow flow, DWORD stateMask, const DeviceStateVisitor &visit) override;
+        HRESULT getDevice(const std::wstring &deviceId, IMMDevice **device) override;
+        HRESULT getDefaultDevice(EDataFlow flow, ERole role, IMMDevice **device) override;
+        HRESULT setDefaultDevice(const std::wstring &deviceId, uint32_t roles) override;
+        HRESULT getFriendlyName(IMMDevice *device, std::wstring &name) override;
+        HRESULT getDeviceState(IMMDevice *device, DWORD &state) override;
+        HRESULT getMixFormat(IMMDevice *device, Utility::DeviceFormatInfo &format) override;
+        HRESULT getFormFactor(IMMDevice *device, EndpointFormFactor &formFactor) override;
+        HRESULT getDeviceDescription(IMMDevice *device, std::wstring &description) override;
+        HRESULT getMute(IMMDevice *device, bool &mute) override;
+        HRESULT setMute(IMMDevice *device, bool mute) override;
+        HRESULT getVolume(IMMDevice *device, float &volume) override;
+        HRESULT setVolume(IMMDevice *device, float volume) override;
+        HRESULT registerListener(IDeviceListener *listener) override;
+        HRESULT unregisterListener(IDeviceListener *listener) override;
+
+        const std::shared_ptr<IAudioBackend> &inner() const { return m_inner; }
+        const std::shared_ptr<TraceWriter> &writer() const { return m_writer; }
+
+    private:
+        class Recorder;
+
+        TraceRecord startCall(BackendOperation operation, IMMDevice *device = nullptr) const;
+        void finishCall(TraceRecord &record, HRESULT result) const;
+        void updateSubscription();
+
+        std::shared_ptr<IAudioBackend> m_inner;
+        std::shared_ptr<TraceWriter> m_writer;
+        bool m_recordEvents;
+        std::unique_ptr<Recorder> m_recorder;
+        std::unique_ptr<ListenerSet> m_listeners;
+        std::mutex m_subscriptionMutex;
+        bool m_subscribed = false;
+    };
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "Backend/Platform.h"
+#include "Devices/DeviceMetadataCache.h"
+
+namespace Devices
+{
+    /**
+     * @brief Endpoint reference in a profile: by ID, else by friendly name.
+     *
+     * IDs are exact but machine-specific; the name (case-insensitive, same flow)
+     * lets a profile survive a driver reinstall or move to another machine.
+     */
+    struct ProfileDevice
+    {
+        std::wstring id;
+        std::wstring name;
+
+        bool empty() const { return id.empty() && name.empty(); }
+    };
+
+    /**
+     * @brief Volume and/or mute of one endpoint in a profile.
+     */
+    struct ProfileEndpoint
+    {
+        ProfileDevice device;
+        EDataFlow flow = eRender;
+        bool hasVolume = false;
+        float volume = 1.0f; ///< Master volume scalar 0..1
+        bool hasMute = false;
+        bool muted = false;
+    };
+
+    /**
+     * @brief Named scene: defaults per flow and role, plus endpoint volumes and mute states.
+     *
+     * Empty defaults and endpoints not listed are left as they are.
+     */
+    struct AudioProfile
+    {
+        std::string name;
+        ProfileDevice defaults[2][3]; ///< [eRender/eCapture][ERole]
+        std::vector<ProfileEndpoint> endpoints;
+    };
+
+    /**
+     * @brief Writes profiles to `path` through a temporary file that replaces it.
+     *
+     * Layout (little-endian): a 32-byte header (magic "AWPF", version, profile count,
+     * payload size, FNV-1a checksum of the payload), then each profile as
+     * length-prefixed UTF-8 strings and packed fields.
+     *
+     * @return true on success.
+     */
+    AUDIO_SWITCHER_API bool SaveProfiles(const std::filesystem::path &path, const std::vector<AudioProfile> &profiles);
+
+    /**
+     * @brief Reads a profile file written by SaveProfiles().
+     *
+     * @return CacheStatus::Loaded with `profiles` filled, or why the file cannot be used.
+     */
+    AUDIO_SWITCHER_API CacheStatus LoadProfiles(const std::filesystem::path &path, std::vector<AudioProfile> &profiles);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Devices/DeviceMetadataCache.h"
+
+namespace Devices
+{
+    /**
+     * @brief Live enumeration callback: fills every current endpoint, returns false on failure.
+     */
+    using DeviceEnumerator = std::function<bool(std::vector<DeviceRecord> &)>;
+
+    /**
+     * @brief Timings and outcome of the last start().
+     */
+    struct DeviceDirectoryStats
+    {
+        CacheStatus cacheStatus = CacheStatus::Missing;
+        double cacheLoadMs = 0.0;    ///< Time for start() to have a list (cache hit) or give up on the cache
+        double enumerateMs = 0.0;    ///< Duration of the background live enumeration
+        bool reconciled = false;     ///< Live enumeration finished successfully
+        bool changed = false;        ///< Live list differed from the cached one
+        bool cacheWritten = false;   ///< Cache file was (re)written
+    };
+
+    /**
+     * @brief Device list served from the metadata cache at startup and reconciled live.
+     *
+     * start() maps the cache file and publishes its records immediately; a background
+     * thread then runs the live enumerator and, if the result differs (or the cache
+     * was missing, stale or corrupt), swaps in the live list, rewrites the cache and
+     * calls the change callback. Queries always see a complete list.
+     */
+    class AUDIO_SWITCHER_API DeviceDirectory
+    {
+    public:
+        DeviceDirectory() = default;
+        ~DeviceDirectory();
+
+        // Owns a thread: not copyable
+        DeviceDirectory(const DeviceDirectory &) = delete;
+        DeviceDirectory &operator=(const DeviceDirectory &) = delete;
+
+        /**
+         * @brief Loads the cache and starts background reconciliation.
+         *
+         * @param cachePath Cache file (created on first reconciliation).
+         * @param enumerate Live enumerator, run on the background thread.
+         * @param onChange Optional callback on the background thread when the list changes.
+         * @return Cache status; with anything but Loaded the list stays empty until reconciled.
+         */
+        CacheStatus start(const std::filesystem::path &cachePath, DeviceEnumerator enumerate,
+                          std::function<void()> onChange = nullptr);
+
+        /**
+         * @brief Waits for the background thread.
+         */
+        void stop();
+
+        /**
+         * @brief Current list (cached or live).
+         */
+        std::vector<DeviceRecord> devices() const;
+
+        /**
+         * @brief Current devices of one flow.
+         */
+        std::vector<DeviceRecord> devices(DeviceFlow flow) const;
+
+        bool find(const std::wstring &id, DeviceRecord &out) const;
+
+        /**
+         * @brief Blocks until live enumeration has finished or the timeout expires.
+         *
+         * @return true if reconciled.
+         */
+        bool waitReconciled(std::chrono::milliseconds timeout);
+
+        bool isReconciled() const;
+
+        /// True while the list still comes from the cache file.
+        bool fromCache() const;
+
+        DeviceDirectoryStats stats() const;
+
+    private:
+        void reconcile(DeviceEnumerator enumerate, std::function<void()> onChange);
+
+        std::filesystem::path m_path;
+        std::thread m_thread;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_done;
+        std::shared_ptr<const std::vector<DeviceRecord>> m_devices;
+        bool m_fromCache = false;
+        bool m_finished = false;
+        DeviceDirectoryStats m_stats;
+    };
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "Backend/Platform.h"
+#include "Utility/DeviceFormatInfo.h"
+#include "Utility/MappedFile.h"
+
+namespace Devices
+{
+    /**
+     * @brief Direction of an endpoint.
+     */
+    enum class DeviceFlow : uint8_t
+    {
+        Render,
+        Capture
+    };
+
+    /**
+     * @brief Last known description of one endpoint.
+     */
+    struct DeviceRecord
+    {
+        std::wstring id;
+        std::wstring name;
+        DeviceFlow flow = DeviceFlow::Render;
+        bool isDefault = false;           ///< Default console endpoint of its flow
+        uint32_t state = DEVICE_STATE_ACTIVE; ///< DEVICE_STATE_* value
+        Utility::DeviceFormatInfo format; ///< Mix format (`.valid` false if it could not be read)
+
+        bool operator==(const DeviceRecord &other) const;
+        bool operator!=(const DeviceRecord &other) const { return !(*this == other); }
+    };
+
+    /**
+     * @brief Outcome of opening a metadata cache file.
+     */
+    enum class CacheStatus
+    {
+        Missing, ///< No file
+        Loaded,  ///< Valid file of the current version
+        Stale,   ///< Valid header of another layout version
+        Corrupt  ///< Bad magic, sizes or checksum
+    };
+
+    /**
+     * @brief Memory-mapped device metadata file with fixed-size records and a string table.
+     *
+     * Layout (little-endian): a 32-byte header (magic, version, record count and size,
+     * string table offset and size, FNV-1a checksum of everything after the header),
+     * then 32-byte records, then UTF-16 strings referenced by offset and length.
+     * The device state sits in the high nibble of a record's flag byte (version 2;
+     * version 1 files, which had no state, open as CacheStatus::Stale).
+     * Records are decoded in place from the mapping on request; nothing is parsed
+     * up front beyond the header and the checksum.
+     */
+    class AUDIO_SWITCHER_API DeviceMetadataCache
+    {
+    public:
+        static constexpr uint16_t Version = 2;
+
+        DeviceMetadataCache() = default;
+
+        // Owns the mapping: not copyable
+        DeviceMetadataCache(const DeviceMetadataCache &) = delete;
+        DeviceMetadataCache &operator=(const DeviceMetadataCache &) = delete;
+
+        /**
+         * @brief Maps and validates a cache file.
+         *
+         * @return Status; records are available only for CacheStatus::Loaded.
+         */
+        CacheStatus open(const std::filesystem::path &path);
+
+        /**
+         * @brief Unmaps the file (required before the file can be replaced on Windows).
+         */
+        void close();
+
+        size_t count() const { return m_count; }
+
+        /**
+         * @brief Decodes record `index` from the mapping.
+         */
+        bool record(size_t index, DeviceRecord &out) const;
+
+        /**
+         * @brief Finds a record by ID, comparing strings in place.
+         */
+        bool find(const std::wstring &id, DeviceRecord &out) const;
+
+        /**
+         * @brief Decodes every record.
+         */
+        std::vector<DeviceRecord> records() const;
+
+        /**
+         * @brief Writes records to `path` through a temporary file that replaces it.
+         *
+         * @return true on success.
+         */
+        static bool write(const std::filesystem::path &path, const std::vector<DeviceRecord> &records);
+
+    private:
+        Utility::MappedFile m_file;
+        const uint8_t *m_records = nullptr;
+        const uint8_t *m_strings = nullptr;
+        size_t m_count = 0;
+        size_t m_stringsSize = 0;
+    };
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Backend/AudioBackend.h"
+
+namespace Devices
+{
+    /**
+     * @brief Lower-cases, folds Latin accents ("É" → "e", "ß" → "ss"), turns punctuation
+     *        into single spaces and trims, so "Haut-Parleurs (Écho)" becomes "haut parleurs echo".
+     */
+    AUDIO_SWITCHER_API std::wstring NormalizeDeviceName(const std::wstring &text);
+
+    /**
+     * @brief One ranked search result.
+     */
+    struct NameMatch
+    {
+        std::wstring id;
+        std::wstring name;
+        uint32_t tag = 0; ///< Caller value given to add()
+        float score = 0.0f; ///< 1 exact, ≥ 0.9 substring, below that the share of query trigrams found
+    };
+
+    /**
+     * @brief Fuzzy search index over device names, built from character trigrams.
+     *
+     * Names (and optional descriptions) are normalised with NormalizeDeviceName()
+     * and split into padded trigrams with posting lists, so a query only touches
+     * the entries that share a trigram with it instead of scanning every name.
+     * Exact and substring matches rank first, then entries by the share of query
+     * trigrams they contain, which tolerates typos and word order. Entries are added,
+     * replaced and removed one at a time.
+     *
+     * Not thread-safe, concurrent search() calls included (they share the per-slot
+     * counters, which are reset after each query instead of reallocated); DeviceSearch
+     * wraps it for live endpoints.
+     */
+    class AUDIO_SWITCHER_API DeviceNameIndex
+    {
+    public:
+        static constexpr float DefaultMinScore = 0.3f;
+
+        /**
+         * @brief Indexes an entry, replacing any entry with the same ID.
+         */
+        void add(const std::wstring &id, const std::wstring &name, const std::wstring &description = std::wstring(),
+                 uint32_t tag = 0);
+
+        bool remove(const std::wstring &id);
+        void clear();
+
+        /// Indexed name of an entry.
+        bool find(const std::wstring &id, std::wstring &name) const;
+
+        size_t size() const { return m_byId.size(); }
+
+        /// IDs of all entries, unordered.
+        std::vector<std::wstring> ids() const;
+
+        /**
+         * @brief Ranked matches, best first (ties: shorter name, then name order).
+         *
+         * @param limit Maximum results; 0 for all.
+         * @param minScore Results scoring below are dropped.
+         */
+        std::vector<NameMatch> search(const std::wstring &query, size_t limit = 5,
+                                      float minScore = DefaultMinScore) const;
+
+    private:
+        struct Entry
+        {
+            std::wstring id;
+            std::wstring name;
+            std::wstring text;           ///< Normalised name and description
+            size_t nameLength = 0;       ///< Length of the normalised name at the start of `text`
+            std::vector<uint64_t> grams; ///< Unique trigrams of `text`
+            uint32_t tag = 0;
+            bool live = false;
+        };
+
+        std::vector<Entry> m_entries;                              ///< Slots reused through m_free
+        std::vector<uint32_t> m_free;
+        mutable std::vector<uint16_t> m_shared;  ///< Per slot: query trigrams found (zero between queries)
+        mutable std::vector<uint32_t> m_touched; ///< Slots with a non-zero count during a query
+        std::unordered_map<std::wstring, uint32_t> m_byId;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> m_postings; ///< Trigram → entry slots
+    };
+
+    /**
+     * @brief DeviceNameIndex over the active endpoints of the audio backend.
+     *
+     * Endpoint notifications only mark the index stale; the next search re-enumerates
+     * and applies the difference (new, renamed and vanished endpoints), so resolving a
+     * name costs an index lookup until the device set changes. Endpoints are indexed by
+     * friendly name and description (getDeviceDescription()). Tags are EDataFlow values.
+     */
+    class AUDIO_SWITCHER_API DeviceSearch : private Backend::IDeviceListener
+    {
+    public:
+        DeviceSearch();
+        ~DeviceSearch() override;
+
+        // Registered with the backend: not copyable
+        DeviceSearch(const DeviceSearch &) = delete;
+        DeviceSearch &operator=(const DeviceSearch &) = delete;
+
+        HRESULT start();
+        void stop();
+
+        /**
+         * @brief Ranked endpoints of `flow` (eAll for both) matching `query`.
+         */
+        std::vector<NameMatch> search(const std::wstring &query, EDataFlow flow = eAll, size_t limit = 5,
+                                      float minScore = DeviceNameIndex::DefaultMinScore);
+
+        /// Enumerations done to (re)build the index.
+        uint64_t refreshes() const;
+
+    private:
+        void onDeviceAdded(const std::wstring &deviceId) override;
+        void onDeviceRemoved(const std::wstring &deviceId) override;
+        void onDeviceStateChanged(const std::wstring &deviceId, DWORD state) override;
+
+        HRESULT refresh();
+
+        std::shared_ptr<Backend::IAudioBackend> m_backend;
+        bool m_registered = false;
+
+        mutable std::mutex m_mutex;
+        DeviceNameIndex m_index;
+        bool m_stale = true;
+        uint64_t m_refreshes = 0;
+    };
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Backend/AudioBackend.h"
+#include "Devices/DeviceMetadataCache.h"
+
+namespace Devices
+{
+    /**
+     * @brief Condition on one tracked endpoint, for DeviceStateTracker::waitForDevice().
+     */
+    using DevicePredicate = std::function<bool(const DeviceRecord &device)>;
+
+    /**
+     * @brief Counters of a DeviceStateTracker.
+     */
+    struct DeviceTrackerStats
+    {
+        uint64_t notifications = 0; ///< Endpoint notifications received
+        uint64_t updates = 0;       ///< Notifications applied in place, without enumerating
+        uint64_t enumerations = 0;  ///< Full enumerations (start and unknown endpoints)
+        uint64_t wakeups = 0;       ///< Times a waitForDevice() re-checked its predicate
+    };
+
+    /**
+     * @brief Endpoints in every state of a mask, kept current by notifications.
+     *
+     * start() enumerates once with the state mask. Afterwards state changes, removals
+     * and console default changes of known endpoints are applied in place from the
+     * notifications; endpoints leaving the mask are remembered, so plugging one back
+     * in needs no enumeration either. Only an endpoint the tracker has never seen (or
+     * a change racing an enumeration) marks the list stale, and the next reader
+     * enumerates again.
+     * waitForDevice() sleeps until a notification changes the list instead of polling.
+     *
+     * Records carry the ID, name, flow, state and console-default flag; the mix format
+     * is not read. Thread-safe.
+     */
+    class AUDIO_SWITCHER_API DeviceStateTracker : private Backend::IDeviceListener
+    {
+    public:
+        DeviceStateTracker();
+        ~DeviceStateTracker() override;
+
+        // Registered with the backend: not copyable
+        DeviceStateTracker(const DeviceStateTracker &) = delete;
+        DeviceStateTracker &operator=(const DeviceStateTracker &) = delete;
+
+        /**
+         * @brief Registers for notifications and enumerates the endpoints in `stateMask`.
+         *
+         * @param stateMask DEVICE_STATE_* bits; endpoints leaving the mask are dropped.
+         */
+        HRESULT start(DWORD stateMask = DEVICE_STATEMASK_ALL);
+
+        /**
+         * @brief Unregisters and wakes every waiter (which then returns false).
+         */
+        void stop();
+
+        /**
+         * @brief Tracked endpoints, render first, then by name.
+         */
+        std::vector<DeviceRecord> devices();
+
+        bool find(const std::wstring &id, DeviceRecord &out);
+
+        /**
+         * @brief Blocks until `predicate` holds for a tracked endpoint or `timeout` expires.
+         *
+         * The predicate is checked at once and again after each change to the list;
+         * it runs under the tracker's lock and must not call the tracker.
+         *
+         * @param match Receives the first endpoint satisfying the predicate.
+         * @return true if one did; false on timeout or stop().
+         */
+        bool waitForDevice(const DevicePredicate &predicate, std::chrono::milliseconds timeout,
+                           DeviceRecord *match = nullptr);
+
+        /// Incremented by every change to the list.
+        uint64_t generation() const;
+
+        DeviceTrackerStats stats() const;
+
+    private:
+        void onDeviceAdded(const std::wstring &deviceId) override;
+        void onDeviceRemoved(const std::wstring &deviceId) override;
+        void onDeviceStateChanged(const std::wstring &deviceId, DWORD state) override;
+        void onDefaultDeviceChanged(EDataFlow flow, ERole role, const std::wstring &deviceId) override;
+
+        HRESULT refresh();
+        void changedLocked();
+
+        std::shared_ptr<Backend::IAudioBackend> m_backend;
+        DWORD m_stateMask = DEVICE_STATEMASK_ALL;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_changed;
+        std::unordered_map<std::wstring, DeviceRecord> m_devices;
+        std::unordered_map<std::wstring, DeviceRecord> m_hidden; ///< Seen, but in a state outside the mask
+        bool m_registered = false;
+        bool m_stale = true;
+        uint32_t m_refreshing = 0; ///< Enumerations in flight; notifications meanwhile leave the list stale
+        uint64_t m_generation = 0;
+        DeviceTrackerStats m_stats;
+    };
+}
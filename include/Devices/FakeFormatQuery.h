@@ -0,0 +1,73 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Devices/FormatQuery.h"
+
+namespace Devices
+{
+    /**
+     * @brief Set of formats a FakeFormatQuery accepts: every combination of the listed values.
+     */
+    struct FakeFormatSupport
+    {
+        std::vector<uint32_t> sampleRates;
+        std::vector<uint16_t> channelCounts;
+        std::vector<SampleType> sampleTypes;
+
+        bool contains(const Utility::DeviceFormatInfo &format, uint16_t validBits) const;
+    };
+
+    /**
+     * @brief Simulated endpoint for probing without hardware.
+     *
+     * Support sets, periods and the mix format are plain public members; each query
+     * sleeps for `callLatency` to model the cost of IAudioClient::IsFormatSupported.
+     */
+    class AUDIO_SWITCHER_API FakeFormatQuery : public IFormatQuery
+    {
+    public:
+        explicit FakeFormatQuery(std::wstring id, std::wstring driverVersion = L"1.0");
+
+        std::wstring deviceId() const override { return m_id; }
+        std::wstring driverVersion() const override { return m_driverVersion; }
+        bool mixFormat(Utility::DeviceFormatInfo &format) override;
+        bool devicePeriods(int64_t &defaultHns, int64_t &minimumHns) override;
+        bool isFormatSupported(ShareMode mode, const Utility::DeviceFormatInfo &format, uint16_t validBits) override;
+
+        /// Number of isFormatSupported() calls so far.
+        uint64_t calls() const { return m_calls.load(std::memory_order_relaxed); }
+
+        FakeFormatSupport shared;
+        FakeFormatSupport exclusive;
+        Utility::DeviceFormatInfo mix;
+        int64_t defaultPeriodHns = 100000; ///< 10 ms
+        int64_t minimumPeriodHns = 30000;  ///< 3 ms
+        std::chrono::microseconds callLatency{0};
+
+    private:
+        std::wstring m_id;
+        std::wstring m_driverVersion;
+        std::atomic<uint64_t> m_calls{0};
+    };
+}
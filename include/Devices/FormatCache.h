@@ -0,0 +1,79 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "Devices/FormatCapabilities.h"
+
+namespace Devices
+{
+    /**
+     * @brief Probe results keyed by device ID and driver version, persisted to a binary file.
+     *
+     * A stored entry is reused only while the driver version and the probe spec are
+     * unchanged, so a driver update invalidates it automatically. The file carries a
+     * magic and version; unreadable or outdated files load as an empty cache.
+     *
+     * Thread-safe: the prober stores results from its worker threads.
+     */
+    class AUDIO_SWITCHER_API FormatCache
+    {
+    public:
+        FormatCache() = default;
+
+        // Non-copyable (owns a mutex)
+        FormatCache(const FormatCache &) = delete;
+        FormatCache &operator=(const FormatCache &) = delete;
+
+        /**
+         * @brief Replaces the contents with a cache file.
+         *
+         * @return true if the file was read; false leaves the cache empty.
+         */
+        bool load(const std::filesystem::path &path);
+
+        /**
+         * @brief Writes the cache through a temporary file that replaces `path`.
+         */
+        bool save(const std::filesystem::path &path) const;
+
+        /**
+         * @brief Looks up a device probed with the same driver version and spec.
+         *
+         * @param out Receives the stored capabilities (fromCache = true, queries = 0).
+         */
+        bool find(const std::wstring &deviceId, const std::wstring &driverVersion, uint64_t specHash,
+                  FormatCapabilities &out) const;
+
+        /**
+         * @brief Inserts or replaces the entry of a device.
+         */
+        void store(const FormatCapabilities &capabilities);
+
+        void clear();
+        size_t size() const;
+
+    private:
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::wstring, FormatCapabilities> m_entries; ///< By device ID
+    };
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Devices/FormatQuery.h"
+#include "Utility/DeviceFormatInfo.h"
+
+namespace Devices
+{
+    /**
+     * @brief Grid of candidate formats to probe: every rate × channel count × sample type.
+     */
+    struct AUDIO_SWITCHER_API FormatProbeSpec
+    {
+        std::vector<uint32_t> sampleRates = {8000, 11025, 16000, 22050, 32000, 44100, 48000,
+                                             88200, 96000, 176400, 192000, 352800, 384000};
+        std::vector<uint16_t> channelCounts = {1, 2, 4, 6, 8};
+        std::vector<SampleType> sampleTypes = {
+            SampleType{16, 16, false}, // s16
+            SampleType{24, 24, false}, // packed s24
+            SampleType{32, 24, false}, // s24 in a 32-bit container
+            SampleType{32, 32, false}, // s32
+            SampleType{32, 32, true},  // f32
+        };
+        bool probeShared = true;
+        bool probeExclusive = true;
+
+        /// Number of grid cells per mode.
+        size_t cellCount() const { return sampleRates.size() * channelCounts.size() * sampleTypes.size(); }
+
+        /**
+         * @brief Grid index of a cell, or -1 if a value is not part of the spec.
+         */
+        std::ptrdiff_t indexOf(uint32_t sampleRate, uint16_t channels, const SampleType &type) const;
+
+        /**
+         * @brief Stable 64-bit hash of the spec (cached results are only reused for the same spec).
+         */
+        uint64_t hash() const;
+    };
+
+    /**
+     * @brief Full capability matrix of one endpoint.
+     */
+    struct AUDIO_SWITCHER_API FormatCapabilities
+    {
+        std::wstring deviceId;
+        std::wstring driverVersion;
+        Utility::DeviceFormatInfo mixFormat; ///< Shared-mode mix format
+        int64_t defaultPeriodHns = 0;        ///< Default device period (100-ns units)
+        int64_t minimumPeriodHns = 0;        ///< Minimum device period (100-ns units)
+
+        FormatProbeSpec spec;                ///< Grid the flags below refer to
+        std::vector<uint8_t> shared;         ///< 1 per supported cell, indexed by FormatProbeSpec::indexOf()
+        std::vector<uint8_t> exclusive;
+
+        uint32_t queries = 0;                ///< isFormatSupported() calls made (0 when served from cache)
+        double probeMs = 0.0;                ///< Wall time of the probe
+        bool fromCache = false;
+        bool valid = false;
+
+        /**
+         * @brief Whether a format was accepted (false for formats outside the spec).
+         */
+        bool supports(ShareMode mode, uint32_t sampleRate, uint16_t channels, const SampleType &type) const;
+
+        /**
+         * @brief Accepted formats of a mode, with the default channel mask for each count.
+         *
+         * DeviceFormatInfo has no valid-bits field: s24-in-32 and s32 both appear as 32-bit integer.
+         */
+        std::vector<Utility::DeviceFormatInfo> supportedFormats(ShareMode mode) const;
+    };
+
+    /**
+     * @brief Builds the DeviceFormatInfo of a grid cell.
+     */
+    AUDIO_SWITCHER_API Utility::DeviceFormatInfo MakeFormat(uint32_t sampleRate, uint16_t channels, const SampleType &type);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Devices/FormatCapabilities.h"
+#include "Utility/DeviceFormatInfo.h"
+
+namespace Devices
+{
+    /**
+     * @brief Weights of the conversion cost model (arbitrary units, only ratios matter).
+     */
+    struct ConversionCosts
+    {
+        float resampleUp = 8.0f;       ///< Rate conversion to a higher device rate
+        float resampleDown = 10.0f;    ///< Rate conversion to a lower device rate (loses bandwidth)
+        float requantizeUp = 0.5f;     ///< Widening to more significant bits (lossless)
+        float requantizeDown = 3.0f;   ///< Narrowing to fewer significant bits (dither / truncation)
+        float floatConversion = 1.0f;  ///< Integer <-> float
+        float channelUpmix = 2.0f;     ///< Remap to more channels
+        float channelDownmix = 4.0f;   ///< Fold to fewer channels (loses separation)
+    };
+
+    /**
+     * @brief How one device gets from the common format to a format it accepts.
+     */
+    struct ConversionPlan
+    {
+        std::wstring deviceId;
+        Utility::DeviceFormatInfo deviceFormat; ///< Format to open the device with
+        SampleType deviceSampleType;
+        bool resample = false;
+        bool requantize = false;
+        bool convertFloat = false;
+        bool remapChannels = false;
+        float cost = 0.0f;
+
+        /// Device accepts the common format as-is.
+        bool passthrough() const { return !resample && !requantize && !convertFloat && !remapChannels; }
+    };
+
+    /**
+     * @brief Outcome of a negotiation.
+     */
+    struct NegotiationResult
+    {
+        bool valid = false;                ///< False if some device has no usable format
+        Utility::DeviceFormatInfo format;  ///< Common format
+        SampleType sampleType;
+        float totalCost = 0.0f;
+        std::vector<ConversionPlan> plans; ///< Same order as the input devices
+        size_t candidatesEvaluated = 0;
+    };
+
+    /**
+     * @brief Picks the common format that minimises the total conversion cost over a set of endpoints.
+     *
+     * Every cell of the probe grids is a candidate. For each candidate, each device
+     * maps it to the accepted format it can reach most cheaply; the candidate with
+     * the lowest sum wins. Ties go to the higher-fidelity format (more significant
+     * bits, float, more channels, then the rate closest to 48 kHz).
+     *
+     * In shared mode a device whose shared grid was not probed is treated as
+     * accepting only its mix format.
+     */
+    class AUDIO_SWITCHER_API FormatNegotiator
+    {
+    public:
+        explicit FormatNegotiator(const ConversionCosts &costs = ConversionCosts()) : m_costs(costs) {}
+
+        /**
+         * @brief Negotiates a common format.
+         *
+         * @param devices Capabilities from FormatProber.
+         * @param mode Sharing mode the devices will be opened in.
+         * @return Common format and one conversion plan per device.
+         */
+        NegotiationResult negotiate(const std::vector<FormatCapabilities> &devices, ShareMode mode) const;
+
+        /**
+         * @brief Cost of converting a stream from one format to another under this model.
+         */
+        float conversionCost(uint32_t fromRate, uint16_t fromChannels, const SampleType &fromType,
+                             uint32_t toRate, uint16_t toChannels, const SampleType &toType) const;
+
+        const ConversionCosts &costs() const { return m_costs; }
+
+    private:
+        ConversionCosts m_costs;
+    };
+}
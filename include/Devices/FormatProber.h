@@ -0,0 +1,66 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <vector>
+#include "Devices/FormatCache.h"
+#include "Devices/FormatCapabilities.h"
+#include "Devices/FormatQuery.h"
+
+namespace Devices
+{
+    /**
+     * @brief Probes the capability matrix of several endpoints in parallel.
+     *
+     * Each device is probed on a worker thread (one device per worker at a time, so
+     * a query object is never shared). Devices already in the cache with the same
+     * driver version and spec are answered without any query; fresh results are
+     * stored back into the cache.
+     */
+    class AUDIO_SWITCHER_API FormatProber
+    {
+    public:
+        /**
+         * @brief Constructor.
+         *
+         * @param maxThreads Worker limit, 0 = one per device (up to 16).
+         */
+        explicit FormatProber(size_t maxThreads = 0) : m_maxThreads(maxThreads) {}
+
+        /**
+         * @brief Probes every device.
+         *
+         * @param devices Endpoints (non-null).
+         * @param spec Candidate grid.
+         * @param cache Optional cache consulted and updated.
+         * @return Capabilities in the order of `devices`; `.valid` is false for devices whose periods or mix format could not be read.
+         */
+        std::vector<FormatCapabilities> probe(const std::vector<IFormatQuery *> &devices,
+                                              const FormatProbeSpec &spec = FormatProbeSpec(),
+                                              FormatCache *cache = nullptr) const;
+
+        /**
+         * @brief Probes one device on the calling thread, bypassing any cache.
+         */
+        static FormatCapabilities probeDevice(IFormatQuery &device, const FormatProbeSpec &spec);
+
+    private:
+        size_t m_maxThreads;
+    };
+}
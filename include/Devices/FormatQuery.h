@@ -0,0 +1,92 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstdint>
+#include <string>
+#include "Utility/DeviceFormatInfo.h"
+
+namespace Devices
+{
+    /**
+     * @brief Stream sharing mode a format is probed for.
+     */
+    enum class ShareMode
+    {
+        Shared,   ///< Through the audio engine (mix format, engine conversions)
+        Exclusive ///< Directly to the driver
+    };
+
+    /**
+     * @brief Sample encoding: container size, significant bits and integer/float.
+     */
+    struct SampleType
+    {
+        uint16_t bitDepth = 16;  ///< Container bits per sample
+        uint16_t validBits = 16; ///< Significant bits (e.g. 24 in a 32-bit container)
+        bool isFloat = false;
+
+        bool operator==(const SampleType &other) const
+        {
+            return bitDepth == other.bitDepth && validBits == other.validBits && isFloat == other.isFloat;
+        }
+    };
+
+    /**
+     * @brief Capability queries against one audio endpoint.
+     *
+     * Abstracts IAudioClient so probing can run against real devices
+     * (WasapiFormatQuery) or simulated ones (FakeFormatQuery). A query object is used
+     * by one thread at a time, but not necessarily the thread that created it.
+     */
+    class AUDIO_SWITCHER_API IFormatQuery
+    {
+    public:
+        virtual ~IFormatQuery() = default;
+
+        /// Endpoint ID (IMMDevice::GetId()).
+        virtual std::wstring deviceId() const = 0;
+
+        /// Driver version or another string that changes when the driver does.
+        virtual std::wstring driverVersion() const = 0;
+
+        /**
+         * @brief Shared-mode mix format.
+         */
+        virtual bool mixFormat(Utility::DeviceFormatInfo &format) = 0;
+
+        /**
+         * @brief Default and minimum device periods in 100-ns units.
+         */
+        virtual bool devicePeriods(int64_t &defaultHns, int64_t &minimumHns) = 0;
+
+        /**
+         * @brief Whether the endpoint accepts a format as-is (no closest-match substitution).
+         *
+         * @param mode Sharing mode.
+         * @param format Rate, channels, container size and float flag (channelMask 0 = default layout).
+         * @param validBits Significant bits per sample.
+         */
+        virtual bool isFormatSupported(ShareMode mode, const Utility::DeviceFormatInfo &format, uint16_t validBits) = 0;
+
+        /**
+         * @brief Releases resources acquired by the queries, on the thread that made them.
+         */
+        virtual void finish() {}
+    };
+}
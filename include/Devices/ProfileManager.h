@@ -0,0 +1,157 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Backend/AudioBackend.h"
+#include "Devices/AudioProfile.h"
+
+namespace Devices
+{
+    /**
+     * @brief What one apply() did.
+     */
+    struct ProfileApplyResult
+    {
+        uint32_t calls = 0;      ///< Backend calls made (one setDefaultDevice covers several roles)
+        uint32_t skipped = 0;    ///< Settings already in the requested state
+        uint32_t unresolved = 0; ///< Settings whose endpoint is not present
+        uint32_t failures = 0;   ///< Backend calls that failed
+        uint32_t refreshCalls = 0; ///< Calls re-reading the state after endpoints changed (not in `calls`)
+    };
+
+    /**
+     * @brief Stores scenes and applies them with the fewest backend calls.
+     *
+     * While started, the manager mirrors the audio state it manages (defaults per
+     * flow and role, volume and mute of every active endpoint) from the backend's
+     * notifications, and keeps each profile compiled to endpoint handles. apply()
+     * then diffs the compiled profile against the mirror and only calls the backend
+     * for what differs, grouping the roles that move to the same endpoint into one
+     * setDefaultDevice(). Endpoint arrivals and removals mark the mirror stale; the
+     * next apply() re-reads the state and recompiles once.
+     */
+    class AUDIO_SWITCHER_API ProfileManager : private Backend::IDeviceListener
+    {
+    public:
+        ProfileManager();
+        ~ProfileManager() override;
+
+        // Registered with the backend: not copyable
+        ProfileManager(const ProfileManager &) = delete;
+        ProfileManager &operator=(const ProfileManager &) = delete;
+
+        /**
+         * @brief Registers with the audio backend and reads the current state.
+         */
+        HRESULT start();
+        void stop();
+
+        // --- Profiles ---
+
+        /**
+         * @brief Replaces every profile.
+         *
+         * @return false, keeping the current profiles, if any volume is outside 0..1.
+         */
+        bool setProfiles(std::vector<AudioProfile> profiles);
+
+        /**
+         * @brief Adds a profile or replaces the one with the same name.
+         *
+         * @return false, leaving the profiles unchanged, if a volume is outside 0..1.
+         */
+        bool setProfile(const AudioProfile &profile);
+
+        bool removeProfile(const std::string &name);
+        std::vector<AudioProfile> profiles() const;
+
+        CacheStatus load(const std::filesystem::path &path);
+        bool save(const std::filesystem::path &path) const;
+
+        /**
+         * @brief Profile of the current state: every default, and volume and mute of every active endpoint.
+         */
+        AudioProfile capture(const std::string &name) const;
+
+        // --- Application ---
+
+        /**
+         * @brief Applies a profile: defaults first, then volumes and mute states.
+         *
+         * @return S_OK, S_FALSE if some endpoints were not present, E_NOTFOUND for an
+         *         unknown profile, or the last failing backend call.
+         */
+        HRESULT apply(const std::string &name, ProfileApplyResult *result = nullptr);
+
+    private:
+        struct Endpoint
+        {
+            std::wstring id;
+            std::wstring name;
+            EDataFlow flow = eRender;
+            IMMDevice *device = nullptr; ///< Reference owned
+            bool active = false;
+            float volume = 1.0f;         ///< Mirrored from notifications
+            bool muted = false;
+        };
+
+        /// A profile resolved to endpoints.
+        struct Compiled
+        {
+            struct Level
+            {
+                Endpoint *endpoint = nullptr;
+                bool hasVolume = false;
+                float volume = 1.0f;
+                bool hasMute = false;
+                bool muted = false;
+            };
+
+            Endpoint *defaults[2][3] = {{nullptr, nullptr, nullptr}, {nullptr, nullptr, nullptr}};
+            std::vector<Level> levels;
+            uint32_t unresolved = 0;
+        };
+
+        void onDeviceAdded(const std::wstring &deviceId) override;
+        void onDeviceRemoved(const std::wstring &deviceId) override;
+        void onDeviceStateChanged(const std::wstring &deviceId, DWORD state) override;
+        void onDefaultDeviceChanged(EDataFlow flow, ERole role, const std::wstring &deviceId) override;
+        void onVolumeChanged(const std::wstring &deviceId, float volume, bool muted) override;
+
+        HRESULT readState(uint32_t *calls = nullptr);
+        Endpoint *resolveLocked(const ProfileDevice &device, EDataFlow flow) const;
+        const Compiled *compiledLocked(const AudioProfile &profile);
+
+        std::shared_ptr<Backend::IAudioBackend> m_backend;
+        bool m_registered = false;
+
+        mutable std::mutex m_mutex;
+        std::vector<AudioProfile> m_profiles;
+        std::unordered_map<std::string, Compiled> m_compiled; ///< By profile name; cleared on any change
+        std::unordered_map<std::wstring, std::unique_ptr<Endpoint>> m_endpoints; ///< Kept until stop()
+        std::wstring m_defaults[2][3];
+        bool m_stale = true;                                  ///< Endpoints changed since the last read
+    };
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Backend/AudioBackend.h"
+
+namespace Devices
+{
+    /**
+     * @brief Device transition a rule reacts to.
+     */
+    enum class RuleTrigger : uint8_t
+    {
+        Arrival, ///< Endpoint became active (plugged in, added, enabled)
+        Removal  ///< Endpoint stopped being active (unplugged, removed, disabled)
+    };
+
+    /**
+     * @brief Selects endpoints; every field that is set must match.
+     */
+    struct DeviceMatch
+    {
+        std::wstring id;                               ///< Exact endpoint ID
+        std::wstring namePattern;                      ///< Case-insensitive glob on the friendly name ("*USB*Headset*")
+        EDataFlow flow = eAll;                         ///< eRender, eCapture or eAll
+        EndpointFormFactor formFactor = UnknownFormFactor; ///< UnknownFormFactor matches any
+
+        /// Matches every endpoint (no field set).
+        bool any() const { return id.empty() && namePattern.empty() && flow == eAll && formFactor == UnknownFormFactor; }
+    };
+
+    enum class RuleActionType : uint8_t
+    {
+        SetDefault, ///< Default endpoint for `roles`
+        Mute,
+        Unmute,
+        SetVolume   ///< Master volume scalar `volume`
+    };
+
+    /**
+     * @brief One step of a rule, applied to every active endpoint matched by `target`.
+     *
+     * An empty target (DeviceMatch::any()) means the endpoint that triggered the rule.
+     */
+    struct RuleAction
+    {
+        RuleActionType type = RuleActionType::SetDefault;
+        DeviceMatch target;
+        uint32_t roles = Backend::AllRoles; ///< RoleMask bits, for SetDefault
+        float volume = 1.0f;                ///< 0..1, for SetVolume
+    };
+
+    /**
+     * @brief "When an endpoint matching `match` arrives (or goes), do `actions` in order."
+     */
+    struct DeviceRule
+    {
+        std::string name;
+        RuleTrigger trigger = RuleTrigger::Arrival;
+        DeviceMatch match;
+        std::vector<RuleAction> actions;
+    };
+
+    /**
+     * @brief Report of one rule run, passed to the firing callback.
+     */
+    struct RuleFiring
+    {
+        size_t rule = 0;            ///< Index in the rule list
+        std::wstring deviceId;      ///< Endpoint that triggered it
+        RuleTrigger trigger = RuleTrigger::Arrival;
+        uint32_t actions = 0;       ///< Backend calls made
+        uint32_t failures = 0;      ///< Of which failed
+        int64_t latencyNs = 0;      ///< From the notification to the last action returning
+    };
+
+    /**
+     * @brief Counters and event-to-action latency of a RuleEngine.
+     */
+    struct RuleEngineStats
+    {
+        uint64_t events = 0;        ///< Arrivals and removals seen
+        uint64_t firings = 0;       ///< Rules run
+        uint64_t actions = 0;       ///< Backend calls made by rules
+        uint64_t failures = 0;      ///< Backend calls that failed
+        uint64_t learned = 0;       ///< Endpoints compiled after start (first arrival of an unknown ID)
+        int64_t lastLatencyNs = 0;
+        int64_t maxLatencyNs = 0;
+        int64_t totalLatencyNs = 0; ///< Sum over firings (mean = total / firings)
+    };
+
+    /**
+     * @brief Automatic switching: runs rules when endpoints arrive or leave.
+     *
+     * Rules are compiled per endpoint when the engine starts: each known endpoint
+     * gets the list of rules it triggers, with every action already resolved to the
+     * endpoint handles it applies to. On a notification the engine only looks the
+     * endpoint up, checks the state transition and queues its compiled list, so the
+     * notification path never enumerates, reads properties or matches names. Rules
+     * run in order on the engine's worker thread, since Core Audio forbids changing
+     * defaults from inside its callbacks. An endpoint ID seen for the first time is
+     * read and compiled on the worker, then fires like any other.
+     */
+    class AUDIO_SWITCHER_API RuleEngine : private Backend::IDeviceListener
+    {
+    public:
+        RuleEngine();
+        ~RuleEngine() override;
+
+        // Owns a thread and a listener registration: not copyable
+        RuleEngine(const RuleEngine &) = delete;
+        RuleEngine &operator=(const RuleEngine &) = delete;
+
+        /**
+         * @brief Compiles the rules against the current endpoints and starts listening.
+         *
+         * Endpoints already present do not fire. Restarts if already running.
+         *
+         * @param rules Rules, evaluated in order for each transition.
+         * @param onFired Optional callback on the worker thread after each rule run.
+         * @return S_OK, E_INVALIDARG for a rule without actions or an invalid volume,
+         *         or the backend's error.
+         */
+        HRESULT start(std::vector<DeviceRule> rules, std::function<void(const RuleFiring &)> onFired = nullptr);
+
+        /**
+         * @brief Unregisters, drops queued work and joins the worker.
+         */
+        void stop();
+
+        bool running() const;
+
+        /**
+         * @brief Blocks until every queued transition has been handled or the timeout expires.
+         */
+        bool waitIdle(std::chrono::milliseconds timeout);
+
+        RuleEngineStats stats() const;
+
+    private:
+        struct Endpoint;
+
+        /// One action resolved to its target handles.
+        struct Step
+        {
+            RuleActionType type = RuleActionType::SetDefault;
+            uint32_t roles = 0;
+            float volume = 1.0f;
+            std::vector<Endpoint *> targets;
+        };
+
+        struct Binding
+        {
+            size_t rule = 0;
+            std::vector<Step> steps;
+        };
+
+        using Program = std::vector<Binding>;
+
+        struct Endpoint
+        {
+            std::wstring id;
+            std::wstring name;
+            EDataFlow flow = eRender;
+            EndpointFormFactor formFactor = UnknownFormFactor;
+            IMMDevice *device = nullptr; ///< Reference owned
+            std::atomic<bool> active{false};
+            std::shared_ptr<const Program> programs[2]; ///< Per RuleTrigger
+        };
+
+        struct Job
+        {
+            Endpoint *endpoint = nullptr; ///< nullptr: unknown ID, resolve first
+            std::wstring deviceId;
+            RuleTrigger trigger = RuleTrigger::Arrival;
+            std::shared_ptr<const Program> program;
+            std::chrono::steady_clock::time_point queued;
+        };
+
+        void onDeviceAdded(const std::wstring &deviceId) override;
+        void onDeviceRemoved(const std::wstring &deviceId) override;
+        void onDeviceStateChanged(const std::wstring &deviceId, DWORD state) override;
+
+        void transition(const std::wstring &deviceId, bool active);
+        void run();
+        void execute(const Job &job);
+        Endpoint *learn(const std::wstring &deviceId);
+        Endpoint *addEndpointLocked(const std::wstring &id, const std::wstring &name, EDataFlow flow,
+                                    EndpointFormFactor formFactor, IMMDevice *device);
+        void compileLocked();
+        std::vector<Endpoint *> resolveLocked(const RuleAction &action, Endpoint &source) const;
+        static bool Matches(const DeviceMatch &match, const Endpoint &endpoint);
+
+        std::shared_ptr<Backend::IAudioBackend> m_backend;
+        std::vector<DeviceRule> m_rules;
+        std::function<void(const RuleFiring &)> m_onFired;
+        bool m_registered = false;
+
+        mutable std::mutex m_mutex; ///< Guards the endpoint table and the queue
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        std::unordered_map<std::wstring, std::unique_ptr<Endpoint>> m_endpoints;
+        std::deque<Job> m_queue;
+        bool m_busy = false;
+        bool m_stopping = false;
+        RuleEngineStats m_stats;
+        std::thread m_worker;
+    };
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Backend/AudioBackend.h"
+#include "Backend/SessionBackend.h"
+
+namespace Devices
+{
+    /**
+     * @brief Counters of a SessionTable.
+     */
+    struct SessionTableStats
+    {
+        size_t devices = 0;        ///< Attached endpoints
+        size_t sessions = 0;       ///< Sessions currently in the table
+        size_t processes = 0;      ///< Distinct process IDs among them
+        uint64_t enumerations = 0; ///< Full enumerations done (one per attach)
+        uint64_t events = 0;       ///< Session notifications applied
+    };
+
+    /**
+     * @brief Per-application audio sessions of the attached endpoints, indexed by process.
+     *
+     * attach() enumerates an endpoint's sessions once and registers for its session
+     * notifications; from then on sessions created, expiring, disconnecting or
+     * changing volume update the table, so looking up or muting the sessions of a
+     * process is a hash lookup plus one call per session on the cached volume
+     * control instead of a walk over every endpoint's session manager.
+     */
+    class AUDIO_SWITCHER_API SessionTable : private Backend::ISessionListener
+    {
+    public:
+        explicit SessionTable(std::shared_ptr<Backend::ISessionBackend> backend = Backend::CreatePlatformSessionBackend());
+        ~SessionTable() override;
+
+        // Registered with the backend: not copyable
+        SessionTable(const SessionTable &) = delete;
+        SessionTable &operator=(const SessionTable &) = delete;
+
+        /**
+         * @brief Starts tracking the sessions of one endpoint.
+         *
+         * @return S_OK, S_FALSE if already attached, or the backend's error.
+         */
+        HRESULT attach(const std::wstring &deviceId);
+
+        /**
+         * @brief Attaches every active endpoint of a flow (from the audio backend).
+         */
+        HRESULT attachAll(EDataFlow flow = eRender);
+
+        void detach(const std::wstring &deviceId);
+        void detachAll();
+
+        // --- Queries ---
+
+        std::vector<Backend::SessionInfo> sessions() const;
+        std::vector<Backend::SessionInfo> sessionsForProcess(DWORD processId) const;
+
+        /**
+         * @brief Sessions whose executable matches ("teams.exe", case-insensitive).
+         */
+        std::vector<Backend::SessionInfo> sessionsForExecutable(const std::wstring &executable) const;
+
+        bool findSession(const std::wstring &instanceId, Backend::SessionInfo &out) const;
+
+        // --- Control (every matching session; E_NOTFOUND if there is none) ---
+
+        HRESULT setProcessVolume(DWORD processId, float volume);
+        HRESULT setProcessMute(DWORD processId, bool mute);
+        HRESULT setExecutableVolume(const std::wstring &executable, float volume);
+        HRESULT setExecutableMute(const std::wstring &executable, bool mute);
+        HRESULT setSessionVolume(const std::wstring &instanceId, float volume);
+        HRESULT setSessionMute(const std::wstring &instanceId, bool mute);
+
+        SessionTableStats stats() const;
+
+    private:
+        struct Entry
+        {
+            Backend::SessionInfo info;
+            std::shared_ptr<Backend::ISessionVolume> volume;
+        };
+
+        using Target = std::pair<std::wstring, std::shared_ptr<Backend::ISessionVolume>>;
+
+        void onSessionCreated(const Backend::SessionInfo &session,
+                              const std::shared_ptr<Backend::ISessionVolume> &volume) override;
+        void onSessionStateChanged(const std::wstring &instanceId, Backend::SessionState state) override;
+        void onSessionVolumeChanged(const std::wstring &instanceId, float volume, bool muted) override;
+        void onSessionDisconnected(const std::wstring &instanceId) override;
+
+        void upsertLocked(const Backend::SessionInfo &session, const std::shared_ptr<Backend::ISessionVolume> &volume);
+        void removeLocked(const std::wstring &instanceId);
+        std::vector<Backend::SessionInfo> collectLocked(const std::vector<std::wstring> *instanceIds) const;
+        std::vector<Target> targetsLocked(const std::vector<std::wstring> *instanceIds) const;
+        HRESULT apply(const std::vector<Target> &targets, const float *volume, const bool *mute);
+
+        std::shared_ptr<Backend::ISessionBackend> m_backend;
+
+        mutable std::mutex m_mutex;
+        std::vector<std::wstring> m_devices;
+        std::unordered_map<std::wstring, Entry> m_sessions;                        ///< By instance ID
+        std::unordered_map<DWORD, std::vector<std::wstring>> m_byProcess;          ///< Instance IDs per PID
+        std::unordered_map<std::wstring, std::vector<std::wstring>> m_byExecutable; ///< Per lower-case image name
+        uint64_t m_enumerations = 0;
+        uint64_t m_events = 0;
+    };
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Devices/DeviceMetadataCache.h"
+
+namespace Devices
+{
+    /**
+     * @brief Ways an endpoint differs between two snapshots (bit flags; a changed endpoint may combine several).
+     */
+    enum DeviceChangeFlags : uint32_t
+    {
+        DeviceAdded = 1,
+        DeviceRemoved = 2,
+        DeviceStateChanged = 4,   ///< DEVICE_STATE_* differs
+        DeviceRenamed = 8,        ///< Friendly name differs
+        DeviceFormatChanged = 16, ///< Mix format differs
+        DeviceDefaultChanged = 32 ///< Became or stopped being the default endpoint
+    };
+
+    /**
+     * @brief One endpoint that differs, by index into the two snapshots.
+     */
+    struct DeviceChange
+    {
+        static constexpr uint32_t None = UINT32_MAX;
+
+        uint32_t flags = 0;       ///< DeviceChangeFlags
+        uint32_t before = None;   ///< Index in the previous snapshot (None when added)
+        uint32_t after = None;    ///< Index in the new snapshot (None when removed)
+    };
+
+    /**
+     * @brief Minimal difference between two snapshots: unchanged endpoints are not listed.
+     *
+     * Changes appear in new-snapshot order, followed by removals in previous-snapshot order.
+     */
+    struct SnapshotDiff
+    {
+        std::vector<DeviceChange> changes;
+        size_t unchanged = 0;
+
+        bool empty() const { return changes.empty(); }
+
+        /// Changes carrying any of `flags`.
+        size_t count(uint32_t flags) const;
+    };
+
+    /**
+     * @brief Linear-time snapshot differ that keeps the last snapshot as its baseline.
+     *
+     * Each record is hashed once when it enters (FNV-1a over the ID, the name and the
+     * format). Endpoints are paired through an open-addressing table of ID hashes,
+     * confirmed by comparing the IDs, and equal content hashes mark a pair unchanged
+     * without comparing fields; the component hashes then say what changed. An ID
+     * seen with another flow is a different endpoint (removed and added).
+     *
+     * Not thread-safe.
+     */
+    class AUDIO_SWITCHER_API SnapshotDiffer
+    {
+    public:
+        /**
+         * @brief Diffs `snapshot` against the current baseline, then makes it the baseline.
+         *
+         * The first call reports every endpoint as added. The result stays valid until
+         * the next update(); its indices refer to previous() and current().
+         */
+        const SnapshotDiff &update(std::vector<DeviceRecord> snapshot);
+
+        /// Forgets the baseline, so the next update() reports everything as added.
+        void reset();
+
+        const std::vector<DeviceRecord> &previous() const { return m_previous; }
+        const std::vector<DeviceRecord> &current() const { return m_current; }
+
+    private:
+        struct Hashes
+        {
+            uint64_t id = 0;
+            uint64_t name = 0;
+            uint64_t format = 0;
+            uint64_t content = 0; ///< Name, format, state, default and flow together
+        };
+
+        void index();
+
+        std::vector<DeviceRecord> m_previous;
+        std::vector<DeviceRecord> m_current;
+        std::vector<Hashes> m_previousHashes;
+        std::vector<Hashes> m_currentHashes;
+        std::vector<uint32_t> m_table; ///< Open addressing over m_current: index + 1, 0 when empty
+        std::vector<uint8_t> m_matched;
+        SnapshotDiff m_diff;
+    };
+
+    /**
+     * @brief One-shot diff of two snapshots (see SnapshotDiffer).
+     */
+    AUDIO_SWITCHER_API SnapshotDiff DiffSnapshots(const std::vector<DeviceRecord> &before,
+                                                  const std::vector<DeviceRecord> &after);
+}
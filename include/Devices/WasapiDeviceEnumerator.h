@@ -0,0 +1,35 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <vector>
+#include "Devices/DeviceMetadataCache.h"
+
+namespace Devices
+{
+    /**
+     * @brief Enumerates active render and capture endpoints with their names and mix formats.
+     *
+     * Suitable as the DeviceDirectory enumerator: initialises COM on the calling thread
+     * and reports failures through the return value instead of throwing.
+     *
+     * @param out Receives render devices first, then capture devices.
+     * @return true if both flows could be enumerated.
+     */
+    AUDIO_SWITCHER_API bool EnumerateWasapiDevices(std::vector<DeviceRecord> &out);
+}
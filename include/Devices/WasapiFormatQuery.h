@@ -0,0 +1,76 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <mmdeviceapi.h>
+#include "Devices/FormatQuery.h"
+
+struct IAudioClient;
+
+namespace Devices
+{
+    /**
+     * @brief IFormatQuery backed by a real endpoint's IAudioClient.
+     *
+     * The device ID and driver version are read at construction. The IAudioClient is
+     * activated lazily by the first query and released by finish(), both on the
+     * probing thread, so it never outlives that thread's COM apartment.
+     */
+    class AUDIO_SWITCHER_API WasapiFormatQuery : public IFormatQuery
+    {
+    public:
+        /**
+         * @brief Constructor.
+         *
+         * @param device Endpoint (AddRef'd; released in the destructor).
+         */
+        explicit WasapiFormatQuery(IMMDevice *device);
+        ~WasapiFormatQuery() override;
+
+        // Non-copyable (owns COM references)
+        WasapiFormatQuery(const WasapiFormatQuery &) = delete;
+        WasapiFormatQuery &operator=(const WasapiFormatQuery &) = delete;
+
+        std::wstring deviceId() const override { return m_id; }
+        std::wstring driverVersion() const override { return m_driverVersion; }
+        bool mixFormat(Utility::DeviceFormatInfo &format) override;
+        bool devicePeriods(int64_t &defaultHns, int64_t &minimumHns) override;
+        bool isFormatSupported(ShareMode mode, const Utility::DeviceFormatInfo &format, uint16_t validBits) override;
+        void finish() override;
+
+    private:
+        bool ensureClient();
+
+        IMMDevice *m_device = nullptr;
+        IAudioClient *m_client = nullptr;
+        std::wstring m_id;
+        std::wstring m_driverVersion;
+    };
+
+    /**
+     * @brief Creates a query object for every active endpoint of a data flow.
+     *
+     * @param flow eRender or eCapture.
+     * @return Query objects in enumeration order.
+     * @throws std::runtime_error If device enumeration fails.
+     */
+    AUDIO_SWITCHER_API std::vector<std::unique_ptr<IFormatQuery>> CreateWasapiFormatQueries(EDataFlow flow);
+}
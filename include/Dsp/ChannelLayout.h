@@ -0,0 +1,97 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstdint>
+#include "Utility/DeviceFormatInfo.h"
+
+namespace Dsp
+{
+    /**
+     * @brief Speaker position bits, identical to the SPEAKER_* values of ksmedia.h.
+     *
+     * Interleaved channels are always ordered by ascending bit value, exactly as
+     * WAVEFORMATEXTENSIBLE defines it.
+     */
+    namespace Speaker
+    {
+        constexpr uint32_t FrontLeft = 0x1;
+        constexpr uint32_t FrontRight = 0x2;
+        constexpr uint32_t FrontCenter = 0x4;
+        constexpr uint32_t LowFrequency = 0x8;
+        constexpr uint32_t BackLeft = 0x10;
+        constexpr uint32_t BackRight = 0x20;
+        constexpr uint32_t FrontLeftOfCenter = 0x40;
+        constexpr uint32_t FrontRightOfCenter = 0x80;
+        constexpr uint32_t BackCenter = 0x100;
+        constexpr uint32_t SideLeft = 0x200;
+        constexpr uint32_t SideRight = 0x400;
+        constexpr uint32_t TopCenter = 0x800;
+        constexpr uint32_t TopFrontLeft = 0x1000;
+        constexpr uint32_t TopFrontCenter = 0x2000;
+        constexpr uint32_t TopFrontRight = 0x4000;
+        constexpr uint32_t TopBackLeft = 0x8000;
+        constexpr uint32_t TopBackCenter = 0x10000;
+        constexpr uint32_t TopBackRight = 0x20000;
+    }
+
+    /**
+     * @brief Common channel layouts (KSAUDIO_SPEAKER_* equivalents).
+     */
+    namespace Layout
+    {
+        constexpr uint32_t Mono = Speaker::FrontCenter;
+        constexpr uint32_t Stereo = Speaker::FrontLeft | Speaker::FrontRight;
+        constexpr uint32_t Quad = Stereo | Speaker::BackLeft | Speaker::BackRight;
+        constexpr uint32_t Surround = Stereo | Speaker::FrontCenter | Speaker::BackCenter;
+        constexpr uint32_t FivePointOne = Stereo | Speaker::FrontCenter | Speaker::LowFrequency |
+                                          Speaker::BackLeft | Speaker::BackRight;
+        constexpr uint32_t FivePointOneSurround = Stereo | Speaker::FrontCenter | Speaker::LowFrequency |
+                                                  Speaker::SideLeft | Speaker::SideRight;
+        constexpr uint32_t SevenPointOne = FivePointOne | Speaker::FrontLeftOfCenter | Speaker::FrontRightOfCenter;
+        constexpr uint32_t SevenPointOneSurround = FivePointOne | Speaker::SideLeft | Speaker::SideRight;
+    }
+
+    /**
+     * @brief Counts the speaker positions present in a channel mask.
+     */
+    AUDIO_SWITCHER_API uint32_t ChannelCount(uint32_t channelMask);
+
+    /**
+     * @brief Returns the interleaved index of a speaker inside a channel mask.
+     *
+     * @return Zero-based channel index, or -1 if the speaker is not part of the mask.
+     */
+    AUDIO_SWITCHER_API int ChannelIndex(uint32_t channelMask, uint32_t speaker);
+
+    /**
+     * @brief Returns the layout Windows assumes for a plain WAVEFORMATEX with the given channel count.
+     *
+     * @param channels Number of interleaved channels.
+     * @return Channel mask (e.g. 2 → Stereo, 6 → 5.1, 8 → 7.1 surround).
+     */
+    AUDIO_SWITCHER_API uint32_t DefaultChannelMask(uint16_t channels);
+
+    /**
+     * @brief Returns the channel mask that describes a device format.
+     *
+     * Uses `channelMask` when it is set and consistent with `channels`,
+     * otherwise falls back to DefaultChannelMask().
+     */
+    AUDIO_SWITCHER_API uint32_t EffectiveChannelMask(const Utility::DeviceFormatInfo &format);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Utility/DeviceFormatInfo.h"
+
+namespace Dsp
+{
+    /**
+     * @brief Up/down-mix matrix between two speaker layouts.
+     *
+     * Builds the standard fold-down (7.1 → 5.1 → stereo → mono) and passive
+     * up-mix (mono → stereo → 5.1 → 7.1) coefficients from two channel masks and
+     * applies them to interleaved float audio.
+     *
+     * Processing works in blocks: each block is split into planar scratch buffers,
+     * mixed with vectorised multiply-accumulate over the non-zero coefficients only,
+     * and re-interleaved. All scratch memory is allocated by build(), so process()
+     * never allocates.
+     */
+    class AUDIO_SWITCHER_API ChannelMatrix
+    {
+    public:
+        /// Frames processed per internal block.
+        static constexpr size_t BlockFrames = 256;
+
+        ChannelMatrix() = default;
+
+        /**
+         * @brief Builds the matrix for a source/destination layout pair.
+         *
+         * @param srcMask Speaker mask of the input stream.
+         * @param dstMask Speaker mask of the output stream.
+         * @param normalize Scale all coefficients so no output can exceed full scale.
+         * @param lfeGain Gain used when folding LFE into the front channels (0 = drop LFE).
+         * @return true if both masks are non-empty, false otherwise.
+         */
+        bool build(uint32_t srcMask, uint32_t dstMask, bool normalize = true, float lfeGain = 0.0f);
+
+        /**
+         * @brief Builds the matrix from two device formats (see EffectiveChannelMask()).
+         */
+        bool build(const Utility::DeviceFormatInfo &src, const Utility::DeviceFormatInfo &dst, bool normalize = true);
+
+        /**
+         * @brief Mixes interleaved input frames into interleaved output frames.
+         *
+         * @param in `frames * srcChannels()` samples.
+         * @param out `frames * dstChannels()` samples. Must not alias `in`.
+         * @param frames Number of frames.
+         */
+        void process(const float *in, float *out, size_t frames);
+
+        /**
+         * @brief Returns the coefficient applied from a source channel to a destination channel.
+         */
+        float coefficient(uint32_t dstChannel, uint32_t srcChannel) const;
+
+        bool isValid() const { return m_srcChannels != 0 && m_dstChannels != 0; }
+        bool isIdentity() const { return m_identity; }
+        uint32_t srcChannels() const { return m_srcChannels; }
+        uint32_t dstChannels() const { return m_dstChannels; }
+        uint32_t srcMask() const { return m_srcMask; }
+        uint32_t dstMask() const { return m_dstMask; }
+
+    private:
+        struct Tap
+        {
+            uint32_t src = 0;  ///< Source channel index
+            float gain = 0.0f; ///< Coefficient
+        };
+
+        uint32_t m_srcMask = 0;
+        uint32_t m_dstMask = 0;
+        uint32_t m_srcChannels = 0;
+        uint32_t m_dstChannels = 0;
+        bool m_identity = false;
+
+        std::vector<float> m_coefficients; ///< Dense dst-major matrix [dst * srcChannels + src]
+        std::vector<Tap> m_taps;           ///< Non-zero coefficients grouped by destination
+        std::vector<uint32_t> m_tapOffsets; ///< m_taps range of each destination (dstChannels + 1 entries)
+        std::vector<float> m_planarIn;     ///< srcChannels * BlockFrames scratch
+        std::vector<float> m_planarOut;    ///< dstChannels * BlockFrames scratch
+    };
+}
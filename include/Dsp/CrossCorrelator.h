@@ -0,0 +1,65 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <vector>
+#include "Dsp/Fft.h"
+
+namespace Dsp
+{
+    /**
+     * @brief Location of a reference signal inside a recording.
+     */
+    struct CorrelationPeak
+    {
+        double lag = 0.0;        ///< Offset of the reference in the recording, in samples (sub-sample accurate)
+        float peak = 0.0f;       ///< Normalised correlation at the peak (1.0 = exact scaled copy)
+        float confidence = 0.0f; ///< Peak height over the RMS of the correlation (higher is more certain)
+        bool valid = false;
+    };
+
+    /**
+     * @brief FFT-based cross-correlation of a reference against a recording.
+     *
+     * Computes IFFT(FFT(recording) · conj(FFT(reference))) once, which costs
+     * O(N log N) instead of the O(N·M) of a direct search.
+     */
+    class AUDIO_SWITCHER_API CrossCorrelator
+    {
+    public:
+        CrossCorrelator() = default;
+
+        /**
+         * @brief Finds the best non-negative lag of `reference` within `recording`.
+         *
+         * @param reference Known signal (e.g. GenerateLogChirp()).
+         * @param referenceLength Samples in `reference`.
+         * @param recording Captured signal.
+         * @param recordingLength Samples in `recording`.
+         * @return The peak; `valid` is false if either input is empty.
+         */
+        CorrelationPeak findDelay(const float *reference, size_t referenceLength,
+                                  const float *recording, size_t recordingLength);
+
+    private:
+        Fft m_fft;
+        std::vector<float> m_refRe, m_refIm;
+        std::vector<float> m_recRe, m_recIm;
+    };
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Dsp
+{
+    /**
+     * @brief In-place radix-2 complex FFT on split real/imaginary arrays.
+     *
+     * Twiddle factors and the bit-reversal permutation are computed once by
+     * configure(); transforms never allocate. Butterflies of stages with at least
+     * four butterflies per group run four at a time with SSE2.
+     */
+    class AUDIO_SWITCHER_API Fft
+    {
+    public:
+        Fft() = default;
+
+        /**
+         * @brief Precomputes tables for a transform size.
+         *
+         * @param size Transform length, a power of two >= 2.
+         * @return true on success, false if `size` is not a power of two.
+         */
+        bool configure(size_t size);
+
+        /**
+         * @brief Forward transform, X[k] = sum x[n] e^(-2πikn/N). Unscaled.
+         */
+        void forward(float *re, float *im) const;
+
+        /**
+         * @brief Inverse transform, scaled by 1/N so inverse(forward(x)) == x.
+         */
+        void inverse(float *re, float *im) const;
+
+        size_t size() const { return m_size; }
+
+    private:
+        void transform(float *re, float *im) const;
+
+        size_t m_size = 0;
+        std::vector<uint32_t> m_bitReverse; ///< Swap pairs (i, j) with i < j, flattened
+        std::vector<float> m_twiddleRe;     ///< Stage tables: stage with half-size m at [m - 1, 2m - 1)
+        std::vector<float> m_twiddleIm;
+    };
+}
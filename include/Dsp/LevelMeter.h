@@ -0,0 +1,135 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Utility/DeviceFormatInfo.h"
+
+namespace Dsp
+{
+    /**
+     * @brief Per-channel measurements over the rolling window.
+     */
+    struct ChannelLevels
+    {
+        float peak = 0.0f;           ///< Sample peak (linear, 1.0 = full scale)
+        float truePeak = 0.0f;       ///< 4x oversampled (inter-sample) peak, 0 if disabled
+        float rms = 0.0f;            ///< Root mean square
+        float dcOffset = 0.0f;       ///< Mean sample value
+        uint64_t clippedSamples = 0; ///< Samples at or beyond the clip threshold in the window
+        uint64_t totalClipped = 0;   ///< Clipped samples since configure()/reset()
+    };
+
+    /**
+     * @brief Single-pass peak / true-peak / RMS / DC / clip analysis of interleaved audio.
+     *
+     * Accepts raw buffers in any format DeviceFormatInfo describes (u8, s16, s24, s32, f32).
+     * Input is converted in small chunks to planar float scratch and analysed with SSE2
+     * kernels while still in cache, so each buffer is read exactly once.
+     *
+     * Results cover a rolling window made of fixed-size blocks. Each completed block's
+     * partial sums are added to running totals and the block leaving the window is
+     * subtracted, so the window is updated incrementally rather than recomputed.
+     */
+    class AUDIO_SWITCHER_API LevelMeter
+    {
+    public:
+        /// Frames converted per chunk (keeps the planar scratch in L1).
+        static constexpr size_t ChunkFrames = 256;
+
+        LevelMeter() = default;
+
+        /**
+         * @brief Allocates state for a stream format.
+         *
+         * @param format Format of the buffers passed to process().
+         * @param windowMs Rolling window length.
+         * @param blockMs Granularity of the window (results update once per block).
+         * @param truePeak Enable 4x oversampled true-peak measurement.
+         * @return true on success, false if the format is not supported.
+         */
+        bool configure(const Utility::DeviceFormatInfo &format, uint32_t windowMs = 3000,
+                       uint32_t blockMs = 10, bool truePeak = true);
+
+        /**
+         * @brief Overrides the clip threshold (linear, default: largest code of the format).
+         */
+        void setClipThreshold(float threshold) { m_clipThreshold = threshold; }
+
+        /**
+         * @brief Analyses a buffer of interleaved frames in the configured format.
+         *
+         * @param data Raw frames.
+         * @param frames Frame count.
+         */
+        void process(const void *data, size_t frames);
+
+        /**
+         * @brief Returns the rolling-window levels of one channel.
+         */
+        ChannelLevels levels(uint32_t channel) const;
+
+        /**
+         * @brief Clears all history.
+         */
+        void reset();
+
+        uint32_t channels() const { return m_channels; }
+
+    private:
+        struct BlockStats
+        {
+            float peak = 0.0f;
+            float truePeak = 0.0f;
+            double sum = 0.0;
+            double sumSq = 0.0;
+            uint32_t clipped = 0;
+        };
+
+        struct ChannelState
+        {
+            BlockStats current;                ///< Block being accumulated
+            std::vector<BlockStats> ring;      ///< Completed blocks in the window
+            double windowSum = 0.0;
+            double windowSumSq = 0.0;
+            uint64_t windowClipped = 0;
+            uint64_t totalClipped = 0;
+            float history[16] = {};            ///< Last samples for the true-peak interpolator
+        };
+
+        void finishBlock();
+        float truePeakChunk(ChannelState &state, const float *x, size_t n);
+
+        Utility::DeviceFormatInfo m_format;
+        uint32_t m_channels = 0;
+        size_t m_blockFrames = 0;
+        size_t m_blockFill = 0;      ///< Frames accumulated in the current block
+        size_t m_windowBlocks = 0;
+        size_t m_ringPos = 0;        ///< Next ring slot to overwrite
+        size_t m_ringCount = 0;      ///< Completed blocks held (<= m_windowBlocks)
+        float m_clipThreshold = 1.0f;
+        bool m_truePeak = false;
+
+        std::vector<ChannelState> m_state;
+        std::vector<float> m_planar;   ///< channels * ChunkFrames scratch
+        std::vector<float> m_convert;  ///< Interleaved float scratch
+        std::vector<float> m_tpBuffer; ///< History + chunk for the interpolator
+    };
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Dsp
+{
+    /**
+     * @brief Streaming linear-interpolation sample-rate converter for interleaved float frames.
+     *
+     * Pull model: the caller asks how many input frames a given number of output frames
+     * needs, supplies exactly that many and gets the output. The interpolation phase and
+     * the last two input frames are carried between calls, so consecutive blocks join
+     * without clicks. Output lags the input by one frame, which lets every block consume
+     * whole frames without look-ahead. Linear interpolation is meant for alerts and
+     * monitoring, not mastering.
+     */
+    class AUDIO_SWITCHER_API LinearResampler
+    {
+    public:
+        LinearResampler() = default;
+
+        /**
+         * @brief Sets the channel count and conversion ratio, and resets the state.
+         *
+         * @return true on success.
+         */
+        bool configure(uint32_t channels, uint32_t inputRate, uint32_t outputRate);
+
+        /**
+         * @brief Restarts from silence.
+         */
+        void reset();
+
+        /**
+         * @brief Number of input frames process() consumes to produce `outputFrames`.
+         */
+        size_t inputFramesFor(size_t outputFrames) const;
+
+        /**
+         * @brief Largest output that can be produced from `inputFrames` frames.
+         */
+        size_t outputFramesFor(size_t inputFrames) const;
+
+        /**
+         * @brief Produces `outputFrames` frames from exactly inputFramesFor(outputFrames) input frames.
+         */
+        void process(const float *in, float *out, size_t outputFrames);
+
+        uint32_t channels() const { return m_channels; }
+
+    private:
+        uint32_t m_channels = 0;
+        double m_step = 1.0;        ///< Input frames per output frame
+        double m_phase = 1.0;       ///< Position of the next output, in input frames after the last consumed one
+        std::vector<float> m_history; ///< Last two consumed frames, older first
+    };
+}
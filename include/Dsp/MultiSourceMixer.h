@@ -0,0 +1,115 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Dsp
+{
+    /**
+     * @brief Sums N interleaved float inputs into one output with smoothed per-input gain.
+     *
+     * Input buffers are owned and preallocated by the mixer (see input()). Mixing is
+     * cache-blocked: the output is produced in blocks of BlockSamples, and every input
+     * is accumulated into the same block while it is still in L1, instead of streaming
+     * the whole output once per input.
+     *
+     * Gains may be changed from any thread; the audio thread ramps towards the new
+     * target with a one-pole smoother so changes never click.
+     */
+    class AUDIO_SWITCHER_API MultiSourceMixer
+    {
+    public:
+        /// Samples (not frames) per cache block: 4 KB of output.
+        static constexpr size_t BlockSamples = 1024;
+
+        MultiSourceMixer() = default;
+
+        // Owns atomics and raw buffers: not copyable
+        MultiSourceMixer(const MultiSourceMixer &) = delete;
+        MultiSourceMixer &operator=(const MultiSourceMixer &) = delete;
+
+        /**
+         * @brief Allocates all buffers. Must be called before mixing.
+         *
+         * @param maxInputs Maximum number of inputs.
+         * @param channels Interleaved channel count shared by all inputs and the output.
+         * @param maxFrames Largest frame count passed to mix().
+         * @param sampleRate Sample rate, used to derive the gain smoothing coefficient.
+         * @param smoothingMs Gain smoothing time constant in milliseconds (0 = instant).
+         * @return true on success, false on invalid arguments.
+         */
+        bool configure(uint32_t maxInputs, uint32_t channels, size_t maxFrames,
+                       uint32_t sampleRate, float smoothingMs = 10.0f);
+
+        /**
+         * @brief Returns the preallocated interleaved buffer of an input.
+         *
+         * Fill the first `frames * channels()` samples before calling mix().
+         */
+        float *input(uint32_t index);
+
+        /**
+         * @brief Sets the target gain of an input (linear). Thread-safe.
+         *
+         * @param index Input index.
+         * @param gain Linear gain.
+         * @param immediate Skip smoothing. Only use while mix() is not running (e.g. during setup).
+         */
+        void setGain(uint32_t index, float gain, bool immediate = false);
+
+        /**
+         * @brief Enables the soft limiter on the summed output.
+         *
+         * @param enabled Whether to limit.
+         * @param knee Level (0..1) above which the limiter starts compressing.
+         */
+        void setSoftClip(bool enabled, float knee = 0.8f);
+
+        /**
+         * @brief Mixes the first `inputCount` inputs into `out`.
+         *
+         * @param out Interleaved output, `frames * channels()` samples.
+         * @param frames Frames to mix (<= maxFrames()).
+         * @param inputCount Number of inputs to sum (<= maxInputs()).
+         */
+        void mix(float *out, size_t frames, uint32_t inputCount);
+
+        uint32_t maxInputs() const { return m_maxInputs; }
+        uint32_t channels() const { return m_channels; }
+        size_t maxFrames() const { return m_maxFrames; }
+
+    private:
+        uint32_t m_maxInputs = 0;
+        uint32_t m_channels = 0;
+        size_t m_maxFrames = 0;
+        size_t m_stride = 0;        ///< Samples between consecutive input buffers
+        float m_smoothing = 1.0f;   ///< Smoothing coefficient of a full BlockSamples block
+        float m_invTauFrames = 0.0f; ///< 1 / time constant in frames (0 = no smoothing), for shorter blocks
+        std::atomic<bool> m_softClip{false};
+        std::atomic<float> m_knee{0.8f};
+
+        std::vector<float> m_inputs;                      ///< maxInputs * m_stride samples
+        std::unique_ptr<std::atomic<float>[]> m_targets;  ///< Target gains (any thread)
+        std::vector<float> m_current;                     ///< Smoothed gains (audio thread)
+    };
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include "Utility/DeviceFormatInfo.h"
+
+namespace Dsp
+{
+    /**
+     * @brief Returns true if samples of this format can be converted by ToFloat()/FromFloat().
+     *
+     * Supported: 8-bit unsigned, 16-bit, packed 24-bit and 32-bit integer PCM, and 32-bit float.
+     */
+    AUDIO_SWITCHER_API bool IsConvertibleFormat(const Utility::DeviceFormatInfo &format);
+
+    /**
+     * @brief Converts device-format samples to normalised float in [-1, 1).
+     *
+     * @param src Raw samples in `format`.
+     * @param dst Output floats, `samples` entries.
+     * @param samples Number of samples (frames * channels).
+     * @param format Format describing `src`.
+     * @return true on success, false if the format is not convertible.
+     */
+    AUDIO_SWITCHER_API bool ToFloat(const void *src, float *dst, size_t samples, const Utility::DeviceFormatInfo &format);
+
+    /**
+     * @brief Converts normalised float samples to the device format, with saturation.
+     *
+     * @param src Float samples.
+     * @param dst Raw output in `format`.
+     * @param samples Number of samples (frames * channels).
+     * @param format Format describing `dst`.
+     * @return true on success, false if the format is not convertible.
+     */
+    AUDIO_SWITCHER_API bool FromFloat(const float *src, void *dst, size_t samples, const Utility::DeviceFormatInfo &format);
+}
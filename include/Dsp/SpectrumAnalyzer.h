@@ -0,0 +1,165 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Dsp/Fft.h"
+#include "Utility/DeviceFormatInfo.h"
+
+namespace Dsp
+{
+    /**
+     * @brief Analysis window shapes.
+     */
+    enum class WindowType
+    {
+        Hann,
+        BlackmanHarris ///< 4-term, ~92 dB side lobes
+    };
+
+    /**
+     * @brief Configuration of a SpectrumAnalyzer.
+     */
+    struct SpectrumConfig
+    {
+        size_t fftSize = 2048;                ///< Power of two
+        WindowType window = WindowType::Hann;
+        float overlap = 0.5f;                 ///< 0 .. 0.95, fraction of fftSize shared by consecutive frames
+        uint32_t bandCount = 32;              ///< Logarithmically spaced output bands
+        float minFrequency = 20.0f;           ///< Lower edge of the first band (Hz)
+        float maxFrequency = 20000.0f;        ///< Upper edge of the last band (Hz), clamped to Nyquist
+    };
+
+    /**
+     * @brief Band magnitudes published by a SpectrumAnalyzer.
+     */
+    struct SpectrumSnapshot
+    {
+        uint64_t sequence = 0;    ///< Number of analyses performed when this snapshot was published
+        std::vector<float> bands; ///< Mean linear magnitude per band (1.0 = full-scale sine)
+    };
+
+    /**
+     * @brief Streaming FFT spectrum analyser for one audio stream.
+     *
+     * Interleaved audio is downmixed to mono into a circular frame buffer; every `hop`
+     * samples the latest fftSize samples are windowed and transformed in place. Band
+     * averages are published through a triple buffer: the audio thread never waits for
+     * the UI and the UI always reads a complete, consistent snapshot.
+     *
+     * Threading: push()/pushRaw() from one producer thread, readSnapshot() from one
+     * consumer thread. All memory is allocated in configure().
+     */
+    class AUDIO_SWITCHER_API SpectrumAnalyzer
+    {
+    public:
+        SpectrumAnalyzer() = default;
+
+        SpectrumAnalyzer(const SpectrumAnalyzer &) = delete;
+        SpectrumAnalyzer &operator=(const SpectrumAnalyzer &) = delete;
+
+        /**
+         * @brief Allocates buffers and precomputes window, twiddles and band edges.
+         *
+         * @param config Analysis parameters.
+         * @param sampleRate Stream sample rate in Hz.
+         * @param maxFrames Largest frame count per pushRaw() call (sizes the conversion scratch).
+         * @return true on success, false on invalid configuration.
+         */
+        bool configure(const SpectrumConfig &config, uint32_t sampleRate, size_t maxFrames = 4800);
+
+        /**
+         * @brief Feeds interleaved float frames (channels are averaged to mono).
+         *
+         * @return Number of analyses performed during this call.
+         */
+        size_t push(const float *interleaved, size_t frames, uint32_t channels);
+
+        /**
+         * @brief Feeds raw interleaved frames in a device format (see Dsp/SampleFormat.h).
+         *
+         * @return Number of analyses performed, 0 if the format is not convertible.
+         */
+        size_t pushRaw(const void *data, size_t frames, const Utility::DeviceFormatInfo &format);
+
+        /**
+         * @brief Copies the latest published bands. Lock-free, single consumer.
+         *
+         * @param out Receives the snapshot (reuses its capacity).
+         * @return true if a snapshot newer than the previous call was available.
+         */
+        bool readSnapshot(SpectrumSnapshot &out);
+
+        /**
+         * @brief Full-resolution magnitudes of the last analysis (fftSize/2 + 1 bins).
+         *
+         * Only valid on the producer thread.
+         */
+        const std::vector<float> &magnitudes() const { return m_magnitudes; }
+
+        /**
+         * @brief Centre frequency of an FFT bin in Hz.
+         */
+        float binFrequency(size_t bin) const;
+
+        /**
+         * @brief Lower and upper edges (Hz) of an output band.
+         */
+        void bandEdges(uint32_t band, float &low, float &high) const;
+
+        const SpectrumConfig &config() const { return m_config; }
+        uint64_t analysisCount() const { return m_sequence; }
+
+    private:
+        void analyze();
+        void publish();
+
+        SpectrumConfig m_config;
+        uint32_t m_sampleRate = 0;
+        size_t m_hop = 0;
+        size_t m_maxFrames = 0;
+
+        Fft m_fft;
+        std::vector<float> m_window;
+        float m_amplitudeScale = 0.0f; ///< 2 / sum(window): full-scale sine → 1.0
+
+        std::vector<float> m_history;  ///< Circular mono buffer of fftSize samples
+        size_t m_writePos = 0;
+        size_t m_filled = 0;           ///< Samples in history (saturates at fftSize)
+        size_t m_sinceLast = 0;        ///< Samples pushed since the last analysis
+
+        std::vector<float> m_re;
+        std::vector<float> m_im;
+        std::vector<float> m_magnitudes;
+        std::vector<uint32_t> m_bandFirst; ///< First bin of each band
+        std::vector<uint32_t> m_bandLast;  ///< Last bin (inclusive) of each band
+        std::vector<float> m_convert;      ///< pushRaw() scratch
+
+        // Triple buffer: producer owns m_back, consumer owns m_front, m_middle is exchanged.
+        static constexpr uint32_t DirtyBit = 4;
+        std::vector<float> m_slots[3];
+        uint64_t m_slotSequence[3] = {0, 0, 0};
+        uint32_t m_back = 0;
+        uint32_t m_front = 2;
+        std::atomic<uint32_t> m_middle{1};
+        uint64_t m_sequence = 0;
+    };
+}
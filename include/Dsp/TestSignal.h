@@ -0,0 +1,47 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Dsp
+{
+    /**
+     * @brief Exponential (log) sine sweep with short raised-cosine fades.
+     *
+     * @param sampleRate Sample rate in Hz.
+     * @param durationMs Sweep length.
+     * @param startHz Start frequency.
+     * @param endHz End frequency (clamped below Nyquist).
+     * @param amplitude Peak amplitude (0..1).
+     * @return Mono samples, empty on invalid arguments.
+     */
+    AUDIO_SWITCHER_API std::vector<float> GenerateLogChirp(uint32_t sampleRate, uint32_t durationMs, float startHz = 100.0f,
+                                                           float endHz = 10000.0f, float amplitude = 0.5f);
+
+    /**
+     * @brief Maximum-length sequence from a Fibonacci LFSR, mapped to ±amplitude.
+     *
+     * @param order Register length, 2..20 (sequence length 2^order - 1).
+     * @param amplitude Output level (0..1).
+     * @return Mono samples, empty if the order is out of range.
+     */
+    AUDIO_SWITCHER_API std::vector<float> GenerateMls(uint32_t order, float amplitude = 0.5f);
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Dsp/Fft.h"
+#include "Utility/DeviceFormatInfo.h"
+
+namespace Dsp
+{
+    /**
+     * @brief Tuning of the voice-activity detector.
+     */
+    struct VadConfig
+    {
+        uint32_t frameMs = 10;          ///< Analysis frame length
+        float snrThresholdDb = 9.0f;    ///< Frame energy above the noise floor needed for speech
+        float minLevelDb = -55.0f;      ///< Absolute level (dBFS) below which a frame is never speech
+        float maxFlatness = 0.45f;      ///< Spectral flatness (0 tonal .. 1 white noise) above which a frame is noise
+        float minZeroCrossing = 0.01f;  ///< Zero crossings per sample, lower bound for voiced speech
+        float maxZeroCrossing = 0.30f;  ///< Upper bound (above: hiss / fricative noise)
+        uint32_t attackFrames = 3;      ///< Consecutive speech frames needed to become active
+        uint32_t hangoverMs = 400;      ///< Time active is held after the last speech frame
+    };
+
+    /**
+     * @brief Features of the most recent frame (for tuning and diagnostics).
+     */
+    struct VadFeatures
+    {
+        float levelDb = -120.0f;      ///< Frame RMS in dBFS
+        float noiseFloorDb = -120.0f; ///< Tracked noise floor in dBFS
+        float zeroCrossing = 0.0f;    ///< Zero crossings per sample
+        float flatness = 1.0f;        ///< Spectral flatness in the 300–4000 Hz speech band
+        bool speechFrame = false;     ///< Frame-level decision before attack/hangover
+    };
+
+    /**
+     * @brief Energy / zero-crossing / spectral-flatness voice-activity detector.
+     *
+     * Audio is framed (default 10 ms) and each frame is classified from three features:
+     * level above an adaptive noise floor, zero-crossing rate and spectral flatness of
+     * the speech band. The frame decisions drive a small state machine: `attackFrames`
+     * consecutive speech frames switch to active (bounded reaction time), and the state
+     * is held for `hangoverMs` after the last speech frame so pauses between words do
+     * not toggle it.
+     *
+     * Per frame the cost is one small FFT plus a few linear passes; no allocation after
+     * configure().
+     */
+    class AUDIO_SWITCHER_API VoiceActivityDetector
+    {
+    public:
+        VoiceActivityDetector() = default;
+
+        /**
+         * @brief Prepares framing and FFT buffers.
+         *
+         * @param sampleRate Stream sample rate in Hz.
+         * @param config Detector tuning.
+         * @param maxFrames Largest frame count per pushRaw() call.
+         * @return true on success.
+         */
+        bool configure(uint32_t sampleRate, const VadConfig &config = VadConfig(), size_t maxFrames = 4800);
+
+        /**
+         * @brief Feeds mono float samples.
+         *
+         * @return Current activity after the samples are processed.
+         */
+        bool push(const float *mono, size_t samples);
+
+        /**
+         * @brief Feeds raw interleaved frames in a device format (channels are averaged).
+         *
+         * @return Current activity after the frames are processed.
+         */
+        bool pushRaw(const void *data, size_t frames, const Utility::DeviceFormatInfo &format);
+
+        /**
+         * @brief Clears the noise floor, the partial frame and the state machine.
+         */
+        void reset();
+
+        bool isActive() const { return m_active; }
+        const VadFeatures &features() const { return m_features; }
+        size_t frameSamples() const { return m_frameSamples; }
+
+        /**
+         * @brief Worst-case delay from speech onset to activation, in milliseconds.
+         */
+        uint32_t reactionTimeMs() const { return m_config.attackFrames * m_config.frameMs; }
+
+    private:
+        void processFrame();
+
+        VadConfig m_config;
+        uint32_t m_sampleRate = 0;
+        size_t m_frameSamples = 0;
+        size_t m_maxFrames = 0;
+        uint32_t m_hangoverFrames = 0;
+
+        Fft m_fft;
+        std::vector<float> m_window;
+        std::vector<float> m_frame;   ///< Samples of the frame being collected
+        size_t m_fill = 0;
+        std::vector<float> m_re;
+        std::vector<float> m_im;
+        std::vector<float> m_convert; ///< pushRaw() scratch
+        size_t m_bandFirst = 0;       ///< First bin of the speech band
+        size_t m_bandLast = 0;        ///< Last bin of the speech band
+
+        VadFeatures m_features;
+        bool m_floorInitialised = false;
+        uint32_t m_speechRun = 0;     ///< Consecutive speech frames
+        uint32_t m_hangover = 0;      ///< Frames left before deactivating
+        bool m_active = false;
+    };
+}
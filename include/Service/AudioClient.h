@@ -0,0 +1,113 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Service/ServiceProtocol.h"
+
+namespace Service
+{
+    class LocalConnection;
+
+    /**
+     * @brief Raw response: the HRESULT and the fields that follow it.
+     */
+    struct ServiceResponse
+    {
+        HRESULT status = kDisconnected;
+        std::vector<uint8_t> body;
+    };
+
+    using ServiceEventCallback = std::function<void(const AswEvent &event)>;
+
+    /**
+     * @brief Thin client for AudioService.
+     *
+     * request() is asynchronous and may be called from any number of threads;
+     * requests on one connection are pipelined and their futures complete as the
+     * responses arrive. The typed helpers wrap request() and wait. When the
+     * connection drops every outstanding request completes with kDisconnected.
+     */
+    class AUDIO_SWITCHER_API AudioClient
+    {
+    public:
+        AudioClient();
+        ~AudioClient();
+
+        // Owns a connection and its reader thread: not copyable
+        AudioClient(const AudioClient &) = delete;
+        AudioClient &operator=(const AudioClient &) = delete;
+
+        bool connect(const std::string &endpoint = DefaultServiceEndpoint());
+        void disconnect();
+        bool isConnected() const { return m_connected.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Sends one request without waiting for its response.
+         *
+         * @param payload Request fields as listed in ServiceProtocol.h.
+         */
+        std::future<ServiceResponse> request(MessageType type, const std::vector<uint8_t> &payload = {});
+
+        HRESULT ping();
+        HRESULT listDevices(int32_t flow, std::vector<ServiceDevice> &devices);
+        HRESULT getDefault(int32_t flow, int32_t role, AswDevice &device);
+        HRESULT setDefault(AswDevice device, uint32_t roles = ASW_ROLE_MASK_ALL);
+        HRESULT findDevice(const std::string &id, AswDevice &device);
+        HRESULT getMute(AswDevice device, bool &muted);
+        HRESULT setMute(AswDevice device, bool muted);
+        HRESULT getVolume(AswDevice device, float &volume);
+        HRESULT setVolume(AswDevice device, float volume);
+
+        /**
+         * @brief Starts (or, with an empty callback, stops) event delivery.
+         *
+         * The callback runs on the client's reader thread: it must not wait on
+         * a response from this client.
+         */
+        HRESULT subscribe(ServiceEventCallback callback);
+
+    private:
+        HRESULT call(MessageType type, const std::vector<uint8_t> &payload, ServiceResponse &response);
+        void readLoop();
+        void failPending();
+
+        std::unique_ptr<LocalConnection> m_stream;
+        std::thread m_reader;
+        std::atomic<bool> m_connected{false};
+
+        std::mutex m_mutex; // m_nextId, m_pending
+        uint32_t m_nextId = 1;
+        std::unordered_map<uint32_t, std::promise<ServiceResponse>> m_pending;
+
+        std::mutex m_writeMutex;
+        std::vector<uint8_t> m_frame;
+
+        std::mutex m_callbackMutex;
+        ServiceEventCallback m_callback;
+    };
+}
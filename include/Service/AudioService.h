@@ -0,0 +1,116 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioSwitcher/AudioSwitcherC.h"
+#include "Service/ServiceProtocol.h"
+
+namespace Service
+{
+    class LocalListener;
+
+    struct ServiceConfig
+    {
+        std::string endpoint;              ///< Empty: DefaultServiceEndpoint()
+        size_t maxQueuedBytes = 1u << 20;  ///< Unsent output per connection; a client that falls further behind is dropped
+    };
+
+    struct ServiceStats
+    {
+        uint64_t connections = 0; ///< Accepted since start()
+        uint64_t requests = 0;
+        uint64_t events = 0;      ///< Event frames queued to subscribers
+        size_t activeConnections = 0;
+    };
+
+    /**
+     * @brief Resident audio-control service.
+     *
+     * Keeps one warm AswContext (device table, defaults and backend objects stay
+     * alive between requests) and serves the protocol of ServiceProtocol.h on a
+     * local endpoint: a Unix domain socket, or a named pipe on Windows. Each
+     * connection has a reader thread that answers requests in order and a writer
+     * thread that batches queued responses and events into as few writes as
+     * possible, so pipelined clients are not limited by round trips.
+     *
+     * The backend is the library's current one (GetAudioBackend()) at start().
+     * COM must be initialised on the thread that calls start() on Windows.
+     */
+    class AUDIO_SWITCHER_API AudioService
+    {
+    public:
+        explicit AudioService(const ServiceConfig &config = ServiceConfig());
+        ~AudioService();
+
+        // Owns threads and connections: not copyable
+        AudioService(const AudioService &) = delete;
+        AudioService &operator=(const AudioService &) = delete;
+
+        /**
+         * @brief Builds the device cache and starts listening.
+         *
+         * @return false if the backend or the endpoint could not be opened, or if
+         *         another instance serves the endpoint (see alreadyRunning()).
+         */
+        bool start();
+
+        /**
+         * @brief Stops listening, closes every connection and waits for their threads.
+         */
+        void stop();
+
+        bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+        const std::string &endpoint() const { return m_endpoint; }
+        ServiceStats stats() const;
+
+        /// The last start() failed because another instance already listens on the endpoint.
+        bool alreadyRunning() const { return m_alreadyRunning; }
+
+    private:
+        class Connection;
+
+        void acceptLoop();
+        void serve(const std::shared_ptr<Connection> &connection);
+        void handle(Connection &connection, uint8_t type, uint32_t requestId, FrameReader &in, std::vector<uint8_t> &out);
+        void reap(bool all);
+        static void onEvent(const AswEvent *event, void *user);
+
+        ServiceConfig m_config;
+        std::string m_endpoint;
+        AswContext *m_context = nullptr;
+        std::unique_ptr<LocalListener> m_listener;
+        std::thread m_acceptThread;
+        std::atomic<bool> m_running{false};
+        bool m_alreadyRunning = false;
+
+        mutable std::mutex m_connectionsMutex;
+        std::vector<std::shared_ptr<Connection>> m_connections;
+
+        std::atomic<uint64_t> m_accepted{0};
+        std::atomic<uint64_t> m_requests{0};
+        std::atomic<uint64_t> m_events{0};
+    };
+}
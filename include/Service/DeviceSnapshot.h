@@ -0,0 +1,185 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioSwitcher/AudioSwitcherC.h"
+
+namespace Service
+{
+    class SharedSegment;
+
+    constexpr uint32_t kSnapshotMaxDevices = 64;
+    constexpr size_t kSnapshotIdSize = 128;   ///< UTF-8 bytes, terminator included (longer IDs are truncated)
+    constexpr size_t kSnapshotNameSize = 128; ///< UTF-8 bytes, terminator included
+
+    /**
+     * @brief One active endpoint as published.
+     */
+    struct SnapshotDevice
+    {
+        AswDevice handle;      ///< Publisher's handle: stable across generations, not valid for other contexts
+        uint8_t flow;          ///< ASW_FLOW_RENDER or ASW_FLOW_CAPTURE
+        uint8_t defaultRoles;  ///< Bit (1 << ASW_ROLE_*) per role
+        uint8_t muted;
+        uint8_t reserved;
+        uint32_t state;        ///< DEVICE_STATE_*
+        float volume;          ///< Master volume scalar, 0..1
+        char id[kSnapshotIdSize];
+        char name[kSnapshotNameSize];
+    };
+
+    /**
+     * @brief Fixed-layout device state: what a reader copies out of the segment.
+     *
+     * Only the first `deviceCount` entries of `devices` are meaningful.
+     */
+    struct DeviceSnapshot
+    {
+        uint64_t generation;      ///< Increases by one per publish
+        int64_t publishedUnixNs;
+        uint32_t deviceCount;
+        uint32_t reserved;
+        AswDevice defaults[2][3]; ///< [ASW_FLOW_*][ASW_ROLE_*], 0 = none
+        SnapshotDevice devices[kSnapshotMaxDevices];
+    };
+
+    /**
+     * @brief Platform default segment name ("Local\AudioSwitcherSnapshot" on Windows, "/AudioSwitcherSnapshot" elsewhere).
+     */
+    AUDIO_SWITCHER_API std::string DefaultSnapshotName();
+
+    /**
+     * @brief Publishes the device state into a named shared-memory segment.
+     *
+     * The segment holds a small header and one DeviceSnapshot behind a seqlock:
+     * a publish makes the sequence odd, copies the snapshot in and makes it even
+     * again, so readers never block the publisher and detect a torn copy by the
+     * sequence changing under them. There must be one publisher per name.
+     *
+     * start() follows the library's current backend: an AswContext supplies the
+     * device table, and every notification wakes a worker thread that republishes
+     * (bursts of notifications coalesce into one publish).
+     */
+    class AUDIO_SWITCHER_API SnapshotPublisher
+    {
+    public:
+        SnapshotPublisher();
+        ~SnapshotPublisher();
+
+        // Owns a segment and a worker thread: not copyable
+        SnapshotPublisher(const SnapshotPublisher &) = delete;
+        SnapshotPublisher &operator=(const SnapshotPublisher &) = delete;
+
+        /**
+         * @brief Creates the segment. Readers see no snapshot until the first publish.
+         */
+        bool open(const std::string &name = DefaultSnapshotName());
+
+        /**
+         * @brief Stops following, marks the segment closed for readers and removes it.
+         */
+        void close();
+
+        bool isOpen() const;
+
+        /**
+         * @brief Publishes `snapshot` as the next generation (its generation and timestamp are filled in).
+         */
+        void publish(const DeviceSnapshot &snapshot);
+
+        /**
+         * @brief Publishes the current device state now and after every device notification.
+         */
+        bool start();
+        void stop();
+
+        uint64_t generation() const;
+
+    private:
+        void followLoop();
+        void capture(DeviceSnapshot &snapshot);
+        static void onEvent(const AswEvent *event, void *user);
+
+        std::unique_ptr<SharedSegment> m_segment;
+        std::mutex m_publishMutex;
+        AswContext *m_context = nullptr;
+        std::unique_ptr<DeviceSnapshot> m_scratch;
+        std::vector<AswDeviceInfo> m_infos;
+        std::vector<char> m_text;
+
+        std::thread m_worker;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_dirty = false;
+        bool m_stopping = false;
+    };
+
+    /**
+     * @brief Reads snapshots published by a SnapshotPublisher, in this or another process.
+     *
+     * Reads are lock-free and touch only the mapped segment: no system call, no
+     * allocation. A reader may be shared by several threads.
+     */
+    class AUDIO_SWITCHER_API SnapshotReader
+    {
+    public:
+        SnapshotReader();
+        ~SnapshotReader();
+
+        // Owns a mapping: not copyable
+        SnapshotReader(const SnapshotReader &) = delete;
+        SnapshotReader &operator=(const SnapshotReader &) = delete;
+
+        /**
+         * @brief Maps the segment; false if no publisher created it or its layout differs.
+         */
+        bool open(const std::string &name = DefaultSnapshotName());
+        void close();
+        bool isOpen() const;
+
+        /**
+         * @brief Current generation (one memory read); 0 before the first publish or once the publisher closed.
+         */
+        uint64_t generation() const;
+
+        /**
+         * @brief Copies a consistent snapshot.
+         *
+         * @return false if nothing is published, the publisher closed the segment
+         *         (reopen to follow a new one), or no consistent copy could be taken.
+         */
+        bool read(DeviceSnapshot &snapshot) const;
+
+        /**
+         * @brief Copies just the default endpoint of a flow and role; false if there is none.
+         */
+        bool readDefault(int32_t flow, int32_t role, SnapshotDevice &device) const;
+
+    private:
+        std::unique_ptr<SharedSegment> m_segment;
+    };
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AudioSwitcher/AudioSwitcherC.h"
+#include "Backend/Platform.h"
+
+namespace Service
+{
+    /**
+     * @brief Message types of the service protocol.
+     *
+     * Every message is a frame:
+     *
+     *     u32 length      bytes that follow (type + requestId + payload), little-endian
+     *     u8  type        MessageType; responses set kResponseFlag
+     *     u32 requestId   echoed in the response; 0 for events
+     *     ... payload
+     *
+     * Responses start with an i32 HRESULT, followed by the result fields when it
+     * succeeded. Strings are u16 length + UTF-8. Clients may pipeline: send any
+     * number of requests without waiting; each connection answers in request order.
+     *
+     * | Request     | Payload                   | Response body                                          |
+     * |-------------|---------------------------|--------------------------------------------------------|
+     * | Ping        | -                         | -                                                      |
+     * | ListDevices | u8 flow (ASW_FLOW_*)      | u32 count, count × {u32 handle, u8 flow, u32 state,    |
+     * |             |                           |   u8 defaultRoles, str id, str name}                   |
+     * | GetDefault  | u8 flow, u8 role          | u32 handle (0 = none)                                  |
+     * | SetDefault  | u32 handle, u8 roles      | -                                                      |
+     * | GetMute     | u32 handle                | u8 muted                                               |
+     * | SetMute     | u32 handle, u8 muted      | -                                                      |
+     * | GetVolume   | u32 handle                | f32 volume                                             |
+     * | SetVolume   | u32 handle, f32 volume    | -                                                      |
+     * | FindDevice  | str id                    | u32 handle                                             |
+     * | Subscribe   | u8 enable                 | -                                                      |
+     *
+     * After Subscribe(1) the service also sends Event frames: u8 type (ASW_EVENT_*),
+     * u32 handle, u8 flow, u8 role, u32 state, f32 volume, u8 muted.
+     */
+    enum class MessageType : uint8_t
+    {
+        Ping = 1,
+        ListDevices,
+        GetDefault,
+        SetDefault,
+        GetMute,
+        SetMute,
+        GetVolume,
+        SetVolume,
+        FindDevice,
+        Subscribe,
+        Event = 0x40
+    };
+
+    constexpr uint8_t kResponseFlag = 0x80;
+    constexpr size_t kFrameHeaderSize = 9;          ///< length + type + requestId
+    constexpr uint32_t kMaxFrameSize = 1u << 20;    ///< Larger frames close the connection
+    constexpr HRESULT kDisconnected = static_cast<HRESULT>(0x8007006Du); ///< HRESULT_FROM_WIN32(ERROR_BROKEN_PIPE)
+
+    /**
+     * @brief Endpoint reported by ListDevices.
+     */
+    struct ServiceDevice
+    {
+        AswDevice handle = 0;
+        int32_t flow = ASW_FLOW_RENDER;
+        uint32_t state = 0;
+        uint32_t defaultRoles = 0;
+        std::string id;   ///< UTF-8
+        std::string name; ///< UTF-8
+    };
+
+    /**
+     * @brief Appends little-endian fields to a frame under construction.
+     *
+     * The three-argument constructor writes the frame header and finish() patches
+     * the length; the one-argument form appends bare payload fields.
+     */
+    class AUDIO_SWITCHER_API FrameWriter
+    {
+    public:
+        FrameWriter(std::vector<uint8_t> &out, uint8_t type, uint32_t requestId);
+        explicit FrameWriter(std::vector<uint8_t> &out) : m_out(out), m_start(out.size()), m_framed(false) {}
+
+        FrameWriter &u8(uint8_t value);
+        FrameWriter &u32(uint32_t value);
+        FrameWriter &i32(int32_t value) { return u32(static_cast<uint32_t>(value)); }
+        FrameWriter &f32(float value);
+        FrameWriter &str(const std::string &value);
+        FrameWriter &bytes(const uint8_t *data, size_t size);
+
+        /// Completes the frame (call once, after the last field).
+        void finish();
+
+    private:
+        std::vector<uint8_t> &m_out;
+        size_t m_start;
+        bool m_framed = true;
+    };
+
+    /**
+     * @brief Reads little-endian fields from a payload; any overrun clears ok().
+     */
+    class AUDIO_SWITCHER_API FrameReader
+    {
+    public:
+        FrameReader(const uint8_t *data, size_t size) : m_p(data), m_end(data + size) {}
+
+        uint8_t u8();
+        uint32_t u32();
+        int32_t i32() { return static_cast<int32_t>(u32()); }
+        float f32();
+        std::string str();
+
+        bool ok() const { return m_ok; }
+        size_t remaining() const { return static_cast<size_t>(m_end - m_p); }
+
+    private:
+        bool need(size_t bytes);
+
+        const uint8_t *m_p;
+        const uint8_t *m_end;
+        bool m_ok = true;
+    };
+
+    /**
+     * @brief Platform default endpoint: a named pipe on Windows, a Unix socket in the runtime directory elsewhere.
+     */
+    AUDIO_SWITCHER_API std::string DefaultServiceEndpoint();
+}
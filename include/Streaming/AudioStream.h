@@ -0,0 +1,107 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Utility/DeviceFormatInfo.h"
+
+namespace Streaming
+{
+    /**
+     * @brief Buffering of an open stream, in frames (0 when unknown).
+     */
+    struct StreamTiming
+    {
+        uint32_t bufferFrames = 0;        ///< Size of the endpoint buffer
+        uint32_t defaultPeriodFrames = 0; ///< Engine processing period in shared mode
+        uint32_t minimumPeriodFrames = 0; ///< Smallest period the device supports
+        uint32_t streamLatencyFrames = 0; ///< Maximum latency reported by the driver
+    };
+
+    /**
+     * @brief A source of interleaved frames in its native device format (e.g. a capture endpoint).
+     *
+     * Implementations must never block in read(): they return whatever is available.
+     */
+    class AUDIO_SWITCHER_API IAudioSource
+    {
+    public:
+        virtual ~IAudioSource() = default;
+
+        /**
+         * @brief Format of the frames returned by read().
+         */
+        virtual const Utility::DeviceFormatInfo &format() const = 0;
+
+        /**
+         * @brief Copies up to `maxFrames` available frames into `dst`.
+         *
+         * @param dst Buffer of at least `maxFrames * format().blockAlign` bytes.
+         * @param maxFrames Capacity of `dst` in frames.
+         * @return Number of frames copied (0 if nothing is available).
+         */
+        virtual size_t read(void *dst, size_t maxFrames) = 0;
+
+        /**
+         * @brief Buffer and period sizes of the stream, if the implementation knows them.
+         */
+        virtual StreamTiming timing() const { return StreamTiming(); }
+
+        /**
+         * @brief ID of the endpoint the frames are captured from, empty if not an endpoint or unknown.
+         */
+        virtual std::wstring endpointId() const { return std::wstring(); }
+    };
+
+    /**
+     * @brief A sink accepting interleaved frames in its native device format (e.g. a render endpoint).
+     *
+     * Implementations must never block in write(): they accept what fits.
+     */
+    class AUDIO_SWITCHER_API IAudioSink
+    {
+    public:
+        virtual ~IAudioSink() = default;
+
+        /**
+         * @brief Format expected by write().
+         */
+        virtual const Utility::DeviceFormatInfo &format() const = 0;
+
+        /**
+         * @brief Number of frames write() can currently accept.
+         */
+        virtual size_t writableFrames() = 0;
+
+        /**
+         * @brief Queues up to `frames` frames for playback.
+         *
+         * @param src Frames in format().
+         * @param frames Number of frames in `src`.
+         * @return Number of frames accepted.
+         */
+        virtual size_t write(const void *src, size_t frames) = 0;
+
+        /**
+         * @brief Buffer and period sizes of the stream, if the implementation knows them.
+         */
+        virtual StreamTiming timing() const { return StreamTiming(); }
+    };
+}
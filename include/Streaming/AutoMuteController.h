@@ -0,0 +1,125 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Backend/Platform.h"
+#include "Dsp/VoiceActivityDetector.h"
+#include "Streaming/AudioStream.h"
+
+namespace Streaming
+{
+    /**
+     * @brief Mutes an input endpoint while nobody is talking.
+     *
+     * Each pump() drains the sensing source into a VoiceActivityDetector and, when the
+     * detected state changes, mutes (silence) or unmutes (speech) the target. The
+     * endpoint is only touched on transitions, never per period.
+     *
+     * Reaction time is bounded by VoiceActivityDetector::reactionTimeMs() plus the
+     * interval between pump() calls; release is delayed by the hangover.
+     *
+     * Muting a capture endpoint through IAudioEndpointVolume also silences the
+     * shared-mode streams opened on it, so a detector listening to the endpoint it
+     * mutes would never hear speech again. The endpoint overload therefore refuses a
+     * sensing source captured from that endpoint. To auto-mute the microphone being
+     * listened to, use the handler overload and gate the stream downstream of the
+     * tap (drop or zero its frames while muted) instead of muting the endpoint.
+     *
+     * Not thread-safe: call pump() from one thread.
+     */
+    class AUDIO_SWITCHER_API AutoMuteController
+    {
+    public:
+        /// Receives true to mute, false to unmute; returns false if the change failed.
+        using MuteHandler = std::function<bool(bool mute)>;
+
+        AutoMuteController() = default;
+        ~AutoMuteController();
+
+        // Holds a reference on the endpoint: not copyable
+        AutoMuteController(const AutoMuteController &) = delete;
+        AutoMuteController &operator=(const AutoMuteController &) = delete;
+
+        /**
+         * @brief Drives the mute state of an endpoint from a sensing source.
+         *
+         * The endpoint is muted immediately (nobody has spoken yet).
+         *
+         * @param source Sensing source (must outlive the controller); must not be captured
+         *        from `endpoint` (see IAudioSource::endpointId()).
+         * @param endpoint Input endpoint to mute; a reference is held until close().
+         * @param config Detector tuning.
+         * @param maxFrames Largest number of frames read per pump() iteration.
+         * @return true on success, false for invalid arguments or a source on `endpoint`.
+         */
+        bool open(IAudioSource *source, IMMDevice *endpoint,
+                  const Dsp::VadConfig &config = Dsp::VadConfig(), size_t maxFrames = 4800);
+
+        /**
+         * @brief Drives an arbitrary mute handler from a sensing source.
+         *
+         * @param source Sensing source (must outlive the controller).
+         * @param handler Called on every activity transition.
+         * @param config Detector tuning.
+         * @param maxFrames Largest number of frames read per pump() iteration.
+         * @return true on success.
+         */
+        bool open(IAudioSource *source, MuteHandler handler,
+                  const Dsp::VadConfig &config = Dsp::VadConfig(), size_t maxFrames = 4800);
+
+        /**
+         * @brief Releases the endpoint. Its mute state is left as is.
+         */
+        void close();
+
+        /**
+         * @brief Reads all available frames and applies any state transition.
+         *
+         * @return Number of frames analysed.
+         */
+        size_t pump();
+
+        bool isOpen() const { return m_source != nullptr; }
+        bool isMuted() const { return m_muted; }
+
+        /// Number of mute/unmute calls issued (including the initial mute).
+        uint64_t transitions() const { return m_transitions; }
+
+        /// Number of mute/unmute calls the handler reported as failed.
+        uint64_t failures() const { return m_failures; }
+
+        const Dsp::VoiceActivityDetector &detector() const { return m_vad; }
+
+    private:
+        void apply(bool mute);
+
+        IAudioSource *m_source = nullptr;
+        IMMDevice *m_endpoint = nullptr;
+        MuteHandler m_handler;
+        Dsp::VoiceActivityDetector m_vad;
+        std::vector<uint8_t> m_raw; ///< One read of native-format frames
+        size_t m_maxFrames = 0;
+        bool m_muted = false;
+        uint64_t m_transitions = 0;
+        uint64_t m_failures = 0;
+    };
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Dsp/CrossCorrelator.h"
+#include "Streaming/AudioStream.h"
+
+namespace Streaming
+{
+    /**
+     * @brief Excitation signals for latency measurement.
+     */
+    enum class ProbeSignal
+    {
+        Chirp, ///< Log sine sweep: robust against band-limited devices
+        Mls    ///< Maximum-length sequence: sharpest peak, sounds like noise
+    };
+
+    /**
+     * @brief Parameters of a round-trip measurement.
+     */
+    struct LatencyProbeConfig
+    {
+        ProbeSignal signal = ProbeSignal::Chirp;
+        uint32_t trials = 5;
+        uint32_t chirpMs = 250;        ///< Sweep length (Chirp)
+        uint32_t mlsOrder = 14;        ///< Sequence length 2^order - 1 (Mls)
+        float amplitude = 0.5f;
+        uint32_t maxLatencyMs = 1000;  ///< Longest round trip searched for
+        uint32_t gapMs = 300;          ///< Silence between trials (lets echoes and buffers drain)
+        float minConfidence = 8.0f;    ///< Trials with a weaker correlation peak are rejected
+    };
+
+    /**
+     * @brief Result of LatencyProbe::measure().
+     */
+    struct LatencyReport
+    {
+        bool valid = false;               ///< At least one trial succeeded
+        uint32_t sampleRate = 0;
+        std::vector<double> latencyMs;    ///< Round trip of every successful trial
+        uint32_t failedTrials = 0;        ///< Timed out or below minConfidence
+        double meanMs = 0.0;
+        double medianMs = 0.0;
+        double minMs = 0.0;
+        double maxMs = 0.0;
+        double jitterMs = 0.0;            ///< Standard deviation across trials
+        float meanConfidence = 0.0f;
+        StreamTiming renderTiming;        ///< Buffer/period sizes of the render stream
+        StreamTiming captureTiming;       ///< Buffer/period sizes of the capture stream
+    };
+
+    /**
+     * @brief Measures render-to-capture round-trip latency.
+     *
+     * Each trial drains the capture stream, writes a known signal into the (empty)
+     * render stream while recording, then locates the signal in the recording by
+     * FFT cross-correlation. The lag between the first frame written and its arrival
+     * on the capture side is the round trip: render buffering, output and input
+     * hardware, the acoustic or cable path, and capture buffering.
+     *
+     * measure() blocks for roughly trials × (signal + maxLatency + gap).
+     */
+    class AUDIO_SWITCHER_API LatencyProbe
+    {
+    public:
+        LatencyProbe() = default;
+
+        /**
+         * @brief Runs the trials.
+         *
+         * @param render Render sink (e.g. RenderStream on the speaker or a loopback cable).
+         * @param capture Capture source at the same sample rate.
+         * @param config Measurement parameters.
+         * @return The report; `valid` is false if the formats are unusable or every trial failed.
+         */
+        LatencyReport measure(IAudioSink &render, IAudioSource &capture,
+                              const LatencyProbeConfig &config = LatencyProbeConfig());
+
+    private:
+        bool run(IAudioSink &render, IAudioSource &capture, const std::vector<float> &signal,
+                 size_t captureFrames, bool keep);
+
+        Dsp::CrossCorrelator m_correlator;
+        std::vector<float> m_recording; ///< Mono capture of the current trial
+        std::vector<float> m_floatOut, m_floatIn;
+        std::vector<uint8_t> m_rawOut, m_rawIn;
+    };
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <vector>
+#include "Streaming/AudioStream.h"
+
+namespace Streaming
+{
+    /**
+     * @brief Parameters of a SimulatedLoopback.
+     */
+    struct SimulatedLoopbackConfig
+    {
+        uint32_t sampleRate = 48000;
+        uint16_t channels = 2;
+        uint32_t delayFrames = 2400;  ///< Acoustic/electrical delay from render output to capture input
+        float gain = 0.5f;            ///< Loopback attenuation
+        float noiseLevel = 0.001f;    ///< RMS of white noise added to the capture side
+        uint32_t bufferFrames = 4800; ///< Render and capture buffer sizes
+        uint32_t periodFrames = 480;  ///< Engine period: frames move in whole periods
+        uint32_t seed = 1;            ///< Noise generator seed
+    };
+
+    /**
+     * @brief A render sink wired to a capture source through a known delay, driven by the wall clock.
+     *
+     * Every elapsed engine period, one period is taken from the render buffer (silence
+     * on underrun), delayed by `delayFrames`, scaled, mixed with noise and appended to
+     * the capture buffer (oldest frames are dropped on overflow). Both sides use 32-bit
+     * float in `channels` channels.
+     *
+     * Useful to validate latency measurement and stream graphs without audio hardware.
+     * Thread-safe: the sink and the source may be used from different threads.
+     */
+    class AUDIO_SWITCHER_API SimulatedLoopback
+    {
+    public:
+        SimulatedLoopback();
+
+        SimulatedLoopback(const SimulatedLoopback &) = delete;
+        SimulatedLoopback &operator=(const SimulatedLoopback &) = delete;
+
+        /**
+         * @brief Resets the buffers and starts the simulated clock.
+         *
+         * @return true on success.
+         */
+        bool open(const SimulatedLoopbackConfig &config = SimulatedLoopbackConfig());
+
+        IAudioSink &sink() { return m_sink; }
+        IAudioSource &source() { return m_source; }
+
+        const SimulatedLoopbackConfig &config() const { return m_config; }
+
+    private:
+        class Sink : public IAudioSink
+        {
+        public:
+            explicit Sink(SimulatedLoopback &owner) : m_owner(owner) {}
+            const Utility::DeviceFormatInfo &format() const override { return m_owner.m_format; }
+            size_t writableFrames() override;
+            size_t write(const void *src, size_t frames) override;
+            StreamTiming timing() const override { return m_owner.m_timing; }
+
+        private:
+            SimulatedLoopback &m_owner;
+        };
+
+        class Source : public IAudioSource
+        {
+        public:
+            explicit Source(SimulatedLoopback &owner) : m_owner(owner) {}
+            const Utility::DeviceFormatInfo &format() const override { return m_owner.m_format; }
+            size_t read(void *dst, size_t maxFrames) override;
+            StreamTiming timing() const override { return m_owner.m_timing; }
+
+        private:
+            SimulatedLoopback &m_owner;
+        };
+
+        void advance();
+
+        SimulatedLoopbackConfig m_config;
+        Utility::DeviceFormatInfo m_format;
+        StreamTiming m_timing;
+        Sink m_sink;
+        Source m_source;
+
+        std::mutex m_mutex;
+        std::chrono::steady_clock::time_point m_start;
+        uint64_t m_periodsDone = 0;
+
+        std::vector<float> m_render;  ///< Render ring (bufferFrames)
+        size_t m_renderRead = 0;
+        size_t m_renderCount = 0;
+        std::vector<float> m_delay;   ///< Delay line ring (delayFrames + 1)
+        size_t m_delayPos = 0;
+        std::vector<float> m_capture; ///< Capture ring (bufferFrames)
+        size_t m_captureRead = 0;
+        size_t m_captureCount = 0;
+
+        std::mt19937 m_rng;
+        std::normal_distribution<float> m_noise;
+    };
+}
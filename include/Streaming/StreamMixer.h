@@ -0,0 +1,111 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Dsp/ChannelMatrix.h"
+#include "Dsp/MultiSourceMixer.h"
+#include "Streaming/AudioStream.h"
+
+namespace Streaming
+{
+    /**
+     * @brief Mixes several capture sources (microphones, loopback) into one render sink.
+     *
+     * Each pump() reads what the sources have, converts it to float, maps it to the
+     * sink's speaker layout, mixes with per-input gain and writes the result in the
+     * sink format. All buffers are allocated by open() and addInput(); pump() does not
+     * allocate. Sources that deliver fewer frames than the sink needs are padded with
+     * silence and counted as underruns.
+     *
+     * Not thread-safe except for setGain()/setSoftClip(): call pump() from one thread.
+     */
+    class AUDIO_SWITCHER_API StreamMixer
+    {
+    public:
+        StreamMixer() = default;
+
+        StreamMixer(const StreamMixer &) = delete;
+        StreamMixer &operator=(const StreamMixer &) = delete;
+
+        /**
+         * @brief Binds the output sink and preallocates the mixer.
+         *
+         * @param sink Render sink (must outlive the mixer).
+         * @param maxInputs Maximum number of sources.
+         * @param maxFrames Largest number of frames mixed per pump().
+         * @return true on success, false if the sink format is unusable.
+         */
+        bool open(IAudioSink *sink, uint32_t maxInputs, size_t maxFrames = 4800);
+
+        /**
+         * @brief Adds a capture source.
+         *
+         * The source must run at the sink's sample rate; channel layouts may differ.
+         *
+         * @param source Source (must outlive the mixer).
+         * @param gain Initial linear gain.
+         * @return Input index, or -1 if full or the format is incompatible.
+         */
+        int addInput(IAudioSource *source, float gain = 1.0f);
+
+        /**
+         * @brief Sets the gain of an input (smoothed). Thread-safe.
+         */
+        void setGain(int input, float gain);
+
+        /**
+         * @brief Enables soft limiting of the mixed signal. Thread-safe.
+         */
+        void setSoftClip(bool enabled, float knee = 0.8f);
+
+        /**
+         * @brief Mixes one period: as many frames as the sink can take (up to maxFrames).
+         *
+         * @return Number of frames written to the sink.
+         */
+        size_t pump();
+
+        /// Number of times a source delivered fewer frames than requested.
+        uint64_t underruns() const { return m_underruns; }
+
+        uint32_t inputCount() const { return static_cast<uint32_t>(m_inputs.size()); }
+
+    private:
+        struct Input
+        {
+            IAudioSource *source = nullptr;
+            Dsp::ChannelMatrix matrix;
+            std::vector<uint8_t> raw;   ///< Native-format scratch
+            std::vector<float> native;  ///< Float scratch in the source layout
+        };
+
+        IAudioSink *m_sink = nullptr;
+        size_t m_maxFrames = 0;
+        uint32_t m_maxInputs = 0;
+        uint64_t m_underruns = 0;
+
+        Dsp::MultiSourceMixer m_mixer;
+        std::vector<std::unique_ptr<Input>> m_inputs;
+        std::vector<float> m_mixed;   ///< Mixed float output
+        std::vector<uint8_t> m_output; ///< Output in sink format
+    };
+}
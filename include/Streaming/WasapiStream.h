@@ -0,0 +1,124 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstdint>
+#include <vector>
+#include <mmdeviceapi.h>
+#include "Streaming/AudioStream.h"
+
+struct IAudioClient;
+struct IAudioCaptureClient;
+struct IAudioRenderClient;
+
+namespace Streaming
+{
+    /**
+     * @brief Shared-mode WASAPI capture stream on an endpoint (or loopback of a render endpoint).
+     *
+     * Frames are delivered in the device mix format (see format()).
+     */
+    class AUDIO_SWITCHER_API CaptureStream : public IAudioSource
+    {
+    public:
+        CaptureStream() = default;
+        ~CaptureStream() override;
+
+        // Owns COM interfaces: not copyable
+        CaptureStream(const CaptureStream &) = delete;
+        CaptureStream &operator=(const CaptureStream &) = delete;
+
+        /**
+         * @brief Opens and starts capturing from a device.
+         *
+         * @param device Capture endpoint, or a render endpoint when `loopback` is true.
+         * @param loopback Capture what the render endpoint is playing.
+         * @param bufferMs Requested WASAPI buffer duration.
+         * @return true on success, false otherwise.
+         */
+        bool open(IMMDevice *device, bool loopback = false, uint32_t bufferMs = 100);
+
+        /**
+         * @brief Stops the stream and releases all COM interfaces.
+         */
+        void close();
+
+        bool isOpen() const { return m_client != nullptr; }
+
+        const Utility::DeviceFormatInfo &format() const override { return m_format; }
+        size_t read(void *dst, size_t maxFrames) override;
+        StreamTiming timing() const override { return m_timing; }
+        std::wstring endpointId() const override { return m_endpointId; }
+
+    private:
+        IAudioClient *m_client = nullptr;
+        IAudioCaptureClient *m_capture = nullptr;
+        Utility::DeviceFormatInfo m_format;
+        StreamTiming m_timing;
+        std::wstring m_endpointId;
+
+        std::vector<uint8_t> m_pending; ///< Leftover of a packet larger than the caller's buffer
+        size_t m_pendingOffset = 0;     ///< Bytes already consumed from m_pending
+        size_t m_pendingSize = 0;       ///< Valid bytes in m_pending
+    };
+
+    /**
+     * @brief Shared-mode WASAPI render stream on an endpoint.
+     *
+     * Frames must be written in the device mix format (see format()).
+     */
+    class AUDIO_SWITCHER_API RenderStream : public IAudioSink
+    {
+    public:
+        RenderStream() = default;
+        ~RenderStream() override;
+
+        // Owns COM interfaces: not copyable
+        RenderStream(const RenderStream &) = delete;
+        RenderStream &operator=(const RenderStream &) = delete;
+
+        /**
+         * @brief Opens a render stream. Playback starts with the first write().
+         *
+         * @param device Render endpoint.
+         * @param bufferMs Requested WASAPI buffer duration.
+         * @return true on success, false otherwise.
+         */
+        bool open(IMMDevice *device, uint32_t bufferMs = 100);
+
+        /**
+         * @brief Stops the stream and releases all COM interfaces.
+         */
+        void close();
+
+        bool isOpen() const { return m_client != nullptr; }
+
+        const Utility::DeviceFormatInfo &format() const override { return m_format; }
+        size_t writableFrames() override;
+        size_t write(const void *src, size_t frames) override;
+        StreamTiming timing() const override { return m_timing; }
+
+    private:
+        IAudioClient *m_client = nullptr;
+        IAudioRenderClient *m_render = nullptr;
+        Utility::DeviceFormatInfo m_format;
+        StreamTiming m_timing;
+        uint32_t m_bufferFrames = 0;
+        bool m_started = false;
+    };
+}
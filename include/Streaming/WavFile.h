@@ -0,0 +1,77 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include "Utility/DeviceFormatInfo.h"
+#include "Utility/MappedFile.h"
+
+namespace Streaming
+{
+    /**
+     * @brief A memory-mapped WAV or RF64 file.
+     *
+     * Supports PCM (8/16/24/32-bit), IEEE float and WAVE_FORMAT_EXTENSIBLE with either
+     * subtype. Sample data is not copied: frames() points into the mapping. A data
+     * chunk that runs past the end of the file (an interrupted recording) is truncated
+     * to the whole frames that exist.
+     */
+    class AUDIO_SWITCHER_API WavFile
+    {
+    public:
+        WavFile() = default;
+
+        WavFile(const WavFile &) = delete;
+        WavFile &operator=(const WavFile &) = delete;
+
+        /**
+         * @brief Maps and parses a file.
+         *
+         * @param path WAV/RF64 file.
+         * @return true if the file is a supported WAV.
+         */
+        bool open(const std::filesystem::path &path);
+
+        /**
+         * @brief Parses a WAV image already in memory (the caller keeps it alive).
+         *
+         * @return true if the image is a supported WAV.
+         */
+        bool parse(const uint8_t *data, uint64_t size);
+
+        void close();
+
+        bool isOpen() const { return m_frames != nullptr; }
+
+        /// Sample format of the file (valid only after a successful open()/parse()).
+        const Utility::DeviceFormatInfo &format() const { return m_format; }
+
+        /// First byte of the interleaved sample data.
+        const uint8_t *frames() const { return m_frames; }
+
+        uint64_t frameCount() const { return m_frameCount; }
+
+    private:
+        Utility::MappedFile m_mapping;
+        Utility::DeviceFormatInfo m_format;
+        const uint8_t *m_frames = nullptr;
+        uint64_t m_frameCount = 0;
+    };
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+#include "Dsp/ChannelMatrix.h"
+#include "Dsp/LinearResampler.h"
+#include "Streaming/AudioStream.h"
+#include "Streaming/WavFile.h"
+#include "Utility/SpscQueue.h"
+
+namespace Streaming
+{
+    /**
+     * @brief Plays memory-mapped WAV files into a render sink, with looping and gapless queueing.
+     *
+     * Files whose format matches the sink (see GetDeviceFormatInfo()) are written to
+     * the sink straight from the mapping. Other files are converted per period: sample
+     * format (Dsp/SampleFormat.h), speaker layout (Dsp::ChannelMatrix) and, if needed,
+     * sample rate (Dsp::LinearResampler). Conversion chains are prepared by enqueue(),
+     * so pump() never allocates.
+     *
+     * The next queued file starts in the same period the previous one ends, so queued
+     * files play back to back without a gap.
+     *
+     * Threading: enqueue()/stop()/breakLoop() from one control thread, pump() from one
+     * audio thread. Items are handed over through lock-free queues and freed on the
+     * control thread.
+     */
+    class AUDIO_SWITCHER_API WavPlayer
+    {
+    public:
+        WavPlayer() = default;
+        ~WavPlayer();
+
+        WavPlayer(const WavPlayer &) = delete;
+        WavPlayer &operator=(const WavPlayer &) = delete;
+
+        /**
+         * @brief Binds the output sink and preallocates conversion buffers.
+         *
+         * @param sink Render sink (must outlive the player), e.g. a RenderStream on the chosen device.
+         * @param maxFrames Largest number of frames written per pump().
+         * @param queueCapacity Maximum number of files waiting to play.
+         * @return true on success.
+         */
+        bool open(IAudioSink *sink, size_t maxFrames = 4800, uint32_t queueCapacity = 16);
+
+        /**
+         * @brief Releases every file. pump() must not be running.
+         */
+        void close();
+
+        /**
+         * @brief Maps a file and appends it to the queue.
+         *
+         * @param path WAV/RF64 file.
+         * @param loop Repeat the file until stop() or breakLoop().
+         * @return false if the file cannot be read, cannot be converted or the queue is full.
+         */
+        bool enqueue(const std::filesystem::path &path, bool loop = false);
+
+        /**
+         * @brief Appends an already opened file to the queue (takes ownership).
+         */
+        bool enqueue(std::unique_ptr<WavFile> file, bool loop = false);
+
+        /**
+         * @brief Drops the current and all queued files at the next pump().
+         */
+        void stop();
+
+        /**
+         * @brief Lets the current looping file finish its pass, then continue with the queue.
+         */
+        void breakLoop();
+
+        /**
+         * @brief Writes as many frames as the sink accepts (up to maxFrames).
+         *
+         * @return Frames written.
+         */
+        size_t pump();
+
+        /// True while a file is playing or queued.
+        bool isPlaying() const { return m_outstanding.load(std::memory_order_acquire) > 0; }
+
+        uint64_t framesPlayed() const { return m_framesPlayed.load(std::memory_order_relaxed); }
+
+    private:
+        struct Item
+        {
+            std::unique_ptr<WavFile> file;
+            bool loop = false;
+            bool direct = false;   ///< File matches the sink format
+            bool resample = false; ///< Sample rates differ
+            Dsp::ChannelMatrix matrix;
+            Dsp::LinearResampler resampler;
+            uint64_t position = 0; ///< Next frame to read
+        };
+
+        void collect();
+        void retire(Item *item);
+        size_t gather(Item &item, float *dst, size_t frames);
+        size_t render(Item &item, uint8_t *out, size_t frames);
+
+        IAudioSink *m_sink = nullptr;
+        size_t m_maxFrames = 0;
+
+        Utility::SpscQueue<Item *> m_pending;  ///< Control -> audio
+        Utility::SpscQueue<Item *> m_finished; ///< Audio -> control
+        Item *m_current = nullptr;
+        std::atomic<uint32_t> m_outstanding{0};
+        std::atomic<bool> m_stopRequested{false};
+        std::atomic<bool> m_breakLoopRequested{false};
+        std::atomic<uint64_t> m_framesPlayed{0};
+
+        std::vector<float> m_native;    ///< File channels, m_maxFrames frames
+        std::vector<float> m_mapped;    ///< Sink channels, m_maxFrames frames
+        std::vector<float> m_resampled; ///< Sink channels, m_maxFrames frames
+        std::vector<uint8_t> m_output;  ///< Sink format, m_maxFrames frames
+    };
+}
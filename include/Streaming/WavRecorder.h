@@ -0,0 +1,187 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Streaming/AudioStream.h"
+#include "Utility/FileSink.h"
+#include "Utility/SpscQueue.h"
+
+namespace Streaming
+{
+    /**
+     * @brief Buffering and header-update policy of a WavRecorder.
+     */
+    struct WavRecorderConfig
+    {
+        size_t bufferBytes = 1 << 20;       ///< Size of each pool buffer (rounded to whole frames and 4 KiB)
+        uint32_t bufferCount = 8;           ///< Buffers in the pool (>= 2)
+        uint32_t headerUpdateMs = 1000;     ///< Interval between crash-safe header updates
+        bool durableHeaderUpdates = true;   ///< Commit data and header to disk on every update
+    };
+
+    /**
+     * @brief Records a capture stream to a WAV file without ever blocking the capture thread.
+     *
+     * Frames are copied into a pool of large 4 KiB-aligned buffers. Full buffers are
+     * handed to a background writer through a lock-free queue and returned once written,
+     * so the capture thread only ever does a memcpy. If the disk stalls long enough for
+     * the pool to run out, incoming frames are dropped and counted instead of waiting.
+     *
+     * File layout: RIFF/WAVE with a 28-byte JUNK chunk reserved up front, `fmt `, and a
+     * padding chunk so the sample data starts at offset 4096 (every pool write is then
+     * sector-aligned). Past 4 GiB the reserved chunk becomes `ds64` and the file RF64
+     * (EBU Tech 3306).
+     *
+     * Crash safety: the writer periodically flushes the data, then patches the sizes,
+     * then flushes again. Sizes on disk therefore never cover more than the data on
+     * disk, and at every point the file is a valid WAV or RF64 of the audio recorded up
+     * to the last update.
+     *
+     * Threading: write()/drain() from one capture thread; statistics from any thread.
+     */
+    class AUDIO_SWITCHER_API WavRecorder : public IAudioSink
+    {
+    public:
+        WavRecorder() = default;
+        ~WavRecorder() override;
+
+        // Owns a writer thread: not copyable
+        WavRecorder(const WavRecorder &) = delete;
+        WavRecorder &operator=(const WavRecorder &) = delete;
+
+        /**
+         * @brief Creates a file and starts the writer thread.
+         *
+         * @param path Output file.
+         * @param format Format of the frames that will be written (e.g. CaptureStream::format()).
+         * @param config Buffering policy.
+         * @return true on success.
+         */
+        bool open(const std::filesystem::path &path, const Utility::DeviceFormatInfo &format,
+                  const WavRecorderConfig &config = WavRecorderConfig());
+
+        /**
+         * @brief Starts recording into a caller-supplied file sink (takes ownership).
+         */
+        bool open(std::unique_ptr<Utility::IFileSink> file, const Utility::DeviceFormatInfo &format,
+                  const WavRecorderConfig &config = WavRecorderConfig());
+
+        /**
+         * @brief Hands over the last partial buffer, waits for the writer and finalises the header.
+         *
+         * Blocks until everything queued is on disk; call it from a control thread, not
+         * from a real-time callback.
+         *
+         * @return true if every write succeeded.
+         */
+        bool close();
+
+        bool isOpen() const { return m_file != nullptr; }
+
+        // IAudioSink
+        const Utility::DeviceFormatInfo &format() const override { return m_format; }
+
+        /**
+         * @brief Frames that fit in the current buffer and the free pool.
+         */
+        size_t writableFrames() override;
+
+        /**
+         * @brief Copies frames into the pool. Never blocks; frames that do not fit are dropped.
+         *
+         * @return Number of frames stored.
+         */
+        size_t write(const void *src, size_t frames) override;
+
+        /**
+         * @brief Reads everything a source has available straight into the pool.
+         *
+         * The source is always drained, so a stalled disk does not back up the capture
+         * endpoint; frames without room are counted as dropped.
+         *
+         * @return Number of frames stored.
+         */
+        size_t drain(IAudioSource &source);
+
+        uint64_t framesRecorded() const { return m_framesRecorded.load(std::memory_order_relaxed); }
+        uint64_t droppedFrames() const { return m_droppedFrames.load(std::memory_order_relaxed); }
+        uint64_t bytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+        uint64_t writeErrors() const { return m_writeErrors.load(std::memory_order_relaxed); }
+
+        /// Largest number of full buffers that were waiting for the writer at once.
+        uint32_t maxQueueDepth() const { return m_maxQueueDepth.load(std::memory_order_relaxed); }
+
+        size_t bufferBytes() const { return m_bufferBytes; }
+
+        /// Offset of the first sample in the file.
+        static constexpr uint64_t DataOffset = 4096;
+
+    private:
+        struct AlignedDelete
+        {
+            void operator()(uint8_t *p) const;
+        };
+
+        struct Block
+        {
+            std::unique_ptr<uint8_t, AlignedDelete> data;
+            size_t used = 0; ///< Bytes filled (set by the capture thread before queueing)
+        };
+
+        bool acquireBlock();
+        void submitBlock();
+        void writerLoop();
+        bool writeHeader();
+        bool updateHeader(bool final);
+
+        Utility::DeviceFormatInfo m_format;
+        WavRecorderConfig m_config;
+        std::unique_ptr<Utility::IFileSink> m_file;
+
+        std::vector<Block> m_blocks;
+        size_t m_bufferBytes = 0;
+        Utility::SpscQueue<uint32_t> m_free;   ///< Writer -> capture
+        Utility::SpscQueue<uint32_t> m_filled; ///< Capture -> writer
+        int64_t m_current = -1;                ///< Block being filled by the capture thread
+        std::vector<uint8_t> m_discard;        ///< drain() scratch when the pool is exhausted
+
+        std::thread m_writer;
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wake;
+        std::atomic<bool> m_stopping{false};
+
+        // Writer-thread state
+        uint64_t m_dataBytes = 0;
+        bool m_rf64 = false;
+
+        std::atomic<uint64_t> m_framesRecorded{0};
+        std::atomic<uint64_t> m_droppedFrames{0};
+        std::atomic<uint64_t> m_bytesWritten{0};
+        std::atomic<uint64_t> m_writeErrors{0};
+        std::atomic<uint32_t> m_maxQueueDepth{0};
+    };
+}
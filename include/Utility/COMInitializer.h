@@ -13,7 +13,7 @@
     #define AUDIO_SWITCHER_API
 #endif
 
-#include <objbase.h>
+#include "Backend/Platform.h"
 #include <stdexcept>
 
 namespace Utility
@@ -30,6 +30,8 @@ namespace Utility
         uint16_t channels = 0;
         uint16_t blockAlign = 0;
         uint32_t sampleRate = 0;
+        uint32_t channelMask = 0; ///< Speaker positions (WAVEFORMATEXTENSIBLE dwChannelMask), see Dsp/ChannelLayout.h
+        bool isFloat = false; ///< True for IEEE float samples, false for integer PCM
         bool valid = false; ///< Indicates if data is valid (device was readable)
     };
 }
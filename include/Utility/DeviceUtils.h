@@ -17,15 +17,19 @@
 #endif
 
 #include <string>
-#include <mmdeviceapi.h>
+#include "Backend/Platform.h" // IMMDevice
 #include "Utility/DeviceFormatInfo.h"
 
+#if defined(_WIN32)
+#include <mmreg.h> // WAVEFORMATEX
+#endif
+
 namespace Utility
 {
     /**
      * @brief Retrieves the friendly name of an audio device.
      *
-     * This function uses the device's property store to extract the user-visible name,
+     * This function asks the installed backend (see Backend/AudioBackend.h) for the user-visible name,
      * such as "Speakers (Realtek Audio)" or "Headphones".
      *
      * @param device Pointer to a valid IMMDevice.
@@ -33,10 +37,20 @@ namespace Utility
      */
     AUDIO_SWITCHER_API std::wstring GetDeviceFriendlyName(IMMDevice *device);
 
+    /**
+     * @brief Retrieves the endpoint ID of a device (IMMDevice::GetId).
+     *
+     * @param device Pointer to a valid IMMDevice.
+     * @return std::wstring Endpoint ID, or an empty string if retrieval fails.
+     */
+    AUDIO_SWITCHER_API std::wstring GetDeviceId(IMMDevice *device);
+
     /**
      * @brief Retrieves audio format information (bit depth, sample rate, channels, etc.) for a device.
      *
-     * Internally uses IAudioClient::GetMixFormat to get the shared-mode default audio format.
+     * On Windows this is IAudioClient::GetMixFormat, the shared-mode default audio format.
+     * `channelMask` is always filled: from WAVEFORMATEXTENSIBLE if available, otherwise
+     * from the default layout for the channel count.
      *
      * @param device Pointer to a valid IMMDevice.
      * @return DeviceFormatInfo Struct containing audio format fields.
@@ -44,6 +58,18 @@ namespace Utility
      */
     AUDIO_SWITCHER_API DeviceFormatInfo GetDeviceFormatInfo(IMMDevice *device);
 
+#if defined(_WIN32)
+    /**
+     * @brief Converts a WAVEFORMATEX/WAVEFORMATEXTENSIBLE into a DeviceFormatInfo.
+     *
+     * Fills channel mask and sample type (integer/float) from the extensible part when present.
+     *
+     * @param format Pointer to a wave format (may be WAVEFORMATEXTENSIBLE).
+     * @return DeviceFormatInfo Converted format; `valid` is false for a null pointer.
+     */
+    AUDIO_SWITCHER_API DeviceFormatInfo GetWaveFormatInfo(const WAVEFORMATEX *format);
+#endif
+
     /**
      * @brief Retrieves the system's current default audio playback (render) device.
      *
@@ -67,7 +93,7 @@ namespace Utility
     /**
      * @brief Mutes or unmutes the default audio playback device.
      *
-     * This uses IAudioEndpointVolume COM interface to control the system volume mute state.
+     * On Windows this uses the IAudioEndpointVolume COM interface to control the mute state.
      *
      * @param mute True to mute, false to unmute.
      * @return true if successful, false otherwise.
@@ -85,7 +111,7 @@ namespace Utility
     /**
      * @brief Mutes or unmutes the given audio playback device.
      *
-     * This uses the IAudioEndpointVolume COM interface to mute the specified device.
+     * On Windows this uses the IAudioEndpointVolume COM interface to mute the specified device.
      *
      * @param device Pointer to the IMMDevice to mute/unmute.
      * @param mute True to mute, false to unmute.
@@ -0,0 +1,101 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+
+namespace Utility
+{
+    /**
+     * @brief Minimal seekable output file used by background writers.
+     *
+     * Data is appended with write(); writeAt() patches earlier bytes (headers) without
+     * moving the append position. Implementations are used from one thread at a time.
+     */
+    class AUDIO_SWITCHER_API IFileSink
+    {
+    public:
+        virtual ~IFileSink() = default;
+
+        /**
+         * @brief Appends bytes at the end of the file.
+         */
+        virtual bool write(const void *data, size_t bytes) = 0;
+
+        /**
+         * @brief Overwrites bytes at an absolute offset.
+         */
+        virtual bool writeAt(uint64_t offset, const void *data, size_t bytes) = 0;
+
+        /**
+         * @brief Pushes written bytes to the OS, and to stable storage when `durable` is true.
+         */
+        virtual bool flush(bool durable) = 0;
+
+        /**
+         * @brief Closes the file. Further calls fail.
+         */
+        virtual void close() = 0;
+    };
+
+    /**
+     * @brief IFileSink over an unbuffered C stdio file (64-bit offsets).
+     */
+    class AUDIO_SWITCHER_API StdioFileSink : public IFileSink
+    {
+    public:
+        StdioFileSink() = default;
+        ~StdioFileSink() override;
+
+        // Owns a FILE handle: not copyable
+        StdioFileSink(const StdioFileSink &) = delete;
+        StdioFileSink &operator=(const StdioFileSink &) = delete;
+
+        /**
+         * @brief Creates (truncates) a file for writing.
+         *
+         * @param path File path.
+         * @return true on success.
+         */
+        bool open(const std::filesystem::path &path);
+
+        bool write(const void *data, size_t bytes) override;
+        bool writeAt(uint64_t offset, const void *data, size_t bytes) override;
+        bool flush(bool durable) override;
+        void close() override;
+
+        bool isOpen() const { return m_file != nullptr; }
+
+    private:
+        bool seek(uint64_t offset);
+
+        std::FILE *m_file = nullptr;
+        uint64_t m_end = 0; ///< Append position
+    };
+
+    /**
+     * @brief Opens a StdioFileSink.
+     *
+     * @return The sink, or nullptr if the file cannot be created.
+     */
+    AUDIO_SWITCHER_API std::unique_ptr<IFileSink> CreateFileSink(const std::filesystem::path &path);
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped timers around backend calls. Enabled with the CMake option
+// AUDIO_SWITCHER_INSTRUMENTATION, which defines AUDIO_SWITCHER_INSTRUMENTATION=1;
+// otherwise the macros expand to the bare call and nothing is recorded.
+//
+//   AUDIO_SWITCHER_TIME_SCOPE("AudioManager::setDefaultOutputDevice");
+//   hr = AUDIO_SWITCHER_TIME_CALL("CoCreateInstance", CoCreateInstance(...));
+#if defined(AUDIO_SWITCHER_INSTRUMENTATION) && AUDIO_SWITCHER_INSTRUMENTATION
+#define AUDIO_SWITCHER_INSTRUMENTATION_CONCAT_(a, b) a##b
+#define AUDIO_SWITCHER_INSTRUMENTATION_CONCAT(a, b) AUDIO_SWITCHER_INSTRUMENTATION_CONCAT_(a, b)
+#define AUDIO_SWITCHER_TIME_SCOPE_(name, id)                                                             \
+    static const uint32_t AUDIO_SWITCHER_INSTRUMENTATION_CONCAT(asTimedOp_, id) =                        \
+        ::Utility::RegisterTimedOperation(name);                                                         \
+    const ::Utility::ScopedTimer AUDIO_SWITCHER_INSTRUMENTATION_CONCAT(asTimer_, id)(                    \
+        AUDIO_SWITCHER_INSTRUMENTATION_CONCAT(asTimedOp_, id))
+#define AUDIO_SWITCHER_TIME_SCOPE(name) AUDIO_SWITCHER_TIME_SCOPE_(name, __COUNTER__)
+#define AUDIO_SWITCHER_TIME_CALL(name, ...) \
+    ([&]() -> decltype(auto) { AUDIO_SWITCHER_TIME_SCOPE(name); return __VA_ARGS__; }())
+#else
+#define AUDIO_SWITCHER_TIME_SCOPE(name) ((void)0)
+#define AUDIO_SWITCHER_TIME_CALL(name, ...) (__VA_ARGS__)
+#endif
+
+namespace Utility
+{
+    /**
+     * @brief Latency summary of one instrumented operation, merged over all threads.
+     */
+    struct OperationStats
+    {
+        std::string name;
+        uint64_t count = 0;
+        double meanUs = 0.0;
+        double p50Us = 0.0;
+        double p99Us = 0.0;
+        double maxUs = 0.0;
+    };
+
+    /**
+     * @brief True when the library was built with instrumentation.
+     */
+    AUDIO_SWITCHER_API bool InstrumentationEnabled();
+
+    /**
+     * @brief Returns the ID of an operation name, registering it on first use.
+     *
+     * Called once per timer site (the macros cache the ID in a static). At most 64
+     * operations are tracked; further names share the last slot.
+     */
+    AUDIO_SWITCHER_API uint32_t RegisterTimedOperation(const char *name);
+
+    /**
+     * @brief Adds one sample to the calling thread's histogram of an operation.
+     *
+     * Lock-free: each thread writes only its own histograms.
+     */
+    AUDIO_SWITCHER_API void RecordTimedOperation(uint32_t operation, uint64_t nanoseconds);
+
+    /**
+     * @brief Merges every thread's histograms into per-operation statistics.
+     *
+     * Percentiles are bucket midpoints (log-linear buckets, ±6% resolution). Empty
+     * operations are omitted. Returns nothing when instrumentation is compiled out.
+     */
+    AUDIO_SWITCHER_API std::vector<OperationStats> GetInstrumentationSnapshot();
+
+    /**
+     * @brief Clears all histograms (samples recorded concurrently may survive).
+     */
+    AUDIO_SWITCHER_API void ResetInstrumentation();
+
+    /**
+     * @brief Records the lifetime of the object as one sample of an operation.
+     */
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(uint32_t operation)
+            : m_operation(operation), m_start(std::chrono::steady_clock::now()) {}
+
+        ~ScopedTimer()
+        {
+            const auto elapsed = std::chrono::steady_clock::now() - m_start;
+            RecordTimedOperation(m_operation, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        uint32_t m_operation;
+        std::chrono::steady_clock::time_point m_start;
+    };
+}
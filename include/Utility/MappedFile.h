@@ -0,0 +1,64 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace Utility
+{
+    /**
+     * @brief Read-only memory mapping of a whole file.
+     *
+     * Pages are loaded on first access by the OS, so opening a large file is cheap and
+     * reading it needs no intermediate buffer.
+     */
+    class AUDIO_SWITCHER_API MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        // Owns OS handles: not copyable
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        /**
+         * @brief Maps a file for reading.
+         *
+         * @param path File to map (must not be empty).
+         * @return true on success.
+         */
+        bool open(const std::filesystem::path &path);
+
+        /**
+         * @brief Unmaps the file.
+         */
+        void close();
+
+        bool isOpen() const { return m_data != nullptr; }
+        const uint8_t *data() const { return m_data; }
+        uint64_t size() const { return m_size; }
+
+    private:
+        const uint8_t *m_data = nullptr;
+        uint64_t m_size = 0;
+        void *m_mapping = nullptr; ///< Win32 file-mapping handle (unused on POSIX)
+    };
+}
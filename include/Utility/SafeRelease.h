@@ -17,7 +17,7 @@
     #define AUDIO_SWITCHER_API
 #endif
 
-#include <windows.h>
+#include "Backend/Platform.h"
 
 namespace Utility
 {
@@ -0,0 +1,102 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace Utility
+{
+    /**
+     * @brief Bounded lock-free single-producer / single-consumer queue.
+     *
+     * Capacity is rounded up to a power of two. tryPush() is only called from the
+     * producer thread and tryPop() only from the consumer thread; neither ever blocks.
+     * Intended for small trivially copyable items such as buffer indices.
+     */
+    template <typename T>
+    class SpscQueue
+    {
+    public:
+        explicit SpscQueue(size_t capacity = 0) { reset(capacity); }
+
+        SpscQueue(const SpscQueue &) = delete;
+        SpscQueue &operator=(const SpscQueue &) = delete;
+
+        /**
+         * @brief Resizes and empties the queue. Not thread-safe.
+         */
+        void reset(size_t capacity)
+        {
+            size_t size = 1;
+            while (size < capacity)
+                size <<= 1;
+            m_items.assign(size, T());
+            m_mask = size - 1;
+            m_head.store(0, std::memory_order_relaxed);
+            m_tail.store(0, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Appends an item. Producer thread only.
+         *
+         * @return false if the queue is full.
+         */
+        bool tryPush(const T &item)
+        {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+                return false;
+
+            m_items[tail & m_mask] = item;
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Removes the oldest item. Consumer thread only.
+         *
+         * @return false if the queue is empty.
+         */
+        bool tryPop(T &item)
+        {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire))
+                return false;
+
+            item = m_items[head & m_mask];
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// Approximate number of queued items (exact when both sides are idle).
+        size_t size() const
+        {
+            return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+        }
+
+        size_t capacity() const { return m_mask + 1; }
+
+    private:
+        std::vector<T> m_items;
+        size_t m_mask = 0;
+        alignas(64) std::atomic<size_t> m_head{0}; ///< Next slot to pop (consumer)
+        alignas(64) std::atomic<size_t> m_tail{0}; ///< Next slot to push (producer)
+    };
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Define export/import macro for the AudioSwitcher library.
+// When building the DLL, define AUDIO_SWITCHER_EXPORTS so that this class is exported.
+// Otherwise, it will be imported.
+// On Windows, we want to export/import symbols only for the shared library.
+// When building the static library, we don’t need any decoration.
+#if defined(_WIN32)
+#if defined(AUDIO_SWITCHER_STATIC)
+#define AUDIO_SWITCHER_API
+#elif defined(AUDIO_SWITCHER_EXPORTS)
+#define AUDIO_SWITCHER_API __declspec(dllexport)
+#else
+#define AUDIO_SWITCHER_API __declspec(dllimport)
+#endif
+#else
+#define AUDIO_SWITCHER_API
+#endif
+
+#include <string>
+
+namespace Utility
+{
+    /**
+     * @brief Converts a wide string (UTF-16 on Windows, UTF-32 elsewhere) to UTF-8.
+     *
+     * Unpaired surrogates and out-of-range code points become U+FFFD.
+     */
+    AUDIO_SWITCHER_API std::string ToUtf8(const std::wstring &text);
+
+    /**
+     * @brief Converts UTF-8 to a wide string.
+     *
+     * Malformed sequences (truncated, overlong, surrogates, > U+10FFFF) become U+FFFD.
+     */
+    AUDIO_SWITCHER_API std::wstring FromUtf8(const std::string &text);
+}
@@ -0,0 +1,158 @@
+// AudioSwitcherService: resident audio-control daemon.
+//
+// Keeps the device table and backend objects warm and serves clients
+// (Service::AudioClient) over a local socket / named pipe:
+//
+//   AudioSwitcherService [--endpoint PATH] [--backend simulated|platform]
+//
+// The simulated backend (default off Windows) lets the daemon and its clients
+// run anywhere; --devices, --inputs and --latency-us shape it as in the bench.
+//
+// --snapshot [NAME] also publishes the device state into shared memory for
+// processes that only read it (Service::SnapshotReader).
+
+#include "Backend/AudioBackend.h"
+#include "Backend/SimulatedBackend.h"
+#include "Service/AudioService.h"
+#include "Service/DeviceSnapshot.h"
+#include "Utility/COMInitializer.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace
+{
+    std::atomic<bool> g_stop{false};
+
+    void OnSignal(int)
+    {
+        g_stop.store(true);
+    }
+
+    struct Options
+    {
+        std::string endpoint;
+#if defined(_WIN32)
+        bool platform = true;
+#else
+        bool platform = false;
+#endif
+        uint32_t renderDevices = 4;
+        uint32_t captureDevices = 2;
+        uint32_t latencyUs = 0;
+        bool snapshot = false;
+        std::string snapshotName;
+    };
+
+    void PrintUsage()
+    {
+        std::fprintf(stderr,
+                     "Usage: AudioSwitcherService [--endpoint PATH] [--backend simulated|platform]\n"
+                     "                            [--devices N] [--inputs N] [--latency-us US]\n"
+                     "                            [--snapshot [NAME]]\n");
+    }
+
+    bool ParseOptions(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--endpoint" && hasValue)
+                options.endpoint = argv[++i];
+            else if (arg == "--backend" && hasValue)
+            {
+                const std::string backend = argv[++i];
+                if (backend != "simulated" && backend != "platform")
+                    return false;
+                options.platform = backend == "platform";
+            }
+            else if (arg == "--devices" && hasValue)
+                options.renderDevices = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--inputs" && hasValue)
+                options.captureDevices = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--latency-us" && hasValue)
+                options.latencyUs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--snapshot")
+            {
+                options.snapshot = true;
+                if (hasValue && argv[i + 1][0] != '-')
+                    options.snapshotName = argv[++i];
+            }
+            else
+                return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    Utility::COMInitializer com;
+
+    if (!options.platform)
+    {
+        Backend::SimulatedBackendConfig config;
+        config.renderDevices = options.renderDevices;
+        config.captureDevices = options.captureDevices;
+        config.latency.enumerateUs = options.latencyUs;
+        config.latency.propertyUs = options.latencyUs;
+        config.latency.defaultUs = options.latencyUs;
+        config.latency.setDefaultUs = options.latencyUs;
+        config.latency.formatUs = options.latencyUs;
+        config.latency.volumeUs = options.latencyUs;
+        Backend::SetAudioBackend(std::make_shared<Backend::SimulatedBackend>(config));
+    }
+
+    Service::ServiceConfig config;
+    config.endpoint = options.endpoint;
+    Service::AudioService service(config);
+    if (!service.start())
+    {
+        if (service.alreadyRunning())
+            std::fprintf(stderr, "Already running: another service listens on %s\n", service.endpoint().c_str());
+        else
+            std::fprintf(stderr, "Cannot listen on %s\n", service.endpoint().c_str());
+        return 1;
+    }
+    std::fprintf(stderr, "Listening on %s (%s backend)\n", service.endpoint().c_str(),
+                 Backend::GetAudioBackend()->name());
+
+    Service::SnapshotPublisher publisher;
+    if (options.snapshot)
+    {
+        const std::string name = options.snapshotName.empty() ? Service::DefaultSnapshotName() : options.snapshotName;
+        if (!publisher.open(name) || !publisher.start())
+        {
+            std::fprintf(stderr, "Cannot publish snapshot %s\n", name.c_str());
+            return 1;
+        }
+        std::fprintf(stderr, "Publishing snapshot %s\n", name.c_str());
+    }
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+    while (!g_stop.load())
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    publisher.close();
+    service.stop();
+    const Service::ServiceStats stats = service.stats();
+    std::fprintf(stderr, "Stopped: %llu connections, %llu requests, %llu events\n",
+                 static_cast<unsigned long long>(stats.connections), static_cast<unsigned long long>(stats.requests),
+                 static_cast<unsigned long long>(stats.events));
+    return 0;
+}
@@ -1,10 +1,9 @@
 #include "AudioSwitcher/AudioInputSwitcher.h"
-#include "AudioSwitcher/IPolicyConfig.h"
+#include "Backend/AudioBackend.h"
+#include "Utility/Instrumentation.h"
 
-#include <mmdeviceapi.h>
-#include <functiondiscoverykeys_devpkey.h>
 #include <iostream>
-#include <comdef.h>
+#include <stdexcept>
 
 namespace AudioSwitcher
 {
@@ -12,94 +11,61 @@ namespace AudioSwitcher
      * @brief Lists all active audio input (capture) devices like microphones.
      *
      * @return std::vector<AudioInputDevice> A list of devices with their IDs and friendly names.
-     * @throws std::runtime_error If any COM operation fails.
+     * @throws std::runtime_error If enumeration fails or no device is found.
      */
     std::vector<AudioInputDevice> AudioInputManager::listInputDevices()
     {
+        AUDIO_SWITCHER_TIME_SCOPE("AudioInputManager::listInputDevices");
         std::vector<AudioInputDevice> devices;
 
-        IMMDeviceEnumerator *pEnum = nullptr;
-        IMMDeviceCollection *pDevices = nullptr;
-
-        try
-        {
-            HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
-                                          __uuidof(IMMDeviceEnumerator), (void **)&pEnum);
-            if (FAILED(hr))
-                throw std::runtime_error("[x] Failed to create device enumerator.");
-
-            // Input devices → eCapture
-            hr = pEnum->EnumAudioEndpoints(eCapture, DEVICE_STATE_ACTIVE, &pDevices);
-            if (FAILED(hr))
-                throw std::runtime_error("[x] Failed to enumerate input devices.");
-
-            UINT count = 0;
-            hr = pDevices->GetCount(&count);
-            if (FAILED(hr))
-                throw std::runtime_error("[x] Failed to get input device count.");
-            if (count == 0)
-                throw std::runtime_error("[x] No input devices found.");
-
-            for (UINT i = 0; i < count; ++i)
+        // Input devices → eCapture
+        HRESULT hr = Backend::GetAudioBackend()->enumerateDevices(
+            eCapture, [&devices](const std::wstring &id, const std::wstring &name, IMMDevice *pDevice)
             {
-                IMMDevice *pDevice = nullptr;
-                LPWSTR deviceId = nullptr;
-
-                hr = pDevices->Item(i, &pDevice);
-                if (FAILED(hr))
-                    continue;
-
-                hr = pDevice->GetId(&deviceId);
-                if (FAILED(hr) && pDevice)
-                {
-                    pDevice->Release();
-                    continue;
-                }
-
-                IPropertyStore *pStore = nullptr;
-                hr = pDevice->OpenPropertyStore(STGM_READ, &pStore);
-                if (FAILED(hr) && pDevice)
-                {
-                    pDevice->Release();
-                    continue;
-                }
-
-                PROPVARIANT prop;
-                PropVariantInit(&prop);
-                hr = pStore->GetValue(PKEY_Device_FriendlyName, &prop);
-                if (SUCCEEDED(hr))
-                {
-                    AudioInputDevice device;
-                    device.id = deviceId;
-                    device.name = prop.pwszVal;
-                    device.device = pDevice;
-
-                    devices.push_back(std::move(device));
-                }
-                else
-                {
-                    if (pDevice)
-                        pDevice->Release();
-                }
-
-                PropVariantClear(&prop);
-                pStore->Release();
-            }
-
-            pDevices->Release();
-            pEnum->Release();
+                AudioInputDevice device;
+                device.id = id;
+                device.name = name;
+                pDevice->AddRef();
+                device.device = pDevice;
+                devices.push_back(std::move(device));
+            });
+
+        if (FAILED(hr))
+            throw std::runtime_error("[x] Failed to enumerate input devices.");
+        if (devices.empty())
+            throw std::runtime_error("[x] No input devices found.");
+
+        return devices;
+    }
 
-            return devices;
-        }
-        catch (const std::exception &e)
-        {
-            if (pDevices)
-                pDevices->Release();
-            if (pEnum)
-                pEnum->Release();
+    /**
+     * @brief Lists the input devices whose state is in `stateMask`.
+     *
+     * @param stateMask DEVICE_STATE_* bits.
+     * @return std::vector<AudioInputDevice> Devices with their IDs, friendly names and states.
+     * @throws std::runtime_error If enumeration fails.
+     */
+    std::vector<AudioInputDevice> AudioInputManager::listInputDevices(DWORD stateMask)
+    {
+        AUDIO_SWITCHER_TIME_SCOPE("AudioInputManager::listInputDevices(stateMask)");
+        std::vector<AudioInputDevice> devices;
 
-            throw std::runtime_error(e.what());
-        }
+        HRESULT hr = Backend::GetAudioBackend()->enumerateDevicesByState(
+            eCapture, stateMask, [&devices](const std::wstring &id, const std::wstring &name, DWORD state, IMMDevice *pDevice)
+            {
+                AudioInputDevice device;
+                device.id = id;
+                device.name = name;
+                device.state = state;
+                pDevice->AddRef();
+                device.device = pDevice;
+                devices.push_back(std::move(device));
+            });
+
+        if (FAILED(hr))
+            throw std::runtime_error("[x] Failed to enumerate input devices.");
+
+        return devices;
     }
 
     /**
@@ -110,31 +76,16 @@ namespace AudioSwitcher
      */
     bool AudioInputManager::setDefaultInputDevice(const std::wstring &deviceId)
     {
-        IPolicyConfig *pPolicyConfig = nullptr;
+        AUDIO_SWITCHER_TIME_SCOPE("AudioInputManager::setDefaultInputDevice");
 
-        try
+        HRESULT hr = Backend::GetAudioBackend()->setDefaultDevice(deviceId, Backend::AllRoles);
+        if (FAILED(hr))
         {
-            HRESULT hr = CoCreateInstance(__uuidof(CPolicyConfigClient), nullptr, CLSCTX_ALL,
-                                          __uuidof(IPolicyConfig), (void **)&pPolicyConfig);
-            if (FAILED(hr) || !pPolicyConfig)
-                throw std::runtime_error("[x] Failed to create IPolicyConfig COM object.");
-
-            HRESULT hr1 = pPolicyConfig->SetDefaultEndpoint(deviceId.c_str(), eConsole);
-            HRESULT hr2 = pPolicyConfig->SetDefaultEndpoint(deviceId.c_str(), eMultimedia);
-            HRESULT hr3 = pPolicyConfig->SetDefaultEndpoint(deviceId.c_str(), eCommunications);
-
-            pPolicyConfig->Release();
-
-            return SUCCEEDED(hr1) && SUCCEEDED(hr2) && SUCCEEDED(hr3);
-        }
-        catch (const std::exception &e)
-        {
-            if (pPolicyConfig)
-                pPolicyConfig->Release();
-
-            std::wcerr << L"[x] Error: " << e.what() << L"\n";
+            std::wcerr << L"[x] Error: failed to set the default input device.\n";
             return false;
         }
+
+        return true;
     }
 
 } // namespace AudioSwitcher
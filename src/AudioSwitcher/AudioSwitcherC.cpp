@@ -0,0 +1,523 @@
+#include "AudioSwitcher/AudioSwitcherC.h"
+#include "Backend/AudioBackend.h"
+#include "Utility/SafeRelease.h"
+#include "Utility/StringConvert.h"
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+
+namespace
+{
+    /**
+     * @brief Cached endpoint. Slots are never removed, so a handle (index + 1) stays valid.
+     */
+    struct Slot
+    {
+        std::wstring id;
+        std::string idUtf8;
+        std::wstring name;
+        std::string nameUtf8;
+        EDataFlow flow = eRender;
+        DWORD state = DEVICE_STATE_NOTPRESENT;
+        IMMDevice *device = nullptr; ///< Held while known to the backend
+        bool seen = false;           ///< Enumerated by the current refresh
+    };
+
+    EDataFlow FlowFromId(const std::wstring &deviceId)
+    {
+        if (deviceId.size() > 5 && deviceId.compare(0, 5, L"{0.0.") == 0 && deviceId[5] == L'1')
+            return eCapture;
+        return eRender;
+    }
+
+    bool ValidFlow(int32_t flow)
+    {
+        return flow == ASW_FLOW_RENDER || flow == ASW_FLOW_CAPTURE;
+    }
+
+    int32_t CopyString(const std::string &text, char *buffer, uint32_t capacity, uint32_t *size)
+    {
+        const uint32_t required = static_cast<uint32_t>(text.size() + 1);
+        if (size)
+            *size = required;
+        if (!buffer || capacity < required)
+            return ASW_E_INSUFFICIENT_BUFFER;
+        std::memcpy(buffer, text.c_str(), required);
+        return ASW_OK;
+    }
+}
+
+/**
+ * @brief Device table of one backend, kept current by its notifications.
+ *
+ * The mutex is recursive because the simulated backend notifies synchronously
+ * from inside the calls made under it (e.g. setDefaultDevice()).
+ */
+struct AswContext : public Backend::IDeviceListener
+{
+    std::shared_ptr<Backend::IAudioBackend> backend;
+    std::recursive_mutex mutex;
+    std::deque<Slot> slots;
+    int defaults[2][3] = {{-1, -1, -1}, {-1, -1, -1}}; ///< [flow][role] → slot index
+    std::atomic<bool> dirty{true};                     ///< Endpoints changed since the last refresh
+    AswEventCallback callback = nullptr;
+    void *user = nullptr;
+
+    ~AswContext() override
+    {
+        for (Slot &slot : slots)
+            Utility::SafeRelease(slot.device);
+    }
+
+    Slot *slotLocked(AswDevice device)
+    {
+        if (device == 0 || device > slots.size())
+            return nullptr;
+        return &slots[device - 1];
+    }
+
+    int findLocked(const std::wstring &id) const
+    {
+        for (size_t i = 0; i < slots.size(); ++i)
+            if (slots[i].id == id)
+                return static_cast<int>(i);
+        return -1;
+    }
+
+    int findOrAddLocked(const std::wstring &id, EDataFlow flow)
+    {
+        const int index = findLocked(id);
+        if (index >= 0)
+            return index;
+
+        Slot slot;
+        slot.id = id;
+        slot.idUtf8 = Utility::ToUtf8(id);
+        slot.flow = flow;
+        slots.push_back(std::move(slot));
+        return static_cast<int>(slots.size() - 1);
+    }
+
+    /**
+     * @brief Re-reads endpoints and defaults. Allocates only for new or renamed endpoints.
+     */
+    HRESULT refreshLocked()
+    {
+        dirty.store(false, std::memory_order_relaxed);
+        for (Slot &slot : slots)
+            slot.seen = false;
+
+        for (EDataFlow flow : {eRender, eCapture})
+        {
+            const HRESULT hr = backend->enumerateDevices(flow, [&](const std::wstring &id, const std::wstring &name, IMMDevice *device)
+                                                         {
+                Slot &slot = slots[static_cast<size_t>(findOrAddLocked(id, flow))];
+                slot.flow = flow;
+                slot.state = DEVICE_STATE_ACTIVE;
+                slot.seen = true;
+                if (slot.name != name)
+                {
+                    slot.name = name;
+                    slot.nameUtf8 = Utility::ToUtf8(name);
+                }
+                if (slot.device != device)
+                {
+                    Utility::SafeRelease(slot.device);
+                    device->AddRef();
+                    slot.device = device;
+                } });
+            if (FAILED(hr))
+            {
+                dirty.store(true, std::memory_order_relaxed);
+                return hr;
+            }
+        }
+
+        // Endpoints that were not enumerated are inactive; read their actual state
+        for (Slot &slot : slots)
+        {
+            if (slot.seen)
+                continue;
+            if (!slot.device)
+                backend->getDevice(slot.id, &slot.device);
+            DWORD state = DEVICE_STATE_NOTPRESENT;
+            if (!slot.device || FAILED(backend->getDeviceState(slot.device, state)) || state == DEVICE_STATE_ACTIVE)
+                state = DEVICE_STATE_NOTPRESENT;
+            slot.state = state;
+        }
+
+        for (EDataFlow flow : {eRender, eCapture})
+        {
+            for (int role = 0; role < 3; ++role)
+            {
+                defaults[flow][role] = -1;
+                IMMDevice *device = nullptr;
+                if (FAILED(backend->getDefaultDevice(flow, static_cast<ERole>(role), &device)) || !device)
+                    continue;
+                for (size_t i = 0; i < slots.size() && defaults[flow][role] < 0; ++i)
+                    if (slots[i].device == device)
+                        defaults[flow][role] = static_cast<int>(i);
+                if (defaults[flow][role] < 0)
+                {
+                    // Core Audio hands out a new object per call: match by ID
+                    LPWSTR id = nullptr;
+                    if (SUCCEEDED(device->GetId(&id)) && id)
+                        defaults[flow][role] = findLocked(id);
+                    CoTaskMemFree(id);
+                }
+                Utility::SafeRelease(device);
+            }
+        }
+        return S_OK;
+    }
+
+    /// Refreshes if a notification invalidated the table.
+    HRESULT syncLocked()
+    {
+        if (!dirty.load(std::memory_order_relaxed))
+            return S_OK;
+        try
+        {
+            return refreshLocked();
+        }
+        catch (const std::bad_alloc &)
+        {
+            dirty.store(true, std::memory_order_relaxed);
+            return E_OUTOFMEMORY;
+        }
+    }
+
+    /**
+     * @brief Takes a device for a backend call (nullptr for a bad handle or an unknown endpoint).
+     */
+    IMMDevice *deviceLocked(AswDevice handle)
+    {
+        syncLocked();
+        Slot *slot = slotLocked(handle);
+        return slot ? slot->device : nullptr;
+    }
+
+    // --- IDeviceListener: update the table in place where possible, then forward ---
+
+    void onDeviceAdded(const std::wstring &deviceId) override
+    {
+        emit(ASW_EVENT_DEVICE_ADDED, deviceId, true);
+    }
+
+    void onDeviceRemoved(const std::wstring &deviceId) override
+    {
+        emit(ASW_EVENT_DEVICE_REMOVED, deviceId, true);
+    }
+
+    void onDeviceStateChanged(const std::wstring &deviceId, DWORD state) override
+    {
+        AswEvent event = {};
+        event.state = state;
+        emit(ASW_EVENT_STATE_CHANGED, deviceId, true, event);
+    }
+
+    void onDefaultDeviceChanged(EDataFlow flow, ERole role, const std::wstring &deviceId) override
+    {
+        AswEvent event = {};
+        event.flow = flow;
+        event.role = role;
+        emit(ASW_EVENT_DEFAULT_CHANGED, deviceId, false, event);
+    }
+
+    void onVolumeChanged(const std::wstring &deviceId, float volume, bool muted) override
+    {
+        AswEvent event = {};
+        event.volume = volume;
+        event.muted = muted ? 1 : 0;
+        emit(ASW_EVENT_VOLUME_CHANGED, deviceId, false, event);
+    }
+
+    void emit(int32_t type, const std::wstring &deviceId, bool invalidates, AswEvent event = AswEvent())
+    {
+        AswEventCallback target = nullptr;
+        void *targetUser = nullptr;
+        {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+            if (invalidates)
+                dirty.store(true, std::memory_order_relaxed);
+
+            int index = findLocked(deviceId);
+            if (index < 0 && !deviceId.empty())
+            {
+                try
+                {
+                    index = findOrAddLocked(deviceId, FlowFromId(deviceId));
+                    dirty.store(true, std::memory_order_relaxed);
+                }
+                catch (const std::bad_alloc &)
+                {
+                    dirty.store(true, std::memory_order_relaxed);
+                }
+            }
+
+            if (type == ASW_EVENT_DEFAULT_CHANGED && (event.flow == eRender || event.flow == eCapture) &&
+                event.role >= eConsole && event.role <= eCommunications)
+                defaults[event.flow][event.role] = index;
+
+            event.type = type;
+            event.device = index < 0 ? 0 : static_cast<AswDevice>(index + 1);
+            target = callback;
+            targetUser = user;
+        }
+
+        if (target)
+            target(&event, targetUser);
+    }
+};
+
+extern "C"
+{
+    /**
+     * @brief Creates a context bound to Backend::GetAudioBackend() and fills its device table.
+     *
+     * The context keeps that backend even if SetAudioBackend() replaces it later.
+     *
+     * @param context Receives the context.
+     * @return HRESULT ASW_OK, ASW_E_POINTER, ASW_E_OUTOFMEMORY, or the backend's enumeration failure.
+     */
+    int32_t AswCreateContext(AswContext **context)
+    {
+        if (!context)
+            return ASW_E_POINTER;
+        *context = nullptr;
+
+        AswContext *created = new (std::nothrow) AswContext();
+        if (!created)
+            return ASW_E_OUTOFMEMORY;
+
+        HRESULT hr = S_OK;
+        try
+        {
+            created->backend = Backend::GetAudioBackend();
+            created->backend->registerListener(created);
+            std::lock_guard<std::recursive_mutex> lock(created->mutex);
+            hr = created->refreshLocked();
+        }
+        catch (const std::bad_alloc &)
+        {
+            hr = E_OUTOFMEMORY;
+        }
+
+        if (FAILED(hr))
+        {
+            AswDestroyContext(created);
+            return static_cast<int32_t>(hr);
+        }
+        *context = created;
+        return ASW_OK;
+    }
+
+    /**
+     * @brief Unregisters the context from its backend (waiting for a running callback) and frees it.
+     */
+    void AswDestroyContext(AswContext *context)
+    {
+        if (!context)
+            return;
+        if (context->backend)
+            context->backend->unregisterListener(context);
+        delete context;
+    }
+
+    int32_t AswRefresh(AswContext *context)
+    {
+        if (!context)
+            return ASW_E_POINTER;
+
+        std::lock_guard<std::recursive_mutex> lock(context->mutex);
+        context->dirty.store(true, std::memory_order_relaxed);
+        return static_cast<int32_t>(context->syncLocked());
+    }
+
+    /**
+     * @brief Copies the active endpoints of a flow from the cached table.
+     */
+    int32_t AswEnumerateDevices(AswContext *context, int32_t flow, AswDeviceInfo *devices, uint32_t capacity, uint32_t *count)
+    {
+        if (!context || !count || (capacity > 0 && !devices))
+            return ASW_E_POINTER;
+        if (!ValidFlow(flow) && flow != ASW_FLOW_ALL)
+            return ASW_E_INVALIDARG;
+
+        std::lock_guard<std::recursive_mutex> lock(context->mutex);
+        const HRESULT hr = context->syncLocked();
+        if (FAILED(hr))
+            return static_cast<int32_t>(hr);
+
+        uint32_t n = 0;
+        for (size_t i = 0; i < context->slots.size(); ++i)
+        {
+            const Slot &slot = context->slots[i];
+            if (slot.state != DEVICE_STATE_ACTIVE || (flow != ASW_FLOW_ALL && slot.flow != flow))
+                continue;
+
+            if (n < capacity)
+            {
+                AswDeviceInfo &info = devices[n];
+                info.device = static_cast<AswDevice>(i + 1);
+                info.flow = slot.flow;
+                info.state = slot.state;
+                info.defaultRoles = 0;
+                for (int role = 0; role < 3; ++role)
+                    if (context->defaults[slot.flow][role] == static_cast<int>(i))
+                        info.defaultRoles |= 1u << role;
+                info.idSize = static_cast<uint32_t>(slot.idUtf8.size() + 1);
+                info.nameSize = static_cast<uint32_t>(slot.nameUtf8.size() + 1);
+            }
+            ++n;
+        }
+
+        *count = n;
+        return n > capacity ? ASW_E_INSUFFICIENT_BUFFER : ASW_OK;
+    }
+
+    int32_t AswGetDeviceId(AswContext *context, AswDevice device, char *buffer, uint32_t capacity, uint32_t *size)
+    {
+        if (!context)
+            return ASW_E_POINTER;
+
+        std::lock_guard<std::recursive_mutex> lock(context->mutex);
+        const Slot *slot = context->slotLocked(device);
+        if (!slot)
+            return ASW_E_NOTFOUND;
+        return CopyString(slot->idUtf8, buffer, capacity, size);
+    }
+
+    int32_t AswGetDeviceName(AswContext *context, AswDevice device, char *buffer, uint32_t capacity, uint32_t *size)
+    {
+        if (!context)
+            return ASW_E_POINTER;
+
+        std::lock_guard<std::recursive_mutex> lock(context->mutex);
+        context->syncLocked();
+        const Slot *slot = context->slotLocked(device);
+        if (!slot)
+            return ASW_E_NOTFOUND;
+        return CopyString(slot->nameUtf8, buffer, capacity, size);
+    }
+
+    int32_t AswFindDevice(AswContext *context, const char *id, AswDevice *device)
+    {
+        if (!context || !id || !device)
+            return ASW_E_POINTER;
+        *device = 0;
+
+        std::lock_guard<std::recursive_mutex> lock(context->mutex);
+        context->syncLocked();
+        for (size_t i = 0; i < context->slots.size(); ++i)
+        {
+            if (context->slots[i].idUtf8 == id)
+            {
+                *device = static_cast<AswDevice>(i + 1);
+                return ASW_OK;
+            }
+        }
+        return ASW_E_NOTFOUND;
+    }
+
+    int32_t AswGetDefaultDevice(AswContext *context, int32_t flow, int32_t role, AswDevice *device)
+    {
+        if (!context || !device)
+            return ASW_E_POINTER;
+        *device = 0;
+        if (!ValidFlow(flow) || role < ASW_ROLE_CONSOLE || role > ASW_ROLE_COMMUNICATIONS)
+            return ASW_E_INVALIDARG;
+
+        std::lock_guard<std::recursive_mutex> lock(context->mutex);
+        const HRESULT hr = context->syncLocked();
+        if (FAILED(hr))
+            return static_cast<int32_t>(hr);
+
+        const int index = context->defaults[flow][role];
+        if (index < 0)
+            return ASW_S_FALSE;
+        *device = static_cast<AswDevice>(index + 1);
+        return ASW_OK;
+    }
+
+    int32_t AswSetDefaultDevice(AswContext *context, AswDevice device, uint32_t roles)
+    {
+        if (!context)
+            return ASW_E_POINTER;
+        if (roles == 0 || (roles & ~ASW_ROLE_MASK_ALL))
+            return ASW_E_INVALIDARG;
+
+        std::lock_guard<std::recursive_mutex> lock(context->mutex);
+        const Slot *slot = context->slotLocked(device);
+        if (!slot)
+            return ASW_E_NOTFOUND;
+        return static_cast<int32_t>(context->backend->setDefaultDevice(slot->id, roles));
+    }
+
+    int32_t AswGetMute(AswContext *context, AswDevice device, int32_t *muted)
+    {
+        if (!context || !muted)
+            return ASW_E_POINTER;
+
+        std::lock_guard<std::recursive_mutex> lock(context->mutex);
+        IMMDevice *endpoint = context->deviceLocked(device);
+        if (!endpoint)
+            return ASW_E_NOTFOUND;
+        bool mute = false;
+        const HRESULT hr = context->backend->getMute(endpoint, mute);
+        *muted = mute ? 1 : 0;
+        return static_cast<int32_t>(hr);
+    }
+
+    int32_t AswSetMute(AswContext *context, AswDevice device, int32_t muted)
+    {
+        if (!context)
+            return ASW_E_POINTER;
+
+        std::lock_guard<std::recursive_mutex> lock(context->mutex);
+        IMMDevice *endpoint = context->deviceLocked(device);
+        if (!endpoint)
+            return ASW_E_NOTFOUND;
+        return static_cast<int32_t>(context->backend->setMute(endpoint, muted != 0));
+    }
+
+    int32_t AswGetVolume(AswContext *context, AswDevice device, float *volume)
+    {
+        if (!context || !volume)
+            return ASW_E_POINTER;
+
+        std::lock_guard<std::recursive_mutex> lock(context->mutex);
+        IMMDevice *endpoint = context->deviceLocked(device);
+        if (!endpoint)
+            return ASW_E_NOTFOUND;
+        return static_cast<int32_t>(context->backend->getVolume(endpoint, *volume));
+    }
+
+    int32_t AswSetVolume(AswContext *context, AswDevice device, float volume)
+    {
+        if (!context)
+            return ASW_E_POINTER;
+
+        std::lock_guard<std::recursive_mutex> lock(context->mutex);
+        IMMDevice *endpoint = context->deviceLocked(device);
+        if (!endpoint)
+            return ASW_E_NOTFOUND;
+        return static_cast<int32_t>(context->backend->setVolume(endpoint, volume));
+    }
+
+    int32_t AswSetEventCallback(AswContext *context, AswEventCallback callback, void *user)
+    {
+        if (!context)
+            return ASW_E_POINTER;
+
+        std::lock_guard<std::recursive_mutex> lock(context->mutex);
+        context->callback = callback;
+        context->user = callback ? user : nullptr;
+        return ASW_OK;
+    }
+}
@@ -0,0 +1,122 @@
+#include "Backend/AudioBackend.h"
+#include "Backend/SimulatedBackend.h"
+
+#if defined(_WIN32)
+#include "WasapiBackend.h"
+#endif
+
+#include <mutex>
+#include <utility>
+
+namespace Backend
+{
+    namespace
+    {
+        std::mutex &BackendMutex()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::shared_ptr<IAudioBackend> &CurrentBackend()
+        {
+            static std::shared_ptr<IAudioBackend> backend;
+            return backend;
+        }
+    }
+
+    /**
+     * @brief Returns the method name of an operation.
+     */
+    const char *OperationName(BackendOperation operation)
+    {
+        switch (operation)
+        {
+        case BackendOperation::EnumerateDevices:
+            return "enumerateDevices";
+        case BackendOperation::GetDevice:
+            return "getDevice";
+        case BackendOperation::GetDefaultDevice:
+            return "getDefaultDevice";
+        case BackendOperation::SetDefaultDevice:
+            return "setDefaultDevice";
+        case BackendOperation::GetFriendlyName:
+            return "getFriendlyName";
+        case BackendOperation::GetDeviceState:
+            return "getDeviceState";
+        case BackendOperation::GetMixFormat:
+            return "getMixFormat";
+        case BackendOperation::GetMute:
+            return "getMute";
+        case BackendOperation::SetMute:
+            return "setMute";
+        case BackendOperation::GetVolume:
+            return "getVolume";
+        case BackendOperation::SetVolume:
+            return "setVolume";
+        case BackendOperation::GetFormFactor:
+            return "getFormFactor";
+        case BackendOperation::EnumerateDevicesByState:
+            return "enumerateDevicesByState";
+        case BackendOperation::GetDeviceDescription:
+            return "getDeviceDescription";
+        default:
+            return "unknown";
+        }
+    }
+
+    /**
+     * @brief Active-only fallback for backends that cannot see other states.
+     */
+    HRESULT IAudioBackend::enumerateDevicesByState(EDataFlow flow, DWORD stateMask, const DeviceStateVisitor &visit)
+    {
+        if (stateMask & ~static_cast<DWORD>(DEVICE_STATE_ACTIVE))
+            return E_NOTIMPL;
+        if (!(stateMask & DEVICE_STATE_ACTIVE))
+            return S_OK;
+        return enumerateDevices(flow, [&visit](const std::wstring &id, const std::wstring &name, IMMDevice *device)
+                                {
+                                    if (visit)
+                                        visit(id, name, DEVICE_STATE_ACTIVE, device); });
+    }
+
+    /**
+     * @brief Returns the installed backend, creating the platform default on first use.
+     *
+     * @return std::shared_ptr<IAudioBackend> Never null.
+     */
+    std::shared_ptr<IAudioBackend> GetAudioBackend()
+    {
+        std::lock_guard<std::mutex> lock(BackendMutex());
+        std::shared_ptr<IAudioBackend> &backend = CurrentBackend();
+        if (!backend)
+            backend = CreatePlatformBackend();
+        return backend;
+    }
+
+    /**
+     * @brief Swaps the installed backend.
+     *
+     * @param backend New backend (nullptr = platform default on next use).
+     * @return std::shared_ptr<IAudioBackend> Previous backend (may be null).
+     */
+    std::shared_ptr<IAudioBackend> SetAudioBackend(std::shared_ptr<IAudioBackend> backend)
+    {
+        std::lock_guard<std::mutex> lock(BackendMutex());
+        std::shared_ptr<IAudioBackend> previous = std::move(CurrentBackend());
+        CurrentBackend() = std::move(backend);
+        return previous;
+    }
+
+    /**
+     * @brief Creates the default backend of the platform.
+     */
+    std::shared_ptr<IAudioBackend> CreatePlatformBackend()
+    {
+#if defined(_WIN32)
+        return std::make_shared<WasapiBackend>();
+#else
+        return std::make_shared<SimulatedBackend>();
+#endif
+    }
+}
@@ -0,0 +1,562 @@
+#include "Backend/BackendTrace.h"
+#include "Utility/MappedFile.h"
+#include "Utility/StringConvert.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+namespace Backend
+{
+    namespace
+    {
+        constexpr uint8_t kMagic[4] = {'A', 'W', 'T', 'R'};
+        constexpr uint16_t kVersion = 2; ///< 2: enumerateDevicesByState records
+        constexpr uint16_t kHeaderSize = 16;
+
+        // Record tags: the low bits carry the operation / event
+        constexpr uint8_t kTagString = 0x01;
+        constexpr uint8_t kTagCall = 0x20;
+        constexpr uint8_t kTagEvent = 0x40;
+        constexpr uint8_t kTagMask = 0xe0;
+
+        int64_t SteadyNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        void PutVarint(std::vector<uint8_t> &out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        /// Signed values are zigzag-encoded so small negative deltas stay short.
+        void PutSigned(std::vector<uint8_t> &out, int64_t value)
+        {
+            PutVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+        }
+
+        void PutFloat(std::vector<uint8_t> &out, float value)
+        {
+            uint32_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(bits));
+            for (int i = 0; i < 4; ++i)
+                out.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+        }
+
+        void PutFixed(std::vector<uint8_t> &out, uint64_t value, size_t bytes)
+        {
+            for (size_t i = 0; i < bytes; ++i)
+                out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+
+        /**
+         * @brief Bounds-checked cursor over the encoded bytes.
+         */
+        struct Cursor
+        {
+            const uint8_t *p;
+            const uint8_t *end;
+
+            bool byte(uint8_t &value)
+            {
+                if (p >= end)
+                    return false;
+                value = *p++;
+                return true;
+            }
+
+            bool varint(uint64_t &value)
+            {
+                value = 0;
+                for (int shift = 0; shift < 64; shift += 7)
+                {
+                    uint8_t b = 0;
+                    if (!byte(b))
+                        return false;
+                    value |= static_cast<uint64_t>(b & 0x7f) << shift;
+                    if (!(b & 0x80))
+                        return true;
+                }
+                return false;
+            }
+
+            bool signedVarint(int64_t &value)
+            {
+                uint64_t raw = 0;
+                if (!varint(raw))
+                    return false;
+                value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+                return true;
+            }
+
+            bool floating(float &value)
+            {
+                if (end - p < 4)
+                    return false;
+                uint32_t bits = 0;
+                for (int i = 0; i < 4; ++i)
+                    bits |= static_cast<uint32_t>(p[i]) << (8 * i);
+                p += 4;
+                std::memcpy(&value, &bits, sizeof(value));
+                return true;
+            }
+
+            template <typename T>
+            bool small(T &value)
+            {
+                uint64_t raw = 0;
+                if (!varint(raw))
+                    return false;
+                value = static_cast<T>(raw);
+                return true;
+            }
+        };
+
+        bool GetString(Cursor &in, const std::vector<std::wstring> &strings, std::wstring &text)
+        {
+            uint64_t ref = 0;
+            if (!in.varint(ref) || ref > strings.size())
+                return false;
+            if (ref == 0)
+                text.clear();
+            else
+                text = strings[static_cast<size_t>(ref - 1)];
+            return true;
+        }
+
+        bool GetFlowRole(Cursor &in, TraceRecord &record)
+        {
+            uint8_t flow = 0, role = 0;
+            if (!in.byte(flow) || !in.byte(role) || flow > eAll || role > eCommunications)
+                return false;
+            record.flow = static_cast<EDataFlow>(flow);
+            record.role = static_cast<ERole>(role);
+            return true;
+        }
+    }
+
+    TraceWriter::TraceWriter()
+    {
+        clear();
+    }
+
+    int64_t TraceWriter::now() const
+    {
+        return SteadyNs() - m_startNs.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Encodes one record (and any string it introduces) at the end of the trace.
+     *
+     * @param record Call or event; fields not used by its operation are ignored.
+     */
+    void TraceWriter::append(const TraceRecord &record)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_scratch.clear();
+
+        if (record.isEvent)
+        {
+            m_scratch.push_back(static_cast<uint8_t>(kTagEvent | static_cast<uint8_t>(record.event)));
+            PutSigned(m_scratch, record.timestampNs - m_lastNs);
+            switch (record.event)
+            {
+            case TraceEventType::DeviceStateChanged:
+                writeString(record.deviceId);
+                PutVarint(m_scratch, record.state);
+                break;
+            case TraceEventType::DefaultDeviceChanged:
+                m_scratch.push_back(static_cast<uint8_t>(record.flow));
+                m_scratch.push_back(static_cast<uint8_t>(record.role));
+                writeString(record.deviceId);
+                break;
+            case TraceEventType::VolumeChanged:
+                writeString(record.deviceId);
+                PutFloat(m_scratch, record.volume);
+                m_scratch.push_back(record.muted ? 1 : 0);
+                break;
+            default:
+                writeString(record.deviceId);
+                break;
+            }
+        }
+        else
+        {
+            m_scratch.push_back(static_cast<uint8_t>(kTagCall | static_cast<uint8_t>(record.operation)));
+            PutSigned(m_scratch, record.timestampNs - m_lastNs);
+            PutVarint(m_scratch, record.durationNs);
+            PutVarint(m_scratch, static_cast<uint32_t>(record.result));
+            switch (record.operation)
+            {
+            case BackendOperation::EnumerateDevices:
+                m_scratch.push_back(static_cast<uint8_t>(record.flow));
+                PutVarint(m_scratch, record.devices.size());
+                for (const TraceDevice &device : record.devices)
+                {
+                    writeString(device.id);
+                    writeString(device.name);
+                }
+                break;
+            case BackendOperation::EnumerateDevicesByState:
+                m_scratch.push_back(static_cast<uint8_t>(record.flow));
+                PutVarint(m_scratch, record.state);
+                PutVarint(m_scratch, record.devices.size());
+                for (const TraceDevice &device : record.devices)
+                {
+                    writeString(device.id);
+                    writeString(device.name);
+                    PutVarint(m_scratch, device.state);
+                }
+                break;
+            case BackendOperation::GetDefaultDevice:
+                m_scratch.push_back(static_cast<uint8_t>(record.flow));
+                m_scratch.push_back(static_cast<uint8_t>(record.role));
+                writeString(record.deviceId);
+                break;
+            case BackendOperation::SetDefaultDevice:
+                writeString(record.deviceId);
+                PutVarint(m_scratch, record.roles);
+                break;
+            case BackendOperation::GetFriendlyName:
+            case BackendOperation::GetDeviceDescription:
+                writeString(record.deviceId);
+                writeString(record.name);
+                break;
+            case BackendOperation::GetDeviceState:
+                writeString(record.deviceId);
+                PutVarint(m_scratch, record.state);
+                break;
+            case BackendOperation::GetMixFormat:
+                writeString(record.deviceId);
+                PutVarint(m_scratch, record.format.sampleRate);
+                PutVarint(m_scratch, record.format.channels);
+                PutVarint(m_scratch, record.format.bitDepth);
+                PutVarint(m_scratch, record.format.blockAlign);
+                PutVarint(m_scratch, record.format.channelMask);
+                m_scratch.push_back(static_cast<uint8_t>((record.format.isFloat ? 1 : 0) | (record.format.valid ? 2 : 0)));
+                break;
+            case BackendOperation::GetMute:
+            case BackendOperation::SetMute:
+                writeString(record.deviceId);
+                m_scratch.push_back(record.muted ? 1 : 0);
+                break;
+            case BackendOperation::GetVolume:
+            case BackendOperation::SetVolume:
+                writeString(record.deviceId);
+                PutFloat(m_scratch, record.volume);
+                break;
+            case BackendOperation::GetFormFactor:
+                writeString(record.deviceId);
+                m_scratch.push_back(static_cast<uint8_t>(record.formFactor));
+                break;
+            default:
+                writeString(record.deviceId);
+                break;
+            }
+        }
+
+        m_data.insert(m_data.end(), m_scratch.begin(), m_scratch.end());
+        m_lastNs = record.timestampNs;
+        ++m_records;
+    }
+
+    size_t TraceWriter::recordCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_records;
+    }
+
+    size_t TraceWriter::byteSize() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_data.size();
+    }
+
+    std::vector<uint8_t> TraceWriter::bytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_data;
+    }
+
+    bool TraceWriter::save(const std::filesystem::path &path) const
+    {
+        const std::vector<uint8_t> data = bytes();
+
+        std::filesystem::path temp = path;
+        temp += ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out)
+                return false;
+            out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+            out.flush();
+            if (!out)
+                return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    void TraceWriter::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_startNs.store(SteadyNs(), std::memory_order_relaxed);
+        m_lastNs = 0;
+        m_records = 0;
+        m_strings.clear();
+        m_data.clear();
+        writeHeaderLocked();
+    }
+
+    /**
+     * @brief Writes a string reference into the current record, defining the string first if new.
+     */
+    void TraceWriter::writeString(const std::wstring &text)
+    {
+        if (text.empty())
+        {
+            m_scratch.push_back(0);
+            return;
+        }
+
+        auto it = m_strings.find(text);
+        if (it == m_strings.end())
+        {
+            const std::string utf8 = Utility::ToUtf8(text);
+            m_data.push_back(kTagString);
+            PutVarint(m_data, utf8.size());
+            m_data.insert(m_data.end(), utf8.begin(), utf8.end());
+            it = m_strings.emplace(text, static_cast<uint32_t>(m_strings.size())).first;
+        }
+        PutVarint(m_scratch, static_cast<uint64_t>(it->second) + 1);
+    }
+
+    void TraceWriter::writeHeaderLocked()
+    {
+        const int64_t startUnixNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        std::chrono::system_clock::now().time_since_epoch())
+                                        .count();
+        m_data.insert(m_data.end(), kMagic, kMagic + 4);
+        PutFixed(m_data, kVersion, 2);
+        PutFixed(m_data, kHeaderSize, 2);
+        PutFixed(m_data, static_cast<uint64_t>(startUnixNs), 8);
+    }
+
+    /**
+     * @brief Decodes a trace produced by TraceWriter.
+     *
+     * Unknown operations or events, string references past the table and
+     * truncated records stop decoding with false.
+     */
+    bool ParseTrace(const uint8_t *data, size_t size, std::vector<TraceRecord> &records, int64_t *startUnixNs)
+    {
+        records.clear();
+        if (!data || size < kHeaderSize || std::memcmp(data, kMagic, 4) != 0)
+            return false;
+
+        const uint16_t version = static_cast<uint16_t>(data[4] | (data[5] << 8));
+        const uint16_t headerSize = static_cast<uint16_t>(data[6] | (data[7] << 8));
+        if (version != kVersion || headerSize < kHeaderSize || headerSize > size)
+            return false;
+        if (startUnixNs)
+        {
+            uint64_t start = 0;
+            for (int i = 0; i < 8; ++i)
+                start |= static_cast<uint64_t>(data[8 + i]) << (8 * i);
+            *startUnixNs = static_cast<int64_t>(start);
+        }
+
+        Cursor in{data + headerSize, data + size};
+        std::vector<std::wstring> strings;
+        int64_t timestamp = 0;
+        while (in.p < in.end)
+        {
+            uint8_t tag = 0;
+            in.byte(tag);
+
+            if (tag == kTagString)
+            {
+                uint64_t length = 0;
+                if (!in.varint(length) || length > static_cast<uint64_t>(in.end - in.p))
+                    return false;
+                strings.push_back(Utility::FromUtf8(std::string(reinterpret_cast<const char *>(in.p), static_cast<size_t>(length))));
+                in.p += length;
+                continue;
+            }
+
+            TraceRecord record;
+            const uint8_t code = tag & static_cast<uint8_t>(~kTagMask);
+            int64_t delta = 0;
+            bool ok = true;
+
+            if ((tag & kTagMask) == kTagEvent && code < static_cast<uint8_t>(TraceEventType::Count))
+            {
+                record.isEvent = true;
+                record.event = static_cast<TraceEventType>(code);
+                ok = in.signedVarint(delta);
+                switch (record.event)
+                {
+                case TraceEventType::DeviceStateChanged:
+                    ok = ok && GetString(in, strings, record.deviceId) && in.small(record.state);
+                    break;
+                case TraceEventType::DefaultDeviceChanged:
+                    ok = ok && GetFlowRole(in, record) && GetString(in, strings, record.deviceId);
+                    break;
+                case TraceEventType::VolumeChanged:
+                {
+                    uint8_t muted = 0;
+                    ok = ok && GetString(in, strings, record.deviceId) && in.floating(record.volume) && in.byte(muted);
+                    record.muted = muted != 0;
+                    break;
+                }
+                default:
+                    ok = ok && GetString(in, strings, record.deviceId);
+                    break;
+                }
+            }
+            else if ((tag & kTagMask) == kTagCall && code < static_cast<uint8_t>(BackendOperation::Count))
+            {
+                record.operation = static_cast<BackendOperation>(code);
+                uint64_t result = 0;
+                ok = in.signedVarint(delta) && in.varint(record.durationNs) && in.varint(result);
+                record.result = static_cast<HRESULT>(static_cast<uint32_t>(result));
+                switch (record.operation)
+                {
+                case BackendOperation::EnumerateDevices:
+                {
+                    uint8_t flow = 0;
+                    uint64_t count = 0;
+                    ok = ok && in.byte(flow) && flow <= eAll && in.varint(count) &&
+                         count <= static_cast<uint64_t>(in.end - in.p); // At least a byte per device
+                    record.flow = static_cast<EDataFlow>(flow);
+                    for (uint64_t i = 0; ok && i < count; ++i)
+                    {
+                        TraceDevice device;
+                        ok = GetString(in, strings, device.id) && GetString(in, strings, device.name);
+                        record.devices.push_back(std::move(device));
+                    }
+                    break;
+                }
+                case BackendOperation::EnumerateDevicesByState:
+                {
+                    uint8_t flow = 0;
+                    uint64_t count = 0;
+                    ok = ok && in.byte(flow) && flow <= eAll && in.small(record.state) && in.varint(count) &&
+                         count <= static_cast<uint64_t>(in.end - in.p);
+                    record.flow = static_cast<EDataFlow>(flow);
+                    for (uint64_t i = 0; ok && i < count; ++i)
+                    {
+                        TraceDevice device;
+                        ok = GetString(in, strings, device.id) && GetString(in, strings, device.name) &&
+                             in.small(device.state);
+                        record.devices.push_back(std::move(device));
+                    }
+                    break;
+                }
+                case BackendOperation::GetDefaultDevice:
+                    ok = ok && GetFlowRole(in, record) && GetString(in, strings, record.deviceId);
+                    break;
+                case BackendOperation::SetDefaultDevice:
+                    ok = ok && GetString(in, strings, record.deviceId) && in.small(record.roles);
+                    break;
+                case BackendOperation::GetFriendlyName:
+                case BackendOperation::GetDeviceDescription:
+                    ok = ok && GetString(in, strings, record.deviceId) && GetString(in, strings, record.name);
+                    break;
+                case BackendOperation::GetDeviceState:
+                    ok = ok && GetString(in, strings, record.deviceId) && in.small(record.state);
+                    break;
+                case BackendOperation::GetMixFormat:
+                {
+                    uint8_t flags = 0;
+                    Utility::DeviceFormatInfo &format = record.format;
+                    ok = ok && GetString(in, strings, record.deviceId) && in.small(format.sampleRate) &&
+                         in.small(format.channels) && in.small(format.bitDepth) && in.small(format.blockAlign) &&
+                         in.small(format.channelMask) && in.byte(flags);
+                    format.isFloat = (flags & 1) != 0;
+                    format.valid = (flags & 2) != 0;
+                    break;
+                }
+                case BackendOperation::GetMute:
+                case BackendOperation::SetMute:
+                {
+                    uint8_t muted = 0;
+                    ok = ok && GetString(in, strings, record.deviceId) && in.byte(muted);
+                    record.muted = muted != 0;
+                    break;
+                }
+                case BackendOperation::GetVolume:
+                case BackendOperation::SetVolume:
+                    ok = ok && GetString(in, strings, record.deviceId) && in.floating(record.volume);
+                    break;
+                case BackendOperation::GetFormFactor:
+                {
+                    uint8_t formFactor = 0;
+                    ok = ok && GetString(in, strings, record.deviceId) && in.byte(formFactor) &&
+                         formFactor < EndpointFormFactor_enum_count;
+                    record.formFactor = static_cast<EndpointFormFactor>(formFactor);
+                    break;
+                }
+                default:
+                    ok = ok && GetString(in, strings, record.deviceId);
+                    break;
+                }
+            }
+            else
+            {
+                return false;
+            }
+
+            if (!ok)
+                return false;
+            timestamp += delta;
+            record.timestampNs = timestamp;
+            records.push_back(std::move(record));
+        }
+
+        return true;
+    }
+
+    bool ReadTrace(const std::filesystem::path &path, std::vector<TraceRecord> &records, int64_t *startUnixNs)
+    {
+        records.clear();
+        Utility::MappedFile file;
+        if (!file.open(path))
+            return false;
+        return ParseTrace(file.data(), static_cast<size_t>(file.size()), records, startUnixNs);
+    }
+
+    const char *EventName(TraceEventType event)
+    {
+        switch (event)
+        {
+        case TraceEventType::DeviceAdded:
+            return "deviceAdded";
+        case TraceEventType::DeviceRemoved:
+            return "deviceRemoved";
+        case TraceEventType::DeviceStateChanged:
+            return "deviceStateChanged";
+        case TraceEventType::DefaultDeviceChanged:
+            return "defaultDeviceChanged";
+        case TraceEventType::VolumeChanged:
+            return "volumeChanged";
+        default:
+            return "unknown";
+        }
+    }
+}
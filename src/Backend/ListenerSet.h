@@ -0,0 +1,69 @@
+#pragma once
+
+// Internal header: listener bookkeeping shared by the backends. Not part of the public API.
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include "Backend/AudioBackend.h"
+
+namespace Backend
+{
+    /**
+     * @brief Registered IDeviceListeners plus the lock that orders dispatch and removal.
+     *
+     * The mutex is recursive so a callback may call back into the backend (and
+     * trigger nested notifications) on the dispatching thread; remove() from another
+     * thread waits for a running dispatch to finish.
+     */
+    class ListenerSet
+    {
+    public:
+        HRESULT add(IDeviceListener *listener)
+        {
+            if (!listener)
+                return E_POINTER;
+
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            if (std::find(m_listeners.begin(), m_listeners.end(), listener) != m_listeners.end())
+                return S_FALSE;
+            m_listeners.push_back(listener);
+            return S_OK;
+        }
+
+        HRESULT remove(IDeviceListener *listener)
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            auto it = std::find(m_listeners.begin(), m_listeners.end(), listener);
+            if (it == m_listeners.end())
+                return E_NOTFOUND;
+            m_listeners.erase(it);
+            return S_OK;
+        }
+
+        bool empty() const
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            return m_listeners.empty();
+        }
+
+        /**
+         * @brief Calls `f(listener)` for every registered listener.
+         *
+         * Iterates in place (no copy, so dispatch does not allocate): listeners may
+         * not register or unregister from a callback, and the index loop stays in
+         * bounds even if one does.
+         */
+        template <typename F>
+        void notify(F &&f)
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            for (size_t i = 0; i < m_listeners.size(); ++i)
+                f(*m_listeners[i]);
+        }
+
+    private:
+        mutable std::recursive_mutex m_mutex;
+        std::vector<IDeviceListener *> m_listeners;
+    };
+}
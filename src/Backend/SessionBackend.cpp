@@ -0,0 +1,21 @@
+#include "Backend/SessionBackend.h"
+#include "Backend/SimulatedSessionBackend.h"
+
+#if defined(_WIN32)
+#include "WasapiSessionBackend.h"
+#endif
+
+namespace Backend
+{
+    /**
+     * @brief Creates the default session backend of the platform.
+     */
+    std::shared_ptr<ISessionBackend> CreatePlatformSessionBackend()
+    {
+#if defined(_WIN32)
+        return std::make_shared<WasapiSessionBackend>();
+#else
+        return std::make_shared<SimulatedSessionBackend>();
+#endif
+    }
+}
@@ -0,0 +1,1021 @@
+#include "Backend/SimulatedBackend.h"
+#include "ListenerSet.h"
+#include "Dsp/ChannelLayout.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cwchar>
+#include <thread>
+
+namespace Backend
+{
+    namespace
+    {
+        constexpr int64_t kSleepThresholdNs = 2000000; ///< Longer delays sleep most of the way, then spin
+        constexpr HRESULT kDeviceInvalidated = static_cast<HRESULT>(0x88890004u); ///< AUDCLNT_E_DEVICE_INVALIDATED
+        constexpr uint32_t kRenderRates[] = {44100, 48000, 48000, 96000};
+        constexpr uint32_t kCaptureRates[] = {16000, 44100, 48000, 48000};
+        constexpr const wchar_t *kRenderNames[] = {L"Speakers", L"Headphones", L"Digital Output", L"Monitor"};
+        constexpr const wchar_t *kCaptureNames[] = {L"Microphone", L"Headset Microphone", L"Line In", L"Stereo Mix"};
+
+        std::atomic<uint64_t> g_nextInstance{1};
+
+        /**
+         * @brief Waits for `ns` nanoseconds without giving up precision to the scheduler.
+         */
+        void SpinFor(int64_t ns)
+        {
+            if (ns <= 0)
+                return;
+
+            const auto end = std::chrono::steady_clock::now() + std::chrono::nanoseconds(ns);
+            if (ns > kSleepThresholdNs)
+                std::this_thread::sleep_for(std::chrono::nanoseconds(ns - kSleepThresholdNs / 2));
+            while (std::chrono::steady_clock::now() < end)
+            {
+            }
+        }
+
+        /**
+         * @brief Builds a "{0.0.F.00000000}.{xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}" endpoint ID.
+         */
+        std::wstring MakeEndpointId(EDataFlow flow, std::mt19937_64 &random)
+        {
+            const uint64_t a = random();
+            const uint64_t b = random();
+            wchar_t buffer[64];
+            std::swprintf(buffer, sizeof(buffer) / sizeof(buffer[0]),
+                          L"{0.0.%d.00000000}.{%08x-%04x-%04x-%04x-%012llx}",
+                          flow == eRender ? 0 : 1,
+                          static_cast<unsigned>(a >> 32), static_cast<unsigned>((a >> 16) & 0xffff),
+                          static_cast<unsigned>(a & 0xffff), static_cast<unsigned>(b >> 48),
+                          static_cast<unsigned long long>(b & 0xffffffffffffull));
+            return buffer;
+        }
+
+        Utility::DeviceFormatInfo MakeMixFormat(EDataFlow flow, std::mt19937_64 &random)
+        {
+            Utility::DeviceFormatInfo format;
+            const uint64_t pick = random();
+            format.sampleRate = flow == eRender ? kRenderRates[pick % 4] : kCaptureRates[pick % 4];
+            format.channels = flow == eRender ? ((pick >> 8) % 4 == 0 ? 6 : 2) : ((pick >> 8) % 2 == 0 ? 1 : 2);
+            format.bitDepth = 32;
+            format.isFloat = true;
+            format.blockAlign = static_cast<uint16_t>(format.channels * 4);
+            format.channelMask = Dsp::DefaultChannelMask(format.channels);
+            format.valid = true;
+            return format;
+        }
+
+        bool ValidFlowRole(EDataFlow flow, ERole role)
+        {
+            return (flow == eRender || flow == eCapture) && role >= eConsole && role <= eCommunications;
+        }
+    }
+
+    /**
+     * @brief Notification collected under the lock and delivered after it is released.
+     */
+    struct SimulatedBackend::Event
+    {
+        enum Type
+        {
+            Added,
+            Removed,
+            StateChanged,
+            DefaultChanged,
+            VolumeChanged
+        };
+
+        Type type;
+        std::wstring id;
+        EDataFlow flow = eRender;
+        ERole role = eConsole;
+        DWORD state = 0;
+        float volume = 0.0f;
+        bool muted = false;
+    };
+
+    /**
+     * @brief Reference-counted endpoint handle handed out as IMMDevice.
+     *
+     * Carries the ID, the owning backend's instance number and the shared state
+     * word; everything else lives in the backend, so a handle may safely outlive it.
+     */
+    class SimulatedBackend::Device : public IMMDevice
+    {
+    public:
+        Device(uint64_t instance, std::wstring id, std::shared_ptr<std::atomic<DWORD>> state)
+            : m_instance(instance), m_id(std::move(id)), m_state(std::move(state)) {}
+
+        uint64_t instance() const { return m_instance; }
+        const std::wstring &id() const { return m_id; }
+
+        ULONG STDMETHODCALLTYPE AddRef() override
+        {
+            return m_refs.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            const ULONG refs = m_refs.fetch_sub(1, std::memory_order_acq_rel) - 1;
+            if (refs == 0)
+                delete this;
+            return refs;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetId(LPWSTR *id) override
+        {
+            if (!id)
+                return E_POINTER;
+
+            const size_t bytes = (m_id.size() + 1) * sizeof(wchar_t);
+            *id = static_cast<LPWSTR>(CoTaskMemAlloc(bytes));
+            if (!*id)
+                return E_OUTOFMEMORY;
+            std::wmemcpy(*id, m_id.c_str(), m_id.size() + 1);
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetState(DWORD *state) override
+        {
+            if (!state)
+                return E_POINTER;
+            *state = m_state->load(std::memory_order_acquire);
+            return S_OK;
+        }
+
+#if defined(_WIN32)
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **object) override
+        {
+            if (!object)
+                return E_POINTER;
+            if (riid == __uuidof(IUnknown) || riid == __uuidof(IMMDevice))
+            {
+                *object = static_cast<IMMDevice *>(this);
+                AddRef();
+                return S_OK;
+            }
+            *object = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        HRESULT STDMETHODCALLTYPE Activate(REFIID, DWORD, PROPVARIANT *, void **object) override
+        {
+            if (object)
+                *object = nullptr;
+            return E_NOTIMPL;
+        }
+
+        HRESULT STDMETHODCALLTYPE OpenPropertyStore(DWORD, IPropertyStore **store) override
+        {
+            if (store)
+                *store = nullptr;
+            return E_NOTIMPL;
+        }
+#endif
+
+    protected:
+        ~Device() = default;
+
+    private:
+        std::atomic<ULONG> m_refs{1};
+        uint64_t m_instance;
+        std::wstring m_id;
+        std::shared_ptr<std::atomic<DWORD>> m_state;
+    };
+
+    /**
+     * @brief Creates the endpoints described by the config.
+     *
+     * @param config Device counts, latencies and seed.
+     */
+    SimulatedBackend::SimulatedBackend(const SimulatedBackendConfig &config)
+        : m_config(config),
+          m_instance(g_nextInstance.fetch_add(1, std::memory_order_relaxed)),
+          m_random(config.seed),
+          m_listeners(new ListenerSet())
+    {
+        clearOperationLatencies();
+        for (uint32_t i = 0; i < config.renderDevices; ++i)
+            addLocked(eRender, std::wstring(), Utility::DeviceFormatInfo());
+        for (uint32_t i = 0; i < config.captureDevices; ++i)
+            addLocked(eCapture, std::wstring(), Utility::DeviceFormatInfo());
+    }
+
+    /**
+     * @brief Drops the backend's reference on every device handle.
+     */
+    SimulatedBackend::~SimulatedBackend()
+    {
+        for (Endpoint &endpoint : m_endpoints)
+            endpoint.handle->Release();
+    }
+
+    /**
+     * @brief Visits the active endpoints of a flow (eAll visits both).
+     */
+    HRESULT SimulatedBackend::enumerateDevices(EDataFlow flow, const DeviceVisitor &visit)
+    {
+        return enumerate(BackendOperation::EnumerateDevices, flow, DEVICE_STATE_ACTIVE,
+                         [&visit](const std::wstring &id, const std::wstring &name, DWORD, IMMDevice *device)
+                         {
+                             if (visit)
+                                 visit(id, name, device); });
+    }
+
+    /**
+     * @brief Visits the endpoints of a flow whose state is in `stateMask` (eAll visits both).
+     *
+     * Costs `enumerateUs` once plus `propertyUs` per endpoint, like opening each
+     * property store in Core Audio. Removed endpoints stay visible as
+     * DEVICE_STATE_NOTPRESENT. The visitor runs without the lock held.
+     *
+     * @param flow eRender, eCapture or eAll.
+     * @param stateMask DEVICE_STATE_* bits.
+     * @param visit Called per endpoint.
+     * @return HRESULT S_OK or an injected failure.
+     */
+    HRESULT SimulatedBackend::enumerateDevicesByState(EDataFlow flow, DWORD stateMask, const DeviceStateVisitor &visit)
+    {
+        return enumerate(BackendOperation::EnumerateDevicesByState, flow, stateMask, visit);
+    }
+
+    /**
+     * @brief Shared body of both enumerations; `operation` selects the latency, failures and call count.
+     */
+    HRESULT SimulatedBackend::enumerate(BackendOperation operation, EDataFlow flow, DWORD stateMask,
+                                        const DeviceStateVisitor &visit)
+    {
+        const HRESULT injected = begin(operation);
+        if (FAILED(injected))
+            return injected;
+
+        struct Visit
+        {
+            std::wstring id;
+            std::wstring name;
+            DWORD state;
+            Device *handle;
+        };
+        std::vector<Visit> visits;
+        int64_t propertyNs = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_latencyOverrides[static_cast<size_t>(operation)] < 0)
+                propertyNs = static_cast<int64_t>(m_config.latency.propertyUs) * 1000;
+            visits.reserve(m_endpoints.size());
+            for (const Endpoint &endpoint : m_endpoints)
+            {
+                const DWORD state = endpoint.state->load(std::memory_order_relaxed);
+                if ((flow != eAll && endpoint.flow != flow) || !(state & stateMask))
+                    continue;
+                endpoint.handle->AddRef();
+                visits.push_back({endpoint.id, endpoint.name, state, endpoint.handle});
+            }
+        }
+
+        for (Visit &v : visits)
+        {
+            SpinFor(propertyNs);
+            if (visit)
+                visit(v.id, v.name, v.state, v.handle);
+            v.handle->Release();
+        }
+
+        return S_OK;
+    }
+
+    /**
+     * @brief Looks up an endpoint by ID, including inactive and removed ones.
+     *
+     * @return HRESULT S_OK, E_POINTER, E_NOTFOUND or an injected failure.
+     */
+    HRESULT SimulatedBackend::getDevice(const std::wstring &deviceId, IMMDevice **device)
+    {
+        if (!device)
+            return E_POINTER;
+        *device = nullptr;
+
+        const HRESULT injected = begin(BackendOperation::GetDevice);
+        if (FAILED(injected))
+            return injected;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(deviceId);
+        if (index < 0)
+            return E_NOTFOUND;
+
+        Device *handle = m_endpoints[static_cast<size_t>(index)].handle;
+        handle->AddRef();
+        *device = handle;
+        return S_OK;
+    }
+
+    /**
+     * @brief Returns the default endpoint of a flow and role (AddRef'd).
+     *
+     * @return HRESULT S_OK, E_POINTER, E_INVALIDARG, E_NOTFOUND when the flow has no
+     *         active device, or an injected failure.
+     */
+    HRESULT SimulatedBackend::getDefaultDevice(EDataFlow flow, ERole role, IMMDevice **device)
+    {
+        if (!device)
+            return E_POINTER;
+        *device = nullptr;
+        if (!ValidFlowRole(flow, role))
+            return E_INVALIDARG;
+
+        const HRESULT injected = begin(BackendOperation::GetDefaultDevice);
+        if (FAILED(injected))
+            return injected;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = m_defaults[flow][role];
+        if (index < 0)
+            return E_NOTFOUND;
+
+        Device *handle = m_endpoints[static_cast<size_t>(index)].handle;
+        handle->AddRef();
+        *device = handle;
+        return S_OK;
+    }
+
+    /**
+     * @brief Makes an active endpoint the default of its flow for the given roles.
+     *
+     * Notifies onDefaultDeviceChanged for every role whose default actually changed.
+     *
+     * @param deviceId Endpoint ID.
+     * @param roles RoleMask bits.
+     * @return HRESULT S_OK, E_NOTFOUND for an unknown ID, E_INVALIDARG for an inactive
+     *         endpoint, or an injected failure.
+     */
+    HRESULT SimulatedBackend::setDefaultDevice(const std::wstring &deviceId, uint32_t roles)
+    {
+        uint32_t roleCount = 0;
+        for (int role = 0; role < 3; ++role)
+            roleCount += (roles >> role) & 1u;
+
+        const HRESULT injected = begin(BackendOperation::SetDefaultDevice, roleCount);
+        if (FAILED(injected))
+            return injected;
+
+        std::vector<Event> events;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const int index = findLocked(deviceId);
+            if (index < 0)
+                return E_NOTFOUND;
+
+            const Endpoint &endpoint = m_endpoints[static_cast<size_t>(index)];
+            if (endpoint.state->load(std::memory_order_relaxed) != DEVICE_STATE_ACTIVE)
+                return E_INVALIDARG;
+
+            for (int role = 0; role < 3; ++role)
+            {
+                if (!(roles & (1u << role)) || m_defaults[endpoint.flow][role] == index)
+                    continue;
+                m_defaults[endpoint.flow][role] = index;
+                Event event{Event::DefaultChanged, endpoint.id};
+                event.flow = endpoint.flow;
+                event.role = static_cast<ERole>(role);
+                events.push_back(std::move(event));
+            }
+        }
+
+        dispatch(events);
+        return S_OK;
+    }
+
+    /**
+     * @brief Reads the friendly name of a device handed out by this backend.
+     *
+     * @return HRESULT S_OK, E_INVALIDARG for foreign devices, or an injected failure.
+     */
+    HRESULT SimulatedBackend::getFriendlyName(IMMDevice *device, std::wstring &name)
+    {
+        const HRESULT injected = begin(BackendOperation::GetFriendlyName);
+        if (FAILED(injected))
+            return injected;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(device);
+        if (index < 0)
+            return E_INVALIDARG;
+        name = m_endpoints[static_cast<size_t>(index)].name;
+        return S_OK;
+    }
+
+    /**
+     * @brief Reads the description of a device handed out by this backend.
+     *
+     * @return HRESULT S_OK, E_INVALIDARG for foreign devices, or an injected failure.
+     */
+    HRESULT SimulatedBackend::getDeviceDescription(IMMDevice *device, std::wstring &description)
+    {
+        const HRESULT injected = begin(BackendOperation::GetDeviceDescription);
+        if (FAILED(injected))
+            return injected;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(device);
+        if (index < 0)
+            return E_INVALIDARG;
+        description = m_endpoints[static_cast<size_t>(index)].description;
+        return S_OK;
+    }
+
+    /**
+     * @brief Form factor given to addDevice() or setFormFactor() (UnknownFormFactor by default).
+     *
+     * @return HRESULT S_OK, E_INVALIDARG for foreign devices, or an injected failure.
+     */
+    HRESULT SimulatedBackend::getFormFactor(IMMDevice *device, EndpointFormFactor &formFactor)
+    {
+        const HRESULT injected = begin(BackendOperation::GetFormFactor);
+        if (FAILED(injected))
+            return injected;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(device);
+        if (index < 0)
+            return E_INVALIDARG;
+        formFactor = m_endpoints[static_cast<size_t>(index)].formFactor;
+        return S_OK;
+    }
+
+    /**
+     * @brief Reads the DEVICE_STATE_* of a device.
+     */
+    HRESULT SimulatedBackend::getDeviceState(IMMDevice *device, DWORD &state)
+    {
+        const HRESULT injected = begin(BackendOperation::GetDeviceState);
+        if (FAILED(injected))
+            return injected;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(device);
+        if (index < 0)
+            return E_INVALIDARG;
+        state = m_endpoints[static_cast<size_t>(index)].state->load(std::memory_order_relaxed);
+        return S_OK;
+    }
+
+    /**
+     * @brief Returns the shared-mode mix format of an active device.
+     *
+     * @return HRESULT S_OK, E_INVALIDARG for foreign devices, AUDCLNT_E_DEVICE_INVALIDATED
+     *         for inactive ones, or an injected failure.
+     */
+    HRESULT SimulatedBackend::getMixFormat(IMMDevice *device, Utility::DeviceFormatInfo &format)
+    {
+        const HRESULT injected = begin(BackendOperation::GetMixFormat);
+        if (FAILED(injected))
+            return injected;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(device);
+        if (index < 0)
+            return E_INVALIDARG;
+        const Endpoint &endpoint = m_endpoints[static_cast<size_t>(index)];
+        if (endpoint.state->load(std::memory_order_relaxed) != DEVICE_STATE_ACTIVE)
+            return kDeviceInvalidated;
+        format = endpoint.format;
+        return S_OK;
+    }
+
+    HRESULT SimulatedBackend::getMute(IMMDevice *device, bool &mute)
+    {
+        const HRESULT injected = begin(BackendOperation::GetMute);
+        if (FAILED(injected))
+            return injected;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(device);
+        if (index < 0)
+            return E_INVALIDARG;
+        const Endpoint &endpoint = m_endpoints[static_cast<size_t>(index)];
+        if (endpoint.state->load(std::memory_order_relaxed) != DEVICE_STATE_ACTIVE)
+            return kDeviceInvalidated;
+        mute = endpoint.muted;
+        return S_OK;
+    }
+
+    /**
+     * @brief Sets the mute state of an active device; notifies onVolumeChanged on change.
+     */
+    HRESULT SimulatedBackend::setMute(IMMDevice *device, bool mute)
+    {
+        const HRESULT injected = begin(BackendOperation::SetMute);
+        if (FAILED(injected))
+            return injected;
+
+        std::vector<Event> events;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const int index = findLocked(device);
+            if (index < 0)
+                return E_INVALIDARG;
+            Endpoint &endpoint = m_endpoints[static_cast<size_t>(index)];
+            if (endpoint.state->load(std::memory_order_relaxed) != DEVICE_STATE_ACTIVE)
+                return kDeviceInvalidated;
+            if (endpoint.muted != mute)
+            {
+                endpoint.muted = mute;
+                Event event{Event::VolumeChanged, endpoint.id};
+                event.volume = endpoint.volume;
+                event.muted = mute;
+                events.push_back(std::move(event));
+            }
+        }
+
+        dispatch(events);
+        return S_OK;
+    }
+
+    HRESULT SimulatedBackend::getVolume(IMMDevice *device, float &volume)
+    {
+        const HRESULT injected = begin(BackendOperation::GetVolume);
+        if (FAILED(injected))
+            return injected;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(device);
+        if (index < 0)
+            return E_INVALIDARG;
+        const Endpoint &endpoint = m_endpoints[static_cast<size_t>(index)];
+        if (endpoint.state->load(std::memory_order_relaxed) != DEVICE_STATE_ACTIVE)
+            return kDeviceInvalidated;
+        volume = endpoint.volume;
+        return S_OK;
+    }
+
+    /**
+     * @brief Sets the master volume scalar of an active device; notifies onVolumeChanged on change.
+     *
+     * @return HRESULT S_OK, E_INVALIDARG for foreign devices or a volume outside 0..1,
+     *         AUDCLNT_E_DEVICE_INVALIDATED for inactive devices, or an injected failure.
+     */
+    HRESULT SimulatedBackend::setVolume(IMMDevice *device, float volume)
+    {
+        if (!(volume >= 0.0f && volume <= 1.0f))
+            return E_INVALIDARG;
+
+        const HRESULT injected = begin(BackendOperation::SetVolume);
+        if (FAILED(injected))
+            return injected;
+
+        std::vector<Event> events;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const int index = findLocked(device);
+            if (index < 0)
+                return E_INVALIDARG;
+            Endpoint &endpoint = m_endpoints[static_cast<size_t>(index)];
+            if (endpoint.state->load(std::memory_order_relaxed) != DEVICE_STATE_ACTIVE)
+                return kDeviceInvalidated;
+            if (endpoint.volume != volume)
+            {
+                endpoint.volume = volume;
+                Event event{Event::VolumeChanged, endpoint.id};
+                event.volume = volume;
+                event.muted = endpoint.muted;
+                events.push_back(std::move(event));
+            }
+        }
+
+        dispatch(events);
+        return S_OK;
+    }
+
+    HRESULT SimulatedBackend::registerListener(IDeviceListener *listener)
+    {
+        return m_listeners->add(listener);
+    }
+
+    HRESULT SimulatedBackend::unregisterListener(IDeviceListener *listener)
+    {
+        return m_listeners->remove(listener);
+    }
+
+    void SimulatedBackend::setLatency(const SimulatedLatency &latency)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_config.latency = latency;
+    }
+
+    void SimulatedBackend::setFailure(BackendOperation operation, const SimulatedFailure &failure)
+    {
+        if (operation >= BackendOperation::Count)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failures[static_cast<size_t>(operation)] = failure;
+    }
+
+    void SimulatedBackend::clearFailures()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (SimulatedFailure &failure : m_failures)
+            failure = SimulatedFailure();
+    }
+
+    void SimulatedBackend::setOperationLatency(BackendOperation operation, int64_t ns)
+    {
+        if (operation >= BackendOperation::Count)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latencyOverrides[static_cast<size_t>(operation)] = ns < 0 ? -1 : ns;
+    }
+
+    void SimulatedBackend::clearOperationLatencies()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int64_t &ns : m_latencyOverrides)
+            ns = -1;
+    }
+
+    /**
+     * @brief Creates an active endpoint and notifies onDeviceAdded (and default changes).
+     */
+    std::wstring SimulatedBackend::addDevice(EDataFlow flow, const std::wstring &name, const Utility::DeviceFormatInfo &format,
+                                             const std::wstring &deviceId, EndpointFormFactor formFactor)
+    {
+        if (flow != eRender && flow != eCapture)
+            return std::wstring();
+
+        std::vector<Event> events;
+        std::wstring id;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!deviceId.empty() && findLocked(deviceId) >= 0)
+                return std::wstring();
+            const int index = addLocked(flow, name, format, deviceId);
+            m_endpoints[static_cast<size_t>(index)].formFactor = formFactor;
+            id = m_endpoints[static_cast<size_t>(index)].id;
+            events.push_back(Event{Event::Added, id});
+            for (int role = 0; role < 3; ++role)
+            {
+                if (m_defaults[flow][role] == index)
+                {
+                    Event event{Event::DefaultChanged, id};
+                    event.flow = flow;
+                    event.role = static_cast<ERole>(role);
+                    events.push_back(std::move(event));
+                }
+            }
+        }
+
+        dispatch(events);
+        return id;
+    }
+
+    /**
+     * @brief Marks an endpoint not present and notifies onDeviceRemoved (and default changes).
+     */
+    bool SimulatedBackend::removeDevice(const std::wstring &deviceId)
+    {
+        std::vector<Event> events;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const int index = findLocked(deviceId);
+            if (index < 0)
+                return false;
+            Endpoint &endpoint = m_endpoints[static_cast<size_t>(index)];
+            if (endpoint.state->load(std::memory_order_relaxed) == DEVICE_STATE_NOTPRESENT)
+                return false;
+
+            endpoint.state->store(DEVICE_STATE_NOTPRESENT, std::memory_order_release);
+            events.push_back(Event{Event::Removed, deviceId});
+            reassignDefaultsLocked(index, events);
+        }
+
+        dispatch(events);
+        return true;
+    }
+
+    /**
+     * @brief Changes an endpoint's state and notifies onDeviceStateChanged (and default changes).
+     */
+    bool SimulatedBackend::setDeviceState(const std::wstring &deviceId, DWORD state)
+    {
+        if (state != DEVICE_STATE_ACTIVE && state != DEVICE_STATE_DISABLED &&
+            state != DEVICE_STATE_NOTPRESENT && state != DEVICE_STATE_UNPLUGGED)
+            return false;
+
+        std::vector<Event> events;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const int index = findLocked(deviceId);
+            if (index < 0)
+                return false;
+            Endpoint &endpoint = m_endpoints[static_cast<size_t>(index)];
+            if (endpoint.state->load(std::memory_order_relaxed) == state)
+                return true;
+
+            endpoint.state->store(state, std::memory_order_release);
+            Event event{Event::StateChanged, deviceId};
+            event.state = state;
+            events.push_back(std::move(event));
+            reassignDefaultsLocked(index, events);
+        }
+
+        dispatch(events);
+        return true;
+    }
+
+    bool SimulatedBackend::setFormFactor(const std::wstring &deviceId, EndpointFormFactor formFactor)
+    {
+        if (static_cast<unsigned>(formFactor) >= EndpointFormFactor_enum_count)
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(deviceId);
+        if (index < 0)
+            return false;
+        m_endpoints[static_cast<size_t>(index)].formFactor = formFactor;
+        return true;
+    }
+
+    bool SimulatedBackend::setDescription(const std::wstring &deviceId, const std::wstring &description)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(deviceId);
+        if (index < 0)
+            return false;
+        m_endpoints[static_cast<size_t>(index)].description = description;
+        return true;
+    }
+
+    SimulatedBackendConfig SimulatedBackend::config() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_config;
+    }
+
+    std::vector<std::wstring> SimulatedBackend::deviceIds(EDataFlow flow) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<std::wstring> ids;
+        for (const Endpoint &endpoint : m_endpoints)
+            if ((flow == eAll || endpoint.flow == flow) &&
+                endpoint.state->load(std::memory_order_relaxed) != DEVICE_STATE_NOTPRESENT)
+                ids.push_back(endpoint.id);
+        return ids;
+    }
+
+    std::wstring SimulatedBackend::defaultDeviceId(EDataFlow flow, ERole role) const
+    {
+        if (!ValidFlowRole(flow, role))
+            return std::wstring();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = m_defaults[flow][role];
+        return index < 0 ? std::wstring() : m_endpoints[static_cast<size_t>(index)].id;
+    }
+
+    bool SimulatedBackend::isMuted(const std::wstring &deviceId) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(deviceId);
+        return index >= 0 && m_endpoints[static_cast<size_t>(index)].muted;
+    }
+
+    float SimulatedBackend::volume(const std::wstring &deviceId) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(deviceId);
+        return index < 0 ? 0.0f : m_endpoints[static_cast<size_t>(index)].volume;
+    }
+
+    DWORD SimulatedBackend::deviceState(const std::wstring &deviceId) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(deviceId);
+        return index < 0 ? 0 : m_endpoints[static_cast<size_t>(index)].state->load(std::memory_order_relaxed);
+    }
+
+    uint64_t SimulatedBackend::callCount() const
+    {
+        uint64_t total = 0;
+        for (const std::atomic<uint64_t> &calls : m_calls)
+            total += calls.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    uint64_t SimulatedBackend::callCount(BackendOperation operation) const
+    {
+        if (operation >= BackendOperation::Count)
+            return 0;
+        return m_calls[static_cast<size_t>(operation)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Common prologue of every operation: count, wait, draw an injected failure.
+     *
+     * @param operation Operation being served.
+     * @param repeats Latency multiplier (roles in setDefaultDevice()).
+     * @return HRESULT The injected failure, or S_OK.
+     */
+    HRESULT SimulatedBackend::begin(BackendOperation operation, uint32_t repeats)
+    {
+        m_calls[static_cast<size_t>(operation)].fetch_add(1, std::memory_order_relaxed);
+
+        int64_t ns = 0;
+        HRESULT result = S_OK;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ns = latencyLocked(operation, repeats);
+
+            SimulatedFailure &failure = m_failures[static_cast<size_t>(operation)];
+            if (failure.failNext > 0)
+            {
+                --failure.failNext;
+                result = failure.result;
+            }
+            else if (failure.probability > 0.0 &&
+                     std::uniform_real_distribution<double>(0.0, 1.0)(m_random) < failure.probability)
+            {
+                result = failure.result;
+            }
+        }
+
+        SpinFor(ns);
+        if (FAILED(result))
+            m_injected.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    /**
+     * @brief Delay of one call in nanoseconds: the override if set, else the configured latency.
+     */
+    int64_t SimulatedBackend::latencyLocked(BackendOperation operation, uint32_t repeats) const
+    {
+        const int64_t overrideNs = m_latencyOverrides[static_cast<size_t>(operation)];
+        if (overrideNs >= 0)
+            return overrideNs;
+
+        const SimulatedLatency &latency = m_config.latency;
+        uint32_t us = 0;
+        switch (operation)
+        {
+        case BackendOperation::EnumerateDevices:
+        case BackendOperation::EnumerateDevicesByState:
+            us = latency.enumerateUs;
+            break;
+        case BackendOperation::GetDevice:
+        case BackendOperation::GetDefaultDevice:
+            us = latency.defaultUs;
+            break;
+        case BackendOperation::SetDefaultDevice:
+            us = latency.setDefaultUs;
+            break;
+        case BackendOperation::GetFriendlyName:
+        case BackendOperation::GetDeviceState:
+        case BackendOperation::GetFormFactor:
+        case BackendOperation::GetDeviceDescription:
+            us = latency.propertyUs;
+            break;
+        case BackendOperation::GetMixFormat:
+            us = latency.formatUs;
+            break;
+        case BackendOperation::GetMute:
+        case BackendOperation::SetMute:
+        case BackendOperation::GetVolume:
+        case BackendOperation::SetVolume:
+            us = latency.volumeUs;
+            break;
+        default:
+            break;
+        }
+        return static_cast<int64_t>(us) * repeats * 1000;
+    }
+
+    /**
+     * @brief Maps a handle back to its endpoint; foreign or unrelated devices give -1.
+     */
+    int SimulatedBackend::findLocked(IMMDevice *device) const
+    {
+        const Device *handle = dynamic_cast<const Device *>(device);
+        if (!handle || handle->instance() != m_instance)
+            return -1;
+        return findLocked(handle->id());
+    }
+
+    int SimulatedBackend::findLocked(const std::wstring &deviceId) const
+    {
+        for (size_t i = 0; i < m_endpoints.size(); ++i)
+            if (m_endpoints[i].id == deviceId)
+                return static_cast<int>(i);
+        return -1;
+    }
+
+    /**
+     * @brief Appends an active endpoint; it takes every role of a flow without a default.
+     *
+     * @return int Index of the new endpoint.
+     */
+    int SimulatedBackend::addLocked(EDataFlow flow, const std::wstring &name, const Utility::DeviceFormatInfo &format,
+                                    const std::wstring &deviceId)
+    {
+        const int f = flow == eRender ? 0 : 1;
+        const uint32_t ordinal = m_added[f]++;
+
+        Endpoint endpoint;
+        endpoint.flow = flow;
+        endpoint.id = deviceId.empty() ? MakeEndpointId(flow, m_random) : deviceId;
+        endpoint.name = name;
+        if (endpoint.name.empty())
+        {
+            const wchar_t *const *names = flow == eRender ? kRenderNames : kCaptureNames;
+            endpoint.name = std::wstring(names[ordinal % 4]) + L" (Simulated Audio " + std::to_wstring(ordinal + 1) + L")";
+        }
+        endpoint.description = endpoint.name.substr(0, endpoint.name.find(L" ("));
+        endpoint.format = format.valid ? format : MakeMixFormat(flow, m_random);
+        endpoint.state = std::make_shared<std::atomic<DWORD>>(DEVICE_STATE_ACTIVE);
+        endpoint.handle = new Device(m_instance, endpoint.id, endpoint.state);
+        m_endpoints.push_back(std::move(endpoint));
+
+        const int index = static_cast<int>(m_endpoints.size() - 1);
+        for (int role = 0; role < 3; ++role)
+            if (m_defaults[f][role] < 0)
+                m_defaults[f][role] = index;
+        return index;
+    }
+
+    /**
+     * @brief Keeps the defaults of an endpoint's flow pointing at active endpoints.
+     *
+     * An inactive default is replaced by the first active endpoint of the flow (or
+     * none); a flow without default adopts the endpoint if it just became active.
+     */
+    void SimulatedBackend::reassignDefaultsLocked(int index, std::vector<Event> &events)
+    {
+        const Endpoint &changed = m_endpoints[static_cast<size_t>(index)];
+        const EDataFlow flow = changed.flow;
+        const bool active = changed.state->load(std::memory_order_relaxed) == DEVICE_STATE_ACTIVE;
+
+        int replacement = -1;
+        for (size_t i = 0; i < m_endpoints.size(); ++i)
+        {
+            if (m_endpoints[i].flow == flow && m_endpoints[i].state->load(std::memory_order_relaxed) == DEVICE_STATE_ACTIVE)
+            {
+                replacement = static_cast<int>(i);
+                break;
+            }
+        }
+
+        for (int role = 0; role < 3; ++role)
+        {
+            int &current = m_defaults[flow][role];
+            int next = current;
+            if (!active && current == index)
+                next = replacement;
+            else if (active && current < 0)
+                next = index;
+            if (next == current)
+                continue;
+
+            current = next;
+            Event event{Event::DefaultChanged, next < 0 ? std::wstring() : m_endpoints[static_cast<size_t>(next)].id};
+            event.flow = flow;
+            event.role = static_cast<ERole>(role);
+            events.push_back(std::move(event));
+        }
+    }
+
+    /**
+     * @brief Delivers collected events to the listeners (lock not held).
+     */
+    void SimulatedBackend::dispatch(const std::vector<Event> &events)
+    {
+        if (events.empty())
+            return;
+
+        m_listeners->notify([&events](IDeviceListener &listener)
+                            {
+            for (const Event &event : events)
+            {
+                switch (event.type)
+                {
+                case Event::Added:
+                    listener.onDeviceAdded(event.id);
+                    break;
+                case Event::Removed:
+                    listener.onDeviceRemoved(event.id);
+                    break;
+                case Event::StateChanged:
+                    listener.onDeviceStateChanged(event.id, event.state);
+                    break;
+                case Event::DefaultChanged:
+                    listener.onDefaultDeviceChanged(event.flow, event.role, event.id);
+                    break;
+                case Event::VolumeChanged:
+                    listener.onVolumeChanged(event.id, event.volume, event.muted);
+                    break;
+                }
+            } });
+    }
+}
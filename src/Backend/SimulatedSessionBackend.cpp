@@ -0,0 +1,310 @@
+#include "Backend/SimulatedSessionBackend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cwchar>
+#include <thread>
+
+namespace Backend
+{
+    namespace
+    {
+        constexpr HRESULT kSessionExpired = static_cast<HRESULT>(0x88890004u); ///< AUDCLNT_E_DEVICE_INVALIDATED
+
+        /**
+         * @brief Busy-waits `us` microseconds (simulated call cost).
+         */
+        void SpinForUs(uint64_t us)
+        {
+            if (us == 0)
+                return;
+            const auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+            while (std::chrono::steady_clock::now() < end)
+            {
+            }
+        }
+    }
+
+    /**
+     * @brief ISimpleAudioVolume stand-in: forwards to the backend by session index.
+     */
+    class SimulatedSessionBackend::Volume : public ISessionVolume
+    {
+    public:
+        Volume(SimulatedSessionBackend *owner, size_t index) : m_owner(owner), m_index(index) {}
+
+        HRESULT getVolume(float &volume) override
+        {
+            bool muted = false;
+            return m_owner->getVolume(m_index, volume, muted);
+        }
+
+        HRESULT setVolume(float volume) override
+        {
+            if (volume < 0.0f || volume > 1.0f)
+                return E_INVALIDARG;
+            return m_owner->setVolume(m_index, &volume, nullptr);
+        }
+
+        HRESULT getMute(bool &mute) override
+        {
+            float volume = 0.0f;
+            return m_owner->getVolume(m_index, volume, mute);
+        }
+
+        HRESULT setMute(bool mute) override
+        {
+            return m_owner->setVolume(m_index, nullptr, &mute);
+        }
+
+    private:
+        SimulatedSessionBackend *m_owner;
+        size_t m_index;
+    };
+
+    SimulatedSessionBackend::SimulatedSessionBackend(const SimulatedSessionLatency &latency) : m_latency(latency) {}
+
+    SimulatedSessionBackend::~SimulatedSessionBackend() = default;
+
+    HRESULT SimulatedSessionBackend::enumerateSessions(const std::wstring &deviceId, const SessionVisitor &visit)
+    {
+        m_enumerations.fetch_add(1, std::memory_order_relaxed);
+
+        // Copy under the lock, visit outside it: a visitor may call back into the backend
+        std::vector<std::pair<SessionInfo, std::shared_ptr<ISessionVolume>>> sessions;
+        SimulatedSessionLatency latency;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            latency = m_latency;
+            for (const Session &session : m_sessions)
+                if (session.info.deviceId == deviceId && session.info.state != SessionState::Expired)
+                    sessions.emplace_back(session.info, session.volume);
+        }
+
+        SpinForUs(latency.enumerateUs + static_cast<uint64_t>(latency.sessionUs) * sessions.size());
+        for (const auto &session : sessions)
+            visit(session.first, session.second);
+        return S_OK;
+    }
+
+    HRESULT SimulatedSessionBackend::registerListener(const std::wstring &deviceId, ISessionListener *listener)
+    {
+        if (!listener)
+            return E_POINTER;
+
+        std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+        std::vector<ISessionListener *> &listeners = m_listeners[deviceId];
+        if (std::find(listeners.begin(), listeners.end(), listener) != listeners.end())
+            return S_FALSE;
+        listeners.push_back(listener);
+        return S_OK;
+    }
+
+    HRESULT SimulatedSessionBackend::unregisterListener(const std::wstring &deviceId, ISessionListener *listener)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+        auto device = m_listeners.find(deviceId);
+        if (device == m_listeners.end())
+            return E_NOTFOUND;
+        auto it = std::find(device->second.begin(), device->second.end(), listener);
+        if (it == device->second.end())
+            return E_NOTFOUND;
+        device->second.erase(it);
+        if (device->second.empty())
+            m_listeners.erase(device);
+        return S_OK;
+    }
+
+    void SimulatedSessionBackend::setLatency(const SimulatedSessionLatency &latency)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latency = latency;
+    }
+
+    std::wstring SimulatedSessionBackend::addSession(const std::wstring &deviceId, DWORD processId,
+                                                     const std::wstring &executable, const std::wstring &displayName,
+                                                     SessionState state)
+    {
+        SessionInfo info;
+        std::shared_ptr<ISessionVolume> volume;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            wchar_t suffix[32];
+            std::swprintf(suffix, sizeof(suffix) / sizeof(suffix[0]), L"%%b{%llu}", static_cast<unsigned long long>(++m_created));
+
+            Session session;
+            session.info.deviceId = deviceId;
+            session.info.instanceId = deviceId + L"|" + executable + suffix;
+            session.info.processId = processId;
+            session.info.executable = executable;
+            session.info.displayName = displayName;
+            session.info.state = state == SessionState::Expired ? SessionState::Inactive : state;
+            session.volume = std::make_shared<Volume>(this, m_sessions.size());
+
+            m_byInstance[session.info.instanceId] = m_sessions.size();
+            m_sessions.push_back(session);
+            info = session.info;
+            volume = session.volume;
+        }
+
+        dispatch(Change::Created, info, volume);
+        return info.instanceId;
+    }
+
+    bool SimulatedSessionBackend::setSessionState(const std::wstring &instanceId, SessionState state)
+    {
+        SessionInfo info;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const int index = findLocked(instanceId);
+            if (index < 0)
+                return false;
+            Session &session = m_sessions[static_cast<size_t>(index)];
+            if (session.info.state == state)
+                return true;
+            session.info.state = state;
+            info = session.info;
+        }
+
+        dispatch(Change::State, info, nullptr);
+        return true;
+    }
+
+    bool SimulatedSessionBackend::setSessionVolume(const std::wstring &instanceId, float volume, bool muted)
+    {
+        SessionInfo info;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const int index = findLocked(instanceId);
+            if (index < 0)
+                return false;
+            Session &session = m_sessions[static_cast<size_t>(index)];
+            session.info.volume = std::min(std::max(volume, 0.0f), 1.0f);
+            session.info.muted = muted;
+            info = session.info;
+        }
+
+        dispatch(Change::Volume, info, nullptr);
+        return true;
+    }
+
+    bool SimulatedSessionBackend::disconnectSession(const std::wstring &instanceId)
+    {
+        SessionInfo info;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const int index = findLocked(instanceId);
+            if (index < 0)
+                return false;
+            Session &session = m_sessions[static_cast<size_t>(index)];
+            session.info.state = SessionState::Expired;
+            info = session.info;
+        }
+
+        dispatch(Change::Disconnected, info, nullptr);
+        return true;
+    }
+
+    size_t SimulatedSessionBackend::sessionCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<size_t>(std::count_if(m_sessions.begin(), m_sessions.end(), [](const Session &session)
+                                                  { return session.info.state != SessionState::Expired; }));
+    }
+
+    bool SimulatedSessionBackend::isMuted(const std::wstring &instanceId) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(instanceId);
+        return index >= 0 && m_sessions[static_cast<size_t>(index)].info.muted;
+    }
+
+    float SimulatedSessionBackend::volume(const std::wstring &instanceId) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = findLocked(instanceId);
+        return index >= 0 ? m_sessions[static_cast<size_t>(index)].info.volume : 0.0f;
+    }
+
+    /**
+     * @brief Index of a session that has not expired, or -1.
+     */
+    int SimulatedSessionBackend::findLocked(const std::wstring &instanceId) const
+    {
+        auto it = m_byInstance.find(instanceId);
+        if (it == m_byInstance.end() || m_sessions[it->second].info.state == SessionState::Expired)
+            return -1;
+        return static_cast<int>(it->second);
+    }
+
+    HRESULT SimulatedSessionBackend::getVolume(size_t index, float &volume, bool &muted)
+    {
+        m_volumeCalls.fetch_add(1, std::memory_order_relaxed);
+        uint32_t cost = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const Session &session = m_sessions[index];
+            if (session.info.state == SessionState::Expired)
+                return kSessionExpired;
+            volume = session.info.volume;
+            muted = session.info.muted;
+            cost = m_latency.volumeUs;
+        }
+        SpinForUs(cost);
+        return S_OK;
+    }
+
+    /**
+     * @brief Applies a volume and/or mute change from a volume control and notifies like Core Audio does.
+     */
+    HRESULT SimulatedSessionBackend::setVolume(size_t index, const float *volume, const bool *muted)
+    {
+        m_volumeCalls.fetch_add(1, std::memory_order_relaxed);
+        SessionInfo info;
+        uint32_t cost = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Session &session = m_sessions[index];
+            if (session.info.state == SessionState::Expired)
+                return kSessionExpired;
+            if (volume)
+                session.info.volume = *volume;
+            if (muted)
+                session.info.muted = *muted;
+            info = session.info;
+            cost = m_latency.volumeUs;
+        }
+        SpinForUs(cost);
+
+        dispatch(Change::Volume, info, nullptr);
+        return S_OK;
+    }
+
+    void SimulatedSessionBackend::dispatch(Change change, const SessionInfo &session, const std::shared_ptr<ISessionVolume> &volume)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+        auto device = m_listeners.find(session.deviceId);
+        if (device == m_listeners.end())
+            return;
+
+        std::vector<ISessionListener *> &listeners = device->second;
+        for (size_t i = 0; i < listeners.size(); ++i)
+        {
+            switch (change)
+            {
+            case Change::Created:
+                listeners[i]->onSessionCreated(session, volume);
+                break;
+            case Change::State:
+                listeners[i]->onSessionStateChanged(session.instanceId, session.state);
+                break;
+            case Change::Volume:
+                listeners[i]->onSessionVolumeChanged(session.instanceId, session.volume, session.muted);
+                break;
+            case Change::Disconnected:
+                listeners[i]->onSessionDisconnected(session.instanceId);
+                break;
+            }
+        }
+    }
+}
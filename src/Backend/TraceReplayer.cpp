@@ -0,0 +1,404 @@
+#include "Backend/TraceReplayer.h"
+#include "Utility/SafeRelease.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace Backend
+{
+    namespace
+    {
+        /**
+         * @brief Flow encoded in a Core Audio endpoint ID ("{0.0.0...." render, "{0.0.1...." capture).
+         */
+        EDataFlow FlowFromId(const std::wstring &deviceId)
+        {
+            if (deviceId.size() > 5 && deviceId.compare(0, 5, L"{0.0.") == 0 && deviceId[5] == L'1')
+                return eCapture;
+            return eRender;
+        }
+
+        bool UsesDevice(BackendOperation operation)
+        {
+            return operation != BackendOperation::EnumerateDevices && operation != BackendOperation::GetDefaultDevice &&
+                   operation != BackendOperation::GetDevice && operation != BackendOperation::SetDefaultDevice &&
+                   operation != BackendOperation::EnumerateDevicesByState;
+        }
+    }
+
+    /**
+     * @brief Orders the records by time and rebuilds the recorded system in a fresh simulation.
+     *
+     * @param records Decoded trace (see ReadTrace()).
+     */
+    TraceReplayer::TraceReplayer(std::vector<TraceRecord> records)
+        : m_records(std::move(records))
+    {
+        // Notifications raised inside a call are appended before the call itself
+        std::stable_sort(m_records.begin(), m_records.end(), [](const TraceRecord &a, const TraceRecord &b)
+                         { return a.timestampNs < b.timestampNs; });
+
+        SimulatedBackendConfig config;
+        config.renderDevices = 0;
+        config.captureDevices = 0;
+        m_backend = std::make_shared<SimulatedBackend>(config);
+        collectDevices();
+    }
+
+    /**
+     * @brief Creates the endpoints seen in the trace and sets the first observed state and defaults.
+     *
+     * Endpoints whose first appearance is a deviceAdded notification are left out;
+     * the notification adds them during the replay.
+     */
+    void TraceReplayer::collectDevices()
+    {
+        std::vector<std::wstring> order;
+        std::unordered_map<std::wstring, bool> addedLater;
+        std::unordered_map<std::wstring, DWORD> initialState;
+        std::unordered_map<std::wstring, bool> changed; ///< Device had a notification (later state reads are not initial)
+        std::wstring defaults[2][3];
+        bool defaultsChanged[2] = {false, false};
+
+        auto note = [&](const std::wstring &id, bool flowKnown, EDataFlow flow)
+        {
+            if (id.empty())
+                return;
+            auto it = m_devices.find(id);
+            if (it == m_devices.end())
+            {
+                DeviceInfo info;
+                info.flow = flowKnown ? flow : FlowFromId(id);
+                m_devices.emplace(id, info);
+                order.push_back(id);
+            }
+            else if (flowKnown)
+            {
+                it->second.flow = flow;
+            }
+        };
+
+        for (const TraceRecord &record : m_records)
+        {
+            if (record.isEvent)
+            {
+                if (record.event == TraceEventType::DeviceAdded && !m_devices.count(record.deviceId))
+                    addedLater[record.deviceId] = true;
+                if (record.event == TraceEventType::DefaultDeviceChanged)
+                {
+                    note(record.deviceId, record.flow != eAll, record.flow);
+                    if (record.flow == eRender || record.flow == eCapture)
+                        defaultsChanged[record.flow] = true;
+                }
+                else
+                {
+                    note(record.deviceId, false, eRender);
+                }
+                changed[record.deviceId] = true;
+                continue;
+            }
+
+            switch (record.operation)
+            {
+            case BackendOperation::EnumerateDevices:
+                for (const TraceDevice &device : record.devices)
+                {
+                    note(device.id, record.flow != eAll, record.flow);
+                    if (!device.name.empty())
+                        m_devices[device.id].name = device.name;
+                }
+                break;
+            case BackendOperation::EnumerateDevicesByState:
+                for (const TraceDevice &device : record.devices)
+                {
+                    note(device.id, record.flow != eAll, record.flow);
+                    if (!device.name.empty())
+                        m_devices[device.id].name = device.name;
+                    if (!changed.count(device.id) && !initialState.count(device.id))
+                        initialState[device.id] = device.state;
+                }
+                break;
+            case BackendOperation::GetDefaultDevice:
+                note(record.deviceId, true, record.flow);
+                if (SUCCEEDED(record.result) && (record.flow == eRender || record.flow == eCapture) &&
+                    !defaultsChanged[record.flow] && defaults[record.flow][record.role].empty())
+                    defaults[record.flow][record.role] = record.deviceId;
+                break;
+            case BackendOperation::SetDefaultDevice:
+                note(record.deviceId, false, eRender);
+                if (SUCCEEDED(record.result))
+                    defaultsChanged[m_devices[record.deviceId].flow] = true;
+                break;
+            case BackendOperation::GetFriendlyName:
+                note(record.deviceId, false, eRender);
+                if (SUCCEEDED(record.result) && !record.deviceId.empty())
+                    m_devices[record.deviceId].name = record.name;
+                break;
+            case BackendOperation::GetDeviceState:
+                note(record.deviceId, false, eRender);
+                if (SUCCEEDED(record.result) && !changed.count(record.deviceId) && !initialState.count(record.deviceId))
+                    initialState[record.deviceId] = record.state;
+                break;
+            case BackendOperation::GetMixFormat:
+                note(record.deviceId, false, eRender);
+                if (SUCCEEDED(record.result) && record.format.valid && !record.deviceId.empty())
+                    m_devices[record.deviceId].format = record.format;
+                break;
+            case BackendOperation::GetDeviceDescription:
+                note(record.deviceId, false, eRender);
+                if (SUCCEEDED(record.result) && !record.deviceId.empty())
+                {
+                    m_devices[record.deviceId].description = record.name;
+                    m_devices[record.deviceId].hasDescription = true;
+                }
+                break;
+            case BackendOperation::GetFormFactor:
+                note(record.deviceId, false, eRender);
+                if (SUCCEEDED(record.result) && !record.deviceId.empty())
+                    m_devices[record.deviceId].formFactor = record.formFactor;
+                break;
+            default:
+                note(record.deviceId, false, eRender);
+                break;
+            }
+        }
+
+        for (const std::wstring &id : order)
+        {
+            if (addedLater.count(id))
+                continue;
+            const DeviceInfo &info = m_devices[id];
+            m_backend->addDevice(info.flow, info.name, info.format, id, info.formFactor);
+            if (info.hasDescription)
+                m_backend->setDescription(id, info.description);
+        }
+        for (const auto &entry : initialState)
+            if (!addedLater.count(entry.first))
+                m_backend->setDeviceState(entry.first, entry.second);
+        for (int flow = 0; flow < 2; ++flow)
+            for (int role = 0; role < 3; ++role)
+                if (!defaults[flow][role].empty())
+                    m_backend->setDefaultDevice(defaults[flow][role], 1u << role);
+    }
+
+    /**
+     * @brief Replays every record in order.
+     *
+     * @param options Speed and what to reproduce.
+     * @return ReplayResult Counts, mismatches and recorded vs replayed timing per operation.
+     */
+    ReplayResult TraceReplayer::replay(const ReplayOptions &options)
+    {
+        ReplayResult result;
+        if (m_records.empty())
+            return result;
+
+        const int64_t origin = m_records.front().timestampNs;
+        result.recordedSpanNs = m_records.back().timestampNs - origin;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (const TraceRecord &record : m_records)
+        {
+            if (options.speed > 0.0)
+            {
+                const auto offset = std::chrono::nanoseconds(static_cast<int64_t>((record.timestampNs - origin) / options.speed));
+                std::this_thread::sleep_until(start + offset);
+            }
+
+            if (record.isEvent)
+            {
+                ++result.events;
+                if (options.replayEvents)
+                    replayEvent(record);
+                continue;
+            }
+
+            uint64_t elapsedNs = 0;
+            const HRESULT hr = replayCall(record, options, elapsedNs);
+            ++result.calls;
+            if (hr != record.result)
+                ++result.mismatches;
+
+            ReplayOperationStats &stats = result.operations[static_cast<size_t>(record.operation)];
+            ++stats.calls;
+            stats.recordedNs += record.durationNs;
+            stats.replayedNs += elapsedNs;
+            stats.maxRecordedNs = std::max(stats.maxRecordedNs, record.durationNs);
+            stats.maxReplayedNs = std::max(stats.maxReplayedNs, elapsedNs);
+        }
+
+        result.replayedSpanNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    /**
+     * @brief Issues one recorded call with its recorded duration and failure.
+     *
+     * The device handle is looked up before the overrides are armed, so the lookup
+     * neither takes the recorded time nor consumes the injected failure.
+     */
+    HRESULT TraceReplayer::replayCall(const TraceRecord &record, const ReplayOptions &options, uint64_t &elapsedNs)
+    {
+        const BackendOperation operation = record.operation;
+
+        IMMDevice *device = nullptr;
+        if (UsesDevice(operation) && !record.deviceId.empty())
+            m_backend->getDevice(record.deviceId, &device);
+
+        if (options.reproduceLatency)
+            m_backend->setOperationLatency(operation, static_cast<int64_t>(record.durationNs));
+        if (options.reproduceFailures && FAILED(record.result))
+        {
+            SimulatedFailure failure;
+            failure.failNext = 1;
+            failure.result = record.result;
+            m_backend->setFailure(operation, failure);
+        }
+
+        HRESULT hr = E_NOTIMPL;
+        const auto start = std::chrono::steady_clock::now();
+        switch (operation)
+        {
+        case BackendOperation::EnumerateDevices:
+            hr = m_backend->enumerateDevices(record.flow, nullptr);
+            break;
+        case BackendOperation::EnumerateDevicesByState:
+            hr = m_backend->enumerateDevicesByState(record.flow, record.state, nullptr);
+            break;
+        case BackendOperation::GetDevice:
+        {
+            IMMDevice *found = nullptr;
+            hr = m_backend->getDevice(record.deviceId, &found);
+            Utility::SafeRelease(found);
+            break;
+        }
+        case BackendOperation::GetDefaultDevice:
+        {
+            IMMDevice *found = nullptr;
+            hr = m_backend->getDefaultDevice(record.flow, record.role, &found);
+            Utility::SafeRelease(found);
+            break;
+        }
+        case BackendOperation::SetDefaultDevice:
+            hr = m_backend->setDefaultDevice(record.deviceId, record.roles);
+            break;
+        case BackendOperation::GetFriendlyName:
+        {
+            std::wstring name;
+            hr = m_backend->getFriendlyName(device, name);
+            break;
+        }
+        case BackendOperation::GetDeviceState:
+        {
+            DWORD state = 0;
+            hr = m_backend->getDeviceState(device, state);
+            break;
+        }
+        case BackendOperation::GetMixFormat:
+        {
+            Utility::DeviceFormatInfo format;
+            hr = m_backend->getMixFormat(device, format);
+            break;
+        }
+        case BackendOperation::GetMute:
+        {
+            bool muted = false;
+            hr = m_backend->getMute(device, muted);
+            break;
+        }
+        case BackendOperation::SetMute:
+            hr = m_backend->setMute(device, record.muted);
+            break;
+        case BackendOperation::GetVolume:
+        {
+            float volume = 0.0f;
+            hr = m_backend->getVolume(device, volume);
+            break;
+        }
+        case BackendOperation::SetVolume:
+            hr = m_backend->setVolume(device, record.volume);
+            break;
+        case BackendOperation::GetDeviceDescription:
+        {
+            std::wstring description;
+            hr = m_backend->getDeviceDescription(device, description);
+            break;
+        }
+        case BackendOperation::GetFormFactor:
+        {
+            EndpointFormFactor formFactor = UnknownFormFactor;
+            hr = m_backend->getFormFactor(device, formFactor);
+            break;
+        }
+        default:
+            break;
+        }
+        elapsedNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+        m_backend->setOperationLatency(operation, -1);
+        m_backend->setFailure(operation, SimulatedFailure());
+        Utility::SafeRelease(device);
+        return hr;
+    }
+
+    /**
+     * @brief Brings the simulation in line with a recorded notification (no-op if it already is).
+     */
+    void TraceReplayer::replayEvent(const TraceRecord &record)
+    {
+        const std::wstring &id = record.deviceId;
+        switch (record.event)
+        {
+        case TraceEventType::DeviceAdded:
+            ensureDevice(id);
+            m_backend->setDeviceState(id, DEVICE_STATE_ACTIVE);
+            break;
+        case TraceEventType::DeviceRemoved:
+            m_backend->removeDevice(id);
+            break;
+        case TraceEventType::DeviceStateChanged:
+            ensureDevice(id);
+            m_backend->setDeviceState(id, record.state);
+            break;
+        case TraceEventType::DefaultDeviceChanged:
+            if (!id.empty() && (record.flow == eRender || record.flow == eCapture) &&
+                m_backend->defaultDeviceId(record.flow, record.role) != id)
+                m_backend->setDefaultDevice(id, 1u << record.role);
+            break;
+        case TraceEventType::VolumeChanged:
+        {
+            IMMDevice *device = nullptr;
+            if (FAILED(m_backend->getDevice(id, &device)))
+                break;
+            if (m_backend->isMuted(id) != record.muted)
+                m_backend->setMute(device, record.muted);
+            if (m_backend->volume(id) != record.volume)
+                m_backend->setVolume(device, record.volume);
+            Utility::SafeRelease(device);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    /**
+     * @brief Adds an endpoint the simulation does not know yet, as described by the trace.
+     */
+    void TraceReplayer::ensureDevice(const std::wstring &deviceId)
+    {
+        if (deviceId.empty() || m_backend->deviceState(deviceId) != 0)
+            return;
+
+        auto it = m_devices.find(deviceId);
+        DeviceInfo info;
+        if (it != m_devices.end())
+            info = it->second;
+        else
+            info.flow = FlowFromId(deviceId);
+        m_backend->addDevice(info.flow, info.name, info.format, deviceId, info.formFactor);
+        if (info.hasDescription)
+            m_backend->setDescription(deviceId, info.description);
+    }
+}
@@ -0,0 +1,332 @@
+#include "Backend/TracingBackend.h"
+#include "ListenerSet.h"
+
+namespace Backend
+{
+    namespace
+    {
+        /**
+         * @brief Endpoint ID of a handle, for the trace (empty for null or on failure).
+         */
+        std::wstring IdOf(IMMDevice *device)
+        {
+            std::wstring id;
+            LPWSTR raw = nullptr;
+            if (device && SUCCEEDED(device->GetId(&raw)) && raw)
+                id = raw;
+            CoTaskMemFree(raw);
+            return id;
+        }
+    }
+
+    /**
+     * @brief Listener on the inner backend: records each notification, then forwards it.
+     */
+    class TracingBackend::Recorder : public IDeviceListener
+    {
+    public:
+        explicit Recorder(TracingBackend &owner) : m_owner(owner) {}
+
+        void onDeviceAdded(const std::wstring &deviceId) override
+        {
+            TraceRecord record = event(TraceEventType::DeviceAdded, deviceId);
+            m_owner.m_writer->append(record);
+            m_owner.m_listeners->notify([&](IDeviceListener &listener)
+                                        { listener.onDeviceAdded(deviceId); });
+        }
+
+        void onDeviceRemoved(const std::wstring &deviceId) override
+        {
+            TraceRecord record = event(TraceEventType::DeviceRemoved, deviceId);
+            m_owner.m_writer->append(record);
+            m_owner.m_listeners->notify([&](IDeviceListener &listener)
+                                        { listener.onDeviceRemoved(deviceId); });
+        }
+
+        void onDeviceStateChanged(const std::wstring &deviceId, DWORD state) override
+        {
+            TraceRecord record = event(TraceEventType::DeviceStateChanged, deviceId);
+            record.state = state;
+            m_owner.m_writer->append(record);
+            m_owner.m_listeners->notify([&](IDeviceListener &listener)
+                                        { listener.onDeviceStateChanged(deviceId, state); });
+        }
+
+        void onDefaultDeviceChanged(EDataFlow flow, ERole role, const std::wstring &deviceId) override
+        {
+            TraceRecord record = event(TraceEventType::DefaultDeviceChanged, deviceId);
+            record.flow = flow;
+            record.role = role;
+            m_owner.m_writer->append(record);
+            m_owner.m_listeners->notify([&](IDeviceListener &listener)
+                                        { listener.onDefaultDeviceChanged(flow, role, deviceId); });
+        }
+
+        void onVolumeChanged(const std::wstring &deviceId, float volume, bool muted) override
+        {
+            TraceRecord record = event(TraceEventType::VolumeChanged, deviceId);
+            record.volume = volume;
+            record.muted = muted;
+            m_owner.m_writer->append(record);
+            m_owner.m_listeners->notify([&](IDeviceListener &listener)
+                                        { listener.onVolumeChanged(deviceId, volume, muted); });
+        }
+
+    private:
+        TraceRecord event(TraceEventType type, const std::wstring &deviceId) const
+        {
+            TraceRecord record;
+            record.isEvent = true;
+            record.event = type;
+            record.timestampNs = m_owner.m_writer->now();
+            record.deviceId = deviceId;
+            return record;
+        }
+
+        TracingBackend &m_owner;
+    };
+
+    TracingBackend::TracingBackend(std::shared_ptr<IAudioBackend> inner, std::shared_ptr<TraceWriter> writer,
+                                   bool recordEvents)
+        : m_inner(inner ? std::move(inner) : CreatePlatformBackend()),
+          m_writer(writer ? std::move(writer) : std::make_shared<TraceWriter>()),
+          m_recordEvents(recordEvents),
+          m_recorder(new Recorder(*this)),
+          m_listeners(new ListenerSet())
+    {
+        updateSubscription();
+    }
+
+    /**
+     * @brief Unsubscribes from the inner backend (waits for a running notification).
+     */
+    TracingBackend::~TracingBackend()
+    {
+        std::lock_guard<std::mutex> lock(m_subscriptionMutex);
+        if (m_subscribed)
+            m_inner->unregisterListener(m_recorder.get());
+    }
+
+    /**
+     * @brief Records the enumerated endpoints along with the call.
+     */
+    HRESULT TracingBackend::enumerateDevices(EDataFlow flow, const DeviceVisitor &visit)
+    {
+        TraceRecord record = startCall(BackendOperation::EnumerateDevices);
+        record.flow = flow;
+        const HRESULT hr = m_inner->enumerateDevices(flow, [&](const std::wstring &id, const std::wstring &name, IMMDevice *device)
+                                                     {
+            record.devices.push_back({id, name});
+            if (visit)
+                visit(id, name, device); });
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    /**
+     * @brief Records the mask and the visited endpoints with their state along with the call.
+     */
+    HRESULT TracingBackend::enumerateDevicesByState(EDataFlow flow, DWORD stateMask, const DeviceStateVisitor &visit)
+    {
+        TraceRecord record = startCall(BackendOperation::EnumerateDevicesByState);
+        record.flow = flow;
+        record.state = stateMask;
+        const HRESULT hr = m_inner->enumerateDevicesByState(flow, stateMask, [&](const std::wstring &id, const std::wstring &name, DWORD state, IMMDevice *device)
+                                                            {
+            record.devices.push_back({id, name, state});
+            if (visit)
+                visit(id, name, state, device); });
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::getDevice(const std::wstring &deviceId, IMMDevice **device)
+    {
+        TraceRecord record = startCall(BackendOperation::GetDevice);
+        record.deviceId = deviceId;
+        const HRESULT hr = m_inner->getDevice(deviceId, device);
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::getDefaultDevice(EDataFlow flow, ERole role, IMMDevice **device)
+    {
+        TraceRecord record = startCall(BackendOperation::GetDefaultDevice);
+        record.flow = flow;
+        record.role = role;
+        const HRESULT hr = m_inner->getDefaultDevice(flow, role, device);
+        finishCall(record, hr);
+        if (SUCCEEDED(hr) && device)
+            record.deviceId = IdOf(*device);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::setDefaultDevice(const std::wstring &deviceId, uint32_t roles)
+    {
+        TraceRecord record = startCall(BackendOperation::SetDefaultDevice);
+        record.deviceId = deviceId;
+        record.roles = roles;
+        const HRESULT hr = m_inner->setDefaultDevice(deviceId, roles);
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::getFriendlyName(IMMDevice *device, std::wstring &name)
+    {
+        TraceRecord record = startCall(BackendOperation::GetFriendlyName, device);
+        const HRESULT hr = m_inner->getFriendlyName(device, name);
+        if (SUCCEEDED(hr))
+            record.name = name;
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::getDeviceState(IMMDevice *device, DWORD &state)
+    {
+        TraceRecord record = startCall(BackendOperation::GetDeviceState, device);
+        const HRESULT hr = m_inner->getDeviceState(device, state);
+        if (SUCCEEDED(hr))
+            record.state = state;
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::getFormFactor(IMMDevice *device, EndpointFormFactor &formFactor)
+    {
+        TraceRecord record = startCall(BackendOperation::GetFormFactor, device);
+        const HRESULT hr = m_inner->getFormFactor(device, formFactor);
+        if (SUCCEEDED(hr))
+            record.formFactor = formFactor;
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::getDeviceDescription(IMMDevice *device, std::wstring &description)
+    {
+        TraceRecord record = startCall(BackendOperation::GetDeviceDescription, device);
+        const HRESULT hr = m_inner->getDeviceDescription(device, description);
+        if (SUCCEEDED(hr))
+            record.name = description;
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::getMixFormat(IMMDevice *device, Utility::DeviceFormatInfo &format)
+    {
+        TraceRecord record = startCall(BackendOperation::GetMixFormat, device);
+        const HRESULT hr = m_inner->getMixFormat(device, format);
+        if (SUCCEEDED(hr))
+            record.format = format;
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::getMute(IMMDevice *device, bool &mute)
+    {
+        TraceRecord record = startCall(BackendOperation::GetMute, device);
+        const HRESULT hr = m_inner->getMute(device, mute);
+        record.muted = SUCCEEDED(hr) && mute;
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::setMute(IMMDevice *device, bool mute)
+    {
+        TraceRecord record = startCall(BackendOperation::SetMute, device);
+        record.muted = mute;
+        const HRESULT hr = m_inner->setMute(device, mute);
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::getVolume(IMMDevice *device, float &volume)
+    {
+        TraceRecord record = startCall(BackendOperation::GetVolume, device);
+        const HRESULT hr = m_inner->getVolume(device, volume);
+        if (SUCCEEDED(hr))
+            record.volume = volume;
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::setVolume(IMMDevice *device, float volume)
+    {
+        TraceRecord record = startCall(BackendOperation::SetVolume, device);
+        record.volume = volume;
+        const HRESULT hr = m_inner->setVolume(device, volume);
+        finishCall(record, hr);
+        m_writer->append(record);
+        return hr;
+    }
+
+    HRESULT TracingBackend::registerListener(IDeviceListener *listener)
+    {
+        const HRESULT hr = m_listeners->add(listener);
+        if (hr == S_OK)
+            updateSubscription();
+        return hr;
+    }
+
+    HRESULT TracingBackend::unregisterListener(IDeviceListener *listener)
+    {
+        const HRESULT hr = m_listeners->remove(listener);
+        if (hr == S_OK)
+            updateSubscription();
+        return hr;
+    }
+
+    /**
+     * @brief Starts a call record; the device ID is resolved before the clock starts.
+     */
+    TraceRecord TracingBackend::startCall(BackendOperation operation, IMMDevice *device) const
+    {
+        TraceRecord record;
+        record.operation = operation;
+        if (device)
+            record.deviceId = IdOf(device);
+        record.timestampNs = m_writer->now();
+        return record;
+    }
+
+    /**
+     * @brief Stamps duration and result right after the inner call returns.
+     */
+    void TracingBackend::finishCall(TraceRecord &record, HRESULT result) const
+    {
+        const int64_t end = m_writer->now();
+        record.durationNs = static_cast<uint64_t>(end > record.timestampNs ? end - record.timestampNs : 0);
+        record.result = result;
+    }
+
+    /**
+     * @brief Subscribes to the inner backend while events are wanted (always, or while listeners exist).
+     */
+    void TracingBackend::updateSubscription()
+    {
+        std::lock_guard<std::mutex> lock(m_subscriptionMutex);
+        const bool wanted = m_recordEvents || !m_listeners->empty();
+        if (wanted == m_subscribed)
+            return;
+
+        if (wanted)
+            m_subscribed = SUCCEEDED(m_inner->registerListener(m_recorder.get()));
+        else
+        {
+            m_inner->unregisterListener(m_recorder.get());
+            m_subscribed = false;
+        }
+    }
+}
@@ -0,0 +1,708 @@
+#include "WasapiBackend.h"
+#include "AudioSwitcher/IPolicyConfig.h"
+#include "Utility/DeviceUtils.h"
+#include "Utility/Instrumentation.h"
+#include "Utility/SafeRelease.h"
+
+#include <windows.h>
+#include <mmdeviceapi.h>
+#include <endpointvolume.h>
+#include <functiondiscoverykeys_devpkey.h> // For PKEY_Device_FriendlyName / DeviceDesc
+#include <propvarutil.h>                   // For PropVariantClear
+#include <audioclient.h>                   // For IAudioClient
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace Backend
+{
+    using Utility::SafeRelease;
+
+    namespace
+    {
+        HRESULT CreateEnumerator(IMMDeviceEnumerator **pEnum)
+        {
+            return AUDIO_SWITCHER_TIME_CALL("CoCreateInstance(MMDeviceEnumerator)",
+                                            CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                                                             __uuidof(IMMDeviceEnumerator), (void **)pEnum));
+        }
+
+        /**
+         * @brief Reads PKEY_Device_FriendlyName; fails unless the value is a string.
+         */
+        HRESULT ReadStringProperty(IMMDevice *device, const PROPERTYKEY &key, std::wstring &value)
+        {
+            IPropertyStore *pStore = nullptr;
+            HRESULT hr = AUDIO_SWITCHER_TIME_CALL("IMMDevice::OpenPropertyStore", device->OpenPropertyStore(STGM_READ, &pStore));
+            if (FAILED(hr) || !pStore)
+                return FAILED(hr) ? hr : E_POINTER;
+
+            PROPVARIANT prop;
+            PropVariantInit(&prop);
+            hr = AUDIO_SWITCHER_TIME_CALL("IPropertyStore::GetValue", pStore->GetValue(key, &prop));
+            if (SUCCEEDED(hr))
+            {
+                if (prop.vt == VT_LPWSTR && prop.pwszVal)
+                    value = prop.pwszVal;
+                else
+                    hr = E_FAIL;
+            }
+
+            PropVariantClear(&prop);
+            SafeRelease(pStore);
+            return hr;
+        }
+
+        HRESULT ReadFriendlyName(IMMDevice *device, std::wstring &name)
+        {
+            return ReadStringProperty(device, PKEY_Device_FriendlyName, name);
+        }
+
+        HRESULT ActivateEndpointVolume(IMMDevice *device, IAudioEndpointVolume **endpointVolume)
+        {
+            HRESULT hr = AUDIO_SWITCHER_TIME_CALL("IMMDevice::Activate(IAudioEndpointVolume)", device->Activate(
+                __uuidof(IAudioEndpointVolume),
+                CLSCTX_ALL,
+                nullptr,
+                reinterpret_cast<void **>(endpointVolume)));
+            if (SUCCEEDED(hr) && !*endpointVolume)
+                hr = E_POINTER;
+            return hr;
+        }
+    }
+
+    /**
+     * @brief IMMNotificationClient forwarding endpoint events to the backend's listeners.
+     */
+    class WasapiBackend::NotificationClient : public IMMNotificationClient
+    {
+    public:
+        explicit NotificationClient(WasapiBackend *owner) : m_owner(owner) {}
+
+        ULONG STDMETHODCALLTYPE AddRef() override { return ++m_refs; }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            const ULONG refs = --m_refs;
+            if (refs == 0)
+                delete this;
+            return refs;
+        }
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **object) override
+        {
+            if (!object)
+                return E_POINTER;
+            if (riid == __uuidof(IUnknown) || riid == __uuidof(IMMNotificationClient))
+            {
+                *object = static_cast<IMMNotificationClient *>(this);
+                AddRef();
+                return S_OK;
+            }
+            *object = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        HRESULT STDMETHODCALLTYPE OnDeviceStateChanged(LPCWSTR deviceId, DWORD state) override
+        {
+            const std::wstring id = deviceId ? deviceId : L"";
+            m_owner->queueWatch(id, state == DEVICE_STATE_ACTIVE);
+            m_owner->m_listeners.notify([&](IDeviceListener &listener)
+                                        { listener.onDeviceStateChanged(id, state); });
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE OnDeviceAdded(LPCWSTR deviceId) override
+        {
+            const std::wstring id = deviceId ? deviceId : L"";
+            m_owner->queueWatch(id, true);
+            m_owner->m_listeners.notify([&](IDeviceListener &listener)
+                                        { listener.onDeviceAdded(id); });
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE OnDeviceRemoved(LPCWSTR deviceId) override
+        {
+            const std::wstring id = deviceId ? deviceId : L"";
+            m_owner->queueWatch(id, false);
+            m_owner->m_listeners.notify([&](IDeviceListener &listener)
+                                        { listener.onDeviceRemoved(id); });
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPCWSTR deviceId) override
+        {
+            const std::wstring id = deviceId ? deviceId : L"";
+            m_owner->m_listeners.notify([&](IDeviceListener &listener)
+                                        { listener.onDefaultDeviceChanged(flow, role, id); });
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR, const PROPERTYKEY) override
+        {
+            return S_OK;
+        }
+
+    private:
+        ~NotificationClient() = default;
+
+        std::atomic<ULONG> m_refs{1};
+        WasapiBackend *m_owner;
+    };
+
+    /**
+     * @brief IAudioEndpointVolumeCallback of one endpoint.
+     */
+    class WasapiBackend::VolumeCallback : public IAudioEndpointVolumeCallback
+    {
+    public:
+        VolumeCallback(WasapiBackend *owner, std::wstring deviceId) : m_owner(owner), m_id(std::move(deviceId)) {}
+
+        ULONG STDMETHODCALLTYPE AddRef() override { return ++m_refs; }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            const ULONG refs = --m_refs;
+            if (refs == 0)
+                delete this;
+            return refs;
+        }
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **object) override
+        {
+            if (!object)
+                return E_POINTER;
+            if (riid == __uuidof(IUnknown) || riid == __uuidof(IAudioEndpointVolumeCallback))
+            {
+                *object = static_cast<IAudioEndpointVolumeCallback *>(this);
+                AddRef();
+                return S_OK;
+            }
+            *object = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        HRESULT STDMETHODCALLTYPE OnNotify(PAUDIO_VOLUME_NOTIFICATION_DATA data) override
+        {
+            if (!data)
+                return E_POINTER;
+            const float volume = data->fMasterVolume;
+            const bool muted = data->bMuted != FALSE;
+            m_owner->m_listeners.notify([&](IDeviceListener &listener)
+                                        { listener.onVolumeChanged(m_id, volume, muted); });
+            return S_OK;
+        }
+
+    private:
+        ~VolumeCallback() = default;
+
+        std::atomic<ULONG> m_refs{1};
+        WasapiBackend *m_owner;
+        std::wstring m_id;
+    };
+
+    WasapiBackend::~WasapiBackend()
+    {
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        stopNotifications();
+    }
+
+    /**
+     * @brief Enumerates the active endpoints of a flow.
+     */
+    HRESULT WasapiBackend::enumerateDevices(EDataFlow flow, const DeviceVisitor &visit)
+    {
+        return enumerateDevicesByState(flow, DEVICE_STATE_ACTIVE, [&visit](const std::wstring &id, const std::wstring &name, DWORD, IMMDevice *device)
+                                       {
+                                           if (visit)
+                                               visit(id, name, device); });
+    }
+
+    /**
+     * @brief Enumerates the endpoints of a flow in any of the states of `stateMask`.
+     *
+     * Endpoints whose ID, state or friendly name cannot be read are skipped, as before.
+     *
+     * @param flow Data flow passed to EnumAudioEndpoints.
+     * @param stateMask DEVICE_STATE_* bits passed to EnumAudioEndpoints.
+     * @param visit Called with a borrowed device pointer.
+     * @return HRESULT First failure of the enumerator / collection, else S_OK.
+     */
+    HRESULT WasapiBackend::enumerateDevicesByState(EDataFlow flow, DWORD stateMask, const DeviceStateVisitor &visit)
+    {
+        IMMDeviceEnumerator *pEnum = nullptr;
+        IMMDeviceCollection *pDevices = nullptr;
+
+        HRESULT hr = CreateEnumerator(&pEnum);
+        if (FAILED(hr))
+            return hr;
+
+        hr = AUDIO_SWITCHER_TIME_CALL("IMMDeviceEnumerator::EnumAudioEndpoints", pEnum->EnumAudioEndpoints(flow, stateMask, &pDevices));
+        if (FAILED(hr))
+        {
+            SafeRelease(pEnum);
+            return hr;
+        }
+
+        UINT count = 0;
+        hr = AUDIO_SWITCHER_TIME_CALL("IMMDeviceCollection::GetCount", pDevices->GetCount(&count));
+
+        for (UINT i = 0; SUCCEEDED(hr) && i < count; ++i)
+        {
+            IMMDevice *pDevice = nullptr;
+            if (FAILED(AUDIO_SWITCHER_TIME_CALL("IMMDeviceCollection::Item", pDevices->Item(i, &pDevice))) || !pDevice)
+                continue;
+
+            LPWSTR deviceId = nullptr;
+            DWORD state = 0;
+            std::wstring name;
+            if (SUCCEEDED(AUDIO_SWITCHER_TIME_CALL("IMMDevice::GetId", pDevice->GetId(&deviceId))) &&
+                (stateMask == DEVICE_STATE_ACTIVE || SUCCEEDED(AUDIO_SWITCHER_TIME_CALL("IMMDevice::GetState", pDevice->GetState(&state)))) &&
+                SUCCEEDED(ReadFriendlyName(pDevice, name)) && visit)
+            {
+                visit(deviceId, name, stateMask == DEVICE_STATE_ACTIVE ? DEVICE_STATE_ACTIVE : state, pDevice);
+            }
+
+            CoTaskMemFree(deviceId);
+            SafeRelease(pDevice);
+        }
+
+        SafeRelease(pDevices);
+        SafeRelease(pEnum);
+        return hr;
+    }
+
+    /**
+     * @brief Looks up an endpoint by ID through IMMDeviceEnumerator::GetDevice.
+     */
+    HRESULT WasapiBackend::getDevice(const std::wstring &deviceId, IMMDevice **device)
+    {
+        if (!device)
+            return E_POINTER;
+        *device = nullptr;
+
+        IMMDeviceEnumerator *pEnum = nullptr;
+        HRESULT hr = CreateEnumerator(&pEnum);
+        if (FAILED(hr) || !pEnum)
+            return FAILED(hr) ? hr : E_POINTER;
+
+        hr = AUDIO_SWITCHER_TIME_CALL("IMMDeviceEnumerator::GetDevice", pEnum->GetDevice(deviceId.c_str(), device));
+        SafeRelease(pEnum);
+        return hr;
+    }
+
+    /**
+     * @brief Retrieves the default endpoint of a flow and role.
+     */
+    HRESULT WasapiBackend::getDefaultDevice(EDataFlow flow, ERole role, IMMDevice **device)
+    {
+        if (!device)
+            return E_POINTER;
+        *device = nullptr;
+
+        IMMDeviceEnumerator *pEnum = nullptr;
+        HRESULT hr = CreateEnumerator(&pEnum);
+        if (FAILED(hr) || !pEnum)
+            return FAILED(hr) ? hr : E_POINTER;
+
+        hr = AUDIO_SWITCHER_TIME_CALL("IMMDeviceEnumerator::GetDefaultAudioEndpoint", pEnum->GetDefaultAudioEndpoint(flow, role, device));
+        SafeRelease(pEnum);
+        return hr;
+    }
+
+    /**
+     * @brief Sets the default endpoint for each requested role through IPolicyConfig.
+     *
+     * Every requested role is attempted even if an earlier one fails.
+     *
+     * @return HRESULT S_OK if all roles were set, otherwise the last failure.
+     */
+    HRESULT WasapiBackend::setDefaultDevice(const std::wstring &deviceId, uint32_t roles)
+    {
+        IPolicyConfig *pPolicyConfig = nullptr;
+        HRESULT hr = AUDIO_SWITCHER_TIME_CALL("CoCreateInstance(CPolicyConfigClient)",
+                                              CoCreateInstance(__uuidof(CPolicyConfigClient), nullptr, CLSCTX_ALL,
+                                                               __uuidof(IPolicyConfig), (LPVOID *)&pPolicyConfig));
+        if (FAILED(hr) || !pPolicyConfig)
+            return FAILED(hr) ? hr : E_POINTER;
+
+        // One timer site per role so each shows up separately in the instrumentation
+        const wchar_t *id = deviceId.c_str();
+        HRESULT result = S_OK;
+        if (roles & RoleConsole)
+        {
+            hr = AUDIO_SWITCHER_TIME_CALL("IPolicyConfig::SetDefaultEndpoint(eConsole)", pPolicyConfig->SetDefaultEndpoint(id, eConsole));
+            result = FAILED(hr) ? hr : result;
+        }
+        if (roles & RoleMultimedia)
+        {
+            hr = AUDIO_SWITCHER_TIME_CALL("IPolicyConfig::SetDefaultEndpoint(eMultimedia)", pPolicyConfig->SetDefaultEndpoint(id, eMultimedia));
+            result = FAILED(hr) ? hr : result;
+        }
+        if (roles & RoleCommunications)
+        {
+            hr = AUDIO_SWITCHER_TIME_CALL("IPolicyConfig::SetDefaultEndpoint(eCommunications)", pPolicyConfig->SetDefaultEndpoint(id, eCommunications));
+            result = FAILED(hr) ? hr : result;
+        }
+
+        SafeRelease(pPolicyConfig);
+        return result;
+    }
+
+    HRESULT WasapiBackend::getFriendlyName(IMMDevice *device, std::wstring &name)
+    {
+        if (!device)
+            return E_POINTER;
+        return ReadFriendlyName(device, name);
+    }
+
+    HRESULT WasapiBackend::getDeviceState(IMMDevice *device, DWORD &state)
+    {
+        if (!device)
+            return E_POINTER;
+        return AUDIO_SWITCHER_TIME_CALL("IMMDevice::GetState", device->GetState(&state));
+    }
+
+    HRESULT WasapiBackend::getFormFactor(IMMDevice *device, EndpointFormFactor &formFactor)
+    {
+        if (!device)
+            return E_POINTER;
+
+        IPropertyStore *pStore = nullptr;
+        HRESULT hr = AUDIO_SWITCHER_TIME_CALL("IMMDevice::OpenPropertyStore", device->OpenPropertyStore(STGM_READ, &pStore));
+        if (FAILED(hr) || !pStore)
+            return FAILED(hr) ? hr : E_POINTER;
+
+        PROPVARIANT prop;
+        PropVariantInit(&prop);
+        hr = AUDIO_SWITCHER_TIME_CALL("IPropertyStore::GetValue", pStore->GetValue(PKEY_AudioEndpoint_FormFactor, &prop));
+        if (SUCCEEDED(hr))
+        {
+            if (prop.vt == VT_UI4 && prop.ulVal < EndpointFormFactor_enum_count)
+                formFactor = static_cast<EndpointFormFactor>(prop.ulVal);
+            else
+                formFactor = UnknownFormFactor;
+        }
+
+        PropVariantClear(&prop);
+        SafeRelease(pStore);
+        return hr;
+    }
+
+    HRESULT WasapiBackend::getDeviceDescription(IMMDevice *device, std::wstring &description)
+    {
+        if (!device)
+            return E_POINTER;
+        return ReadStringProperty(device, PKEY_Device_DeviceDesc, description);
+    }
+
+    /**
+     * @brief Reads the shared-mode mix format via IAudioClient::GetMixFormat.
+     */
+    HRESULT WasapiBackend::getMixFormat(IMMDevice *device, Utility::DeviceFormatInfo &format)
+    {
+        if (!device)
+            return E_POINTER;
+
+        IAudioClient *pAudioClient = nullptr;
+        HRESULT hr = AUDIO_SWITCHER_TIME_CALL("IMMDevice::Activate(IAudioClient)", device->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr, (void **)&pAudioClient));
+        if (FAILED(hr) || !pAudioClient)
+            return FAILED(hr) ? hr : E_POINTER;
+
+        WAVEFORMATEX *pwfx = nullptr;
+        hr = AUDIO_SWITCHER_TIME_CALL("IAudioClient::GetMixFormat", pAudioClient->GetMixFormat(&pwfx));
+        if (SUCCEEDED(hr) && pwfx)
+            format = Utility::GetWaveFormatInfo(pwfx);
+        else if (SUCCEEDED(hr))
+            hr = E_POINTER;
+
+        CoTaskMemFree(pwfx);
+        SafeRelease(pAudioClient);
+        return hr;
+    }
+
+    HRESULT WasapiBackend::getMute(IMMDevice *device, bool &mute)
+    {
+        if (!device)
+            return E_POINTER;
+
+        IAudioEndpointVolume *endpointVolume = nullptr;
+        HRESULT hr = ActivateEndpointVolume(device, &endpointVolume);
+        if (FAILED(hr))
+            return hr;
+
+        BOOL muted = FALSE;
+        hr = AUDIO_SWITCHER_TIME_CALL("IAudioEndpointVolume::GetMute", endpointVolume->GetMute(&muted));
+        if (SUCCEEDED(hr))
+            mute = muted != FALSE;
+        SafeRelease(endpointVolume);
+        return hr;
+    }
+
+    /**
+     * @brief Sets the mute state through IAudioEndpointVolume.
+     */
+    HRESULT WasapiBackend::setMute(IMMDevice *device, bool mute)
+    {
+        if (!device)
+            return E_POINTER;
+
+        IAudioEndpointVolume *endpointVolume = nullptr;
+        HRESULT hr = ActivateEndpointVolume(device, &endpointVolume);
+        if (FAILED(hr))
+            return hr;
+
+        hr = AUDIO_SWITCHER_TIME_CALL("IAudioEndpointVolume::SetMute", endpointVolume->SetMute(mute ? TRUE : FALSE, nullptr));
+        SafeRelease(endpointVolume);
+        return hr;
+    }
+
+    HRESULT WasapiBackend::getVolume(IMMDevice *device, float &volume)
+    {
+        if (!device)
+            return E_POINTER;
+
+        IAudioEndpointVolume *endpointVolume = nullptr;
+        HRESULT hr = ActivateEndpointVolume(device, &endpointVolume);
+        if (FAILED(hr))
+            return hr;
+
+        hr = AUDIO_SWITCHER_TIME_CALL("IAudioEndpointVolume::GetMasterVolumeLevelScalar", endpointVolume->GetMasterVolumeLevelScalar(&volume));
+        SafeRelease(endpointVolume);
+        return hr;
+    }
+
+    HRESULT WasapiBackend::setVolume(IMMDevice *device, float volume)
+    {
+        if (!device)
+            return E_POINTER;
+        if (!(volume >= 0.0f && volume <= 1.0f))
+            return E_INVALIDARG;
+
+        IAudioEndpointVolume *endpointVolume = nullptr;
+        HRESULT hr = ActivateEndpointVolume(device, &endpointVolume);
+        if (FAILED(hr))
+            return hr;
+
+        hr = AUDIO_SWITCHER_TIME_CALL("IAudioEndpointVolume::SetMasterVolumeLevelScalar", endpointVolume->SetMasterVolumeLevelScalar(volume, nullptr));
+        SafeRelease(endpointVolume);
+        return hr;
+    }
+
+    /**
+     * @brief Adds a listener; the first one starts the COM notification registrations.
+     */
+    HRESULT WasapiBackend::registerListener(IDeviceListener *listener)
+    {
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        const bool first = m_listeners.empty();
+        HRESULT hr = m_listeners.add(listener);
+        if (hr != S_OK || !first)
+            return hr;
+
+        hr = startNotifications();
+        if (FAILED(hr))
+            m_listeners.remove(listener);
+        return hr;
+    }
+
+    /**
+     * @brief Removes a listener; the last one stops the COM notification registrations.
+     */
+    HRESULT WasapiBackend::unregisterListener(IDeviceListener *listener)
+    {
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        HRESULT hr = m_listeners.remove(listener);
+        if (SUCCEEDED(hr) && m_listeners.empty())
+            stopNotifications();
+        return hr;
+    }
+
+    /**
+     * @brief Registers the endpoint notification client and a volume callback per active endpoint,
+     *        and starts the worker that keeps the volume callbacks in step with device changes.
+     */
+    HRESULT WasapiBackend::startNotifications()
+    {
+        IMMDeviceEnumerator *pEnum = nullptr;
+        HRESULT hr = CreateEnumerator(&pEnum);
+        if (FAILED(hr) || !pEnum)
+            return FAILED(hr) ? hr : E_POINTER;
+
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_watchQueue.clear();
+            m_queueStop = false;
+        }
+        m_watchThread = std::thread(&WasapiBackend::runWatches, this);
+
+        NotificationClient *client = new NotificationClient(this);
+        {
+            std::lock_guard<std::mutex> lock(m_watchMutex);
+            m_notifyEnum = pEnum;
+            m_client = client;
+        }
+
+        hr = AUDIO_SWITCHER_TIME_CALL("IMMDeviceEnumerator::RegisterEndpointNotificationCallback", pEnum->RegisterEndpointNotificationCallback(client));
+        if (FAILED(hr))
+        {
+            std::lock_guard<std::mutex> lock(m_watchMutex);
+            m_notifyEnum = nullptr;
+            m_client = nullptr;
+            client->Release();
+            SafeRelease(pEnum);
+            stopNotifications();
+            return hr;
+        }
+
+        std::vector<std::wstring> ids;
+        enumerateDevices(eAll, [&ids](const std::wstring &id, const std::wstring &, IMMDevice *)
+                         { ids.push_back(id); });
+        for (const std::wstring &id : ids)
+            watchVolume(id);
+        return S_OK;
+    }
+
+    /**
+     * @brief Undoes startNotifications().
+     *
+     * The endpoint client is unregistered first, because unregistering waits for
+     * running callbacks; the worker is then joined so nothing re-registers a
+     * volume callback while the watches are torn down.
+     */
+    void WasapiBackend::stopNotifications()
+    {
+        IMMDeviceEnumerator *pEnum = nullptr;
+        NotificationClient *client = nullptr;
+        std::map<std::wstring, VolumeWatch> watches;
+        {
+            std::lock_guard<std::mutex> lock(m_watchMutex);
+            pEnum = m_notifyEnum;
+            client = m_client;
+            m_notifyEnum = nullptr;
+            m_client = nullptr;
+        }
+
+        if (pEnum && client)
+            AUDIO_SWITCHER_TIME_CALL("IMMDeviceEnumerator::UnregisterEndpointNotificationCallback", pEnum->UnregisterEndpointNotificationCallback(client));
+        if (client)
+            client->Release();
+
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_queueStop = true;
+            m_watchQueue.clear();
+        }
+        m_queueWake.notify_all();
+        if (m_watchThread.joinable())
+            m_watchThread.join();
+        SafeRelease(pEnum);
+
+        {
+            std::lock_guard<std::mutex> lock(m_watchMutex);
+            watches.swap(m_volumeWatches);
+        }
+        for (auto &entry : watches)
+        {
+            entry.second.volume->UnregisterControlChangeNotify(entry.second.callback);
+            entry.second.callback->Release();
+            SafeRelease(entry.second.volume);
+        }
+    }
+
+    /**
+     * @brief Registers a volume callback on an endpoint (no-op when not listening or already watched).
+     */
+    void WasapiBackend::watchVolume(const std::wstring &deviceId)
+    {
+        std::lock_guard<std::mutex> lock(m_watchMutex);
+        if (!m_notifyEnum || m_volumeWatches.count(deviceId))
+            return;
+
+        IMMDevice *pDevice = nullptr;
+        if (FAILED(m_notifyEnum->GetDevice(deviceId.c_str(), &pDevice)) || !pDevice)
+            return;
+
+        DWORD state = 0;
+        IAudioEndpointVolume *endpointVolume = nullptr;
+        if (SUCCEEDED(pDevice->GetState(&state)) && state == DEVICE_STATE_ACTIVE &&
+            SUCCEEDED(ActivateEndpointVolume(pDevice, &endpointVolume)))
+        {
+            VolumeCallback *callback = new VolumeCallback(this, deviceId);
+            if (SUCCEEDED(endpointVolume->RegisterControlChangeNotify(callback)))
+            {
+                m_volumeWatches[deviceId] = VolumeWatch{endpointVolume, callback};
+                endpointVolume = nullptr;
+            }
+            else
+            {
+                callback->Release();
+            }
+        }
+
+        SafeRelease(endpointVolume);
+        SafeRelease(pDevice);
+    }
+
+    void WasapiBackend::unwatchVolume(const std::wstring &deviceId)
+    {
+        VolumeWatch watch;
+        {
+            std::lock_guard<std::mutex> lock(m_watchMutex);
+            auto it = m_volumeWatches.find(deviceId);
+            if (it == m_volumeWatches.end())
+                return;
+            watch = it->second;
+            m_volumeWatches.erase(it);
+        }
+
+        watch.volume->UnregisterControlChangeNotify(watch.callback);
+        watch.callback->Release();
+        SafeRelease(watch.volume);
+    }
+
+    /**
+     * @brief Hands a device change to the watch worker; called from endpoint callbacks.
+     */
+    void WasapiBackend::queueWatch(const std::wstring &deviceId, bool watch)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            if (m_queueStop)
+                return;
+            m_watchQueue.emplace_back(deviceId, watch);
+        }
+        m_queueWake.notify_one();
+    }
+
+    /**
+     * @brief Watch worker: applies queued device changes in order until stopNotifications().
+     */
+    void WasapiBackend::runWatches()
+    {
+        const HRESULT init = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+        std::unique_lock<std::mutex> lock(m_queueMutex);
+        for (;;)
+        {
+            m_queueWake.wait(lock, [this]
+                             { return m_queueStop || !m_watchQueue.empty(); });
+            if (m_queueStop)
+                break;
+
+            std::pair<std::wstring, bool> change = std::move(m_watchQueue.front());
+            m_watchQueue.pop_front();
+            lock.unlock();
+            if (change.second)
+                watchVolume(change.first);
+            else
+                unwatchVolume(change.first);
+            lock.lock();
+        }
+        lock.unlock();
+
+        if (SUCCEEDED(init))
+            CoUninitialize();
+    }
+}
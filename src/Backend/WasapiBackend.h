@@ -0,0 +1,89 @@
+#pragma once
+
+// Internal header: Core Audio implementation of IAudioBackend (Windows only). Not part of the public API.
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include "Backend/AudioBackend.h"
+#include "ListenerSet.h"
+
+struct IAudioEndpointVolume;
+
+namespace Backend
+{
+    /**
+     * @brief IAudioBackend over MMDeviceEnumerator, the property store, IAudioClient,
+     *        IAudioEndpointVolume and the undocumented IPolicyConfig.
+     *
+     * Calls create and release their own COM objects, so the calling thread must
+     * have COM initialized. While at least one listener is registered the backend
+     * keeps an IMMNotificationClient registered, plus an IAudioEndpointVolumeCallback
+     * on every active endpoint. Endpoint callbacks only queue the device ID and
+     * forward the event; a worker thread (re)registers the volume callbacks, since
+     * IMMNotificationClient methods must not block on COM activation.
+     */
+    class WasapiBackend : public IAudioBackend
+    {
+    public:
+        WasapiBackend() = default;
+        ~WasapiBackend() override;
+
+        // Non-copyable: owns the notification registrations
+        WasapiBackend(const WasapiBackend &) = delete;
+        WasapiBackend &operator=(const WasapiBackend &) = delete;
+
+        const char *name() const override { return "wasapi"; }
+
+        HRESULT enumerateDevices(EDataFlow flow, const DeviceVisitor &visit) override;
+        HRESULT enumerateDevicesByState(EDataFlow flow, DWORD stateMask, const DeviceStateVisitor &visit) override;
+        HRESULT getDevice(const std::wstring &deviceId, IMMDevice **device) override;
+        HRESULT getDefaultDevice(EDataFlow flow, ERole role, IMMDevice **device) override;
+        HRESULT setDefaultDevice(const std::wstring &deviceId, uint32_t roles) override;
+        HRESULT getFriendlyName(IMMDevice *device, std::wstring &name) override;
+        HRESULT getDeviceState(IMMDevice *device, DWORD &state) override;
+        HRESULT getMixFormat(IMMDevice *device, Utility::DeviceFormatInfo &format) override;
+        HRESULT getFormFactor(IMMDevice *device, EndpointFormFactor &formFactor) override;
+        HRESULT getDeviceDescription(IMMDevice *device, std::wstring &description) override;
+        HRESULT getMute(IMMDevice *device, bool &mute) override;
+        HRESULT setMute(IMMDevice *device, bool mute) override;
+        HRESULT getVolume(IMMDevice *device, float &volume) override;
+        HRESULT setVolume(IMMDevice *device, float volume) override;
+        HRESULT registerListener(IDeviceListener *listener) override;
+        HRESULT unregisterListener(IDeviceListener *listener) override;
+
+    private:
+        class NotificationClient;
+        class VolumeCallback;
+
+        struct VolumeWatch
+        {
+            IAudioEndpointVolume *volume = nullptr;
+            VolumeCallback *callback = nullptr;
+        };
+
+        HRESULT startNotifications();
+        void stopNotifications();
+        void watchVolume(const std::wstring &deviceId);
+        void unwatchVolume(const std::wstring &deviceId);
+        void queueWatch(const std::wstring &deviceId, bool watch);
+        void runWatches();
+
+        ListenerSet m_listeners;
+        std::mutex m_registrationMutex; ///< Serialises start/stop of the registrations
+        std::mutex m_watchMutex;        ///< Guards the members below (taken by the watch worker)
+        IMMDeviceEnumerator *m_notifyEnum = nullptr;
+        NotificationClient *m_client = nullptr;
+        std::map<std::wstring, VolumeWatch> m_volumeWatches;
+
+        std::mutex m_queueMutex; ///< Guards the queue below; held only to push or pop
+        std::condition_variable m_queueWake;
+        std::deque<std::pair<std::wstring, bool>> m_watchQueue; ///< Device ID, watch (true) or unwatch
+        bool m_queueStop = false;
+        std::thread m_watchThread;
+    };
+}
@@ -0,0 +1,492 @@
+#include "WasapiSessionBackend.h"
+#include "Utility/Instrumentation.h"
+#include "Utility/SafeRelease.h"
+
+#include <windows.h>
+#include <mmdeviceapi.h>
+#include <audiopolicy.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace Backend
+{
+    using Utility::SafeRelease;
+
+    namespace
+    {
+        SessionState ToSessionState(AudioSessionState state)
+        {
+            switch (state)
+            {
+            case AudioSessionStateActive:
+                return SessionState::Active;
+            case AudioSessionStateExpired:
+                return SessionState::Expired;
+            default:
+                return SessionState::Inactive;
+            }
+        }
+
+        /**
+         * @brief File name of a process image ("Teams.exe"); empty if it cannot be queried.
+         */
+        std::wstring ProcessImageName(DWORD processId)
+        {
+            if (processId == 0)
+                return std::wstring();
+
+            HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+            if (!process)
+                return std::wstring();
+
+            wchar_t path[MAX_PATH];
+            DWORD size = MAX_PATH;
+            std::wstring name;
+            if (QueryFullProcessImageNameW(process, 0, path, &size))
+            {
+                name.assign(path, size);
+                const size_t slash = name.find_last_of(L"\\/");
+                if (slash != std::wstring::npos)
+                    name.erase(0, slash + 1);
+            }
+            CloseHandle(process);
+            return name;
+        }
+
+        /**
+         * @brief Session volume over a cached ISimpleAudioVolume (reference owned).
+         */
+        class SimpleVolume : public ISessionVolume
+        {
+        public:
+            explicit SimpleVolume(ISimpleAudioVolume *volume) : m_volume(volume) {}
+            ~SimpleVolume() override { SafeRelease(m_volume); }
+
+            // Owns a COM reference: not copyable
+            SimpleVolume(const SimpleVolume &) = delete;
+            SimpleVolume &operator=(const SimpleVolume &) = delete;
+
+            HRESULT getVolume(float &volume) override
+            {
+                return AUDIO_SWITCHER_TIME_CALL("ISimpleAudioVolume::GetMasterVolume", m_volume->GetMasterVolume(&volume));
+            }
+
+            HRESULT setVolume(float volume) override
+            {
+                if (volume < 0.0f || volume > 1.0f)
+                    return E_INVALIDARG;
+                return AUDIO_SWITCHER_TIME_CALL("ISimpleAudioVolume::SetMasterVolume", m_volume->SetMasterVolume(volume, nullptr));
+            }
+
+            HRESULT getMute(bool &mute) override
+            {
+                BOOL muted = FALSE;
+                const HRESULT hr = AUDIO_SWITCHER_TIME_CALL("ISimpleAudioVolume::GetMute", m_volume->GetMute(&muted));
+                mute = SUCCEEDED(hr) && muted;
+                return hr;
+            }
+
+            HRESULT setMute(bool mute) override
+            {
+                return AUDIO_SWITCHER_TIME_CALL("ISimpleAudioVolume::SetMute", m_volume->SetMute(mute ? TRUE : FALSE, nullptr));
+            }
+
+        private:
+            ISimpleAudioVolume *m_volume;
+        };
+
+        /**
+         * @brief Reads a session's identity, state and volume, and wraps its ISimpleAudioVolume.
+         */
+        HRESULT ReadSession(const std::wstring &deviceId, IAudioSessionControl *control, SessionInfo &info,
+                            std::shared_ptr<ISessionVolume> &volume)
+        {
+            IAudioSessionControl2 *control2 = nullptr;
+            HRESULT hr = control->QueryInterface(__uuidof(IAudioSessionControl2), reinterpret_cast<void **>(&control2));
+            if (FAILED(hr) || !control2)
+                return FAILED(hr) ? hr : E_POINTER;
+
+            info.deviceId = deviceId;
+
+            LPWSTR text = nullptr;
+            hr = AUDIO_SWITCHER_TIME_CALL("IAudioSessionControl2::GetSessionInstanceIdentifier",
+                                          control2->GetSessionInstanceIdentifier(&text));
+            if (SUCCEEDED(hr) && text)
+                info.instanceId = text;
+            CoTaskMemFree(text);
+
+            // AUDCLNT_S_NO_SINGLE_PROCESS (cross-process session) still reports a process
+            DWORD processId = 0;
+            if (SUCCEEDED(AUDIO_SWITCHER_TIME_CALL("IAudioSessionControl2::GetProcessId", control2->GetProcessId(&processId))))
+                info.processId = processId;
+            info.executable = ProcessImageName(info.processId);
+
+            text = nullptr;
+            if (SUCCEEDED(control->GetDisplayName(&text)) && text)
+                info.displayName = text;
+            CoTaskMemFree(text);
+
+            AudioSessionState state = AudioSessionStateInactive;
+            if (SUCCEEDED(control->GetState(&state)))
+                info.state = ToSessionState(state);
+            SafeRelease(control2);
+
+            if (FAILED(hr) || info.instanceId.empty())
+                return FAILED(hr) ? hr : E_FAIL;
+
+            ISimpleAudioVolume *simple = nullptr;
+            hr = control->QueryInterface(__uuidof(ISimpleAudioVolume), reinterpret_cast<void **>(&simple));
+            if (FAILED(hr) || !simple)
+                return FAILED(hr) ? hr : E_POINTER;
+
+            BOOL muted = FALSE;
+            simple->GetMasterVolume(&info.volume);
+            simple->GetMute(&muted);
+            info.muted = muted != FALSE;
+            volume = std::make_shared<SimpleVolume>(simple);
+            return S_OK;
+        }
+
+        HRESULT ActivateSessionManager(const std::wstring &deviceId, IAudioSessionManager2 **manager)
+        {
+            IMMDeviceEnumerator *pEnum = nullptr;
+            HRESULT hr = AUDIO_SWITCHER_TIME_CALL("CoCreateInstance(MMDeviceEnumerator)",
+                                                  CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                                                                   __uuidof(IMMDeviceEnumerator), (void **)&pEnum));
+            if (FAILED(hr) || !pEnum)
+                return FAILED(hr) ? hr : E_POINTER;
+
+            IMMDevice *device = nullptr;
+            hr = AUDIO_SWITCHER_TIME_CALL("IMMDeviceEnumerator::GetDevice", pEnum->GetDevice(deviceId.c_str(), &device));
+            SafeRelease(pEnum);
+            if (FAILED(hr) || !device)
+                return FAILED(hr) ? hr : E_POINTER;
+
+            hr = AUDIO_SWITCHER_TIME_CALL("IMMDevice::Activate(IAudioSessionManager2)",
+                                          device->Activate(__uuidof(IAudioSessionManager2), CLSCTX_ALL, nullptr,
+                                                           reinterpret_cast<void **>(manager)));
+            SafeRelease(device);
+            if (SUCCEEDED(hr) && !*manager)
+                hr = E_POINTER;
+            return hr;
+        }
+    }
+
+    /**
+     * @brief IAudioSessionNotification of one endpoint: reports new sessions.
+     */
+    class WasapiSessionBackend::SessionNotification : public IAudioSessionNotification
+    {
+    public:
+        SessionNotification(WasapiSessionBackend *owner, const std::wstring &deviceId) : m_owner(owner), m_deviceId(deviceId) {}
+
+        ULONG STDMETHODCALLTYPE AddRef() override { return ++m_refs; }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            const ULONG refs = --m_refs;
+            if (refs == 0)
+                delete this;
+            return refs;
+        }
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **object) override
+        {
+            if (!object)
+                return E_POINTER;
+            if (riid == __uuidof(IUnknown) || riid == __uuidof(IAudioSessionNotification))
+            {
+                *object = static_cast<IAudioSessionNotification *>(this);
+                AddRef();
+                return S_OK;
+            }
+            *object = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        HRESULT STDMETHODCALLTYPE OnSessionCreated(IAudioSessionControl *control) override
+        {
+            if (control)
+                m_owner->sessionCreated(m_deviceId, control);
+            return S_OK;
+        }
+
+    private:
+        std::atomic<ULONG> m_refs{1};
+        WasapiSessionBackend *m_owner;
+        std::wstring m_deviceId;
+    };
+
+    /**
+     * @brief IAudioSessionEvents of one session: state, volume and disconnection.
+     */
+    class WasapiSessionBackend::SessionEvents : public IAudioSessionEvents
+    {
+    public:
+        SessionEvents(WasapiSessionBackend *owner, const std::wstring &deviceId, const std::wstring &instanceId)
+            : m_owner(owner), m_deviceId(deviceId), m_instanceId(instanceId) {}
+
+        ULONG STDMETHODCALLTYPE AddRef() override { return ++m_refs; }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            const ULONG refs = --m_refs;
+            if (refs == 0)
+                delete this;
+            return refs;
+        }
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **object) override
+        {
+            if (!object)
+                return E_POINTER;
+            if (riid == __uuidof(IUnknown) || riid == __uuidof(IAudioSessionEvents))
+            {
+                *object = static_cast<IAudioSessionEvents *>(this);
+                AddRef();
+                return S_OK;
+            }
+            *object = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        HRESULT STDMETHODCALLTYPE OnStateChanged(AudioSessionState state) override
+        {
+            const SessionState sessionState = ToSessionState(state);
+            m_owner->notify(m_deviceId, [&](ISessionListener &listener)
+                            { listener.onSessionStateChanged(m_instanceId, sessionState); });
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE OnSimpleVolumeChanged(float volume, BOOL muted, LPCGUID) override
+        {
+            m_owner->notify(m_deviceId, [&](ISessionListener &listener)
+                            { listener.onSessionVolumeChanged(m_instanceId, volume, muted != FALSE); });
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE OnSessionDisconnected(AudioSessionDisconnectReason) override
+        {
+            m_owner->notify(m_deviceId, [&](ISessionListener &listener)
+                            { listener.onSessionDisconnected(m_instanceId); });
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE OnDisplayNameChanged(LPCWSTR, LPCGUID) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE OnIconPathChanged(LPCWSTR, LPCGUID) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE OnChannelVolumeChanged(DWORD, float[], DWORD, LPCGUID) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE OnGroupingParamChanged(LPCGUID, LPCGUID) override { return S_OK; }
+
+    private:
+        std::atomic<ULONG> m_refs{1};
+        WasapiSessionBackend *m_owner;
+        std::wstring m_deviceId;
+        std::wstring m_instanceId;
+    };
+
+    WasapiSessionBackend::~WasapiSessionBackend()
+    {
+        std::map<std::wstring, Watch> watches;
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            watches.swap(m_watches);
+        }
+        for (auto &entry : watches)
+            stopWatch(entry.second);
+    }
+
+    /**
+     * @brief Enumerates the sessions of an endpoint through a fresh session manager.
+     */
+    HRESULT WasapiSessionBackend::enumerateSessions(const std::wstring &deviceId, const SessionVisitor &visit)
+    {
+        IAudioSessionManager2 *manager = nullptr;
+        HRESULT hr = ActivateSessionManager(deviceId, &manager);
+        if (FAILED(hr))
+            return hr;
+
+        IAudioSessionEnumerator *sessions = nullptr;
+        hr = AUDIO_SWITCHER_TIME_CALL("IAudioSessionManager2::GetSessionEnumerator", manager->GetSessionEnumerator(&sessions));
+        if (FAILED(hr) || !sessions)
+        {
+            SafeRelease(manager);
+            return FAILED(hr) ? hr : E_POINTER;
+        }
+
+        int count = 0;
+        sessions->GetCount(&count);
+        for (int i = 0; i < count; ++i)
+        {
+            IAudioSessionControl *control = nullptr;
+            if (FAILED(AUDIO_SWITCHER_TIME_CALL("IAudioSessionEnumerator::GetSession", sessions->GetSession(i, &control))) || !control)
+                continue;
+
+            SessionInfo info;
+            std::shared_ptr<ISessionVolume> volume;
+            if (SUCCEEDED(ReadSession(deviceId, control, info, volume)) && info.state != SessionState::Expired)
+                visit(info, volume);
+            SafeRelease(control);
+        }
+
+        SafeRelease(sessions);
+        SafeRelease(manager);
+        return S_OK;
+    }
+
+    HRESULT WasapiSessionBackend::registerListener(const std::wstring &deviceId, ISessionListener *listener)
+    {
+        if (!listener)
+            return E_POINTER;
+
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        auto it = m_watches.find(deviceId);
+        if (it == m_watches.end())
+        {
+            Watch watch;
+            const HRESULT hr = startWatch(deviceId, watch);
+            if (FAILED(hr))
+                return hr;
+            it = m_watches.emplace(deviceId, std::move(watch)).first;
+        }
+
+        std::vector<ISessionListener *> &listeners = it->second.listeners;
+        if (std::find(listeners.begin(), listeners.end(), listener) != listeners.end())
+            return S_FALSE;
+        listeners.push_back(listener);
+        return S_OK;
+    }
+
+    /**
+     * @brief Removes a listener; the last one for an endpoint also drops its registrations.
+     *
+     * The COM unregistrations run outside the lock: they wait for running callbacks,
+     * which take it.
+     */
+    HRESULT WasapiSessionBackend::unregisterListener(const std::wstring &deviceId, ISessionListener *listener)
+    {
+        Watch stopped;
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            auto it = m_watches.find(deviceId);
+            if (it == m_watches.end())
+                return E_NOTFOUND;
+            std::vector<ISessionListener *> &listeners = it->second.listeners;
+            auto found = std::find(listeners.begin(), listeners.end(), listener);
+            if (found == listeners.end())
+                return E_NOTFOUND;
+            listeners.erase(found);
+            if (!listeners.empty())
+                return S_OK;
+            stopped = std::move(it->second);
+            m_watches.erase(it);
+        }
+        stopWatch(stopped);
+        return S_OK;
+    }
+
+    /**
+     * @brief Registers for new sessions of an endpoint and for the events of the existing ones.
+     *
+     * Session notifications only start once the manager's enumerator has been
+     * requested, which the walk over the existing sessions does.
+     */
+    HRESULT WasapiSessionBackend::startWatch(const std::wstring &deviceId, Watch &watch)
+    {
+        HRESULT hr = ActivateSessionManager(deviceId, &watch.manager);
+        if (FAILED(hr))
+            return hr;
+
+        watch.notification = new SessionNotification(this, deviceId);
+        hr = AUDIO_SWITCHER_TIME_CALL("IAudioSessionManager2::RegisterSessionNotification",
+                                      watch.manager->RegisterSessionNotification(watch.notification));
+        if (FAILED(hr))
+        {
+            SafeRelease(watch.notification);
+            SafeRelease(watch.manager);
+            return hr;
+        }
+
+        IAudioSessionEnumerator *sessions = nullptr;
+        if (SUCCEEDED(watch.manager->GetSessionEnumerator(&sessions)) && sessions)
+        {
+            int count = 0;
+            sessions->GetCount(&count);
+            for (int i = 0; i < count; ++i)
+            {
+                IAudioSessionControl *control = nullptr;
+                if (FAILED(sessions->GetSession(i, &control)) || !control)
+                    continue;
+
+                IAudioSessionControl2 *control2 = nullptr;
+                LPWSTR instance = nullptr;
+                if (SUCCEEDED(control->QueryInterface(__uuidof(IAudioSessionControl2), reinterpret_cast<void **>(&control2))) &&
+                    SUCCEEDED(control2->GetSessionInstanceIdentifier(&instance)) && instance)
+                    watchSession(watch, deviceId, instance, control);
+                CoTaskMemFree(instance);
+                SafeRelease(control2);
+                SafeRelease(control);
+            }
+            SafeRelease(sessions);
+        }
+        return S_OK;
+    }
+
+    void WasapiSessionBackend::stopWatch(Watch &watch)
+    {
+        for (auto &entry : watch.sessions)
+        {
+            entry.second.control->UnregisterAudioSessionNotification(entry.second.events);
+            SafeRelease(entry.second.events);
+            SafeRelease(entry.second.control);
+        }
+        watch.sessions.clear();
+
+        if (watch.manager && watch.notification)
+            watch.manager->UnregisterSessionNotification(watch.notification);
+        SafeRelease(watch.notification);
+        SafeRelease(watch.manager);
+    }
+
+    /**
+     * @brief Registers an IAudioSessionEvents on a session not seen before (keeps the control).
+     */
+    void WasapiSessionBackend::watchSession(Watch &watch, const std::wstring &deviceId, const std::wstring &instanceId,
+                                            IAudioSessionControl *control)
+    {
+        if (watch.sessions.count(instanceId))
+            return;
+
+        SessionWatch session;
+        session.events = new SessionEvents(this, deviceId, instanceId);
+        if (FAILED(control->RegisterAudioSessionNotification(session.events)))
+        {
+            SafeRelease(session.events);
+            return;
+        }
+        control->AddRef();
+        session.control = control;
+        watch.sessions.emplace(instanceId, session);
+    }
+
+    /**
+     * @brief IAudioSessionNotification callback: watches the new session and reports it.
+     */
+    void WasapiSessionBackend::sessionCreated(const std::wstring &deviceId, IAudioSessionControl *control)
+    {
+        SessionInfo info;
+        std::shared_ptr<ISessionVolume> volume;
+        if (FAILED(ReadSession(deviceId, control, info, volume)))
+            return;
+
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        auto it = m_watches.find(deviceId);
+        if (it == m_watches.end())
+            return;
+        watchSession(it->second, deviceId, info.instanceId, control);
+        for (size_t i = 0; i < it->second.listeners.size(); ++i)
+            it->second.listeners[i]->onSessionCreated(info, volume);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+// Internal header: Core Audio implementation of ISessionBackend (Windows only). Not part of the public API.
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Backend/SessionBackend.h"
+
+struct IAudioSessionManager2;
+struct IAudioSessionControl;
+
+namespace Backend
+{
+    /**
+     * @brief ISessionBackend over IAudioSessionManager2, IAudioSessionControl2 and ISimpleAudioVolume.
+     *
+     * While a listener is registered for an endpoint the backend keeps that
+     * endpoint's session manager with an IAudioSessionNotification, plus an
+     * IAudioSessionEvents on every session it has seen. The calling thread must
+     * have COM initialized.
+     */
+    class WasapiSessionBackend : public ISessionBackend
+    {
+    public:
+        WasapiSessionBackend() = default;
+        ~WasapiSessionBackend() override;
+
+        // Non-copyable: owns the notification registrations
+        WasapiSessionBackend(const WasapiSessionBackend &) = delete;
+        WasapiSessionBackend &operator=(const WasapiSessionBackend &) = delete;
+
+        const char *name() const override { return "wasapi"; }
+
+        HRESULT enumerateSessions(const std::wstring &deviceId, const SessionVisitor &visit) override;
+        HRESULT registerListener(const std::wstring &deviceId, ISessionListener *listener) override;
+        HRESULT unregisterListener(const std::wstring &deviceId, ISessionListener *listener) override;
+
+    private:
+        class SessionNotification;
+        class SessionEvents;
+
+        struct SessionWatch
+        {
+            IAudioSessionControl *control = nullptr;
+            SessionEvents *events = nullptr;
+        };
+
+        struct Watch
+        {
+            IAudioSessionManager2 *manager = nullptr;
+            SessionNotification *notification = nullptr;
+            std::map<std::wstring, SessionWatch> sessions; ///< By instance ID
+            std::vector<ISessionListener *> listeners;
+        };
+
+        HRESULT startWatch(const std::wstring &deviceId, Watch &watch);
+        static void stopWatch(Watch &watch);
+        void watchSession(Watch &watch, const std::wstring &deviceId, const std::wstring &instanceId,
+                          IAudioSessionControl *control);
+        void sessionCreated(const std::wstring &deviceId, IAudioSessionControl *control);
+
+        template <typename F>
+        void notify(const std::wstring &deviceId, F &&f)
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            auto it = m_watches.find(deviceId);
+            if (it == m_watches.end())
+                return;
+            for (size_t i = 0; i < it->second.listeners.size(); ++i)
+                f(*it->second.listeners[i]);
+        }
+
+        std::recursive_mutex m_mutex; ///< Guards m_watches; held while dispatching
+        std::map<std::wstring, Watch> m_watches;
+    };
+}
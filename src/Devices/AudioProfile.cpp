@@ -0,0 +1,223 @@
+#include "Devices/AudioProfile.h"
+#include "Utility/StringConvert.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace Devices
+{
+    namespace
+    {
+        constexpr uint32_t kMagic = 0x46505741; // "AWPF"
+        constexpr uint16_t kVersion = 1;
+        constexpr size_t kHeaderSize = 32;
+
+        constexpr uint8_t kFlagVolume = 1;
+        constexpr uint8_t kFlagMute = 2;
+        constexpr uint8_t kFlagMuted = 4;
+
+        uint64_t Fnv1a(const uint8_t *data, size_t size)
+        {
+            uint64_t hash = 1469598103934665603ull;
+            for (size_t i = 0; i < size; ++i)
+                hash = (hash ^ data[i]) * 1099511628211ull;
+            return hash;
+        }
+
+        void Put(std::vector<uint8_t> &out, uint64_t value, size_t bytes)
+        {
+            for (size_t i = 0; i < bytes; ++i)
+                out.push_back(static_cast<uint8_t>((value >> (8 * i)) & 0xFF));
+        }
+
+        /**
+         * @brief Appends a UTF-8 string with a 16-bit length (longer strings are cut).
+         */
+        void PutString(std::vector<uint8_t> &out, const std::string &text)
+        {
+            const size_t size = text.size() < 0xFFFF ? text.size() : 0xFFFF;
+            Put(out, size, 2);
+            out.insert(out.end(), text.begin(), text.begin() + static_cast<std::ptrdiff_t>(size));
+        }
+
+        void PutDevice(std::vector<uint8_t> &out, const ProfileDevice &device)
+        {
+            PutString(out, Utility::ToUtf8(device.id));
+            PutString(out, Utility::ToUtf8(device.name));
+        }
+
+        /**
+         * @brief Bounds-checked sequential reader over the payload.
+         */
+        class Cursor
+        {
+        public:
+            Cursor(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+
+            bool get(uint64_t &value, size_t bytes)
+            {
+                if (m_size - m_offset < bytes)
+                    return false;
+                value = 0;
+                for (size_t i = 0; i < bytes; ++i)
+                    value |= static_cast<uint64_t>(m_data[m_offset + i]) << (8 * i);
+                m_offset += bytes;
+                return true;
+            }
+
+            bool string(std::string &text)
+            {
+                uint64_t size = 0;
+                if (!get(size, 2) || m_size - m_offset < size)
+                    return false;
+                text.assign(reinterpret_cast<const char *>(m_data + m_offset), static_cast<size_t>(size));
+                m_offset += static_cast<size_t>(size);
+                return true;
+            }
+
+            bool device(ProfileDevice &device)
+            {
+                std::string id, name;
+                if (!string(id) || !string(name))
+                    return false;
+                device.id = Utility::FromUtf8(id);
+                device.name = Utility::FromUtf8(name);
+                return true;
+            }
+
+            bool done() const { return m_offset == m_size; }
+
+        private:
+            const uint8_t *m_data;
+            size_t m_size;
+            size_t m_offset = 0;
+        };
+    }
+
+    /**
+     * @brief Serialises the profiles and atomically replaces the file.
+     */
+    bool SaveProfiles(const std::filesystem::path &path, const std::vector<AudioProfile> &profiles)
+    {
+        std::vector<uint8_t> payload;
+        for (const AudioProfile &profile : profiles)
+        {
+            PutString(payload, profile.name);
+            for (const auto &flow : profile.defaults)
+                for (const ProfileDevice &device : flow)
+                    PutDevice(payload, device);
+
+            Put(payload, profile.endpoints.size(), 2);
+            for (const ProfileEndpoint &endpoint : profile.endpoints)
+            {
+                PutDevice(payload, endpoint.device);
+                uint32_t volume = 0;
+                std::memcpy(&volume, &endpoint.volume, sizeof(volume));
+                Put(payload, endpoint.flow == eCapture ? 1 : 0, 1);
+                Put(payload, (endpoint.hasVolume ? kFlagVolume : 0) | (endpoint.hasMute ? kFlagMute : 0) |
+                                 (endpoint.muted ? kFlagMuted : 0), 1);
+                Put(payload, volume, 4);
+            }
+        }
+
+        std::vector<uint8_t> image;
+        image.reserve(kHeaderSize + payload.size());
+        Put(image, kMagic, 4);
+        Put(image, kVersion, 2);
+        Put(image, kHeaderSize, 2);
+        Put(image, profiles.size(), 4);
+        Put(image, payload.size(), 4);
+        Put(image, Fnv1a(payload.data(), payload.size()), 8);
+        image.resize(kHeaderSize, 0);
+        image.insert(image.end(), payload.begin(), payload.end());
+
+        std::filesystem::path temp = path;
+        temp += ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out)
+                return false;
+            out.write(reinterpret_cast<const char *>(image.data()), static_cast<std::streamsize>(image.size()));
+            out.flush();
+            if (!out)
+                return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reads and validates the whole file; `profiles` is only replaced on success.
+     */
+    CacheStatus LoadProfiles(const std::filesystem::path &path, std::vector<AudioProfile> &profiles)
+    {
+        std::error_code ec;
+        if (!std::filesystem::exists(path, ec))
+            return CacheStatus::Missing;
+
+        std::ifstream in(path, std::ios::binary);
+        const std::vector<uint8_t> image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (!in.eof() && in.fail())
+            return CacheStatus::Corrupt;
+
+        Cursor header(image.data(), image.size() < kHeaderSize ? image.size() : kHeaderSize);
+        uint64_t magic = 0, version = 0, headerSize = 0, count = 0, payloadSize = 0, checksum = 0;
+        if (!header.get(magic, 4) || magic != kMagic || !header.get(version, 2))
+            return CacheStatus::Corrupt;
+        if (version != kVersion)
+            return CacheStatus::Stale;
+        if (!header.get(headerSize, 2) || !header.get(count, 4) || !header.get(payloadSize, 4) || !header.get(checksum, 8) ||
+            headerSize != kHeaderSize || image.size() != kHeaderSize + payloadSize ||
+            Fnv1a(image.data() + kHeaderSize, static_cast<size_t>(payloadSize)) != checksum)
+            return CacheStatus::Corrupt;
+
+        Cursor cursor(image.data() + kHeaderSize, static_cast<size_t>(payloadSize));
+        std::vector<AudioProfile> loaded;
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            AudioProfile profile;
+            if (!cursor.string(profile.name))
+                return CacheStatus::Corrupt;
+            for (auto &flow : profile.defaults)
+                for (ProfileDevice &device : flow)
+                    if (!cursor.device(device))
+                        return CacheStatus::Corrupt;
+
+            uint64_t endpoints = 0;
+            if (!cursor.get(endpoints, 2))
+                return CacheStatus::Corrupt;
+            for (uint64_t e = 0; e < endpoints; ++e)
+            {
+                ProfileEndpoint endpoint;
+                uint64_t flow = 0, flags = 0, volume = 0;
+                if (!cursor.device(endpoint.device) || !cursor.get(flow, 1) || !cursor.get(flags, 1) || !cursor.get(volume, 4) ||
+                    flow > 1)
+                    return CacheStatus::Corrupt;
+                const uint32_t bits = static_cast<uint32_t>(volume);
+                endpoint.flow = flow ? eCapture : eRender;
+                endpoint.hasVolume = (flags & kFlagVolume) != 0;
+                endpoint.hasMute = (flags & kFlagMute) != 0;
+                endpoint.muted = (flags & kFlagMuted) != 0;
+                std::memcpy(&endpoint.volume, &bits, sizeof(bits));
+                if (endpoint.hasVolume && !(endpoint.volume >= 0.0f && endpoint.volume <= 1.0f))
+                    return CacheStatus::Corrupt;
+                profile.endpoints.push_back(std::move(endpoint));
+            }
+            loaded.push_back(std::move(profile));
+        }
+        if (!cursor.done())
+            return CacheStatus::Corrupt;
+
+        profiles.swap(loaded);
+        return CacheStatus::Loaded;
+    }
+}
@@ -0,0 +1,204 @@
+#include "Devices/DeviceDirectory.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace Devices
+{
+    /**
+     * @brief Destructor - waits for reconciliation to finish.
+     */
+    DeviceDirectory::~DeviceDirectory()
+    {
+        stop();
+    }
+
+    /**
+     * @brief Publishes the cached list and launches the reconcile thread.
+     *
+     * The mapping is closed once the records are decoded so the background thread can
+     * replace the file.
+     *
+     * @param cachePath Cache file.
+     * @param enumerate Live enumerator.
+     * @param onChange Called after the list changed.
+     * @return CacheStatus Outcome of opening the cache.
+     */
+    CacheStatus DeviceDirectory::start(const std::filesystem::path &cachePath, DeviceEnumerator enumerate,
+                                       std::function<void()> onChange)
+    {
+        stop();
+
+        const auto begin = std::chrono::steady_clock::now();
+
+        DeviceMetadataCache cache;
+        const CacheStatus status = cache.open(cachePath);
+        auto cached = std::make_shared<std::vector<DeviceRecord>>();
+        if (status == CacheStatus::Loaded)
+            *cached = cache.records();
+        cache.close();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_path = cachePath;
+            m_devices = std::move(cached);
+            m_fromCache = status == CacheStatus::Loaded;
+            m_finished = false;
+            m_stats = DeviceDirectoryStats();
+            m_stats.cacheStatus = status;
+            m_stats.cacheLoadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        }
+
+        m_thread = std::thread(&DeviceDirectory::reconcile, this, std::move(enumerate), std::move(onChange));
+        return status;
+    }
+
+    /**
+     * @brief Joins the reconcile thread (enumeration itself cannot be interrupted).
+     */
+    void DeviceDirectory::stop()
+    {
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    /**
+     * @brief Runs the live enumeration and replaces the list and the file when needed.
+     */
+    void DeviceDirectory::reconcile(DeviceEnumerator enumerate, std::function<void()> onChange)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+
+        auto live = std::make_shared<std::vector<DeviceRecord>>();
+        bool ok = false;
+        try
+        {
+            ok = enumerate && enumerate(*live);
+        }
+        catch (const std::exception &)
+        {
+            // Enumeration failed (e.g. audio service not ready): keep serving the cache
+        }
+        const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        bool changed = false;
+        bool rewrite = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.enumerateMs = elapsed;
+            if (ok)
+            {
+                changed = *m_devices != *live;
+                rewrite = changed || m_stats.cacheStatus != CacheStatus::Loaded;
+                if (changed)
+                    m_devices = live;
+                m_fromCache = false;
+            }
+        }
+
+        // The file is written outside the lock; queries keep using the published list
+        const bool written = rewrite && DeviceMetadataCache::write(m_path, *live);
+
+        // Listeners run before waiters are released, so waitReconciled() implies they were notified
+        if (changed && onChange)
+            onChange();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.reconciled = ok;
+            m_stats.changed = changed;
+            m_stats.cacheWritten = written;
+            m_finished = true;
+        }
+        m_done.notify_all();
+    }
+
+    /**
+     * @brief Copies the current list.
+     */
+    std::vector<DeviceRecord> DeviceDirectory::devices() const
+    {
+        std::shared_ptr<const std::vector<DeviceRecord>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            snapshot = m_devices;
+        }
+        return snapshot ? *snapshot : std::vector<DeviceRecord>();
+    }
+
+    /**
+     * @brief Copies the current devices of one flow.
+     */
+    std::vector<DeviceRecord> DeviceDirectory::devices(DeviceFlow flow) const
+    {
+        std::vector<DeviceRecord> result;
+        for (DeviceRecord &record : devices())
+            if (record.flow == flow)
+                result.push_back(std::move(record));
+        return result;
+    }
+
+    /**
+     * @brief Looks a device up by ID in the current list.
+     */
+    bool DeviceDirectory::find(const std::wstring &id, DeviceRecord &out) const
+    {
+        std::shared_ptr<const std::vector<DeviceRecord>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            snapshot = m_devices;
+        }
+        if (!snapshot)
+            return false;
+
+        for (const DeviceRecord &record : *snapshot)
+        {
+            if (record.id == id)
+            {
+                out = record;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Waits on the completion condition.
+     *
+     * @param timeout Maximum wait.
+     * @return true if live enumeration succeeded.
+     */
+    bool DeviceDirectory::waitReconciled(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait_for(lock, timeout, [this]() { return m_finished; });
+        return m_finished && m_stats.reconciled;
+    }
+
+    /**
+     * @brief Whether live enumeration has completed successfully.
+     */
+    bool DeviceDirectory::isReconciled() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_finished && m_stats.reconciled;
+    }
+
+    /**
+     * @brief Whether the list still comes from the cache file.
+     */
+    bool DeviceDirectory::fromCache() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_fromCache;
+    }
+
+    /**
+     * @brief Copies the statistics.
+     */
+    DeviceDirectoryStats DeviceDirectory::stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+}
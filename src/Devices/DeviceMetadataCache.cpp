@@ -0,0 +1,329 @@
+#include "Devices/DeviceMetadataCache.h"
+
+#include <fstream>
+#include <system_error>
+
+namespace Devices
+{
+    namespace
+    {
+        constexpr uint32_t kMagic = 0x4D445741; // "AWDM"
+        constexpr size_t kHeaderSize = 32;
+        constexpr size_t kRecordSize = 32;
+
+        constexpr uint8_t kFlagFormatValid = 1;
+        constexpr uint8_t kFlagFloat = 2;
+        constexpr uint8_t kFlagDefault = 4;
+        constexpr unsigned kStateShift = 4; ///< DEVICE_STATE_* in the high nibble of the flags
+
+        uint64_t Fnv1a(const uint8_t *data, size_t size)
+        {
+            uint64_t hash = 1469598103934665603ull;
+            for (size_t i = 0; i < size; ++i)
+                hash = (hash ^ data[i]) * 1099511628211ull;
+            return hash;
+        }
+
+        // Unaligned little-endian access into the mapping
+
+        uint64_t Load(const uint8_t *p, size_t bytes)
+        {
+            uint64_t value = 0;
+            for (size_t i = 0; i < bytes; ++i)
+                value |= static_cast<uint64_t>(p[i]) << (8 * i);
+            return value;
+        }
+
+        void Store(std::vector<uint8_t> &out, size_t offset, uint64_t value, size_t bytes)
+        {
+            for (size_t i = 0; i < bytes; ++i)
+                out[offset + i] = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
+        }
+
+        /**
+         * @brief Appends a string to the table as UTF-16 and returns its length in code units.
+         */
+        uint32_t AppendUtf16(std::vector<uint8_t> &table, const std::wstring &text)
+        {
+            const size_t start = table.size();
+            auto put = [&table](uint32_t unit)
+            {
+                table.push_back(static_cast<uint8_t>(unit & 0xFF));
+                table.push_back(static_cast<uint8_t>(unit >> 8));
+            };
+
+            for (wchar_t ch : text)
+            {
+                const uint32_t code = static_cast<uint32_t>(ch);
+                if (sizeof(wchar_t) > 2 && code > 0xFFFF)
+                {
+                    put(0xD800 + ((code - 0x10000) >> 10));
+                    put(0xDC00 + ((code - 0x10000) & 0x3FF));
+                }
+                else
+                {
+                    put(code & 0xFFFF);
+                }
+            }
+
+            return static_cast<uint32_t>((table.size() - start) / 2);
+        }
+
+        std::wstring DecodeUtf16(const uint8_t *p, size_t units)
+        {
+            std::wstring text;
+            text.reserve(units);
+            for (size_t i = 0; i < units; ++i)
+            {
+                uint32_t unit = static_cast<uint32_t>(Load(p + 2 * i, 2));
+                if (sizeof(wchar_t) > 2 && unit >= 0xD800 && unit < 0xDC00 && i + 1 < units)
+                {
+                    const uint32_t low = static_cast<uint32_t>(Load(p + 2 * (i + 1), 2));
+                    if (low >= 0xDC00 && low < 0xE000)
+                    {
+                        unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                        ++i;
+                    }
+                }
+                text.push_back(static_cast<wchar_t>(unit));
+            }
+            return text;
+        }
+
+        /**
+         * @brief Compares a table string with `text` without decoding it.
+         */
+        bool EqualsUtf16(const uint8_t *p, size_t units, const std::wstring &text)
+        {
+            if (sizeof(wchar_t) > 2)
+                return DecodeUtf16(p, units) == text;
+
+            if (units != text.size())
+                return false;
+            for (size_t i = 0; i < units; ++i)
+                if (Load(p + 2 * i, 2) != static_cast<uint64_t>(text[i]))
+                    return false;
+            return true;
+        }
+    }
+
+    /**
+     * @brief Field-wise equality (the format is compared only when both are valid).
+     */
+    bool DeviceRecord::operator==(const DeviceRecord &other) const
+    {
+        if (id != other.id || name != other.name || flow != other.flow || isDefault != other.isDefault ||
+            state != other.state || format.valid != other.format.valid)
+            return false;
+        if (!format.valid)
+            return true;
+
+        return format.sampleRate == other.format.sampleRate && format.channels == other.format.channels &&
+               format.bitDepth == other.format.bitDepth && format.blockAlign == other.format.blockAlign &&
+               format.channelMask == other.format.channelMask && format.isFloat == other.format.isFloat;
+    }
+
+    /**
+     * @brief Maps the file and checks header, bounds and checksum.
+     *
+     * @param path Cache file.
+     * @return CacheStatus Loaded, or why the file cannot be used.
+     */
+    CacheStatus DeviceMetadataCache::open(const std::filesystem::path &path)
+    {
+        close();
+
+        std::error_code ec;
+        if (!std::filesystem::exists(path, ec))
+            return CacheStatus::Missing;
+        if (!m_file.open(path) || m_file.size() < kHeaderSize)
+        {
+            close();
+            return CacheStatus::Corrupt;
+        }
+
+        const uint8_t *base = m_file.data();
+        const uint64_t size = m_file.size();
+
+        if (Load(base, 4) != kMagic)
+        {
+            close();
+            return CacheStatus::Corrupt;
+        }
+        if (Load(base + 4, 2) != Version)
+        {
+            close();
+            return CacheStatus::Stale;
+        }
+
+        const uint64_t headerSize = Load(base + 6, 2);
+        const uint64_t count = Load(base + 8, 4);
+        const uint64_t recordSize = Load(base + 12, 4);
+        const uint64_t stringsOffset = Load(base + 16, 4);
+        const uint64_t stringsSize = Load(base + 20, 4);
+        const uint64_t checksum = Load(base + 24, 8);
+
+        if (headerSize != kHeaderSize || recordSize != kRecordSize ||
+            stringsOffset != kHeaderSize + count * kRecordSize || stringsOffset + stringsSize != size ||
+            Fnv1a(base + kHeaderSize, static_cast<size_t>(size - kHeaderSize)) != checksum)
+        {
+            close();
+            return CacheStatus::Corrupt;
+        }
+
+        m_records = base + kHeaderSize;
+        m_strings = base + stringsOffset;
+        m_count = static_cast<size_t>(count);
+        m_stringsSize = static_cast<size_t>(stringsSize);
+
+        // String references are validated once so record() can trust them
+        for (size_t i = 0; i < m_count; ++i)
+        {
+            const uint8_t *r = m_records + i * kRecordSize;
+            const uint64_t idEnd = Load(r, 4) + 2 * Load(r + 4, 4);
+            const uint64_t nameEnd = Load(r + 8, 4) + 2 * Load(r + 12, 4);
+            if (idEnd > m_stringsSize || nameEnd > m_stringsSize || r[30] > static_cast<uint8_t>(DeviceFlow::Capture))
+            {
+                close();
+                return CacheStatus::Corrupt;
+            }
+        }
+
+        return CacheStatus::Loaded;
+    }
+
+    /**
+     * @brief Releases the mapping.
+     */
+    void DeviceMetadataCache::close()
+    {
+        m_file.close();
+        m_records = nullptr;
+        m_strings = nullptr;
+        m_count = 0;
+        m_stringsSize = 0;
+    }
+
+    /**
+     * @brief Decodes one fixed-size record and its strings.
+     *
+     * @param index Record index.
+     * @param out Destination.
+     * @return true if `index` is valid.
+     */
+    bool DeviceMetadataCache::record(size_t index, DeviceRecord &out) const
+    {
+        if (index >= m_count)
+            return false;
+
+        const uint8_t *r = m_records + index * kRecordSize;
+        out.id = DecodeUtf16(m_strings + Load(r, 4), static_cast<size_t>(Load(r + 4, 4)));
+        out.name = DecodeUtf16(m_strings + Load(r + 8, 4), static_cast<size_t>(Load(r + 12, 4)));
+
+        const uint8_t flags = r[31];
+        out.format = Utility::DeviceFormatInfo();
+        out.format.sampleRate = static_cast<uint32_t>(Load(r + 16, 4));
+        out.format.channelMask = static_cast<uint32_t>(Load(r + 20, 4));
+        out.format.bitDepth = static_cast<uint16_t>(Load(r + 24, 2));
+        out.format.channels = static_cast<uint16_t>(Load(r + 26, 2));
+        out.format.blockAlign = static_cast<uint16_t>(Load(r + 28, 2));
+        out.format.isFloat = (flags & kFlagFloat) != 0;
+        out.format.valid = (flags & kFlagFormatValid) != 0;
+        out.flow = static_cast<DeviceFlow>(r[30]);
+        out.isDefault = (flags & kFlagDefault) != 0;
+        out.state = flags >> kStateShift;
+        return true;
+    }
+
+    /**
+     * @brief Linear search over the records, decoding only the matching one.
+     */
+    bool DeviceMetadataCache::find(const std::wstring &id, DeviceRecord &out) const
+    {
+        for (size_t i = 0; i < m_count; ++i)
+        {
+            const uint8_t *r = m_records + i * kRecordSize;
+            if (EqualsUtf16(m_strings + Load(r, 4), static_cast<size_t>(Load(r + 4, 4)), id))
+                return record(i, out);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Decodes all records in file order.
+     */
+    std::vector<DeviceRecord> DeviceMetadataCache::records() const
+    {
+        std::vector<DeviceRecord> result(m_count);
+        for (size_t i = 0; i < m_count; ++i)
+            record(i, result[i]);
+        return result;
+    }
+
+    /**
+     * @brief Serialises records and atomically replaces the cache file.
+     *
+     * @param path Cache file (must not be mapped by another instance on Windows).
+     * @param records Devices to store.
+     * @return true on success.
+     */
+    bool DeviceMetadataCache::write(const std::filesystem::path &path, const std::vector<DeviceRecord> &records)
+    {
+        std::vector<uint8_t> table;
+        std::vector<uint8_t> image(kHeaderSize + records.size() * kRecordSize, 0);
+
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            const DeviceRecord &rec = records[i];
+            const size_t r = kHeaderSize + i * kRecordSize;
+
+            Store(image, r, table.size(), 4);
+            Store(image, r + 4, AppendUtf16(table, rec.id), 4);
+            Store(image, r + 8, table.size(), 4);
+            Store(image, r + 12, AppendUtf16(table, rec.name), 4);
+            Store(image, r + 16, rec.format.sampleRate, 4);
+            Store(image, r + 20, rec.format.channelMask, 4);
+            Store(image, r + 24, rec.format.bitDepth, 2);
+            Store(image, r + 26, rec.format.channels, 2);
+            Store(image, r + 28, rec.format.blockAlign, 2);
+            image[r + 30] = static_cast<uint8_t>(rec.flow);
+            image[r + 31] = static_cast<uint8_t>((rec.format.valid ? kFlagFormatValid : 0) |
+                                                 (rec.format.isFloat ? kFlagFloat : 0) |
+                                                 (rec.isDefault ? kFlagDefault : 0) |
+                                                 ((rec.state & DEVICE_STATEMASK_ALL) << kStateShift));
+        }
+
+        const size_t stringsOffset = image.size();
+        image.insert(image.end(), table.begin(), table.end());
+
+        Store(image, 0, kMagic, 4);
+        Store(image, 4, Version, 2);
+        Store(image, 6, kHeaderSize, 2);
+        Store(image, 8, records.size(), 4);
+        Store(image, 12, kRecordSize, 4);
+        Store(image, 16, stringsOffset, 4);
+        Store(image, 20, table.size(), 4);
+        Store(image, 24, Fnv1a(image.data() + kHeaderSize, image.size() - kHeaderSize), 8);
+
+        std::filesystem::path temp = path;
+        temp += ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out)
+                return false;
+            out.write(reinterpret_cast<const char *>(image.data()), static_cast<std::streamsize>(image.size()));
+            out.flush();
+            if (!out)
+                return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+}
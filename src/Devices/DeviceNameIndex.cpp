@@ -0,0 +1,437 @@
+#include "Devices/DeviceNameIndex.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Devices
+{
+    namespace
+    {
+        constexpr float kExactScore = 1.0f;
+        constexpr float kWordPrefixScore = 0.95f; ///< Query starts a word of the name
+        constexpr float kSubstringScore = 0.9f;
+        constexpr float kFuzzyWeight = 0.85f;     ///< Trigram matches rank below any substring match
+        constexpr size_t kMinIndexedQuery = 3;    ///< Shorter queries are scanned (their trigrams are all padding)
+
+        /// U+00C0..U+00FF without diacritics; '?' marks the expansions handled separately, ' ' separators.
+        constexpr wchar_t kLatin1[] = L"AAAAAA?CEEEEIIIIDNOOOOO OUUUUY??aaaaaa?ceeeeiiiidnooooo ouuuuy?y";
+
+        /// U+0100..U+017F without diacritics.
+        constexpr wchar_t kLatinExtendedA[] = L"AaAaAaCcCcCcCcDdDdEeEeEeEeEeGgGgGgGgHhHhIiIiIiIiIiIiJjKkkLlLlLlLlLlNnNnNnnNnOoOoOo??RrRrRrSsSsSsSsTtTtTtUuUuUuUuUuUuWwYyYZzZzZzs";
+
+        /**
+         * @brief Appends the folded form of one character (empty for combining marks).
+         */
+        void Fold(wchar_t c, std::wstring &out)
+        {
+            const uint32_t code = static_cast<uint32_t>(c);
+            if (code < 0x80)
+            {
+                if (c >= L'A' && c <= L'Z')
+                    out.push_back(static_cast<wchar_t>(c - L'A' + L'a'));
+                else if ((c >= L'a' && c <= L'z') || (c >= L'0' && c <= L'9'))
+                    out.push_back(c);
+                else
+                    out.push_back(L' ');
+                return;
+            }
+            if (code >= 0x300 && code <= 0x36F)
+                return; // Combining diacritical mark of a decomposed character
+
+            switch (code)
+            {
+            case 0xC6:
+            case 0xE6:
+                out += L"ae";
+                return;
+            case 0xDE:
+            case 0xFE:
+                out += L"th";
+                return;
+            case 0xDF:
+                out += L"ss";
+                return;
+            case 0x152:
+            case 0x153:
+                out += L"oe";
+                return;
+            default:
+                break;
+            }
+
+            wchar_t base = c;
+            if (code >= 0xC0 && code <= 0xFF)
+                base = kLatin1[code - 0xC0];
+            else if (code >= 0x100 && code <= 0x17F)
+                base = kLatinExtendedA[code - 0x100];
+            else if (code < 0xC0)
+                base = L' '; // Latin-1 punctuation and symbols
+
+            if (base >= L'A' && base <= L'Z')
+                base = static_cast<wchar_t>(base - L'A' + L'a');
+            out.push_back(base);
+        }
+
+        /**
+         * @brief Unique trigrams of " text " (three characters of 21 bits each).
+         */
+        std::vector<uint64_t> Trigrams(const std::wstring &text)
+        {
+            const std::wstring padded = L" " + text + L" ";
+            std::vector<uint64_t> grams;
+            for (size_t i = 0; i + 3 <= padded.size(); ++i)
+            {
+                grams.push_back((static_cast<uint64_t>(padded[i] & 0x1FFFFF) << 42) |
+                                (static_cast<uint64_t>(padded[i + 1] & 0x1FFFFF) << 21) |
+                                static_cast<uint64_t>(padded[i + 2] & 0x1FFFFF));
+            }
+            std::sort(grams.begin(), grams.end());
+            grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+            return grams;
+        }
+
+        /**
+         * @brief Exact, word-prefix or substring score of a normalised query in an entry; 0 if absent.
+         */
+        float SubstringScore(const std::wstring &text, size_t nameLength, const std::wstring &query)
+        {
+            const size_t pos = text.find(query);
+            if (pos == std::wstring::npos)
+                return 0.0f;
+            if (pos == 0 && query.size() == nameLength)
+                return kExactScore;
+            return pos == 0 || text[pos - 1] == L' ' ? kWordPrefixScore : kSubstringScore;
+        }
+    }
+
+    std::wstring NormalizeDeviceName(const std::wstring &text)
+    {
+        std::wstring folded;
+        folded.reserve(text.size());
+        for (wchar_t c : text)
+            Fold(c, folded);
+
+        // Collapse separator runs and trim
+        std::wstring out;
+        out.reserve(folded.size());
+        for (wchar_t c : folded)
+        {
+            if (c == L' ' && (out.empty() || out.back() == L' '))
+                continue;
+            out.push_back(c);
+        }
+        if (!out.empty() && out.back() == L' ')
+            out.pop_back();
+        return out;
+    }
+
+    void DeviceNameIndex::add(const std::wstring &id, const std::wstring &name, const std::wstring &description, uint32_t tag)
+    {
+        remove(id);
+
+        uint32_t slot;
+        if (!m_free.empty())
+        {
+            slot = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            slot = static_cast<uint32_t>(m_entries.size());
+            m_entries.emplace_back();
+            m_shared.push_back(0);
+        }
+
+        Entry &entry = m_entries[slot];
+        entry.id = id;
+        entry.name = name;
+        entry.text = NormalizeDeviceName(name);
+        entry.nameLength = entry.text.size();
+        const std::wstring extra = NormalizeDeviceName(description);
+        if (!extra.empty())
+            entry.text += L" " + extra;
+        entry.grams = Trigrams(entry.text);
+        entry.tag = tag;
+        entry.live = true;
+
+        for (uint64_t gram : entry.grams)
+            m_postings[gram].push_back(slot);
+        m_byId.emplace(id, slot);
+    }
+
+    bool DeviceNameIndex::remove(const std::wstring &id)
+    {
+        auto it = m_byId.find(id);
+        if (it == m_byId.end())
+            return false;
+
+        const uint32_t slot = it->second;
+        Entry &entry = m_entries[slot];
+        for (uint64_t gram : entry.grams)
+        {
+            auto posting = m_postings.find(gram);
+            if (posting == m_postings.end())
+                continue;
+            std::vector<uint32_t> &slots = posting->second;
+            auto found = std::find(slots.begin(), slots.end(), slot);
+            if (found != slots.end())
+            {
+                *found = slots.back();
+                slots.pop_back();
+            }
+            if (slots.empty())
+                m_postings.erase(posting);
+        }
+
+        entry = Entry();
+        m_free.push_back(slot);
+        m_byId.erase(it);
+        return true;
+    }
+
+    void DeviceNameIndex::clear()
+    {
+        m_entries.clear();
+        m_shared.clear();
+        m_free.clear();
+        m_byId.clear();
+        m_postings.clear();
+    }
+
+    std::vector<std::wstring> DeviceNameIndex::ids() const
+    {
+        std::vector<std::wstring> out;
+        out.reserve(m_byId.size());
+        for (const auto &entry : m_byId)
+            out.push_back(entry.first);
+        return out;
+    }
+
+    bool DeviceNameIndex::find(const std::wstring &id, std::wstring &name) const
+    {
+        auto it = m_byId.find(id);
+        if (it == m_byId.end())
+            return false;
+        name = m_entries[it->second].name;
+        return true;
+    }
+
+    /**
+     * @brief Counts shared trigrams per entry through the posting lists, then ranks.
+     */
+    std::vector<NameMatch> DeviceNameIndex::search(const std::wstring &query, size_t limit, float minScore) const
+    {
+        std::vector<NameMatch> matches;
+        const std::wstring normalized = NormalizeDeviceName(query);
+        if (normalized.empty())
+            return matches;
+
+        // Rank slots first; only the returned entries are copied out
+        struct Candidate
+        {
+            float score;
+            uint32_t slot;
+        };
+        std::vector<Candidate> candidates;
+        if (normalized.size() < kMinIndexedQuery)
+        {
+            for (uint32_t slot = 0; slot < m_entries.size(); ++slot)
+            {
+                const Entry &entry = m_entries[slot];
+                const float score = entry.live ? SubstringScore(entry.text, entry.nameLength, normalized) : 0.0f;
+                if (score > 0.0f && score >= minScore)
+                    candidates.push_back(Candidate{score, slot});
+            }
+        }
+        else
+        {
+            // Counters persist across queries; only the slots touched here are reset
+            const std::vector<uint64_t> grams = Trigrams(normalized);
+            m_touched.clear();
+            for (uint64_t gram : grams)
+            {
+                auto posting = m_postings.find(gram);
+                if (posting == m_postings.end())
+                    continue;
+                for (uint32_t slot : posting->second)
+                    if (m_shared[slot]++ == 0)
+                        m_touched.push_back(slot);
+            }
+
+            const float perGram = kFuzzyWeight / static_cast<float>(grams.size());
+            for (uint32_t slot : m_touched)
+            {
+                const uint16_t shared = m_shared[slot];
+                m_shared[slot] = 0;
+                float score = 0.0f;
+                // A substring shares every trigram but the two padded edges; skip the find otherwise
+                if (shared + 2u >= grams.size())
+                    score = SubstringScore(m_entries[slot].text, m_entries[slot].nameLength, normalized);
+                if (score == 0.0f)
+                    score = perGram * static_cast<float>(shared);
+                if (score >= minScore)
+                    candidates.push_back(Candidate{score, slot});
+            }
+        }
+
+        auto better = [this](const Candidate &a, const Candidate &b)
+        {
+            if (a.score != b.score)
+                return a.score > b.score;
+            const std::wstring &left = m_entries[a.slot].name;
+            const std::wstring &right = m_entries[b.slot].name;
+            if (left.size() != right.size())
+                return left.size() < right.size();
+            return left < right;
+        };
+        const size_t count = limit ? std::min(limit, candidates.size()) : candidates.size();
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), better);
+
+        matches.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Entry &entry = m_entries[candidates[i].slot];
+            matches.push_back(NameMatch{entry.id, entry.name, entry.tag, candidates[i].score});
+        }
+        return matches;
+    }
+
+    DeviceSearch::DeviceSearch() = default;
+
+    DeviceSearch::~DeviceSearch()
+    {
+        stop();
+    }
+
+    HRESULT DeviceSearch::start()
+    {
+        stop();
+
+        m_backend = Backend::GetAudioBackend();
+        HRESULT hr = m_backend->registerListener(this);
+        if (FAILED(hr))
+            return hr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_registered = true;
+            m_stale = true;
+        }
+
+        hr = refresh();
+        if (FAILED(hr))
+            stop();
+        return hr;
+    }
+
+    void DeviceSearch::stop()
+    {
+        bool registered;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            registered = m_registered;
+            m_registered = false;
+            m_index.clear();
+            m_stale = true;
+        }
+        // Outside the lock: the backend may be dispatching to this listener
+        if (registered)
+            m_backend->unregisterListener(this);
+    }
+
+    std::vector<NameMatch> DeviceSearch::search(const std::wstring &query, EDataFlow flow, size_t limit, float minScore)
+    {
+        if (FAILED(refresh()))
+            return std::vector<NameMatch>();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<NameMatch> matches = m_index.search(query, 0, minScore);
+        if (flow != eAll)
+            matches.erase(std::remove_if(matches.begin(), matches.end(), [flow](const NameMatch &match)
+                                         { return match.tag != static_cast<uint32_t>(flow); }),
+                          matches.end());
+        if (limit && matches.size() > limit)
+            matches.resize(limit);
+        return matches;
+    }
+
+    uint64_t DeviceSearch::refreshes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_refreshes;
+    }
+
+    void DeviceSearch::onDeviceAdded(const std::wstring &)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stale = true;
+    }
+
+    void DeviceSearch::onDeviceRemoved(const std::wstring &)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stale = true;
+    }
+
+    void DeviceSearch::onDeviceStateChanged(const std::wstring &, DWORD)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stale = true;
+    }
+
+    /**
+     * @brief Re-enumerates when stale and applies only the difference to the index.
+     *
+     * Enumerates outside the lock. Clearing the stale flag first means a topology
+     * change during the enumeration leaves it set, so the next search reads again.
+     */
+    HRESULT DeviceSearch::refresh()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_registered)
+                return E_FAIL;
+            if (!m_stale)
+                return S_OK;
+            m_stale = false;
+        }
+
+        struct Found
+        {
+            std::wstring name;
+            std::wstring description;
+            EDataFlow flow;
+        };
+        std::unordered_map<std::wstring, Found> found;
+        for (EDataFlow flow : {eRender, eCapture})
+        {
+            const HRESULT hr = m_backend->enumerateDevices(flow, [&](const std::wstring &id, const std::wstring &name, IMMDevice *device)
+                                                           {
+                                                               // Optional property: an endpoint without one is indexed by name only
+                                                               std::wstring description;
+                                                               if (FAILED(m_backend->getDeviceDescription(device, description)))
+                                                                   description.clear();
+                                                               found[id] = Found{name, std::move(description), flow}; });
+            if (FAILED(hr))
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stale = true;
+                return hr;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_registered)
+            return E_FAIL;
+        ++m_refreshes;
+        for (const std::wstring &id : m_index.ids())
+            if (found.find(id) == found.end())
+                m_index.remove(id);
+        std::wstring name;
+        for (const auto &entry : found)
+        {
+            if (!m_index.find(entry.first, name) || name != entry.second.name)
+                m_index.add(entry.first, entry.second.name, entry.second.description, static_cast<uint32_t>(entry.second.flow));
+        }
+        return S_OK;
+    }
+}
@@ -0,0 +1,307 @@
+#include "Devices/DeviceStateTracker.h"
+#include "Utility/SafeRelease.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Devices
+{
+    using Utility::SafeRelease;
+
+    namespace
+    {
+        DeviceFlow ToDeviceFlow(EDataFlow flow)
+        {
+            return flow == eCapture ? DeviceFlow::Capture : DeviceFlow::Render;
+        }
+    }
+
+    DeviceStateTracker::DeviceStateTracker() = default;
+
+    DeviceStateTracker::~DeviceStateTracker()
+    {
+        stop();
+    }
+
+    HRESULT DeviceStateTracker::start(DWORD stateMask)
+    {
+        stop();
+
+        m_backend = Backend::GetAudioBackend();
+        m_stateMask = stateMask;
+        HRESULT hr = m_backend->registerListener(this);
+        if (FAILED(hr))
+            return hr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_registered = true;
+            m_stale = true;
+            m_stats = DeviceTrackerStats();
+        }
+
+        hr = refresh();
+        if (FAILED(hr))
+            stop();
+        return hr;
+    }
+
+    void DeviceStateTracker::stop()
+    {
+        bool registered;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            registered = m_registered;
+            m_registered = false;
+            m_devices.clear();
+            m_hidden.clear();
+            m_stale = true;
+            changedLocked();
+        }
+        // Outside the lock: the backend may be dispatching to this listener
+        if (registered)
+            m_backend->unregisterListener(this);
+    }
+
+    std::vector<DeviceRecord> DeviceStateTracker::devices()
+    {
+        refresh();
+
+        std::vector<DeviceRecord> out;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            out.reserve(m_devices.size());
+            for (const auto &entry : m_devices)
+                out.push_back(entry.second);
+        }
+        std::sort(out.begin(), out.end(), [](const DeviceRecord &a, const DeviceRecord &b)
+                  {
+                      if (a.flow != b.flow)
+                          return a.flow < b.flow;
+                      if (a.name != b.name)
+                          return a.name < b.name;
+                      return a.id < b.id; });
+        return out;
+    }
+
+    bool DeviceStateTracker::find(const std::wstring &id, DeviceRecord &out)
+    {
+        refresh();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_devices.find(id);
+        if (it == m_devices.end())
+            return false;
+        out = it->second;
+        return true;
+    }
+
+    /**
+     * @brief Checks the predicate, then sleeps until the generation moves or the deadline passes.
+     */
+    bool DeviceStateTracker::waitForDevice(const DevicePredicate &predicate, std::chrono::milliseconds timeout,
+                                           DeviceRecord *match)
+    {
+        if (!predicate)
+            return false;
+
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;)
+        {
+            // A failed enumeration leaves the list stale; the next change retries it
+            refresh();
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_registered)
+                return false;
+            for (const auto &entry : m_devices)
+            {
+                if (predicate(entry.second))
+                {
+                    if (match)
+                        *match = entry.second;
+                    return true;
+                }
+            }
+
+            const uint64_t seen = m_generation;
+            if (!m_changed.wait_until(lock, deadline, [&]
+                                      { return m_generation != seen || !m_registered; }))
+                return false;
+            ++m_stats.wakeups;
+        }
+    }
+
+    uint64_t DeviceStateTracker::generation() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_generation;
+    }
+
+    DeviceTrackerStats DeviceStateTracker::stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    void DeviceStateTracker::onDeviceAdded(const std::wstring &)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_registered)
+            return;
+        ++m_stats.notifications;
+        m_stale = true;
+        changedLocked();
+    }
+
+    /**
+     * @brief Removed endpoints become DEVICE_STATE_NOTPRESENT, or leave the list if the mask excludes it.
+     */
+    void DeviceStateTracker::onDeviceRemoved(const std::wstring &deviceId)
+    {
+        onDeviceStateChanged(deviceId, DEVICE_STATE_NOTPRESENT);
+    }
+
+    void DeviceStateTracker::onDeviceStateChanged(const std::wstring &deviceId, DWORD state)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_registered)
+            return;
+        ++m_stats.notifications;
+        if (m_refreshing)
+            m_stale = true;
+
+        auto it = m_devices.find(deviceId);
+        if (it != m_devices.end())
+        {
+            it->second.state = state;
+            if (!(state & m_stateMask))
+            {
+                m_hidden[deviceId] = std::move(it->second);
+                m_devices.erase(it);
+            }
+            ++m_stats.updates;
+            changedLocked();
+            return;
+        }
+
+        auto hidden = m_hidden.find(deviceId);
+        if (hidden != m_hidden.end())
+        {
+            hidden->second.state = state;
+            if (state & m_stateMask)
+            {
+                m_devices[deviceId] = std::move(hidden->second);
+                m_hidden.erase(hidden);
+                ++m_stats.updates;
+                changedLocked();
+            }
+            return;
+        }
+
+        // Name and flow are unknown: enumerate on the next read
+        if (state & m_stateMask)
+        {
+            m_stale = true;
+            changedLocked();
+        }
+    }
+
+    void DeviceStateTracker::onDefaultDeviceChanged(EDataFlow flow, ERole role, const std::wstring &deviceId)
+    {
+        if (role != eConsole)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_registered)
+            return;
+        ++m_stats.notifications;
+        ++m_stats.updates;
+        if (m_refreshing)
+            m_stale = true;
+        for (auto *devices : {&m_devices, &m_hidden})
+        {
+            for (auto &entry : *devices)
+            {
+                if (entry.second.flow == ToDeviceFlow(flow))
+                    entry.second.isDefault = entry.first == deviceId;
+            }
+        }
+        changedLocked();
+    }
+
+    /**
+     * @brief Enumerates when stale and replaces the list.
+     *
+     * Enumerates outside the lock. A notification arriving meanwhile marks the list
+     * stale again, so the next reader enumerates once more rather than keep a result
+     * that may predate it.
+     */
+    HRESULT DeviceStateTracker::refresh()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_registered)
+                return E_FAIL;
+            if (!m_stale)
+                return S_OK;
+            m_stale = false;
+            ++m_refreshing;
+        }
+
+        std::unordered_map<std::wstring, DeviceRecord> found;
+        std::wstring defaults[2];
+        HRESULT hr = S_OK;
+        for (EDataFlow flow : {eRender, eCapture})
+        {
+            hr = m_backend->enumerateDevicesByState(flow, m_stateMask, [&](const std::wstring &id, const std::wstring &name, DWORD state, IMMDevice *)
+                                                    {
+                                                        DeviceRecord &record = found[id];
+                                                        record.id = id;
+                                                        record.name = name;
+                                                        record.flow = ToDeviceFlow(flow);
+                                                        record.state = state; });
+            if (FAILED(hr))
+                break;
+
+            IMMDevice *device = nullptr;
+            if (FAILED(m_backend->getDefaultDevice(flow, eConsole, &device)) || !device)
+                continue;
+            LPWSTR id = nullptr;
+            if (SUCCEEDED(device->GetId(&id)) && id)
+                defaults[flow == eCapture ? 1 : 0] = id;
+            CoTaskMemFree(id);
+            SafeRelease(device);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_refreshing;
+        if (!m_registered)
+            return E_FAIL;
+        if (FAILED(hr))
+        {
+            m_stale = true;
+            return hr;
+        }
+
+        for (auto &entry : found)
+            entry.second.isDefault = entry.first == defaults[entry.second.flow == DeviceFlow::Capture ? 1 : 0];
+        for (const auto &entry : found)
+            m_hidden.erase(entry.first);
+        // Tracked endpoints missing from the enumeration left the mask unnoticed
+        for (auto &entry : m_devices)
+        {
+            if (found.find(entry.first) == found.end())
+                m_hidden[entry.first] = std::move(entry.second);
+        }
+        m_devices.swap(found);
+        ++m_stats.enumerations;
+        changedLocked();
+        return S_OK;
+    }
+
+    void DeviceStateTracker::changedLocked()
+    {
+        ++m_generation;
+        m_changed.notify_all();
+    }
+}
@@ -0,0 +1,72 @@
+#include "Devices/FakeFormatQuery.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace Devices
+{
+    /**
+     * @brief Returns true if rate, channel count and sample type are all listed.
+     */
+    bool FakeFormatSupport::contains(const Utility::DeviceFormatInfo &format, uint16_t validBits) const
+    {
+        const SampleType type{format.bitDepth, validBits, format.isFloat};
+        return std::find(sampleRates.begin(), sampleRates.end(), format.sampleRate) != sampleRates.end() &&
+               std::find(channelCounts.begin(), channelCounts.end(), format.channels) != channelCounts.end() &&
+               std::find(sampleTypes.begin(), sampleTypes.end(), type) != sampleTypes.end();
+    }
+
+    /**
+     * @brief Constructor - a 48 kHz stereo float device by default.
+     *
+     * @param id Device ID.
+     * @param driverVersion Driver version string.
+     */
+    FakeFormatQuery::FakeFormatQuery(std::wstring id, std::wstring driverVersion)
+        : m_id(std::move(id)), m_driverVersion(std::move(driverVersion))
+    {
+        mix.sampleRate = 48000;
+        mix.channels = 2;
+        mix.bitDepth = 32;
+        mix.blockAlign = 8;
+        mix.channelMask = 0x3;
+        mix.isFloat = true;
+        mix.valid = true;
+
+        shared.sampleRates = {48000};
+        shared.channelCounts = {2};
+        shared.sampleTypes = {SampleType{32, 32, true}};
+    }
+
+    /**
+     * @brief Returns the configured mix format.
+     */
+    bool FakeFormatQuery::mixFormat(Utility::DeviceFormatInfo &format)
+    {
+        format = mix;
+        return mix.valid;
+    }
+
+    /**
+     * @brief Returns the configured periods.
+     */
+    bool FakeFormatQuery::devicePeriods(int64_t &defaultHns, int64_t &minimumHns)
+    {
+        defaultHns = defaultPeriodHns;
+        minimumHns = minimumPeriodHns;
+        return true;
+    }
+
+    /**
+     * @brief Answers from the support set of the mode after the configured delay.
+     */
+    bool FakeFormatQuery::isFormatSupported(ShareMode mode, const Utility::DeviceFormatInfo &format, uint16_t validBits)
+    {
+        m_calls.fetch_add(1, std::memory_order_relaxed);
+        if (callLatency.count() > 0)
+            std::this_thread::sleep_for(callLatency);
+
+        return (mode == ShareMode::Shared ? shared : exclusive).contains(format, validBits);
+    }
+}
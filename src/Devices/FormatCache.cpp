@@ -0,0 +1,295 @@
+#include "Devices/FormatCache.h"
+
+#include <fstream>
+#include <system_error>
+
+namespace Devices
+{
+    namespace
+    {
+        constexpr uint32_t kMagic = 0x43465741; // "AWFC"
+        constexpr uint32_t kVersion = 1;
+        constexpr uint32_t kMaxCount = 1u << 20; ///< Sanity bound on any stored length
+
+        // Fixed-width little-endian fields, so a cache file survives a rebuild with another compiler
+
+        void PutU(std::ostream &out, uint64_t value, size_t bytes)
+        {
+            char buffer[8];
+            for (size_t i = 0; i < bytes; ++i)
+                buffer[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+            out.write(buffer, static_cast<std::streamsize>(bytes));
+        }
+
+        bool GetU(std::istream &in, uint64_t &value, size_t bytes)
+        {
+            unsigned char buffer[8];
+            if (!in.read(reinterpret_cast<char *>(buffer), static_cast<std::streamsize>(bytes)))
+                return false;
+            value = 0;
+            for (size_t i = 0; i < bytes; ++i)
+                value |= static_cast<uint64_t>(buffer[i]) << (8 * i);
+            return true;
+        }
+
+        template <typename T>
+        bool Get(std::istream &in, T &value, size_t bytes = sizeof(T))
+        {
+            uint64_t raw = 0;
+            if (!GetU(in, raw, bytes))
+                return false;
+            value = static_cast<T>(raw);
+            return true;
+        }
+
+        void PutString(std::ostream &out, const std::wstring &text)
+        {
+            PutU(out, text.size(), 4);
+            for (wchar_t ch : text)
+                PutU(out, static_cast<uint32_t>(ch), 4);
+        }
+
+        bool GetString(std::istream &in, std::wstring &text)
+        {
+            uint32_t size = 0;
+            if (!Get(in, size) || size > kMaxCount)
+                return false;
+            text.resize(size);
+            for (wchar_t &ch : text)
+            {
+                uint32_t code = 0;
+                if (!Get(in, code))
+                    return false;
+                ch = static_cast<wchar_t>(code);
+            }
+            return true;
+        }
+
+        void PutBytes(std::ostream &out, const std::vector<uint8_t> &bytes)
+        {
+            PutU(out, bytes.size(), 4);
+            out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        }
+
+        bool GetBytes(std::istream &in, std::vector<uint8_t> &bytes)
+        {
+            uint32_t size = 0;
+            if (!Get(in, size) || size > kMaxCount)
+                return false;
+            bytes.resize(size);
+            return size == 0 || static_cast<bool>(in.read(reinterpret_cast<char *>(bytes.data()), size));
+        }
+
+        void PutEntry(std::ostream &out, const FormatCapabilities &caps)
+        {
+            PutString(out, caps.deviceId);
+            PutString(out, caps.driverVersion);
+
+            const Utility::DeviceFormatInfo &mix = caps.mixFormat;
+            PutU(out, mix.bitDepth, 2);
+            PutU(out, mix.channels, 2);
+            PutU(out, mix.blockAlign, 2);
+            PutU(out, mix.sampleRate, 4);
+            PutU(out, mix.channelMask, 4);
+            PutU(out, mix.isFloat ? 1 : 0, 1);
+            PutU(out, mix.valid ? 1 : 0, 1);
+            PutU(out, static_cast<uint64_t>(caps.defaultPeriodHns), 8);
+            PutU(out, static_cast<uint64_t>(caps.minimumPeriodHns), 8);
+
+            const FormatProbeSpec &spec = caps.spec;
+            PutU(out, spec.sampleRates.size(), 4);
+            for (uint32_t rate : spec.sampleRates)
+                PutU(out, rate, 4);
+            PutU(out, spec.channelCounts.size(), 4);
+            for (uint16_t channels : spec.channelCounts)
+                PutU(out, channels, 2);
+            PutU(out, spec.sampleTypes.size(), 4);
+            for (const SampleType &type : spec.sampleTypes)
+            {
+                PutU(out, type.bitDepth, 2);
+                PutU(out, type.validBits, 2);
+                PutU(out, type.isFloat ? 1 : 0, 1);
+            }
+            PutU(out, spec.probeShared ? 1 : 0, 1);
+            PutU(out, spec.probeExclusive ? 1 : 0, 1);
+
+            PutBytes(out, caps.shared);
+            PutBytes(out, caps.exclusive);
+        }
+
+        bool GetEntry(std::istream &in, FormatCapabilities &caps)
+        {
+            if (!GetString(in, caps.deviceId) || !GetString(in, caps.driverVersion))
+                return false;
+
+            Utility::DeviceFormatInfo &mix = caps.mixFormat;
+            uint8_t isFloat = 0, valid = 0;
+            if (!Get(in, mix.bitDepth) || !Get(in, mix.channels) || !Get(in, mix.blockAlign) ||
+                !Get(in, mix.sampleRate) || !Get(in, mix.channelMask) || !Get(in, isFloat) || !Get(in, valid) ||
+                !Get(in, caps.defaultPeriodHns) || !Get(in, caps.minimumPeriodHns))
+                return false;
+            mix.isFloat = isFloat != 0;
+            mix.valid = valid != 0;
+
+            FormatProbeSpec &spec = caps.spec;
+            uint32_t count = 0;
+            if (!Get(in, count) || count > kMaxCount)
+                return false;
+            spec.sampleRates.resize(count);
+            for (uint32_t &rate : spec.sampleRates)
+                if (!Get(in, rate))
+                    return false;
+
+            if (!Get(in, count) || count > kMaxCount)
+                return false;
+            spec.channelCounts.resize(count);
+            for (uint16_t &channels : spec.channelCounts)
+                if (!Get(in, channels))
+                    return false;
+
+            if (!Get(in, count) || count > kMaxCount)
+                return false;
+            spec.sampleTypes.resize(count);
+            for (SampleType &type : spec.sampleTypes)
+            {
+                uint8_t flag = 0;
+                if (!Get(in, type.bitDepth) || !Get(in, type.validBits) || !Get(in, flag))
+                    return false;
+                type.isFloat = flag != 0;
+            }
+
+            uint8_t probeShared = 0, probeExclusive = 0;
+            if (!Get(in, probeShared) || !Get(in, probeExclusive))
+                return false;
+            spec.probeShared = probeShared != 0;
+            spec.probeExclusive = probeExclusive != 0;
+
+            if (!GetBytes(in, caps.shared) || !GetBytes(in, caps.exclusive))
+                return false;
+
+            const size_t cells = spec.cellCount();
+            if ((spec.probeShared && caps.shared.size() != cells) || (spec.probeExclusive && caps.exclusive.size() != cells))
+                return false;
+
+            caps.valid = true;
+            return true;
+        }
+    }
+
+    /**
+     * @brief Reads every entry; any error discards the whole file.
+     *
+     * @param path Cache file.
+     * @return true if the file existed, had the current version and parsed completely.
+     */
+    bool FormatCache::load(const std::filesystem::path &path)
+    {
+        std::unordered_map<std::wstring, FormatCapabilities> entries;
+
+        std::ifstream in(path, std::ios::binary);
+        uint32_t magic = 0, version = 0, count = 0;
+        bool ok = in && Get(in, magic) && magic == kMagic && Get(in, version) && version == kVersion &&
+                  Get(in, count) && count <= kMaxCount;
+
+        for (uint32_t i = 0; ok && i < count; ++i)
+        {
+            FormatCapabilities caps;
+            ok = GetEntry(in, caps);
+            if (ok)
+                entries[caps.deviceId] = std::move(caps);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        if (ok)
+            m_entries = std::move(entries);
+        return ok;
+    }
+
+    /**
+     * @brief Serialises to `path`.tmp and renames it over `path`.
+     *
+     * A crash mid-write leaves the previous file intact.
+     *
+     * @param path Cache file.
+     * @return true on success.
+     */
+    bool FormatCache::save(const std::filesystem::path &path) const
+    {
+        std::filesystem::path temp = path;
+        temp += ".tmp";
+
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out)
+                return false;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            PutU(out, kMagic, 4);
+            PutU(out, kVersion, 4);
+            PutU(out, m_entries.size(), 4);
+            for (const auto &entry : m_entries)
+                PutEntry(out, entry.second);
+
+            out.flush();
+            if (!out)
+                return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns a stored entry if driver version and spec hash still match.
+     */
+    bool FormatCache::find(const std::wstring &deviceId, const std::wstring &driverVersion, uint64_t specHash,
+                           FormatCapabilities &out) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_entries.find(deviceId);
+        if (it == m_entries.end() || it->second.driverVersion != driverVersion || it->second.spec.hash() != specHash)
+            return false;
+
+        out = it->second;
+        out.queries = 0;
+        out.probeMs = 0.0;
+        out.fromCache = true;
+        return true;
+    }
+
+    /**
+     * @brief Inserts or replaces the entry of `capabilities.deviceId`.
+     */
+    void FormatCache::store(const FormatCapabilities &capabilities)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        FormatCapabilities &entry = m_entries[capabilities.deviceId];
+        entry = capabilities;
+        entry.fromCache = false;
+    }
+
+    /**
+     * @brief Drops every entry.
+     */
+    void FormatCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+    }
+
+    /**
+     * @brief Number of devices stored.
+     */
+    size_t FormatCache::size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+}
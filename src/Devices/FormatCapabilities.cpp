@@ -0,0 +1,123 @@
+#include "Devices/FormatCapabilities.h"
+#include "Dsp/ChannelLayout.h"
+
+#include <algorithm>
+
+namespace Devices
+{
+    namespace
+    {
+        constexpr uint64_t kFnvOffset = 1469598103934665603ull;
+        constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+        void HashValue(uint64_t &hash, uint64_t value, size_t bytes)
+        {
+            for (size_t i = 0; i < bytes; ++i)
+            {
+                hash ^= (value >> (8 * i)) & 0xFF;
+                hash *= kFnvPrime;
+            }
+        }
+    }
+
+    /**
+     * @brief Finds the grid cell of a format.
+     *
+     * Cells are ordered rate-major, then channel count, then sample type.
+     *
+     * @return Index into the per-mode flag vectors, -1 if a value is not in the spec.
+     */
+    std::ptrdiff_t FormatProbeSpec::indexOf(uint32_t sampleRate, uint16_t channels, const SampleType &type) const
+    {
+        const auto rate = std::find(sampleRates.begin(), sampleRates.end(), sampleRate);
+        const auto count = std::find(channelCounts.begin(), channelCounts.end(), channels);
+        const auto sample = std::find(sampleTypes.begin(), sampleTypes.end(), type);
+        if (rate == sampleRates.end() || count == channelCounts.end() || sample == sampleTypes.end())
+            return -1;
+
+        const std::ptrdiff_t r = rate - sampleRates.begin();
+        const std::ptrdiff_t c = count - channelCounts.begin();
+        const std::ptrdiff_t t = sample - sampleTypes.begin();
+        return (r * static_cast<std::ptrdiff_t>(channelCounts.size()) + c) * static_cast<std::ptrdiff_t>(sampleTypes.size()) + t;
+    }
+
+    /**
+     * @brief FNV-1a over every field, with lengths so different splits never collide trivially.
+     */
+    uint64_t FormatProbeSpec::hash() const
+    {
+        uint64_t hash = kFnvOffset;
+        HashValue(hash, sampleRates.size(), 4);
+        for (uint32_t rate : sampleRates)
+            HashValue(hash, rate, 4);
+        HashValue(hash, channelCounts.size(), 4);
+        for (uint16_t channels : channelCounts)
+            HashValue(hash, channels, 2);
+        HashValue(hash, sampleTypes.size(), 4);
+        for (const SampleType &type : sampleTypes)
+        {
+            HashValue(hash, type.bitDepth, 2);
+            HashValue(hash, type.validBits, 2);
+            HashValue(hash, type.isFloat ? 1 : 0, 1);
+        }
+        HashValue(hash, probeShared ? 1 : 0, 1);
+        HashValue(hash, probeExclusive ? 1 : 0, 1);
+        return hash;
+    }
+
+    /**
+     * @brief Looks the format up in the flag vector of a mode.
+     */
+    bool FormatCapabilities::supports(ShareMode mode, uint32_t sampleRate, uint16_t channels, const SampleType &type) const
+    {
+        const std::vector<uint8_t> &flags = mode == ShareMode::Shared ? shared : exclusive;
+        const std::ptrdiff_t index = spec.indexOf(sampleRate, channels, type);
+        return index >= 0 && static_cast<size_t>(index) < flags.size() && flags[static_cast<size_t>(index)] != 0;
+    }
+
+    /**
+     * @brief Lists the accepted cells of a mode in grid order.
+     */
+    std::vector<Utility::DeviceFormatInfo> FormatCapabilities::supportedFormats(ShareMode mode) const
+    {
+        std::vector<Utility::DeviceFormatInfo> formats;
+        const std::vector<uint8_t> &flags = mode == ShareMode::Shared ? shared : exclusive;
+
+        size_t index = 0;
+        for (uint32_t rate : spec.sampleRates)
+        {
+            for (uint16_t channels : spec.channelCounts)
+            {
+                for (const SampleType &type : spec.sampleTypes)
+                {
+                    if (index < flags.size() && flags[index] != 0)
+                        formats.push_back(MakeFormat(rate, channels, type));
+                    ++index;
+                }
+            }
+        }
+
+        return formats;
+    }
+
+    /**
+     * @brief Fills a DeviceFormatInfo for a grid cell.
+     *
+     * @param sampleRate Rate in Hz.
+     * @param channels Channel count (default speaker layout).
+     * @param type Sample type; validBits is not representable and is dropped.
+     * @return Utility::DeviceFormatInfo Format with `.valid` set.
+     */
+    Utility::DeviceFormatInfo MakeFormat(uint32_t sampleRate, uint16_t channels, const SampleType &type)
+    {
+        Utility::DeviceFormatInfo format;
+        format.sampleRate = sampleRate;
+        format.channels = channels;
+        format.bitDepth = type.bitDepth;
+        format.blockAlign = static_cast<uint16_t>(channels * (type.bitDepth / 8));
+        format.channelMask = Dsp::DefaultChannelMask(channels);
+        format.isFloat = type.isFloat;
+        format.valid = true;
+        return format;
+    }
+}
@@ -0,0 +1,229 @@
+#include "Devices/FormatNegotiator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+namespace Devices
+{
+    namespace
+    {
+        /**
+         * @brief One concrete format (a grid cell or a mix format).
+         */
+        struct Cell
+        {
+            uint32_t rate;
+            uint16_t channels;
+            SampleType type;
+
+            bool operator==(const Cell &other) const
+            {
+                return rate == other.rate && channels == other.channels && type == other.type;
+            }
+        };
+
+        /**
+         * @brief Significant bits a sample type carries (a float32 mantissa holds 24).
+         */
+        uint16_t Precision(const SampleType &type)
+        {
+            if (type.isFloat)
+                return type.bitDepth >= 64 ? 53 : 24;
+            return type.validBits;
+        }
+
+        /**
+         * @brief Strict fidelity order used to break cost ties deterministically.
+         */
+        bool MoreFaithful(const Cell &a, const Cell &b)
+        {
+            if (Precision(a.type) != Precision(b.type))
+                return Precision(a.type) > Precision(b.type);
+            if (a.type.isFloat != b.type.isFloat)
+                return a.type.isFloat;
+            if (a.type.bitDepth != b.type.bitDepth)
+                return a.type.bitDepth < b.type.bitDepth; // Same precision: smaller container
+            if (a.channels != b.channels)
+                return a.channels > b.channels;
+
+            const long long da = std::llabs(static_cast<long long>(a.rate) - 48000);
+            const long long db = std::llabs(static_cast<long long>(b.rate) - 48000);
+            if (da != db)
+                return da < db;
+            return a.rate > b.rate;
+        }
+
+        void AppendUnique(std::vector<Cell> &cells, const Cell &cell)
+        {
+            if (std::find(cells.begin(), cells.end(), cell) == cells.end())
+                cells.push_back(cell);
+        }
+
+        /**
+         * @brief Formats a device accepts in `mode` (mix format only if the grid is empty).
+         */
+        std::vector<Cell> AcceptedCells(const FormatCapabilities &caps, ShareMode mode)
+        {
+            std::vector<Cell> cells;
+            const std::vector<uint8_t> &flags = mode == ShareMode::Shared ? caps.shared : caps.exclusive;
+
+            size_t index = 0;
+            for (uint32_t rate : caps.spec.sampleRates)
+                for (uint16_t channels : caps.spec.channelCounts)
+                    for (const SampleType &type : caps.spec.sampleTypes)
+                    {
+                        if (index < flags.size() && flags[index] != 0)
+                            cells.push_back(Cell{rate, channels, type});
+                        ++index;
+                    }
+
+            if (cells.empty() && mode == ShareMode::Shared && caps.mixFormat.valid)
+            {
+                const Utility::DeviceFormatInfo &mix = caps.mixFormat;
+                cells.push_back(Cell{mix.sampleRate, mix.channels, SampleType{mix.bitDepth, mix.bitDepth, mix.isFloat}});
+            }
+
+            return cells;
+        }
+    }
+
+    /**
+     * @brief Sums the weights of every conversion stage needed.
+     *
+     * Precision changes count as requantisation; a container change at equal
+     * precision counts as a lossless widening.
+     *
+     * @return float Cost, 0 when the formats are identical.
+     */
+    float FormatNegotiator::conversionCost(uint32_t fromRate, uint16_t fromChannels, const SampleType &fromType,
+                                           uint32_t toRate, uint16_t toChannels, const SampleType &toType) const
+    {
+        float cost = 0.0f;
+
+        if (toRate != fromRate)
+            cost += toRate > fromRate ? m_costs.resampleUp : m_costs.resampleDown;
+
+        const uint16_t fromBits = Precision(fromType);
+        const uint16_t toBits = Precision(toType);
+        if (toBits < fromBits)
+            cost += m_costs.requantizeDown;
+        else if (toBits > fromBits || toType.bitDepth != fromType.bitDepth)
+            cost += m_costs.requantizeUp;
+
+        if (toType.isFloat != fromType.isFloat)
+            cost += m_costs.floatConversion;
+
+        if (toChannels != fromChannels)
+            cost += toChannels > fromChannels ? m_costs.channelUpmix : m_costs.channelDownmix;
+
+        return cost;
+    }
+
+    /**
+     * @brief Exhaustive search over candidate formats with branch-and-bound pruning.
+     *
+     * A candidate is abandoned as soon as its partial sum exceeds the best total, and a
+     * device's search stops at the first passthrough format.
+     *
+     * @param devices Probed capabilities.
+     * @param mode Sharing mode.
+     * @return NegotiationResult Best format and per-device plans.
+     */
+    NegotiationResult FormatNegotiator::negotiate(const std::vector<FormatCapabilities> &devices, ShareMode mode) const
+    {
+        NegotiationResult result;
+        if (devices.empty())
+            return result;
+
+        std::vector<std::vector<Cell>> accepted;
+        accepted.reserve(devices.size());
+        std::vector<Cell> candidates;
+        std::vector<uint64_t> specHashes;
+
+        for (const FormatCapabilities &caps : devices)
+        {
+            accepted.push_back(AcceptedCells(caps, mode));
+            if (accepted.back().empty())
+                return result; // This device cannot be opened in `mode` at all
+
+            // Devices probed with the same spec contribute the same grid once
+            const uint64_t specHash = caps.spec.hash();
+            if (std::find(specHashes.begin(), specHashes.end(), specHash) == specHashes.end())
+            {
+                specHashes.push_back(specHash);
+                for (uint32_t rate : caps.spec.sampleRates)
+                    for (uint16_t channels : caps.spec.channelCounts)
+                        for (const SampleType &type : caps.spec.sampleTypes)
+                            AppendUnique(candidates, Cell{rate, channels, type});
+            }
+            for (const Cell &cell : accepted.back())
+                AppendUnique(candidates, cell);
+        }
+
+        float bestCost = std::numeric_limits<float>::max();
+        const Cell *best = nullptr;
+
+        for (const Cell &candidate : candidates)
+        {
+            float total = 0.0f;
+            for (size_t d = 0; d < accepted.size() && total <= bestCost; ++d)
+            {
+                float deviceBest = std::numeric_limits<float>::max();
+                for (const Cell &target : accepted[d])
+                {
+                    const float cost = conversionCost(candidate.rate, candidate.channels, candidate.type,
+                                                      target.rate, target.channels, target.type);
+                    deviceBest = std::min(deviceBest, cost);
+                    if (deviceBest == 0.0f)
+                        break;
+                }
+                total += deviceBest;
+            }
+            ++result.candidatesEvaluated;
+
+            if (total < bestCost || (total == bestCost && best && MoreFaithful(candidate, *best)))
+            {
+                bestCost = total;
+                best = &candidate;
+            }
+        }
+
+        if (!best)
+            return result;
+
+        // Per-device plans for the winner (same choice rule as the search, ties by fidelity)
+        result.plans.reserve(devices.size());
+        for (size_t d = 0; d < devices.size(); ++d)
+        {
+            const Cell *target = nullptr;
+            float targetCost = std::numeric_limits<float>::max();
+            for (const Cell &cell : accepted[d])
+            {
+                const float cost = conversionCost(best->rate, best->channels, best->type, cell.rate, cell.channels, cell.type);
+                if (cost < targetCost || (cost == targetCost && MoreFaithful(cell, *target)))
+                {
+                    targetCost = cost;
+                    target = &cell;
+                }
+            }
+
+            ConversionPlan plan;
+            plan.deviceId = devices[d].deviceId;
+            plan.deviceFormat = MakeFormat(target->rate, target->channels, target->type);
+            plan.deviceSampleType = target->type;
+            plan.resample = target->rate != best->rate;
+            plan.requantize = Precision(target->type) != Precision(best->type) || target->type.bitDepth != best->type.bitDepth;
+            plan.convertFloat = target->type.isFloat != best->type.isFloat;
+            plan.remapChannels = target->channels != best->channels;
+            plan.cost = targetCost;
+            result.plans.push_back(plan);
+        }
+
+        result.valid = true;
+        result.format = MakeFormat(best->rate, best->channels, best->type);
+        result.sampleType = best->type;
+        result.totalCost = bestCost;
+        return result;
+    }
+}
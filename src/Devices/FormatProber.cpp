@@ -0,0 +1,144 @@
+#include "Devices/FormatProber.h"
+
+#if defined(_WIN32)
+#include "Utility/COMInitializer.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace Devices
+{
+    namespace
+    {
+        constexpr size_t kDefaultMaxThreads = 16;
+
+        /**
+         * @brief Queries every cell of the grid for one mode.
+         */
+        void ProbeMode(IFormatQuery &device, const FormatProbeSpec &spec, ShareMode mode,
+                       std::vector<uint8_t> &flags, uint32_t &queries)
+        {
+            flags.assign(spec.cellCount(), 0);
+
+            size_t index = 0;
+            for (uint32_t rate : spec.sampleRates)
+            {
+                for (uint16_t channels : spec.channelCounts)
+                {
+                    for (const SampleType &type : spec.sampleTypes)
+                    {
+                        flags[index++] = device.isFormatSupported(mode, MakeFormat(rate, channels, type), type.validBits) ? 1 : 0;
+                        ++queries;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Reads mix format and periods, then walks the grid in each requested mode.
+     *
+     * @param device Endpoint.
+     * @param spec Candidate grid.
+     * @return FormatCapabilities Probe result (`.valid` false if mix format or periods failed).
+     */
+    FormatCapabilities FormatProber::probeDevice(IFormatQuery &device, const FormatProbeSpec &spec)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        FormatCapabilities caps;
+        caps.deviceId = device.deviceId();
+        caps.driverVersion = device.driverVersion();
+        caps.spec = spec;
+
+        const bool mixOk = device.mixFormat(caps.mixFormat);
+        const bool periodsOk = device.devicePeriods(caps.defaultPeriodHns, caps.minimumPeriodHns);
+
+        if (spec.probeShared)
+            ProbeMode(device, spec, ShareMode::Shared, caps.shared, caps.queries);
+        if (spec.probeExclusive)
+            ProbeMode(device, spec, ShareMode::Exclusive, caps.exclusive, caps.queries);
+        device.finish();
+
+        caps.valid = mixOk && periodsOk;
+        caps.probeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return caps;
+    }
+
+    /**
+     * @brief Answers cached devices directly and probes the rest on worker threads.
+     *
+     * Workers pull device indices from a shared counter, so a slow device does not
+     * hold up the others. Invalid results are not cached.
+     *
+     * @param devices Endpoints.
+     * @param spec Candidate grid.
+     * @param cache Optional cache.
+     * @return std::vector<FormatCapabilities> One entry per device, same order.
+     */
+    std::vector<FormatCapabilities> FormatProber::probe(const std::vector<IFormatQuery *> &devices,
+                                                        const FormatProbeSpec &spec, FormatCache *cache) const
+    {
+        std::vector<FormatCapabilities> results(devices.size());
+        std::vector<size_t> pending;
+        const uint64_t specHash = spec.hash();
+
+        for (size_t i = 0; i < devices.size(); ++i)
+        {
+            if (!devices[i])
+                continue;
+            if (cache && cache->find(devices[i]->deviceId(), devices[i]->driverVersion(), specHash, results[i]))
+                continue;
+            pending.push_back(i);
+        }
+
+        if (pending.empty())
+            return results;
+
+        // Probing waits on the driver rather than the CPU, so workers are not tied to core count
+        const size_t threads = std::min(m_maxThreads != 0 ? m_maxThreads : kDefaultMaxThreads, pending.size());
+
+        std::atomic<size_t> next{0};
+        auto worker = [&]()
+        {
+#if defined(_WIN32)
+            // Query objects activate their IAudioClient on the thread that uses them
+            std::unique_ptr<Utility::COMInitializer> com;
+            try
+            {
+                com = std::make_unique<Utility::COMInitializer>();
+            }
+            catch (const std::exception &)
+            {
+                // Already initialised differently on this thread; queries will report failures
+            }
+#endif
+            for (size_t n = next.fetch_add(1); n < pending.size(); n = next.fetch_add(1))
+            {
+                const size_t i = pending[n];
+                results[i] = probeDevice(*devices[i], spec);
+                if (cache && results[i].valid)
+                    cache->store(results[i]);
+            }
+        };
+
+        if (threads == 1)
+        {
+            worker();
+            return results;
+        }
+
+        std::vector<std::thread> pool;
+        pool.reserve(threads);
+        for (size_t t = 0; t < threads; ++t)
+            pool.emplace_back(worker);
+        for (std::thread &thread : pool)
+            thread.join();
+
+        return results;
+    }
+}
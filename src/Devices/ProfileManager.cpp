@@ -0,0 +1,562 @@
+#include "Devices/ProfileManager.h"
+#include "Utility/SafeRelease.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cwctype>
+#include <utility>
+
+namespace Devices
+{
+    using Utility::SafeRelease;
+
+    namespace
+    {
+        constexpr float kVolumeEpsilon = 1e-4f; ///< Closer than this counts as already set
+
+        bool EqualsNoCase(const std::wstring &a, const std::wstring &b)
+        {
+            if (a.size() != b.size())
+                return false;
+            for (size_t i = 0; i < a.size(); ++i)
+                if (std::towlower(a[i]) != std::towlower(b[i]))
+                    return false;
+            return true;
+        }
+
+        size_t FlowIndex(EDataFlow flow)
+        {
+            return flow == eCapture ? 1 : 0;
+        }
+
+        /// Every volume the profile sets is a master scalar (NaN fails the comparison too).
+        bool ValidVolumes(const AudioProfile &profile)
+        {
+            for (const ProfileEndpoint &endpoint : profile.endpoints)
+                if (endpoint.hasVolume && !(endpoint.volume >= 0.0f && endpoint.volume <= 1.0f))
+                    return false;
+            return true;
+        }
+    }
+
+    ProfileManager::ProfileManager() = default;
+
+    ProfileManager::~ProfileManager()
+    {
+        stop();
+    }
+
+    /**
+     * @brief Registers first so no change between the read and the registration is lost.
+     */
+    HRESULT ProfileManager::start()
+    {
+        stop();
+
+        m_backend = Backend::GetAudioBackend();
+        HRESULT hr = m_backend->registerListener(this);
+        if (FAILED(hr))
+            return hr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_registered = true;
+        }
+
+        hr = readState();
+        if (FAILED(hr))
+            stop();
+        return hr;
+    }
+
+    void ProfileManager::stop()
+    {
+        bool registered;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            registered = m_registered;
+            m_registered = false;
+        }
+        // Outside the lock: unregistering waits for callbacks, which take it
+        if (registered)
+            m_backend->unregisterListener(this);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &entry : m_endpoints)
+            SafeRelease(entry.second->device);
+        m_endpoints.clear();
+        m_compiled.clear();
+        for (auto &flow : m_defaults)
+            for (std::wstring &id : flow)
+                id.clear();
+        m_stale = true;
+    }
+
+    bool ProfileManager::setProfiles(std::vector<AudioProfile> profiles)
+    {
+        if (!std::all_of(profiles.begin(), profiles.end(), ValidVolumes))
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_profiles = std::move(profiles);
+        m_compiled.clear();
+        return true;
+    }
+
+    bool ProfileManager::setProfile(const AudioProfile &profile)
+    {
+        if (!ValidVolumes(profile))
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_compiled.erase(profile.name);
+        for (AudioProfile &existing : m_profiles)
+        {
+            if (existing.name == profile.name)
+            {
+                existing = profile;
+                return true;
+            }
+        }
+        m_profiles.push_back(profile);
+        return true;
+    }
+
+    bool ProfileManager::removeProfile(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::find_if(m_profiles.begin(), m_profiles.end(), [&](const AudioProfile &profile)
+                               { return profile.name == name; });
+        if (it == m_profiles.end())
+            return false;
+        m_profiles.erase(it);
+        m_compiled.erase(name);
+        return true;
+    }
+
+    std::vector<AudioProfile> ProfileManager::profiles() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_profiles;
+    }
+
+    CacheStatus ProfileManager::load(const std::filesystem::path &path)
+    {
+        std::vector<AudioProfile> loaded;
+        const CacheStatus status = LoadProfiles(path, loaded);
+        if (status == CacheStatus::Loaded)
+            setProfiles(std::move(loaded));
+        return status;
+    }
+
+    bool ProfileManager::save(const std::filesystem::path &path) const
+    {
+        return SaveProfiles(path, profiles());
+    }
+
+    /**
+     * @brief Builds a profile from the mirror (no backend calls).
+     */
+    AudioProfile ProfileManager::capture(const std::string &name) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        AudioProfile profile;
+        profile.name = name;
+        for (size_t f = 0; f < 2; ++f)
+        {
+            for (size_t r = 0; r < 3; ++r)
+            {
+                auto it = m_endpoints.find(m_defaults[f][r]);
+                if (it == m_endpoints.end())
+                    continue;
+                profile.defaults[f][r].id = it->second->id;
+                profile.defaults[f][r].name = it->second->name;
+            }
+        }
+
+        for (const auto &entry : m_endpoints)
+        {
+            const Endpoint &endpoint = *entry.second;
+            if (!endpoint.active)
+                continue;
+            ProfileEndpoint level;
+            level.device.id = endpoint.id;
+            level.device.name = endpoint.name;
+            level.flow = endpoint.flow;
+            level.hasVolume = true;
+            level.volume = endpoint.volume;
+            level.hasMute = true;
+            level.muted = endpoint.muted;
+            profile.endpoints.push_back(std::move(level));
+        }
+        return profile;
+    }
+
+    /**
+     * @brief Diffs the compiled profile against the mirror and makes only the needed calls.
+     *
+     * The calls are planned under the lock with copies of the endpoint IDs and their
+     * own device references, so a concurrent stop() or re-read cannot free what the
+     * calls use; results are written back to the mirror by ID.
+     */
+    HRESULT ProfileManager::apply(const std::string &name, ProfileApplyResult *result)
+    {
+        ProfileApplyResult local;
+        ProfileApplyResult &out = result ? *result : local;
+        out = ProfileApplyResult();
+
+        struct DefaultCall
+        {
+            std::wstring id;
+            size_t flow;
+            uint32_t roles;
+        };
+        struct LevelCall
+        {
+            std::wstring id;
+            IMMDevice *device; ///< Reference owned by the call
+            bool hasVolume;
+            float volume;
+            bool hasMute;
+            bool muted;
+        };
+        std::vector<DefaultCall> defaults;
+        std::vector<LevelCall> levels;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_registered)
+                return E_FAIL;
+            auto profile = std::find_if(m_profiles.begin(), m_profiles.end(), [&](const AudioProfile &candidate)
+                                        { return candidate.name == name; });
+            if (profile == m_profiles.end())
+                return E_NOTFOUND;
+
+            if (m_stale)
+            {
+                lock.unlock();
+                const HRESULT hr = readState(&out.refreshCalls);
+                lock.lock();
+                if (FAILED(hr))
+                    return hr;
+                profile = std::find_if(m_profiles.begin(), m_profiles.end(), [&](const AudioProfile &candidate)
+                                       { return candidate.name == name; });
+                if (profile == m_profiles.end())
+                    return E_NOTFOUND;
+            }
+
+            const Compiled &compiled = *compiledLocked(*profile);
+            out.unresolved = compiled.unresolved;
+
+            for (size_t f = 0; f < 2; ++f)
+            {
+                for (size_t r = 0; r < 3; ++r)
+                {
+                    Endpoint *target = compiled.defaults[f][r];
+                    if (!target)
+                        continue;
+                    if (m_defaults[f][r] == target->id)
+                    {
+                        ++out.skipped;
+                        continue;
+                    }
+                    auto call = std::find_if(defaults.begin(), defaults.end(), [&](const DefaultCall &c)
+                                             { return c.id == target->id; });
+                    if (call == defaults.end())
+                        defaults.push_back(DefaultCall{target->id, f, 1u << r});
+                    else
+                        call->roles |= 1u << r;
+                }
+            }
+
+            for (const Compiled::Level &level : compiled.levels)
+            {
+                LevelCall change{level.endpoint->id, level.endpoint->device, level.hasVolume, level.volume,
+                                 level.hasMute, level.muted};
+                if (level.hasVolume && std::fabs(level.endpoint->volume - level.volume) < kVolumeEpsilon)
+                {
+                    change.hasVolume = false;
+                    ++out.skipped;
+                }
+                if (level.hasMute && level.endpoint->muted == level.muted)
+                {
+                    change.hasMute = false;
+                    ++out.skipped;
+                }
+                if (!change.hasVolume && !change.hasMute)
+                    continue;
+                change.device->AddRef();
+                levels.push_back(std::move(change));
+            }
+        }
+
+        // Calls outside the lock: the simulated backend notifies synchronously
+        HRESULT failure = S_OK;
+        for (const DefaultCall &call : defaults)
+        {
+            ++out.calls;
+            const HRESULT hr = m_backend->setDefaultDevice(call.id, call.roles);
+            if (FAILED(hr))
+            {
+                ++out.failures;
+                failure = hr;
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_registered)
+                continue; // Stopped meanwhile: the mirror is gone
+            for (size_t r = 0; r < 3; ++r)
+                if (call.roles & (1u << r))
+                    m_defaults[call.flow][r] = call.id;
+        }
+
+        for (LevelCall &level : levels)
+        {
+            if (level.hasVolume)
+            {
+                ++out.calls;
+                const HRESULT hr = m_backend->setVolume(level.device, level.volume);
+                if (FAILED(hr))
+                {
+                    ++out.failures;
+                    failure = hr;
+                }
+                else
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto it = m_endpoints.find(level.id);
+                    if (it != m_endpoints.end())
+                        it->second->volume = level.volume;
+                }
+            }
+            if (level.hasMute)
+            {
+                ++out.calls;
+                const HRESULT hr = m_backend->setMute(level.device, level.muted);
+                if (FAILED(hr))
+                {
+                    ++out.failures;
+                    failure = hr;
+                }
+                else
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto it = m_endpoints.find(level.id);
+                    if (it != m_endpoints.end())
+                        it->second->muted = level.muted;
+                }
+            }
+            SafeRelease(level.device);
+        }
+
+        if (FAILED(failure))
+            return failure;
+        return out.unresolved ? S_FALSE : S_OK;
+    }
+
+    void ProfileManager::onDeviceAdded(const std::wstring &)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stale = true;
+    }
+
+    void ProfileManager::onDeviceRemoved(const std::wstring &)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stale = true;
+    }
+
+    void ProfileManager::onDeviceStateChanged(const std::wstring &, DWORD)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stale = true;
+    }
+
+    void ProfileManager::onDefaultDeviceChanged(EDataFlow flow, ERole role, const std::wstring &deviceId)
+    {
+        if ((flow != eRender && flow != eCapture) || role < eConsole || role > eCommunications)
+            return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_defaults[FlowIndex(flow)][role] = deviceId;
+    }
+
+    void ProfileManager::onVolumeChanged(const std::wstring &deviceId, float volume, bool muted)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_endpoints.find(deviceId);
+        if (it == m_endpoints.end())
+            return;
+        it->second->volume = volume;
+        it->second->muted = muted;
+    }
+
+    /**
+     * @brief Reads endpoints, their volume and mute, and the six defaults into the mirror.
+     *
+     * Clearing the stale flag first means a topology change during the read
+     * leaves it set, so the next apply() reads again.
+     */
+    HRESULT ProfileManager::readState(uint32_t *calls)
+    {
+        uint32_t made = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stale = false;
+        }
+
+        struct Found
+        {
+            std::wstring id;
+            std::wstring name;
+            EDataFlow flow;
+            IMMDevice *device;
+            float volume;
+            bool muted;
+        };
+        std::vector<Found> found;
+        for (EDataFlow flow : {eRender, eCapture})
+        {
+            ++made;
+            const HRESULT hr = m_backend->enumerateDevices(flow, [&](const std::wstring &id, const std::wstring &name, IMMDevice *device)
+                                                           {
+                                                               device->AddRef();
+                                                               found.push_back(Found{id, name, flow, device, 1.0f, false}); });
+            if (FAILED(hr))
+            {
+                for (Found &endpoint : found)
+                    SafeRelease(endpoint.device);
+                if (calls)
+                    *calls += made;
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stale = true;
+                return hr;
+            }
+        }
+        for (Found &endpoint : found)
+        {
+            m_backend->getVolume(endpoint.device, endpoint.volume);
+            m_backend->getMute(endpoint.device, endpoint.muted);
+            made += 2;
+        }
+
+        std::wstring defaults[2][3];
+        for (EDataFlow flow : {eRender, eCapture})
+        {
+            for (ERole role : {eConsole, eMultimedia, eCommunications})
+            {
+                IMMDevice *device = nullptr;
+                ++made;
+                if (FAILED(m_backend->getDefaultDevice(flow, role, &device)) || !device)
+                    continue;
+                LPWSTR id = nullptr;
+                if (SUCCEEDED(device->GetId(&id)) && id)
+                    defaults[FlowIndex(flow)][role] = id;
+                CoTaskMemFree(id);
+                SafeRelease(device);
+            }
+        }
+
+        if (calls)
+            *calls += made;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_registered)
+        {
+            // stop() ran during the read: keep nothing it would not release
+            for (Found &endpoint : found)
+                SafeRelease(endpoint.device);
+            return E_FAIL;
+        }
+        for (auto &entry : m_endpoints)
+            entry.second->active = false;
+        for (Found &endpoint : found)
+        {
+            std::unique_ptr<Endpoint> &slot = m_endpoints[endpoint.id];
+            if (!slot)
+            {
+                slot.reset(new Endpoint());
+                slot->id = endpoint.id;
+                slot->flow = endpoint.flow;
+                slot->device = endpoint.device;
+            }
+            else
+            {
+                SafeRelease(endpoint.device);
+            }
+            slot->name = endpoint.name;
+            slot->active = true;
+            slot->volume = endpoint.volume;
+            slot->muted = endpoint.muted;
+        }
+        for (size_t f = 0; f < 2; ++f)
+            for (size_t r = 0; r < 3; ++r)
+                m_defaults[f][r] = defaults[f][r];
+        m_compiled.clear();
+        return S_OK;
+    }
+
+    /**
+     * @brief Active endpoint of `flow` with the device's ID, else with its name.
+     */
+    ProfileManager::Endpoint *ProfileManager::resolveLocked(const ProfileDevice &device, EDataFlow flow) const
+    {
+        if (!device.id.empty())
+        {
+            auto it = m_endpoints.find(device.id);
+            if (it != m_endpoints.end() && it->second->active && it->second->flow == flow)
+                return it->second.get();
+        }
+        if (!device.name.empty())
+        {
+            for (const auto &entry : m_endpoints)
+            {
+                Endpoint &endpoint = *entry.second;
+                if (endpoint.active && endpoint.flow == flow && EqualsNoCase(endpoint.name, device.name))
+                    return &endpoint;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Returns the profile resolved to endpoints, compiling it on first use.
+     */
+    const ProfileManager::Compiled *ProfileManager::compiledLocked(const AudioProfile &profile)
+    {
+        auto it = m_compiled.find(profile.name);
+        if (it != m_compiled.end())
+            return &it->second;
+
+        Compiled compiled;
+        for (size_t f = 0; f < 2; ++f)
+        {
+            for (size_t r = 0; r < 3; ++r)
+            {
+                const ProfileDevice &device = profile.defaults[f][r];
+                if (device.empty())
+                    continue;
+                compiled.defaults[f][r] = resolveLocked(device, f == 0 ? eRender : eCapture);
+                if (!compiled.defaults[f][r])
+                    ++compiled.unresolved;
+            }
+        }
+
+        for (const ProfileEndpoint &endpoint : profile.endpoints)
+        {
+            if (!endpoint.hasVolume && !endpoint.hasMute)
+                continue;
+            Compiled::Level level;
+            level.endpoint = resolveLocked(endpoint.device, endpoint.flow);
+            if (!level.endpoint)
+            {
+                ++compiled.unresolved;
+                continue;
+            }
+            level.hasVolume = endpoint.hasVolume; // Range checked by setProfile() and LoadProfiles()
+            level.volume = endpoint.volume;
+            level.hasMute = endpoint.hasMute;
+            level.muted = endpoint.muted;
+            compiled.levels.push_back(level);
+        }
+
+        return &m_compiled.emplace(profile.name, std::move(compiled)).first->second;
+    }
+}
@@ -0,0 +1,455 @@
+#include "Devices/RuleEngine.h"
+#include "Utility/SafeRelease.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <utility>
+
+namespace Devices
+{
+    using Utility::SafeRelease;
+
+    namespace
+    {
+        /**
+         * @brief Case-insensitive glob: '*' matches any run, '?' any one character.
+         */
+        bool GlobMatch(const std::wstring &pattern, const std::wstring &text)
+        {
+            size_t p = 0, t = 0;
+            size_t star = std::wstring::npos, resume = 0;
+            while (t < text.size())
+            {
+                if (p < pattern.size() && (pattern[p] == L'?' || std::towlower(pattern[p]) == std::towlower(text[t])))
+                {
+                    ++p;
+                    ++t;
+                }
+                else if (p < pattern.size() && pattern[p] == L'*')
+                {
+                    star = p++;
+                    resume = t;
+                }
+                else if (star != std::wstring::npos)
+                {
+                    p = star + 1;
+                    t = ++resume;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            while (p < pattern.size() && pattern[p] == L'*')
+                ++p;
+            return p == pattern.size();
+        }
+
+        size_t TriggerIndex(RuleTrigger trigger)
+        {
+            return trigger == RuleTrigger::Arrival ? 0 : 1;
+        }
+    }
+
+    RuleEngine::RuleEngine() = default;
+
+    RuleEngine::~RuleEngine()
+    {
+        stop();
+    }
+
+    /**
+     * @brief Validates and compiles the rules, then registers with the audio backend.
+     *
+     * The worker and the registration come before the initial enumeration, so an
+     * endpoint arriving meanwhile is either enumerated or resolved by the worker.
+     */
+    HRESULT RuleEngine::start(std::vector<DeviceRule> rules, std::function<void(const RuleFiring &)> onFired)
+    {
+        for (const DeviceRule &rule : rules)
+        {
+            if (rule.actions.empty())
+                return E_INVALIDARG;
+            for (const RuleAction &action : rule.actions)
+                if (action.type == RuleActionType::SetVolume && (action.volume < 0.0f || action.volume > 1.0f))
+                    return E_INVALIDARG;
+        }
+
+        stop();
+
+        m_backend = Backend::GetAudioBackend();
+        m_rules = std::move(rules);
+        m_onFired = std::move(onFired);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = false;
+            m_stats = RuleEngineStats();
+        }
+        m_worker = std::thread(&RuleEngine::run, this);
+
+        HRESULT hr = m_backend->registerListener(this);
+        if (FAILED(hr))
+        {
+            stop();
+            return hr;
+        }
+        m_registered = true;
+
+        for (EDataFlow flow : {eRender, eCapture})
+        {
+            struct Found
+            {
+                std::wstring id;
+                std::wstring name;
+                EndpointFormFactor formFactor;
+                IMMDevice *device;
+            };
+            std::vector<Found> found;
+            hr = m_backend->enumerateDevices(flow, [&](const std::wstring &id, const std::wstring &name, IMMDevice *device)
+                                             {
+                                                 EndpointFormFactor formFactor = UnknownFormFactor;
+                                                 m_backend->getFormFactor(device, formFactor);
+                                                 device->AddRef();
+                                                 found.push_back(Found{id, name, formFactor, device}); });
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (Found &endpoint : found)
+            {
+                if (Endpoint *added = addEndpointLocked(endpoint.id, endpoint.name, flow, endpoint.formFactor, endpoint.device))
+                    added->active = true;
+                else
+                    SafeRelease(endpoint.device);
+            }
+            if (FAILED(hr))
+                break;
+        }
+
+        if (FAILED(hr))
+        {
+            stop();
+            return hr;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        compileLocked();
+        return S_OK;
+    }
+
+    void RuleEngine::stop()
+    {
+        // Outside the lock: unregistering waits for callbacks, which take it
+        if (m_registered)
+        {
+            m_backend->unregisterListener(this);
+            m_registered = false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            m_queue.clear();
+        }
+        m_wake.notify_all();
+        if (m_worker.joinable())
+            m_worker.join();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &entry : m_endpoints)
+            SafeRelease(entry.second->device);
+        m_endpoints.clear();
+        m_idle.notify_all();
+    }
+
+    bool RuleEngine::running() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_worker.joinable() && !m_stopping;
+    }
+
+    bool RuleEngine::waitIdle(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_idle.wait_for(lock, timeout, [this]
+                               { return m_queue.empty() && !m_busy; });
+    }
+
+    RuleEngineStats RuleEngine::stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    /**
+     * @brief An endpoint known from a previous removal comes back active; a new one gets resolved.
+     */
+    void RuleEngine::onDeviceAdded(const std::wstring &deviceId)
+    {
+        transition(deviceId, true);
+    }
+
+    void RuleEngine::onDeviceRemoved(const std::wstring &deviceId)
+    {
+        transition(deviceId, false);
+    }
+
+    void RuleEngine::onDeviceStateChanged(const std::wstring &deviceId, DWORD state)
+    {
+        transition(deviceId, state == DEVICE_STATE_ACTIVE);
+    }
+
+    /**
+     * @brief Notification path: one lookup, the state edge, and a queued program.
+     *
+     * Duplicate notifications (added + state changed) are absorbed by the edge
+     * check. Unknown IDs only become jobs when they turn active.
+     */
+    void RuleEngine::transition(const std::wstring &deviceId, bool active)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping)
+                return;
+
+            Job job;
+            job.deviceId = deviceId;
+            job.queued = now;
+
+            auto it = m_endpoints.find(deviceId);
+            if (it == m_endpoints.end())
+            {
+                if (!active)
+                    return;
+            }
+            else
+            {
+                Endpoint &endpoint = *it->second;
+                if (endpoint.active.exchange(active) == active)
+                    return;
+                ++m_stats.events;
+                job.endpoint = &endpoint;
+                job.trigger = active ? RuleTrigger::Arrival : RuleTrigger::Removal;
+                job.program = endpoint.programs[TriggerIndex(job.trigger)];
+                if (!job.program)
+                    return;
+            }
+            m_queue.push_back(std::move(job));
+        }
+        m_wake.notify_one();
+    }
+
+    void RuleEngine::run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            m_wake.wait(lock, [this]
+                        { return m_stopping || !m_queue.empty(); });
+            if (m_stopping)
+                break;
+
+            Job job = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busy = true;
+            lock.unlock();
+
+            if (!job.endpoint)
+            {
+                // First sight of this ID: read it, recompile, and fire its arrival
+                Endpoint *endpoint = learn(job.deviceId);
+                std::lock_guard<std::mutex> relock(m_mutex);
+                if (endpoint)
+                {
+                    job.endpoint = endpoint;
+                    job.program = endpoint->programs[TriggerIndex(RuleTrigger::Arrival)];
+                }
+            }
+            if (job.program)
+                execute(job);
+
+            lock.lock();
+            m_busy = false;
+            if (m_queue.empty())
+                m_idle.notify_all();
+        }
+        m_busy = false;
+        m_idle.notify_all();
+    }
+
+    /**
+     * @brief Runs a compiled program: each rule's steps in order, skipping inactive targets.
+     */
+    void RuleEngine::execute(const Job &job)
+    {
+        for (const Binding &binding : *job.program)
+        {
+            RuleFiring firing;
+            firing.rule = binding.rule;
+            firing.deviceId = job.deviceId;
+            firing.trigger = job.trigger;
+
+            for (const Step &step : binding.steps)
+            {
+                for (Endpoint *target : step.targets)
+                {
+                    if (!target->active.load())
+                        continue;
+
+                    HRESULT hr = S_OK;
+                    switch (step.type)
+                    {
+                    case RuleActionType::SetDefault:
+                        hr = m_backend->setDefaultDevice(target->id, step.roles);
+                        break;
+                    case RuleActionType::Mute:
+                        hr = m_backend->setMute(target->device, true);
+                        break;
+                    case RuleActionType::Unmute:
+                        hr = m_backend->setMute(target->device, false);
+                        break;
+                    case RuleActionType::SetVolume:
+                        hr = m_backend->setVolume(target->device, step.volume);
+                        break;
+                    }
+                    ++firing.actions;
+                    if (FAILED(hr))
+                        ++firing.failures;
+                }
+            }
+
+            firing.latencyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - job.queued).count();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_stats.firings;
+                m_stats.actions += firing.actions;
+                m_stats.failures += firing.failures;
+                m_stats.lastLatencyNs = firing.latencyNs;
+                m_stats.maxLatencyNs = std::max(m_stats.maxLatencyNs, firing.latencyNs);
+                m_stats.totalLatencyNs += firing.latencyNs;
+            }
+            if (m_onFired)
+                m_onFired(firing);
+        }
+    }
+
+    /**
+     * @brief Reads an endpoint seen for the first time and recompiles every program.
+     *
+     * Recompiling (rather than compiling just the newcomer) also lets existing rules
+     * target it, e.g. "mute every headset" once a second headset exists.
+     *
+     * @return The endpoint, or nullptr if it is not active (any more) or already known.
+     */
+    RuleEngine::Endpoint *RuleEngine::learn(const std::wstring &deviceId)
+    {
+        for (EDataFlow flow : {eRender, eCapture})
+        {
+            std::wstring name;
+            EndpointFormFactor formFactor = UnknownFormFactor;
+            IMMDevice *device = nullptr;
+            m_backend->enumerateDevices(flow, [&](const std::wstring &id, const std::wstring &friendlyName, IMMDevice *found)
+                                        {
+                                            if (device || id != deviceId)
+                                                return;
+                                            name = friendlyName;
+                                            m_backend->getFormFactor(found, formFactor);
+                                            found->AddRef();
+                                            device = found; });
+            if (!device)
+                continue;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Endpoint *endpoint = addEndpointLocked(deviceId, name, flow, formFactor, device);
+            if (!endpoint)
+            {
+                SafeRelease(device);
+                return nullptr;
+            }
+            endpoint->active = true;
+            ++m_stats.events;
+            ++m_stats.learned;
+            compileLocked();
+            return endpoint;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Adds an endpoint (taking the device reference); nullptr if the ID is known.
+     */
+    RuleEngine::Endpoint *RuleEngine::addEndpointLocked(const std::wstring &id, const std::wstring &name, EDataFlow flow,
+                                                        EndpointFormFactor formFactor, IMMDevice *device)
+    {
+        std::unique_ptr<Endpoint> &slot = m_endpoints[id];
+        if (slot)
+            return nullptr;
+        slot.reset(new Endpoint());
+        slot->id = id;
+        slot->name = name;
+        slot->flow = flow;
+        slot->formFactor = formFactor;
+        slot->device = device;
+        return slot.get();
+    }
+
+    /**
+     * @brief Builds each endpoint's arrival and removal programs.
+     *
+     * Programs are replaced, not edited, so a job holding the previous one keeps
+     * running it unchanged.
+     */
+    void RuleEngine::compileLocked()
+    {
+        for (auto &entry : m_endpoints)
+        {
+            Endpoint &endpoint = *entry.second;
+            for (RuleTrigger trigger : {RuleTrigger::Arrival, RuleTrigger::Removal})
+            {
+                auto program = std::make_shared<Program>();
+                for (size_t i = 0; i < m_rules.size(); ++i)
+                {
+                    const DeviceRule &rule = m_rules[i];
+                    if (rule.trigger != trigger || !Matches(rule.match, endpoint))
+                        continue;
+
+                    Binding binding;
+                    binding.rule = i;
+                    for (const RuleAction &action : rule.actions)
+                    {
+                        Step step;
+                        step.type = action.type;
+                        step.roles = action.roles;
+                        step.volume = action.volume;
+                        step.targets = resolveLocked(action, endpoint);
+                        binding.steps.push_back(std::move(step));
+                    }
+                    program->push_back(std::move(binding));
+                }
+                endpoint.programs[TriggerIndex(trigger)] = program->empty() ? nullptr : std::move(program);
+            }
+        }
+    }
+
+    std::vector<RuleEngine::Endpoint *> RuleEngine::resolveLocked(const RuleAction &action, Endpoint &source) const
+    {
+        if (action.target.any())
+            return std::vector<Endpoint *>(1, &source);
+
+        std::vector<Endpoint *> targets;
+        for (const auto &entry : m_endpoints)
+            if (Matches(action.target, *entry.second))
+                targets.push_back(entry.second.get());
+        return targets;
+    }
+
+    bool RuleEngine::Matches(const DeviceMatch &match, const Endpoint &endpoint)
+    {
+        if (!match.id.empty() && match.id != endpoint.id)
+            return false;
+        if (match.flow != eAll && match.flow != endpoint.flow)
+            return false;
+        if (match.formFactor != UnknownFormFactor && match.formFactor != endpoint.formFactor)
+            return false;
+        return match.namePattern.empty() || GlobMatch(match.namePattern, endpoint.name);
+    }
+}
@@ -0,0 +1,399 @@
+#include "Devices/SessionTable.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <utility>
+
+namespace Devices
+{
+    using Backend::SessionInfo;
+    using Backend::SessionState;
+
+    namespace
+    {
+        std::wstring Lower(const std::wstring &text)
+        {
+            std::wstring lower(text);
+            for (wchar_t &c : lower)
+                c = static_cast<wchar_t>(std::towlower(c));
+            return lower;
+        }
+
+        template <typename Key>
+        void EraseIndex(std::unordered_map<Key, std::vector<std::wstring>> &index, const Key &key, const std::wstring &instanceId)
+        {
+            auto it = index.find(key);
+            if (it == index.end())
+                return;
+            std::vector<std::wstring> &ids = it->second;
+            ids.erase(std::remove(ids.begin(), ids.end(), instanceId), ids.end());
+            if (ids.empty())
+                index.erase(it);
+        }
+    }
+
+    SessionTable::SessionTable(std::shared_ptr<Backend::ISessionBackend> backend) : m_backend(std::move(backend)) {}
+
+    SessionTable::~SessionTable()
+    {
+        detachAll();
+    }
+
+    /**
+     * @brief Registers for the endpoint's session events, then enumerates its sessions.
+     *
+     * Registering first means a session created during the enumeration is reported
+     * either way; the table merges both by instance ID.
+     */
+    HRESULT SessionTable::attach(const std::wstring &deviceId)
+    {
+        if (!m_backend)
+            return E_POINTER;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (std::find(m_devices.begin(), m_devices.end(), deviceId) != m_devices.end())
+                return S_FALSE;
+            m_devices.push_back(deviceId);
+        }
+
+        HRESULT hr = m_backend->registerListener(deviceId, this);
+        if (FAILED(hr))
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_devices.erase(std::remove(m_devices.begin(), m_devices.end(), deviceId), m_devices.end());
+            return hr;
+        }
+
+        std::vector<std::pair<SessionInfo, std::shared_ptr<Backend::ISessionVolume>>> found;
+        hr = m_backend->enumerateSessions(deviceId, [&](const SessionInfo &session, const std::shared_ptr<Backend::ISessionVolume> &volume)
+                                          { found.emplace_back(session, volume); });
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_enumerations;
+        for (const auto &session : found)
+            upsertLocked(session.first, session.second);
+        return SUCCEEDED(hr) ? S_OK : hr;
+    }
+
+    HRESULT SessionTable::attachAll(EDataFlow flow)
+    {
+        std::vector<std::wstring> ids;
+        HRESULT hr = Backend::GetAudioBackend()->enumerateDevices(flow, [&](const std::wstring &id, const std::wstring &, IMMDevice *)
+                                                                  { ids.push_back(id); });
+        if (FAILED(hr))
+            return hr;
+
+        for (const std::wstring &id : ids)
+        {
+            const HRESULT attached = attach(id);
+            if (FAILED(attached))
+                hr = attached;
+        }
+        return hr;
+    }
+
+    /**
+     * @brief Stops tracking an endpoint and drops its sessions.
+     */
+    void SessionTable::detach(const std::wstring &deviceId)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = std::find(m_devices.begin(), m_devices.end(), deviceId);
+            if (it == m_devices.end())
+                return;
+            m_devices.erase(it);
+        }
+
+        // Outside the lock: unregistering waits for callbacks, which take it
+        if (m_backend)
+            m_backend->unregisterListener(deviceId, this);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<std::wstring> gone;
+        for (const auto &entry : m_sessions)
+            if (entry.second.info.deviceId == deviceId)
+                gone.push_back(entry.first);
+        for (const std::wstring &instanceId : gone)
+            removeLocked(instanceId);
+    }
+
+    void SessionTable::detachAll()
+    {
+        std::vector<std::wstring> devices;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            devices = m_devices;
+        }
+        for (const std::wstring &deviceId : devices)
+            detach(deviceId);
+    }
+
+    std::vector<SessionInfo> SessionTable::sessions() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return collectLocked(nullptr);
+    }
+
+    std::vector<SessionInfo> SessionTable::sessionsForProcess(DWORD processId) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_byProcess.find(processId);
+        return it == m_byProcess.end() ? std::vector<SessionInfo>() : collectLocked(&it->second);
+    }
+
+    std::vector<SessionInfo> SessionTable::sessionsForExecutable(const std::wstring &executable) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_byExecutable.find(Lower(executable));
+        return it == m_byExecutable.end() ? std::vector<SessionInfo>() : collectLocked(&it->second);
+    }
+
+    bool SessionTable::findSession(const std::wstring &instanceId, SessionInfo &out) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_sessions.find(instanceId);
+        if (it == m_sessions.end())
+            return false;
+        out = it->second.info;
+        return true;
+    }
+
+    HRESULT SessionTable::setProcessVolume(DWORD processId, float volume)
+    {
+        std::vector<Target> targets;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_byProcess.find(processId);
+            if (it != m_byProcess.end())
+                targets = targetsLocked(&it->second);
+        }
+        return apply(targets, &volume, nullptr);
+    }
+
+    HRESULT SessionTable::setProcessMute(DWORD processId, bool mute)
+    {
+        std::vector<Target> targets;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_byProcess.find(processId);
+            if (it != m_byProcess.end())
+                targets = targetsLocked(&it->second);
+        }
+        return apply(targets, nullptr, &mute);
+    }
+
+    HRESULT SessionTable::setExecutableVolume(const std::wstring &executable, float volume)
+    {
+        std::vector<Target> targets;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_byExecutable.find(Lower(executable));
+            if (it != m_byExecutable.end())
+                targets = targetsLocked(&it->second);
+        }
+        return apply(targets, &volume, nullptr);
+    }
+
+    HRESULT SessionTable::setExecutableMute(const std::wstring &executable, bool mute)
+    {
+        std::vector<Target> targets;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_byExecutable.find(Lower(executable));
+            if (it != m_byExecutable.end())
+                targets = targetsLocked(&it->second);
+        }
+        return apply(targets, nullptr, &mute);
+    }
+
+    HRESULT SessionTable::setSessionVolume(const std::wstring &instanceId, float volume)
+    {
+        const std::vector<std::wstring> ids(1, instanceId);
+        std::vector<Target> targets;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            targets = targetsLocked(&ids);
+        }
+        return apply(targets, &volume, nullptr);
+    }
+
+    HRESULT SessionTable::setSessionMute(const std::wstring &instanceId, bool mute)
+    {
+        const std::vector<std::wstring> ids(1, instanceId);
+        std::vector<Target> targets;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            targets = targetsLocked(&ids);
+        }
+        return apply(targets, nullptr, &mute);
+    }
+
+    SessionTableStats SessionTable::stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        SessionTableStats stats;
+        stats.devices = m_devices.size();
+        stats.sessions = m_sessions.size();
+        stats.processes = m_byProcess.size();
+        stats.enumerations = m_enumerations;
+        stats.events = m_events;
+        return stats;
+    }
+
+    void SessionTable::onSessionCreated(const SessionInfo &session, const std::shared_ptr<Backend::ISessionVolume> &volume)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_events;
+        upsertLocked(session, volume);
+    }
+
+    void SessionTable::onSessionStateChanged(const std::wstring &instanceId, SessionState state)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_events;
+        if (state == SessionState::Expired)
+        {
+            removeLocked(instanceId);
+            return;
+        }
+        auto it = m_sessions.find(instanceId);
+        if (it != m_sessions.end())
+            it->second.info.state = state;
+    }
+
+    void SessionTable::onSessionVolumeChanged(const std::wstring &instanceId, float volume, bool muted)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_events;
+        auto it = m_sessions.find(instanceId);
+        if (it == m_sessions.end())
+            return;
+        it->second.info.volume = volume;
+        it->second.info.muted = muted;
+    }
+
+    void SessionTable::onSessionDisconnected(const std::wstring &instanceId)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_events;
+        removeLocked(instanceId);
+    }
+
+    /**
+     * @brief Inserts or refreshes a session, keeping the process and executable indexes in step.
+     */
+    void SessionTable::upsertLocked(const SessionInfo &session, const std::shared_ptr<Backend::ISessionVolume> &volume)
+    {
+        if (session.state == SessionState::Expired)
+        {
+            removeLocked(session.instanceId);
+            return;
+        }
+
+        auto it = m_sessions.find(session.instanceId);
+        if (it != m_sessions.end())
+        {
+            // Same instance ID means same process and image: only the mutable fields move
+            it->second.info.state = session.state;
+            it->second.info.volume = session.volume;
+            it->second.info.muted = session.muted;
+            it->second.info.displayName = session.displayName;
+            if (volume)
+                it->second.volume = volume;
+            return;
+        }
+
+        Entry &entry = m_sessions[session.instanceId];
+        entry.info = session;
+        entry.volume = volume;
+        m_byProcess[session.processId].push_back(session.instanceId);
+        if (!session.executable.empty())
+            m_byExecutable[Lower(session.executable)].push_back(session.instanceId);
+    }
+
+    void SessionTable::removeLocked(const std::wstring &instanceId)
+    {
+        auto it = m_sessions.find(instanceId);
+        if (it == m_sessions.end())
+            return;
+        EraseIndex(m_byProcess, it->second.info.processId, instanceId);
+        if (!it->second.info.executable.empty())
+            EraseIndex(m_byExecutable, Lower(it->second.info.executable), instanceId);
+        m_sessions.erase(it);
+    }
+
+    /**
+     * @brief Copies the listed sessions, or all of them for nullptr.
+     */
+    std::vector<SessionInfo> SessionTable::collectLocked(const std::vector<std::wstring> *instanceIds) const
+    {
+        std::vector<SessionInfo> out;
+        if (!instanceIds)
+        {
+            out.reserve(m_sessions.size());
+            for (const auto &entry : m_sessions)
+                out.push_back(entry.second.info);
+            return out;
+        }
+
+        out.reserve(instanceIds->size());
+        for (const std::wstring &instanceId : *instanceIds)
+        {
+            auto it = m_sessions.find(instanceId);
+            if (it != m_sessions.end())
+                out.push_back(it->second.info);
+        }
+        return out;
+    }
+
+    std::vector<SessionTable::Target> SessionTable::targetsLocked(const std::vector<std::wstring> *instanceIds) const
+    {
+        std::vector<Target> targets;
+        for (const std::wstring &instanceId : *instanceIds)
+        {
+            auto it = m_sessions.find(instanceId);
+            if (it != m_sessions.end() && it->second.volume)
+                targets.emplace_back(instanceId, it->second.volume);
+        }
+        return targets;
+    }
+
+    /**
+     * @brief Calls the cached volume controls outside the lock and mirrors successful changes.
+     *
+     * The backend's own volume notification would update the entry too, but on Core
+     * Audio it arrives asynchronously; updating here keeps reads consistent with writes.
+     *
+     * @return E_NOTFOUND without targets, otherwise S_OK or the last failure.
+     */
+    HRESULT SessionTable::apply(const std::vector<Target> &targets, const float *volume, const bool *mute)
+    {
+        if (targets.empty())
+            return E_NOTFOUND;
+        if (volume && (*volume < 0.0f || *volume > 1.0f))
+            return E_INVALIDARG;
+
+        HRESULT result = S_OK;
+        for (const Target &target : targets)
+        {
+            const HRESULT hr = volume ? target.second->setVolume(*volume) : target.second->setMute(*mute);
+            if (FAILED(hr))
+            {
+                result = hr;
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_sessions.find(target.first);
+            if (it == m_sessions.end())
+                continue;
+            if (volume)
+                it->second.info.volume = *volume;
+            else
+                it->second.info.muted = *mute;
+        }
+        return result;
+    }
+}
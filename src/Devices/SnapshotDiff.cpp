@@ -0,0 +1,179 @@
+#include "Devices/SnapshotDiff.h"
+
+#include <utility>
+
+namespace Devices
+{
+    namespace
+    {
+        constexpr uint64_t kFnvOffset = 1469598103934665603ull;
+        constexpr uint64_t kFnvPrime = 1099511628211ull;
+        constexpr size_t kMinTableSize = 16;
+
+        uint64_t Mix(uint64_t hash, uint64_t value)
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                hash ^= (value >> (8 * i)) & 0xFF;
+                hash *= kFnvPrime;
+            }
+            return hash;
+        }
+
+        uint64_t HashText(const std::wstring &text)
+        {
+            uint64_t hash = kFnvOffset;
+            for (wchar_t c : text)
+                hash = (hash ^ static_cast<uint32_t>(c)) * kFnvPrime;
+            return Mix(hash, text.size());
+        }
+
+        /**
+         * @brief Hash of the fields DeviceRecord::operator== compares (a constant for an unreadable format).
+         */
+        uint64_t HashFormat(const Utility::DeviceFormatInfo &format)
+        {
+            if (!format.valid)
+                return 0;
+            uint64_t hash = Mix(kFnvOffset, format.sampleRate);
+            hash = Mix(hash, format.channelMask);
+            hash = Mix(hash, (static_cast<uint64_t>(format.bitDepth) << 32) | (static_cast<uint64_t>(format.channels) << 16) |
+                                 format.blockAlign);
+            return Mix(hash, format.isFloat ? 2 : 1);
+        }
+    }
+
+    size_t SnapshotDiff::count(uint32_t flags) const
+    {
+        size_t n = 0;
+        for (const DeviceChange &change : changes)
+            n += (change.flags & flags) != 0;
+        return n;
+    }
+
+    /**
+     * @brief Hashes the new snapshot, pairs it with the baseline through the ID table and classifies.
+     */
+    const SnapshotDiff &SnapshotDiffer::update(std::vector<DeviceRecord> snapshot)
+    {
+        // The table built by the last update() indexes what is now m_previous
+        m_previous.swap(m_current);
+        m_previousHashes.swap(m_currentHashes);
+        m_current = std::move(snapshot);
+
+        m_currentHashes.resize(m_current.size());
+        for (size_t i = 0; i < m_current.size(); ++i)
+        {
+            const DeviceRecord &record = m_current[i];
+            Hashes &hashes = m_currentHashes[i];
+            hashes.id = HashText(record.id);
+            hashes.name = HashText(record.name);
+            hashes.format = HashFormat(record.format);
+            hashes.content = Mix(Mix(Mix(hashes.name, hashes.format), record.state),
+                                 (record.isDefault ? 2u : 0u) | static_cast<uint32_t>(record.flow));
+        }
+
+        m_diff.changes.clear();
+        m_diff.unchanged = 0;
+        m_matched.assign(m_previous.size(), 0);
+        const size_t mask = m_table.empty() ? 0 : m_table.size() - 1;
+
+        for (size_t i = 0; i < m_current.size(); ++i)
+        {
+            const DeviceRecord &record = m_current[i];
+            const Hashes &hashes = m_currentHashes[i];
+
+            uint32_t found = DeviceChange::None;
+            for (size_t slot = hashes.id & mask; !m_table.empty() && m_table[slot]; slot = (slot + 1) & mask)
+            {
+                const uint32_t candidate = m_table[slot] - 1;
+                if (!m_matched[candidate] && m_previousHashes[candidate].id == hashes.id &&
+                    m_previous[candidate].flow == record.flow && m_previous[candidate].id == record.id)
+                {
+                    found = candidate;
+                    break;
+                }
+            }
+
+            DeviceChange change;
+            change.after = static_cast<uint32_t>(i);
+            if (found == DeviceChange::None)
+            {
+                change.flags = DeviceAdded;
+                m_diff.changes.push_back(change);
+                continue;
+            }
+
+            m_matched[found] = 1;
+            const Hashes &old = m_previousHashes[found];
+            if (old.content == hashes.content)
+            {
+                ++m_diff.unchanged;
+                continue;
+            }
+
+            const DeviceRecord &before = m_previous[found];
+            change.before = found;
+            if (before.state != record.state)
+                change.flags |= static_cast<uint32_t>(DeviceStateChanged);
+            if (old.name != hashes.name)
+                change.flags |= static_cast<uint32_t>(DeviceRenamed);
+            if (old.format != hashes.format)
+                change.flags |= static_cast<uint32_t>(DeviceFormatChanged);
+            if (before.isDefault != record.isDefault)
+                change.flags |= static_cast<uint32_t>(DeviceDefaultChanged);
+            m_diff.changes.push_back(change);
+        }
+
+        for (size_t j = 0; j < m_previous.size(); ++j)
+        {
+            if (m_matched[j])
+                continue;
+            DeviceChange change;
+            change.flags = DeviceRemoved;
+            change.before = static_cast<uint32_t>(j);
+            m_diff.changes.push_back(change);
+        }
+
+        index();
+        return m_diff;
+    }
+
+    void SnapshotDiffer::reset()
+    {
+        m_previous.clear();
+        m_current.clear();
+        m_previousHashes.clear();
+        m_currentHashes.clear();
+        m_table.clear();
+        m_matched.clear();
+        m_diff = SnapshotDiff();
+    }
+
+    /**
+     * @brief Rebuilds the ID table over m_current at no more than half load.
+     */
+    void SnapshotDiffer::index()
+    {
+        size_t size = kMinTableSize;
+        while (size < 2 * m_current.size())
+            size *= 2;
+        m_table.assign(size, 0);
+
+        const size_t mask = size - 1;
+        for (size_t i = 0; i < m_current.size(); ++i)
+        {
+            size_t slot = m_currentHashes[i].id & mask;
+            while (m_table[slot])
+                slot = (slot + 1) & mask;
+            m_table[slot] = static_cast<uint32_t>(i + 1);
+        }
+    }
+
+    SnapshotDiff DiffSnapshots(const std::vector<DeviceRecord> &before, const std::vector<DeviceRecord> &after)
+    {
+        SnapshotDiffer differ;
+        differ.update(before);
+        return differ.update(after);
+    }
+}
@@ -0,0 +1,97 @@
+#include "Devices/WasapiDeviceEnumerator.h"
+#include "Utility/COMInitializer.h"
+#include "Utility/DeviceUtils.h"
+#include "Utility/SafeRelease.h"
+
+#include <windows.h>
+#include <mmdeviceapi.h>
+#include <memory>
+#include <stdexcept>
+
+namespace Devices
+{
+    namespace
+    {
+        /**
+         * @brief Appends the active endpoints of one flow.
+         */
+        bool EnumerateFlow(IMMDeviceEnumerator *pEnum, EDataFlow flow, std::vector<DeviceRecord> &out)
+        {
+            IMMDeviceCollection *pDevices = nullptr;
+            if (FAILED(pEnum->EnumAudioEndpoints(flow, DEVICE_STATE_ACTIVE, &pDevices)))
+                return false;
+
+            // Default console endpoint, to flag it (none is fine: no device of this flow)
+            std::wstring defaultId;
+            IMMDevice *pDefault = nullptr;
+            if (SUCCEEDED(pEnum->GetDefaultAudioEndpoint(flow, eConsole, &pDefault)) && pDefault)
+            {
+                LPWSTR id = nullptr;
+                if (SUCCEEDED(pDefault->GetId(&id)) && id)
+                {
+                    defaultId = id;
+                    CoTaskMemFree(id);
+                }
+                Utility::SafeRelease(pDefault);
+            }
+
+            UINT count = 0;
+            pDevices->GetCount(&count);
+            for (UINT i = 0; i < count; ++i)
+            {
+                IMMDevice *pDevice = nullptr;
+                if (FAILED(pDevices->Item(i, &pDevice)) || !pDevice)
+                    continue;
+
+                LPWSTR id = nullptr;
+                if (SUCCEEDED(pDevice->GetId(&id)) && id)
+                {
+                    DeviceRecord record;
+                    record.id = id;
+                    record.name = Utility::GetDeviceFriendlyName(pDevice);
+                    record.flow = flow == eRender ? DeviceFlow::Render : DeviceFlow::Capture;
+                    record.isDefault = record.id == defaultId;
+                    record.format = Utility::GetDeviceFormatInfo(pDevice);
+                    out.push_back(std::move(record));
+                    CoTaskMemFree(id);
+                }
+
+                Utility::SafeRelease(pDevice);
+            }
+
+            Utility::SafeRelease(pDevices);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Enumerates render then capture endpoints.
+     *
+     * @param out Receives the records (cleared first).
+     * @return true on success.
+     */
+    bool EnumerateWasapiDevices(std::vector<DeviceRecord> &out)
+    {
+        out.clear();
+
+        std::unique_ptr<Utility::COMInitializer> com;
+        try
+        {
+            com = std::make_unique<Utility::COMInitializer>();
+        }
+        catch (const std::exception &)
+        {
+            // COM already initialised with another model on this thread; use it as is
+        }
+
+        IMMDeviceEnumerator *pEnum = nullptr;
+        HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                                      __uuidof(IMMDeviceEnumerator), (void **)&pEnum);
+        if (FAILED(hr))
+            return false;
+
+        const bool ok = EnumerateFlow(pEnum, eRender, out) && EnumerateFlow(pEnum, eCapture, out);
+        Utility::SafeRelease(pEnum);
+        return ok;
+    }
+}
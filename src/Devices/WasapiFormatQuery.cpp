@@ -0,0 +1,230 @@
+#include "Devices/WasapiFormatQuery.h"
+#include "Utility/DeviceUtils.h"
+#include "Utility/SafeRelease.h"
+
+#include <windows.h>
+#include <audioclient.h>
+#include <mmreg.h>          // For WAVEFORMATEXTENSIBLE
+#include <ksmedia.h>        // For KSDATAFORMAT_SUBTYPE_*
+#include <propvarutil.h>    // For PropVariantClear
+#include <cstdio>
+#include <stdexcept>
+
+namespace Devices
+{
+    namespace
+    {
+        // DEVPKEY_Device_DriverVersion, exposed as a property key on the endpoint store
+        const PROPERTYKEY kDriverVersionKey = {{0xa8b865dd, 0x2e3d, 0x4094, {0xad, 0x97, 0xe5, 0x93, 0xa7, 0x0c, 0x75, 0xd6}}, 3};
+
+        // PKEY_AudioEngine_DeviceFormat: the format the engine opens the device with
+        const PROPERTYKEY kDeviceFormatKey = {{0xf19f064d, 0x082c, 0x4e27, {0xbc, 0x73, 0x68, 0x82, 0xa1, 0xbb, 0x8e, 0x4c}}, 0};
+
+        /**
+         * @brief Reads the driver version, or a fingerprint of the engine device format.
+         *
+         * Not every endpoint store exposes the driver version; the device format blob
+         * changes with most driver updates and is the best available substitute.
+         */
+        std::wstring ReadDriverVersion(IMMDevice *device)
+        {
+            IPropertyStore *pStore = nullptr;
+            if (FAILED(device->OpenPropertyStore(STGM_READ, &pStore)) || !pStore)
+                return L"unknown";
+
+            std::wstring version;
+            PROPVARIANT prop;
+            PropVariantInit(&prop);
+            if (SUCCEEDED(pStore->GetValue(kDriverVersionKey, &prop)) && prop.vt == VT_LPWSTR && prop.pwszVal)
+                version = prop.pwszVal;
+            PropVariantClear(&prop);
+
+            if (version.empty())
+            {
+                PropVariantInit(&prop);
+                if (SUCCEEDED(pStore->GetValue(kDeviceFormatKey, &prop)) && prop.vt == VT_BLOB && prop.blob.pBlobData)
+                {
+                    uint64_t hash = 1469598103934665603ull;
+                    for (ULONG i = 0; i < prop.blob.cbSize; ++i)
+                        hash = (hash ^ prop.blob.pBlobData[i]) * 1099511628211ull;
+
+                    wchar_t text[32];
+                    swprintf(text, 32, L"fmt-%016llx", static_cast<unsigned long long>(hash));
+                    version = text;
+                }
+                PropVariantClear(&prop);
+            }
+
+            Utility::SafeRelease(pStore);
+            return version.empty() ? L"unknown" : version;
+        }
+    }
+
+    /**
+     * @brief Constructor - keeps a reference to the device and reads its identity.
+     *
+     * @param device Endpoint.
+     */
+    WasapiFormatQuery::WasapiFormatQuery(IMMDevice *device) : m_device(device)
+    {
+        if (!m_device)
+            return;
+
+        m_device->AddRef();
+
+        LPWSTR id = nullptr;
+        if (SUCCEEDED(m_device->GetId(&id)) && id)
+        {
+            m_id = id;
+            CoTaskMemFree(id);
+        }
+        m_driverVersion = ReadDriverVersion(m_device);
+    }
+
+    /**
+     * @brief Destructor - releases the client and the device.
+     */
+    WasapiFormatQuery::~WasapiFormatQuery()
+    {
+        Utility::SafeRelease(m_client);
+        Utility::SafeRelease(m_device);
+    }
+
+    /**
+     * @brief Activates the IAudioClient on first use.
+     */
+    bool WasapiFormatQuery::ensureClient()
+    {
+        if (m_client)
+            return true;
+        if (!m_device)
+            return false;
+
+        HRESULT hr = m_device->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr, (void **)&m_client);
+        return SUCCEEDED(hr) && m_client;
+    }
+
+    /**
+     * @brief Reads the shared-mode mix format.
+     */
+    bool WasapiFormatQuery::mixFormat(Utility::DeviceFormatInfo &format)
+    {
+        if (!ensureClient())
+            return false;
+
+        WAVEFORMATEX *pwfx = nullptr;
+        if (FAILED(m_client->GetMixFormat(&pwfx)) || !pwfx)
+            return false;
+
+        format = Utility::GetWaveFormatInfo(pwfx);
+        CoTaskMemFree(pwfx);
+        return format.valid;
+    }
+
+    /**
+     * @brief Reads the default and minimum device periods.
+     */
+    bool WasapiFormatQuery::devicePeriods(int64_t &defaultHns, int64_t &minimumHns)
+    {
+        if (!ensureClient())
+            return false;
+
+        REFERENCE_TIME defaultPeriod = 0, minimumPeriod = 0;
+        if (FAILED(m_client->GetDevicePeriod(&defaultPeriod, &minimumPeriod)))
+            return false;
+
+        defaultHns = defaultPeriod;
+        minimumHns = minimumPeriod;
+        return true;
+    }
+
+    /**
+     * @brief Asks IAudioClient::IsFormatSupported about a WAVEFORMATEXTENSIBLE.
+     *
+     * Shared mode answers S_FALSE with a closest match when it would convert; only an
+     * exact S_OK counts as supported.
+     *
+     * @param mode Sharing mode.
+     * @param format Candidate format.
+     * @param validBits Significant bits per sample.
+     * @return true if the format is accepted unchanged.
+     */
+    bool WasapiFormatQuery::isFormatSupported(ShareMode mode, const Utility::DeviceFormatInfo &format, uint16_t validBits)
+    {
+        if (!ensureClient())
+            return false;
+
+        WAVEFORMATEXTENSIBLE wfx = {};
+        wfx.Format.wFormatTag = WAVE_FORMAT_EXTENSIBLE;
+        wfx.Format.nChannels = format.channels;
+        wfx.Format.nSamplesPerSec = format.sampleRate;
+        wfx.Format.wBitsPerSample = format.bitDepth;
+        wfx.Format.nBlockAlign = static_cast<WORD>(format.channels * (format.bitDepth / 8));
+        wfx.Format.nAvgBytesPerSec = format.sampleRate * wfx.Format.nBlockAlign;
+        wfx.Format.cbSize = sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX);
+        wfx.Samples.wValidBitsPerSample = validBits;
+        wfx.dwChannelMask = format.channelMask;
+        wfx.SubFormat = format.isFloat ? KSDATAFORMAT_SUBTYPE_IEEE_FLOAT : KSDATAFORMAT_SUBTYPE_PCM;
+
+        const WAVEFORMATEX *candidate = reinterpret_cast<const WAVEFORMATEX *>(&wfx);
+        if (mode == ShareMode::Exclusive)
+            return m_client->IsFormatSupported(AUDCLNT_SHAREMODE_EXCLUSIVE, candidate, nullptr) == S_OK;
+
+        WAVEFORMATEX *closest = nullptr;
+        HRESULT hr = m_client->IsFormatSupported(AUDCLNT_SHAREMODE_SHARED, candidate, &closest);
+        if (closest)
+            CoTaskMemFree(closest);
+        return hr == S_OK;
+    }
+
+    /**
+     * @brief Releases the client activated by the queries.
+     */
+    void WasapiFormatQuery::finish()
+    {
+        Utility::SafeRelease(m_client);
+    }
+
+    /**
+     * @brief Enumerates active endpoints and wraps each in a WasapiFormatQuery.
+     *
+     * @param flow eRender or eCapture.
+     * @return std::vector<std::unique_ptr<IFormatQuery>> One query per device.
+     * @throws std::runtime_error If the enumerator or the collection cannot be created.
+     */
+    std::vector<std::unique_ptr<IFormatQuery>> CreateWasapiFormatQueries(EDataFlow flow)
+    {
+        std::vector<std::unique_ptr<IFormatQuery>> queries;
+
+        IMMDeviceEnumerator *pEnum = nullptr;
+        IMMDeviceCollection *pDevices = nullptr;
+
+        HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                                      __uuidof(IMMDeviceEnumerator), (void **)&pEnum);
+        if (FAILED(hr))
+            throw std::runtime_error("[x] Failed to create device enumerator.");
+
+        hr = pEnum->EnumAudioEndpoints(flow, DEVICE_STATE_ACTIVE, &pDevices);
+        if (FAILED(hr))
+        {
+            Utility::SafeRelease(pEnum);
+            throw std::runtime_error("[x] Failed to enumerate audio endpoints.");
+        }
+
+        UINT count = 0;
+        pDevices->GetCount(&count);
+        for (UINT i = 0; i < count; ++i)
+        {
+            IMMDevice *pDevice = nullptr;
+            if (FAILED(pDevices->Item(i, &pDevice)) || !pDevice)
+                continue;
+
+            queries.push_back(std::make_unique<WasapiFormatQuery>(pDevice));
+            Utility::SafeRelease(pDevice);
+        }
+
+        Utility::SafeRelease(pDevices);
+        Utility::SafeRelease(pEnum);
+        return queries;
+    }
+}
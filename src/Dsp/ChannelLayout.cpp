@@ -0,0 +1,96 @@
+#include "Dsp/ChannelLayout.h"
+
+namespace Dsp
+{
+    /**
+     * @brief Counts the set bits of a channel mask.
+     *
+     * @param channelMask Speaker mask.
+     * @return uint32_t Number of speaker positions.
+     */
+    uint32_t ChannelCount(uint32_t channelMask)
+    {
+        uint32_t count = 0;
+        while (channelMask)
+        {
+            channelMask &= channelMask - 1; // Clear lowest set bit
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Finds the interleaved position of a speaker.
+     *
+     * Channels are interleaved in ascending bit order, so the index is the number
+     * of mask bits below the speaker bit.
+     *
+     * @param channelMask Speaker mask describing the stream.
+     * @param speaker Single speaker bit to look up.
+     * @return int Channel index, or -1 if the speaker is not present.
+     */
+    int ChannelIndex(uint32_t channelMask, uint32_t speaker)
+    {
+        if ((channelMask & speaker) == 0)
+            return -1;
+
+        return static_cast<int>(ChannelCount(channelMask & (speaker - 1)));
+    }
+
+    /**
+     * @brief Maps a bare channel count to the layout Windows uses for it.
+     *
+     * Counts without a well-known layout are assigned the lowest speaker bits.
+     *
+     * @param channels Channel count.
+     * @return uint32_t Channel mask, or 0 for 0 channels.
+     */
+    uint32_t DefaultChannelMask(uint16_t channels)
+    {
+        switch (channels)
+        {
+        case 0:
+            return 0;
+        case 1:
+            return Layout::Mono;
+        case 2:
+            return Layout::Stereo;
+        case 3:
+            return Layout::Stereo | Speaker::FrontCenter;
+        case 4:
+            return Layout::Quad;
+        case 5:
+            return Layout::Quad | Speaker::FrontCenter;
+        case 6:
+            return Layout::FivePointOne;
+        case 7:
+            return Layout::FivePointOne | Speaker::BackCenter;
+        case 8:
+            return Layout::SevenPointOneSurround;
+        default:
+            break;
+        }
+
+        // Unknown layout: take the first N positions (max 18 defined speakers)
+        if (channels >= 18)
+            return 0x3FFFF;
+        return (1u << channels) - 1u;
+    }
+
+    /**
+     * @brief Resolves the channel mask of a device format.
+     *
+     * Devices that report a plain WAVEFORMATEX (or a mask that does not match
+     * the channel count) get the default layout for their channel count.
+     *
+     * @param format Device format.
+     * @return uint32_t Channel mask to use for mixing.
+     */
+    uint32_t EffectiveChannelMask(const Utility::DeviceFormatInfo &format)
+    {
+        if (format.channelMask != 0 && ChannelCount(format.channelMask) == format.channels)
+            return format.channelMask;
+
+        return DefaultChannelMask(format.channels);
+    }
+}
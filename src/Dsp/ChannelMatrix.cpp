@@ -0,0 +1,299 @@
+#include "Dsp/ChannelMatrix.h"
+#include "Dsp/ChannelLayout.h"
+#include "SimdKernels.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace Dsp
+{
+    namespace
+    {
+        constexpr float kMinus3dB = 0.70710678f;
+
+        struct FoldTarget
+        {
+            uint32_t speaker;
+            float gain;
+        };
+
+        /// One fold-down option: a speaker is redistributed to up to two other speakers.
+        struct FoldGroup
+        {
+            FoldTarget targets[2];
+            int count;
+        };
+
+        struct FoldRule
+        {
+            uint32_t speaker;
+            FoldGroup groups[3];
+            int groupCount;
+        };
+
+        // Fold-down preferences for each speaker that is missing in the destination layout.
+        // Groups are tried in order; the first group whose speakers all exist in the destination
+        // is used. If none match, the last group is resolved recursively (e.g. back → side → front).
+        const FoldRule kFoldRules[] = {
+            {Speaker::FrontLeft, {{{{Speaker::FrontCenter, kMinus3dB}}, 1}}, 1},
+            {Speaker::FrontRight, {{{{Speaker::FrontCenter, kMinus3dB}}, 1}}, 1},
+            {Speaker::FrontCenter,
+             {{{{Speaker::FrontLeft, kMinus3dB}, {Speaker::FrontRight, kMinus3dB}}, 2},
+              {{{Speaker::FrontLeftOfCenter, kMinus3dB}, {Speaker::FrontRightOfCenter, kMinus3dB}}, 2}},
+             2},
+            {Speaker::BackLeft, {{{{Speaker::SideLeft, 1.0f}}, 1}, {{{Speaker::FrontLeft, kMinus3dB}}, 1}}, 2},
+            {Speaker::BackRight, {{{{Speaker::SideRight, 1.0f}}, 1}, {{{Speaker::FrontRight, kMinus3dB}}, 1}}, 2},
+            {Speaker::SideLeft, {{{{Speaker::BackLeft, 1.0f}}, 1}, {{{Speaker::FrontLeft, kMinus3dB}}, 1}}, 2},
+            {Speaker::SideRight, {{{{Speaker::BackRight, 1.0f}}, 1}, {{{Speaker::FrontRight, kMinus3dB}}, 1}}, 2},
+            {Speaker::FrontLeftOfCenter, {{{{Speaker::FrontLeft, 1.0f}}, 1}}, 1},
+            {Speaker::FrontRightOfCenter, {{{{Speaker::FrontRight, 1.0f}}, 1}}, 1},
+            {Speaker::BackCenter,
+             {{{{Speaker::BackLeft, kMinus3dB}, {Speaker::BackRight, kMinus3dB}}, 2},
+              {{{Speaker::SideLeft, kMinus3dB}, {Speaker::SideRight, kMinus3dB}}, 2},
+              {{{Speaker::FrontLeft, 0.5f}, {Speaker::FrontRight, 0.5f}}, 2}},
+             3},
+            {Speaker::TopCenter, {{{{Speaker::FrontCenter, kMinus3dB}}, 1}}, 1},
+            {Speaker::TopFrontLeft, {{{{Speaker::FrontLeft, kMinus3dB}}, 1}}, 1},
+            {Speaker::TopFrontCenter, {{{{Speaker::FrontCenter, kMinus3dB}}, 1}}, 1},
+            {Speaker::TopFrontRight, {{{{Speaker::FrontRight, kMinus3dB}}, 1}}, 1},
+            {Speaker::TopBackLeft, {{{{Speaker::BackLeft, kMinus3dB}}, 1}}, 1},
+            {Speaker::TopBackCenter, {{{{Speaker::BackCenter, kMinus3dB}}, 1}}, 1},
+            {Speaker::TopBackRight, {{{{Speaker::BackRight, kMinus3dB}}, 1}}, 1},
+        };
+
+        const FoldRule *FindRule(uint32_t speaker)
+        {
+            for (const FoldRule &rule : kFoldRules)
+            {
+                if (rule.speaker == speaker)
+                    return &rule;
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief Adds the contribution of one source speaker to a matrix row set.
+         *
+         * @param speaker Source speaker bit.
+         * @param gain Accumulated gain along the fold chain.
+         * @param dstMask Destination layout.
+         * @param column Matrix column (source channel) being filled.
+         * @param srcChannels Column count of the matrix.
+         * @param matrix Dense dst-major matrix.
+         * @param depth Recursion guard.
+         */
+        void Route(uint32_t speaker, float gain, uint32_t dstMask, uint32_t column,
+                   uint32_t srcChannels, std::vector<float> &matrix, int depth)
+        {
+            int dst = ChannelIndex(dstMask, speaker);
+            if (dst >= 0)
+            {
+                matrix[static_cast<size_t>(dst) * srcChannels + column] += gain;
+                return;
+            }
+
+            const FoldRule *rule = FindRule(speaker);
+            if (!rule || depth > 3)
+                return; // No sensible destination: drop the channel
+
+            for (int g = 0; g < rule->groupCount; ++g)
+            {
+                const FoldGroup &group = rule->groups[g];
+                bool present = true;
+                for (int t = 0; t < group.count; ++t)
+                    present = present && (dstMask & group.targets[t].speaker) != 0;
+
+                if (present)
+                {
+                    for (int t = 0; t < group.count; ++t)
+                        Route(group.targets[t].speaker, gain * group.targets[t].gain, dstMask, column,
+                              srcChannels, matrix, depth + 1);
+                    return;
+                }
+            }
+
+            // Nothing directly available: keep folding through the most generic option
+            const FoldGroup &last = rule->groups[rule->groupCount - 1];
+            for (int t = 0; t < last.count; ++t)
+                Route(last.targets[t].speaker, gain * last.targets[t].gain, dstMask, column,
+                      srcChannels, matrix, depth + 1);
+        }
+    }
+
+    /**
+     * @brief Builds the mixing coefficients for a pair of speaker layouts.
+     *
+     * Every source speaker is routed to the same speaker if the destination has it,
+     * otherwise it is folded with the standard -3 dB rules (center → L/R, back ↔ side,
+     * surround → front, front → mono center). Speakers that only exist in the destination
+     * receive silence (passive up-mix), except mono which is spread to L/R at -3 dB.
+     *
+     * With `normalize`, all coefficients are divided by the largest row sum so a full
+     * scale input can never clip, while preserving the balance between outputs.
+     *
+     * @param srcMask Source speaker mask.
+     * @param dstMask Destination speaker mask.
+     * @param normalize Whether to normalise the matrix.
+     * @param lfeGain Gain for folding LFE into the front pair when the destination lacks LFE.
+     * @return true if the matrix was built, false if either mask is empty.
+     */
+    bool ChannelMatrix::build(uint32_t srcMask, uint32_t dstMask, bool normalize, float lfeGain)
+    {
+        m_srcMask = srcMask;
+        m_dstMask = dstMask;
+        m_srcChannels = ChannelCount(srcMask);
+        m_dstChannels = ChannelCount(dstMask);
+        m_identity = srcMask == dstMask;
+
+        m_coefficients.assign(static_cast<size_t>(m_srcChannels) * m_dstChannels, 0.0f);
+        m_taps.clear();
+        m_tapOffsets.assign(m_dstChannels + 1, 0);
+
+        if (!isValid())
+            return false;
+
+        // Route each source speaker (ascending bit order == interleaved order)
+        uint32_t column = 0;
+        for (uint32_t bit = 1; bit != 0 && bit <= srcMask; bit <<= 1)
+        {
+            if ((srcMask & bit) == 0)
+                continue;
+
+            if (bit == Speaker::LowFrequency && (dstMask & bit) == 0)
+            {
+                if (lfeGain > 0.0f)
+                {
+                    Route(Speaker::FrontLeft, lfeGain, dstMask, column, m_srcChannels, m_coefficients, 1);
+                    Route(Speaker::FrontRight, lfeGain, dstMask, column, m_srcChannels, m_coefficients, 1);
+                }
+            }
+            else
+            {
+                Route(bit, 1.0f, dstMask, column, m_srcChannels, m_coefficients, 0);
+            }
+            ++column;
+        }
+
+        if (normalize && !m_identity)
+        {
+            float maxRowSum = 0.0f;
+            for (uint32_t d = 0; d < m_dstChannels; ++d)
+            {
+                float rowSum = 0.0f;
+                for (uint32_t s = 0; s < m_srcChannels; ++s)
+                    rowSum += std::fabs(m_coefficients[static_cast<size_t>(d) * m_srcChannels + s]);
+                if (rowSum > maxRowSum)
+                    maxRowSum = rowSum;
+            }
+
+            if (maxRowSum > 1.0f)
+            {
+                for (float &c : m_coefficients)
+                    c /= maxRowSum;
+            }
+        }
+
+        // Sparse view used by process(): only non-zero taps are visited
+        for (uint32_t d = 0; d < m_dstChannels; ++d)
+        {
+            m_tapOffsets[d] = static_cast<uint32_t>(m_taps.size());
+            for (uint32_t s = 0; s < m_srcChannels; ++s)
+            {
+                float c = m_coefficients[static_cast<size_t>(d) * m_srcChannels + s];
+                if (c != 0.0f)
+                    m_taps.push_back({s, c});
+            }
+        }
+        m_tapOffsets[m_dstChannels] = static_cast<uint32_t>(m_taps.size());
+
+        m_planarIn.assign(static_cast<size_t>(m_srcChannels) * BlockFrames, 0.0f);
+        m_planarOut.assign(static_cast<size_t>(m_dstChannels) * BlockFrames, 0.0f);
+        return true;
+    }
+
+    /**
+     * @brief Builds the matrix from two device formats.
+     *
+     * @param src Input format.
+     * @param dst Output format.
+     * @param normalize Whether to normalise the matrix.
+     * @return true if the matrix was built.
+     */
+    bool ChannelMatrix::build(const Utility::DeviceFormatInfo &src, const Utility::DeviceFormatInfo &dst, bool normalize)
+    {
+        return build(EffectiveChannelMask(src), EffectiveChannelMask(dst), normalize);
+    }
+
+    /**
+     * @brief Applies the matrix to interleaved float frames.
+     *
+     * Identical layouts are copied straight through. Otherwise each block of
+     * BlockFrames frames is deinterleaved, mixed with MulAdd() per non-zero
+     * coefficient, and interleaved into `out`.
+     *
+     * @param in Interleaved input.
+     * @param out Interleaved output.
+     * @param frames Frame count.
+     */
+    void ChannelMatrix::process(const float *in, float *out, size_t frames)
+    {
+        if (!isValid() || frames == 0)
+            return;
+
+        if (m_identity)
+        {
+            std::memcpy(out, in, frames * m_srcChannels * sizeof(float));
+            return;
+        }
+
+        const size_t srcCh = m_srcChannels;
+        const size_t dstCh = m_dstChannels;
+
+        for (size_t offset = 0; offset < frames; offset += BlockFrames)
+        {
+            const size_t n = (frames - offset < BlockFrames) ? frames - offset : BlockFrames;
+            const float *src = in + offset * srcCh;
+            float *dst = out + offset * dstCh;
+
+            // Deinterleave into planar scratch
+            for (size_t s = 0; s < srcCh; ++s)
+            {
+                float *plane = m_planarIn.data() + s * BlockFrames;
+                for (size_t f = 0; f < n; ++f)
+                    plane[f] = src[f * srcCh + s];
+            }
+
+            // Mix: one vectorised multiply-accumulate per non-zero coefficient
+            for (size_t d = 0; d < dstCh; ++d)
+            {
+                float *acc = m_planarOut.data() + d * BlockFrames;
+                detail::Zero(acc, n);
+                for (uint32_t t = m_tapOffsets[d]; t < m_tapOffsets[d + 1]; ++t)
+                    detail::MulAdd(acc, m_planarIn.data() + m_taps[t].src * BlockFrames, m_taps[t].gain, n);
+            }
+
+            // Interleave into the output
+            for (size_t d = 0; d < dstCh; ++d)
+            {
+                const float *plane = m_planarOut.data() + d * BlockFrames;
+                for (size_t f = 0; f < n; ++f)
+                    dst[f * dstCh + d] = plane[f];
+            }
+        }
+    }
+
+    /**
+     * @brief Reads a single matrix coefficient.
+     *
+     * @param dstChannel Destination channel index.
+     * @param srcChannel Source channel index.
+     * @return float Coefficient, or 0 if out of range.
+     */
+    float ChannelMatrix::coefficient(uint32_t dstChannel, uint32_t srcChannel) const
+    {
+        if (dstChannel >= m_dstChannels || srcChannel >= m_srcChannels)
+            return 0.0f;
+
+        return m_coefficients[static_cast<size_t>(dstChannel) * m_srcChannels + srcChannel];
+    }
+}
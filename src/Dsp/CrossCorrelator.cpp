@@ -0,0 +1,93 @@
+#include "Dsp/CrossCorrelator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Dsp
+{
+    /**
+     * @brief Correlates in the frequency domain and refines the peak by parabolic interpolation.
+     *
+     * The transform is zero-padded to at least referenceLength + recordingLength so the
+     * circular correlation has no wrap-around in the searched lag range.
+     *
+     * @param reference Reference samples.
+     * @param referenceLength Reference length.
+     * @param recording Recorded samples.
+     * @param recordingLength Recording length.
+     * @return CorrelationPeak The best lag in [0, recordingLength).
+     */
+    CorrelationPeak CrossCorrelator::findDelay(const float *reference, size_t referenceLength,
+                                               const float *recording, size_t recordingLength)
+    {
+        CorrelationPeak result;
+        if (!reference || !recording || referenceLength == 0 || recordingLength == 0)
+            return result;
+
+        size_t n = 2;
+        while (n < referenceLength + recordingLength)
+            n <<= 1;
+        if (m_fft.size() != n && !m_fft.configure(n))
+            return result;
+
+        m_refRe.assign(n, 0.0f);
+        m_refIm.assign(n, 0.0f);
+        m_recRe.assign(n, 0.0f);
+        m_recIm.assign(n, 0.0f);
+        std::copy(reference, reference + referenceLength, m_refRe.begin());
+        std::copy(recording, recording + recordingLength, m_recRe.begin());
+
+        m_fft.forward(m_refRe.data(), m_refIm.data());
+        m_fft.forward(m_recRe.data(), m_recIm.data());
+
+        // recording · conj(reference)
+        for (size_t k = 0; k < n; ++k)
+        {
+            const float re = m_recRe[k] * m_refRe[k] + m_recIm[k] * m_refIm[k];
+            const float im = m_recIm[k] * m_refRe[k] - m_recRe[k] * m_refIm[k];
+            m_recRe[k] = re;
+            m_recIm[k] = im;
+        }
+        m_fft.inverse(m_recRe.data(), m_recIm.data());
+
+        const float *corr = m_recRe.data();
+        size_t best = 0;
+        double sumSq = 0.0;
+        for (size_t i = 0; i < recordingLength; ++i)
+        {
+            sumSq += static_cast<double>(corr[i]) * corr[i];
+            if (std::fabs(corr[i]) > std::fabs(corr[best]))
+                best = i;
+        }
+
+        // Parabolic interpolation through the peak and its neighbours
+        double offset = 0.0;
+        if (best > 0 && best + 1 < recordingLength)
+        {
+            const double a = std::fabs(corr[best - 1]);
+            const double b = std::fabs(corr[best]);
+            const double c = std::fabs(corr[best + 1]);
+            const double denom = a - 2.0 * b + c;
+            if (denom < 0.0)
+                offset = 0.5 * (a - c) / denom;
+        }
+
+        double refEnergy = 0.0;
+        for (size_t i = 0; i < referenceLength; ++i)
+            refEnergy += static_cast<double>(reference[i]) * reference[i];
+
+        double recEnergy = 0.0;
+        const size_t windowEnd = std::min(recordingLength, best + referenceLength);
+        for (size_t i = best; i < windowEnd; ++i)
+            recEnergy += static_cast<double>(recording[i]) * recording[i];
+
+        const double rms = std::sqrt(sumSq / static_cast<double>(recordingLength));
+        const double norm = std::sqrt(refEnergy * recEnergy);
+
+        result.lag = static_cast<double>(best) + offset;
+        result.peak = norm > 0.0 ? static_cast<float>(std::fabs(corr[best]) / norm) : 0.0f;
+        result.confidence = rms > 0.0 ? static_cast<float>(std::fabs(corr[best]) / rms) : 0.0f;
+        result.valid = true;
+        return result;
+    }
+}
@@ -0,0 +1,150 @@
+#include "Dsp/Fft.h"
+#include "SimdKernels.h"
+
+#include <cmath>
+#include <utility>
+
+namespace Dsp
+{
+    /**
+     * @brief Builds the bit-reversal swap list and per-stage twiddle tables.
+     *
+     * Each stage stores its twiddles contiguously so the vectorised butterflies
+     * can load four consecutive factors at once.
+     *
+     * @param size Power-of-two transform length.
+     * @return true on success.
+     */
+    bool Fft::configure(size_t size)
+    {
+        if (size < 2 || (size & (size - 1)) != 0)
+            return false;
+
+        m_size = size;
+
+        // Bit-reversal permutation as a list of swaps
+        m_bitReverse.clear();
+        size_t bits = 0;
+        while ((static_cast<size_t>(1) << bits) < size)
+            ++bits;
+        for (size_t i = 0; i < size; ++i)
+        {
+            size_t r = 0;
+            for (size_t b = 0; b < bits; ++b)
+                r |= ((i >> b) & 1u) << (bits - 1 - b);
+            if (i < r)
+            {
+                m_bitReverse.push_back(static_cast<uint32_t>(i));
+                m_bitReverse.push_back(static_cast<uint32_t>(r));
+            }
+        }
+
+        // Twiddles: stage with half-size m uses w_j = e^(-iπj/m), j < m
+        m_twiddleRe.assign(size - 1, 0.0f);
+        m_twiddleIm.assign(size - 1, 0.0f);
+        const double pi = 3.14159265358979323846;
+        for (size_t m = 1; m < size; m <<= 1)
+        {
+            for (size_t j = 0; j < m; ++j)
+            {
+                double angle = -pi * static_cast<double>(j) / static_cast<double>(m);
+                m_twiddleRe[m - 1 + j] = static_cast<float>(std::cos(angle));
+                m_twiddleIm[m - 1 + j] = static_cast<float>(std::sin(angle));
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Iterative decimation-in-time transform (forward direction).
+     */
+    void Fft::transform(float *re, float *im) const
+    {
+        const size_t n = m_size;
+
+        for (size_t i = 0; i < m_bitReverse.size(); i += 2)
+        {
+            const uint32_t a = m_bitReverse[i];
+            const uint32_t b = m_bitReverse[i + 1];
+            std::swap(re[a], re[b]);
+            std::swap(im[a], im[b]);
+        }
+
+        for (size_t m = 1; m < n; m <<= 1)
+        {
+            const float *wr = m_twiddleRe.data() + (m - 1);
+            const float *wi = m_twiddleIm.data() + (m - 1);
+
+            for (size_t k = 0; k < n; k += 2 * m)
+            {
+                float *ar = re + k;
+                float *ai = im + k;
+                float *br = re + k + m;
+                float *bi = im + k + m;
+                size_t j = 0;
+#if defined(AUDIO_SWITCHER_SSE2)
+                for (; j + 4 <= m; j += 4)
+                {
+                    __m128 twr = _mm_loadu_ps(wr + j);
+                    __m128 twi = _mm_loadu_ps(wi + j);
+                    __m128 xr = _mm_loadu_ps(br + j);
+                    __m128 xi = _mm_loadu_ps(bi + j);
+                    __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, twr), _mm_mul_ps(xi, twi));
+                    __m128 ti = _mm_add_ps(_mm_mul_ps(xr, twi), _mm_mul_ps(xi, twr));
+                    __m128 ur = _mm_loadu_ps(ar + j);
+                    __m128 ui = _mm_loadu_ps(ai + j);
+                    _mm_storeu_ps(ar + j, _mm_add_ps(ur, tr));
+                    _mm_storeu_ps(ai + j, _mm_add_ps(ui, ti));
+                    _mm_storeu_ps(br + j, _mm_sub_ps(ur, tr));
+                    _mm_storeu_ps(bi + j, _mm_sub_ps(ui, ti));
+                }
+#endif
+                for (; j < m; ++j)
+                {
+                    float tr = br[j] * wr[j] - bi[j] * wi[j];
+                    float ti = br[j] * wi[j] + bi[j] * wr[j];
+                    float ur = ar[j];
+                    float ui = ai[j];
+                    ar[j] = ur + tr;
+                    ai[j] = ui + ti;
+                    br[j] = ur - tr;
+                    bi[j] = ui - ti;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Forward FFT in place.
+     *
+     * @param re Real parts, size() entries.
+     * @param im Imaginary parts, size() entries.
+     */
+    void Fft::forward(float *re, float *im) const
+    {
+        if (m_size != 0)
+            transform(re, im);
+    }
+
+    /**
+     * @brief Inverse FFT in place, computed as conj(FFT(conj(x))) / N.
+     *
+     * @param re Real parts.
+     * @param im Imaginary parts.
+     */
+    void Fft::inverse(float *re, float *im) const
+    {
+        if (m_size == 0)
+            return;
+
+        for (size_t i = 0; i < m_size; ++i)
+            im[i] = -im[i];
+
+        transform(re, im);
+
+        const float scale = 1.0f / static_cast<float>(m_size);
+        detail::Scale(re, scale, m_size);
+        detail::Scale(im, -scale, m_size);
+    }
+}
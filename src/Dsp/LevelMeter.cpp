@@ -0,0 +1,290 @@
+#include "Dsp/LevelMeter.h"
+#include "Dsp/SampleFormat.h"
+#include "SimdKernels.h"
+
+#include <cmath>
+
+namespace Dsp
+{
+    namespace
+    {
+        constexpr size_t kTruePeakPhases = 4;
+        constexpr size_t kTruePeakTaps = 12; ///< Taps per phase (48-tap prototype)
+        constexpr double kPi = 3.14159265358979323846;
+
+        /**
+         * @brief 4x interpolation filter, one row per phase, taps reversed for Dot().
+         *
+         * Windowed-sinc (Blackman) prototype with each phase normalised to unity DC gain,
+         * in the spirit of the ITU-R BS.1770 true-peak meter.
+         */
+        struct TruePeakFilter
+        {
+            float taps[kTruePeakPhases][kTruePeakTaps];
+
+            TruePeakFilter()
+            {
+                const size_t length = kTruePeakPhases * kTruePeakTaps;
+                const double center = (length - 1) / 2.0;
+                double proto[kTruePeakPhases * kTruePeakTaps];
+
+                for (size_t n = 0; n < length; ++n)
+                {
+                    double t = (n - center) / kTruePeakPhases;
+                    double sinc = t == 0.0 ? 1.0 : std::sin(kPi * t) / (kPi * t);
+                    double w = 0.42 - 0.5 * std::cos(2.0 * kPi * n / (length - 1)) +
+                               0.08 * std::cos(4.0 * kPi * n / (length - 1));
+                    proto[n] = sinc * w;
+                }
+
+                for (size_t p = 0; p < kTruePeakPhases; ++p)
+                {
+                    double dc = 0.0;
+                    for (size_t k = 0; k < kTruePeakTaps; ++k)
+                        dc += proto[k * kTruePeakPhases + p];
+                    for (size_t k = 0; k < kTruePeakTaps; ++k)
+                        taps[p][kTruePeakTaps - 1 - k] = static_cast<float>(proto[k * kTruePeakPhases + p] / dc);
+                }
+            }
+        };
+
+        const TruePeakFilter &GetTruePeakFilter()
+        {
+            static const TruePeakFilter filter;
+            return filter;
+        }
+    }
+
+    /**
+     * @brief Allocates per-channel state and scratch buffers.
+     *
+     * The default clip threshold is the largest positive code of the format's
+     * valid bits (e.g. 32767/32768 for 16-bit, 8388607/8388608 for 24-in-32),
+     * or 1.0 for float.
+     *
+     * @param format Stream format.
+     * @param windowMs Window length in milliseconds.
+     * @param blockMs Block length in milliseconds.
+     * @param truePeak Enable true-peak measurement.
+     * @return true on success.
+     */
+    bool LevelMeter::configure(const Utility::DeviceFormatInfo &format, uint32_t windowMs,
+                               uint32_t blockMs, bool truePeak)
+    {
+        if (!format.valid || format.channels == 0 || format.sampleRate == 0 || !IsConvertibleFormat(format))
+            return false;
+        if (blockMs == 0 || windowMs < blockMs)
+            return false;
+
+        m_format = format;
+        m_channels = format.channels;
+        m_blockFrames = static_cast<size_t>(format.sampleRate) * blockMs / 1000;
+        if (m_blockFrames == 0)
+            m_blockFrames = 1;
+        m_windowBlocks = windowMs / blockMs;
+        m_truePeak = truePeak;
+
+        if (format.isFloat)
+        {
+            m_clipThreshold = 1.0f;
+        }
+        else
+        {
+            // Valid bits, not the container: a 24-in-32 full-scale sample converts to 1 - 2^-23
+            const uint32_t containerBits = format.blockAlign / format.channels * 8u;
+            const uint32_t bits = format.bitDepth != 0 && format.bitDepth < containerBits ? format.bitDepth : containerBits;
+            const float fullScale = std::ldexp(1.0f, static_cast<int>(bits) - 1);
+            m_clipThreshold = (fullScale - 1.0f) / fullScale;
+        }
+
+        m_state.assign(m_channels, ChannelState());
+        for (ChannelState &state : m_state)
+            state.ring.assign(m_windowBlocks, BlockStats());
+
+        m_planar.assign(static_cast<size_t>(m_channels) * ChunkFrames, 0.0f);
+        m_convert.assign(static_cast<size_t>(m_channels) * ChunkFrames, 0.0f);
+        m_tpBuffer.assign(kTruePeakTaps + ChunkFrames, 0.0f);
+
+        reset();
+        return true;
+    }
+
+    /**
+     * @brief Clears the window, the running totals and the interpolator history.
+     */
+    void LevelMeter::reset()
+    {
+        for (ChannelState &state : m_state)
+        {
+            state.current = BlockStats();
+            for (BlockStats &block : state.ring)
+                block = BlockStats();
+            state.windowSum = 0.0;
+            state.windowSumSq = 0.0;
+            state.windowClipped = 0;
+            state.totalClipped = 0;
+            for (float &h : state.history)
+                h = 0.0f;
+        }
+        m_blockFill = 0;
+        m_ringPos = 0;
+        m_ringCount = 0;
+    }
+
+    /**
+     * @brief Runs the 4x interpolator over a planar chunk and returns its largest |value|.
+     *
+     * The previous kTruePeakTaps - 1 samples are kept per channel so chunk and
+     * buffer boundaries are seamless.
+     */
+    float LevelMeter::truePeakChunk(ChannelState &state, const float *x, size_t n)
+    {
+        const TruePeakFilter &filter = GetTruePeakFilter();
+        const size_t hist = kTruePeakTaps - 1;
+        float *buf = m_tpBuffer.data();
+
+        for (size_t i = 0; i < hist; ++i)
+            buf[i] = state.history[i];
+        for (size_t i = 0; i < n; ++i)
+            buf[hist + i] = x[i];
+
+        float peak = 0.0f;
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (size_t p = 0; p < kTruePeakPhases; ++p)
+            {
+                float y = detail::Dot(filter.taps[p], buf + i, kTruePeakTaps);
+                y = y < 0.0f ? -y : y;
+                peak = y > peak ? y : peak;
+            }
+        }
+
+        for (size_t i = 0; i < hist; ++i)
+            state.history[i] = buf[n + i];
+
+        return peak;
+    }
+
+    /**
+     * @brief Moves the current block of every channel into the window.
+     *
+     * Running sums gain the new block and lose the block it replaces, so the
+     * window costs O(1) per block regardless of its length.
+     */
+    void LevelMeter::finishBlock()
+    {
+        for (ChannelState &state : m_state)
+        {
+            BlockStats &slot = state.ring[m_ringPos];
+            if (m_ringCount == m_windowBlocks)
+            {
+                state.windowSum -= slot.sum;
+                state.windowSumSq -= slot.sumSq;
+                state.windowClipped -= slot.clipped;
+            }
+
+            slot = state.current;
+            state.windowSum += slot.sum;
+            state.windowSumSq += slot.sumSq;
+            state.windowClipped += slot.clipped;
+            state.totalClipped += slot.clipped;
+            state.current = BlockStats();
+        }
+
+        m_ringPos = (m_ringPos + 1) % m_windowBlocks;
+        if (m_ringCount < m_windowBlocks)
+            ++m_ringCount;
+        m_blockFill = 0;
+    }
+
+    /**
+     * @brief Analyses interleaved raw frames.
+     *
+     * Frames are converted ChunkFrames at a time; chunks never straddle a block
+     * boundary so the window advances exactly at block ends.
+     *
+     * @param data Raw interleaved frames in the configured format.
+     * @param frames Frame count.
+     */
+    void LevelMeter::process(const void *data, size_t frames)
+    {
+        if (m_channels == 0 || !data)
+            return;
+
+        const uint8_t *raw = static_cast<const uint8_t *>(data);
+        const size_t channels = m_channels;
+
+        while (frames > 0)
+        {
+            size_t n = frames < ChunkFrames ? frames : ChunkFrames;
+            if (n > m_blockFrames - m_blockFill)
+                n = m_blockFrames - m_blockFill;
+
+            // Convert and deinterleave into planar scratch
+            ToFloat(raw, m_convert.data(), n * channels, m_format);
+            for (size_t c = 0; c < channels; ++c)
+            {
+                float *plane = m_planar.data() + c * ChunkFrames;
+                for (size_t f = 0; f < n; ++f)
+                    plane[f] = m_convert[f * channels + c];
+            }
+
+            for (size_t c = 0; c < channels; ++c)
+            {
+                ChannelState &state = m_state[c];
+                const float *plane = m_planar.data() + c * ChunkFrames;
+
+                float sum = 0.0f, sumSq = 0.0f;
+                detail::Analyze(plane, n, m_clipThreshold, state.current.peak, sum, sumSq, state.current.clipped);
+                state.current.sum += sum;
+                state.current.sumSq += sumSq;
+
+                if (m_truePeak)
+                {
+                    float tp = truePeakChunk(state, plane, n);
+                    if (tp > state.current.truePeak)
+                        state.current.truePeak = tp;
+                }
+            }
+
+            raw += n * m_format.blockAlign;
+            frames -= n;
+            m_blockFill += n;
+            if (m_blockFill == m_blockFrames)
+                finishBlock();
+        }
+    }
+
+    /**
+     * @brief Returns the levels of a channel over the completed blocks in the window.
+     *
+     * @param channel Channel index.
+     * @return ChannelLevels Zeroed if no block has completed yet or the index is invalid.
+     */
+    ChannelLevels LevelMeter::levels(uint32_t channel) const
+    {
+        ChannelLevels result;
+        if (channel >= m_channels || m_ringCount == 0)
+            return result;
+
+        const ChannelState &state = m_state[channel];
+        for (size_t b = 0; b < m_ringCount; ++b)
+        {
+            const BlockStats &block = state.ring[b];
+            result.peak = block.peak > result.peak ? block.peak : result.peak;
+            result.truePeak = block.truePeak > result.truePeak ? block.truePeak : result.truePeak;
+        }
+
+        // True peak can never be below the sample peak
+        if (m_truePeak && result.truePeak < result.peak)
+            result.truePeak = result.peak;
+
+        const double n = static_cast<double>(m_ringCount * m_blockFrames);
+        const double meanSq = state.windowSumSq / n;
+        result.rms = static_cast<float>(std::sqrt(meanSq > 0.0 ? meanSq : 0.0));
+        result.dcOffset = static_cast<float>(state.windowSum / n);
+        result.clippedSamples = state.windowClipped;
+        result.totalClipped = state.totalClipped;
+        return result;
+    }
+}
@@ -0,0 +1,112 @@
+#include "Dsp/LinearResampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Dsp
+{
+    /**
+     * @brief Configures the converter.
+     *
+     * @param channels Interleaved channels.
+     * @param inputRate Source rate in Hz.
+     * @param outputRate Destination rate in Hz.
+     * @return true on success.
+     */
+    bool LinearResampler::configure(uint32_t channels, uint32_t inputRate, uint32_t outputRate)
+    {
+        if (channels == 0 || inputRate == 0 || outputRate == 0)
+            return false;
+
+        m_channels = channels;
+        m_step = static_cast<double>(inputRate) / static_cast<double>(outputRate);
+        m_history.assign(static_cast<size_t>(channels) * 2, 0.0f);
+        reset();
+        return true;
+    }
+
+    /**
+     * @brief Resets phase and history.
+     *
+     * Starting at phase 1 makes the first output the first input frame's predecessor
+     * (silence), i.e. exactly one frame of latency.
+     */
+    void LinearResampler::reset()
+    {
+        m_phase = 1.0;
+        std::fill(m_history.begin(), m_history.end(), 0.0f);
+    }
+
+    /**
+     * @brief Input frames needed for a given output count.
+     *
+     * Output j sits at m_phase + j * m_step input frames after the last consumed frame;
+     * a block consumes every frame before the position of the following output.
+     */
+    size_t LinearResampler::inputFramesFor(size_t outputFrames) const
+    {
+        if (outputFrames == 0)
+            return 0;
+
+        return static_cast<size_t>(std::floor(m_phase + static_cast<double>(outputFrames) * m_step));
+    }
+
+    /**
+     * @brief Output frames producible from a given input count.
+     */
+    size_t LinearResampler::outputFramesFor(size_t inputFrames) const
+    {
+        size_t outputs = static_cast<size_t>((static_cast<double>(inputFrames) + 1.0 - m_phase) / m_step);
+        while (outputs > 0 && inputFramesFor(outputs) > inputFrames)
+            --outputs;
+        while (inputFramesFor(outputs + 1) <= inputFrames)
+            ++outputs;
+        return outputs;
+    }
+
+    /**
+     * @brief Interpolates one block.
+     *
+     * Positions are counted in input frames: the older history frame is at -1, the
+     * newer at 0 and in[k] at k + 1. Output at position p is the signal at p - 1, so it
+     * only needs frames up to floor(p), all of which the block consumes.
+     *
+     * @param in inputFramesFor(outputFrames) interleaved frames.
+     * @param out outputFrames interleaved frames.
+     * @param outputFrames Frames to produce.
+     */
+    void LinearResampler::process(const float *in, float *out, size_t outputFrames)
+    {
+        if (m_channels == 0 || outputFrames == 0)
+            return;
+
+        const size_t ch = m_channels;
+        const size_t consumed = inputFramesFor(outputFrames);
+        const float *older = m_history.data();
+        const float *newer = m_history.data() + ch;
+
+        double position = m_phase;
+        for (size_t j = 0; j < outputFrames; ++j, position = m_phase + static_cast<double>(j) * m_step)
+        {
+            const size_t index = static_cast<size_t>(position);
+            const float frac = static_cast<float>(position - static_cast<double>(index));
+            const float *a = index == 0 ? older : (index == 1 ? newer : in + (index - 2) * ch);
+            const float *b = index == 0 ? newer : in + (index - 1) * ch;
+            float *o = out + j * ch;
+
+            for (size_t c = 0; c < ch; ++c)
+                o[c] = a[c] + (b[c] - a[c]) * frac;
+        }
+
+        m_phase = m_phase + static_cast<double>(outputFrames) * m_step - static_cast<double>(consumed);
+
+        if (consumed >= 2)
+            std::memcpy(m_history.data(), in + (consumed - 2) * ch, 2 * ch * sizeof(float));
+        else if (consumed == 1)
+        {
+            std::memcpy(m_history.data(), m_history.data() + ch, ch * sizeof(float));
+            std::memcpy(m_history.data() + ch, in, ch * sizeof(float));
+        }
+    }
+}
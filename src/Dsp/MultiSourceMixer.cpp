@@ -0,0 +1,145 @@
+#include "Dsp/MultiSourceMixer.h"
+#include "SimdKernels.h"
+
+#include <cmath>
+
+namespace Dsp
+{
+    /**
+     * @brief Preallocates input buffers and gain state.
+     *
+     * Each input buffer is padded to a multiple of 16 floats (one cache line) so
+     * that inputs never share a line.
+     *
+     * @param maxInputs Maximum input count.
+     * @param channels Channel count.
+     * @param maxFrames Largest block handed to mix().
+     * @param sampleRate Sample rate in Hz.
+     * @param smoothingMs Gain smoothing time constant.
+     * @return true on success, false if any size is zero.
+     */
+    bool MultiSourceMixer::configure(uint32_t maxInputs, uint32_t channels, size_t maxFrames,
+                                     uint32_t sampleRate, float smoothingMs)
+    {
+        if (maxInputs == 0 || channels == 0 || maxFrames == 0 || sampleRate == 0)
+            return false;
+
+        m_maxInputs = maxInputs;
+        m_channels = channels;
+        m_maxFrames = maxFrames;
+        m_stride = (maxFrames * channels + 15) & ~static_cast<size_t>(15);
+
+        m_inputs.assign(m_stride * maxInputs, 0.0f);
+        m_targets.reset(new std::atomic<float>[maxInputs]);
+        for (uint32_t i = 0; i < maxInputs; ++i)
+            m_targets[i].store(1.0f, std::memory_order_relaxed);
+        m_current.assign(maxInputs, 1.0f);
+
+        // One-pole coefficient applied once per block; a shorter block gets 1 - exp(-frames / tau)
+        const float blockFrames = static_cast<float>(BlockSamples) / static_cast<float>(channels);
+        const float tauFrames = smoothingMs * 0.001f * static_cast<float>(sampleRate);
+        m_invTauFrames = tauFrames > 0.0f ? 1.0f / tauFrames : 0.0f;
+        m_smoothing = tauFrames > 0.0f ? 1.0f - std::exp(-blockFrames * m_invTauFrames) : 1.0f; // 1 = no smoothing
+
+        return true;
+    }
+
+    /**
+     * @brief Returns the buffer of an input, or nullptr if out of range.
+     */
+    float *MultiSourceMixer::input(uint32_t index)
+    {
+        if (index >= m_maxInputs)
+            return nullptr;
+
+        return m_inputs.data() + m_stride * index;
+    }
+
+    /**
+     * @brief Sets the target gain; the audio thread ramps to it unless `immediate` is set.
+     */
+    void MultiSourceMixer::setGain(uint32_t index, float gain, bool immediate)
+    {
+        if (index >= m_maxInputs)
+            return;
+
+        m_targets[index].store(gain, std::memory_order_relaxed);
+        if (immediate)
+            m_current[index] = gain;
+    }
+
+    /**
+     * @brief Enables or disables soft limiting of the summed output.
+     */
+    void MultiSourceMixer::setSoftClip(bool enabled, float knee)
+    {
+        if (knee < 0.0f)
+            knee = 0.0f;
+        if (knee > 0.99f)
+            knee = 0.99f;
+
+        m_knee.store(knee, std::memory_order_relaxed);
+        m_softClip.store(enabled, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Mixes inputs into `out`, one cache block at a time.
+     *
+     * For every block, the output is zeroed and each input is accumulated with a
+     * linear gain ramp from its current gain to the next smoothed value, then the
+     * optional limiter runs on the still-hot block. The smoothing step follows the
+     * block's frame count, so the ramp time does not depend on the callback size.
+     *
+     * @param out Output buffer.
+     * @param frames Frame count.
+     * @param inputCount Number of inputs to sum.
+     */
+    void MultiSourceMixer::mix(float *out, size_t frames, uint32_t inputCount)
+    {
+        if (frames > m_maxFrames)
+            frames = m_maxFrames;
+        if (inputCount > m_maxInputs)
+            inputCount = m_maxInputs;
+
+        const size_t total = frames * m_channels;
+        const bool softClip = m_softClip.load(std::memory_order_relaxed);
+        const float knee = m_knee.load(std::memory_order_relaxed);
+
+        for (size_t offset = 0; offset < total; offset += BlockSamples)
+        {
+            const size_t n = (total - offset < BlockSamples) ? total - offset : BlockSamples;
+            float *acc = out + offset;
+            const float smoothing = (n == BlockSamples || m_smoothing >= 1.0f)
+                                        ? m_smoothing
+                                        : 1.0f - std::exp(-static_cast<float>(n) / static_cast<float>(m_channels) * m_invTauFrames);
+
+            detail::Zero(acc, n);
+
+            for (uint32_t i = 0; i < inputCount; ++i)
+            {
+                const float *src = m_inputs.data() + m_stride * i + offset;
+                const float target = m_targets[i].load(std::memory_order_relaxed);
+                if (smoothing >= 1.0f)
+                    m_current[i] = target; // Smoothing disabled: jump straight to the target
+                const float start = m_current[i];
+
+                if (start == target)
+                {
+                    if (target != 0.0f)
+                        detail::MulAdd(acc, src, target, n);
+                    continue;
+                }
+
+                float end = start + (target - start) * smoothing;
+                if (std::fabs(end - target) < 1e-6f)
+                    end = target; // Snap once inaudible so the fast path resumes
+
+                detail::MulAddRamp(acc, src, start, (end - start) / static_cast<float>(n), n);
+                m_current[i] = end;
+            }
+
+            if (softClip)
+                detail::SoftClip(acc, knee, n);
+        }
+    }
+}
@@ -0,0 +1,175 @@
+#include "Dsp/SampleFormat.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace Dsp
+{
+    namespace
+    {
+        /// Bytes per sample of the container, derived from block alignment when available.
+        size_t BytesPerSample(const Utility::DeviceFormatInfo &format)
+        {
+            if (format.channels != 0 && format.blockAlign != 0)
+                return format.blockAlign / format.channels;
+            return format.bitDepth / 8u;
+        }
+
+        inline float Saturate(float x)
+        {
+            return x < -1.0f ? -1.0f : (x > 1.0f ? 1.0f : x);
+        }
+    }
+
+    /**
+     * @brief Checks whether a format is handled by the converters.
+     *
+     * @param format Format to check.
+     * @return true for u8/s16/s24/s32 PCM and f32.
+     */
+    bool IsConvertibleFormat(const Utility::DeviceFormatInfo &format)
+    {
+        const size_t bytes = BytesPerSample(format);
+        if (format.isFloat)
+            return bytes == 4;
+        return bytes >= 1 && bytes <= 4;
+    }
+
+    /**
+     * @brief Converts raw device samples to float.
+     *
+     * Integer containers are scaled by their full container width, so 24-in-32
+     * (left-justified) formats convert correctly as 32-bit.
+     *
+     * @param src Raw input.
+     * @param dst Float output.
+     * @param samples Sample count.
+     * @param format Input format.
+     * @return true on success.
+     */
+    bool ToFloat(const void *src, float *dst, size_t samples, const Utility::DeviceFormatInfo &format)
+    {
+        if (!IsConvertibleFormat(format))
+            return false;
+
+        const size_t bytes = BytesPerSample(format);
+
+        if (format.isFloat)
+        {
+            std::memcpy(dst, src, samples * sizeof(float));
+            return true;
+        }
+
+        switch (bytes)
+        {
+        case 1:
+        {
+            const uint8_t *in = static_cast<const uint8_t *>(src);
+            for (size_t i = 0; i < samples; ++i)
+                dst[i] = (static_cast<int>(in[i]) - 128) * (1.0f / 128.0f);
+            break;
+        }
+        case 2:
+        {
+            const int16_t *in = static_cast<const int16_t *>(src);
+            for (size_t i = 0; i < samples; ++i)
+                dst[i] = in[i] * (1.0f / 32768.0f);
+            break;
+        }
+        case 3:
+        {
+            const uint8_t *in = static_cast<const uint8_t *>(src);
+            for (size_t i = 0; i < samples; ++i, in += 3)
+            {
+                // Little-endian packed 24-bit, sign-extended via the top byte
+                int32_t v = static_cast<int32_t>((static_cast<uint32_t>(in[0]) << 8) |
+                                                 (static_cast<uint32_t>(in[1]) << 16) |
+                                                 (static_cast<uint32_t>(in[2]) << 24));
+                dst[i] = (v >> 8) * (1.0f / 8388608.0f);
+            }
+            break;
+        }
+        case 4:
+        {
+            const int32_t *in = static_cast<const int32_t *>(src);
+            for (size_t i = 0; i < samples; ++i)
+                dst[i] = static_cast<float>(in[i]) * (1.0f / 2147483648.0f);
+            break;
+        }
+        default:
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Converts float samples to raw device samples.
+     *
+     * Values outside [-1, 1] are saturated before quantisation.
+     *
+     * @param src Float input.
+     * @param dst Raw output.
+     * @param samples Sample count.
+     * @param format Output format.
+     * @return true on success.
+     */
+    bool FromFloat(const float *src, void *dst, size_t samples, const Utility::DeviceFormatInfo &format)
+    {
+        if (!IsConvertibleFormat(format))
+            return false;
+
+        const size_t bytes = BytesPerSample(format);
+
+        if (format.isFloat)
+        {
+            std::memcpy(dst, src, samples * sizeof(float));
+            return true;
+        }
+
+        switch (bytes)
+        {
+        case 1:
+        {
+            uint8_t *out = static_cast<uint8_t *>(dst);
+            for (size_t i = 0; i < samples; ++i)
+            {
+                float v = Saturate(src[i]) * 127.0f + 128.0f;
+                out[i] = static_cast<uint8_t>(v + 0.5f);
+            }
+            break;
+        }
+        case 2:
+        {
+            int16_t *out = static_cast<int16_t *>(dst);
+            for (size_t i = 0; i < samples; ++i)
+                out[i] = static_cast<int16_t>(Saturate(src[i]) * 32767.0f);
+            break;
+        }
+        case 3:
+        {
+            uint8_t *out = static_cast<uint8_t *>(dst);
+            for (size_t i = 0; i < samples; ++i, out += 3)
+            {
+                int32_t v = static_cast<int32_t>(Saturate(src[i]) * 8388607.0f);
+                out[0] = static_cast<uint8_t>(v & 0xFF);
+                out[1] = static_cast<uint8_t>((v >> 8) & 0xFF);
+                out[2] = static_cast<uint8_t>((v >> 16) & 0xFF);
+            }
+            break;
+        }
+        case 4:
+        {
+            int32_t *out = static_cast<int32_t *>(dst);
+            for (size_t i = 0; i < samples; ++i)
+            {
+                // Scale in double: 2^31 - 1 is not representable in float
+                out[i] = static_cast<int32_t>(static_cast<double>(Saturate(src[i])) * 2147483647.0);
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+// Internal header: vector helpers shared by the Dsp sources. Not part of the public API.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define AUDIO_SWITCHER_SSE2 1
+#endif
+
+namespace Dsp
+{
+    namespace detail
+    {
+        /**
+         * @brief Sets `count` floats to zero.
+         */
+        inline void Zero(float *dst, size_t count)
+        {
+            std::memset(dst, 0, count * sizeof(float));
+        }
+
+        /**
+         * @brief Multiply-accumulate: acc[i] += gain * src[i].
+         */
+        inline void MulAdd(float *acc, const float *src, float gain, size_t count)
+        {
+            size_t i = 0;
+#if defined(AUDIO_SWITCHER_SSE2)
+            const __m128 g = _mm_set1_ps(gain);
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128 a0 = _mm_loadu_ps(acc + i);
+                __m128 a1 = _mm_loadu_ps(acc + i + 4);
+                a0 = _mm_add_ps(a0, _mm_mul_ps(g, _mm_loadu_ps(src + i)));
+                a1 = _mm_add_ps(a1, _mm_mul_ps(g, _mm_loadu_ps(src + i + 4)));
+                _mm_storeu_ps(acc + i, a0);
+                _mm_storeu_ps(acc + i + 4, a1);
+            }
+#endif
+            for (; i < count; ++i)
+                acc[i] += gain * src[i];
+        }
+
+        /**
+         * @brief Multiply-accumulate with a linear gain ramp:
+         *        acc[i] += (gain + i * step) * src[i].
+         */
+        inline void MulAddRamp(float *acc, const float *src, float gain, float step, size_t count)
+        {
+            size_t i = 0;
+#if defined(AUDIO_SWITCHER_SSE2)
+            __m128 g = _mm_setr_ps(gain, gain + step, gain + 2.0f * step, gain + 3.0f * step);
+            const __m128 g4 = _mm_set1_ps(4.0f * step);
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 a = _mm_loadu_ps(acc + i);
+                a = _mm_add_ps(a, _mm_mul_ps(g, _mm_loadu_ps(src + i)));
+                _mm_storeu_ps(acc + i, a);
+                g = _mm_add_ps(g, g4);
+            }
+#endif
+            for (; i < count; ++i)
+                acc[i] += (gain + static_cast<float>(i) * step) * src[i];
+        }
+
+        /**
+         * @brief In-place scale: dst[i] *= gain.
+         */
+        inline void Scale(float *dst, float gain, size_t count)
+        {
+            size_t i = 0;
+#if defined(AUDIO_SWITCHER_SSE2)
+            const __m128 g = _mm_set1_ps(gain);
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(dst + i, _mm_mul_ps(g, _mm_loadu_ps(dst + i)));
+#endif
+            for (; i < count; ++i)
+                dst[i] *= gain;
+        }
+
+        /**
+         * @brief Single-pass statistics of a planar block.
+         *
+         * Accumulates into the outputs: peak = max(peak, |x|), sum += x, sumSq += x²,
+         * clipped += count(|x| >= clip).
+         */
+        inline void Analyze(const float *x, size_t count, float clip,
+                            float &peak, float &sum, float &sumSq, uint32_t &clipped)
+        {
+            size_t i = 0;
+            float pk = peak, s = 0.0f, sq = 0.0f;
+            uint32_t clips = 0;
+#if defined(AUDIO_SWITCHER_SSE2)
+            const __m128 signMask = _mm_set1_ps(-0.0f);
+            const __m128 c = _mm_set1_ps(clip);
+            __m128 vPeak = _mm_set1_ps(peak);
+            __m128 vSum = _mm_setzero_ps();
+            __m128 vSq = _mm_setzero_ps();
+            __m128i vClips = _mm_setzero_si128();
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 v = _mm_loadu_ps(x + i);
+                __m128 a = _mm_andnot_ps(signMask, v);
+                vPeak = _mm_max_ps(vPeak, a);
+                vSum = _mm_add_ps(vSum, v);
+                vSq = _mm_add_ps(vSq, _mm_mul_ps(v, v));
+                // Compare mask is -1 per clipped lane: subtracting it counts
+                vClips = _mm_sub_epi32(vClips, _mm_castps_si128(_mm_cmpge_ps(a, c)));
+            }
+
+            alignas(16) float lanes[4];
+            alignas(16) int32_t clipLanes[4];
+            _mm_store_ps(lanes, vPeak);
+            for (float l : lanes)
+                pk = l > pk ? l : pk;
+            _mm_store_ps(lanes, vSum);
+            s = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            _mm_store_ps(lanes, vSq);
+            sq = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            _mm_store_si128(reinterpret_cast<__m128i *>(clipLanes), vClips);
+            clips = static_cast<uint32_t>(clipLanes[0] + clipLanes[1] + clipLanes[2] + clipLanes[3]);
+#endif
+            for (; i < count; ++i)
+            {
+                float v = x[i];
+                float a = v < 0.0f ? -v : v;
+                pk = a > pk ? a : pk;
+                s += v;
+                sq += v * v;
+                clips += a >= clip ? 1u : 0u;
+            }
+
+            peak = pk;
+            sum += s;
+            sumSq += sq;
+            clipped += clips;
+        }
+
+        /**
+         * @brief Dot product of two float arrays.
+         */
+        inline float Dot(const float *a, const float *b, size_t count)
+        {
+            size_t i = 0;
+            float result = 0.0f;
+#if defined(AUDIO_SWITCHER_SSE2)
+            const size_t vectorEnd = count & ~static_cast<size_t>(3);
+            __m128 acc = _mm_setzero_ps();
+            for (; i < vectorEnd; i += 4)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, acc);
+            result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+            for (; i < count; ++i)
+                result += a[i] * b[i];
+            return result;
+        }
+
+        /**
+         * @brief In-place soft limiter.
+         *
+         * Samples with |x| <= knee pass unchanged. Above the knee the excess is
+         * compressed with u / (1 + u), which is continuous in value and slope at the
+         * knee and approaches full scale asymptotically.
+         */
+        inline void SoftClip(float *dst, float knee, size_t count)
+        {
+            const float range = 1.0f - knee;
+            const float invRange = 1.0f / range;
+            size_t i = 0;
+#if defined(AUDIO_SWITCHER_SSE2)
+            const __m128 k = _mm_set1_ps(knee);
+            const __m128 r = _mm_set1_ps(range);
+            const __m128 ir = _mm_set1_ps(invRange);
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 signMask = _mm_set1_ps(-0.0f);
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 x = _mm_loadu_ps(dst + i);
+                __m128 sign = _mm_and_ps(x, signMask);
+                __m128 ax = _mm_andnot_ps(signMask, x);
+                __m128 u = _mm_mul_ps(_mm_sub_ps(ax, k), ir);
+                __m128 y = _mm_add_ps(k, _mm_mul_ps(r, _mm_div_ps(u, _mm_add_ps(one, u))));
+                __m128 over = _mm_cmpgt_ps(ax, k);
+                __m128 limited = _mm_or_ps(y, sign);
+                _mm_storeu_ps(dst + i, _mm_or_ps(_mm_and_ps(over, limited), _mm_andnot_ps(over, x)));
+            }
+#endif
+            for (; i < count; ++i)
+            {
+                float x = dst[i];
+                float ax = x < 0.0f ? -x : x;
+                if (ax > knee)
+                {
+                    float u = (ax - knee) * invRange;
+                    float y = knee + range * (u / (1.0f + u));
+                    dst[i] = x < 0.0f ? -y : y;
+                }
+            }
+        }
+    }
+}
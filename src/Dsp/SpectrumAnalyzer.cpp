@@ -0,0 +1,252 @@
+#include "Dsp/SpectrumAnalyzer.h"
+#include "Dsp/SampleFormat.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Dsp
+{
+    namespace
+    {
+        constexpr double kPi = 3.14159265358979323846;
+    }
+
+    /**
+     * @brief Validates the configuration and preallocates every buffer.
+     *
+     * @param config Analysis parameters.
+     * @param sampleRate Sample rate in Hz.
+     * @param maxFrames Largest pushRaw() call in frames.
+     * @return true on success.
+     */
+    bool SpectrumAnalyzer::configure(const SpectrumConfig &config, uint32_t sampleRate, size_t maxFrames)
+    {
+        if (sampleRate == 0 || config.bandCount == 0 || config.minFrequency <= 0.0f ||
+            config.maxFrequency <= config.minFrequency || config.overlap < 0.0f || config.overlap > 0.95f)
+            return false;
+
+        if (!m_fft.configure(config.fftSize))
+            return false;
+
+        m_config = config;
+        m_sampleRate = sampleRate;
+        m_maxFrames = maxFrames;
+
+        const size_t n = config.fftSize;
+        m_hop = static_cast<size_t>(static_cast<double>(n) * (1.0 - config.overlap));
+        if (m_hop == 0)
+            m_hop = 1;
+
+        // Periodic window
+        m_window.assign(n, 0.0f);
+        double windowSum = 0.0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double x = 2.0 * kPi * static_cast<double>(i) / static_cast<double>(n);
+            double w = 0.0;
+            if (config.window == WindowType::Hann)
+                w = 0.5 - 0.5 * std::cos(x);
+            else
+                w = 0.35875 - 0.48829 * std::cos(x) + 0.14128 * std::cos(2.0 * x) - 0.01168 * std::cos(3.0 * x);
+            m_window[i] = static_cast<float>(w);
+            windowSum += w;
+        }
+        m_amplitudeScale = static_cast<float>(2.0 / windowSum);
+
+        m_history.assign(n, 0.0f);
+        m_writePos = 0;
+        m_filled = 0;
+        m_sinceLast = 0;
+
+        m_re.assign(n, 0.0f);
+        m_im.assign(n, 0.0f);
+        m_magnitudes.assign(n / 2 + 1, 0.0f);
+
+        // Logarithmically spaced bands, each covering at least one bin
+        const float nyquist = static_cast<float>(sampleRate) * 0.5f;
+        const float maxFrequency = std::min(config.maxFrequency, nyquist);
+        const float minFrequency = std::min(config.minFrequency, maxFrequency * 0.5f);
+        m_config.minFrequency = minFrequency;
+        m_config.maxFrequency = maxFrequency;
+
+        const double binHz = static_cast<double>(sampleRate) / static_cast<double>(n);
+        const size_t lastBin = n / 2;
+        m_bandFirst.assign(config.bandCount, 0);
+        m_bandLast.assign(config.bandCount, 0);
+        for (uint32_t b = 0; b < config.bandCount; ++b)
+        {
+            float low = 0.0f, high = 0.0f;
+            bandEdges(b, low, high);
+            size_t first = static_cast<size_t>(std::floor(low / binHz + 0.5));
+            size_t last = static_cast<size_t>(std::floor(high / binHz + 0.5));
+            if (last > 0)
+                --last;
+            first = std::min(first, lastBin);
+            last = std::min(std::max(last, first), lastBin);
+            m_bandFirst[b] = static_cast<uint32_t>(first);
+            m_bandLast[b] = static_cast<uint32_t>(last);
+        }
+
+        m_convert.assign(maxFrames * 8, 0.0f); // Up to 7.1 per pushRaw() chunk
+
+        for (std::vector<float> &slot : m_slots)
+            slot.assign(config.bandCount, 0.0f);
+        for (uint64_t &seq : m_slotSequence)
+            seq = 0;
+        m_back = 0;
+        m_front = 2;
+        m_middle.store(1, std::memory_order_relaxed);
+        m_sequence = 0;
+
+        return true;
+    }
+
+    /**
+     * @brief Returns the centre frequency of a bin.
+     */
+    float SpectrumAnalyzer::binFrequency(size_t bin) const
+    {
+        if (m_config.fftSize == 0)
+            return 0.0f;
+
+        return static_cast<float>(bin) * static_cast<float>(m_sampleRate) / static_cast<float>(m_config.fftSize);
+    }
+
+    /**
+     * @brief Computes the log-spaced edges of a band.
+     */
+    void SpectrumAnalyzer::bandEdges(uint32_t band, float &low, float &high) const
+    {
+        const double ratio = static_cast<double>(m_config.maxFrequency) / static_cast<double>(m_config.minFrequency);
+        const double count = static_cast<double>(m_config.bandCount);
+        low = static_cast<float>(m_config.minFrequency * std::pow(ratio, band / count));
+        high = static_cast<float>(m_config.minFrequency * std::pow(ratio, (band + 1) / count));
+    }
+
+    /**
+     * @brief Appends frames to the history and analyses every `hop` samples.
+     *
+     * @param interleaved Float frames.
+     * @param frames Frame count.
+     * @param channels Channels per frame.
+     * @return size_t Analyses performed.
+     */
+    size_t SpectrumAnalyzer::push(const float *interleaved, size_t frames, uint32_t channels)
+    {
+        if (m_config.fftSize == 0 || channels == 0 || !interleaved)
+            return 0;
+
+        const size_t n = m_config.fftSize;
+        const float inv = 1.0f / static_cast<float>(channels);
+        size_t analyses = 0;
+
+        for (size_t f = 0; f < frames; ++f)
+        {
+            const float *frame = interleaved + f * channels;
+            float mono = frame[0];
+            for (uint32_t c = 1; c < channels; ++c)
+                mono += frame[c];
+
+            m_history[m_writePos] = mono * inv;
+            m_writePos = (m_writePos + 1 == n) ? 0 : m_writePos + 1;
+            if (m_filled < n)
+                ++m_filled;
+
+            if (++m_sinceLast >= m_hop && m_filled == n)
+            {
+                analyze();
+                m_sinceLast = 0;
+                ++analyses;
+            }
+        }
+
+        return analyses;
+    }
+
+    /**
+     * @brief Converts raw device frames to float in bounded chunks and pushes them.
+     *
+     * @param data Raw frames.
+     * @param frames Frame count.
+     * @param format Format of `data`.
+     * @return size_t Analyses performed.
+     */
+    size_t SpectrumAnalyzer::pushRaw(const void *data, size_t frames, const Utility::DeviceFormatInfo &format)
+    {
+        if (!IsConvertibleFormat(format) || format.channels == 0 || format.channels > 8 || m_maxFrames == 0)
+            return 0;
+
+        const uint8_t *raw = static_cast<const uint8_t *>(data);
+        size_t analyses = 0;
+
+        while (frames > 0)
+        {
+            const size_t n = frames < m_maxFrames ? frames : m_maxFrames;
+            ToFloat(raw, m_convert.data(), n * format.channels, format);
+            analyses += push(m_convert.data(), n, format.channels);
+            raw += n * format.blockAlign;
+            frames -= n;
+        }
+
+        return analyses;
+    }
+
+    /**
+     * @brief Windows the latest fftSize samples, transforms and publishes the bands.
+     */
+    void SpectrumAnalyzer::analyze()
+    {
+        const size_t n = m_config.fftSize;
+
+        // Oldest sample sits at the write position
+        const size_t tail = n - m_writePos;
+        for (size_t i = 0; i < tail; ++i)
+            m_re[i] = m_history[m_writePos + i] * m_window[i];
+        for (size_t i = 0; i < m_writePos; ++i)
+            m_re[tail + i] = m_history[i] * m_window[tail + i];
+        std::fill(m_im.begin(), m_im.end(), 0.0f);
+
+        m_fft.forward(m_re.data(), m_im.data());
+
+        for (size_t k = 0; k <= n / 2; ++k)
+            m_magnitudes[k] = std::sqrt(m_re[k] * m_re[k] + m_im[k] * m_im[k]) * m_amplitudeScale;
+
+        ++m_sequence;
+        publish();
+    }
+
+    /**
+     * @brief Writes band averages into the back slot and swaps it into the middle.
+     */
+    void SpectrumAnalyzer::publish()
+    {
+        std::vector<float> &slot = m_slots[m_back];
+        for (uint32_t b = 0; b < m_config.bandCount; ++b)
+        {
+            float sum = 0.0f;
+            for (uint32_t k = m_bandFirst[b]; k <= m_bandLast[b]; ++k)
+                sum += m_magnitudes[k];
+            slot[b] = sum / static_cast<float>(m_bandLast[b] - m_bandFirst[b] + 1);
+        }
+        m_slotSequence[m_back] = m_sequence;
+
+        m_back = m_middle.exchange(m_back | DirtyBit, std::memory_order_acq_rel) & ~DirtyBit;
+    }
+
+    /**
+     * @brief Takes the middle slot if it holds a new snapshot and copies it out.
+     *
+     * @param out Destination.
+     * @return true if a new snapshot was read.
+     */
+    bool SpectrumAnalyzer::readSnapshot(SpectrumSnapshot &out)
+    {
+        if ((m_middle.load(std::memory_order_acquire) & DirtyBit) == 0)
+            return false;
+
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & ~DirtyBit;
+        out.sequence = m_slotSequence[m_front];
+        out.bands.assign(m_slots[m_front].begin(), m_slots[m_front].end());
+        return true;
+    }
+}
@@ -0,0 +1,92 @@
+#include "Dsp/TestSignal.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Dsp
+{
+    namespace
+    {
+        constexpr double kPi = 3.14159265358979323846;
+
+        /// Feedback taps (1-based bit positions) of primitive polynomials, indexed by order.
+        constexpr uint32_t kMlsTaps[21][2] = {
+            {0, 0}, {0, 0}, {2, 1}, {3, 2}, {4, 3}, {5, 3}, {6, 5}, {7, 6}, {8, 6},
+            {9, 5}, {10, 7}, {11, 9}, {12, 11}, {13, 12}, {14, 13}, {15, 14}, {16, 15},
+            {17, 14}, {18, 11}, {19, 18}, {20, 17}};
+
+        /// Extra taps for orders whose primitive polynomials need four terms.
+        constexpr uint32_t kMlsExtraTaps[21][2] = {
+            {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {5, 4},
+            {0, 0}, {0, 0}, {0, 0}, {10, 4}, {11, 8}, {12, 2}, {0, 0}, {13, 4},
+            {0, 0}, {0, 0}, {17, 14}, {0, 0}};
+    }
+
+    /**
+     * @brief Generates a log sweep: instantaneous frequency rises exponentially from start to end.
+     *
+     * 5 ms fades at both ends avoid clicks that would smear the correlation peak.
+     *
+     * @param sampleRate Sample rate.
+     * @param durationMs Length.
+     * @param startHz Start frequency.
+     * @param endHz End frequency.
+     * @param amplitude Peak level.
+     * @return std::vector<float> Sweep samples.
+     */
+    std::vector<float> GenerateLogChirp(uint32_t sampleRate, uint32_t durationMs, float startHz, float endHz, float amplitude)
+    {
+        const size_t length = static_cast<size_t>(sampleRate) * durationMs / 1000;
+        endHz = std::min(endHz, static_cast<float>(sampleRate) * 0.45f);
+        if (length < 2 || startHz <= 0.0f || endHz <= startHz)
+            return {};
+
+        std::vector<float> out(length);
+        const double duration = static_cast<double>(length) / sampleRate;
+        const double k = std::log(static_cast<double>(endHz) / startHz);
+        const size_t fade = std::min(length / 2, static_cast<size_t>(sampleRate / 200));
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            const double t = static_cast<double>(i) / sampleRate;
+            const double phase = 2.0 * kPi * startHz * duration / k * (std::exp(t * k / duration) - 1.0);
+            double gain = amplitude;
+            if (i < fade)
+                gain *= 0.5 - 0.5 * std::cos(kPi * i / fade);
+            else if (i >= length - fade)
+                gain *= 0.5 - 0.5 * std::cos(kPi * (length - 1 - i) / fade);
+            out[i] = static_cast<float>(gain * std::sin(phase));
+        }
+
+        return out;
+    }
+
+    /**
+     * @brief Generates an MLS: its circular autocorrelation is a single spike.
+     *
+     * @param order Register length.
+     * @param amplitude Level.
+     * @return std::vector<float> Sequence of 2^order - 1 samples.
+     */
+    std::vector<float> GenerateMls(uint32_t order, float amplitude)
+    {
+        if (order < 2 || order > 20)
+            return {};
+
+        const size_t length = (static_cast<size_t>(1) << order) - 1;
+        std::vector<float> out(length);
+        uint32_t state = 1;
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            out[i] = (state & 1u) ? amplitude : -amplitude;
+
+            uint32_t bit = ((state >> (kMlsTaps[order][0] - 1)) ^ (state >> (kMlsTaps[order][1] - 1))) & 1u;
+            if (kMlsExtraTaps[order][0] != 0)
+                bit ^= ((state >> (kMlsExtraTaps[order][0] - 1)) ^ (state >> (kMlsExtraTaps[order][1] - 1))) & 1u;
+            state = ((state << 1) | bit) & ((1u << order) - 1);
+        }
+
+        return out;
+    }
+}
@@ -0,0 +1,240 @@
+#include "Dsp/VoiceActivityDetector.h"
+#include "Dsp/SampleFormat.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Dsp
+{
+    namespace
+    {
+        constexpr double kPi = 3.14159265358979323846;
+        constexpr float kSilenceDb = -120.0f;
+        constexpr float kSpeechBandLowHz = 300.0f;
+        constexpr float kSpeechBandHighHz = 4000.0f;
+        constexpr float kFloorRiseDbPerFrame = 0.05f; ///< Slow upward tracking (≈ 5 dB/s at 10 ms frames)
+    }
+
+    /**
+     * @brief Prepares frame buffers, the analysis window and the speech band bins.
+     *
+     * The FFT size is the next power of two above the frame length; the frame is
+     * zero-padded.
+     *
+     * @param sampleRate Sample rate.
+     * @param config Tuning.
+     * @param maxFrames Largest pushRaw() call.
+     * @return true on success.
+     */
+    bool VoiceActivityDetector::configure(uint32_t sampleRate, const VadConfig &config, size_t maxFrames)
+    {
+        if (sampleRate == 0 || config.frameMs == 0 || config.attackFrames == 0)
+            return false;
+
+        m_config = config;
+        m_sampleRate = sampleRate;
+        m_maxFrames = maxFrames;
+        m_frameSamples = static_cast<size_t>(sampleRate) * config.frameMs / 1000;
+        if (m_frameSamples < 16)
+            return false;
+        m_hangoverFrames = config.hangoverMs / config.frameMs;
+
+        size_t fftSize = 16;
+        while (fftSize < m_frameSamples)
+            fftSize <<= 1;
+        if (!m_fft.configure(fftSize))
+            return false;
+
+        m_window.assign(m_frameSamples, 0.0f);
+        for (size_t i = 0; i < m_frameSamples; ++i)
+            m_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / m_frameSamples));
+
+        m_frame.assign(m_frameSamples, 0.0f);
+        m_re.assign(fftSize, 0.0f);
+        m_im.assign(fftSize, 0.0f);
+        m_convert.assign(maxFrames * 8, 0.0f); // Up to 7.1 per pushRaw() chunk
+
+        const double binHz = static_cast<double>(sampleRate) / static_cast<double>(fftSize);
+        m_bandFirst = std::max<size_t>(1, static_cast<size_t>(kSpeechBandLowHz / binHz));
+        m_bandLast = std::min<size_t>(fftSize / 2, static_cast<size_t>(kSpeechBandHighHz / binHz));
+        if (m_bandLast <= m_bandFirst)
+            m_bandLast = std::min(fftSize / 2, m_bandFirst + 1);
+
+        reset();
+        return true;
+    }
+
+    /**
+     * @brief Resets the detector to inactive with no noise-floor estimate.
+     */
+    void VoiceActivityDetector::reset()
+    {
+        m_fill = 0;
+        m_features = VadFeatures();
+        m_floorInitialised = false;
+        m_speechRun = 0;
+        m_hangover = 0;
+        m_active = false;
+    }
+
+    /**
+     * @brief Collects samples into frames and classifies every complete frame.
+     *
+     * @param mono Mono samples.
+     * @param samples Count.
+     * @return bool Activity after processing.
+     */
+    bool VoiceActivityDetector::push(const float *mono, size_t samples)
+    {
+        if (m_frameSamples == 0 || !mono)
+            return m_active;
+
+        while (samples > 0)
+        {
+            size_t n = std::min(samples, m_frameSamples - m_fill);
+            std::copy(mono, mono + n, m_frame.begin() + static_cast<std::ptrdiff_t>(m_fill));
+            m_fill += n;
+            mono += n;
+            samples -= n;
+
+            if (m_fill == m_frameSamples)
+            {
+                processFrame();
+                m_fill = 0;
+            }
+        }
+
+        return m_active;
+    }
+
+    /**
+     * @brief Converts raw frames to mono float in bounded chunks and pushes them.
+     *
+     * @param data Raw frames.
+     * @param frames Frame count.
+     * @param format Format of `data`.
+     * @return bool Activity after processing.
+     */
+    bool VoiceActivityDetector::pushRaw(const void *data, size_t frames, const Utility::DeviceFormatInfo &format)
+    {
+        if (!IsConvertibleFormat(format) || format.channels == 0 || format.channels > 8 || m_maxFrames == 0)
+            return m_active;
+
+        const uint8_t *raw = static_cast<const uint8_t *>(data);
+        const uint32_t channels = format.channels;
+        const float inv = 1.0f / static_cast<float>(channels);
+
+        while (frames > 0)
+        {
+            const size_t n = std::min(frames, m_maxFrames);
+            ToFloat(raw, m_convert.data(), n * channels, format);
+
+            // Downmix in place: frame f lands in m_convert[f]
+            for (size_t f = 0; f < n; ++f)
+            {
+                float sum = 0.0f;
+                for (uint32_t c = 0; c < channels; ++c)
+                    sum += m_convert[f * channels + c];
+                m_convert[f] = sum * inv;
+            }
+
+            push(m_convert.data(), n);
+            raw += n * format.blockAlign;
+            frames -= n;
+        }
+
+        return m_active;
+    }
+
+    /**
+     * @brief Extracts the features of the collected frame and advances the state machine.
+     */
+    void VoiceActivityDetector::processFrame()
+    {
+        const size_t n = m_frameSamples;
+
+        // Level and zero-crossing rate (DC removed so offset does not hide crossings)
+        double mean = 0.0;
+        for (size_t i = 0; i < n; ++i)
+            mean += m_frame[i];
+        mean /= static_cast<double>(n);
+
+        double energy = 0.0;
+        size_t crossings = 0;
+        float previous = static_cast<float>(m_frame[0] - mean);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const float x = static_cast<float>(m_frame[i] - mean);
+            energy += static_cast<double>(x) * x;
+            crossings += ((x >= 0.0f) != (previous >= 0.0f)) ? 1u : 0u;
+            previous = x;
+        }
+
+        const double rms = std::sqrt(energy / static_cast<double>(n));
+        m_features.levelDb = rms > 1e-6 ? static_cast<float>(20.0 * std::log10(rms)) : kSilenceDb;
+        m_features.zeroCrossing = static_cast<float>(crossings) / static_cast<float>(n);
+
+        // Spectral flatness of the speech band: geometric / arithmetic mean of the power
+        std::fill(m_re.begin(), m_re.end(), 0.0f);
+        std::fill(m_im.begin(), m_im.end(), 0.0f);
+        for (size_t i = 0; i < n; ++i)
+            m_re[i] = static_cast<float>(m_frame[i] - mean) * m_window[i];
+        m_fft.forward(m_re.data(), m_im.data());
+
+        double logSum = 0.0, linSum = 0.0;
+        for (size_t k = m_bandFirst; k <= m_bandLast; ++k)
+        {
+            const double power = static_cast<double>(m_re[k]) * m_re[k] + static_cast<double>(m_im[k]) * m_im[k] + 1e-12;
+            logSum += std::log(power);
+            linSum += power;
+        }
+        const double bins = static_cast<double>(m_bandLast - m_bandFirst + 1);
+        m_features.flatness = static_cast<float>(std::exp(logSum / bins) / (linSum / bins));
+
+        // Noise floor: follow drops immediately, rises slowly
+        if (!m_floorInitialised)
+        {
+            m_features.noiseFloorDb = m_features.levelDb;
+            m_floorInitialised = true;
+        }
+        else if (m_features.levelDb < m_features.noiseFloorDb)
+        {
+            m_features.noiseFloorDb = m_features.levelDb;
+        }
+        else
+        {
+            m_features.noiseFloorDb = std::min(m_features.levelDb, m_features.noiseFloorDb + kFloorRiseDbPerFrame);
+        }
+
+        // Energy is mandatory; speech must also look voiced by one of the other two features
+        const bool loud = m_features.levelDb > m_config.minLevelDb &&
+                          m_features.levelDb > m_features.noiseFloorDb + m_config.snrThresholdDb;
+        const bool tonal = m_features.flatness < m_config.maxFlatness;
+        const bool voicedRate = m_features.zeroCrossing >= m_config.minZeroCrossing &&
+                                m_features.zeroCrossing <= m_config.maxZeroCrossing;
+        m_features.speechFrame = loud && (tonal || voicedRate);
+
+        // Attack / hangover state machine
+        if (m_features.speechFrame)
+        {
+            if (m_speechRun < m_config.attackFrames)
+                ++m_speechRun;
+            if (m_speechRun >= m_config.attackFrames)
+            {
+                m_active = true;
+                m_hangover = m_hangoverFrames;
+            }
+        }
+        else
+        {
+            m_speechRun = 0;
+            if (m_active)
+            {
+                if (m_hangover > 0)
+                    --m_hangover;
+                else
+                    m_active = false;
+            }
+        }
+    }
+}
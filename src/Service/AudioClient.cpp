@@ -0,0 +1,278 @@
+#include "Service/AudioClient.h"
+#include "LocalSocket.h"
+
+namespace Service
+{
+    AudioClient::AudioClient() = default;
+
+    AudioClient::~AudioClient()
+    {
+        disconnect();
+    }
+
+    bool AudioClient::connect(const std::string &endpoint)
+    {
+        disconnect();
+
+        m_stream = LocalConnection::connect(endpoint);
+        if (!m_stream)
+            return false;
+
+        m_connected.store(true, std::memory_order_release);
+        m_reader = std::thread(&AudioClient::readLoop, this);
+        return true;
+    }
+
+    void AudioClient::disconnect()
+    {
+        if (m_stream)
+            m_stream->shutdown();
+        if (m_reader.joinable())
+            m_reader.join();
+        m_stream.reset();
+    }
+
+    /**
+     * @brief Registers a promise under a fresh request ID and writes the frame.
+     *
+     * A failed write shuts the stream down; the reader thread then fails every
+     * pending request, this one included.
+     */
+    std::future<ServiceResponse> AudioClient::request(MessageType type, const std::vector<uint8_t> &payload)
+    {
+        std::promise<ServiceResponse> promise;
+        std::future<ServiceResponse> future = promise.get_future();
+
+        uint32_t requestId = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!isConnected())
+            {
+                promise.set_value(ServiceResponse());
+                return future;
+            }
+            requestId = m_nextId++;
+            if (m_nextId == 0)
+                m_nextId = 1; // 0 is reserved for events
+            m_pending.emplace(requestId, std::move(promise));
+        }
+
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        m_frame.clear();
+        FrameWriter w(m_frame, static_cast<uint8_t>(type), requestId);
+        w.bytes(payload.data(), payload.size());
+        w.finish();
+        if (!m_stream->writeAll(m_frame.data(), m_frame.size()))
+            m_stream->shutdown();
+        return future;
+    }
+
+    HRESULT AudioClient::call(MessageType type, const std::vector<uint8_t> &payload, ServiceResponse &response)
+    {
+        response = request(type, payload).get();
+        return response.status;
+    }
+
+    HRESULT AudioClient::ping()
+    {
+        ServiceResponse response;
+        return call(MessageType::Ping, {}, response);
+    }
+
+    HRESULT AudioClient::listDevices(int32_t flow, std::vector<ServiceDevice> &devices)
+    {
+        devices.clear();
+
+        std::vector<uint8_t> payload;
+        FrameWriter(payload).u8(static_cast<uint8_t>(flow));
+        ServiceResponse response;
+        if (FAILED(call(MessageType::ListDevices, payload, response)))
+            return response.status;
+
+        FrameReader in(response.body.data(), response.body.size());
+        const uint32_t count = in.u32();
+        for (uint32_t i = 0; i < count && in.ok(); ++i)
+        {
+            ServiceDevice device;
+            device.handle = in.u32();
+            device.flow = in.u8();
+            device.state = in.u32();
+            device.defaultRoles = in.u8();
+            device.id = in.str();
+            device.name = in.str();
+            if (in.ok())
+                devices.push_back(std::move(device));
+        }
+        return in.ok() ? response.status : E_FAIL;
+    }
+
+    HRESULT AudioClient::getDefault(int32_t flow, int32_t role, AswDevice &device)
+    {
+        device = 0;
+        std::vector<uint8_t> payload;
+        FrameWriter(payload).u8(static_cast<uint8_t>(flow)).u8(static_cast<uint8_t>(role));
+        ServiceResponse response;
+        if (FAILED(call(MessageType::GetDefault, payload, response)))
+            return response.status;
+
+        FrameReader in(response.body.data(), response.body.size());
+        device = in.u32();
+        return in.ok() ? response.status : E_FAIL;
+    }
+
+    HRESULT AudioClient::setDefault(AswDevice device, uint32_t roles)
+    {
+        std::vector<uint8_t> payload;
+        FrameWriter(payload).u32(device).u8(static_cast<uint8_t>(roles));
+        ServiceResponse response;
+        return call(MessageType::SetDefault, payload, response);
+    }
+
+    HRESULT AudioClient::findDevice(const std::string &id, AswDevice &device)
+    {
+        device = 0;
+        std::vector<uint8_t> payload;
+        FrameWriter(payload).str(id);
+        ServiceResponse response;
+        if (FAILED(call(MessageType::FindDevice, payload, response)))
+            return response.status;
+
+        FrameReader in(response.body.data(), response.body.size());
+        device = in.u32();
+        return in.ok() ? response.status : E_FAIL;
+    }
+
+    HRESULT AudioClient::getMute(AswDevice device, bool &muted)
+    {
+        muted = false;
+        std::vector<uint8_t> payload;
+        FrameWriter(payload).u32(device);
+        ServiceResponse response;
+        if (FAILED(call(MessageType::GetMute, payload, response)))
+            return response.status;
+
+        FrameReader in(response.body.data(), response.body.size());
+        muted = in.u8() != 0;
+        return in.ok() ? response.status : E_FAIL;
+    }
+
+    HRESULT AudioClient::setMute(AswDevice device, bool muted)
+    {
+        std::vector<uint8_t> payload;
+        FrameWriter(payload).u32(device).u8(muted ? 1 : 0);
+        ServiceResponse response;
+        return call(MessageType::SetMute, payload, response);
+    }
+
+    HRESULT AudioClient::getVolume(AswDevice device, float &volume)
+    {
+        volume = 0.0f;
+        std::vector<uint8_t> payload;
+        FrameWriter(payload).u32(device);
+        ServiceResponse response;
+        if (FAILED(call(MessageType::GetVolume, payload, response)))
+            return response.status;
+
+        FrameReader in(response.body.data(), response.body.size());
+        volume = in.f32();
+        return in.ok() ? response.status : E_FAIL;
+    }
+
+    HRESULT AudioClient::setVolume(AswDevice device, float volume)
+    {
+        std::vector<uint8_t> payload;
+        FrameWriter(payload).u32(device).f32(volume);
+        ServiceResponse response;
+        return call(MessageType::SetVolume, payload, response);
+    }
+
+    HRESULT AudioClient::subscribe(ServiceEventCallback callback)
+    {
+        const bool enable = static_cast<bool>(callback);
+        {
+            std::lock_guard<std::mutex> lock(m_callbackMutex);
+            m_callback = std::move(callback);
+        }
+
+        std::vector<uint8_t> payload;
+        FrameWriter(payload).u8(enable ? 1 : 0);
+        ServiceResponse response;
+        return call(MessageType::Subscribe, payload, response);
+    }
+
+    /**
+     * @brief Reader thread: completes pending requests and dispatches events until the stream ends.
+     */
+    void AudioClient::readLoop()
+    {
+        std::vector<uint8_t> frame;
+        uint8_t header[4];
+        while (m_stream->readAll(header, sizeof(header)))
+        {
+            const uint32_t length = static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+                                    (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+            if (length < kFrameHeaderSize - 4 || length > kMaxFrameSize)
+                break;
+
+            frame.resize(length);
+            if (!m_stream->readAll(frame.data(), length))
+                break;
+
+            FrameReader in(frame.data(), frame.size());
+            const uint8_t type = in.u8();
+            const uint32_t requestId = in.u32();
+
+            if (type == static_cast<uint8_t>(MessageType::Event))
+            {
+                AswEvent event = {};
+                event.type = in.u8();
+                event.device = in.u32();
+                event.flow = in.u8();
+                event.role = in.u8();
+                event.state = in.u32();
+                event.volume = in.f32();
+                event.muted = in.u8();
+
+                std::lock_guard<std::mutex> lock(m_callbackMutex);
+                if (in.ok() && m_callback)
+                    m_callback(event);
+                continue;
+            }
+
+            if ((type & kResponseFlag) == 0)
+                break;
+
+            ServiceResponse response;
+            response.status = static_cast<HRESULT>(in.i32());
+            if (!in.ok())
+                break;
+            response.body.assign(frame.end() - static_cast<std::ptrdiff_t>(in.remaining()), frame.end());
+
+            std::promise<ServiceResponse> promise;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_pending.find(requestId);
+                if (it == m_pending.end())
+                    continue;
+                promise = std::move(it->second);
+                m_pending.erase(it);
+            }
+            promise.set_value(std::move(response));
+        }
+
+        m_stream->shutdown();
+        failPending();
+    }
+
+    void AudioClient::failPending()
+    {
+        std::unordered_map<uint32_t, std::promise<ServiceResponse>> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_connected.store(false, std::memory_order_release);
+            pending.swap(m_pending);
+        }
+        for (auto &entry : pending)
+            entry.second.set_value(ServiceResponse());
+    }
+}
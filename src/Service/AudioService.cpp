@@ -0,0 +1,430 @@
+#include "Service/AudioService.h"
+#include "LocalSocket.h"
+
+#include <condition_variable>
+
+namespace Service
+{
+    /**
+     * @brief One client: its stream, the reader/writer threads and the unsent output.
+     *
+     * Output is a single byte buffer that the writer swaps out and sends in one
+     * write, so pipelined responses and events are batched naturally.
+     */
+    class AudioService::Connection
+    {
+    public:
+        Connection(std::unique_ptr<LocalConnection> stream, size_t maxQueuedBytes)
+            : m_stream(std::move(stream)), m_maxQueued(maxQueuedBytes) {}
+
+        LocalConnection &stream() { return *m_stream; }
+
+        /**
+         * @brief Queues a frame for the writer; closes the connection if the client fell too far behind.
+         */
+        bool enqueue(const uint8_t *data, size_t size)
+        {
+            bool queued = false;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_closed)
+                    return false;
+                if (m_pending.size() + size > m_maxQueued)
+                {
+                    m_closed = true;
+                    m_stream->shutdown();
+                }
+                else
+                {
+                    m_pending.insert(m_pending.end(), data, data + size);
+                    queued = true;
+                }
+            }
+            m_ready.notify_one();
+            return queued;
+        }
+
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_closed = true;
+            }
+            m_stream->shutdown();
+            m_ready.notify_one();
+        }
+
+        void writeLoop()
+        {
+            std::vector<uint8_t> sending;
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_ready.wait(lock, [this]
+                                 { return m_closed || !m_pending.empty(); });
+                    if (m_pending.empty())
+                        return;
+                    sending.swap(m_pending);
+                }
+                if (!m_stream->writeAll(sending.data(), sending.size()))
+                {
+                    close();
+                    return;
+                }
+                sending.clear();
+            }
+        }
+
+        std::thread reader;
+        std::thread writer;
+        std::atomic<bool> finished{false};
+        std::atomic<bool> subscribed{false};
+
+        // Reader-thread scratch, reused across requests
+        std::vector<uint8_t> request;
+        std::vector<uint8_t> response;
+        std::vector<AswDeviceInfo> devices;
+        std::vector<char> text;
+
+    private:
+        std::unique_ptr<LocalConnection> m_stream;
+        size_t m_maxQueued;
+        std::mutex m_mutex;
+        std::condition_variable m_ready;
+        std::vector<uint8_t> m_pending;
+        bool m_closed = false;
+    };
+
+    namespace
+    {
+        /**
+         * @brief Reads a context string (ID or name) through the size-query API.
+         */
+        template <typename Get>
+        std::string ReadString(AswContext *context, AswDevice device, std::vector<char> &buffer, Get get)
+        {
+            uint32_t size = 0;
+            if (buffer.empty())
+                buffer.resize(256);
+            int32_t hr = get(context, device, buffer.data(), static_cast<uint32_t>(buffer.size()), &size);
+            if (hr == ASW_E_INSUFFICIENT_BUFFER)
+            {
+                buffer.resize(size);
+                hr = get(context, device, buffer.data(), static_cast<uint32_t>(buffer.size()), &size);
+            }
+            return hr == ASW_OK ? std::string(buffer.data(), size - 1) : std::string();
+        }
+    }
+
+    AudioService::AudioService(const ServiceConfig &config)
+        : m_config(config),
+          m_endpoint(config.endpoint.empty() ? DefaultServiceEndpoint() : config.endpoint)
+    {
+    }
+
+    AudioService::~AudioService()
+    {
+        stop();
+    }
+
+    /**
+     * @brief Creates the warm device context, opens the endpoint and starts the accept thread.
+     */
+    bool AudioService::start()
+    {
+        if (isRunning())
+            return true;
+        m_alreadyRunning = false;
+
+        if (AswCreateContext(&m_context) != ASW_OK)
+            return false;
+        AswSetEventCallback(m_context, &AudioService::onEvent, this);
+
+        m_listener.reset(new LocalListener());
+        const ListenStatus status = m_listener->listen(m_endpoint);
+        if (status != ListenStatus::Listening)
+        {
+            m_alreadyRunning = status == ListenStatus::AlreadyRunning;
+            m_listener.reset();
+            AswDestroyContext(m_context);
+            m_context = nullptr;
+            return false;
+        }
+
+        m_running.store(true, std::memory_order_release);
+        m_acceptThread = std::thread(&AudioService::acceptLoop, this);
+        return true;
+    }
+
+    void AudioService::stop()
+    {
+        if (!m_running.exchange(false))
+            return;
+
+        m_listener->close();
+        if (m_acceptThread.joinable())
+            m_acceptThread.join();
+        reap(true);
+        m_listener.reset();
+
+        AswDestroyContext(m_context);
+        m_context = nullptr;
+    }
+
+    ServiceStats AudioService::stats() const
+    {
+        ServiceStats stats;
+        stats.connections = m_accepted.load(std::memory_order_relaxed);
+        stats.requests = m_requests.load(std::memory_order_relaxed);
+        stats.events = m_events.load(std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(m_connectionsMutex);
+        for (const std::shared_ptr<Connection> &connection : m_connections)
+            stats.activeConnections += connection->finished.load(std::memory_order_relaxed) ? 0 : 1;
+        return stats;
+    }
+
+    void AudioService::acceptLoop()
+    {
+        while (isRunning())
+        {
+            std::unique_ptr<LocalConnection> stream = m_listener->accept();
+            if (!stream)
+                break;
+
+            reap(false);
+            auto connection = std::make_shared<Connection>(std::move(stream), m_config.maxQueuedBytes);
+            {
+                std::lock_guard<std::mutex> lock(m_connectionsMutex);
+                m_connections.push_back(connection);
+            }
+            m_accepted.fetch_add(1, std::memory_order_relaxed);
+            connection->writer = std::thread(&Connection::writeLoop, connection.get());
+            connection->reader = std::thread(&AudioService::serve, this, connection);
+        }
+    }
+
+    /**
+     * @brief Reader thread: answers the requests of one connection in order until it closes.
+     */
+    void AudioService::serve(const std::shared_ptr<Connection> &connection)
+    {
+        Connection &c = *connection;
+        uint8_t header[4];
+        while (c.stream().readAll(header, sizeof(header)))
+        {
+            const uint32_t length = static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+                                    (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+            if (length < kFrameHeaderSize - 4 || length > kMaxFrameSize)
+                break;
+
+            c.request.resize(length);
+            if (!c.stream().readAll(c.request.data(), length))
+                break;
+
+            FrameReader in(c.request.data(), c.request.size());
+            const uint8_t type = in.u8();
+            const uint32_t requestId = in.u32();
+            m_requests.fetch_add(1, std::memory_order_relaxed);
+
+            c.response.clear();
+            handle(c, type, requestId, in, c.response);
+            if (!c.enqueue(c.response.data(), c.response.size()))
+                break;
+        }
+
+        c.close();
+        c.finished.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Executes one request against the device context and writes the response frame.
+     */
+    void AudioService::handle(Connection &connection, uint8_t type, uint32_t requestId, FrameReader &in, std::vector<uint8_t> &out)
+    {
+        FrameWriter w(out, static_cast<uint8_t>(type | kResponseFlag), requestId);
+
+        switch (static_cast<MessageType>(type))
+        {
+        case MessageType::Ping:
+            w.i32(ASW_OK);
+            break;
+
+        case MessageType::ListDevices:
+        {
+            const int32_t flow = in.u8();
+            std::vector<AswDeviceInfo> &devices = connection.devices;
+            uint32_t count = 0;
+            if (!in.ok())
+            {
+                w.i32(ASW_E_INVALIDARG);
+                break;
+            }
+            int32_t hr = AswEnumerateDevices(m_context, flow, devices.data(), static_cast<uint32_t>(devices.size()), &count);
+            if (hr == ASW_E_INSUFFICIENT_BUFFER)
+            {
+                devices.resize(count + 8);
+                hr = AswEnumerateDevices(m_context, flow, devices.data(), static_cast<uint32_t>(devices.size()), &count);
+            }
+            w.i32(hr);
+            if (hr != ASW_OK)
+                break;
+
+            w.u32(count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const AswDeviceInfo &device = devices[i];
+                w.u32(device.device).u8(static_cast<uint8_t>(device.flow)).u32(device.state).u8(static_cast<uint8_t>(device.defaultRoles));
+                w.str(ReadString(m_context, device.device, connection.text, AswGetDeviceId));
+                w.str(ReadString(m_context, device.device, connection.text, AswGetDeviceName));
+            }
+            break;
+        }
+
+        case MessageType::GetDefault:
+        {
+            const int32_t flow = in.u8();
+            const int32_t role = in.u8();
+            AswDevice device = 0;
+            const int32_t hr = in.ok() ? AswGetDefaultDevice(m_context, flow, role, &device) : ASW_E_INVALIDARG;
+            w.i32(hr);
+            if (hr >= 0)
+                w.u32(device);
+            break;
+        }
+
+        case MessageType::SetDefault:
+        {
+            const AswDevice device = in.u32();
+            const uint32_t roles = in.u8();
+            w.i32(in.ok() ? AswSetDefaultDevice(m_context, device, roles) : ASW_E_INVALIDARG);
+            break;
+        }
+
+        case MessageType::GetMute:
+        {
+            const AswDevice device = in.u32();
+            int32_t muted = 0;
+            const int32_t hr = in.ok() ? AswGetMute(m_context, device, &muted) : ASW_E_INVALIDARG;
+            w.i32(hr);
+            if (hr >= 0)
+                w.u8(static_cast<uint8_t>(muted));
+            break;
+        }
+
+        case MessageType::SetMute:
+        {
+            const AswDevice device = in.u32();
+            const int32_t muted = in.u8();
+            w.i32(in.ok() ? AswSetMute(m_context, device, muted) : ASW_E_INVALIDARG);
+            break;
+        }
+
+        case MessageType::GetVolume:
+        {
+            const AswDevice device = in.u32();
+            float volume = 0.0f;
+            const int32_t hr = in.ok() ? AswGetVolume(m_context, device, &volume) : ASW_E_INVALIDARG;
+            w.i32(hr);
+            if (hr >= 0)
+                w.f32(volume);
+            break;
+        }
+
+        case MessageType::SetVolume:
+        {
+            const AswDevice device = in.u32();
+            const float volume = in.f32();
+            w.i32(in.ok() ? AswSetVolume(m_context, device, volume) : ASW_E_INVALIDARG);
+            break;
+        }
+
+        case MessageType::FindDevice:
+        {
+            const std::string id = in.str();
+            AswDevice device = 0;
+            const int32_t hr = in.ok() ? AswFindDevice(m_context, id.c_str(), &device) : ASW_E_INVALIDARG;
+            w.i32(hr);
+            if (hr >= 0)
+                w.u32(device);
+            break;
+        }
+
+        case MessageType::Subscribe:
+        {
+            const uint8_t enable = in.u8();
+            if (in.ok())
+                connection.subscribed.store(enable != 0, std::memory_order_relaxed);
+            w.i32(in.ok() ? ASW_OK : ASW_E_INVALIDARG);
+            break;
+        }
+
+        default:
+            w.i32(static_cast<int32_t>(E_NOTIMPL));
+            break;
+        }
+
+        w.finish();
+    }
+
+    /**
+     * @brief Joins the threads of finished connections (or of all, after closing them).
+     *
+     * Threads are joined outside the lock: a reader may be inside onEvent(), which takes it.
+     */
+    void AudioService::reap(bool all)
+    {
+        std::vector<std::shared_ptr<Connection>> done;
+        {
+            std::lock_guard<std::mutex> lock(m_connectionsMutex);
+            for (auto it = m_connections.begin(); it != m_connections.end();)
+            {
+                if (all || (*it)->finished.load(std::memory_order_acquire))
+                {
+                    done.push_back(std::move(*it));
+                    it = m_connections.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        for (const std::shared_ptr<Connection> &connection : done)
+        {
+            connection->close();
+            if (connection->reader.joinable())
+                connection->reader.join();
+            if (connection->writer.joinable())
+                connection->writer.join();
+        }
+    }
+
+    /**
+     * @brief Context callback: queues an Event frame to every subscribed connection.
+     */
+    void AudioService::onEvent(const AswEvent *event, void *user)
+    {
+        AudioService *service = static_cast<AudioService *>(user);
+
+        std::vector<uint8_t> frame;
+        FrameWriter w(frame, static_cast<uint8_t>(MessageType::Event), 0);
+        w.u8(static_cast<uint8_t>(event->type))
+            .u32(event->device)
+            .u8(static_cast<uint8_t>(event->flow))
+            .u8(static_cast<uint8_t>(event->role))
+            .u32(event->state)
+            .f32(event->volume)
+            .u8(static_cast<uint8_t>(event->muted));
+        w.finish();
+
+        std::lock_guard<std::mutex> lock(service->m_connectionsMutex);
+        for (const std::shared_ptr<Connection> &connection : service->m_connections)
+        {
+            if (connection->subscribed.load(std::memory_order_relaxed) && connection->enqueue(frame.data(), frame.size()))
+                service->m_events.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
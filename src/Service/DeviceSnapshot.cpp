@@ -0,0 +1,391 @@
+#include "Service/DeviceSnapshot.h"
+#include "SharedSegment.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace Service
+{
+    namespace
+    {
+        constexpr uint32_t kMagic = 0x53535741; // "AWSS"
+        constexpr uint16_t kVersion = 1;
+        constexpr int kReadAttempts = 1 << 16;
+        constexpr int kSpinsBeforeYield = 64;
+
+        /**
+         * @brief Segment layout. The header is one cache line so the sequence
+         *        does not share a line with the first devices.
+         */
+        struct SegmentHeader
+        {
+            uint32_t magic;
+            uint16_t version;
+            uint16_t headerSize;
+            uint32_t segmentSize;
+            std::atomic<uint32_t> live;     ///< 0 once the publisher closed the segment
+            std::atomic<uint32_t> sequence; ///< Odd while a publish is in progress; generation = sequence / 2
+            uint8_t reserved[44];
+        };
+
+        struct Segment
+        {
+            SegmentHeader header;
+            DeviceSnapshot snapshot;
+        };
+
+        static_assert(sizeof(SegmentHeader) == 64, "snapshot header must stay one cache line");
+        static_assert(std::atomic<uint32_t>::is_always_lock_free, "seqlock needs address-free atomics");
+
+        constexpr size_t kDevicesOffset = offsetof(DeviceSnapshot, devices);
+
+        size_t CopySize(uint32_t deviceCount)
+        {
+            return kDevicesOffset + std::min(deviceCount, kSnapshotMaxDevices) * sizeof(SnapshotDevice);
+        }
+
+        Segment *AsSegment(const SharedSegment &segment)
+        {
+            return reinterpret_cast<Segment *>(segment.data());
+        }
+
+        /**
+         * @brief Copies a context string into a fixed field, truncating at a UTF-8 character boundary.
+         */
+        template <typename Get>
+        void CopyString(AswContext *context, AswDevice device, std::vector<char> &scratch, char *field, size_t capacity, Get get)
+        {
+            uint32_t size = 0;
+            field[0] = '\0';
+            if (get(context, device, field, static_cast<uint32_t>(capacity), &size) != ASW_E_INSUFFICIENT_BUFFER)
+                return;
+
+            scratch.resize(size);
+            if (get(context, device, scratch.data(), size, &size) != ASW_OK)
+                return;
+            size_t length = capacity - 1;
+            while (length > 0 && (static_cast<unsigned char>(scratch[length]) & 0xC0) == 0x80)
+                --length; // Do not cut a multi-byte sequence
+            std::memcpy(field, scratch.data(), length);
+            field[length] = '\0';
+        }
+
+        inline void Pause(int attempt)
+        {
+            if (attempt % kSpinsBeforeYield == kSpinsBeforeYield - 1)
+                std::this_thread::yield();
+        }
+    }
+
+    std::string DefaultSnapshotName()
+    {
+        return "AudioSwitcherSnapshot";
+    }
+
+    // ------------------------------------------------------------------------
+    // SnapshotPublisher
+    // ------------------------------------------------------------------------
+
+    SnapshotPublisher::SnapshotPublisher()
+        : m_segment(new SharedSegment()), m_scratch(new DeviceSnapshot()), m_infos(kSnapshotMaxDevices)
+    {
+    }
+
+    SnapshotPublisher::~SnapshotPublisher()
+    {
+        close();
+    }
+
+    /**
+     * @brief Creates the segment and writes its header.
+     *
+     * A segment left behind by a publisher that crashed is reused: its sequence
+     * is kept (made even) so readers still mapping it see generations continue.
+     */
+    bool SnapshotPublisher::open(const std::string &name)
+    {
+        close();
+        if (!m_segment->create(name, sizeof(Segment)))
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_publishMutex);
+        SegmentHeader &header = AsSegment(*m_segment)->header;
+        const uint32_t sequence = header.sequence.load(std::memory_order_relaxed);
+        header.sequence.store((sequence + 1) & ~1u, std::memory_order_relaxed);
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.headerSize = sizeof(SegmentHeader);
+        header.segmentSize = sizeof(Segment);
+        header.live.store(1, std::memory_order_release);
+        return true;
+    }
+
+    void SnapshotPublisher::close()
+    {
+        stop();
+        if (!m_segment->isOpen())
+            return;
+
+        std::lock_guard<std::mutex> lock(m_publishMutex);
+        AsSegment(*m_segment)->header.live.store(0, std::memory_order_release);
+        m_segment->close();
+    }
+
+    bool SnapshotPublisher::isOpen() const
+    {
+        return m_segment->isOpen();
+    }
+
+    /**
+     * @brief Seqlock write: sequence odd, copy, sequence even.
+     *
+     * Only the header fields and the used device entries are copied.
+     */
+    void SnapshotPublisher::publish(const DeviceSnapshot &snapshot)
+    {
+        std::lock_guard<std::mutex> lock(m_publishMutex);
+        if (!m_segment->isOpen())
+            return;
+
+        Segment *segment = AsSegment(*m_segment);
+        const uint32_t sequence = segment->header.sequence.load(std::memory_order_relaxed);
+        segment->header.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(&segment->snapshot, &snapshot, CopySize(snapshot.deviceCount));
+        segment->snapshot.deviceCount = std::min(snapshot.deviceCount, kSnapshotMaxDevices);
+        segment->snapshot.generation = (sequence + 2) / 2;
+        segment->snapshot.publishedUnixNs =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+        segment->header.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    uint64_t SnapshotPublisher::generation() const
+    {
+        if (!m_segment->isOpen())
+            return 0;
+        return AsSegment(*m_segment)->header.sequence.load(std::memory_order_acquire) / 2;
+    }
+
+    bool SnapshotPublisher::start()
+    {
+        if (!m_segment->isOpen() || m_context)
+            return m_context != nullptr;
+        if (AswCreateContext(&m_context) != ASW_OK)
+        {
+            m_context = nullptr;
+            return false;
+        }
+
+        capture(*m_scratch);
+        publish(*m_scratch);
+
+        m_stopping = false;
+        m_dirty = false;
+        AswSetEventCallback(m_context, &SnapshotPublisher::onEvent, this);
+        m_worker = std::thread(&SnapshotPublisher::followLoop, this);
+        return true;
+    }
+
+    void SnapshotPublisher::stop()
+    {
+        if (!m_context)
+            return;
+
+        AswSetEventCallback(m_context, nullptr, nullptr);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        if (m_worker.joinable())
+            m_worker.join();
+
+        AswDestroyContext(m_context);
+        m_context = nullptr;
+    }
+
+    /**
+     * @brief Worker: republishes after notifications, coalescing bursts.
+     *
+     * Publishing happens here rather than in the callback because reading mute
+     * and volume calls the backend, which Core Audio notification threads must not.
+     */
+    void SnapshotPublisher::followLoop()
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this]
+                            { return m_stopping || m_dirty; });
+                if (m_stopping)
+                    return;
+                m_dirty = false;
+            }
+            capture(*m_scratch);
+            publish(*m_scratch);
+        }
+    }
+
+    /**
+     * @brief Reads the device table, defaults, mute and volume through the context.
+     */
+    void SnapshotPublisher::capture(DeviceSnapshot &snapshot)
+    {
+        uint32_t count = 0;
+        AswEnumerateDevices(m_context, ASW_FLOW_ALL, m_infos.data(), kSnapshotMaxDevices, &count);
+        count = std::min(count, kSnapshotMaxDevices);
+
+        snapshot.deviceCount = count;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const AswDeviceInfo &info = m_infos[i];
+            SnapshotDevice &device = snapshot.devices[i];
+            device.handle = info.device;
+            device.flow = static_cast<uint8_t>(info.flow);
+            device.defaultRoles = static_cast<uint8_t>(info.defaultRoles);
+            device.state = info.state;
+            device.reserved = 0;
+            CopyString(m_context, info.device, m_text, device.id, kSnapshotIdSize, AswGetDeviceId);
+            CopyString(m_context, info.device, m_text, device.name, kSnapshotNameSize, AswGetDeviceName);
+
+            int32_t muted = 0;
+            float volume = 0.0f;
+            AswGetMute(m_context, info.device, &muted);
+            AswGetVolume(m_context, info.device, &volume);
+            device.muted = muted ? 1 : 0;
+            device.volume = volume;
+        }
+
+        for (int32_t flow = 0; flow < 2; ++flow)
+            for (int32_t role = 0; role < 3; ++role)
+            {
+                AswDevice device = 0;
+                AswGetDefaultDevice(m_context, flow, role, &device);
+                snapshot.defaults[flow][role] = device;
+            }
+    }
+
+    void SnapshotPublisher::onEvent(const AswEvent *, void *user)
+    {
+        SnapshotPublisher *publisher = static_cast<SnapshotPublisher *>(user);
+        {
+            std::lock_guard<std::mutex> lock(publisher->m_mutex);
+            publisher->m_dirty = true;
+        }
+        publisher->m_wake.notify_one();
+    }
+
+    // ------------------------------------------------------------------------
+    // SnapshotReader
+    // ------------------------------------------------------------------------
+
+    SnapshotReader::SnapshotReader() : m_segment(new SharedSegment()) {}
+
+    SnapshotReader::~SnapshotReader() = default;
+
+    bool SnapshotReader::open(const std::string &name)
+    {
+        if (!m_segment->open(name, sizeof(Segment)))
+            return false;
+
+        const SegmentHeader &header = AsSegment(*m_segment)->header;
+        if (header.magic != kMagic || header.version != kVersion || header.headerSize != sizeof(SegmentHeader) ||
+            header.segmentSize != sizeof(Segment))
+        {
+            m_segment->close();
+            return false;
+        }
+        return true;
+    }
+
+    void SnapshotReader::close()
+    {
+        m_segment->close();
+    }
+
+    bool SnapshotReader::isOpen() const
+    {
+        return m_segment->isOpen();
+    }
+
+    uint64_t SnapshotReader::generation() const
+    {
+        if (!m_segment->isOpen())
+            return 0;
+        const SegmentHeader &header = AsSegment(*m_segment)->header;
+        if (!header.live.load(std::memory_order_acquire))
+            return 0;
+        return header.sequence.load(std::memory_order_acquire) / 2;
+    }
+
+    /**
+     * @brief Seqlock read: retries while a publish is in progress or completed during the copy.
+     */
+    bool SnapshotReader::read(DeviceSnapshot &snapshot) const
+    {
+        if (!m_segment->isOpen())
+            return false;
+
+        const Segment *segment = AsSegment(*m_segment);
+        for (int attempt = 0; attempt < kReadAttempts; ++attempt)
+        {
+            const uint32_t before = segment->header.sequence.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                Pause(attempt);
+                continue;
+            }
+            if (before == 0 || !segment->header.live.load(std::memory_order_relaxed))
+                return false;
+
+            // The count may be torn; CopySize() clamps it and the sequence check rejects the copy
+            std::memcpy(&snapshot, &segment->snapshot, CopySize(segment->snapshot.deviceCount));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (segment->header.sequence.load(std::memory_order_relaxed) == before)
+                return true;
+            Pause(attempt);
+        }
+        return false;
+    }
+
+    bool SnapshotReader::readDefault(int32_t flow, int32_t role, SnapshotDevice &device) const
+    {
+        if (!m_segment->isOpen() || flow < 0 || flow > 1 || role < 0 || role > 2)
+            return false;
+
+        const Segment *segment = AsSegment(*m_segment);
+        for (int attempt = 0; attempt < kReadAttempts; ++attempt)
+        {
+            const uint32_t before = segment->header.sequence.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                Pause(attempt);
+                continue;
+            }
+            if (before == 0 || !segment->header.live.load(std::memory_order_relaxed))
+                return false;
+
+            const AswDevice handle = segment->snapshot.defaults[flow][role];
+            const uint32_t count = std::min(segment->snapshot.deviceCount, kSnapshotMaxDevices);
+            bool found = false;
+            for (uint32_t i = 0; i < count && handle != 0; ++i)
+            {
+                if (segment->snapshot.devices[i].handle == handle)
+                {
+                    std::memcpy(&device, &segment->snapshot.devices[i], sizeof(SnapshotDevice));
+                    found = true;
+                    break;
+                }
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (segment->header.sequence.load(std::memory_order_relaxed) == before)
+                return found;
+            Pause(attempt);
+        }
+        return false;
+    }
+}
@@ -0,0 +1,328 @@
+#include "LocalSocket.h"
+
+#include <cstring>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace Service
+{
+    namespace
+    {
+#if defined(_WIN32)
+        constexpr DWORD kPipeBufferSize = 64 * 1024;
+        constexpr DWORD kConnectWaitMs = 2000;
+
+        /**
+         * @brief Runs one overlapped read or write to completion, or until `shutdown` is signalled.
+         *
+         * @return Bytes transferred; 0 on failure or shutdown.
+         */
+        DWORD Transfer(HANDLE pipe, HANDLE event, HANDLE shutdown, bool write, void *data, DWORD size)
+        {
+            OVERLAPPED overlapped = {};
+            overlapped.hEvent = event;
+            DWORD done = 0;
+            const BOOL ok = write ? WriteFile(pipe, data, size, &done, &overlapped)
+                                  : ReadFile(pipe, data, size, &done, &overlapped);
+            if (!ok && GetLastError() != ERROR_IO_PENDING)
+                return 0;
+
+            const HANDLE waits[2] = {event, shutdown};
+            if (WaitForMultipleObjects(2, waits, FALSE, INFINITE) != WAIT_OBJECT_0)
+            {
+                CancelIoEx(pipe, &overlapped);
+                GetOverlappedResult(pipe, &overlapped, &done, TRUE);
+                return 0;
+            }
+            if (!GetOverlappedResult(pipe, &overlapped, &done, FALSE))
+                return 0;
+            return done;
+        }
+#else
+        bool MakeAddress(const std::string &endpoint, sockaddr_un &address)
+        {
+            std::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            if (endpoint.empty() || endpoint.size() >= sizeof(address.sun_path))
+                return false;
+            std::memcpy(address.sun_path, endpoint.c_str(), endpoint.size() + 1);
+            return true;
+        }
+
+        /**
+         * @brief Tries to connect to an endpoint.
+         *
+         * @return 0 if something accepted the connection, otherwise the connect() errno.
+         */
+        int Probe(const sockaddr_un &address)
+        {
+            const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd < 0)
+                return errno;
+            const int error = ::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0 ? 0 : errno;
+            ::close(fd);
+            return error;
+        }
+#endif
+    }
+
+    LocalConnection::~LocalConnection()
+    {
+#if defined(_WIN32)
+        if (m_pipe)
+            CloseHandle(m_pipe);
+        for (void *event : {m_readEvent, m_writeEvent, m_shutdownEvent})
+            if (event)
+                CloseHandle(event);
+#else
+        if (m_fd >= 0)
+            ::close(m_fd);
+#endif
+    }
+
+    std::unique_ptr<LocalConnection> LocalConnection::connect(const std::string &endpoint)
+    {
+        std::unique_ptr<LocalConnection> connection(new LocalConnection());
+#if defined(_WIN32)
+        HANDLE pipe = INVALID_HANDLE_VALUE;
+        for (int attempt = 0; attempt < 2 && pipe == INVALID_HANDLE_VALUE; ++attempt)
+        {
+            pipe = CreateFileA(endpoint.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+                               FILE_FLAG_OVERLAPPED, nullptr);
+            if (pipe == INVALID_HANDLE_VALUE && (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeA(endpoint.c_str(), kConnectWaitMs)))
+                return nullptr;
+        }
+        if (pipe == INVALID_HANDLE_VALUE)
+            return nullptr;
+        connection->m_pipe = pipe;
+        connection->m_readEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        connection->m_writeEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        connection->m_shutdownEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!connection->m_readEvent || !connection->m_writeEvent || !connection->m_shutdownEvent)
+            return nullptr;
+#else
+        sockaddr_un address;
+        if (!MakeAddress(endpoint, address))
+            return nullptr;
+        connection->m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connection->m_fd < 0 ||
+            ::connect(connection->m_fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+            return nullptr;
+#endif
+        return connection;
+    }
+
+    bool LocalConnection::readAll(void *data, size_t size)
+    {
+        uint8_t *p = static_cast<uint8_t *>(data);
+        while (size > 0)
+        {
+            if (m_shutdown.load(std::memory_order_relaxed))
+                return false;
+#if defined(_WIN32)
+            const DWORD n = Transfer(m_pipe, m_readEvent, m_shutdownEvent, false, p,
+                                     static_cast<DWORD>(size < kPipeBufferSize ? size : kPipeBufferSize));
+            if (n == 0)
+                return false;
+#else
+            const ssize_t n = ::recv(m_fd, p, size, 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+#endif
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool LocalConnection::writeAll(const void *data, size_t size)
+    {
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        while (size > 0)
+        {
+            if (m_shutdown.load(std::memory_order_relaxed))
+                return false;
+#if defined(_WIN32)
+            const DWORD n = Transfer(m_pipe, m_writeEvent, m_shutdownEvent, true, const_cast<uint8_t *>(p),
+                                     static_cast<DWORD>(size < kPipeBufferSize ? size : kPipeBufferSize));
+            if (n == 0)
+                return false;
+#else
+#if defined(MSG_NOSIGNAL)
+            const ssize_t n = ::send(m_fd, p, size, MSG_NOSIGNAL);
+#else
+            const ssize_t n = ::send(m_fd, p, size, 0);
+#endif
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+#endif
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    void LocalConnection::shutdown()
+    {
+        m_shutdown.store(true, std::memory_order_relaxed);
+#if defined(_WIN32)
+        if (m_shutdownEvent)
+            SetEvent(m_shutdownEvent);
+#else
+        if (m_fd >= 0)
+            ::shutdown(m_fd, SHUT_RDWR);
+#endif
+    }
+
+    LocalListener::~LocalListener()
+    {
+        close();
+#if defined(_WIN32)
+        if (m_stopEvent)
+            CloseHandle(m_stopEvent);
+#else
+        if (m_fd >= 0)
+            ::close(m_fd);
+#endif
+    }
+
+    ListenStatus LocalListener::listen(const std::string &endpoint)
+    {
+        m_endpoint = endpoint;
+        m_closed.store(false, std::memory_order_relaxed);
+#if defined(_WIN32)
+        if (endpoint.empty())
+            return ListenStatus::Failed;
+        // Any pipe instance under the name, busy or idle, belongs to a running server
+        if (WaitNamedPipeA(endpoint.c_str(), 1) || GetLastError() != ERROR_FILE_NOT_FOUND)
+            return ListenStatus::AlreadyRunning;
+        if (!m_stopEvent)
+            m_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        else
+            ResetEvent(m_stopEvent);
+        return m_stopEvent != nullptr ? ListenStatus::Listening : ListenStatus::Failed;
+#else
+        sockaddr_un address;
+        if (!MakeAddress(endpoint, address))
+            return ListenStatus::Failed;
+
+        const int probe = Probe(address);
+        if (probe == 0)
+            return ListenStatus::AlreadyRunning;
+        if (probe == ECONNREFUSED)
+            ::unlink(endpoint.c_str()); // Left behind by an instance that did not shut down
+        else if (probe != ENOENT)
+            return ListenStatus::Failed;
+
+        m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_fd < 0)
+            return ListenStatus::Failed;
+        if (::bind(m_fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || ::listen(m_fd, SOMAXCONN) != 0)
+        {
+            // EADDRINUSE: another instance bound the path since the probe
+            const ListenStatus status = errno == EADDRINUSE ? ListenStatus::AlreadyRunning : ListenStatus::Failed;
+            ::close(m_fd);
+            m_fd = -1;
+            return status;
+        }
+        return ListenStatus::Listening;
+#endif
+    }
+
+    /**
+     * @brief Accepts one client.
+     *
+     * On Windows every client gets its own pipe instance, created here and
+     * connected with an overlapped ConnectNamedPipe() so close() can interrupt it.
+     */
+    std::unique_ptr<LocalConnection> LocalListener::accept()
+    {
+#if defined(_WIN32)
+        while (!m_closed.load(std::memory_order_relaxed))
+        {
+            HANDLE pipe = CreateNamedPipeA(m_endpoint.c_str(), PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED,
+                                           PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                           PIPE_UNLIMITED_INSTANCES, kPipeBufferSize, kPipeBufferSize, 0, nullptr);
+            if (pipe == INVALID_HANDLE_VALUE)
+                return nullptr;
+
+            HANDLE connected = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            OVERLAPPED overlapped = {};
+            overlapped.hEvent = connected;
+            bool ok = ConnectNamedPipe(pipe, &overlapped) != FALSE;
+            const DWORD error = ok ? ERROR_SUCCESS : GetLastError();
+            if (error == ERROR_PIPE_CONNECTED)
+                ok = true;
+            else if (error == ERROR_IO_PENDING)
+            {
+                const HANDLE waits[2] = {connected, m_stopEvent};
+                DWORD ignored = 0;
+                if (WaitForMultipleObjects(2, waits, FALSE, INFINITE) == WAIT_OBJECT_0)
+                    ok = GetOverlappedResult(pipe, &overlapped, &ignored, FALSE) != FALSE;
+                else
+                {
+                    CancelIoEx(pipe, &overlapped);
+                    GetOverlappedResult(pipe, &overlapped, &ignored, TRUE);
+                }
+            }
+            CloseHandle(connected);
+
+            if (!ok)
+            {
+                CloseHandle(pipe);
+                continue;
+            }
+
+            std::unique_ptr<LocalConnection> connection(new LocalConnection());
+            connection->m_pipe = pipe;
+            connection->m_readEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            connection->m_writeEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            connection->m_shutdownEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            if (connection->m_readEvent && connection->m_writeEvent && connection->m_shutdownEvent)
+                return connection;
+        }
+        return nullptr;
+#else
+        while (!m_closed.load(std::memory_order_relaxed))
+        {
+            const int fd = ::accept(m_fd, nullptr, nullptr);
+            if (fd >= 0)
+            {
+                std::unique_ptr<LocalConnection> connection(new LocalConnection());
+                connection->m_fd = fd;
+                return connection;
+            }
+            if (errno != EINTR && errno != ECONNABORTED)
+                return nullptr;
+        }
+        return nullptr;
+#endif
+    }
+
+    void LocalListener::close()
+    {
+        if (m_closed.exchange(true))
+            return;
+#if defined(_WIN32)
+        if (m_stopEvent)
+            SetEvent(m_stopEvent);
+#else
+        if (m_fd >= 0)
+        {
+            ::shutdown(m_fd, SHUT_RDWR);
+            ::unlink(m_endpoint.c_str());
+        }
+#endif
+    }
+}
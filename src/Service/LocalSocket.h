@@ -0,0 +1,107 @@
+#pragma once
+
+// Internal header: local stream transport of the service. Not part of the public API.
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace Service
+{
+    /**
+     * @brief Connected full-duplex byte stream (Unix domain socket or named pipe).
+     *
+     * One thread may read while another writes.
+     */
+    class LocalConnection
+    {
+    public:
+        ~LocalConnection();
+
+        // Owns an OS handle: not copyable
+        LocalConnection(const LocalConnection &) = delete;
+        LocalConnection &operator=(const LocalConnection &) = delete;
+
+        /**
+         * @brief Connects to a listening endpoint.
+         *
+         * @return nullptr if nothing listens there.
+         */
+        static std::unique_ptr<LocalConnection> connect(const std::string &endpoint);
+
+        /// Reads exactly `size` bytes; false on end of stream, error or shutdown().
+        bool readAll(void *data, size_t size);
+
+        /// Writes all bytes; false on error or shutdown().
+        bool writeAll(const void *data, size_t size);
+
+        /**
+         * @brief Ends the stream in both directions and wakes a blocked readAll().
+         */
+        void shutdown();
+
+    private:
+        friend class LocalListener;
+        LocalConnection() = default;
+
+#if defined(_WIN32)
+        void *m_pipe = nullptr;
+        void *m_readEvent = nullptr;
+        void *m_writeEvent = nullptr;
+        void *m_shutdownEvent = nullptr;
+#else
+        int m_fd = -1;
+#endif
+        std::atomic<bool> m_shutdown{false};
+    };
+
+    enum class ListenStatus
+    {
+        Listening,
+        AlreadyRunning, ///< Another process accepts connections on the endpoint
+        Failed
+    };
+
+    /**
+     * @brief Listening endpoint.
+     */
+    class LocalListener
+    {
+    public:
+        LocalListener() = default;
+        ~LocalListener();
+
+        // Owns an OS handle: not copyable
+        LocalListener(const LocalListener &) = delete;
+        LocalListener &operator=(const LocalListener &) = delete;
+
+        /**
+         * @brief Starts listening unless another process already serves the endpoint.
+         *
+         * The endpoint is probed with a connection first. A Unix socket file that
+         * refuses it (left behind by a crashed instance) is replaced; one that accepts
+         * it gives AlreadyRunning and is left alone.
+         */
+        ListenStatus listen(const std::string &endpoint);
+
+        /**
+         * @brief Waits for the next client; nullptr once close() was called.
+         */
+        std::unique_ptr<LocalConnection> accept();
+
+        /**
+         * @brief Stops listening and wakes a blocked accept().
+         */
+        void close();
+
+    private:
+        std::string m_endpoint;
+        std::atomic<bool> m_closed{false};
+#if defined(_WIN32)
+        void *m_stopEvent = nullptr;
+#else
+        int m_fd = -1;
+#endif
+    };
+}
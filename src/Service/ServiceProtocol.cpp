@@ -0,0 +1,122 @@
+#include "Service/ServiceProtocol.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+namespace Service
+{
+    FrameWriter::FrameWriter(std::vector<uint8_t> &out, uint8_t type, uint32_t requestId)
+        : m_out(out), m_start(out.size())
+    {
+        u32(0); // Length, patched by finish()
+        u8(type);
+        u32(requestId);
+    }
+
+    FrameWriter &FrameWriter::u8(uint8_t value)
+    {
+        m_out.push_back(value);
+        return *this;
+    }
+
+    FrameWriter &FrameWriter::u32(uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            m_out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        return *this;
+    }
+
+    FrameWriter &FrameWriter::f32(float value)
+    {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return u32(bits);
+    }
+
+    /**
+     * @brief Writes a u16 length and the bytes (truncated to 65535).
+     */
+    FrameWriter &FrameWriter::str(const std::string &value)
+    {
+        const size_t length = value.size() < 0xffff ? value.size() : 0xffff;
+        m_out.push_back(static_cast<uint8_t>(length));
+        m_out.push_back(static_cast<uint8_t>(length >> 8));
+        m_out.insert(m_out.end(), value.begin(), value.begin() + static_cast<std::ptrdiff_t>(length));
+        return *this;
+    }
+
+    FrameWriter &FrameWriter::bytes(const uint8_t *data, size_t size)
+    {
+        m_out.insert(m_out.end(), data, data + size);
+        return *this;
+    }
+
+    void FrameWriter::finish()
+    {
+        if (!m_framed)
+            return;
+        const uint32_t length = static_cast<uint32_t>(m_out.size() - m_start - 4);
+        for (int i = 0; i < 4; ++i)
+            m_out[m_start + static_cast<size_t>(i)] = static_cast<uint8_t>(length >> (8 * i));
+    }
+
+    bool FrameReader::need(size_t bytes)
+    {
+        if (m_ok && remaining() >= bytes)
+            return true;
+        m_ok = false;
+        return false;
+    }
+
+    uint8_t FrameReader::u8()
+    {
+        return need(1) ? *m_p++ : 0;
+    }
+
+    uint32_t FrameReader::u32()
+    {
+        if (!need(4))
+            return 0;
+        const uint32_t value = static_cast<uint32_t>(m_p[0]) | (static_cast<uint32_t>(m_p[1]) << 8) |
+                               (static_cast<uint32_t>(m_p[2]) << 16) | (static_cast<uint32_t>(m_p[3]) << 24);
+        m_p += 4;
+        return value;
+    }
+
+    float FrameReader::f32()
+    {
+        const uint32_t bits = u32();
+        float value = 0.0f;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string FrameReader::str()
+    {
+        if (!need(2))
+            return std::string();
+        const size_t length = static_cast<size_t>(m_p[0]) | (static_cast<size_t>(m_p[1]) << 8);
+        m_p += 2;
+        if (!need(length))
+            return std::string();
+        std::string value(reinterpret_cast<const char *>(m_p), length);
+        m_p += length;
+        return value;
+    }
+
+    std::string DefaultServiceEndpoint()
+    {
+#if defined(_WIN32)
+        return "\\\\.\\pipe\\AudioSwitcher";
+#else
+        if (const char *runtime = std::getenv("XDG_RUNTIME_DIR"))
+            if (*runtime)
+                return std::string(runtime) + "/audioswitcher.sock";
+        return "/tmp/audioswitcher-" + std::to_string(static_cast<unsigned long>(getuid())) + ".sock";
+#endif
+    }
+}
@@ -0,0 +1,136 @@
+#include "SharedSegment.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Service
+{
+    namespace
+    {
+#if defined(_WIN32)
+        std::string SystemName(const std::string &name)
+        {
+            return "Local\\" + name; // Session namespace: no privilege needed
+        }
+#else
+        std::string SystemName(const std::string &name)
+        {
+            return "/" + name;
+        }
+#endif
+    }
+
+    SharedSegment::~SharedSegment()
+    {
+        close();
+    }
+
+    bool SharedSegment::create(const std::string &name, size_t size)
+    {
+        close();
+        if (name.empty() || size == 0)
+            return false;
+
+#if defined(_WIN32)
+        const uint64_t size64 = size;
+        HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                            static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64),
+                                            SystemName(name).c_str());
+        if (!mapping)
+            return false;
+        void *view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (!view)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+        m_mapping = mapping;
+#else
+        const std::string systemName = SystemName(name);
+        const int fd = shm_open(systemName.c_str(), O_RDWR | O_CREAT, 0600);
+        if (fd < 0)
+            return false;
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void *view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd); // The mapping keeps the object alive
+        if (view == MAP_FAILED)
+            return false;
+#endif
+
+        m_data = static_cast<uint8_t *>(view);
+        m_size = size;
+        m_owner = true;
+        m_name = name;
+        return true;
+    }
+
+    bool SharedSegment::open(const std::string &name, size_t size)
+    {
+        close();
+        if (name.empty() || size == 0)
+            return false;
+
+#if defined(_WIN32)
+        HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, SystemName(name).c_str());
+        if (!mapping)
+            return false;
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+        if (!view)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+        m_mapping = mapping;
+#else
+        const int fd = shm_open(SystemName(name).c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+        struct stat info = {};
+        if (fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < size)
+        {
+            ::close(fd);
+            return false;
+        }
+        void *view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+            return false;
+#endif
+
+        m_data = static_cast<uint8_t *>(view);
+        m_size = size;
+        m_owner = false;
+        m_name = name;
+        return true;
+    }
+
+    void SharedSegment::close()
+    {
+        if (!m_data)
+            return;
+
+#if defined(_WIN32)
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+#else
+        munmap(m_data, m_size);
+        if (m_owner)
+            shm_unlink(SystemName(m_name).c_str());
+#endif
+        m_data = nullptr;
+        m_size = 0;
+        m_owner = false;
+        m_name.clear();
+    }
+}
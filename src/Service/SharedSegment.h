@@ -0,0 +1,49 @@
+#pragma once
+
+// Internal header: named shared-memory segment of the snapshot publisher. Not part of the public API.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Service
+{
+    /**
+     * @brief Named shared-memory mapping (POSIX shm object or Win32 file mapping).
+     */
+    class SharedSegment
+    {
+    public:
+        SharedSegment() = default;
+        ~SharedSegment();
+
+        // Owns a mapping: not copyable
+        SharedSegment(const SharedSegment &) = delete;
+        SharedSegment &operator=(const SharedSegment &) = delete;
+
+        /**
+         * @brief Creates the segment (or reuses one left by a previous owner) and maps it read/write.
+         *
+         * A new segment is zero-filled. close() removes the name again.
+         */
+        bool create(const std::string &name, size_t size);
+
+        /**
+         * @brief Maps an existing segment read-only; fails if it is smaller than `size`.
+         */
+        bool open(const std::string &name, size_t size);
+
+        void close();
+
+        bool isOpen() const { return m_data != nullptr; }
+        uint8_t *data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        uint8_t *m_data = nullptr;
+        size_t m_size = 0;
+        bool m_owner = false;
+        std::string m_name;
+        void *m_mapping = nullptr; ///< Win32 file-mapping handle (unused on POSIX)
+    };
+}
@@ -0,0 +1,141 @@
+#include "Streaming/AutoMuteController.h"
+#include "Dsp/SampleFormat.h"
+#include "Utility/DeviceUtils.h"
+#include "Utility/SafeRelease.h"
+
+namespace Streaming
+{
+    /**
+     * @brief Destructor - releases the endpoint.
+     */
+    AutoMuteController::~AutoMuteController()
+    {
+        close();
+    }
+
+    /**
+     * @brief Binds a source to an endpoint through Utility::MuteDevice.
+     *
+     * A source captured from the endpoint itself is refused: once muted it would only
+     * deliver silence and the endpoint would never be unmuted.
+     *
+     * @param source Sensing source.
+     * @param endpoint Endpoint to mute.
+     * @param config Detector tuning.
+     * @param maxFrames Read size.
+     * @return true on success.
+     */
+    bool AutoMuteController::open(IAudioSource *source, IMMDevice *endpoint,
+                                  const Dsp::VadConfig &config, size_t maxFrames)
+    {
+        if (!endpoint || !source)
+            return false;
+
+        const std::wstring sensed = source->endpointId();
+        if (!sensed.empty() && sensed == Utility::GetDeviceId(endpoint))
+            return false;
+
+        endpoint->AddRef();
+        if (!open(source, [endpoint](bool mute)
+                  { return Utility::MuteDevice(endpoint, mute); },
+                  config, maxFrames))
+        {
+            endpoint->Release();
+            return false;
+        }
+
+        m_endpoint = endpoint;
+        return true;
+    }
+
+    /**
+     * @brief Binds a source to a mute handler and applies the initial (muted) state.
+     *
+     * @param source Sensing source.
+     * @param handler Mute handler.
+     * @param config Detector tuning.
+     * @param maxFrames Read size.
+     * @return true on success.
+     */
+    bool AutoMuteController::open(IAudioSource *source, MuteHandler handler,
+                                  const Dsp::VadConfig &config, size_t maxFrames)
+    {
+        close();
+
+        if (!source || !handler || maxFrames == 0)
+            return false;
+
+        const Utility::DeviceFormatInfo &format = source->format();
+        if (!format.valid || !Dsp::IsConvertibleFormat(format))
+            return false;
+
+        if (!m_vad.configure(format.sampleRate, config, maxFrames))
+            return false;
+
+        m_source = source;
+        m_handler = std::move(handler);
+        m_maxFrames = maxFrames;
+        m_raw.assign(maxFrames * format.blockAlign, 0);
+        m_transitions = 0;
+        m_failures = 0;
+
+        apply(true);
+        return true;
+    }
+
+    /**
+     * @brief Detaches from the source and releases the endpoint reference.
+     */
+    void AutoMuteController::close()
+    {
+        Utility::SafeRelease(m_endpoint);
+        m_handler = nullptr;
+        m_source = nullptr;
+        m_muted = false;
+    }
+
+    /**
+     * @brief Drains the source through the detector and mutes/unmutes on transitions.
+     *
+     * @return size_t Frames analysed.
+     */
+    size_t AutoMuteController::pump()
+    {
+        if (!m_source)
+            return 0;
+
+        const Utility::DeviceFormatInfo &format = m_source->format();
+        size_t total = 0;
+
+        for (;;)
+        {
+            const size_t frames = m_source->read(m_raw.data(), m_maxFrames);
+            if (frames == 0)
+                break;
+
+            const bool active = m_vad.pushRaw(m_raw.data(), frames, format);
+            if (active == m_muted)
+                apply(!active);
+
+            total += frames;
+            if (frames < m_maxFrames)
+                break;
+        }
+
+        return total;
+    }
+
+    /**
+     * @brief Calls the handler and records the new state.
+     *
+     * The state is recorded even if the handler fails so a failing endpoint is not
+     * retried every period; the next transition tries again.
+     */
+    void AutoMuteController::apply(bool mute)
+    {
+        if (!m_handler(mute))
+            ++m_failures;
+        m_muted = mute;
+        ++m_transitions;
+    }
+}
@@ -0,0 +1,183 @@
+#include "Streaming/LatencyProbe.h"
+#include "Dsp/SampleFormat.h"
+#include "Dsp/TestSignal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace Streaming
+{
+    namespace
+    {
+        constexpr size_t kChunkFrames = 1024;
+    }
+
+    /**
+     * @brief Plays `signal` from an empty render buffer while capturing `captureFrames` frames.
+     *
+     * Nothing is written once the signal is out, so the render stream runs dry into
+     * silence and the next trial again starts from an empty buffer.
+     *
+     * @param render Render sink.
+     * @param capture Capture source.
+     * @param signal Mono signal (may be empty to just capture).
+     * @param captureFrames Frames to capture.
+     * @param keep Store the capture (mono) in m_recording.
+     * @return false on timeout.
+     */
+    bool LatencyProbe::run(IAudioSink &render, IAudioSource &capture, const std::vector<float> &signal,
+                           size_t captureFrames, bool keep)
+    {
+        const Utility::DeviceFormatInfo &out = render.format();
+        const Utility::DeviceFormatInfo &in = capture.format();
+        const double seconds = static_cast<double>(captureFrames) / in.sampleRate;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000.0) + 2000);
+
+        if (keep)
+            m_recording.clear();
+
+        size_t played = 0;
+        size_t captured = 0;
+        while (captured < captureFrames)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+
+            bool moved = false;
+
+            if (played < signal.size())
+            {
+                const size_t frames = std::min({render.writableFrames(), kChunkFrames, signal.size() - played});
+                if (frames > 0)
+                {
+                    for (size_t f = 0; f < frames; ++f)
+                        std::fill_n(m_floatOut.begin() + static_cast<std::ptrdiff_t>(f * out.channels), out.channels, signal[played + f]);
+                    Dsp::FromFloat(m_floatOut.data(), m_rawOut.data(), frames * out.channels, out);
+                    const size_t written = render.write(m_rawOut.data(), frames);
+                    played += written;
+                    moved = written > 0;
+                }
+            }
+
+            const size_t frames = capture.read(m_rawIn.data(), std::min(kChunkFrames, captureFrames - captured));
+            if (frames > 0)
+            {
+                if (keep)
+                {
+                    Dsp::ToFloat(m_rawIn.data(), m_floatIn.data(), frames * in.channels, in);
+                    const float inv = 1.0f / static_cast<float>(in.channels);
+                    for (size_t f = 0; f < frames; ++f)
+                    {
+                        float sum = 0.0f;
+                        for (uint32_t c = 0; c < in.channels; ++c)
+                            sum += m_floatIn[f * in.channels + c];
+                        m_recording.push_back(sum * inv);
+                    }
+                }
+                captured += frames;
+                moved = true;
+            }
+
+            if (!moved)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Runs every trial and summarises the successful ones.
+     *
+     * @param render Render sink.
+     * @param capture Capture source.
+     * @param config Parameters.
+     * @return LatencyReport Statistics over the trials.
+     */
+    LatencyReport LatencyProbe::measure(IAudioSink &render, IAudioSource &capture, const LatencyProbeConfig &config)
+    {
+        LatencyReport report;
+        report.renderTiming = render.timing();
+        report.captureTiming = capture.timing();
+
+        const Utility::DeviceFormatInfo &out = render.format();
+        const Utility::DeviceFormatInfo &in = capture.format();
+        if (!out.valid || !in.valid || !Dsp::IsConvertibleFormat(out) || !Dsp::IsConvertibleFormat(in) ||
+            out.sampleRate != in.sampleRate || config.trials == 0)
+            return report;
+
+        const uint32_t rate = in.sampleRate;
+        report.sampleRate = rate;
+
+        const std::vector<float> signal = config.signal == ProbeSignal::Chirp
+                                              ? Dsp::GenerateLogChirp(rate, config.chirpMs, 100.0f, 10000.0f, config.amplitude)
+                                              : Dsp::GenerateMls(config.mlsOrder, config.amplitude);
+        if (signal.empty())
+            return report;
+
+        m_floatOut.assign(kChunkFrames * out.channels, 0.0f);
+        m_rawOut.assign(kChunkFrames * out.blockAlign, 0);
+        m_floatIn.assign(kChunkFrames * in.channels, 0.0f);
+        m_rawIn.assign(kChunkFrames * in.blockAlign, 0);
+
+        const size_t captureFrames = signal.size() + static_cast<size_t>(rate) * config.maxLatencyMs / 1000;
+        m_recording.reserve(captureFrames);
+
+        // Let the render buffer run dry (at least one buffer) between trials
+        const size_t gapFrames = std::max(static_cast<size_t>(rate) * config.gapMs / 1000,
+                                          static_cast<size_t>(report.renderTiming.bufferFrames));
+        const std::vector<float> none;
+
+        float confidenceSum = 0.0f;
+        for (uint32_t trial = 0; trial < config.trials; ++trial)
+        {
+            // Drop anything captured before the trial
+            while (capture.read(m_rawIn.data(), kChunkFrames) > 0)
+            {
+            }
+
+            if (!run(render, capture, signal, captureFrames, true))
+            {
+                ++report.failedTrials;
+                continue;
+            }
+
+            const Dsp::CorrelationPeak peak = m_correlator.findDelay(signal.data(), signal.size(),
+                                                                     m_recording.data(), m_recording.size());
+            if (!peak.valid || peak.confidence < config.minConfidence)
+                ++report.failedTrials;
+            else
+            {
+                report.latencyMs.push_back(peak.lag * 1000.0 / rate);
+                confidenceSum += peak.confidence;
+            }
+
+            if (trial + 1 < config.trials)
+                run(render, capture, none, gapFrames, false);
+        }
+
+        if (report.latencyMs.empty())
+            return report;
+
+        std::vector<double> sorted = report.latencyMs;
+        std::sort(sorted.begin(), sorted.end());
+        const size_t count = sorted.size();
+
+        double sum = 0.0;
+        for (double v : sorted)
+            sum += v;
+        report.meanMs = sum / static_cast<double>(count);
+        report.medianMs = count % 2 ? sorted[count / 2] : 0.5 * (sorted[count / 2 - 1] + sorted[count / 2]);
+        report.minMs = sorted.front();
+        report.maxMs = sorted.back();
+
+        double variance = 0.0;
+        for (double v : sorted)
+            variance += (v - report.meanMs) * (v - report.meanMs);
+        report.jitterMs = std::sqrt(variance / static_cast<double>(count));
+        report.meanConfidence = confidenceSum / static_cast<float>(count);
+        report.valid = true;
+        return report;
+    }
+}
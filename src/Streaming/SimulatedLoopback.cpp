@@ -0,0 +1,177 @@
+#include "Streaming/SimulatedLoopback.h"
+#include "Dsp/ChannelLayout.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Streaming
+{
+    /**
+     * @brief Constructor - wires the sink and source views to this object.
+     */
+    SimulatedLoopback::SimulatedLoopback()
+        : m_sink(*this), m_source(*this)
+    {
+    }
+
+    /**
+     * @brief Allocates the rings and restarts the clock.
+     *
+     * @param config Loopback parameters.
+     * @return true on success.
+     */
+    bool SimulatedLoopback::open(const SimulatedLoopbackConfig &config)
+    {
+        if (config.sampleRate == 0 || config.channels == 0 || config.periodFrames == 0 ||
+            config.bufferFrames < config.periodFrames)
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_config = config;
+        m_format = Utility::DeviceFormatInfo();
+        m_format.sampleRate = config.sampleRate;
+        m_format.channels = config.channels;
+        m_format.bitDepth = 32;
+        m_format.blockAlign = static_cast<uint16_t>(config.channels * 4);
+        m_format.channelMask = Dsp::DefaultChannelMask(config.channels);
+        m_format.isFloat = true;
+        m_format.valid = true;
+
+        m_timing = StreamTiming();
+        m_timing.bufferFrames = config.bufferFrames;
+        m_timing.defaultPeriodFrames = config.periodFrames;
+        m_timing.minimumPeriodFrames = config.periodFrames;
+
+        const size_t ch = config.channels;
+        m_render.assign(config.bufferFrames * ch, 0.0f);
+        m_renderRead = 0;
+        m_renderCount = 0;
+        m_delay.assign((static_cast<size_t>(config.delayFrames) + 1) * ch, 0.0f);
+        m_delayPos = 0;
+        m_capture.assign(config.bufferFrames * ch, 0.0f);
+        m_captureRead = 0;
+        m_captureCount = 0;
+
+        m_rng.seed(config.seed);
+        m_noise = std::normal_distribution<float>(0.0f, config.noiseLevel);
+
+        m_start = std::chrono::steady_clock::now();
+        m_periodsDone = 0;
+        return true;
+    }
+
+    /**
+     * @brief Runs every engine period that has elapsed since the last call. Caller holds the lock.
+     */
+    void SimulatedLoopback::advance()
+    {
+        if (m_render.empty())
+            return;
+
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        const uint64_t due = static_cast<uint64_t>(elapsed * m_config.sampleRate) / m_config.periodFrames;
+
+        const size_t ch = m_config.channels;
+        const size_t bufferFrames = m_config.bufferFrames;
+        const size_t delayFrames = m_delay.size() / ch;
+
+        for (; m_periodsDone < due; ++m_periodsDone)
+        {
+            for (uint32_t f = 0; f < m_config.periodFrames; ++f)
+            {
+                // The next slot of the (delayFrames + 1)-frame ring holds the frame rendered delayFrames ago
+                float *slot = m_delay.data() + m_delayPos * ch;
+                const size_t delayedPos = (m_delayPos + 1) % delayFrames;
+                const float *delayed = m_delay.data() + delayedPos * ch;
+
+                if (m_captureCount == bufferFrames)
+                {
+                    // Overflow: drop the oldest captured frame
+                    m_captureRead = (m_captureRead + 1) % bufferFrames;
+                    --m_captureCount;
+                }
+                float *captured = m_capture.data() + ((m_captureRead + m_captureCount) % bufferFrames) * ch;
+                ++m_captureCount;
+
+                for (size_t c = 0; c < ch; ++c)
+                    captured[c] = delayed[c] * m_config.gain + m_noise(m_rng);
+
+                // Device output: next rendered frame, or silence on underrun
+                if (m_renderCount > 0)
+                {
+                    std::memcpy(slot, m_render.data() + m_renderRead * ch, ch * sizeof(float));
+                    m_renderRead = (m_renderRead + 1) % bufferFrames;
+                    --m_renderCount;
+                }
+                else
+                {
+                    std::fill(slot, slot + ch, 0.0f);
+                }
+                m_delayPos = delayedPos;
+            }
+        }
+    }
+
+    /**
+     * @brief Free space in the render ring.
+     */
+    size_t SimulatedLoopback::Sink::writableFrames()
+    {
+        std::lock_guard<std::mutex> lock(m_owner.m_mutex);
+        m_owner.advance();
+        return m_owner.m_config.bufferFrames - m_owner.m_renderCount;
+    }
+
+    /**
+     * @brief Appends frames to the render ring.
+     *
+     * @param src Float frames.
+     * @param frames Frame count.
+     * @return size_t Frames accepted.
+     */
+    size_t SimulatedLoopback::Sink::write(const void *src, size_t frames)
+    {
+        std::lock_guard<std::mutex> lock(m_owner.m_mutex);
+        m_owner.advance();
+
+        const size_t ch = m_owner.m_config.channels;
+        const size_t bufferFrames = m_owner.m_config.bufferFrames;
+        frames = std::min(frames, bufferFrames - m_owner.m_renderCount);
+
+        const float *in = static_cast<const float *>(src);
+        for (size_t f = 0; f < frames; ++f)
+        {
+            const size_t pos = (m_owner.m_renderRead + m_owner.m_renderCount) % bufferFrames;
+            std::memcpy(m_owner.m_render.data() + pos * ch, in + f * ch, ch * sizeof(float));
+            ++m_owner.m_renderCount;
+        }
+        return frames;
+    }
+
+    /**
+     * @brief Copies captured frames out of the capture ring.
+     *
+     * @param dst Float frames.
+     * @param maxFrames Capacity.
+     * @return size_t Frames copied.
+     */
+    size_t SimulatedLoopback::Source::read(void *dst, size_t maxFrames)
+    {
+        std::lock_guard<std::mutex> lock(m_owner.m_mutex);
+        m_owner.advance();
+
+        const size_t ch = m_owner.m_config.channels;
+        const size_t bufferFrames = m_owner.m_config.bufferFrames;
+        const size_t frames = std::min(maxFrames, m_owner.m_captureCount);
+
+        float *out = static_cast<float *>(dst);
+        for (size_t f = 0; f < frames; ++f)
+        {
+            std::memcpy(out + f * ch, m_owner.m_capture.data() + m_owner.m_captureRead * ch, ch * sizeof(float));
+            m_owner.m_captureRead = (m_owner.m_captureRead + 1) % bufferFrames;
+            --m_owner.m_captureCount;
+        }
+        return frames;
+    }
+}
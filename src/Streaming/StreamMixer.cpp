@@ -0,0 +1,128 @@
+#include "Streaming/StreamMixer.h"
+#include "Dsp/SampleFormat.h"
+
+#include <cstring>
+
+namespace Streaming
+{
+    /**
+     * @brief Binds the sink and allocates the mixer and output buffers.
+     *
+     * @param sink Render sink.
+     * @param maxInputs Maximum number of inputs.
+     * @param maxFrames Largest period in frames.
+     * @return true on success.
+     */
+    bool StreamMixer::open(IAudioSink *sink, uint32_t maxInputs, size_t maxFrames)
+    {
+        if (!sink || maxInputs == 0 || maxFrames == 0)
+            return false;
+
+        const Utility::DeviceFormatInfo &out = sink->format();
+        if (!out.valid || !Dsp::IsConvertibleFormat(out))
+            return false;
+
+        if (!m_mixer.configure(maxInputs, out.channels, maxFrames, out.sampleRate))
+            return false;
+
+        m_sink = sink;
+        m_maxFrames = maxFrames;
+        m_maxInputs = maxInputs;
+        m_underruns = 0;
+        m_inputs.clear();
+        m_inputs.reserve(maxInputs);
+        m_mixed.assign(maxFrames * out.channels, 0.0f);
+        m_output.assign(maxFrames * out.blockAlign, 0);
+        return true;
+    }
+
+    /**
+     * @brief Registers a source and prepares its conversion chain.
+     *
+     * @param source Capture source.
+     * @param gain Initial gain.
+     * @return Input index, or -1 on failure.
+     */
+    int StreamMixer::addInput(IAudioSource *source, float gain)
+    {
+        if (!m_sink || !source || m_inputs.size() >= m_maxInputs)
+            return -1;
+
+        const Utility::DeviceFormatInfo &in = source->format();
+        const Utility::DeviceFormatInfo &out = m_sink->format();
+        if (!in.valid || !Dsp::IsConvertibleFormat(in) || in.sampleRate != out.sampleRate)
+            return -1;
+
+        auto input = std::make_unique<Input>();
+        input->source = source;
+        if (!input->matrix.build(in, out))
+            return -1;
+        input->raw.assign(m_maxFrames * in.blockAlign, 0);
+        input->native.assign(m_maxFrames * in.channels, 0.0f);
+
+        const int index = static_cast<int>(m_inputs.size());
+        m_inputs.push_back(std::move(input));
+        m_mixer.setGain(static_cast<uint32_t>(index), gain, true);
+        return index;
+    }
+
+    /**
+     * @brief Sets the gain of an input.
+     */
+    void StreamMixer::setGain(int input, float gain)
+    {
+        if (input >= 0)
+            m_mixer.setGain(static_cast<uint32_t>(input), gain);
+    }
+
+    /**
+     * @brief Enables or disables the soft limiter.
+     */
+    void StreamMixer::setSoftClip(bool enabled, float knee)
+    {
+        m_mixer.setSoftClip(enabled, knee);
+    }
+
+    /**
+     * @brief Runs one mixing period.
+     *
+     * @return Frames written to the sink.
+     */
+    size_t StreamMixer::pump()
+    {
+        if (!m_sink)
+            return 0;
+
+        size_t frames = m_sink->writableFrames();
+        if (frames > m_maxFrames)
+            frames = m_maxFrames;
+        if (frames == 0)
+            return 0;
+
+        const uint32_t outChannels = m_mixer.channels();
+
+        for (size_t i = 0; i < m_inputs.size(); ++i)
+        {
+            Input &input = *m_inputs[i];
+            const Utility::DeviceFormatInfo &in = input.source->format();
+
+            size_t got = input.source->read(input.raw.data(), frames);
+            if (got < frames)
+            {
+                // Pad with silence so all inputs stay frame-aligned
+                const int silence = (!in.isFloat && in.bitDepth == 8) ? 0x80 : 0; // 8-bit PCM is unsigned
+                ++m_underruns;
+                std::memset(input.raw.data() + got * in.blockAlign, silence, (frames - got) * in.blockAlign);
+            }
+
+            // Native format → float → sink layout, written straight into the mixer input
+            Dsp::ToFloat(input.raw.data(), input.native.data(), frames * in.channels, in);
+            input.matrix.process(input.native.data(), m_mixer.input(static_cast<uint32_t>(i)), frames);
+        }
+
+        m_mixer.mix(m_mixed.data(), frames, static_cast<uint32_t>(m_inputs.size()));
+
+        Dsp::FromFloat(m_mixed.data(), m_output.data(), frames * outChannels, m_sink->format());
+        return m_sink->write(m_output.data(), frames);
+    }
+}
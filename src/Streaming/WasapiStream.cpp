@@ -0,0 +1,335 @@
+#include "Streaming/WasapiStream.h"
+#include "Utility/DeviceUtils.h"
+#include "Utility/SafeRelease.h"
+
+#include <windows.h>
+#include <audioclient.h>
+#include <cstring>
+
+namespace Streaming
+{
+    namespace
+    {
+        constexpr REFERENCE_TIME kHnsPerMs = 10000;
+
+        uint32_t HnsToFrames(REFERENCE_TIME hns, uint32_t sampleRate)
+        {
+            return static_cast<uint32_t>((hns * sampleRate + 5000000) / 10000000);
+        }
+
+        /**
+         * @brief Collects buffer, period and latency sizes of an initialised client.
+         */
+        StreamTiming QueryTiming(IAudioClient *client, uint32_t sampleRate, UINT32 bufferFrames)
+        {
+            StreamTiming timing;
+            timing.bufferFrames = bufferFrames;
+
+            REFERENCE_TIME defaultPeriod = 0, minimumPeriod = 0, latency = 0;
+            if (SUCCEEDED(client->GetDevicePeriod(&defaultPeriod, &minimumPeriod)))
+            {
+                timing.defaultPeriodFrames = HnsToFrames(defaultPeriod, sampleRate);
+                timing.minimumPeriodFrames = HnsToFrames(minimumPeriod, sampleRate);
+            }
+            if (SUCCEEDED(client->GetStreamLatency(&latency)))
+                timing.streamLatencyFrames = HnsToFrames(latency, sampleRate);
+
+            return timing;
+        }
+    }
+
+    /**
+     * @brief Destructor - stops capture and releases COM interfaces.
+     */
+    CaptureStream::~CaptureStream()
+    {
+        close();
+    }
+
+    /**
+     * @brief Opens a shared-mode capture stream in the device mix format and starts it.
+     *
+     * @param device Endpoint to capture from (render endpoint for loopback).
+     * @param loopback Whether to open in loopback mode.
+     * @param bufferMs Buffer duration in milliseconds.
+     * @return true if the stream is running, false otherwise.
+     */
+    bool CaptureStream::open(IMMDevice *device, bool loopback, uint32_t bufferMs)
+    {
+        close();
+
+        if (!device)
+            return false;
+
+        HRESULT hr = device->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr, (void **)&m_client);
+        if (FAILED(hr) || !m_client)
+        {
+            m_client = nullptr;
+            return false;
+        }
+
+        WAVEFORMATEX *pwfx = nullptr;
+        hr = m_client->GetMixFormat(&pwfx);
+        if (FAILED(hr) || !pwfx)
+        {
+            close();
+            return false;
+        }
+
+        hr = m_client->Initialize(AUDCLNT_SHAREMODE_SHARED,
+                                  loopback ? AUDCLNT_STREAMFLAGS_LOOPBACK : 0,
+                                  bufferMs * kHnsPerMs, 0, pwfx, nullptr);
+        m_format = Utility::GetWaveFormatInfo(pwfx);
+        CoTaskMemFree(pwfx);
+
+        if (FAILED(hr))
+        {
+            close();
+            return false;
+        }
+
+        UINT32 bufferFrames = 0;
+        hr = m_client->GetBufferSize(&bufferFrames);
+        if (SUCCEEDED(hr))
+            hr = m_client->GetService(__uuidof(IAudioCaptureClient), (void **)&m_capture);
+        if (FAILED(hr) || !m_capture)
+        {
+            close();
+            return false;
+        }
+
+        m_timing = QueryTiming(m_client, m_format.sampleRate, bufferFrames);
+
+        // A single packet never exceeds the endpoint buffer
+        m_pending.assign(static_cast<size_t>(bufferFrames) * m_format.blockAlign, 0);
+        m_pendingOffset = 0;
+        m_pendingSize = 0;
+
+        hr = m_client->Start();
+        if (FAILED(hr))
+        {
+            close();
+            return false;
+        }
+
+        m_endpointId = Utility::GetDeviceId(device);
+        return true;
+    }
+
+    /**
+     * @brief Stops the stream and releases the capture client.
+     */
+    void CaptureStream::close()
+    {
+        if (m_client)
+            m_client->Stop();
+
+        Utility::SafeRelease(m_capture);
+        Utility::SafeRelease(m_client);
+        m_timing = StreamTiming();
+        m_endpointId.clear();
+        m_pendingOffset = 0;
+        m_pendingSize = 0;
+    }
+
+    /**
+     * @brief Copies captured frames into `dst` without blocking.
+     *
+     * WASAPI packets must be released whole, so a packet that does not fit in
+     * the caller's buffer is parked in a preallocated staging buffer and served
+     * on the following calls. Silent packets are returned as zeros.
+     *
+     * @param dst Destination buffer.
+     * @param maxFrames Capacity in frames.
+     * @return Frames copied.
+     */
+    size_t CaptureStream::read(void *dst, size_t maxFrames)
+    {
+        if (!m_capture || maxFrames == 0)
+            return 0;
+
+        const size_t frameBytes = m_format.blockAlign;
+        uint8_t *out = static_cast<uint8_t *>(dst);
+        size_t copied = 0;
+
+        // Serve leftovers from the previous packet first
+        if (m_pendingSize > m_pendingOffset)
+        {
+            size_t frames = (m_pendingSize - m_pendingOffset) / frameBytes;
+            if (frames > maxFrames)
+                frames = maxFrames;
+
+            std::memcpy(out, m_pending.data() + m_pendingOffset, frames * frameBytes);
+            m_pendingOffset += frames * frameBytes;
+            copied += frames;
+        }
+
+        while (copied < maxFrames)
+        {
+            UINT32 packetFrames = 0;
+            HRESULT hr = m_capture->GetNextPacketSize(&packetFrames);
+            if (FAILED(hr) || packetFrames == 0)
+                break;
+
+            BYTE *data = nullptr;
+            DWORD flags = 0;
+            hr = m_capture->GetBuffer(&data, &packetFrames, &flags, nullptr, nullptr);
+            if (FAILED(hr))
+                break;
+
+            const bool silent = (flags & AUDCLNT_BUFFERFLAGS_SILENT) != 0;
+            const size_t room = maxFrames - copied;
+            const size_t direct = packetFrames < room ? packetFrames : room;
+
+            if (silent)
+                std::memset(out + copied * frameBytes, 0, direct * frameBytes);
+            else
+                std::memcpy(out + copied * frameBytes, data, direct * frameBytes);
+            copied += direct;
+
+            // Park the remainder of the packet
+            const size_t rest = packetFrames - direct;
+            if (rest > 0)
+            {
+                const size_t restBytes = rest * frameBytes;
+                if (silent)
+                    std::memset(m_pending.data(), 0, restBytes);
+                else
+                    std::memcpy(m_pending.data(), data + direct * frameBytes, restBytes);
+                m_pendingOffset = 0;
+                m_pendingSize = restBytes;
+            }
+
+            m_capture->ReleaseBuffer(packetFrames);
+
+            if (rest > 0)
+                break;
+        }
+
+        return copied;
+    }
+
+    /**
+     * @brief Destructor - stops playback and releases COM interfaces.
+     */
+    RenderStream::~RenderStream()
+    {
+        close();
+    }
+
+    /**
+     * @brief Opens a shared-mode render stream in the device mix format.
+     *
+     * @param device Render endpoint.
+     * @param bufferMs Buffer duration in milliseconds.
+     * @return true on success, false otherwise.
+     */
+    bool RenderStream::open(IMMDevice *device, uint32_t bufferMs)
+    {
+        close();
+
+        if (!device)
+            return false;
+
+        HRESULT hr = device->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr, (void **)&m_client);
+        if (FAILED(hr) || !m_client)
+        {
+            m_client = nullptr;
+            return false;
+        }
+
+        WAVEFORMATEX *pwfx = nullptr;
+        hr = m_client->GetMixFormat(&pwfx);
+        if (FAILED(hr) || !pwfx)
+        {
+            close();
+            return false;
+        }
+
+        hr = m_client->Initialize(AUDCLNT_SHAREMODE_SHARED, 0, bufferMs * kHnsPerMs, 0, pwfx, nullptr);
+        m_format = Utility::GetWaveFormatInfo(pwfx);
+        CoTaskMemFree(pwfx);
+
+        if (FAILED(hr))
+        {
+            close();
+            return false;
+        }
+
+        UINT32 bufferFrames = 0;
+        hr = m_client->GetBufferSize(&bufferFrames);
+        if (SUCCEEDED(hr))
+            hr = m_client->GetService(__uuidof(IAudioRenderClient), (void **)&m_render);
+        if (FAILED(hr) || !m_render)
+        {
+            close();
+            return false;
+        }
+
+        m_bufferFrames = bufferFrames;
+        m_timing = QueryTiming(m_client, m_format.sampleRate, bufferFrames);
+        return true;
+    }
+
+    /**
+     * @brief Stops playback and releases the render client.
+     */
+    void RenderStream::close()
+    {
+        if (m_client && m_started)
+            m_client->Stop();
+
+        Utility::SafeRelease(m_render);
+        Utility::SafeRelease(m_client);
+        m_timing = StreamTiming();
+        m_bufferFrames = 0;
+        m_started = false;
+    }
+
+    /**
+     * @brief Returns how many frames fit into the endpoint buffer right now.
+     */
+    size_t RenderStream::writableFrames()
+    {
+        if (!m_client)
+            return 0;
+
+        UINT32 padding = 0;
+        if (FAILED(m_client->GetCurrentPadding(&padding)) || padding > m_bufferFrames)
+            return 0;
+
+        return m_bufferFrames - padding;
+    }
+
+    /**
+     * @brief Copies frames into the endpoint buffer and starts playback on first use.
+     *
+     * @param src Frames in the device format.
+     * @param frames Frame count.
+     * @return Frames accepted.
+     */
+    size_t RenderStream::write(const void *src, size_t frames)
+    {
+        if (!m_render)
+            return 0;
+
+        size_t writable = writableFrames();
+        if (frames > writable)
+            frames = writable;
+        if (frames == 0)
+            return 0;
+
+        BYTE *data = nullptr;
+        HRESULT hr = m_render->GetBuffer(static_cast<UINT32>(frames), &data);
+        if (FAILED(hr) || !data)
+            return 0;
+
+        std::memcpy(data, src, frames * m_format.blockAlign);
+        m_render->ReleaseBuffer(static_cast<UINT32>(frames), 0);
+
+        if (!m_started && SUCCEEDED(m_client->Start()))
+            m_started = true;
+
+        return frames;
+    }
+}
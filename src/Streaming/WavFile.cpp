@@ -0,0 +1,141 @@
+#include "Streaming/WavFile.h"
+
+#include <cstring>
+
+namespace Streaming
+{
+    namespace
+    {
+        uint16_t GetU16(const uint8_t *p)
+        {
+            return static_cast<uint16_t>(p[0] | (p[1] << 8));
+        }
+
+        uint32_t GetU32(const uint8_t *p)
+        {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        uint64_t GetU64(const uint8_t *p)
+        {
+            return static_cast<uint64_t>(GetU32(p)) | (static_cast<uint64_t>(GetU32(p + 4)) << 32);
+        }
+
+        bool IsId(const uint8_t *p, const char *id)
+        {
+            return std::memcmp(p, id, 4) == 0;
+        }
+    }
+
+    /**
+     * @brief Maps a file and parses its header.
+     *
+     * @param path File path.
+     * @return true on success.
+     */
+    bool WavFile::open(const std::filesystem::path &path)
+    {
+        close();
+
+        if (!m_mapping.open(path))
+            return false;
+
+        if (!parse(m_mapping.data(), m_mapping.size()))
+        {
+            m_mapping.close();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Unmaps the file.
+     */
+    void WavFile::close()
+    {
+        m_mapping.close();
+        m_format = Utility::DeviceFormatInfo();
+        m_frames = nullptr;
+        m_frameCount = 0;
+    }
+
+    /**
+     * @brief Walks the RIFF chunks and locates `fmt ` and `data`.
+     *
+     * For RF64 the 64-bit data size comes from the ds64 chunk.
+     *
+     * @param data File image.
+     * @param size Image size in bytes.
+     * @return true if a supported format and a data chunk were found.
+     */
+    bool WavFile::parse(const uint8_t *data, uint64_t size)
+    {
+        m_format = Utility::DeviceFormatInfo();
+        m_frames = nullptr;
+        m_frameCount = 0;
+
+        if (!data || size < 12 || !IsId(data + 8, "WAVE"))
+            return false;
+
+        const bool rf64 = IsId(data, "RF64");
+        if (!rf64 && !IsId(data, "RIFF"))
+            return false;
+
+        uint64_t ds64DataSize = 0;
+        bool haveFormat = false;
+        uint64_t offset = 12;
+
+        while (offset + 8 <= size)
+        {
+            const uint8_t *chunk = data + offset;
+            uint64_t chunkSize = GetU32(chunk + 4);
+            const uint8_t *body = chunk + 8;
+            const uint64_t available = size - offset - 8;
+
+            if (IsId(chunk, "ds64") && chunkSize >= 24 && available >= 24)
+            {
+                ds64DataSize = GetU64(body + 8);
+            }
+            else if (IsId(chunk, "fmt ") && chunkSize >= 16 && available >= 16)
+            {
+                uint16_t tag = GetU16(body);
+                m_format.channels = GetU16(body + 2);
+                m_format.sampleRate = GetU32(body + 4);
+                m_format.blockAlign = GetU16(body + 12);
+                m_format.bitDepth = GetU16(body + 14);
+
+                if (tag == 0xFFFE && chunkSize >= 40 && available >= 40)
+                {
+                    m_format.channelMask = GetU32(body + 20);
+                    tag = static_cast<uint16_t>(GetU32(body + 24)); // SubFormat.Data1
+                }
+
+                if (tag != 1 && tag != 3)
+                    return false;
+
+                m_format.isFloat = tag == 3;
+                haveFormat = true;
+            }
+            else if (IsId(chunk, "data"))
+            {
+                if (!haveFormat || m_format.blockAlign == 0 || m_format.channels == 0 || m_format.sampleRate == 0)
+                    return false;
+
+                if (rf64 && chunkSize == 0xFFFFFFFFull)
+                    chunkSize = ds64DataSize;
+                if (chunkSize > available)
+                    chunkSize = available;
+
+                m_frames = body;
+                m_frameCount = chunkSize / m_format.blockAlign;
+                m_format.valid = true;
+                return true;
+            }
+
+            offset += 8 + chunkSize + (chunkSize & 1);
+        }
+
+        return false;
+    }
+}
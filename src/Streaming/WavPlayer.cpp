@@ -0,0 +1,349 @@
+#include "Streaming/WavPlayer.h"
+#include "Dsp/SampleFormat.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Streaming
+{
+    namespace
+    {
+        constexpr uint32_t kMaxChannels = 8;
+
+        bool SameFormat(const Utility::DeviceFormatInfo &a, const Utility::DeviceFormatInfo &b)
+        {
+            return a.sampleRate == b.sampleRate && a.channels == b.channels && a.bitDepth == b.bitDepth &&
+                   a.blockAlign == b.blockAlign && a.isFloat == b.isFloat &&
+                   (a.channelMask == b.channelMask || a.channelMask == 0 || b.channelMask == 0);
+        }
+    }
+
+    /**
+     * @brief Destructor - releases every file.
+     */
+    WavPlayer::~WavPlayer()
+    {
+        close();
+    }
+
+    /**
+     * @brief Binds the sink and allocates the per-period buffers.
+     *
+     * @param sink Render sink.
+     * @param maxFrames Period limit in frames.
+     * @param queueCapacity Queue length.
+     * @return true on success.
+     */
+    bool WavPlayer::open(IAudioSink *sink, size_t maxFrames, uint32_t queueCapacity)
+    {
+        close();
+
+        if (!sink || maxFrames == 0 || queueCapacity == 0)
+            return false;
+
+        const Utility::DeviceFormatInfo &out = sink->format();
+        if (!out.valid || out.channels == 0 || out.blockAlign == 0)
+            return false;
+
+        m_sink = sink;
+        m_maxFrames = maxFrames;
+        m_pending.reset(queueCapacity);
+        // Every item can be retired before the control thread collects
+        m_finished.reset(m_pending.capacity() + 1);
+        m_outstanding.store(0, std::memory_order_relaxed);
+        m_stopRequested.store(false, std::memory_order_relaxed);
+        m_breakLoopRequested.store(false, std::memory_order_relaxed);
+        m_framesPlayed.store(0, std::memory_order_relaxed);
+
+        m_native.assign(maxFrames * kMaxChannels, 0.0f);
+        m_mapped.assign(maxFrames * out.channels, 0.0f);
+        m_resampled.assign(maxFrames * out.channels, 0.0f);
+        m_output.assign(maxFrames * out.blockAlign, 0);
+        return true;
+    }
+
+    /**
+     * @brief Frees the current, queued and finished items.
+     */
+    void WavPlayer::close()
+    {
+        delete m_current;
+        m_current = nullptr;
+
+        Item *item = nullptr;
+        while (m_pending.tryPop(item))
+            delete item;
+        collect();
+
+        m_outstanding.store(0, std::memory_order_relaxed);
+        m_sink = nullptr;
+    }
+
+    /**
+     * @brief Maps a file and queues it.
+     *
+     * @param path File path.
+     * @param loop Loop flag.
+     * @return true if queued.
+     */
+    bool WavPlayer::enqueue(const std::filesystem::path &path, bool loop)
+    {
+        auto file = std::make_unique<WavFile>();
+        if (!file->open(path))
+            return false;
+
+        return enqueue(std::move(file), loop);
+    }
+
+    /**
+     * @brief Prepares the conversion chain of a file and hands it to the audio thread.
+     *
+     * @param file Opened file.
+     * @param loop Loop flag.
+     * @return true if queued.
+     */
+    bool WavPlayer::enqueue(std::unique_ptr<WavFile> file, bool loop)
+    {
+        if (!m_sink || !file || !file->isOpen() || file->frameCount() == 0)
+            return false;
+
+        collect();
+
+        const Utility::DeviceFormatInfo &in = file->format();
+        const Utility::DeviceFormatInfo &out = m_sink->format();
+
+        auto item = std::make_unique<Item>();
+        item->loop = loop;
+        item->direct = SameFormat(in, out);
+        if (!item->direct)
+        {
+            if (in.channels > kMaxChannels || !Dsp::IsConvertibleFormat(in) || !Dsp::IsConvertibleFormat(out))
+                return false;
+            if (!item->matrix.build(in, out))
+                return false;
+
+            item->resample = in.sampleRate != out.sampleRate;
+            if (item->resample && !item->resampler.configure(out.channels, in.sampleRate, out.sampleRate))
+                return false;
+        }
+        item->file = std::move(file);
+
+        m_outstanding.fetch_add(1, std::memory_order_acq_rel);
+        if (!m_pending.tryPush(item.get()))
+        {
+            m_outstanding.fetch_sub(1, std::memory_order_acq_rel);
+            return false;
+        }
+
+        item.release();
+        return true;
+    }
+
+    /**
+     * @brief Requests that everything stops at the next period.
+     */
+    void WavPlayer::stop()
+    {
+        m_stopRequested.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Requests that the current file stops looping.
+     */
+    void WavPlayer::breakLoop()
+    {
+        m_breakLoopRequested.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Frees items the audio thread has finished with.
+     */
+    void WavPlayer::collect()
+    {
+        Item *item = nullptr;
+        while (m_finished.tryPop(item))
+            delete item;
+    }
+
+    /**
+     * @brief Hands an item back to the control thread for deletion.
+     */
+    void WavPlayer::retire(Item *item)
+    {
+        m_finished.tryPush(item);
+        m_outstanding.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    /**
+     * @brief Converts up to `frames` file frames to float, wrapping around when looping.
+     *
+     * @return Frames converted (fewer at the end of a non-looping file).
+     */
+    size_t WavPlayer::gather(Item &item, float *dst, size_t frames)
+    {
+        const Utility::DeviceFormatInfo &in = item.file->format();
+        const uint64_t count = item.file->frameCount();
+        size_t done = 0;
+
+        while (done < frames)
+        {
+            if (item.position == count)
+            {
+                if (!item.loop)
+                    break;
+                item.position = 0;
+            }
+
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(frames - done, count - item.position));
+            Dsp::ToFloat(item.file->frames() + item.position * in.blockAlign, dst + done * in.channels,
+                         n * in.channels, in);
+            item.position += n;
+            done += n;
+        }
+
+        return done;
+    }
+
+    /**
+     * @brief Renders frames of one item in the sink format.
+     *
+     * @param item Item to play.
+     * @param out Destination in sink format.
+     * @param frames Frames wanted.
+     * @return Frames produced; fewer than `frames` means the item has ended.
+     */
+    size_t WavPlayer::render(Item &item, uint8_t *out, size_t frames)
+    {
+        const Utility::DeviceFormatInfo &sinkFormat = m_sink->format();
+        const uint64_t count = item.file->frameCount();
+        size_t produced = 0;
+
+        if (item.direct)
+        {
+            const size_t blockAlign = sinkFormat.blockAlign;
+            while (produced < frames)
+            {
+                if (item.position == count)
+                {
+                    if (!item.loop)
+                        break;
+                    item.position = 0;
+                }
+
+                const size_t n = static_cast<size_t>(std::min<uint64_t>(frames - produced, count - item.position));
+                std::memcpy(out + produced * blockAlign, item.file->frames() + item.position * blockAlign, n * blockAlign);
+                item.position += n;
+                produced += n;
+            }
+            return produced;
+        }
+
+        const size_t outChannels = sinkFormat.channels;
+        while (produced < frames)
+        {
+            const uint64_t remaining = count - item.position;
+            size_t n = frames - produced;
+            size_t need = n;
+
+            if (item.resample)
+            {
+                n = std::min(n, item.resampler.outputFramesFor(m_maxFrames));
+                if (!item.loop)
+                    n = std::min(n, item.resampler.outputFramesFor(static_cast<size_t>(std::min<uint64_t>(remaining, m_maxFrames))));
+                need = item.resampler.inputFramesFor(n);
+            }
+            else if (!item.loop)
+            {
+                n = static_cast<size_t>(std::min<uint64_t>(n, remaining));
+                need = n;
+            }
+
+            if (n == 0)
+            {
+                // Less than one output frame left: the tail is dropped
+                item.position = count;
+                break;
+            }
+
+            gather(item, m_native.data(), need);
+            item.matrix.process(m_native.data(), m_mapped.data(), need);
+
+            const float *result = m_mapped.data();
+            if (item.resample)
+            {
+                item.resampler.process(m_mapped.data(), m_resampled.data(), n);
+                result = m_resampled.data();
+            }
+
+            Dsp::FromFloat(result, out + produced * sinkFormat.blockAlign, n * outChannels, sinkFormat);
+            produced += n;
+        }
+
+        return produced;
+    }
+
+    /**
+     * @brief Fills one period from the current item and, if it ends, from the next ones.
+     *
+     * A single matching file that does not end in this period is written to the sink
+     * straight from the mapping.
+     *
+     * @return size_t Frames written to the sink.
+     */
+    size_t WavPlayer::pump()
+    {
+        if (!m_sink)
+            return 0;
+
+        if (m_stopRequested.exchange(false, std::memory_order_acq_rel))
+        {
+            if (m_current)
+                retire(m_current);
+            m_current = nullptr;
+
+            Item *item = nullptr;
+            while (m_pending.tryPop(item))
+                retire(item);
+        }
+
+        if (!m_current && !m_pending.tryPop(m_current))
+            return 0;
+
+        if (m_breakLoopRequested.exchange(false, std::memory_order_acq_rel))
+            m_current->loop = false;
+
+        const size_t frames = std::min(m_sink->writableFrames(), m_maxFrames);
+        if (frames == 0)
+            return 0;
+
+        const size_t blockAlign = m_sink->format().blockAlign;
+
+        // Zero-copy path: the whole period is one contiguous run of a matching file
+        if (m_current->direct && m_current->file->frameCount() - m_current->position >= frames)
+        {
+            const size_t written = m_sink->write(m_current->file->frames() + m_current->position * blockAlign, frames);
+            m_current->position += written;
+            m_framesPlayed.fetch_add(written, std::memory_order_relaxed);
+            return written;
+        }
+
+        size_t produced = 0;
+        while (produced < frames && m_current)
+        {
+            produced += render(*m_current, m_output.data() + produced * blockAlign, frames - produced);
+            if (produced < frames)
+            {
+                retire(m_current);
+                m_current = nullptr;
+                m_pending.tryPop(m_current);
+            }
+        }
+
+        if (produced == 0)
+            return 0;
+
+        const size_t written = m_sink->write(m_output.data(), produced);
+        m_framesPlayed.fetch_add(written, std::memory_order_relaxed);
+        return written;
+    }
+}
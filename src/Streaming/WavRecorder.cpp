@@ -0,0 +1,462 @@
+#include "Streaming/WavRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <numeric>
+
+namespace Streaming
+{
+    namespace
+    {
+        constexpr size_t kAlignment = 4096;
+        constexpr uint64_t kRiffSizeOffset = 4;
+        constexpr uint64_t kReservedIdOffset = 12;   ///< "JUNK", later "ds64"
+        constexpr uint64_t kReservedBodyOffset = 20; ///< 28-byte ds64 body
+        constexpr uint32_t kReservedBodySize = 28;
+        constexpr uint64_t kDataSizeOffset = WavRecorder::DataOffset - 4;
+        constexpr uint64_t kMax32 = 0xFFFFFFFFull;
+
+        void PutU16(uint8_t *p, uint16_t v)
+        {
+            p[0] = static_cast<uint8_t>(v);
+            p[1] = static_cast<uint8_t>(v >> 8);
+        }
+
+        void PutU32(uint8_t *p, uint32_t v)
+        {
+            for (int i = 0; i < 4; ++i)
+                p[i] = static_cast<uint8_t>(v >> (8 * i));
+        }
+
+        void PutU64(uint8_t *p, uint64_t v)
+        {
+            for (int i = 0; i < 8; ++i)
+                p[i] = static_cast<uint8_t>(v >> (8 * i));
+        }
+
+        void PutId(uint8_t *p, const char *id)
+        {
+            std::memcpy(p, id, 4);
+        }
+    }
+
+    /**
+     * @brief Frees a pool buffer allocated with 4 KiB alignment.
+     */
+    void WavRecorder::AlignedDelete::operator()(uint8_t *p) const
+    {
+        ::operator delete(p, std::align_val_t(kAlignment));
+    }
+
+    /**
+     * @brief Destructor - flushes and finalises the file.
+     */
+    WavRecorder::~WavRecorder()
+    {
+        close();
+    }
+
+    /**
+     * @brief Creates the output file and starts recording into it.
+     *
+     * @param path Output path.
+     * @param format Frame format.
+     * @param config Buffering policy.
+     * @return true on success.
+     */
+    bool WavRecorder::open(const std::filesystem::path &path, const Utility::DeviceFormatInfo &format,
+                           const WavRecorderConfig &config)
+    {
+        close();
+
+        std::unique_ptr<Utility::IFileSink> file = Utility::CreateFileSink(path);
+        if (!file)
+            return false;
+
+        return open(std::move(file), format, config);
+    }
+
+    /**
+     * @brief Writes the header, allocates the buffer pool and starts the writer thread.
+     *
+     * @param file Destination (ownership is taken).
+     * @param format Frame format.
+     * @param config Buffering policy.
+     * @return true on success.
+     */
+    bool WavRecorder::open(std::unique_ptr<Utility::IFileSink> file, const Utility::DeviceFormatInfo &format,
+                           const WavRecorderConfig &config)
+    {
+        close();
+
+        if (!file || !format.valid || format.channels == 0 || format.blockAlign == 0 ||
+            format.sampleRate == 0 || config.bufferCount < 2)
+            return false;
+
+        m_file = std::move(file);
+        m_format = format;
+        m_config = config;
+        m_dataBytes = 0;
+        m_rf64 = false;
+
+        if (!writeHeader())
+        {
+            m_file.reset();
+            return false;
+        }
+
+        // Whole frames and whole 4 KiB pages per buffer
+        const size_t unit = std::lcm(static_cast<size_t>(format.blockAlign), kAlignment);
+        m_bufferBytes = std::max(unit, (config.bufferBytes + unit - 1) / unit * unit);
+
+        m_blocks.clear();
+        m_blocks.resize(config.bufferCount);
+        m_free.reset(config.bufferCount);
+        m_filled.reset(config.bufferCount);
+        for (uint32_t i = 0; i < config.bufferCount; ++i)
+        {
+            m_blocks[i].data.reset(static_cast<uint8_t *>(::operator new(m_bufferBytes, std::align_val_t(kAlignment))));
+            m_free.tryPush(i);
+        }
+        m_discard.assign(m_bufferBytes, 0);
+        m_current = -1;
+
+        m_framesRecorded.store(0, std::memory_order_relaxed);
+        m_droppedFrames.store(0, std::memory_order_relaxed);
+        m_bytesWritten.store(0, std::memory_order_relaxed);
+        m_writeErrors.store(0, std::memory_order_relaxed);
+        m_maxQueueDepth.store(0, std::memory_order_relaxed);
+
+        m_stopping.store(false, std::memory_order_relaxed);
+        m_writer = std::thread(&WavRecorder::writerLoop, this);
+        return true;
+    }
+
+    /**
+     * @brief Submits the partial buffer, stops the writer and finalises the header.
+     *
+     * @return true if no write failed during the recording.
+     */
+    bool WavRecorder::close()
+    {
+        if (!m_file)
+            return false;
+
+        if (m_current >= 0 && m_blocks[static_cast<size_t>(m_current)].used > 0)
+            submitBlock();
+
+        m_stopping.store(true, std::memory_order_release);
+        m_wake.notify_one();
+        if (m_writer.joinable())
+            m_writer.join();
+
+        // RIFF chunks are word aligned: pad an odd-sized data chunk
+        if (m_dataBytes & 1)
+        {
+            const uint8_t pad = 0;
+            if (!m_file->write(&pad, 1))
+                m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (!updateHeader(true))
+            m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+
+        m_file->close();
+        m_file.reset();
+        m_blocks.clear();
+        m_discard.clear();
+        m_current = -1;
+
+        return m_writeErrors.load(std::memory_order_relaxed) == 0;
+    }
+
+    /**
+     * @brief Makes sure the capture thread has a buffer to fill.
+     *
+     * @return false if the pool is exhausted.
+     */
+    bool WavRecorder::acquireBlock()
+    {
+        if (m_current >= 0)
+            return true;
+
+        uint32_t index = 0;
+        if (!m_free.tryPop(index))
+            return false;
+
+        m_current = index;
+        m_blocks[index].used = 0;
+        return true;
+    }
+
+    /**
+     * @brief Hands the current buffer to the writer.
+     */
+    void WavRecorder::submitBlock()
+    {
+        // Cannot fail: the queue holds every block
+        m_filled.tryPush(static_cast<uint32_t>(m_current));
+        m_current = -1;
+
+        const uint32_t depth = static_cast<uint32_t>(m_filled.size());
+        if (depth > m_maxQueueDepth.load(std::memory_order_relaxed))
+            m_maxQueueDepth.store(depth, std::memory_order_relaxed);
+
+        m_wake.notify_one();
+    }
+
+    /**
+     * @brief Frames that can be stored without dropping.
+     */
+    size_t WavRecorder::writableFrames()
+    {
+        if (!m_file)
+            return 0;
+
+        size_t bytes = m_free.size() * m_bufferBytes;
+        if (m_current >= 0)
+            bytes += m_bufferBytes - m_blocks[static_cast<size_t>(m_current)].used;
+        return bytes / m_format.blockAlign;
+    }
+
+    /**
+     * @brief Copies frames into the pool, dropping what does not fit.
+     *
+     * @param src Frames in format().
+     * @param frames Frame count.
+     * @return size_t Frames stored.
+     */
+    size_t WavRecorder::write(const void *src, size_t frames)
+    {
+        if (!m_file || !src)
+            return 0;
+
+        const uint8_t *bytes = static_cast<const uint8_t *>(src);
+        const size_t total = frames * m_format.blockAlign;
+        size_t done = 0;
+
+        while (done < total && acquireBlock())
+        {
+            Block &block = m_blocks[static_cast<size_t>(m_current)];
+            const size_t n = std::min(total - done, m_bufferBytes - block.used);
+            std::memcpy(block.data.get() + block.used, bytes + done, n);
+            block.used += n;
+            done += n;
+
+            if (block.used == m_bufferBytes)
+                submitBlock();
+        }
+
+        const size_t stored = done / m_format.blockAlign;
+        m_framesRecorded.fetch_add(stored, std::memory_order_relaxed);
+        if (stored < frames)
+            m_droppedFrames.fetch_add(frames - stored, std::memory_order_relaxed);
+        return stored;
+    }
+
+    /**
+     * @brief Reads a source directly into the pool until it runs dry.
+     *
+     * @param source Capture source in format().
+     * @return size_t Frames stored.
+     */
+    size_t WavRecorder::drain(IAudioSource &source)
+    {
+        if (!m_file)
+            return 0;
+
+        const size_t blockAlign = m_format.blockAlign;
+        size_t stored = 0;
+
+        for (;;)
+        {
+            if (acquireBlock())
+            {
+                Block &block = m_blocks[static_cast<size_t>(m_current)];
+                const size_t room = (m_bufferBytes - block.used) / blockAlign;
+                const size_t got = source.read(block.data.get() + block.used, room);
+                block.used += got * blockAlign;
+                stored += got;
+
+                if (block.used == m_bufferBytes)
+                    submitBlock();
+                if (got < room)
+                    break;
+            }
+            else
+            {
+                const size_t room = m_discard.size() / blockAlign;
+                const size_t got = source.read(m_discard.data(), room);
+                m_droppedFrames.fetch_add(got, std::memory_order_relaxed);
+                if (got < room)
+                    break;
+            }
+        }
+
+        m_framesRecorded.fetch_add(stored, std::memory_order_relaxed);
+        return stored;
+    }
+
+    /**
+     * @brief Background thread: writes queued buffers and periodically updates the header.
+     */
+    void WavRecorder::writerLoop()
+    {
+        using Clock = std::chrono::steady_clock;
+        const auto interval = std::chrono::milliseconds(m_config.headerUpdateMs);
+        auto lastUpdate = Clock::now();
+        bool dirty = false;
+
+        for (;;)
+        {
+            // Read the flag before polling so the final block queued by close() is not missed
+            const bool stopping = m_stopping.load(std::memory_order_acquire);
+
+            uint32_t index = 0;
+            if (m_filled.tryPop(index))
+            {
+                Block &block = m_blocks[index];
+                if (m_file->write(block.data.get(), block.used))
+                {
+                    m_dataBytes += block.used;
+                    m_bytesWritten.fetch_add(block.used, std::memory_order_relaxed);
+                    dirty = true;
+                }
+                else
+                {
+                    m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+                }
+                m_free.tryPush(index);
+            }
+            else if (stopping)
+            {
+                break;
+            }
+            else
+            {
+                // Timed wait: the capture thread notifies without taking the mutex
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wake.wait_for(lock, std::chrono::milliseconds(20));
+            }
+
+            if (dirty && Clock::now() - lastUpdate >= interval)
+            {
+                if (!updateHeader(false))
+                    m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+                dirty = false;
+                lastUpdate = Clock::now();
+            }
+        }
+    }
+
+    /**
+     * @brief Writes the 4 KiB header describing an empty recording.
+     *
+     * Layout: RIFF/WAVE, JUNK (28 bytes, reserved for ds64), fmt, JUNK padding, data
+     * header ending at DataOffset.
+     *
+     * @return true on success.
+     */
+    bool WavRecorder::writeHeader()
+    {
+        std::vector<uint8_t> header(DataOffset, 0);
+        uint8_t *p = header.data();
+
+        PutId(p, "RIFF");
+        PutU32(p + kRiffSizeOffset, static_cast<uint32_t>(DataOffset - 8));
+        PutId(p + 8, "WAVE");
+        PutId(p + kReservedIdOffset, "JUNK");
+        PutU32(p + 16, kReservedBodySize);
+
+        // fmt: WAVE_FORMAT_EXTENSIBLE for more than 2 channels or more than 16 bits
+        const bool extensible = m_format.channels > 2 || m_format.bitDepth > 16;
+        const uint16_t tag = extensible ? 0xFFFE : (m_format.isFloat ? 3 : 1);
+        const uint32_t fmtSize = extensible ? 40 : (m_format.isFloat ? 18 : 16);
+
+        uint8_t *fmt = p + kReservedBodyOffset + kReservedBodySize;
+        PutId(fmt, "fmt ");
+        PutU32(fmt + 4, fmtSize);
+        PutU16(fmt + 8, tag);
+        PutU16(fmt + 10, m_format.channels);
+        PutU32(fmt + 12, m_format.sampleRate);
+        PutU32(fmt + 16, m_format.sampleRate * m_format.blockAlign);
+        PutU16(fmt + 20, m_format.blockAlign);
+        PutU16(fmt + 22, m_format.bitDepth);
+        if (extensible)
+        {
+            // KSDATAFORMAT_SUBTYPE_PCM / _IEEE_FLOAT: {0000000x-0000-0010-8000-00AA00389B71}
+            static const uint8_t kGuidTail[12] = {0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+            PutU16(fmt + 24, 22);
+            PutU16(fmt + 26, m_format.bitDepth);
+            PutU32(fmt + 28, m_format.channelMask);
+            PutU32(fmt + 32, m_format.isFloat ? 3u : 1u);
+            std::memcpy(fmt + 36, kGuidTail, sizeof(kGuidTail));
+        }
+        // else: an 18-byte float fmt ends with cbSize = 0, already zero
+
+        uint8_t *pad = fmt + 8 + fmtSize;
+        const uint64_t padOffset = static_cast<uint64_t>(pad - p);
+        PutId(pad, "JUNK");
+        PutU32(pad + 4, static_cast<uint32_t>(kDataSizeOffset - 4 - padOffset - 8));
+
+        PutId(p + kDataSizeOffset - 4, "data");
+        PutU32(p + kDataSizeOffset, 0);
+
+        return m_file->write(header.data(), header.size()) && m_file->flush(m_config.durableHeaderUpdates);
+    }
+
+    /**
+     * @brief Publishes the current data size in the header.
+     *
+     * Data is flushed before any size is patched, so the header never describes bytes
+     * that are not on disk. Crossing 4 GiB fills in the ds64 body first and only then
+     * renames the file to RF64, so every intermediate state is a readable file.
+     *
+     * @param final Include the data chunk pad byte in the RIFF size.
+     * @return true on success.
+     */
+    bool WavRecorder::updateHeader(bool final)
+    {
+        const bool durable = m_config.durableHeaderUpdates || final;
+        if (!m_file->flush(durable))
+            return false;
+
+        const uint64_t riffSize = DataOffset - 8 + m_dataBytes + ((final && (m_dataBytes & 1)) ? 1 : 0);
+        uint8_t value[8];
+
+        if (!m_rf64 && riffSize <= kMax32)
+        {
+            PutU32(value, static_cast<uint32_t>(riffSize));
+            bool ok = m_file->writeAt(kRiffSizeOffset, value, 4);
+            PutU32(value, static_cast<uint32_t>(m_dataBytes));
+            ok = ok && m_file->writeAt(kDataSizeOffset, value, 4);
+            return ok && m_file->flush(durable);
+        }
+
+        uint8_t ds64[kReservedBodySize] = {};
+        PutU64(ds64, riffSize);
+        PutU64(ds64 + 8, m_dataBytes);
+        PutU64(ds64 + 16, m_dataBytes / m_format.blockAlign);
+        // ds64 + 24: table length 0
+
+        bool ok = m_file->writeAt(kReservedBodyOffset, ds64, sizeof(ds64)) && m_file->flush(durable);
+        if (ok && !m_rf64)
+        {
+            uint8_t id[4];
+            PutId(id, "ds64");
+            ok = m_file->writeAt(kReservedIdOffset, id, 4);
+            PutU32(value, static_cast<uint32_t>(kMax32));
+            ok = ok && m_file->writeAt(kDataSizeOffset, value, 4);
+            ok = ok && m_file->flush(durable);
+
+            PutId(id, "RF64");
+            ok = ok && m_file->writeAt(0, id, 4);
+            ok = ok && m_file->writeAt(kRiffSizeOffset, value, 4);
+            ok = ok && m_file->flush(durable);
+            m_rf64 = ok;
+        }
+        return ok;
+    }
+}
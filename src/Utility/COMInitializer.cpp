@@ -6,19 +6,24 @@ namespace Utility
      * @brief Constructor - Initializes COM for the current thread.
      *
      * Uses CoInitializeEx with the specified initialization flags (e.g., COINIT_MULTITHREADED).
-     * If initialization fails, throws a std::runtime_error.
+     * If initialization fails, throws a std::runtime_error. Without COM (non-Windows
+     * builds) this is a no-op.
      *
      * @param coinitFlags Initialization flags. Default is COINIT_MULTITHREADED.
      * @throws std::runtime_error if COM initialization fails.
      */
     COMInitializer::COMInitializer(DWORD coinitFlags)
     {
+#if defined(_WIN32)
         HRESULT hr = CoInitializeEx(nullptr, coinitFlags);
         if (FAILED(hr))
         {
             throw std::runtime_error("Failed to initialize COM.");
         }
         m_initialized = true;
+#else
+        (void)coinitFlags;
+#endif
     }
 
     /**
@@ -28,10 +33,12 @@ namespace Utility
      */
     COMInitializer::~COMInitializer()
     {
+#if defined(_WIN32)
         if (m_initialized)
         {
             CoUninitialize();
         }
+#endif
     }
 
     /**
@@ -61,8 +68,10 @@ namespace Utility
     {
         if (this != &other)
         {
+#if defined(_WIN32)
             if (m_initialized)
                 CoUninitialize();
+#endif
 
             m_initialized = other.m_initialized;
             other.m_initialized = false;
@@ -1,20 +1,22 @@
 #include "Utility/DeviceUtils.h"
 #include "Utility/SafeRelease.h"
+#include "Backend/AudioBackend.h"
+#include "Dsp/ChannelLayout.h"
+
+#if defined(_WIN32)
 #include <windows.h>
-#include <mmdeviceapi.h>
-#include <endpointvolume.h>
-#include <functiondiscoverykeys_devpkey.h> // For PKEY_Device_FriendlyName
-#include <propvarutil.h>                   // For PropVariantClear
-#include <audioclient.h>                   // For IAudioClient
-#include <comdef.h>                        // For HRESULT error handling
-#include <stdexcept>
+#include <mmreg.h>   // For WAVEFORMATEXTENSIBLE
+#include <ksmedia.h> // For KSDATAFORMAT_SUBTYPE_IEEE_FLOAT
+#endif
+
 namespace Utility
 {
     /**
      * @brief Retrieves the friendly name of a given audio device.
      *
-     * This function queries the device's property store to extract the user-friendly
-     * name (e.g., "Speakers", "Headphones", etc.). If it fails, it returns "Unknown".
+     * This function asks the installed backend for the user-friendly name (on Windows
+     * read from the device's property store, e.g. "Speakers", "Headphones", etc.).
+     * If it fails, it returns "Unknown".
      *
      * @param device A valid IMMDevice pointer.
      * @return std::wstring The friendly device name, or "Unknown" on failure.
@@ -24,40 +26,73 @@ namespace Utility
         if (!device)
             return L"Unknown";
 
-        IPropertyStore *pStore = nullptr;
-
-        // Open the device's property store for reading
-        HRESULT hr = device->OpenPropertyStore(STGM_READ, &pStore);
-        if (FAILED(hr) || !pStore)
+        std::wstring name;
+        if (FAILED(Backend::GetAudioBackend()->getFriendlyName(device, name)))
             return L"Unknown";
 
-        PROPVARIANT prop;
-        PropVariantInit(&prop);
+        return name;
+    }
 
-        // Retrieve the friendly name property
-        hr = pStore->GetValue(PKEY_Device_FriendlyName, &prop);
+    /**
+     * @brief Retrieves the endpoint ID of a given audio device.
+     *
+     * @param device A valid IMMDevice pointer.
+     * @return std::wstring The endpoint ID, or an empty string on failure.
+     */
+    std::wstring GetDeviceId(IMMDevice *device)
+    {
+        std::wstring id;
+        LPWSTR raw = nullptr;
+        if (device && SUCCEEDED(device->GetId(&raw)) && raw)
+            id = raw;
+        CoTaskMemFree(raw);
+        return id;
+    }
 
-        std::wstring name = L"Unknown";
+#if defined(_WIN32)
+    /**
+     * @brief Converts a WAVEFORMATEX (or WAVEFORMATEXTENSIBLE) into DeviceFormatInfo.
+     *
+     * The channel mask and sample type are read from the extensible part when present;
+     * plain formats get the default layout for their channel count.
+     *
+     * @param format Pointer to a wave format, e.g. from IAudioClient::GetMixFormat.
+     * @return DeviceFormatInfo Converted format. `.valid` is false if `format` is null.
+     */
+    DeviceFormatInfo GetWaveFormatInfo(const WAVEFORMATEX *format)
+    {
+        DeviceFormatInfo info;
 
-        if (SUCCEEDED(hr) && prop.vt == VT_LPWSTR)
+        if (!format)
+            return info;
+
+        info.bitDepth = format->wBitsPerSample;
+        info.channels = format->nChannels;
+        info.blockAlign = format->nBlockAlign;
+        info.sampleRate = format->nSamplesPerSec;
+        info.isFloat = format->wFormatTag == WAVE_FORMAT_IEEE_FLOAT;
+
+        // Speaker layout and sample type: only WAVEFORMATEXTENSIBLE carries them explicitly
+        if (format->wFormatTag == WAVE_FORMAT_EXTENSIBLE && format->cbSize >= sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX))
         {
-            // If the value is a wide string, use it
-            name = prop.pwszVal;
+            const WAVEFORMATEXTENSIBLE *formatExt = reinterpret_cast<const WAVEFORMATEXTENSIBLE *>(format);
+            info.channelMask = formatExt->dwChannelMask;
+            info.isFloat = IsEqualGUID(formatExt->SubFormat, KSDATAFORMAT_SUBTYPE_IEEE_FLOAT) != FALSE;
         }
+        info.channelMask = Dsp::EffectiveChannelMask(info);
+        info.valid = true;
 
-        // Always clean up
-        PropVariantClear(&prop);
-        // pStore->Release();
-        SafeRelease(pStore);
-
-        return name;
+        return info;
     }
+#endif
 
     /**
      * @brief Retrieves basic audio format information from a playback device.
      *
-     * This includes bit depth, sample rate, channel count, and block alignment.
-     * It uses the IAudioClient interface to query the shared-mode mix format.
+     * This includes bit depth, sample rate, channel count, block alignment and the
+     * speaker layout. On Windows the backend uses IAudioClient to query the shared-mode mix format.
+     * The channel mask comes from WAVEFORMATEXTENSIBLE when the device reports one,
+     * otherwise the default layout for the channel count is assumed.
      *
      * @param device A valid IMMDevice pointer.
      * @return DeviceFormatInfo Struct containing audio format details.
@@ -70,47 +105,18 @@ namespace Utility
         if (!device)
             return info;
 
-        IAudioClient *pAudioClient = nullptr;
-
-        // Activate the IAudioClient interface for this device
-        HRESULT hr = device->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr, (void **)&pAudioClient);
-        if (FAILED(hr) || !pAudioClient)
+        DeviceFormatInfo format;
+        if (FAILED(Backend::GetAudioBackend()->getMixFormat(device, format)))
             return info;
 
-        WAVEFORMATEX *pwfx = nullptr;
-
-        // Get the mix format (shared-mode default format)
-        hr = pAudioClient->GetMixFormat(&pwfx);
-        if (FAILED(hr) || !pwfx)
-        {
-            // pAudioClient->Release();
-            SafeRelease(pAudioClient);
-            return info;
-        }
-
-        // Extract format values
-        info.bitDepth = pwfx->wBitsPerSample;
-        info.channels = pwfx->nChannels;
-        info.blockAlign = pwfx->nBlockAlign;
-        info.sampleRate = pwfx->nSamplesPerSec;
-        info.valid = true;
-
-        // Clean up memory allocated by GetMixFormat
-        CoTaskMemFree(pwfx);
-        // pAudioClient->Release();
-        SafeRelease(pAudioClient);
-
-        return info;
+        return format;
     }
 
     /**
      * @brief Retrieves the system's current default audio playback (render) device.
      *
-     * This function uses the Windows Core Audio API to query the default audio endpoint
-     * for the `eRender` data flow and the `eConsole` role.
-     *
-     * It safely initializes COM for the current thread if needed, and uninitializes it
-     * after the operation. If the caller already initialized COM, this will still work safely.
+     * This function asks the installed backend (Core Audio on Windows) for the default
+     * audio endpoint of the `eRender` data flow and the `eConsole` role.
      *
      * @note Caller is responsible for releasing the returned IMMDevice pointer using `SafeRelease`.
      *
@@ -118,53 +124,20 @@ namespace Utility
      */
     IMMDevice *GetDefaultAudioPlaybackDevice()
     {
-        // Initialize COM for this thread if not already initialized.
-        // bool comInitialized = SUCCEEDED(CoInitialize(nullptr));
-
-        IMMDeviceEnumerator *pEnum = nullptr;
         IMMDevice *pDefaultDevice = nullptr;
 
-        // Create the device enumerator COM object.
-        HRESULT hr = CoCreateInstance(
-            __uuidof(MMDeviceEnumerator),
-            nullptr,
-            CLSCTX_ALL,
-            __uuidof(IMMDeviceEnumerator),
-            (void **)&pEnum);
-
-        if (FAILED(hr) || !pEnum)
-        {
-            // if (comInitialized)
-            // CoUninitialize();
+        // Default audio endpoint: render device for the console role
+        if (FAILED(Backend::GetAudioBackend()->getDefaultDevice(eRender, eConsole, &pDefaultDevice)))
             return nullptr;
-        }
-
-        // Retrieve the default audio endpoint (render device for the console role).
-        hr = pEnum->GetDefaultAudioEndpoint(eRender, eConsole, &pDefaultDevice);
-        SafeRelease(pEnum);
-
-        // If retrieval fails, uninitialize COM if we initialized it and return nullptr.
-        if (FAILED(hr))
-        {
-            // if (comInitialized)
-            // CoUninitialize();
-            return nullptr;
-        }
 
-        // Do not call CoUninitialize() here if we initialized COM in this function.
-        // The returned pDefaultDevice requires an active COM apartment.
-        // The caller is responsible for eventually calling CoUninitialize() when done.
         return pDefaultDevice;
     }
 
     /**
      * @brief Retrieves the system's current default audio input (capture) device.
      *
-     * This function uses the Windows Core Audio API to query the default audio endpoint
-     * for the `eCapture` data flow and the `eConsole` role.
-     *
-     * It safely initializes COM for the current thread if needed, and uninitializes it
-     * after the operation. If the caller already initialized COM, this will still work safely.
+     * This function asks the installed backend (Core Audio on Windows) for the default
+     * audio endpoint of the `eCapture` data flow and the `eConsole` role.
      *
      * @note Caller is responsible for releasing the returned IMMDevice pointer using `SafeRelease`.
      *
@@ -172,37 +145,11 @@ namespace Utility
      */
     IMMDevice *GetDefaultAudioInputDevice()
     {
-        // Initialize COM for this thread if not already initialized.
-        // bool comInitialized = SUCCEEDED(CoInitialize(nullptr));
-
-        IMMDeviceEnumerator *pEnum = nullptr;
         IMMDevice *pDefaultDevice = nullptr;
 
-        // Create the device enumerator COM object.
-        HRESULT hr = CoCreateInstance(
-            __uuidof(MMDeviceEnumerator),
-            nullptr,
-            CLSCTX_ALL,
-            __uuidof(IMMDeviceEnumerator),
-            (void **)&pEnum);
-
-        if (FAILED(hr) || !pEnum)
-        {
-            // if (comInitialized)
-            //     CoUninitialize();
+        // Default input device: capture, console role
+        if (FAILED(Backend::GetAudioBackend()->getDefaultDevice(eCapture, eConsole, &pDefaultDevice)))
             return nullptr;
-        }
-
-        // Retrieve the default input device (capture, console role).
-        hr = pEnum->GetDefaultAudioEndpoint(eCapture, eConsole, &pDefaultDevice);
-        SafeRelease(pEnum);
-
-        if (FAILED(hr))
-        {
-            // if (comInitialized)
-            //     CoUninitialize();
-            return nullptr;
-        }
 
         return pDefaultDevice;
     }
@@ -210,8 +157,8 @@ namespace Utility
     /**
      * @brief Sets the mute state for the default audio playback device.
      *
-     * This function retrieves the default audio playback device, activates its endpoint volume interface,
-     * and sets the mute state according to the specified parameter. All resources are properly released
+     * This function retrieves the default audio playback device and sets its mute state through
+     * MuteDevice() according to the specified parameter. All resources are properly released
      * before returning.
      *
      * @param mute Boolean value indicating the desired mute state:
@@ -224,6 +171,7 @@ namespace Utility
      * @warning This function should be called from a thread initialized for COM if using COM apartment threading.
      *
      * @see GetDefaultAudioPlaybackDevice()
+     * @see MuteDevice()
      */
     bool SetDefaultPlaybackDeviceMute(bool mute)
     {
@@ -232,32 +180,17 @@ namespace Utility
         if (!device)
             return false;
 
-        // Activate endpoint volume interface
-        IAudioEndpointVolume *endpointVolume = nullptr;
-        HRESULT hr = device->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_ALL, nullptr, (void **)&endpointVolume);
-        if (FAILED(hr) || !endpointVolume)
-        {
-            device->Release();
-            return false;
-        }
-
-        // Set the mute state
-        hr = endpointVolume->SetMute(mute ? TRUE : FALSE, nullptr);
-
-        // Clean up resources
-        // endpointVolume->Release();
-        // device->Release();
-        SafeRelease(endpointVolume);
+        const bool ok = MuteDevice(device, mute);
         SafeRelease(device);
 
-        return SUCCEEDED(hr);
+        return ok;
     }
 
     /**
      * @brief Sets the mute state for the default audio input (capture) device.
      *
-     * This function retrieves the default audio input device, activates its endpoint volume interface,
-     * and sets the mute state according to the specified parameter. All resources are properly released
+     * This function retrieves the default audio input device and sets its mute state through
+     * MuteDevice() according to the specified parameter. All resources are properly released
      * before returning.
      *
      * @param mute Boolean value indicating the desired mute state:
@@ -268,6 +201,7 @@ namespace Utility
      *
      * @note Caller must ensure COM is initialized for the current thread.
      * @see GetDefaultAudioInputDevice()
+     * @see MuteDevice()
      */
     bool SetDefaultInputDeviceMute(bool mute)
     {
@@ -276,37 +210,18 @@ namespace Utility
         if (!device)
             return false;
 
-        IAudioEndpointVolume *endpointVolume = nullptr;
-
-        // Activate endpoint volume interface on input device
-        HRESULT hr = device->Activate(
-            __uuidof(IAudioEndpointVolume),
-            CLSCTX_ALL,
-            nullptr,
-            (void **)&endpointVolume);
-
-        if (FAILED(hr) || !endpointVolume)
-        {
-            SafeRelease(device);
-            return false;
-        }
-
-        // Set mute or unmute
-        hr = endpointVolume->SetMute(mute ? TRUE : FALSE, nullptr);
-
-        // Clean up
-        SafeRelease(endpointVolume);
+        const bool ok = MuteDevice(device, mute);
         SafeRelease(device);
 
-        return SUCCEEDED(hr);
+        return ok;
     }
 
     /**
      * @brief Mutes or unmutes a specific audio device.
      *
-     * This function controls the mute state of a given audio device by activating its
-     * endpoint volume interface. The function handles COM interface activation safely
-     * and includes exception handling to prevent resource leaks.
+     * This function controls the mute state of a given audio device through the installed
+     * backend (on Windows by activating its endpoint volume interface) and includes
+     * exception handling so a throwing backend never escapes.
      *
      * @param[in] device Pointer to the IMMDevice interface of the audio device to control.
      *                   Must not be nullptr.
@@ -318,15 +233,12 @@ namespace Utility
      *                   - true: mute operation succeeded
      *                   - false: operation failed (invalid device, COM failure, etc.)
      *
-     * @note The function uses RAII-style cleanup (SafeRelease) to ensure COM interfaces
-     *       are properly released in all execution paths.
      * @warning The caller must ensure the IMMDevice pointer is valid for the duration
      *          of this call. This function does not take ownership of the device pointer.
      * @warning Requires COM initialization on the calling thread.
      *
      * @see IMMDevice
      * @see IAudioEndpointVolume
-     * @see SafeRelease
      */
     bool MuteDevice(IMMDevice *device, bool mute)
     {
@@ -334,32 +246,12 @@ namespace Utility
         if (!device)
             return false;
 
-        IAudioEndpointVolume *endpointVolume = nullptr;
-
         try
         {
-            // Activate the IAudioEndpointVolume interface from the device
-            HRESULT hr = device->Activate(
-                __uuidof(IAudioEndpointVolume),
-                CLSCTX_ALL,
-                nullptr,
-                reinterpret_cast<void **>(&endpointVolume));
-
-            // Check for activation failure
-            if (FAILED(hr) || !endpointVolume)
-                return false;
-
-            // Set the desired mute state (TRUE/FALSE for COM compatibility)
-            hr = endpointVolume->SetMute(mute ? TRUE : FALSE, nullptr);
-
-            // Clean up and return result
-            SafeRelease(endpointVolume);
-            return SUCCEEDED(hr);
+            return SUCCEEDED(Backend::GetAudioBackend()->setMute(device, mute));
         }
         catch (...)
         {
-            // Handle any exceptions and clean up
-            SafeRelease(endpointVolume);
             return false;
         }
     }
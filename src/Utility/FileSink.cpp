@@ -0,0 +1,139 @@
+#include "Utility/FileSink.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace Utility
+{
+    /**
+     * @brief Destructor - closes the file.
+     */
+    StdioFileSink::~StdioFileSink()
+    {
+        close();
+    }
+
+    /**
+     * @brief Creates the file with stdio buffering disabled.
+     *
+     * Callers write large blocks, so the stdio buffer would only add a copy.
+     *
+     * @param path File path.
+     * @return true on success.
+     */
+    bool StdioFileSink::open(const std::filesystem::path &path)
+    {
+        close();
+
+#if defined(_WIN32)
+        m_file = _wfopen(path.c_str(), L"wb");
+#else
+        m_file = std::fopen(path.c_str(), "wb");
+#endif
+        if (!m_file)
+            return false;
+
+        std::setvbuf(m_file, nullptr, _IONBF, 0);
+        m_end = 0;
+        return true;
+    }
+
+    /**
+     * @brief Positions the stream at a 64-bit offset.
+     */
+    bool StdioFileSink::seek(uint64_t offset)
+    {
+#if defined(_WIN32)
+        return _fseeki64(m_file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+        return fseeko(m_file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+
+    /**
+     * @brief Appends bytes at the end of the file.
+     *
+     * @param data Bytes.
+     * @param bytes Count.
+     * @return true if everything was written.
+     */
+    bool StdioFileSink::write(const void *data, size_t bytes)
+    {
+        if (!m_file || !seek(m_end))
+            return false;
+
+        const size_t written = std::fwrite(data, 1, bytes, m_file);
+        m_end += written;
+        return written == bytes;
+    }
+
+    /**
+     * @brief Overwrites bytes at an offset; the append position is unchanged.
+     *
+     * @param offset Absolute offset.
+     * @param data Bytes.
+     * @param bytes Count.
+     * @return true if everything was written.
+     */
+    bool StdioFileSink::writeAt(uint64_t offset, const void *data, size_t bytes)
+    {
+        if (!m_file || !seek(offset))
+            return false;
+
+        const size_t written = std::fwrite(data, 1, bytes, m_file);
+        if (offset + written > m_end)
+            m_end = offset + written;
+        return written == bytes;
+    }
+
+    /**
+     * @brief Flushes the stream, optionally forcing it to disk.
+     *
+     * @param durable Also commit to stable storage (_commit / fsync).
+     * @return true on success.
+     */
+    bool StdioFileSink::flush(bool durable)
+    {
+        if (!m_file || std::fflush(m_file) != 0)
+            return false;
+
+        if (!durable)
+            return true;
+
+#if defined(_WIN32)
+        return _commit(_fileno(m_file)) == 0;
+#else
+        return fsync(fileno(m_file)) == 0;
+#endif
+    }
+
+    /**
+     * @brief Closes the file.
+     */
+    void StdioFileSink::close()
+    {
+        if (m_file)
+        {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+    }
+
+    /**
+     * @brief Creates and opens a StdioFileSink.
+     *
+     * @param path File path.
+     * @return std::unique_ptr<IFileSink> The sink, or nullptr on failure.
+     */
+    std::unique_ptr<IFileSink> CreateFileSink(const std::filesystem::path &path)
+    {
+        auto sink = std::make_unique<StdioFileSink>();
+        if (!sink->open(path))
+            return nullptr;
+        return sink;
+    }
+}
@@ -0,0 +1,308 @@
+#include "Utility/Instrumentation.h"
+
+#if defined(AUDIO_SWITCHER_INSTRUMENTATION) && AUDIO_SWITCHER_INSTRUMENTATION
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#endif
+
+namespace Utility
+{
+#if defined(AUDIO_SWITCHER_INSTRUMENTATION) && AUDIO_SWITCHER_INSTRUMENTATION
+    namespace
+    {
+        constexpr uint32_t kMaxOperations = 64;
+        constexpr uint32_t kSubBits = 3;                  ///< 8 sub-buckets per power of two (±6%)
+        constexpr uint32_t kSubBuckets = 1u << kSubBits;
+        constexpr uint32_t kLinearLimit = 2 * kSubBuckets; ///< Values below are counted exactly
+        constexpr uint32_t kBuckets = kLinearLimit + (64 - (kSubBits + 1)) * kSubBuckets;
+
+        /**
+         * @brief Log-linear (HDR-style) histogram written by a single thread.
+         *
+         * The owner updates with relaxed load + store (no read-modify-write); readers
+         * merge with relaxed loads and may see a sample half-recorded, which only
+         * skews a snapshot by one sample.
+         */
+        struct Histogram
+        {
+            std::atomic<uint64_t> sum{0};
+            std::atomic<uint64_t> max{0};
+            std::array<std::atomic<uint64_t>, kBuckets> buckets{};
+        };
+
+        uint32_t BucketIndex(uint64_t value)
+        {
+            if (value < kLinearLimit)
+                return static_cast<uint32_t>(value);
+
+            uint32_t exponent = 63;
+            while ((value >> exponent) == 0)
+                --exponent;
+
+            const uint32_t sub = static_cast<uint32_t>(value >> (exponent - kSubBits)) & (kSubBuckets - 1);
+            return kLinearLimit + (exponent - (kSubBits + 1)) * kSubBuckets + sub;
+        }
+
+        double BucketMidpoint(uint32_t index)
+        {
+            if (index < kLinearLimit)
+                return static_cast<double>(index);
+
+            const uint32_t exponent = (index - kLinearLimit) / kSubBuckets + (kSubBits + 1);
+            const uint32_t sub = (index - kLinearLimit) % kSubBuckets;
+            const double width = static_cast<double>(1ull << (exponent - kSubBits));
+            return static_cast<double>(kSubBuckets + sub) * width + width * 0.5;
+        }
+
+        void Bump(std::atomic<uint64_t> &value, uint64_t amount)
+        {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Histograms of one thread, allocated per operation on first use.
+         */
+        struct ThreadBlock
+        {
+            std::array<std::atomic<Histogram *>, kMaxOperations> histograms{};
+            std::atomic<bool> inUse{true};
+        };
+
+        /**
+         * @brief Operation names and every thread block ever handed out.
+         *
+         * Blocks of exited threads keep their samples and are reused by new threads,
+         * so the number of blocks is bounded by the peak number of concurrent threads.
+         */
+        struct Registry
+        {
+            std::mutex mutex;
+            std::array<std::string, kMaxOperations> names;
+            std::atomic<uint32_t> operationCount{0};
+            std::vector<std::unique_ptr<ThreadBlock>> blocks;
+            std::vector<std::unique_ptr<Histogram>> histograms;
+        };
+
+        Registry &GetRegistry()
+        {
+            // Never destroyed: threads may record during static destruction
+            static Registry *registry = new Registry();
+            return *registry;
+        }
+
+        /**
+         * @brief Thread-local lease on a block, returned for reuse at thread exit.
+         */
+        struct BlockLease
+        {
+            ThreadBlock *block = nullptr;
+
+            ~BlockLease()
+            {
+                if (block)
+                    block->inUse.store(false, std::memory_order_release);
+            }
+        };
+
+        ThreadBlock &CurrentBlock()
+        {
+            thread_local BlockLease lease;
+            if (lease.block)
+                return *lease.block;
+
+            Registry &registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (const std::unique_ptr<ThreadBlock> &block : registry.blocks)
+            {
+                if (!block->inUse.load(std::memory_order_acquire))
+                {
+                    block->inUse.store(true, std::memory_order_relaxed);
+                    lease.block = block.get();
+                    return *lease.block;
+                }
+            }
+
+            registry.blocks.push_back(std::make_unique<ThreadBlock>());
+            lease.block = registry.blocks.back().get();
+            return *lease.block;
+        }
+    }
+
+    /**
+     * @brief Instrumentation is compiled in.
+     */
+    bool InstrumentationEnabled()
+    {
+        return true;
+    }
+
+    /**
+     * @brief Looks a name up, adding it if new.
+     *
+     * @param name Operation name (copied).
+     * @return uint32_t Operation ID.
+     */
+    uint32_t RegisterTimedOperation(const char *name)
+    {
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        const uint32_t count = registry.operationCount.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < count; ++i)
+            if (registry.names[i] == name)
+                return i;
+
+        if (count == kMaxOperations)
+            return kMaxOperations - 1;
+
+        registry.names[count] = name;
+        registry.operationCount.store(count + 1, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Adds a sample to the calling thread's histogram.
+     *
+     * The first sample of an operation on a thread allocates its histogram (under the
+     * registry lock); every later one is a handful of relaxed stores.
+     *
+     * @param operation Operation ID.
+     * @param nanoseconds Duration.
+     */
+    void RecordTimedOperation(uint32_t operation, uint64_t nanoseconds)
+    {
+        if (operation >= kMaxOperations)
+            return;
+
+        ThreadBlock &block = CurrentBlock();
+        Histogram *histogram = block.histograms[operation].load(std::memory_order_acquire);
+        if (!histogram)
+        {
+            Registry &registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.histograms.push_back(std::make_unique<Histogram>());
+            histogram = registry.histograms.back().get();
+            block.histograms[operation].store(histogram, std::memory_order_release);
+        }
+
+        Bump(histogram->buckets[BucketIndex(nanoseconds)], 1);
+        Bump(histogram->sum, nanoseconds);
+        if (nanoseconds > histogram->max.load(std::memory_order_relaxed))
+            histogram->max.store(nanoseconds, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sums the histograms of every thread block per operation.
+     *
+     * @return std::vector<OperationStats> One entry per operation with samples.
+     */
+    std::vector<OperationStats> GetInstrumentationSnapshot()
+    {
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        std::vector<OperationStats> result;
+        std::array<uint64_t, kBuckets> merged;
+        const uint32_t operations = registry.operationCount.load(std::memory_order_acquire);
+
+        for (uint32_t op = 0; op < operations; ++op)
+        {
+            merged.fill(0);
+            uint64_t count = 0, sum = 0, max = 0;
+
+            for (const std::unique_ptr<ThreadBlock> &block : registry.blocks)
+            {
+                const Histogram *histogram = block->histograms[op].load(std::memory_order_acquire);
+                if (!histogram)
+                    continue;
+
+                for (uint32_t b = 0; b < kBuckets; ++b)
+                    merged[b] += histogram->buckets[b].load(std::memory_order_relaxed);
+                sum += histogram->sum.load(std::memory_order_relaxed);
+                const uint64_t threadMax = histogram->max.load(std::memory_order_relaxed);
+                max = threadMax > max ? threadMax : max;
+            }
+
+            for (uint64_t n : merged)
+                count += n;
+            if (count == 0)
+                continue;
+
+            OperationStats stats;
+            stats.name = registry.names[op];
+            stats.count = count;
+            stats.meanUs = static_cast<double>(sum) / static_cast<double>(count) / 1000.0;
+            stats.maxUs = static_cast<double>(max) / 1000.0;
+
+            // Percentiles from the merged buckets (nearest rank)
+            const uint64_t rank50 = (count + 1) / 2;
+            const uint64_t rank99 = count - count / 100;
+            uint64_t seen = 0;
+            bool have50 = false;
+            for (uint32_t b = 0; b < kBuckets; ++b)
+            {
+                seen += merged[b];
+                if (!have50 && seen >= rank50)
+                {
+                    stats.p50Us = BucketMidpoint(b) / 1000.0;
+                    have50 = true;
+                }
+                if (seen >= rank99)
+                {
+                    stats.p99Us = BucketMidpoint(b) / 1000.0;
+                    break;
+                }
+            }
+
+            // A midpoint can overshoot the largest sample
+            stats.p50Us = stats.p50Us < stats.maxUs ? stats.p50Us : stats.maxUs;
+            stats.p99Us = stats.p99Us < stats.maxUs ? stats.p99Us : stats.maxUs;
+            result.push_back(stats);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Zeroes every histogram.
+     */
+    void ResetInstrumentation()
+    {
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        for (const std::unique_ptr<Histogram> &histogram : registry.histograms)
+        {
+            for (std::atomic<uint64_t> &bucket : histogram->buckets)
+                bucket.store(0, std::memory_order_relaxed);
+            histogram->sum.store(0, std::memory_order_relaxed);
+            histogram->max.store(0, std::memory_order_relaxed);
+        }
+    }
+#else
+    bool InstrumentationEnabled()
+    {
+        return false;
+    }
+
+    uint32_t RegisterTimedOperation(const char *)
+    {
+        return 0;
+    }
+
+    void RecordTimedOperation(uint32_t, uint64_t)
+    {
+    }
+
+    std::vector<OperationStats> GetInstrumentationSnapshot()
+    {
+        return {};
+    }
+
+    void ResetInstrumentation()
+    {
+    }
+#endif
+}
@@ -0,0 +1,104 @@
+#include "Utility/MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Utility
+{
+    /**
+     * @brief Destructor - unmaps the file.
+     */
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    /**
+     * @brief Maps the whole file read-only with a sequential access hint.
+     *
+     * The file handle is closed once the mapping exists; the mapping keeps the file open.
+     *
+     * @param path File path.
+     * @return true on success, false if the file cannot be opened, is empty or cannot be mapped.
+     */
+    bool MappedFile::open(const std::filesystem::path &path)
+    {
+        close();
+
+#if defined(_WIN32)
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size = {};
+        if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping)
+            return false;
+
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        m_mapping = mapping;
+        m_data = static_cast<const uint8_t *>(view);
+        m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info = {};
+        if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+            return false;
+
+        madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+        m_data = static_cast<const uint8_t *>(view);
+        m_size = static_cast<uint64_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    /**
+     * @brief Releases the view and the mapping.
+     */
+    void MappedFile::close()
+    {
+        if (!m_data)
+            return;
+
+#if defined(_WIN32)
+        UnmapViewOfFile(m_data);
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+#else
+        munmap(const_cast<uint8_t *>(m_data), static_cast<size_t>(m_size));
+#endif
+        m_data = nullptr;
+        m_size = 0;
+        m_mapping = nullptr;
+    }
+}
@@ -0,0 +1,171 @@
+#include "Utility/StringConvert.h"
+
+#include <cstdint>
+
+namespace Utility
+{
+    namespace
+    {
+        constexpr char32_t kReplacement = 0xFFFD;
+        constexpr bool kWideIsUtf16 = sizeof(wchar_t) == 2;
+
+        void AppendUtf8(std::string &out, char32_t cp)
+        {
+            if (cp < 0x80)
+            {
+                out.push_back(static_cast<char>(cp));
+            }
+            else if (cp < 0x800)
+            {
+                out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+            else if (cp < 0x10000)
+            {
+                out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+        }
+
+        void AppendWide(std::wstring &out, char32_t cp)
+        {
+            if (kWideIsUtf16 && cp >= 0x10000)
+            {
+                cp -= 0x10000;
+                out.push_back(static_cast<wchar_t>(0xD800 + (cp >> 10)));
+                out.push_back(static_cast<wchar_t>(0xDC00 + (cp & 0x3FF)));
+            }
+            else
+            {
+                out.push_back(static_cast<wchar_t>(cp));
+            }
+        }
+
+        bool IsSurrogate(char32_t cp)
+        {
+            return cp >= 0xD800 && cp <= 0xDFFF;
+        }
+    }
+
+    /**
+     * @brief Encodes a wide string as UTF-8.
+     *
+     * ASCII runs are copied directly; everything else goes through a code point.
+     *
+     * @param text Wide text.
+     * @return std::string UTF-8 bytes.
+     */
+    std::string ToUtf8(const std::wstring &text)
+    {
+        std::string out;
+        out.reserve(text.size());
+
+        const size_t n = text.size();
+        for (size_t i = 0; i < n; ++i)
+        {
+            char32_t cp = static_cast<char32_t>(text[i]);
+            if (cp < 0x80)
+            {
+                out.push_back(static_cast<char>(cp));
+                continue;
+            }
+
+            if (kWideIsUtf16 && cp >= 0xD800 && cp <= 0xDBFF && i + 1 < n)
+            {
+                const char32_t low = static_cast<char32_t>(text[i + 1]);
+                if (low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    ++i;
+                }
+            }
+            if (IsSurrogate(cp) || cp > 0x10FFFF)
+                cp = kReplacement;
+
+            AppendUtf8(out, cp);
+        }
+
+        return out;
+    }
+
+    /**
+     * @brief Decodes UTF-8 into a wide string.
+     *
+     * Each malformed sequence yields one U+FFFD and decoding resumes at the next byte
+     * that can start a sequence.
+     *
+     * @param text UTF-8 bytes.
+     * @return std::wstring Wide text.
+     */
+    std::wstring FromUtf8(const std::string &text)
+    {
+        std::wstring out;
+        out.reserve(text.size());
+
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(text.data());
+        const size_t n = text.size();
+        size_t i = 0;
+
+        while (i < n)
+        {
+            const unsigned char lead = p[i];
+            if (lead < 0x80)
+            {
+                out.push_back(static_cast<wchar_t>(lead));
+                ++i;
+                continue;
+            }
+
+            size_t length = 0;
+            char32_t cp = 0;
+            char32_t minimum = 0;
+            if ((lead & 0xE0) == 0xC0)
+            {
+                length = 2;
+                cp = lead & 0x1F;
+                minimum = 0x80;
+            }
+            else if ((lead & 0xF0) == 0xE0)
+            {
+                length = 3;
+                cp = lead & 0x0F;
+                minimum = 0x800;
+            }
+            else if ((lead & 0xF8) == 0xF0)
+            {
+                length = 4;
+                cp = lead & 0x07;
+                minimum = 0x10000;
+            }
+
+            size_t consumed = 1;
+            bool valid = length != 0;
+            while (valid && consumed < length)
+            {
+                if (i + consumed >= n || (p[i + consumed] & 0xC0) != 0x80)
+                {
+                    valid = false;
+                    break;
+                }
+                cp = (cp << 6) | (p[i + consumed] & 0x3F);
+                ++consumed;
+            }
+
+            if (!valid || cp < minimum || cp > 0x10FFFF || IsSurrogate(cp))
+                cp = kReplacement;
+
+            AppendWide(out, cp);
+            i += consumed;
+        }
+
+        return out;
+    }
+}
@@ -0,0 +1,119 @@
+#include "UnitTest.h"
+#include "Streaming/AutoMuteController.h"
+#include "Utility/SafeRelease.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Streaming;
+
+namespace
+{
+    constexpr uint32_t kRate = 16000;
+
+    /**
+     * @brief Silent mono float source that claims to be captured from `endpoint`.
+     */
+    class SilentSource : public IAudioSource
+    {
+    public:
+        explicit SilentSource(std::wstring endpoint = std::wstring()) : m_endpoint(std::move(endpoint))
+        {
+            m_format.sampleRate = kRate;
+            m_format.channels = 1;
+            m_format.bitDepth = 32;
+            m_format.blockAlign = 4;
+            m_format.channelMask = 0x4;
+            m_format.isFloat = true;
+            m_format.valid = true;
+        }
+
+        const Utility::DeviceFormatInfo &format() const override { return m_format; }
+
+        size_t read(void *dst, size_t maxFrames) override
+        {
+            const size_t frames = std::min(maxFrames, m_available);
+            std::memset(dst, 0, frames * m_format.blockAlign);
+            m_available -= frames;
+            return frames;
+        }
+
+        std::wstring endpointId() const override { return m_endpoint; }
+
+        void feed(size_t frames) { m_available += frames; }
+
+    private:
+        Utility::DeviceFormatInfo m_format;
+        std::wstring m_endpoint;
+        size_t m_available = 0;
+    };
+
+    IMMDevice *Device(const std::wstring &id)
+    {
+        IMMDevice *device = nullptr;
+        REQUIRE(SUCCEEDED(UnitTest::Simulated()->getDevice(id, &device)) && device);
+        return device;
+    }
+}
+
+TEST_CASE(AutoMuteController, RefusesASourceCapturedFromTheMutedEndpoint)
+{
+    const auto simulated = UnitTest::Simulated();
+    const std::wstring mic = simulated->deviceIds(eCapture).front();
+    IMMDevice *endpoint = Device(mic);
+
+    SilentSource ownMic(mic);
+    AutoMuteController controller;
+    CHECK(!controller.open(&ownMic, endpoint));
+    CHECK(!controller.isOpen());
+    CHECK(!simulated->isMuted(mic));
+    CHECK_EQ(controller.transitions(), 0u);
+
+    Utility::SafeRelease(endpoint);
+}
+
+TEST_CASE(AutoMuteController, MutesAnotherEndpointOnSilence)
+{
+    const auto simulated = UnitTest::Simulated();
+    const std::vector<std::wstring> captures = simulated->deviceIds(eCapture);
+    REQUIRE(captures.size() >= 2u);
+    IMMDevice *endpoint = Device(captures[0]);
+
+    // A second microphone, and a source that does not know its endpoint
+    for (const std::wstring &sensed : {captures[1], std::wstring()})
+    {
+        SilentSource sensor(sensed);
+        AutoMuteController controller;
+        REQUIRE(controller.open(&sensor, endpoint));
+        CHECK(controller.isMuted());
+        CHECK(simulated->isMuted(captures[0]));
+
+        sensor.feed(kRate);
+        CHECK_EQ(controller.pump(), static_cast<size_t>(kRate));
+        CHECK(controller.isMuted());
+        CHECK_EQ(controller.transitions(), 1u);
+        CHECK_EQ(controller.failures(), 0u);
+
+        controller.close();
+        REQUIRE(simulated->setMute(endpoint, false) == S_OK);
+    }
+
+    Utility::SafeRelease(endpoint);
+}
+
+TEST_CASE(AutoMuteController, HandlerGatesTheSensedStream)
+{
+    // The supported way to auto-mute the microphone being listened to
+    SilentSource mic(UnitTest::Simulated()->deviceIds(eCapture).front());
+    bool gated = false;
+    AutoMuteController controller;
+    REQUIRE(controller.open(&mic, [&](bool mute)
+                            {
+                                gated = mute;
+                                return true; }));
+    CHECK(gated);
+    CHECK(!UnitTest::Simulated()->isMuted(mic.endpointId()));
+}
@@ -0,0 +1,148 @@
+#include "UnitTest.h"
+#include "Dsp/ChannelLayout.h"
+#include "Dsp/ChannelMatrix.h"
+
+#include <vector>
+
+using namespace Dsp;
+
+namespace
+{
+    constexpr float kMinus3dB = 0.70710678f;
+    constexpr float kTolerance = 1e-6f;
+}
+
+TEST_CASE(ChannelMatrix, RejectsEmptyLayouts)
+{
+    ChannelMatrix matrix;
+    CHECK(!matrix.build(0, Layout::Stereo));
+    CHECK(!matrix.build(Layout::Stereo, 0));
+    CHECK(!matrix.isValid());
+}
+
+TEST_CASE(ChannelMatrix, SameLayoutIsIdentity)
+{
+    ChannelMatrix matrix;
+    REQUIRE(matrix.build(Layout::FivePointOne, Layout::FivePointOne));
+    CHECK(matrix.isIdentity());
+    for (uint32_t d = 0; d < 6; ++d)
+    {
+        for (uint32_t s = 0; s < 6; ++s)
+            CHECK_EQ(matrix.coefficient(d, s), d == s ? 1.0f : 0.0f);
+    }
+}
+
+TEST_CASE(ChannelMatrix, MonoSpreadsToStereoAtMinus3dB)
+{
+    ChannelMatrix matrix;
+    REQUIRE(matrix.build(Layout::Mono, Layout::Stereo));
+    CHECK_EQ(matrix.srcChannels(), 1u);
+    CHECK_EQ(matrix.dstChannels(), 2u);
+    CHECK_NEAR(matrix.coefficient(0, 0), kMinus3dB, kTolerance);
+    CHECK_NEAR(matrix.coefficient(1, 0), kMinus3dB, kTolerance);
+}
+
+TEST_CASE(ChannelMatrix, StereoFoldsToMonoCenter)
+{
+    ChannelMatrix matrix;
+    REQUIRE(matrix.build(Layout::Stereo, Layout::Mono, false));
+    CHECK_NEAR(matrix.coefficient(0, 0), kMinus3dB, kTolerance);
+    CHECK_NEAR(matrix.coefficient(0, 1), kMinus3dB, kTolerance);
+}
+
+TEST_CASE(ChannelMatrix, FivePointOneToStereoDownmix)
+{
+    // Source order: FL FR FC LFE BL BR
+    ChannelMatrix raw;
+    REQUIRE(raw.build(Layout::FivePointOne, Layout::Stereo, false));
+    const float left[] = {1.0f, 0.0f, kMinus3dB, 0.0f, kMinus3dB, 0.0f};
+    const float right[] = {0.0f, 1.0f, kMinus3dB, 0.0f, 0.0f, kMinus3dB};
+    for (uint32_t s = 0; s < 6; ++s)
+    {
+        CHECK_NEAR(raw.coefficient(0, s), left[s], kTolerance);
+        CHECK_NEAR(raw.coefficient(1, s), right[s], kTolerance);
+    }
+
+    // Normalised: the largest row sums to exactly 1, balance unchanged
+    ChannelMatrix normalized;
+    REQUIRE(normalized.build(Layout::FivePointOne, Layout::Stereo));
+    const float rowSum = 1.0f + 2.0f * kMinus3dB;
+    float sum = 0.0f;
+    for (uint32_t s = 0; s < 6; ++s)
+    {
+        CHECK_NEAR(normalized.coefficient(0, s), left[s] / rowSum, kTolerance);
+        sum += normalized.coefficient(0, s);
+    }
+    CHECK_NEAR(sum, 1.0f, kTolerance);
+}
+
+TEST_CASE(ChannelMatrix, LfeFoldsOnlyWhenRequested)
+{
+    ChannelMatrix matrix;
+    REQUIRE(matrix.build(Layout::FivePointOne, Layout::Stereo, false, 0.5f));
+    CHECK_NEAR(matrix.coefficient(0, 3), 0.5f, kTolerance);
+    CHECK_NEAR(matrix.coefficient(1, 3), 0.5f, kTolerance);
+
+    // A destination with an LFE channel keeps it discrete whatever the gain
+    REQUIRE(matrix.build(Layout::SevenPointOneSurround, Layout::FivePointOne, false, 0.5f));
+    CHECK_NEAR(matrix.coefficient(3, 3), 1.0f, kTolerance);
+    CHECK_NEAR(matrix.coefficient(0, 3), 0.0f, kTolerance);
+}
+
+TEST_CASE(ChannelMatrix, SideAndBackSwapWithoutLoss)
+{
+    // 7.1 surround (FL FR FC LFE BL BR SL SR) into 5.1 (FL FR FC LFE BL BR): sides join the backs
+    ChannelMatrix matrix;
+    REQUIRE(matrix.build(Layout::SevenPointOneSurround, Layout::FivePointOne, false));
+    CHECK_NEAR(matrix.coefficient(4, 4), 1.0f, kTolerance);
+    CHECK_NEAR(matrix.coefficient(4, 6), 1.0f, kTolerance);
+    CHECK_NEAR(matrix.coefficient(5, 5), 1.0f, kTolerance);
+    CHECK_NEAR(matrix.coefficient(5, 7), 1.0f, kTolerance);
+
+    // 5.1 into 5.1 surround: backs become sides
+    REQUIRE(matrix.build(Layout::FivePointOne, Layout::FivePointOneSurround, false));
+    CHECK_NEAR(matrix.coefficient(4, 4), 1.0f, kTolerance);
+    CHECK_NEAR(matrix.coefficient(5, 5), 1.0f, kTolerance);
+}
+
+TEST_CASE(ChannelMatrix, UpmixLeavesExtraSpeakersSilent)
+{
+    ChannelMatrix matrix;
+    REQUIRE(matrix.build(Layout::Stereo, Layout::FivePointOne));
+    CHECK_EQ(matrix.coefficient(0, 0), 1.0f);
+    CHECK_EQ(matrix.coefficient(1, 1), 1.0f);
+    for (uint32_t d = 2; d < 6; ++d)
+    {
+        CHECK_EQ(matrix.coefficient(d, 0), 0.0f);
+        CHECK_EQ(matrix.coefficient(d, 1), 0.0f);
+    }
+}
+
+TEST_CASE(ChannelMatrix, ProcessMatchesCoefficients)
+{
+    // Every speaker position into stereo, over more frames than one internal block
+    const uint32_t allSpeakers = 0x3ffff;
+    ChannelMatrix matrix;
+    REQUIRE(matrix.build(allSpeakers, Layout::Stereo));
+    const uint32_t src = matrix.srcChannels();
+    const uint32_t dst = matrix.dstChannels();
+    REQUIRE(src == 18 && dst == 2);
+
+    const size_t frames = ChannelMatrix::BlockFrames * 2 + 37;
+    std::vector<float> in(frames * src);
+    for (size_t i = 0; i < in.size(); ++i)
+        in[i] = static_cast<float>((i * 7919) % 2001) / 1000.0f - 1.0f;
+    std::vector<float> out(frames * dst, -9.0f);
+    matrix.process(in.data(), out.data(), frames);
+
+    for (size_t f = 0; f < frames; ++f)
+    {
+        for (uint32_t d = 0; d < dst; ++d)
+        {
+            double expected = 0.0;
+            for (uint32_t s = 0; s < src; ++s)
+                expected += static_cast<double>(matrix.coefficient(d, s)) * in[f * src + s];
+            CHECK_NEAR(out[f * dst + d], expected, 1e-5);
+        }
+    }
+}
@@ -0,0 +1,205 @@
+#include "UnitTest.h"
+#include "Devices/DeviceStateTracker.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Devices;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    DevicePredicate Plugged(const std::wstring &id)
+    {
+        return [id](const DeviceRecord &device)
+        { return device.id == id && device.state == DEVICE_STATE_ACTIVE; };
+    }
+
+    /**
+     * @brief Runs `script` on another thread after `delayMs`, joined on destruction.
+     */
+    class Later
+    {
+    public:
+        template <typename Script>
+        Later(int delayMs, Script script)
+            : m_thread([delayMs, script]
+                       {
+                           std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+                           script(); })
+        {
+        }
+        ~Later() { m_thread.join(); }
+
+        // Owns a thread: not copyable
+        Later(const Later &) = delete;
+        Later &operator=(const Later &) = delete;
+
+    private:
+        std::thread m_thread;
+    };
+}
+
+TEST_CASE(DeviceStateTracker, StartEnumeratesEveryStateOnce)
+{
+    const auto simulated = UnitTest::Simulated();
+    const std::wstring jack = simulated->addDevice(eRender, L"Line Out (Rear Jack)");
+    REQUIRE(simulated->setDeviceState(jack, DEVICE_STATE_UNPLUGGED));
+
+    DeviceStateTracker tracker;
+    REQUIRE(tracker.start() == S_OK);
+
+    const std::vector<DeviceRecord> devices = tracker.devices();
+    // deviceIds() lists every endpoint that is not removed, the unplugged jack included
+    CHECK_EQ(devices.size(), simulated->deviceIds(eRender).size() + simulated->deviceIds(eCapture).size());
+    for (size_t i = 1; i < devices.size(); ++i)
+        CHECK(devices[i - 1].flow <= devices[i].flow); // Render first
+
+    DeviceRecord record;
+    REQUIRE(tracker.find(jack, record));
+    CHECK(record.name == L"Line Out (Rear Jack)");
+    CHECK_EQ(record.state, static_cast<uint32_t>(DEVICE_STATE_UNPLUGGED));
+    REQUIRE(tracker.find(simulated->defaultDeviceId(eCapture, eConsole), record));
+    CHECK(record.isDefault);
+    CHECK(record.flow == DeviceFlow::Capture);
+
+    CHECK_EQ(tracker.stats().enumerations, 1u);
+    tracker.stop();
+    CHECK(tracker.devices().empty());
+}
+
+TEST_CASE(DeviceStateTracker, PlugAndUnplugAreAppliedInPlace)
+{
+    const auto simulated = UnitTest::Simulated();
+    const std::wstring jack = simulated->addDevice(eRender, L"Line Out (Rear Jack)");
+
+    DeviceStateTracker tracker;
+    REQUIRE(tracker.start(DEVICE_STATE_ACTIVE) == S_OK);
+    const size_t active = tracker.devices().size();
+
+    REQUIRE(simulated->setDeviceState(jack, DEVICE_STATE_UNPLUGGED));
+    DeviceRecord record;
+    CHECK(!tracker.find(jack, record));
+    CHECK_EQ(tracker.devices().size(), active - 1);
+
+    REQUIRE(simulated->setDeviceState(jack, DEVICE_STATE_ACTIVE));
+    REQUIRE(tracker.find(jack, record));
+    CHECK(record.name == L"Line Out (Rear Jack)");
+
+    REQUIRE(simulated->removeDevice(jack));
+    CHECK(!tracker.find(jack, record));
+
+    const DeviceTrackerStats stats = tracker.stats();
+    CHECK_EQ(stats.enumerations, 1u);
+    CHECK_EQ(stats.updates, 3u);
+    CHECK(stats.notifications >= 3u);
+}
+
+TEST_CASE(DeviceStateTracker, DefaultChangesFollowTheConsoleRole)
+{
+    const auto simulated = UnitTest::Simulated();
+    const std::wstring oldDefault = simulated->defaultDeviceId(eRender, eConsole);
+    const std::wstring usb = simulated->addDevice(eRender, L"USB Audio DAC");
+
+    DeviceStateTracker tracker;
+    REQUIRE(tracker.start() == S_OK);
+
+    REQUIRE(simulated->setDefaultDevice(usb, Backend::RoleMultimedia) == S_OK);
+    DeviceRecord record;
+    REQUIRE(tracker.find(usb, record));
+    CHECK(!record.isDefault);
+
+    REQUIRE(simulated->setDefaultDevice(usb, Backend::AllRoles) == S_OK);
+    REQUIRE(tracker.find(usb, record));
+    CHECK(record.isDefault);
+    REQUIRE(tracker.find(oldDefault, record));
+    CHECK(!record.isDefault);
+
+    // The capture default is untouched
+    REQUIRE(tracker.find(simulated->defaultDeviceId(eCapture, eConsole), record));
+    CHECK(record.isDefault);
+    CHECK_EQ(tracker.stats().enumerations, 1u);
+}
+
+TEST_CASE(DeviceStateTracker, WaitForDeviceWakesOnScriptedPlug)
+{
+    const auto simulated = UnitTest::Simulated();
+    const std::wstring jack = simulated->addDevice(eRender, L"Line Out (Rear Jack)");
+    REQUIRE(simulated->setDeviceState(jack, DEVICE_STATE_UNPLUGGED));
+
+    DeviceStateTracker tracker;
+    REQUIRE(tracker.start() == S_OK);
+
+    DeviceRecord match;
+    {
+        // Disable and unplug a few times; only the final plug satisfies the wait
+        Later script(20, [&]
+                     {
+                         for (int i = 0; i < 3; ++i)
+                         {
+                             simulated->setDeviceState(jack, DEVICE_STATE_DISABLED);
+                             simulated->setDeviceState(jack, DEVICE_STATE_UNPLUGGED);
+                         }
+                         simulated->setDeviceState(jack, DEVICE_STATE_ACTIVE); });
+        CHECK(tracker.waitForDevice(Plugged(jack), std::chrono::seconds(5), &match));
+    }
+    CHECK(match.id == jack);
+    CHECK_EQ(match.state, static_cast<uint32_t>(DEVICE_STATE_ACTIVE));
+
+    const DeviceTrackerStats stats = tracker.stats();
+    CHECK(stats.wakeups >= 1u);
+    CHECK_EQ(stats.enumerations, 1u);
+
+    // Already satisfied: returns without sleeping
+    CHECK(tracker.waitForDevice(Plugged(jack), std::chrono::milliseconds(0)));
+    CHECK_EQ(tracker.stats().wakeups, stats.wakeups);
+}
+
+TEST_CASE(DeviceStateTracker, WaitForDeviceSeesNewEndpoints)
+{
+    const auto simulated = UnitTest::Simulated();
+    DeviceStateTracker tracker;
+    REQUIRE(tracker.start(DEVICE_STATE_ACTIVE) == S_OK);
+
+    DeviceRecord match;
+    {
+        Later script(20, [&]
+                     { simulated->addDevice(eCapture, L"Microphone (USB Webcam)"); });
+        CHECK(tracker.waitForDevice([](const DeviceRecord &device)
+                                    { return device.name == L"Microphone (USB Webcam)"; },
+                                    std::chrono::seconds(5), &match));
+    }
+    CHECK(match.flow == DeviceFlow::Capture);
+    CHECK_EQ(tracker.stats().enumerations, 2u); // Unknown endpoint: one re-enumeration
+}
+
+TEST_CASE(DeviceStateTracker, WaitForDeviceTimesOutAndStopWakesIt)
+{
+    const auto simulated = UnitTest::Simulated();
+    const std::wstring jack = simulated->addDevice(eRender, L"Line Out (Rear Jack)");
+    REQUIRE(simulated->setDeviceState(jack, DEVICE_STATE_UNPLUGGED));
+
+    DeviceStateTracker tracker;
+    REQUIRE(tracker.start() == S_OK);
+
+    // Changes that never satisfy the predicate do not end the wait early
+    auto begin = Clock::now();
+    {
+        Later script(10, [&]
+                     { simulated->setDeviceState(jack, DEVICE_STATE_DISABLED); });
+        CHECK(!tracker.waitForDevice(Plugged(jack), std::chrono::milliseconds(100)));
+    }
+    CHECK(Clock::now() - begin >= std::chrono::milliseconds(100));
+
+    begin = Clock::now();
+    {
+        Later script(20, [&]
+                     { tracker.stop(); });
+        CHECK(!tracker.waitForDevice(Plugged(jack), std::chrono::seconds(5)));
+    }
+    CHECK(Clock::now() - begin < std::chrono::seconds(4));
+    CHECK(!tracker.waitForDevice(Plugged(jack), std::chrono::seconds(1))); // Stopped: returns at once
+}
@@ -0,0 +1,249 @@
+#include "UnitTest.h"
+#include "Devices/FormatNegotiator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Devices;
+
+namespace
+{
+    const SampleType kS16{16, 16, false};
+    const SampleType kS24{24, 24, false};
+    const SampleType kS24In32{32, 24, false};
+    const SampleType kF32{32, 32, true};
+
+    struct Cell
+    {
+        uint32_t rate;
+        uint16_t channels;
+        SampleType type;
+    };
+
+    /// Small grid so exhaustive reference checks stay cheap.
+    FormatProbeSpec Spec()
+    {
+        FormatProbeSpec spec;
+        spec.sampleRates = {44100, 48000, 96000};
+        spec.channelCounts = {2, 6};
+        spec.sampleTypes = {kS16, kS24, kS24In32, kF32};
+        return spec;
+    }
+
+    FormatCapabilities Device(const std::wstring &id, ShareMode mode, const std::vector<Cell> &accepted)
+    {
+        FormatCapabilities caps;
+        caps.deviceId = id;
+        caps.spec = Spec();
+        caps.shared.assign(caps.spec.cellCount(), 0);
+        caps.exclusive.assign(caps.spec.cellCount(), 0);
+        std::vector<uint8_t> &flags = mode == ShareMode::Shared ? caps.shared : caps.exclusive;
+        for (const Cell &cell : accepted)
+        {
+            const std::ptrdiff_t index = caps.spec.indexOf(cell.rate, cell.channels, cell.type);
+            REQUIRE(index >= 0);
+            flags[static_cast<size_t>(index)] = 1;
+        }
+        caps.valid = true;
+        return caps;
+    }
+
+    bool SameFormat(const Utility::DeviceFormatInfo &format, uint32_t rate, uint16_t channels, const SampleType &type)
+    {
+        return format.valid && format.sampleRate == rate && format.channels == channels &&
+               format.bitDepth == type.bitDepth && format.isFloat == type.isFloat;
+    }
+
+    /**
+     * @brief Cheapest conversion from a format to one the device accepts, trying every accepted cell.
+     */
+    float DeviceCost(const FormatNegotiator &negotiator, const FormatCapabilities &caps, ShareMode mode,
+                     uint32_t rate, uint16_t channels, const SampleType &type)
+    {
+        float best = std::numeric_limits<float>::max();
+        for (uint32_t r : caps.spec.sampleRates)
+            for (uint16_t c : caps.spec.channelCounts)
+                for (const SampleType &t : caps.spec.sampleTypes)
+                    if (caps.supports(mode, r, c, t))
+                        best = std::min(best, negotiator.conversionCost(rate, channels, type, r, c, t));
+        return best;
+    }
+}
+
+TEST_CASE(FormatNegotiator, ConversionCostSumsEveryStage)
+{
+    const FormatNegotiator negotiator;
+    const ConversionCosts &w = negotiator.costs();
+
+    CHECK_EQ(negotiator.conversionCost(48000, 2, kS16, 48000, 2, kS16), 0.0f);
+    CHECK_EQ(negotiator.conversionCost(44100, 2, kS16, 48000, 2, kS16), w.resampleUp);
+    CHECK_EQ(negotiator.conversionCost(48000, 2, kS16, 44100, 2, kS16), w.resampleDown);
+    CHECK_EQ(negotiator.conversionCost(48000, 2, kS16, 48000, 2, kS24In32), w.requantizeUp);
+    CHECK_EQ(negotiator.conversionCost(48000, 2, kS24In32, 48000, 2, kS16), w.requantizeDown);
+    CHECK_EQ(negotiator.conversionCost(48000, 2, kS24, 48000, 2, kS24In32), w.requantizeUp); // Container only
+    CHECK_EQ(negotiator.conversionCost(48000, 2, kS24In32, 48000, 2, kF32), w.floatConversion); // Both 24 bits
+    CHECK_EQ(negotiator.conversionCost(48000, 2, kS16, 48000, 6, kS16), w.channelUpmix);
+    CHECK_EQ(negotiator.conversionCost(48000, 6, kS16, 48000, 2, kS16), w.channelDownmix);
+    CHECK_EQ(negotiator.conversionCost(96000, 6, kF32, 44100, 2, kS16),
+             w.resampleDown + w.requantizeDown + w.floatConversion + w.channelDownmix);
+}
+
+TEST_CASE(FormatNegotiator, SharedFormatIsPassthroughForEveryDevice)
+{
+    const std::vector<FormatCapabilities> devices = {
+        Device(L"a", ShareMode::Exclusive, {{48000, 2, kS16}, {96000, 2, kS24In32}, {44100, 6, kF32}}),
+        Device(L"b", ShareMode::Exclusive, {{96000, 2, kS24In32}, {48000, 6, kS16}}),
+        Device(L"c", ShareMode::Exclusive, {{96000, 2, kS24In32}}),
+    };
+
+    const NegotiationResult result = FormatNegotiator().negotiate(devices, ShareMode::Exclusive);
+    REQUIRE(result.valid);
+    CHECK(SameFormat(result.format, 96000, 2, kS24In32));
+    CHECK(result.sampleType == kS24In32);
+    CHECK_EQ(result.totalCost, 0.0f);
+    REQUIRE(result.plans.size() == devices.size());
+    for (size_t d = 0; d < devices.size(); ++d)
+    {
+        CHECK(result.plans[d].deviceId == devices[d].deviceId);
+        CHECK(result.plans[d].passthrough());
+        CHECK(SameFormat(result.plans[d].deviceFormat, 96000, 2, kS24In32));
+    }
+    CHECK(result.candidatesEvaluated > 0);
+}
+
+TEST_CASE(FormatNegotiator, TiesGoToTheMoreFaithfulFormat)
+{
+    // Every pair is passthrough for both devices: precision, then float, then channels, then 48 kHz
+    const auto pick = [](const std::vector<Cell> &accepted) {
+        const std::vector<FormatCapabilities> devices = {Device(L"a", ShareMode::Exclusive, accepted),
+                                                         Device(L"b", ShareMode::Exclusive, accepted)};
+        return FormatNegotiator().negotiate(devices, ShareMode::Exclusive);
+    };
+
+    CHECK(SameFormat(pick({{48000, 2, kS16}, {48000, 2, kS24}}).format, 48000, 2, kS24));
+    CHECK(SameFormat(pick({{48000, 2, kS24In32}, {48000, 2, kF32}}).format, 48000, 2, kF32));
+    CHECK(SameFormat(pick({{48000, 2, kS24}, {48000, 2, kS24In32}}).format, 48000, 2, kS24));
+    CHECK(SameFormat(pick({{48000, 2, kS16}, {48000, 6, kS16}}).format, 48000, 6, kS16));
+    CHECK(SameFormat(pick({{44100, 2, kS16}, {48000, 2, kS16}, {96000, 2, kS16}}).format, 48000, 2, kS16));
+}
+
+TEST_CASE(FormatNegotiator, DisjointDevicesResampleTheCheaperWay)
+{
+    // 44.1 kHz common: the 48 kHz device upsamples (8). 48 kHz common: the other downsamples (10).
+    const std::vector<FormatCapabilities> devices = {
+        Device(L"cd", ShareMode::Exclusive, {{44100, 2, kS16}}),
+        Device(L"dvd", ShareMode::Exclusive, {{48000, 2, kS16}}),
+    };
+
+    const FormatNegotiator negotiator;
+    const NegotiationResult result = negotiator.negotiate(devices, ShareMode::Exclusive);
+    REQUIRE(result.valid);
+    CHECK(SameFormat(result.format, 44100, 2, kS16));
+    CHECK_EQ(result.totalCost, negotiator.costs().resampleUp);
+    REQUIRE(result.plans.size() == 2u);
+    CHECK(result.plans[0].passthrough());
+    CHECK(result.plans[1].resample);
+    CHECK(!result.plans[1].requantize && !result.plans[1].convertFloat && !result.plans[1].remapChannels);
+    CHECK(SameFormat(result.plans[1].deviceFormat, 48000, 2, kS16));
+
+    // Make upsampling the expensive direction and the winner flips
+    ConversionCosts costs;
+    costs.resampleUp = 20.0f;
+    const NegotiationResult flipped = FormatNegotiator(costs).negotiate(devices, ShareMode::Exclusive);
+    REQUIRE(flipped.valid);
+    CHECK(SameFormat(flipped.format, 48000, 2, kS16));
+    CHECK_EQ(flipped.totalCost, costs.resampleDown);
+    CHECK(flipped.plans[0].resample);
+    CHECK(flipped.plans[1].passthrough());
+}
+
+TEST_CASE(FormatNegotiator, MatchesExhaustiveSearchOnRandomCapabilities)
+{
+    const FormatNegotiator negotiator;
+    const FormatProbeSpec spec = Spec();
+    std::mt19937 rng(7);
+    std::bernoulli_distribution accept(0.15);
+    std::uniform_int_distribution<size_t> deviceCount(1, 4);
+
+    for (int round = 0; round < 200; ++round)
+    {
+        std::vector<FormatCapabilities> devices(deviceCount(rng));
+        for (size_t d = 0; d < devices.size(); ++d)
+        {
+            devices[d] = Device(L"dev" + std::to_wstring(d), ShareMode::Exclusive, {});
+            for (uint8_t &flag : devices[d].exclusive)
+                flag = accept(rng) ? 1 : 0;
+            devices[d].exclusive[static_cast<size_t>(rng() % spec.cellCount())] = 1; // Never empty
+        }
+
+        float expected = std::numeric_limits<float>::max();
+        for (uint32_t rate : spec.sampleRates)
+            for (uint16_t channels : spec.channelCounts)
+                for (const SampleType &type : spec.sampleTypes)
+                {
+                    float total = 0.0f;
+                    for (const FormatCapabilities &caps : devices)
+                        total += DeviceCost(negotiator, caps, ShareMode::Exclusive, rate, channels, type);
+                    expected = std::min(expected, total);
+                }
+
+        const NegotiationResult result = negotiator.negotiate(devices, ShareMode::Exclusive);
+        REQUIRE(result.valid);
+        CHECK_NEAR(result.totalCost, expected, 1e-4f);
+        REQUIRE(result.plans.size() == devices.size());
+
+        float planSum = 0.0f;
+        for (size_t d = 0; d < devices.size(); ++d)
+        {
+            const ConversionPlan &plan = result.plans[d];
+            const Utility::DeviceFormatInfo &target = plan.deviceFormat;
+            CHECK(devices[d].supports(ShareMode::Exclusive, target.sampleRate, target.channels, plan.deviceSampleType));
+            CHECK_NEAR(plan.cost,
+                       DeviceCost(negotiator, devices[d], ShareMode::Exclusive, result.format.sampleRate,
+                                  result.format.channels, result.sampleType),
+                       1e-4f);
+            CHECK_EQ(plan.resample, target.sampleRate != result.format.sampleRate);
+            CHECK_EQ(plan.remapChannels, target.channels != result.format.channels);
+            CHECK_EQ(plan.convertFloat, plan.deviceSampleType.isFloat != result.sampleType.isFloat);
+            CHECK_EQ(plan.passthrough(), plan.cost == 0.0f);
+            planSum += plan.cost;
+        }
+        CHECK_NEAR(planSum, result.totalCost, 1e-4f);
+    }
+}
+
+TEST_CASE(FormatNegotiator, SharedModeFallsBackToTheMixFormat)
+{
+    // Shared grid not probed: only the mix format is usable
+    FormatCapabilities unprobed = Device(L"mix", ShareMode::Exclusive, {{96000, 6, kS24In32}});
+    unprobed.shared.clear();
+    unprobed.mixFormat = MakeFormat(48000, 2, kF32);
+
+    const FormatCapabilities other = Device(L"other", ShareMode::Shared, {{48000, 2, kF32}, {44100, 2, kS16}});
+
+    const NegotiationResult result = FormatNegotiator().negotiate({unprobed, other}, ShareMode::Shared);
+    REQUIRE(result.valid);
+    CHECK(SameFormat(result.format, 48000, 2, kF32));
+    CHECK_EQ(result.totalCost, 0.0f);
+    CHECK(result.plans[0].passthrough());
+}
+
+TEST_CASE(FormatNegotiator, DeviceWithoutFormatsFailsTheNegotiation)
+{
+    const FormatNegotiator negotiator;
+    CHECK(!negotiator.negotiate({}, ShareMode::Exclusive).valid);
+
+    // Accepts formats only in shared mode, and no mix format to fall back on in exclusive
+    const std::vector<FormatCapabilities> devices = {
+        Device(L"a", ShareMode::Exclusive, {{48000, 2, kS16}}),
+        Device(L"b", ShareMode::Shared, {{48000, 2, kS16}}),
+    };
+    const NegotiationResult result = negotiator.negotiate(devices, ShareMode::Exclusive);
+    CHECK(!result.valid);
+    CHECK(result.plans.empty());
+    CHECK(!negotiator.negotiate(devices, ShareMode::Shared).valid);
+}
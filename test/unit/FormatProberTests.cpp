@@ -0,0 +1,201 @@
+#include "UnitTest.h"
+#include "Devices/FakeFormatQuery.h"
+#include "Devices/FormatCache.h"
+#include "Devices/FormatProber.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using namespace Devices;
+
+namespace
+{
+    const SampleType kS16{16, 16, false};
+    const SampleType kS24In32{32, 24, false};
+    const SampleType kF32{32, 32, true};
+
+    /**
+     * @brief A small grid, so every test walks it in a few dozen queries.
+     */
+    FormatProbeSpec SmallSpec()
+    {
+        FormatProbeSpec spec;
+        spec.sampleRates = {44100, 48000, 96000};
+        spec.channelCounts = {1, 2};
+        spec.sampleTypes = {kS16, kS24In32, kF32};
+        return spec;
+    }
+
+    /**
+     * @brief Endpoint that also takes 16- and 24-bit stereo at 44.1 and 48 kHz exclusively.
+     */
+    std::unique_ptr<FakeFormatQuery> Device(const std::wstring &id, const std::wstring &driverVersion = L"1.0")
+    {
+        auto device = std::make_unique<FakeFormatQuery>(id, driverVersion);
+        device->exclusive.sampleRates = {44100, 48000};
+        device->exclusive.channelCounts = {2};
+        device->exclusive.sampleTypes = {kS16, kS24In32};
+        return device;
+    }
+
+    void CheckSameMatrix(const FormatCapabilities &actual, const FormatCapabilities &expected)
+    {
+        CHECK(actual.deviceId == expected.deviceId);
+        CHECK(actual.driverVersion == expected.driverVersion);
+        CHECK(actual.shared == expected.shared);
+        CHECK(actual.exclusive == expected.exclusive);
+        CHECK_EQ(actual.defaultPeriodHns, expected.defaultPeriodHns);
+        CHECK_EQ(actual.minimumPeriodHns, expected.minimumPeriodHns);
+        CHECK_EQ(actual.mixFormat.sampleRate, expected.mixFormat.sampleRate);
+    }
+}
+
+TEST_CASE(FormatProber, ProbeWalksEveryCellInBothModes)
+{
+    const FormatProbeSpec spec = SmallSpec();
+    auto device = Device(L"{speakers}");
+
+    const FormatCapabilities caps = FormatProber::probeDevice(*device, spec);
+    REQUIRE(caps.valid);
+    CHECK_EQ(caps.queries, static_cast<uint32_t>(2 * spec.cellCount()));
+    CHECK_EQ(device->calls(), static_cast<uint64_t>(caps.queries));
+    CHECK(!caps.fromCache);
+
+    CHECK(caps.supports(ShareMode::Shared, 48000, 2, kF32));
+    CHECK(!caps.supports(ShareMode::Shared, 44100, 2, kF32));
+    CHECK(caps.supports(ShareMode::Exclusive, 44100, 2, kS24In32));
+    CHECK(!caps.supports(ShareMode::Exclusive, 96000, 2, kS16));
+    CHECK(!caps.supports(ShareMode::Exclusive, 48000, 2, SampleType{24, 24, false})); // Not in the spec
+    CHECK_EQ(caps.supportedFormats(ShareMode::Exclusive).size(), 4u);
+}
+
+TEST_CASE(FormatProber, ParallelProbeKeepsDeviceOrder)
+{
+    const FormatProbeSpec spec = SmallSpec();
+    std::vector<std::unique_ptr<FakeFormatQuery>> owned;
+    std::vector<IFormatQuery *> devices;
+    for (int i = 0; i < 6; ++i)
+    {
+        owned.push_back(Device(L"{device-" + std::to_wstring(i) + L"}"));
+        if (i % 2)
+            owned.back()->exclusive.sampleRates = {96000};
+        devices.push_back(owned.back().get());
+    }
+    devices.insert(devices.begin() + 3, nullptr); // Skipped, left invalid
+
+    const std::vector<FormatCapabilities> caps = FormatProber(4).probe(devices, spec);
+    REQUIRE(caps.size() == devices.size());
+    CHECK(!caps[3].valid);
+    for (size_t i = 0; i < devices.size(); ++i)
+    {
+        if (!devices[i])
+            continue;
+        auto reference = Device(devices[i]->deviceId());
+        reference->exclusive.sampleRates = static_cast<FakeFormatQuery *>(devices[i])->exclusive.sampleRates;
+        CheckSameMatrix(caps[i], FormatProber::probeDevice(*reference, spec));
+    }
+}
+
+TEST_CASE(FormatProber, CachedDevicesAreNotQueried)
+{
+    const FormatProbeSpec spec = SmallSpec();
+    auto speakers = Device(L"{speakers}");
+    auto headset = Device(L"{headset}");
+    const std::vector<IFormatQuery *> devices = {speakers.get(), headset.get()};
+
+    FormatCache cache;
+    const FormatProber prober;
+    const std::vector<FormatCapabilities> first = prober.probe(devices, spec, &cache);
+    CHECK_EQ(cache.size(), 2u);
+    const uint64_t speakerCalls = speakers->calls();
+    const uint64_t headsetCalls = headset->calls();
+    CHECK(speakerCalls > 0u && headsetCalls > 0u);
+
+    const std::vector<FormatCapabilities> second = prober.probe(devices, spec, &cache);
+    REQUIRE(second.size() == 2u);
+    for (size_t i = 0; i < second.size(); ++i)
+    {
+        CHECK(second[i].fromCache);
+        CHECK(second[i].valid);
+        CHECK_EQ(second[i].queries, 0u);
+        CheckSameMatrix(second[i], first[i]);
+    }
+    CHECK_EQ(speakers->calls(), speakerCalls);
+    CHECK_EQ(headset->calls(), headsetCalls);
+
+    // A different grid is not answered from the cache
+    FormatProbeSpec wider = spec;
+    wider.sampleRates.push_back(192000);
+    CHECK(!prober.probe(devices, wider, &cache)[0].fromCache);
+    CHECK(speakers->calls() > speakerCalls);
+}
+
+TEST_CASE(FormatProber, DriverUpdateInvalidatesTheEntry)
+{
+    const FormatProbeSpec spec = SmallSpec();
+    auto before = Device(L"{speakers}", L"10.0.1.2");
+    auto headset = Device(L"{headset}");
+
+    FormatCache cache;
+    const FormatProber prober;
+    prober.probe({before.get(), headset.get()}, spec, &cache);
+
+    // Same endpoint after a driver update: exclusive mode now also takes 96 kHz
+    auto after = Device(L"{speakers}", L"10.0.1.3");
+    after->exclusive.sampleRates.push_back(96000);
+    const uint64_t headsetCalls = headset->calls();
+
+    const std::vector<FormatCapabilities> caps = prober.probe({after.get(), headset.get()}, spec, &cache);
+    CHECK(!caps[0].fromCache);
+    CHECK_EQ(after->calls(), static_cast<uint64_t>(2 * spec.cellCount()));
+    CHECK(caps[0].driverVersion == L"10.0.1.3");
+    CHECK(caps[0].supports(ShareMode::Exclusive, 96000, 2, kS16));
+    CHECK(caps[1].fromCache);
+    CHECK_EQ(headset->calls(), headsetCalls);
+
+    // The entry was replaced, not added to
+    CHECK_EQ(cache.size(), 2u);
+    FormatCapabilities stored;
+    CHECK(!cache.find(L"{speakers}", L"10.0.1.2", spec.hash(), stored));
+    REQUIRE(cache.find(L"{speakers}", L"10.0.1.3", spec.hash(), stored));
+    CHECK(stored.supports(ShareMode::Exclusive, 96000, 2, kS16));
+}
+
+TEST_CASE(FormatProber, InvalidResultsAreNotCached)
+{
+    auto device = Device(L"{broken}");
+    device->mix.valid = false;
+
+    FormatCache cache;
+    const std::vector<FormatCapabilities> caps = FormatProber().probe({device.get()}, SmallSpec(), &cache);
+    CHECK(!caps[0].valid);
+    CHECK_EQ(cache.size(), 0u);
+}
+
+TEST_CASE(FormatProber, CacheFileRoundTrip)
+{
+    const FormatProbeSpec spec = SmallSpec();
+    auto device = Device(L"{speakers}");
+    FormatCache cache;
+    const FormatCapabilities probed = FormatProber().probe({device.get()}, spec, &cache)[0];
+
+    std::error_code ignored;
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "audioswitcher-unit-formats.cache";
+    REQUIRE(cache.save(path));
+
+    FormatCache loaded;
+    REQUIRE(loaded.load(path));
+    std::filesystem::remove(path, ignored);
+
+    const uint64_t calls = device->calls();
+    const FormatCapabilities reloaded = FormatProber().probe({device.get()}, spec, &loaded)[0];
+    CHECK(reloaded.fromCache);
+    CHECK_EQ(device->calls(), calls);
+    CheckSameMatrix(reloaded, probed);
+
+    CHECK(!loaded.load(path)); // Missing file: empty cache
+    CHECK_EQ(loaded.size(), 0u);
+}
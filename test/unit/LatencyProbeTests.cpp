@@ -0,0 +1,150 @@
+#include "UnitTest.h"
+#include "Streaming/LatencyProbe.h"
+#include "Streaming/SimulatedLoopback.h"
+
+#include <cstdint>
+
+using namespace Streaming;
+
+namespace
+{
+    constexpr uint32_t kRate = 48000;
+    constexpr uint32_t kPeriodFrames = 480;
+
+    SimulatedLoopbackConfig Loopback(uint32_t delayFrames, float gain = 0.5f)
+    {
+        SimulatedLoopbackConfig config;
+        config.sampleRate = kRate;
+        config.delayFrames = delayFrames;
+        config.gain = gain;
+        config.periodFrames = kPeriodFrames;
+        return config;
+    }
+
+    /// Short trials so the suite stays fast: the loopback runs on the wall clock.
+    LatencyProbeConfig Probe(ProbeSignal signal)
+    {
+        LatencyProbeConfig config;
+        config.signal = signal;
+        config.trials = 3;
+        config.chirpMs = 100;
+        config.mlsOrder = 12;
+        config.maxLatencyMs = 200;
+        config.gapMs = 50;
+        return config;
+    }
+
+    double FramesToMs(uint32_t frames)
+    {
+        return frames * 1000.0 / kRate;
+    }
+
+    /**
+     * @brief The probe sees the loopback delay plus at most one engine period, depending on
+     *        where the first write lands relative to the period the capture drain ended in.
+     */
+    void CheckTracksDelay(const LatencyReport &report, uint32_t delayFrames, uint32_t trials)
+    {
+        REQUIRE(report.valid);
+        CHECK_EQ(report.sampleRate, kRate);
+        CHECK_EQ(report.failedTrials, 0u);
+        CHECK_EQ(report.latencyMs.size(), static_cast<size_t>(trials));
+
+        const double low = FramesToMs(delayFrames) - 0.5;
+        const double high = FramesToMs(delayFrames + kPeriodFrames) + 0.5;
+        for (double ms : report.latencyMs)
+        {
+            CHECK(ms >= low);
+            CHECK(ms <= high);
+        }
+        CHECK(report.minMs <= report.medianMs);
+        CHECK(report.medianMs <= report.maxMs);
+        CHECK(report.jitterMs <= FramesToMs(kPeriodFrames));
+        CHECK(report.meanConfidence >= Probe(ProbeSignal::Chirp).minConfidence);
+    }
+}
+
+TEST_CASE(LatencyProbe, ChirpMeasuresLoopbackDelay)
+{
+    SimulatedLoopback loopback;
+    REQUIRE(loopback.open(Loopback(2400)));
+
+    LatencyProbe probe;
+    const LatencyProbeConfig config = Probe(ProbeSignal::Chirp);
+    const LatencyReport report = probe.measure(loopback.sink(), loopback.source(), config);
+    CheckTracksDelay(report, 2400, config.trials);
+    CHECK_EQ(report.renderTiming.bufferFrames, loopback.config().bufferFrames);
+    CHECK_EQ(report.captureTiming.defaultPeriodFrames, kPeriodFrames);
+}
+
+TEST_CASE(LatencyProbe, MlsMeasuresLoopbackDelay)
+{
+    SimulatedLoopback loopback;
+    REQUIRE(loopback.open(Loopback(2400)));
+
+    LatencyProbe probe;
+    const LatencyProbeConfig config = Probe(ProbeSignal::Mls);
+    CheckTracksDelay(probe.measure(loopback.sink(), loopback.source(), config), 2400, config.trials);
+}
+
+TEST_CASE(LatencyProbe, TracksTheConfiguredDelay)
+{
+    for (uint32_t delayFrames : {480u, 4321u})
+    {
+        SimulatedLoopback loopback;
+        REQUIRE(loopback.open(Loopback(delayFrames)));
+
+        LatencyProbe probe;
+        const LatencyProbeConfig config = Probe(ProbeSignal::Chirp);
+        CheckTracksDelay(probe.measure(loopback.sink(), loopback.source(), config), delayFrames, config.trials);
+    }
+}
+
+TEST_CASE(LatencyProbe, SilentLoopbackFailsEveryTrial)
+{
+    SimulatedLoopback loopback;
+    REQUIRE(loopback.open(Loopback(2400, 0.0f)));
+
+    LatencyProbe probe;
+    const LatencyProbeConfig config = Probe(ProbeSignal::Chirp);
+    const LatencyReport report = probe.measure(loopback.sink(), loopback.source(), config);
+    CHECK(!report.valid);
+    CHECK_EQ(report.failedTrials, config.trials);
+    CHECK(report.latencyMs.empty());
+}
+
+TEST_CASE(LatencyProbe, DelayBeyondTheCaptureWindowFails)
+{
+    // The capture window is the chirp plus maxLatencyMs (300 ms); 350 ms of delay never reaches it
+    SimulatedLoopback loopback;
+    REQUIRE(loopback.open(Loopback(16800)));
+
+    LatencyProbe probe;
+    LatencyProbeConfig config = Probe(ProbeSignal::Chirp);
+    config.trials = 1;
+    const LatencyReport report = probe.measure(loopback.sink(), loopback.source(), config);
+    CHECK(!report.valid);
+    CHECK_EQ(report.failedTrials, 1u);
+}
+
+TEST_CASE(LatencyProbe, RejectsMismatchedRatesAndZeroTrials)
+{
+    SimulatedLoopback render;
+    SimulatedLoopback capture;
+    REQUIRE(render.open(Loopback(2400)));
+    SimulatedLoopbackConfig other = Loopback(2400);
+    other.sampleRate = 44100;
+    REQUIRE(capture.open(other));
+
+    LatencyProbe probe;
+    LatencyReport report = probe.measure(render.sink(), capture.source(), Probe(ProbeSignal::Chirp));
+    CHECK(!report.valid);
+    CHECK_EQ(report.sampleRate, 0u);
+    CHECK_EQ(report.failedTrials, 0u);
+
+    LatencyProbeConfig none = Probe(ProbeSignal::Chirp);
+    none.trials = 0;
+    report = probe.measure(render.sink(), render.source(), none);
+    CHECK(!report.valid);
+    CHECK(report.latencyMs.empty());
+}
@@ -0,0 +1,229 @@
+#include "UnitTest.h"
+#include "Dsp/LevelMeter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace Dsp;
+
+namespace
+{
+    constexpr uint32_t kRate = 48000;
+    constexpr double kPi = 3.14159265358979323846;
+
+    Utility::DeviceFormatInfo Format(uint16_t channels, uint16_t bits, bool isFloat)
+    {
+        Utility::DeviceFormatInfo format;
+        format.bitDepth = bits;
+        format.channels = channels;
+        format.blockAlign = static_cast<uint16_t>(channels * bits / 8);
+        format.sampleRate = kRate;
+        format.isFloat = isFloat;
+        format.valid = true;
+        return format;
+    }
+
+    /**
+     * @brief Levels of one channel over the last `windowBlocks` complete blocks, computed directly.
+     */
+    ChannelLevels Reference(const std::vector<float> &interleaved, uint32_t channels, uint32_t channel,
+                            size_t blockFrames, size_t windowBlocks, float clipThreshold)
+    {
+        const size_t frames = interleaved.size() / channels;
+        const size_t blocks = frames / blockFrames;
+        const size_t first = blocks > windowBlocks ? blocks - windowBlocks : 0;
+
+        ChannelLevels levels;
+        double sum = 0.0;
+        double sumSq = 0.0;
+        for (size_t f = 0; f < blocks * blockFrames; ++f)
+        {
+            const float v = interleaved[f * channels + channel];
+            const bool clipped = std::fabs(v) >= clipThreshold;
+            levels.totalClipped += clipped;
+            if (f / blockFrames < first)
+                continue;
+            levels.peak = std::max(levels.peak, std::fabs(v));
+            levels.clippedSamples += clipped;
+            sum += v;
+            sumSq += static_cast<double>(v) * v;
+        }
+        const double n = static_cast<double>((blocks - first) * blockFrames);
+        levels.rms = static_cast<float>(std::sqrt(sumSq / n));
+        levels.dcOffset = static_cast<float>(sum / n);
+        return levels;
+    }
+
+    std::vector<float> TestSignal(size_t frames, uint32_t channels)
+    {
+        std::vector<float> samples(frames * channels);
+        uint32_t state = 12345;
+        for (size_t f = 0; f < frames; ++f)
+        {
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                const float noise = static_cast<float>(state) / 4294967296.0f - 0.5f;
+                // Channel-dependent level and DC; the envelope makes later blocks louder
+                const float envelope = 0.2f + 0.6f * static_cast<float>(f) / static_cast<float>(frames);
+                samples[f * channels + c] = envelope * noise / static_cast<float>(c + 1) + 0.01f * static_cast<float>(c);
+            }
+        }
+        return samples;
+    }
+}
+
+TEST_CASE(LevelMeter, RejectsInvalidConfiguration)
+{
+    LevelMeter meter;
+    CHECK(!meter.configure(Utility::DeviceFormatInfo()));
+    CHECK(!meter.configure(Format(2, 32, true), 5, 10)); // Window shorter than a block
+    CHECK(!meter.configure(Format(2, 32, true), 100, 0));
+    CHECK(meter.configure(Format(2, 32, true)));
+}
+
+TEST_CASE(LevelMeter, NoLevelsBeforeTheFirstBlock)
+{
+    LevelMeter meter;
+    REQUIRE(meter.configure(Format(1, 32, true), 100, 10));
+    const std::vector<float> partial(479, 0.5f);
+    meter.process(partial.data(), partial.size());
+    CHECK_EQ(meter.levels(0).peak, 0.0f);
+    CHECK_EQ(meter.levels(0).rms, 0.0f);
+    CHECK_EQ(meter.levels(1).peak, 0.0f); // Out of range
+}
+
+TEST_CASE(LevelMeter, FloatLevelsMatchReference)
+{
+    const uint32_t channels = 3;
+    const size_t blockFrames = kRate / 100;
+    const size_t windowBlocks = 10;
+    LevelMeter meter;
+    REQUIRE(meter.configure(Format(channels, 32, true), 100, 10, false));
+
+    // 2.5 windows in uneven buffers, so the window has slid and a partial block is pending
+    const std::vector<float> signal = TestSignal(blockFrames * 25 + 123, channels);
+    const size_t sizes[] = {1, 255, 480, 1000, 7};
+    size_t done = 0;
+    for (size_t i = 0; done < signal.size() / channels; ++i)
+    {
+        const size_t n = std::min(sizes[i % 5], signal.size() / channels - done);
+        meter.process(signal.data() + done * channels, n);
+        done += n;
+    }
+
+    for (uint32_t c = 0; c < channels; ++c)
+    {
+        const ChannelLevels expected = Reference(signal, channels, c, blockFrames, windowBlocks, 1.0f);
+        const ChannelLevels actual = meter.levels(c);
+        CHECK_NEAR(actual.peak, expected.peak, 1e-7);
+        CHECK_NEAR(actual.rms, expected.rms, 1e-5);
+        CHECK_NEAR(actual.dcOffset, expected.dcOffset, 1e-5);
+        CHECK_EQ(actual.clippedSamples, 0u);
+        CHECK_EQ(actual.truePeak, 0.0f); // Disabled
+    }
+}
+
+TEST_CASE(LevelMeter, ClipsCountInWindowAndInTotal)
+{
+    const size_t blockFrames = kRate / 100;
+    LevelMeter meter;
+    REQUIRE(meter.configure(Format(1, 32, true), 20, 10, false));
+
+    std::vector<float> signal(blockFrames * 5, 0.25f);
+    signal[3] = 1.0f;                     // Block 0: leaves the window
+    signal[blockFrames * 3 + 9] = -1.5f;  // Block 3
+    signal[blockFrames * 4 + 1] = 1.0f;   // Block 4
+    signal[blockFrames * 4 + 2] = 0.999f; // Below threshold
+    meter.process(signal.data(), blockFrames * 5);
+
+    const ChannelLevels expected = Reference(signal, 1, 0, blockFrames, 2, 1.0f);
+    const ChannelLevels actual = meter.levels(0);
+    CHECK_EQ(actual.clippedSamples, 2u);
+    CHECK_EQ(actual.totalClipped, 3u);
+    CHECK_EQ(actual.clippedSamples, expected.clippedSamples);
+    CHECK_EQ(actual.totalClipped, expected.totalClipped);
+    CHECK_NEAR(actual.peak, 1.5f, 1e-7);
+
+    meter.reset();
+    CHECK_EQ(meter.levels(0).totalClipped, 0u);
+}
+
+TEST_CASE(LevelMeter, Pcm16UsesFullScaleAndLargestCode)
+{
+    const size_t blockFrames = kRate / 100;
+    LevelMeter meter;
+    REQUIRE(meter.configure(Format(2, 16, false), 10, 10, false));
+
+    std::vector<int16_t> pcm(blockFrames * 2);
+    std::vector<float> reference(pcm.size());
+    for (size_t i = 0; i < pcm.size(); ++i)
+    {
+        pcm[i] = static_cast<int16_t>((static_cast<int>(i * 193) % 20001) - 10000);
+        reference[i] = pcm[i] / 32768.0f;
+    }
+    pcm[10] = 32767; // Largest positive code counts as clipped
+    reference[10] = 32767 / 32768.0f;
+    pcm[11] = -32768;
+    reference[11] = -1.0f;
+    meter.process(pcm.data(), blockFrames);
+
+    const float threshold = 32767.0f / 32768.0f;
+    for (uint32_t c = 0; c < 2; ++c)
+    {
+        const ChannelLevels expected = Reference(reference, 2, c, blockFrames, 1, threshold);
+        const ChannelLevels actual = meter.levels(c);
+        CHECK_NEAR(actual.peak, expected.peak, 1e-7);
+        CHECK_NEAR(actual.rms, expected.rms, 1e-5);
+        CHECK_NEAR(actual.dcOffset, expected.dcOffset, 1e-5);
+        CHECK_EQ(actual.clippedSamples, 1u);
+    }
+}
+
+TEST_CASE(LevelMeter, Pcm24In32ClipsAtTheLargest24BitCode)
+{
+    const size_t blockFrames = kRate / 100;
+    Utility::DeviceFormatInfo format = Format(1, 32, false);
+    format.bitDepth = 24; // Valid bits; the container stays 32-bit
+    LevelMeter meter;
+    REQUIRE(meter.configure(format, 10, 10, false));
+
+    // Left-justified samples: the low byte is padding
+    std::vector<int32_t> pcm(blockFrames, 0x00100000 << 8);
+    pcm[3] = 0x7FFFFF << 8; // Full scale: 0.99999988f after conversion
+    pcm[4] = std::numeric_limits<int32_t>::min(); // -1.0f
+    pcm[5] = 0x7FFFFE << 8; // One code below
+    meter.process(pcm.data(), blockFrames);
+
+    const ChannelLevels levels = meter.levels(0);
+    CHECK_NEAR(levels.peak, 1.0f, 1e-7);
+    CHECK_EQ(levels.clippedSamples, 2u);
+    CHECK_EQ(levels.totalClipped, 2u);
+
+    // A true 32-bit stream keeps the 32-bit threshold, which 24-bit full scale does not reach
+    REQUIRE(meter.configure(Format(1, 32, false), 10, 10, false));
+    meter.process(pcm.data(), blockFrames);
+    CHECK_EQ(meter.levels(0).clippedSamples, 1u);
+}
+
+TEST_CASE(LevelMeter, TruePeakFindsInterSamplePeaks)
+{
+    // A sine at a quarter of the rate, sampled 45 degrees off its crests: samples reach 0.707, the wave 1.0
+    const size_t blockFrames = kRate / 100;
+    LevelMeter meter;
+    REQUIRE(meter.configure(Format(1, 32, true), 10, 10, true));
+    std::vector<float> signal(blockFrames);
+    for (size_t i = 0; i < signal.size(); ++i)
+        signal[i] = static_cast<float>(std::sin(kPi / 2.0 * static_cast<double>(i) + kPi / 4.0));
+    meter.process(signal.data(), signal.size());
+
+    const ChannelLevels levels = meter.levels(0);
+    CHECK_NEAR(levels.peak, 0.70710678, 1e-5);
+    CHECK_NEAR(levels.truePeak, 1.0, 0.03);
+    CHECK(levels.truePeak >= levels.peak);
+}
@@ -0,0 +1,226 @@
+#include "UnitTest.h"
+#include "Dsp/MultiSourceMixer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace Dsp;
+
+namespace
+{
+    constexpr uint32_t kRate = 48000;
+
+    /**
+     * @brief Sample-by-sample mixer in double precision: per block, each gain ramps linearly
+     *        from its current value toward the target by 1 - exp(-blockFrames / tau).
+     */
+    class ReferenceMixer
+    {
+    public:
+        ReferenceMixer(uint32_t inputs, uint32_t channels, float smoothingMs)
+            : m_channels(channels), m_current(inputs, 1.0), m_targets(inputs, 1.0),
+              m_tauFrames(smoothingMs * 0.001 * kRate) {}
+
+        void setGain(uint32_t index, double gain, bool immediate)
+        {
+            m_targets[index] = gain;
+            if (immediate)
+                m_current[index] = gain;
+        }
+
+        void mix(const std::vector<std::vector<float>> &inputs, std::vector<double> &out, size_t frames,
+                 uint32_t inputCount, bool softClip = false, double knee = 0.8)
+        {
+            const size_t total = frames * m_channels;
+            out.assign(total, 0.0);
+            for (size_t offset = 0; offset < total; offset += MultiSourceMixer::BlockSamples)
+            {
+                const size_t n = std::min(total - offset, MultiSourceMixer::BlockSamples);
+                const double smoothing = m_tauFrames > 0.0 ? 1.0 - std::exp(-static_cast<double>(n) / m_channels / m_tauFrames) : 1.0;
+                for (uint32_t i = 0; i < inputCount; ++i)
+                {
+                    const double start = m_current[i];
+                    const double end = start + (m_targets[i] - start) * smoothing;
+                    for (size_t k = 0; k < n; ++k)
+                        out[offset + k] += (start + (end - start) * k / n) * inputs[i][offset + k];
+                    m_current[i] = end;
+                }
+                if (softClip)
+                {
+                    for (size_t k = offset; k < offset + n; ++k)
+                    {
+                        const double magnitude = std::fabs(out[k]);
+                        if (magnitude > knee)
+                        {
+                            const double u = (magnitude - knee) / (1.0 - knee);
+                            out[k] = std::copysign(knee + (1.0 - knee) * u / (1.0 + u), out[k]);
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        uint32_t m_channels;
+        std::vector<double> m_current;
+        std::vector<double> m_targets;
+        double m_tauFrames;
+    };
+
+    /// Deterministic pseudo-random samples in [-amplitude, amplitude].
+    std::vector<float> Noise(size_t count, uint32_t seed, float amplitude)
+    {
+        std::vector<float> samples(count);
+        uint32_t state = seed * 2654435761u + 1;
+        for (float &sample : samples)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            sample = amplitude * (static_cast<float>(state) / 2147483648.0f - 1.0f);
+        }
+        return samples;
+    }
+
+    void Fill(MultiSourceMixer &mixer, const std::vector<std::vector<float>> &inputs)
+    {
+        for (uint32_t i = 0; i < inputs.size(); ++i)
+            std::copy(inputs[i].begin(), inputs[i].end(), mixer.input(i));
+    }
+}
+
+TEST_CASE(MultiSourceMixer, RejectsZeroSizes)
+{
+    MultiSourceMixer mixer;
+    CHECK(!mixer.configure(0, 2, 480, kRate));
+    CHECK(!mixer.configure(2, 0, 480, kRate));
+    CHECK(!mixer.configure(2, 2, 0, kRate));
+    CHECK(!mixer.configure(2, 2, 480, 0));
+    REQUIRE(mixer.configure(2, 2, 480, kRate));
+    CHECK(mixer.input(1) != nullptr);
+    CHECK(mixer.input(2) == nullptr);
+}
+
+TEST_CASE(MultiSourceMixer, StaticGainsMatchReference)
+{
+    const uint32_t inputs = 5;
+    const uint32_t channels = 2;
+    const size_t frames = 1111; // Several full blocks and a partial one
+    MultiSourceMixer mixer;
+    REQUIRE(mixer.configure(inputs, channels, frames, kRate));
+    ReferenceMixer reference(inputs, channels, 10.0f);
+
+    std::vector<std::vector<float>> data;
+    for (uint32_t i = 0; i < inputs; ++i)
+    {
+        data.push_back(Noise(frames * channels, i + 1, 0.5f));
+        const float gain = 0.1f + 0.2f * static_cast<float>(i);
+        mixer.setGain(i, gain, true);
+        reference.setGain(i, gain, true);
+    }
+    Fill(mixer, data);
+
+    std::vector<float> out(frames * channels);
+    std::vector<double> expected;
+    mixer.mix(out.data(), frames, inputs);
+    reference.mix(data, expected, frames, inputs);
+    for (size_t k = 0; k < out.size(); ++k)
+        CHECK_NEAR(out[k], expected[k], 1e-5);
+
+    // Only the first inputs are summed
+    mixer.mix(out.data(), frames, 2);
+    reference.mix(data, expected, frames, 2);
+    for (size_t k = 0; k < out.size(); ++k)
+        CHECK_NEAR(out[k], expected[k], 1e-5);
+}
+
+TEST_CASE(MultiSourceMixer, GainRampsMatchReferenceForAnyBlockSize)
+{
+    const uint32_t inputs = 3;
+    const uint32_t channels = 2;
+    const size_t maxFrames = 2048;
+    MultiSourceMixer mixer;
+    REQUIRE(mixer.configure(inputs, channels, maxFrames, kRate, 5.0f));
+    ReferenceMixer reference(inputs, channels, 5.0f);
+
+    std::vector<std::vector<float>> data;
+    for (uint32_t i = 0; i < inputs; ++i)
+        data.push_back(Noise(maxFrames * channels, 10 + i, 0.3f));
+    Fill(mixer, data);
+
+    mixer.setGain(0, 0.0f);
+    reference.setGain(0, 0.0, false);
+    mixer.setGain(2, 2.0f);
+    reference.setGain(2, 2.0, false);
+
+    std::vector<float> out(maxFrames * channels);
+    std::vector<double> expected;
+    const size_t sizes[] = {480, 37, 1, 512, 2048, 100, 441};
+    for (size_t frames : sizes)
+    {
+        mixer.mix(out.data(), frames, inputs);
+        reference.mix(data, expected, frames, inputs);
+        for (size_t k = 0; k < frames * channels; ++k)
+            CHECK_NEAR(out[k], expected[k], 1e-4);
+    }
+}
+
+TEST_CASE(MultiSourceMixer, RampTimeDoesNotDependOnCallbackSize)
+{
+    // A constant input of 1 ramped from gain 0 to 1 reaches 1 - 1/e after one time constant
+    const float smoothingMs = 10.0f;
+    const size_t tauFrames = static_cast<size_t>(smoothingMs * kRate / 1000);
+    for (size_t callback : {size_t(32), size_t(128), size_t(480), size_t(1024)})
+    {
+        MultiSourceMixer mixer;
+        REQUIRE(mixer.configure(1, 1, callback, kRate, smoothingMs));
+        std::fill(mixer.input(0), mixer.input(0) + callback, 1.0f);
+        mixer.setGain(0, 0.0f, true);
+        mixer.setGain(0, 1.0f);
+
+        std::vector<float> out(callback);
+        size_t done = 0;
+        while (done + callback <= tauFrames)
+        {
+            mixer.mix(out.data(), callback, 1);
+            done += callback;
+        }
+        const double expected = 1.0 - std::exp(-static_cast<double>(done) / tauFrames);
+        CHECK_NEAR(out[callback - 1], expected, 0.02);
+    }
+}
+
+TEST_CASE(MultiSourceMixer, SoftClipMatchesReference)
+{
+    const uint32_t channels = 2;
+    const size_t frames = 700;
+    MultiSourceMixer mixer;
+    REQUIRE(mixer.configure(2, channels, frames, kRate));
+    ReferenceMixer reference(2, channels, 10.0f);
+    const std::vector<std::vector<float>> data = {Noise(frames * channels, 3, 1.0f), Noise(frames * channels, 4, 1.0f)};
+    Fill(mixer, data);
+    mixer.setSoftClip(true, 0.5f);
+
+    std::vector<float> out(frames * channels);
+    std::vector<double> expected;
+    mixer.mix(out.data(), frames, 2);
+    reference.mix(data, expected, frames, 2, true, 0.5);
+    for (size_t k = 0; k < out.size(); ++k)
+    {
+        CHECK_NEAR(out[k], expected[k], 1e-5);
+        CHECK(std::fabs(out[k]) < 1.0f);
+    }
+}
+
+TEST_CASE(MultiSourceMixer, ZeroSmoothingJumpsToTarget)
+{
+    MultiSourceMixer mixer;
+    REQUIRE(mixer.configure(1, 1, 64, kRate, 0.0f));
+    std::fill(mixer.input(0), mixer.input(0) + 64, 1.0f);
+    mixer.setGain(0, 0.25f);
+    std::vector<float> out(64);
+    mixer.mix(out.data(), 64, 1);
+    for (float sample : out)
+        CHECK_EQ(sample, 0.25f);
+}
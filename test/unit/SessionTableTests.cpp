@@ -0,0 +1,225 @@
+#include "UnitTest.h"
+#include "Backend/SimulatedSessionBackend.h"
+#include "Devices/SessionTable.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Devices;
+using Backend::SessionInfo;
+using Backend::SessionState;
+
+namespace
+{
+    const std::wstring kSpeakers = L"{0.0.0.00000000}.{speakers}";
+    const std::wstring kHeadset = L"{0.0.0.00000000}.{headset}";
+
+    bool Contains(const std::vector<SessionInfo> &sessions, const std::wstring &instanceId)
+    {
+        for (const SessionInfo &session : sessions)
+            if (session.instanceId == instanceId)
+                return true;
+        return false;
+    }
+}
+
+TEST_CASE(SessionTable, AttachEnumeratesExistingSessionsOnce)
+{
+    auto backend = std::make_shared<Backend::SimulatedSessionBackend>();
+    const std::wstring teams = backend->addSession(kSpeakers, 100, L"Teams.exe", L"Microsoft Teams");
+    const std::wstring idle = backend->addSession(kSpeakers, 200, L"Spotify.exe", L"", SessionState::Inactive);
+    backend->addSession(kHeadset, 300, L"Discord.exe");
+
+    SessionTable table(backend);
+    CHECK_EQ(table.attach(kSpeakers), S_OK);
+    CHECK_EQ(table.attach(kSpeakers), S_FALSE);
+
+    const SessionTableStats stats = table.stats();
+    CHECK_EQ(stats.devices, 1u);
+    CHECK_EQ(stats.sessions, 2u);
+    CHECK_EQ(stats.processes, 2u);
+    CHECK_EQ(stats.enumerations, 1u);
+    CHECK_EQ(stats.events, 0u);
+    CHECK_EQ(backend->enumerations(), 1u);
+
+    SessionInfo info;
+    REQUIRE(table.findSession(teams, info));
+    CHECK(info.deviceId == kSpeakers);
+    CHECK_EQ(info.processId, static_cast<DWORD>(100));
+    CHECK(info.executable == L"Teams.exe");
+    CHECK(info.displayName == L"Microsoft Teams");
+    CHECK(info.state == SessionState::Active);
+    REQUIRE(table.findSession(idle, info));
+    CHECK(info.state == SessionState::Inactive);
+    CHECK(table.sessionsForExecutable(L"Discord.exe").empty()); // Not attached
+}
+
+TEST_CASE(SessionTable, CreatedSessionsAreIndexedByProcessAndExecutable)
+{
+    auto backend = std::make_shared<Backend::SimulatedSessionBackend>();
+    SessionTable table(backend);
+    REQUIRE(table.attach(kSpeakers) == S_OK);
+    REQUIRE(table.attach(kHeadset) == S_OK);
+
+    const std::wstring first = backend->addSession(kSpeakers, 100, L"Teams.exe");
+    const std::wstring second = backend->addSession(kHeadset, 100, L"Teams.exe");
+    const std::wstring other = backend->addSession(kSpeakers, 200, L"chrome.exe");
+    const std::wstring system = backend->addSession(kSpeakers, 0, L"");
+
+    const SessionTableStats stats = table.stats();
+    CHECK_EQ(stats.sessions, 4u);
+    CHECK_EQ(stats.processes, 3u);
+    CHECK_EQ(stats.events, 4u);
+    CHECK_EQ(stats.enumerations, 2u);
+
+    const std::vector<SessionInfo> teams = table.sessionsForProcess(100);
+    CHECK_EQ(teams.size(), 2u);
+    CHECK(Contains(teams, first) && Contains(teams, second));
+
+    const std::vector<SessionInfo> byName = table.sessionsForExecutable(L"TEAMS.EXE");
+    CHECK_EQ(byName.size(), 2u);
+    CHECK(Contains(byName, first) && Contains(byName, second));
+    CHECK(Contains(table.sessionsForExecutable(L"Chrome.exe"), other));
+    CHECK(Contains(table.sessionsForProcess(0), system));
+    CHECK(table.sessionsForExecutable(L"").empty());
+    CHECK(table.sessionsForProcess(999).empty());
+    CHECK_EQ(table.sessions().size(), 4u);
+}
+
+TEST_CASE(SessionTable, StateChangesAndExpiryKeepIndexesInStep)
+{
+    auto backend = std::make_shared<Backend::SimulatedSessionBackend>();
+    SessionTable table(backend);
+    REQUIRE(table.attach(kSpeakers) == S_OK);
+
+    const std::wstring call = backend->addSession(kSpeakers, 100, L"Teams.exe");
+    const std::wstring ring = backend->addSession(kSpeakers, 100, L"Teams.exe");
+    const std::wstring music = backend->addSession(kSpeakers, 200, L"Spotify.exe");
+
+    REQUIRE(backend->setSessionState(call, SessionState::Inactive));
+    SessionInfo info;
+    REQUIRE(table.findSession(call, info));
+    CHECK(info.state == SessionState::Inactive);
+
+    REQUIRE(backend->setSessionState(call, SessionState::Expired));
+    CHECK(!table.findSession(call, info));
+    CHECK_EQ(table.sessionsForProcess(100).size(), 1u);
+    CHECK_EQ(table.sessionsForExecutable(L"teams.exe").size(), 1u);
+
+    REQUIRE(backend->disconnectSession(ring));
+    CHECK(table.sessionsForProcess(100).empty());
+    CHECK(table.sessionsForExecutable(L"teams.exe").empty());
+
+    const SessionTableStats stats = table.stats();
+    CHECK_EQ(stats.sessions, 1u);
+    CHECK_EQ(stats.processes, 1u);
+    CHECK_EQ(stats.events, 6u); // 3 created, 2 state changes, 1 disconnect
+    CHECK(table.findSession(music, info));
+    CHECK_EQ(table.setProcessMute(100, true), E_NOTFOUND);
+}
+
+TEST_CASE(SessionTable, VolumeEventsFromTheMixerAreMirrored)
+{
+    auto backend = std::make_shared<Backend::SimulatedSessionBackend>();
+    SessionTable table(backend);
+    REQUIRE(table.attach(kSpeakers) == S_OK);
+    const std::wstring session = backend->addSession(kSpeakers, 100, L"Teams.exe");
+
+    REQUIRE(backend->setSessionVolume(session, 0.25f, true));
+    SessionInfo info;
+    REQUIRE(table.findSession(session, info));
+    CHECK_EQ(info.volume, 0.25f);
+    CHECK(info.muted);
+
+    REQUIRE(backend->setSessionVolume(session, 0.75f, false));
+    REQUIRE(table.findSession(session, info));
+    CHECK_EQ(info.volume, 0.75f);
+    CHECK(!info.muted);
+}
+
+TEST_CASE(SessionTable, ControlUsesCachedVolumeControls)
+{
+    auto backend = std::make_shared<Backend::SimulatedSessionBackend>();
+    SessionTable table(backend);
+    REQUIRE(table.attach(kSpeakers) == S_OK);
+    REQUIRE(table.attach(kHeadset) == S_OK);
+
+    const std::wstring a = backend->addSession(kSpeakers, 100, L"Teams.exe");
+    const std::wstring b = backend->addSession(kHeadset, 100, L"Teams.exe");
+    const std::wstring c = backend->addSession(kSpeakers, 200, L"Spotify.exe");
+    const uint64_t enumerations = backend->enumerations();
+
+    CHECK_EQ(table.setProcessMute(100, true), S_OK);
+    CHECK(backend->isMuted(a) && backend->isMuted(b));
+    CHECK(!backend->isMuted(c));
+    CHECK_EQ(backend->volumeCalls(), 2u);
+
+    CHECK_EQ(table.setExecutableVolume(L"spotify.EXE", 0.5f), S_OK);
+    CHECK_EQ(backend->volume(c), 0.5f);
+    CHECK_EQ(table.setSessionMute(a, false), S_OK);
+    CHECK(!backend->isMuted(a));
+    CHECK_EQ(table.setSessionVolume(b, 0.1f), S_OK);
+    CHECK_EQ(backend->volume(b), 0.1f);
+    CHECK_EQ(table.setExecutableMute(L"teams.exe", false), S_OK);
+    CHECK_EQ(table.setProcessVolume(200, 1.0f), S_OK);
+    CHECK_EQ(backend->volumeCalls(), 8u);
+    CHECK_EQ(backend->enumerations(), enumerations); // No walk over the session managers
+
+    SessionInfo info;
+    REQUIRE(table.findSession(b, info));
+    CHECK_EQ(info.volume, 0.1f);
+    CHECK(!info.muted);
+
+    CHECK_EQ(table.setProcessVolume(100, 1.5f), E_INVALIDARG);
+    CHECK_EQ(table.setProcessMute(999, true), E_NOTFOUND);
+    CHECK_EQ(table.setExecutableMute(L"unknown.exe", true), E_NOTFOUND);
+    CHECK_EQ(table.setSessionVolume(L"missing", 0.5f), E_NOTFOUND);
+    CHECK_EQ(backend->volumeCalls(), 8u);
+}
+
+TEST_CASE(SessionTable, DetachDropsSessionsAndStopsEvents)
+{
+    auto backend = std::make_shared<Backend::SimulatedSessionBackend>();
+    SessionTable table(backend);
+    REQUIRE(table.attach(kSpeakers) == S_OK);
+    REQUIRE(table.attach(kHeadset) == S_OK);
+    backend->addSession(kSpeakers, 100, L"Teams.exe");
+    const std::wstring kept = backend->addSession(kHeadset, 200, L"Discord.exe");
+
+    table.detach(kSpeakers);
+    backend->addSession(kSpeakers, 300, L"chrome.exe");
+
+    const SessionTableStats stats = table.stats();
+    CHECK_EQ(stats.devices, 1u);
+    CHECK_EQ(stats.sessions, 1u);
+    CHECK_EQ(stats.events, 2u);
+    CHECK(table.sessionsForProcess(100).empty());
+    CHECK(table.sessionsForProcess(300).empty());
+    CHECK(Contains(table.sessions(), kept));
+
+    table.detachAll();
+    CHECK_EQ(table.stats().devices, 0u);
+    CHECK(table.sessions().empty());
+    backend->addSession(kHeadset, 400, L"obs64.exe");
+    CHECK(table.sessions().empty());
+}
+
+TEST_CASE(SessionTable, AttachAllFollowsTheAudioBackend)
+{
+    const auto audio = UnitTest::Simulated();
+    const std::vector<std::wstring> render = audio->deviceIds(eRender);
+    REQUIRE(!render.empty());
+
+    auto backend = std::make_shared<Backend::SimulatedSessionBackend>();
+    const std::wstring playing = backend->addSession(render.back(), 100, L"Teams.exe");
+    backend->addSession(audio->deviceIds(eCapture).front(), 100, L"Teams.exe");
+
+    SessionTable table(backend);
+    CHECK_EQ(table.attachAll(eRender), S_OK);
+    const SessionTableStats stats = table.stats();
+    CHECK_EQ(stats.devices, render.size());
+    CHECK_EQ(stats.enumerations, static_cast<uint64_t>(render.size()));
+    CHECK_EQ(stats.sessions, 1u);
+    CHECK(Contains(table.sessionsForProcess(100), playing));
+}
@@ -0,0 +1,286 @@
+#include "UnitTest.h"
+#include "Devices/SnapshotDiff.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Devices;
+
+namespace
+{
+    Utility::DeviceFormatInfo Format(uint32_t sampleRate, uint16_t channels)
+    {
+        Utility::DeviceFormatInfo format;
+        format.sampleRate = sampleRate;
+        format.channels = channels;
+        format.bitDepth = 32;
+        format.blockAlign = static_cast<uint16_t>(channels * 4);
+        format.channelMask = channels == 2 ? 0x3u : 0x3Fu;
+        format.isFloat = true;
+        format.valid = true;
+        return format;
+    }
+
+    DeviceRecord Record(const std::wstring &id, const std::wstring &name, DeviceFlow flow = DeviceFlow::Render)
+    {
+        DeviceRecord record;
+        record.id = id;
+        record.name = name;
+        record.flow = flow;
+        record.format = Format(48000, 2);
+        return record;
+    }
+
+    std::vector<DeviceRecord> Baseline()
+    {
+        std::vector<DeviceRecord> records = {
+            Record(L"{speakers}", L"Speakers (Realtek)"),
+            Record(L"{hdmi}", L"LG TV (NVIDIA High Definition Audio)"),
+            Record(L"{headset}", L"Headset Earphone (Jabra)"),
+            Record(L"{mic}", L"Microphone (Jabra)", DeviceFlow::Capture),
+        };
+        records[0].isDefault = true;
+        records[3].isDefault = true;
+        return records;
+    }
+
+    /**
+     * @brief Diff of the baseline against a copy with one record edited: exactly one change, with these flags.
+     */
+    template <typename Edit>
+    void CheckSingleChange(size_t index, uint32_t expected, Edit edit)
+    {
+        const std::vector<DeviceRecord> before = Baseline();
+        std::vector<DeviceRecord> after = before;
+        edit(after[index]);
+
+        const SnapshotDiff diff = DiffSnapshots(before, after);
+        REQUIRE(diff.changes.size() == 1u);
+        CHECK_EQ(diff.changes[0].flags, expected);
+        CHECK_EQ(diff.changes[0].before, static_cast<uint32_t>(index));
+        CHECK_EQ(diff.changes[0].after, static_cast<uint32_t>(index));
+        CHECK_EQ(diff.unchanged, before.size() - 1);
+        CHECK_EQ(diff.count(expected), 1u);
+    }
+
+    /**
+     * @brief Pairs by ID and flow and compares fields with DeviceRecord::operator==.
+     */
+    SnapshotDiff ReferenceDiff(const std::vector<DeviceRecord> &before, const std::vector<DeviceRecord> &after)
+    {
+        SnapshotDiff diff;
+        std::vector<bool> matched(before.size(), false);
+        for (size_t i = 0; i < after.size(); ++i)
+        {
+            DeviceChange change;
+            change.after = static_cast<uint32_t>(i);
+            size_t j = 0;
+            while (j < before.size() && (matched[j] || before[j].id != after[i].id || before[j].flow != after[i].flow))
+                ++j;
+            if (j == before.size())
+            {
+                change.flags = DeviceAdded;
+                diff.changes.push_back(change);
+                continue;
+            }
+
+            matched[j] = true;
+            if (before[j] == after[i])
+            {
+                ++diff.unchanged;
+                continue;
+            }
+
+            DeviceRecord reformatted = before[j];
+            reformatted.format = after[i].format;
+            change.before = static_cast<uint32_t>(j);
+            if (before[j].state != after[i].state)
+                change.flags |= DeviceStateChanged;
+            if (before[j].name != after[i].name)
+                change.flags |= DeviceRenamed;
+            if (reformatted != before[j])
+                change.flags |= DeviceFormatChanged;
+            if (before[j].isDefault != after[i].isDefault)
+                change.flags |= DeviceDefaultChanged;
+            diff.changes.push_back(change);
+        }
+        for (size_t j = 0; j < before.size(); ++j)
+        {
+            if (matched[j])
+                continue;
+            DeviceChange change;
+            change.flags = DeviceRemoved;
+            change.before = static_cast<uint32_t>(j);
+            diff.changes.push_back(change);
+        }
+        return diff;
+    }
+
+    void CheckSameDiff(const SnapshotDiff &actual, const SnapshotDiff &expected)
+    {
+        CHECK_EQ(actual.unchanged, expected.unchanged);
+        REQUIRE(actual.changes.size() == expected.changes.size());
+        for (size_t i = 0; i < actual.changes.size(); ++i)
+        {
+            CHECK_EQ(actual.changes[i].flags, expected.changes[i].flags);
+            CHECK_EQ(actual.changes[i].before, expected.changes[i].before);
+            CHECK_EQ(actual.changes[i].after, expected.changes[i].after);
+        }
+    }
+}
+
+TEST_CASE(SnapshotDiff, FirstUpdateAndResetReportEverythingAdded)
+{
+    SnapshotDiffer differ;
+    const std::vector<DeviceRecord> records = Baseline();
+
+    const SnapshotDiff &first = differ.update(records);
+    REQUIRE(first.changes.size() == records.size());
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        CHECK_EQ(first.changes[i].flags, static_cast<uint32_t>(DeviceAdded));
+        CHECK_EQ(first.changes[i].before, DeviceChange::None);
+        CHECK_EQ(first.changes[i].after, static_cast<uint32_t>(i));
+    }
+    CHECK_EQ(first.count(DeviceAdded), records.size());
+    CHECK(differ.previous().empty());
+
+    differ.reset();
+    CHECK(differ.current().empty());
+    CHECK_EQ(differ.update(records).count(DeviceAdded), records.size());
+}
+
+TEST_CASE(SnapshotDiff, IdenticalSnapshotsAreUnchangedInAnyOrder)
+{
+    const std::vector<DeviceRecord> before = Baseline();
+    std::vector<DeviceRecord> after(before.rbegin(), before.rend());
+
+    const SnapshotDiff diff = DiffSnapshots(before, after);
+    CHECK(diff.empty());
+    CHECK_EQ(diff.unchanged, before.size());
+
+    // Unreadable formats compare equal whatever their stale fields hold
+    std::vector<DeviceRecord> invalid = before;
+    invalid[1].format = Utility::DeviceFormatInfo();
+    std::vector<DeviceRecord> stale = invalid;
+    stale[1].format.sampleRate = 96000;
+    CHECK(DiffSnapshots(invalid, stale).empty());
+}
+
+TEST_CASE(SnapshotDiff, ClassifiesEachKindOfChange)
+{
+    CheckSingleChange(2, DeviceStateChanged, [](DeviceRecord &r) { r.state = DEVICE_STATE_UNPLUGGED; });
+    CheckSingleChange(1, DeviceRenamed, [](DeviceRecord &r) { r.name = L"Living Room TV (NVIDIA High Definition Audio)"; });
+    CheckSingleChange(0, DeviceFormatChanged, [](DeviceRecord &r) { r.format = Format(44100, 2); });
+    CheckSingleChange(0, DeviceFormatChanged, [](DeviceRecord &r) { r.format = Format(48000, 6); });
+    CheckSingleChange(3, DeviceFormatChanged, [](DeviceRecord &r) { r.format = Utility::DeviceFormatInfo(); });
+    CheckSingleChange(3, DeviceFormatChanged, [](DeviceRecord &r) { r.format.channelMask = 0x4u; });
+    CheckSingleChange(2, DeviceDefaultChanged, [](DeviceRecord &r) { r.isDefault = true; });
+    CheckSingleChange(0, DeviceDefaultChanged, [](DeviceRecord &r) { r.isDefault = false; });
+    CheckSingleChange(1, DeviceStateChanged | DeviceRenamed | DeviceFormatChanged | DeviceDefaultChanged, [](DeviceRecord &r) {
+        r.state = DEVICE_STATE_DISABLED;
+        r.name = L"TV";
+        r.format = Format(96000, 6);
+        r.isDefault = true;
+    });
+}
+
+TEST_CASE(SnapshotDiff, AddedAndRemovedFollowSnapshotOrder)
+{
+    const std::vector<DeviceRecord> before = Baseline();
+    std::vector<DeviceRecord> after = {
+        before[2],
+        Record(L"{usb}", L"USB Audio DAC"),
+        before[0],
+        Record(L"{webcam}", L"Microphone (C920)", DeviceFlow::Capture),
+    };
+    after[2].name = L"Speakers (Realtek(R) Audio)";
+
+    const SnapshotDiff diff = DiffSnapshots(before, after);
+    CHECK_EQ(diff.unchanged, 1u);
+    REQUIRE(diff.changes.size() == 5u);
+
+    CHECK_EQ(diff.changes[0].flags, static_cast<uint32_t>(DeviceAdded));
+    CHECK_EQ(diff.changes[0].after, 1u);
+    CHECK_EQ(diff.changes[1].flags, static_cast<uint32_t>(DeviceRenamed));
+    CHECK_EQ(diff.changes[1].before, 0u);
+    CHECK_EQ(diff.changes[1].after, 2u);
+    CHECK_EQ(diff.changes[2].flags, static_cast<uint32_t>(DeviceAdded));
+    CHECK_EQ(diff.changes[2].after, 3u);
+    CHECK_EQ(diff.changes[3].flags, static_cast<uint32_t>(DeviceRemoved));
+    CHECK_EQ(diff.changes[3].before, 1u);
+    CHECK_EQ(diff.changes[3].after, DeviceChange::None);
+    CHECK_EQ(diff.changes[4].flags, static_cast<uint32_t>(DeviceRemoved));
+    CHECK_EQ(diff.changes[4].before, 3u);
+
+    CHECK_EQ(diff.count(DeviceAdded | DeviceRemoved), 4u);
+    CHECK(DiffSnapshots(before, {}).count(DeviceRemoved) == before.size());
+}
+
+TEST_CASE(SnapshotDiff, SameIdWithAnotherFlowIsAnotherEndpoint)
+{
+    const std::vector<DeviceRecord> before = {Record(L"{combo}", L"Headset", DeviceFlow::Render)};
+    const std::vector<DeviceRecord> after = {Record(L"{combo}", L"Headset", DeviceFlow::Capture)};
+
+    const SnapshotDiff diff = DiffSnapshots(before, after);
+    REQUIRE(diff.changes.size() == 2u);
+    CHECK_EQ(diff.changes[0].flags, static_cast<uint32_t>(DeviceAdded));
+    CHECK_EQ(diff.changes[1].flags, static_cast<uint32_t>(DeviceRemoved));
+    CHECK_EQ(diff.unchanged, 0u);
+}
+
+TEST_CASE(SnapshotDiff, UpdateMatchesReferenceOverManyGenerations)
+{
+    // Sizes cross the 16-slot minimum table several times over; every update diffs against the last
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> idPool(0, 199);
+
+    SnapshotDiffer differ;
+    std::vector<DeviceRecord> previous;
+    for (int generation = 0; generation < 300; ++generation)
+    {
+        std::vector<DeviceRecord> next;
+        for (const DeviceRecord &record : previous)
+        {
+            if (percent(rng) < 10)
+                continue; // Removed
+            DeviceRecord copy = record;
+            const int edit = percent(rng);
+            if (edit < 5)
+                copy.state = copy.state == DEVICE_STATE_ACTIVE ? DEVICE_STATE_UNPLUGGED : DEVICE_STATE_ACTIVE;
+            else if (edit < 10)
+                copy.name += L"*";
+            else if (edit < 15)
+                copy.format = Format(copy.format.sampleRate == 48000 ? 44100 : 48000, 2);
+            else if (edit < 20)
+                copy.isDefault = !copy.isDefault;
+            else if (edit < 22)
+                copy.format = Utility::DeviceFormatInfo();
+            next.push_back(copy);
+        }
+
+        const int additions = percent(rng) % 8;
+        for (int a = 0; a < additions; ++a)
+        {
+            const std::wstring id = L"{" + std::to_wstring(idPool(rng)) + L"}";
+            bool taken = false;
+            for (const DeviceRecord &record : next)
+                taken = taken || record.id == id;
+            if (!taken)
+                next.push_back(Record(id, L"Device " + id, percent(rng) < 30 ? DeviceFlow::Capture : DeviceFlow::Render));
+        }
+
+        // Enumeration order is not stable either
+        std::shuffle(next.begin(), next.end(), rng);
+
+        const SnapshotDiff expected = ReferenceDiff(previous, next);
+        CheckSameDiff(differ.update(next), expected);
+        CHECK_EQ(differ.current().size(), next.size());
+        previous = std::move(next);
+    }
+}
@@ -0,0 +1,175 @@
+#include "UnitTest.h"
+#include "Dsp/Fft.h"
+#include "Dsp/SpectrumAnalyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace Dsp;
+
+namespace
+{
+    constexpr uint32_t kRate = 48000;
+    constexpr double kPi = 3.14159265358979323846;
+
+    std::vector<float> Tone(double hz, float amplitude, size_t frames, uint32_t channels = 1)
+    {
+        std::vector<float> samples(frames * channels);
+        for (size_t f = 0; f < frames; ++f)
+        {
+            const float value = amplitude * static_cast<float>(std::sin(2.0 * kPi * hz * static_cast<double>(f) / kRate));
+            for (uint32_t c = 0; c < channels; ++c)
+                samples[f * channels + c] = value;
+        }
+        return samples;
+    }
+
+    size_t Loudest(const std::vector<float> &magnitudes)
+    {
+        return static_cast<size_t>(std::max_element(magnitudes.begin(), magnitudes.end()) - magnitudes.begin());
+    }
+}
+
+TEST_CASE(SpectrumAnalyzer, FftRejectsSizesThatAreNotPowersOfTwo)
+{
+    Fft fft;
+    CHECK(!fft.configure(0));
+    CHECK(!fft.configure(1));
+    CHECK(!fft.configure(96));
+    CHECK(fft.configure(2));
+    CHECK(fft.configure(4096));
+    CHECK_EQ(fft.size(), size_t(4096));
+}
+
+TEST_CASE(SpectrumAnalyzer, FftMatchesDirectDft)
+{
+    for (size_t n : {size_t(8), size_t(64), size_t(512)})
+    {
+        Fft fft;
+        REQUIRE(fft.configure(n));
+        std::vector<float> re(n), im(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            re[i] = static_cast<float>(std::cos(0.37 * i) + 0.25 * std::sin(1.9 * i));
+            im[i] = static_cast<float>(0.5 * std::sin(0.11 * i * i));
+        }
+        const std::vector<float> inRe = re, inIm = im;
+        fft.forward(re.data(), im.data());
+
+        for (size_t k = 0; k < n; ++k)
+        {
+            double sumRe = 0.0, sumIm = 0.0;
+            for (size_t t = 0; t < n; ++t)
+            {
+                const double angle = -2.0 * kPi * static_cast<double>(k * t % n) / static_cast<double>(n);
+                sumRe += inRe[t] * std::cos(angle) - inIm[t] * std::sin(angle);
+                sumIm += inRe[t] * std::sin(angle) + inIm[t] * std::cos(angle);
+            }
+            CHECK_NEAR(re[k], sumRe, 1e-3 * std::sqrt(static_cast<double>(n)));
+            CHECK_NEAR(im[k], sumIm, 1e-3 * std::sqrt(static_cast<double>(n)));
+        }
+
+        fft.inverse(re.data(), im.data());
+        for (size_t i = 0; i < n; ++i)
+        {
+            CHECK_NEAR(re[i], inRe[i], 1e-4);
+            CHECK_NEAR(im[i], inIm[i], 1e-4);
+        }
+    }
+}
+
+TEST_CASE(SpectrumAnalyzer, FftPutsABinCentredCosineInOneBin)
+{
+    const size_t n = 1024;
+    const size_t bin = 37;
+    Fft fft;
+    REQUIRE(fft.configure(n));
+    std::vector<float> re(n), im(n, 0.0f);
+    for (size_t i = 0; i < n; ++i)
+        re[i] = static_cast<float>(std::cos(2.0 * kPi * bin * i / n));
+    fft.forward(re.data(), im.data());
+    for (size_t k = 0; k < n; ++k)
+    {
+        const double magnitude = std::hypot(re[k], im[k]);
+        const double expected = (k == bin || k == n - bin) ? n / 2.0 : 0.0;
+        CHECK_NEAR(magnitude, expected, 1e-2);
+    }
+}
+
+TEST_CASE(SpectrumAnalyzer, AnalysesEveryHopOnceTheWindowIsFull)
+{
+    SpectrumConfig config;
+    config.fftSize = 2048;
+    config.overlap = 0.5f;
+    SpectrumAnalyzer analyzer;
+    REQUIRE(analyzer.configure(config, kRate));
+
+    const std::vector<float> silence(4096, 0.0f);
+    CHECK_EQ(analyzer.push(silence.data(), 2047, 1), size_t(0));
+    CHECK_EQ(analyzer.push(silence.data(), 1, 1), size_t(1));
+    CHECK_EQ(analyzer.push(silence.data(), 2048, 1), size_t(2));
+    CHECK_EQ(analyzer.analysisCount(), uint64_t(3));
+    CHECK_EQ(analyzer.magnitudes().size(), size_t(1025));
+}
+
+TEST_CASE(SpectrumAnalyzer, PureTonesPeakAtTheirBinWithTheirAmplitude)
+{
+    SpectrumConfig config;
+    config.fftSize = 4096;
+    SpectrumAnalyzer analyzer;
+    REQUIRE(analyzer.configure(config, kRate, 8192));
+
+    for (size_t bin : {size_t(10), size_t(85), size_t(400), size_t(1500)})
+    {
+        for (float amplitude : {1.0f, 0.25f})
+        {
+            const double hz = analyzer.binFrequency(bin);
+            const std::vector<float> tone = Tone(hz, amplitude, config.fftSize * 2);
+            REQUIRE(analyzer.push(tone.data(), tone.size(), 1) > 0);
+            const std::vector<float> &magnitudes = analyzer.magnitudes();
+            CHECK_EQ(Loudest(magnitudes), bin);
+            CHECK_NEAR(magnitudes[bin], amplitude, 0.01 * amplitude);
+            // Hann leakage stays within the neighbouring bins
+            CHECK(magnitudes[bin + 3] < 0.001f * amplitude);
+            CHECK(magnitudes[bin - 3] < 0.001f * amplitude);
+        }
+    }
+    CHECK_NEAR(analyzer.binFrequency(1), kRate / 4096.0, 1e-3);
+}
+
+TEST_CASE(SpectrumAnalyzer, BandsReportTheToneBand)
+{
+    SpectrumConfig config;
+    config.fftSize = 2048;
+    config.bandCount = 16;
+    SpectrumAnalyzer analyzer;
+    REQUIRE(analyzer.configure(config, kRate));
+
+    SpectrumSnapshot snapshot;
+    CHECK(!analyzer.readSnapshot(snapshot));
+
+    const std::vector<float> tone = Tone(1000.0, 0.5f, 4096, 2);
+    REQUIRE(analyzer.push(tone.data(), 4096, 2) > 0);
+    REQUIRE(analyzer.readSnapshot(snapshot));
+    REQUIRE(snapshot.bands.size() == 16u);
+    CHECK_EQ(snapshot.sequence, analyzer.analysisCount());
+    CHECK(!analyzer.readSnapshot(snapshot)); // Nothing newer
+
+    const size_t loudest = Loudest(snapshot.bands);
+    float low = 0.0f, high = 0.0f;
+    analyzer.bandEdges(static_cast<uint32_t>(loudest), low, high);
+    CHECK(low <= 1000.0f && 1000.0f <= high);
+}
+
+TEST_CASE(SpectrumAnalyzer, OppositeChannelsCancelInTheDownmix)
+{
+    SpectrumAnalyzer analyzer;
+    REQUIRE(analyzer.configure(SpectrumConfig(), kRate));
+    std::vector<float> stereo = Tone(440.0, 0.8f, 4096, 2);
+    for (size_t f = 0; f < 4096; ++f)
+        stereo[f * 2 + 1] = -stereo[f * 2];
+    REQUIRE(analyzer.push(stereo.data(), 4096, 2) > 0);
+    for (float magnitude : analyzer.magnitudes())
+        CHECK(magnitude < 1e-6f);
+}
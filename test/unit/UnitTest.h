@@ -0,0 +1,112 @@
+#pragma once
+
+// Minimal test registry for the unit tests (test/unit), run by CTest on every platform.
+//
+//   TEST_CASE(ChannelMatrix, MonoToStereo)
+//   {
+//       CHECK_NEAR(matrix.coefficient(0, 0), 0.7071f, 1e-4f);
+//   }
+//
+// Tests of a suite live in <Suite>Tests.cpp; CMake registers one CTest test per
+// suite. Every test runs against a fresh Backend::SimulatedBackend.
+
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Backend/SimulatedBackend.h"
+
+namespace UnitTest
+{
+    using TestFunction = void (*)();
+
+    struct TestCase
+    {
+        const char *suite;
+        const char *name;
+        TestFunction function;
+    };
+
+    /**
+     * @brief Every test case linked into the executable, in registration order.
+     */
+    std::vector<TestCase> &Registry();
+
+    /**
+     * @brief Adds a test case to the registry at static initialisation (used by TEST_CASE).
+     */
+    struct Registrar
+    {
+        Registrar(const char *suite, const char *name, TestFunction function);
+    };
+
+    /**
+     * @brief Thrown by REQUIRE to abandon the current test.
+     */
+    struct Abort
+    {
+    };
+
+    /**
+     * @brief Records a failed check of the current test.
+     */
+    void Fail(const char *file, int line, const std::string &message);
+
+    /**
+     * @brief The simulated backend installed for the current test (also the process-wide backend).
+     */
+    std::shared_ptr<Backend::SimulatedBackend> Simulated();
+
+    template <typename T>
+    std::string Describe(const T &value)
+    {
+        std::ostringstream text;
+        text << value;
+        return text.str();
+    }
+}
+
+#define TEST_CASE(suite, name)                                                                     \
+    static void suite##_##name();                                                                  \
+    static const ::UnitTest::Registrar suite##_##name##_registrar(#suite, #name, &suite##_##name); \
+    static void suite##_##name()
+
+#define CHECK(condition)                                               \
+    do                                                                 \
+    {                                                                  \
+        if (!(condition))                                              \
+            ::UnitTest::Fail(__FILE__, __LINE__, "CHECK(" #condition ")"); \
+    } while (0)
+
+#define REQUIRE(condition)                                               \
+    do                                                                   \
+    {                                                                    \
+        if (!(condition))                                                \
+        {                                                                \
+            ::UnitTest::Fail(__FILE__, __LINE__, "REQUIRE(" #condition ")"); \
+            throw ::UnitTest::Abort();                                   \
+        }                                                                \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                          \
+    do                                                                                                      \
+    {                                                                                                       \
+        const auto &unitTestActual_ = (actual);                                                             \
+        const auto &unitTestExpected_ = (expected);                                                         \
+        if (!(unitTestActual_ == unitTestExpected_))                                                        \
+            ::UnitTest::Fail(__FILE__, __LINE__, "CHECK_EQ(" #actual ", " #expected "): " +                 \
+                                                     ::UnitTest::Describe(unitTestActual_) + " != " +       \
+                                                     ::UnitTest::Describe(unitTestExpected_));              \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                                              \
+    do                                                                                                       \
+    {                                                                                                        \
+        const double unitTestActual_ = static_cast<double>(actual);                                          \
+        const double unitTestExpected_ = static_cast<double>(expected);                                      \
+        if (!(std::fabs(unitTestActual_ - unitTestExpected_) <= static_cast<double>(tolerance)))             \
+            ::UnitTest::Fail(__FILE__, __LINE__, "CHECK_NEAR(" #actual ", " #expected "): " +                \
+                                                     ::UnitTest::Describe(unitTestActual_) + " vs " +        \
+                                                     ::UnitTest::Describe(unitTestExpected_));               \
+    } while (0)
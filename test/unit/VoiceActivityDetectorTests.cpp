@@ -0,0 +1,217 @@
+#include "UnitTest.h"
+#include "Dsp/VoiceActivityDetector.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace Dsp;
+
+namespace
+{
+    constexpr uint32_t kRate = 48000;
+    constexpr double kPi = 3.14159265358979323846;
+
+    /**
+     * @brief A stretch of test signal and whether it contains speech.
+     */
+    struct Segment
+    {
+        enum Kind
+        {
+            Silence,
+            QuietNoise, ///< -60 dBFS white noise (room tone)
+            LoudNoise,  ///< -20 dBFS white noise (fan, hiss): loud but not speech
+            Voice       ///< Voiced vowel-like harmonics around -25 dBFS with syllable modulation
+        };
+        Kind kind;
+        uint32_t ms;
+    };
+
+    bool IsSpeech(Segment::Kind kind)
+    {
+        return kind == Segment::Voice;
+    }
+
+    class Generator
+    {
+    public:
+        float next(Segment::Kind kind)
+        {
+            const double t = static_cast<double>(m_sample++) / kRate;
+            switch (kind)
+            {
+            case Segment::Silence:
+                return 0.0f;
+            case Segment::QuietNoise:
+                return 0.001f * noise() * 1.7320508f;
+            case Segment::LoudNoise:
+                return 0.1f * noise() * 1.7320508f;
+            case Segment::Voice:
+            {
+                // 120-180 Hz vibrato fundamental, 12 harmonics falling 6 dB/octave, 4 Hz syllables
+                m_phase += 2.0 * kPi * (150.0 + 30.0 * std::sin(2.0 * kPi * 3.0 * t)) / kRate;
+                double value = 0.0;
+                for (int h = 1; h <= 12; ++h)
+                    value += std::sin(h * m_phase) / h;
+                const double syllable = 0.6 + 0.4 * std::sin(2.0 * kPi * 4.0 * t);
+                return static_cast<float>(0.05 * syllable * value) + 0.001f * noise();
+            }
+            }
+            return 0.0f;
+        }
+
+    private:
+        /// Uniform in [-1, 1).
+        float noise()
+        {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return static_cast<float>(m_state) / 2147483648.0f - 1.0f;
+        }
+
+        uint64_t m_sample = 0;
+        double m_phase = 0.0;
+        uint32_t m_state = 2463534242u;
+    };
+
+    /**
+     * @brief Feeds the segments frame by frame and checks isActive() against the labels.
+     *
+     * Around each speech onset the detector may lag by its reaction time, and after each
+     * speech offset it stays active for the hangover; every other frame must match.
+     */
+    void CheckLabelled(const std::vector<Segment> &segments, const VadConfig &config = VadConfig())
+    {
+        VoiceActivityDetector vad;
+        REQUIRE(vad.configure(kRate, config));
+        const size_t frame = vad.frameSamples();
+        const uint32_t onsetFrames = vad.reactionTimeMs() / config.frameMs + 1;
+        const uint32_t offsetFrames = config.hangoverMs / config.frameMs + 2;
+
+        Generator generator;
+        std::vector<float> samples(frame);
+        bool previousSpeech = false;
+        uint32_t sinceChange = 1000;
+        size_t mismatches = 0;
+        size_t index = 0;
+        for (const Segment &segment : segments)
+        {
+            const bool speech = IsSpeech(segment.kind);
+            if (speech != previousSpeech)
+                sinceChange = 0;
+            previousSpeech = speech;
+
+            for (uint32_t f = 0; f < segment.ms / config.frameMs; ++f, ++sinceChange, ++index)
+            {
+                for (float &sample : samples)
+                    sample = generator.next(segment.kind);
+                const bool active = vad.push(samples.data(), samples.size());
+                const uint32_t margin = speech ? onsetFrames : offsetFrames;
+                if (sinceChange >= margin && active != speech)
+                {
+                    ++mismatches;
+                    ::UnitTest::Fail(__FILE__, __LINE__, "frame " + std::to_string(index) + " (segment " +
+                                                             std::to_string(segment.kind) + "): active " +
+                                                             std::to_string(active) + ", level " +
+                                                             std::to_string(vad.features().levelDb) + " dB, floor " +
+                                                             std::to_string(vad.features().noiseFloorDb) + " dB");
+                    if (mismatches > 5)
+                        throw ::UnitTest::Abort();
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(VoiceActivityDetector, RejectsInvalidConfiguration)
+{
+    VoiceActivityDetector vad;
+    CHECK(!vad.configure(0));
+    VadConfig tiny;
+    tiny.frameMs = 0;
+    CHECK(!vad.configure(kRate, tiny));
+    REQUIRE(vad.configure(kRate));
+    CHECK_EQ(vad.frameSamples(), size_t(480));
+    CHECK_EQ(vad.reactionTimeMs(), 30u);
+}
+
+TEST_CASE(VoiceActivityDetector, SilenceAndRoomToneAreNotSpeech)
+{
+    CheckLabelled({{Segment::Silence, 500}, {Segment::QuietNoise, 2000}, {Segment::Silence, 500}});
+}
+
+TEST_CASE(VoiceActivityDetector, VoiceAfterRoomToneIsSpeech)
+{
+    CheckLabelled({{Segment::QuietNoise, 1000}, {Segment::Voice, 800}, {Segment::QuietNoise, 1500},
+                   {Segment::Voice, 400}, {Segment::QuietNoise, 1000}});
+}
+
+TEST_CASE(VoiceActivityDetector, LoudBroadbandNoiseIsNotSpeech)
+{
+    CheckLabelled({{Segment::QuietNoise, 500}, {Segment::LoudNoise, 1500}, {Segment::QuietNoise, 500},
+                   {Segment::Voice, 600}, {Segment::QuietNoise, 1000}});
+}
+
+TEST_CASE(VoiceActivityDetector, ShortPausesAreBridgedByTheHangover)
+{
+    VoiceActivityDetector vad;
+    REQUIRE(vad.configure(kRate));
+    Generator generator;
+    std::vector<float> samples(vad.frameSamples());
+    auto run = [&](Segment::Kind kind, uint32_t frames)
+    {
+        bool alwaysActive = true;
+        for (uint32_t f = 0; f < frames; ++f)
+        {
+            for (float &sample : samples)
+                sample = generator.next(kind);
+            alwaysActive = vad.push(samples.data(), samples.size()) && alwaysActive;
+        }
+        return alwaysActive;
+    };
+
+    run(Segment::QuietNoise, 100);
+    run(Segment::Voice, 50);
+    CHECK(vad.isActive());
+    CHECK(run(Segment::QuietNoise, 20)); // 200 ms pause < 400 ms hangover
+    run(Segment::Voice, 10);
+    CHECK(vad.isActive());
+    run(Segment::QuietNoise, 60);
+    CHECK(!vad.isActive());
+
+    vad.reset();
+    CHECK(!vad.isActive());
+}
+
+TEST_CASE(VoiceActivityDetector, RawPcmMatchesFloatInput)
+{
+    Utility::DeviceFormatInfo format;
+    format.bitDepth = 16;
+    format.channels = 2;
+    format.blockAlign = 4;
+    format.sampleRate = kRate;
+    format.valid = true;
+
+    VoiceActivityDetector floatVad, pcmVad;
+    REQUIRE(floatVad.configure(kRate));
+    REQUIRE(pcmVad.configure(kRate));
+    Generator generator;
+    const size_t frames = 960;
+    std::vector<float> mono(frames);
+    std::vector<int16_t> pcm(frames * 2);
+    for (int block = 0; block < 200; ++block)
+    {
+        const Segment::Kind kind = block < 50 ? Segment::QuietNoise : (block < 120 ? Segment::Voice : Segment::QuietNoise);
+        for (size_t i = 0; i < frames; ++i)
+        {
+            const int16_t value = static_cast<int16_t>(std::lround(generator.next(kind) * 32767.0f));
+            mono[i] = value / 32768.0f;
+            pcm[i * 2] = value;
+            pcm[i * 2 + 1] = value;
+        }
+        CHECK_EQ(pcmVad.pushRaw(pcm.data(), frames, format), floatVad.push(mono.data(), frames));
+        CHECK_NEAR(pcmVad.features().levelDb, floatVad.features().levelDb, 0.01);
+    }
+}
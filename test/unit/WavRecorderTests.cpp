@@ -0,0 +1,322 @@
+#include "UnitTest.h"
+#include "Streaming/AudioStream.h"
+#include "Streaming/WavFile.h"
+#include "Streaming/WavRecorder.h"
+#include "Utility/FileSink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Streaming;
+
+namespace
+{
+    constexpr uint64_t kDataOffset = WavRecorder::DataOffset;
+
+    /**
+     * @brief What a MemoryFileSink wrote, shared with the test after the recorder owns the sink.
+     */
+    struct SinkState
+    {
+        std::mutex mutex;
+        std::condition_variable released;
+        bool stalled = false;                        ///< write() waits until cleared
+        std::chrono::milliseconds delay{0};          ///< Added to every write()
+        bool failWrites = false;
+        std::vector<uint8_t> image;                  ///< Current file contents
+        std::vector<std::vector<uint8_t>> flushes;   ///< Contents at every flush (what survives a crash)
+        size_t writes = 0;
+
+        void stall()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stalled = true;
+        }
+
+        void fail()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            failWrites = true;
+        }
+
+        void release()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stalled = false;
+            }
+            released.notify_all();
+        }
+    };
+
+    /**
+     * @brief In-memory IFileSink that can be slowed down, stalled or made to fail.
+     */
+    class MemoryFileSink : public Utility::IFileSink
+    {
+    public:
+        explicit MemoryFileSink(std::shared_ptr<SinkState> state) : m_state(std::move(state)) {}
+
+        bool write(const void *data, size_t bytes) override
+        {
+            std::unique_lock<std::mutex> lock(m_state->mutex);
+            m_state->released.wait(lock, [&]
+                                   { return !m_state->stalled; });
+            if (m_state->delay.count() > 0)
+                std::this_thread::sleep_for(m_state->delay);
+            ++m_state->writes;
+            if (m_state->failWrites)
+                return false;
+            const uint8_t *p = static_cast<const uint8_t *>(data);
+            m_state->image.insert(m_state->image.end(), p, p + bytes);
+            return true;
+        }
+
+        bool writeAt(uint64_t offset, const void *data, size_t bytes) override
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            if (offset + bytes > m_state->image.size())
+                return false;
+            std::memcpy(m_state->image.data() + offset, data, bytes);
+            return true;
+        }
+
+        bool flush(bool) override
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            m_state->flushes.push_back(m_state->image);
+            return true;
+        }
+
+        void close() override {}
+
+    private:
+        std::shared_ptr<SinkState> m_state;
+    };
+
+    /**
+     * @brief Source handing out a fixed number of frames, as much as asked per read().
+     */
+    class CountingSource : public IAudioSource
+    {
+    public:
+        CountingSource(const Utility::DeviceFormatInfo &format, size_t frames) : m_format(format), m_left(frames) {}
+
+        const Utility::DeviceFormatInfo &format() const override { return m_format; }
+
+        size_t read(void *dst, size_t maxFrames) override
+        {
+            const size_t n = std::min(maxFrames, m_left);
+            std::memset(dst, 0x11, n * m_format.blockAlign);
+            m_left -= n;
+            return n;
+        }
+
+    private:
+        Utility::DeviceFormatInfo m_format;
+        size_t m_left;
+    };
+
+    Utility::DeviceFormatInfo Format(uint16_t channels, uint16_t bits, bool isFloat)
+    {
+        Utility::DeviceFormatInfo format;
+        format.bitDepth = bits;
+        format.channels = channels;
+        format.blockAlign = static_cast<uint16_t>(channels * bits / 8);
+        format.sampleRate = 48000;
+        format.isFloat = isFloat;
+        format.valid = true;
+        return format;
+    }
+
+    uint32_t ReadU32(const std::vector<uint8_t> &image, size_t offset)
+    {
+        return static_cast<uint32_t>(image[offset]) | static_cast<uint32_t>(image[offset + 1]) << 8 |
+               static_cast<uint32_t>(image[offset + 2]) << 16 | static_cast<uint32_t>(image[offset + 3]) << 24;
+    }
+
+    std::vector<int16_t> Ramp(size_t samples)
+    {
+        std::vector<int16_t> data(samples);
+        for (size_t i = 0; i < samples; ++i)
+            data[i] = static_cast<int16_t>(i * 7);
+        return data;
+    }
+
+    WavRecorderConfig SmallPool()
+    {
+        WavRecorderConfig config;
+        config.bufferBytes = 16 * 1024;
+        config.bufferCount = 4;
+        config.headerUpdateMs = 1;
+        config.durableHeaderUpdates = false;
+        return config;
+    }
+}
+
+TEST_CASE(WavRecorder, RecordsAPlayableFile)
+{
+    const Utility::DeviceFormatInfo format = Format(2, 16, false);
+    auto state = std::make_shared<SinkState>();
+    WavRecorder recorder;
+    REQUIRE(recorder.open(std::make_unique<MemoryFileSink>(state), format, SmallPool()));
+
+    const std::vector<int16_t> samples = Ramp(2 * 10001); // Odd frame count: not a whole buffer
+    size_t written = 0;
+    while (written < 10001)
+    {
+        const size_t n = std::min<size_t>(480, 10001 - written);
+        written += recorder.write(samples.data() + written * 2, n);
+        if (recorder.writableFrames() < 480)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(recorder.close());
+    CHECK_EQ(recorder.framesRecorded(), uint64_t(10001));
+    CHECK_EQ(recorder.droppedFrames(), uint64_t(0));
+
+    WavFile file;
+    REQUIRE(file.parse(state->image.data(), state->image.size()));
+    CHECK_EQ(file.format().channels, uint16_t(2));
+    CHECK_EQ(file.format().bitDepth, uint16_t(16));
+    CHECK_EQ(file.format().sampleRate, 48000u);
+    CHECK(!file.format().isFloat);
+    REQUIRE(file.frameCount() == 10001u);
+    CHECK(std::memcmp(file.frames(), samples.data(), samples.size() * sizeof(int16_t)) == 0);
+    CHECK(file.frames() == state->image.data() + kDataOffset);
+}
+
+TEST_CASE(WavRecorder, StalledDiskDropsFramesInsteadOfBlocking)
+{
+    const Utility::DeviceFormatInfo format = Format(2, 16, false);
+    auto state = std::make_shared<SinkState>();
+    WavRecorder recorder;
+    REQUIRE(recorder.open(std::make_unique<MemoryFileSink>(state), format, SmallPool()));
+    state->stall(); // The header went through; from now on the disk hangs
+
+    // Fill the pool, then keep offering frames: every write() must return at once
+    const std::vector<int16_t> samples = Ramp(2 * 480 * 200);
+    uint64_t offered = 0;
+    uint64_t stored = 0;
+    size_t droppedCalls = 0;
+    auto slowest = std::chrono::steady_clock::duration::zero();
+    for (size_t call = 0; call < 200 && droppedCalls < 20; ++call)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const size_t n = recorder.write(samples.data() + call * 480 * 2, 480);
+        slowest = std::max(slowest, std::chrono::steady_clock::now() - start);
+        offered += 480;
+        stored += n;
+        droppedCalls += n < 480;
+    }
+    CHECK(droppedCalls == 20);
+    CHECK(slowest < std::chrono::milliseconds(50));
+    CHECK_EQ(recorder.framesRecorded(), stored);
+    CHECK_EQ(recorder.droppedFrames(), offered - stored);
+    CHECK_EQ(recorder.writableFrames(), size_t(0));
+
+    // Once the disk recovers everything stored reaches the file, in order
+    state->release();
+    REQUIRE(recorder.close());
+    CHECK_EQ(recorder.bytesWritten(), stored * format.blockAlign);
+
+    WavFile file;
+    REQUIRE(file.parse(state->image.data(), state->image.size()));
+    REQUIRE(file.frameCount() == stored);
+    CHECK(std::memcmp(file.frames(), samples.data(), static_cast<size_t>(stored) * format.blockAlign) == 0);
+}
+
+TEST_CASE(WavRecorder, HeaderNeverCoversUnflushedData)
+{
+    const Utility::DeviceFormatInfo format = Format(2, 32, true);
+    auto state = std::make_shared<SinkState>();
+    state->delay = std::chrono::milliseconds(3);
+    WavRecorder recorder;
+    REQUIRE(recorder.open(std::make_unique<MemoryFileSink>(state), format, SmallPool()));
+
+    std::vector<float> samples(2 * 2048, 0.25f);
+    for (int i = 0; i < 8; ++i)
+    {
+        recorder.write(samples.data(), 2048);
+        std::this_thread::sleep_for(std::chrono::milliseconds(4));
+    }
+    REQUIRE(recorder.close());
+    CHECK_EQ(recorder.droppedFrames(), uint64_t(0));
+
+    // Every flushed image is a valid file whose sizes only cover bytes it contains
+    size_t updates = 0;
+    uint32_t lastDataSize = 0;
+    for (const std::vector<uint8_t> &image : state->flushes)
+    {
+        REQUIRE(image.size() >= kDataOffset);
+        const uint32_t riffSize = ReadU32(image, 4);
+        const uint32_t dataSize = ReadU32(image, kDataOffset - 4);
+        CHECK(dataSize <= image.size() - kDataOffset);
+        CHECK_EQ(riffSize, static_cast<uint32_t>(kDataOffset - 8 + dataSize + (dataSize & 1)));
+        CHECK(dataSize % format.blockAlign == 0);
+        CHECK(dataSize >= lastDataSize);
+        if (dataSize != lastDataSize)
+            ++updates;
+        lastDataSize = dataSize;
+
+        WavFile file;
+        if (dataSize > 0)
+        {
+            CHECK(file.parse(image.data(), image.size()));
+            CHECK_EQ(file.frameCount(), uint64_t(dataSize / format.blockAlign));
+        }
+    }
+    CHECK_EQ(lastDataSize, 8u * 2048u * format.blockAlign);
+    CHECK(updates >= 2); // At least one periodic update before the final one
+}
+
+TEST_CASE(WavRecorder, FailedWritesAreCountedAndReported)
+{
+    auto state = std::make_shared<SinkState>();
+    WavRecorder recorder;
+    REQUIRE(recorder.open(std::make_unique<MemoryFileSink>(state), Format(1, 16, false), SmallPool()));
+    state->fail();
+
+    const std::vector<int16_t> samples = Ramp(16 * 1024);
+    recorder.write(samples.data(), samples.size());
+    CHECK(!recorder.close());
+    CHECK(recorder.writeErrors() > 0);
+    CHECK_EQ(recorder.bytesWritten(), uint64_t(0));
+}
+
+TEST_CASE(WavRecorder, DrainAlwaysEmptiesTheSource)
+{
+    const Utility::DeviceFormatInfo format = Format(2, 16, false);
+    auto state = std::make_shared<SinkState>();
+    WavRecorder recorder;
+    REQUIRE(recorder.open(std::make_unique<MemoryFileSink>(state), format, SmallPool()));
+    state->stall();
+
+    // Four 16 KiB buffers hold 16384 frames; the rest of the source is read and dropped
+    CountingSource source(format, 50000);
+    const size_t stored = recorder.drain(source);
+    CHECK_EQ(stored, size_t(16384));
+    CHECK_EQ(recorder.framesRecorded(), uint64_t(16384));
+    CHECK_EQ(recorder.droppedFrames(), uint64_t(50000 - 16384));
+    CHECK_EQ(source.read(nullptr, 0), size_t(0));
+
+    state->release();
+    CHECK(recorder.close());
+    CHECK_EQ(recorder.bytesWritten(), uint64_t(16384) * format.blockAlign);
+}
+
+TEST_CASE(WavRecorder, RejectsInvalidArguments)
+{
+    WavRecorder recorder;
+    CHECK(!recorder.open(std::unique_ptr<Utility::IFileSink>(), Format(2, 16, false)));
+    CHECK(!recorder.open(std::make_unique<MemoryFileSink>(std::make_shared<SinkState>()), Utility::DeviceFormatInfo()));
+    WavRecorderConfig single;
+    single.bufferCount = 1;
+    CHECK(!recorder.open(std::make_unique<MemoryFileSink>(std::make_shared<SinkState>()), Format(2, 16, false), single));
+    CHECK(!recorder.isOpen());
+    CHECK(!recorder.close());
+}
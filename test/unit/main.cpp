@@ -0,0 +1,90 @@
+// AudioSwitcherUnitTests: runs the registered unit tests (all of them, or one suite).
+//
+//   AudioSwitcherUnitTests [SUITE]
+//
+// Exits with 0 when every selected test passed, 1 otherwise (2 for an unknown suite).
+
+#include "UnitTest.h"
+#include "Backend/AudioBackend.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+namespace
+{
+    const char *g_test = nullptr;
+    size_t g_failures = 0;
+    std::shared_ptr<Backend::SimulatedBackend> g_backend;
+}
+
+namespace UnitTest
+{
+    std::vector<TestCase> &Registry()
+    {
+        static std::vector<TestCase> registry;
+        return registry;
+    }
+
+    Registrar::Registrar(const char *suite, const char *name, TestFunction function)
+    {
+        Registry().push_back({suite, name, function});
+    }
+
+    void Fail(const char *file, int line, const std::string &message)
+    {
+        ++g_failures;
+        std::fprintf(stderr, "%s:%d: %s: %s\n", file, line, g_test ? g_test : "?", message.c_str());
+    }
+
+    std::shared_ptr<Backend::SimulatedBackend> Simulated()
+    {
+        return g_backend;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *suite = argc > 1 ? argv[1] : nullptr;
+
+    size_t run = 0;
+    size_t failed = 0;
+    for (const UnitTest::TestCase &test : UnitTest::Registry())
+    {
+        if (suite && std::strcmp(suite, test.suite) != 0)
+            continue;
+
+        const std::string name = std::string(test.suite) + "." + test.name;
+        g_test = name.c_str();
+        g_backend = std::make_shared<Backend::SimulatedBackend>();
+        Backend::SetAudioBackend(g_backend);
+
+        const size_t failuresBefore = g_failures;
+        try
+        {
+            test.function();
+        }
+        catch (const UnitTest::Abort &)
+        {
+        }
+        catch (const std::exception &e)
+        {
+            UnitTest::Fail(__FILE__, __LINE__, std::string("unexpected exception: ") + e.what());
+        }
+
+        Backend::SetAudioBackend(nullptr);
+        g_backend.reset();
+        ++run;
+        if (g_failures != failuresBefore)
+            ++failed;
+        std::fprintf(stderr, "%s %s\n", g_failures != failuresBefore ? "FAIL" : "ok  ", name.c_str());
+    }
+
+    if (run == 0)
+    {
+        std::fprintf(stderr, "No tests in suite %s\n", suite ? suite : "(all)");
+        return 2;
+    }
+    std::fprintf(stderr, "%zu of %zu tests passed\n", run - failed, run);
+    return failed == 0 ? 0 : 1;
+}